@@ -1,5 +1,6 @@
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/Time.hpp"
+#include "Engine/Core/Profiler.hpp"
 #include <thread>
 
 #define STATIC
@@ -114,6 +115,7 @@ STATIC Clock& Clock::GetSystemClock()
 STATIC void Clock::TickSystemClock()
 {
 	s_systemClock->Tick();
+	ProfilerBeginFrame();
 }
 
 void Clock::Tick()
@@ -1,15 +1,19 @@
 #include "Engine/Core/DebugRender.hpp"
 #include "Engine/Core/Clock.hpp"
-#include "Engine/Core/Timer.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Renderer/Camera.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/SlotMap.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
 #include <vector>
 #include <algorithm>
+#include <cmath>
+#include <unordered_map>
 
 class Texture;
 
@@ -17,173 +21,422 @@ class Texture;
 namespace 
 {
 	constexpr float	MESSAGE_MARGIN_RATIO = 0.2f;
+	// Timed objects are filed by expiry time in buckets this long, a whole bucket goes at once
+	constexpr double EXPIRY_BUCKET_SECONDS = 0.25;
+	Rgba8 const X_RAY_TINT = Rgba8(255, 255, 255, 127);
 
 	DebugRenderConfig s_config;
 	bool s_isVisible = true;
 	BitmapFont* s_font = nullptr;
 
+	double GetDebugRenderTime()
+	{
+		Clock const& clock = s_config.m_clock ? *s_config.m_clock : Clock::GetSystemClock();
+		return clock.GetTotalSeconds();
+	}
+
 	struct DebugRenderObject
 	{
 	public:
 		DebugRenderObject(Rgba8 const& startColor = Rgba8::OPAQUE_WHITE, Rgba8 const& endColor = Rgba8::OPAQUE_WHITE, float duration = -1.f, DebugRenderMode mode = DebugRenderMode::USE_DEPTH);
 
-		void Render(Camera const& camera) const;
-		bool IsFinished() const;
+		// Objects are recycled, this keeps the capacity of m_vertexs
+		void Reset(Rgba8 const& startColor, Rgba8 const& endColor, float duration, DebugRenderMode mode);
+		bool IsFinished(double currentTime) const;
 		bool IsPriorMessage() const;
+		Rgba8 GetColor(double currentTime) const;
 
 	public:
 		Rgba8 m_startColor = Rgba8::OPAQUE_WHITE;
 		Rgba8 m_endColor = Rgba8::OPAQUE_WHITE;
 		float m_duration = -1.f;
 		DebugRenderMode m_mode = DebugRenderMode::USE_DEPTH;
-
-		Timer m_timer;
+		double m_startTime = 0.0;
 
 		std::vector<Vertex_PCU> m_vertexs;
 		Texture* m_texture = nullptr;
 		RasterizerMode m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
 		bool m_isBillboard = false;
-		//bool m_isScreenText = false; // not used?
 
 		Vec3 m_origin; // billboard and text need this
 	};
 
 	DebugRenderObject::DebugRenderObject(Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, float duration /*= -1.f*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
-		: m_startColor(startColor)
-		, m_endColor(endColor)
-		, m_duration(duration)
-		, m_mode(mode)
 	{
-		if (m_duration >= 0.f)
+		Reset(startColor, endColor, duration, mode);
+	}
+
+	void DebugRenderObject::Reset(Rgba8 const& startColor, Rgba8 const& endColor, float duration, DebugRenderMode mode)
+	{
+		m_startColor = startColor;
+		m_endColor = endColor;
+		m_duration = duration;
+		m_mode = mode;
+		m_startTime = GetDebugRenderTime();
+		m_vertexs.clear();
+		m_texture = nullptr;
+		m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
+		m_isBillboard = false;
+		m_origin = Vec3();
+	}
+
+	bool DebugRenderObject::IsFinished(double currentTime) const
+	{
+		if (m_duration < 0.f)
 		{
-			m_timer.m_period = m_duration;
-			m_timer.Start();
+			return false;
 		}
+		return currentTime - m_startTime > m_duration;
 	}
 
-	void DebugRenderObject::Render(Camera const& camera) const
+	bool DebugRenderObject::IsPriorMessage() const
 	{
-		if (IsFinished())
+		// Infinite and One frame
+		return m_duration <= 0.f;
+	}
+
+	Rgba8 DebugRenderObject::GetColor(double currentTime) const
+	{
+		if (m_duration <= 0.f)
 		{
-			return;
+			return m_startColor;
 		}
+		return Interpolate(m_startColor, m_endColor, GetClampedZeroToOne(static_cast<float>((currentTime - m_startTime) / m_duration)));
+	}
 
-		// Calculate the transform
-		Mat44 transform;
-		transform.SetTranslation3D(m_origin);
-		if (m_isBillboard)
+	//-----------------------------------------------------------------------------------------------
+	// Live objects plus their expiry buckets. Removing the objects of a bucket that has fully passed
+	// costs O(1) per object, whatever else is alive
+	struct DebugRenderList
+	{
+	public:
+		DebugRenderObject& Add(Rgba8 const& startColor, Rgba8 const& endColor, float duration, DebugRenderMode mode);
+		void RemoveExpired(double currentTime);
+		void Clear();
+
+	public:
+		SlotMap<DebugRenderObject> m_objects;
+		std::unordered_map<int64_t, std::vector<SlotHandle>> m_expiryBuckets;
+		int64_t m_nextBucketToExpire = 0;
+	};
+
+	DebugRenderObject& DebugRenderList::Add(Rgba8 const& startColor, Rgba8 const& endColor, float duration, DebugRenderMode mode)
+	{
+		SlotHandle handle = m_objects.Add();
+		DebugRenderObject& obj = *m_objects.Get(handle);
+		obj.Reset(startColor, endColor, duration, mode);
+
+		if (duration >= 0.f)
 		{
-			transform = GetBillboardTransform(BillboardType::FULL_OPPOSING, camera.GetCameraToWorldTransform(), m_origin);
+			int64_t bucket = static_cast<int64_t>(floor((obj.m_startTime + duration) / EXPIRY_BUCKET_SECONDS));
+			if (m_expiryBuckets.empty() || bucket < m_nextBucketToExpire)
+			{
+				m_nextBucketToExpire = bucket;
+			}
+			m_expiryBuckets[bucket].push_back(handle);
 		}
+		return obj;
+	}
 
+	void DebugRenderList::RemoveExpired(double currentTime)
+	{
+		// Only buckets that ended before now are certain to hold nothing but finished objects. The
+		// ones in the current bucket are skipped while rendering until their bucket goes
+		int64_t lastPassedBucket = static_cast<int64_t>(floor(currentTime / EXPIRY_BUCKET_SECONDS)) - 1;
+		if (m_expiryBuckets.empty() || lastPassedBucket < m_nextBucketToExpire)
+		{
+			return;
+		}
 
-		// Calculate the color
-		Rgba8 color;
-		if (m_duration <= 0.f)
+		if (lastPassedBucket - m_nextBucketToExpire < static_cast<int64_t>(m_expiryBuckets.size()))
 		{
-			color = m_startColor;
+			for (int64_t bucket = m_nextBucketToExpire; bucket <= lastPassedBucket; ++bucket)
+			{
+				auto found = m_expiryBuckets.find(bucket);
+				if (found != m_expiryBuckets.end())
+				{
+					for (SlotHandle handle : found->second)
+					{
+						m_objects.Remove(handle);
+					}
+					m_expiryBuckets.erase(found);
+				}
+			}
 		}
 		else
 		{
-			color = Interpolate(m_startColor, m_endColor, GetClampedZeroToOne((float)m_timer.GetElapsedFraction()));
+			// The clock jumped further than there are buckets, walk the buckets instead
+			for (auto bucketIter = m_expiryBuckets.begin(); bucketIter != m_expiryBuckets.end();)
+			{
+				if (bucketIter->first <= lastPassedBucket)
+				{
+					for (SlotHandle handle : bucketIter->second)
+					{
+						m_objects.Remove(handle);
+					}
+					bucketIter = m_expiryBuckets.erase(bucketIter);
+				}
+				else
+				{
+					++bucketIter;
+				}
+			}
 		}
+		m_nextBucketToExpire = lastPassedBucket + 1;
+	}
 
-#ifdef ENGINE_RENDER_D3D11
-		s_config.m_renderer->BindTexture(m_texture); // font or white texture
-		s_config.m_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-#endif // ENGINE_RENDER_D3D11
+	void DebugRenderList::Clear()
+	{
+		m_objects.Clear();
+		m_expiryBuckets.clear();
+	}
 
-#ifdef ENGINE_RENDER_D3D12
-		UnlitRenderResources resources;
-		resources.diffuseTextureIndex = s_config.m_renderer->GetSrvIndexFromLoadedTexture(m_texture);
-		resources.diffuseSamplerIndex = s_config.m_renderer->GetDefaultSamplerIndex(SamplerMode::POINT_CLAMP);
-		resources.cameraConstantsIndex = s_config.m_renderer->GetCurrentCameraConstantsIndex();
-#endif // ENGINE_RENDER_D3D12
+	DebugRenderList s_worldGeometry;
+	DebugRenderList s_screenGeometry;
+	std::vector<DebugRenderObject> s_screenMessage;
 
-		s_config.m_renderer->SetModelConstants(transform, color);
-#ifdef ENGINE_RENDER_D3D12
-		resources.modelConstantsIndex = s_config.m_renderer->GetCurrentModelConstantsIndex();
-#endif // ENGINE_RENDER_D3D12
+	void RemoveFinishedDebugRenderObjects(std::vector<DebugRenderObject>& vec)
+	{
+		double currentTime = GetDebugRenderTime();
+		vec.erase(
+			std::remove_if(vec.begin(), vec.end(),
+				[currentTime](DebugRenderObject const& obj) -> bool {return obj.IsFinished(currentTime); }),
+			vec.end()
+		);
+	}
 
-#ifdef ENGINE_RENDER_D3D12
-			s_config.m_renderer->SetGraphicsBindlessResources(sizeof(UnlitRenderResources), &resources);
-#endif // ENGINE_RENDER_D3D12
+	//-----------------------------------------------------------------------------------------------
+	// Everything drawn with the same mode, texture and rasterizer mode goes into one vertex stream,
+	// in world space with the object color already multiplied in, and is drawn with one call
+	struct DebugRenderBatch
+	{
+		DebugRenderMode m_mode = DebugRenderMode::USE_DEPTH;
+		Texture* m_texture = nullptr;
+		RasterizerMode m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
+		std::vector<Vertex_PCU> m_verts;
+	};
 
-		s_config.m_renderer->BindShader(nullptr);
-		s_config.m_renderer->SetRasterizerMode(m_rasterizerMode); // some draw are wired
+	std::vector<DebugRenderBatch> s_batches;
 
-		if (m_mode == DebugRenderMode::ALWAYS)
+	void ClearBatches()
+	{
+		for (DebugRenderBatch& batch : s_batches)
 		{
-			s_config.m_renderer->SetBlendMode(BlendMode::ALPHA);
-			s_config.m_renderer->SetDepthMode(DepthMode::DISABLED);
-			s_config.m_renderer->SetRenderTargetFormats();
-			s_config.m_renderer->DrawVertexArray(m_vertexs);
+			batch.m_verts.clear();
 		}
-		else if (m_mode == DebugRenderMode::USE_DEPTH)
+	}
+
+	std::vector<Vertex_PCU>& GetBatchVerts(DebugRenderObject const& obj)
+	{
+		for (DebugRenderBatch& batch : s_batches)
 		{
-			s_config.m_renderer->SetBlendMode(BlendMode::ALPHA);
-			s_config.m_renderer->SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
-			s_config.m_renderer->SetRenderTargetFormats();
+			if (batch.m_mode == obj.m_mode && batch.m_texture == obj.m_texture && batch.m_rasterizerMode == obj.m_rasterizerMode)
+			{
+				return batch.m_verts;
+			}
+		}
 
-			s_config.m_renderer->DrawVertexArray(m_vertexs);
+		s_batches.emplace_back();
+		DebugRenderBatch& batch = s_batches.back();
+		batch.m_mode = obj.m_mode;
+		batch.m_texture = obj.m_texture;
+		batch.m_rasterizerMode = obj.m_rasterizerMode;
+		return batch.m_verts;
+	}
 
+	unsigned char MultiplyColorByte(unsigned char a, unsigned char b)
+	{
+		return static_cast<unsigned char>((static_cast<unsigned int>(a) * b + 127) / 255);
+	}
+
+	void AddObjectToBatch(DebugRenderObject const& obj, double currentTime, Camera const& camera)
+	{
+		if (obj.IsFinished(currentTime) || obj.m_vertexs.empty())
+		{
+			return;
 		}
-		else if (m_mode == DebugRenderMode::X_RAY)
+
+		Rgba8 color = obj.GetColor(currentTime);
+		bool hasTint = !(color == Rgba8::OPAQUE_WHITE);
+		bool hasTransform = obj.m_isBillboard || obj.m_origin != Vec3();
+
+		Mat44 transform;
+		transform.SetTranslation3D(obj.m_origin);
+		if (obj.m_isBillboard)
 		{
-			Rgba8 xRayColor(color.r, color.g, color.b, color.a / 2);
-			s_config.m_renderer->SetModelConstants(transform, xRayColor);
-#ifdef ENGINE_RENDER_D3D12
-			resources.modelConstantsIndex = s_config.m_renderer->GetCurrentModelConstantsIndex();
-#endif // ENGINE_RENDER_D3D12
-			s_config.m_renderer->SetBlendMode(BlendMode::ALPHA);
-			s_config.m_renderer->SetDepthMode(DepthMode::READ_ONLY_ALWAYS);
-			s_config.m_renderer->SetRenderTargetFormats();
-#ifdef ENGINE_RENDER_D3D12
-			s_config.m_renderer->SetGraphicsBindlessResources(sizeof(UnlitRenderResources), &resources);
-#endif // ENGINE_RENDER_D3D12
-			s_config.m_renderer->DrawVertexArray(m_vertexs);
+			transform = GetBillboardTransform(BillboardType::FULL_OPPOSING, camera.GetCameraToWorldTransform(), obj.m_origin);
+		}
 
-			s_config.m_renderer->SetModelConstants(transform, color);
-#ifdef ENGINE_RENDER_D3D12
-			resources.modelConstantsIndex = s_config.m_renderer->GetCurrentModelConstantsIndex();
-#endif // ENGINE_RENDER_D3D12
+		std::vector<Vertex_PCU>& batchVerts = GetBatchVerts(obj);
+		size_t firstVert = batchVerts.size();
+		batchVerts.insert(batchVerts.end(), obj.m_vertexs.begin(), obj.m_vertexs.end());
+		if (!hasTint && !hasTransform)
+		{
+			return;
+		}
+
+		for (size_t vertIndex = firstVert; vertIndex < batchVerts.size(); ++vertIndex)
+		{
+			Vertex_PCU& vert = batchVerts[vertIndex];
+			if (hasTransform)
+			{
+				vert.m_position = transform.TransformPosition3D(vert.m_position);
+			}
+			if (hasTint)
+			{
+				vert.m_color = Rgba8(MultiplyColorByte(vert.m_color.r, color.r), MultiplyColorByte(vert.m_color.g, color.g),
+					MultiplyColorByte(vert.m_color.b, color.b), MultiplyColorByte(vert.m_color.a, color.a));
+			}
+		}
+	}
+
+	void DrawBatchPass(DebugRenderBatch const& batch, BlendMode blendMode, DepthMode depthMode, Rgba8 const& tint, RenderState& inout_previousState, bool& inout_hasPreviousState)
+	{
+		RenderState state;
+		state.m_texture = batch.m_texture; // font or white texture
+		state.m_samplerMode = SamplerMode::POINT_CLAMP;
+		if (s_font->IsSDF() && batch.m_texture == &s_font->GetTexture())
+		{
+			state.m_shader = s_config.m_renderer->CreateOrGetShader(ShaderConfig(SDF_TEXT_SHADER_NAME));
+			state.m_samplerMode = SamplerMode::BILINEAR_CLAMP;
+		}
+		state.m_rasterizerMode = batch.m_rasterizerMode; // some draw are wired
+		state.m_blendMode = blendMode;
+		state.m_depthMode = depthMode;
 
-			s_config.m_renderer->SetBlendMode(BlendMode::OPAQUE);
-			s_config.m_renderer->SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
-			s_config.m_renderer->SetRenderTargetFormats();
+		BindRenderState(s_config.m_renderer, state, inout_hasPreviousState ? &inout_previousState : nullptr);
+		s_config.m_renderer->SetRenderTargetFormats();
+		s_config.m_renderer->SetModelConstants(Mat44(), tint);
 #ifdef ENGINE_RENDER_D3D12
-			s_config.m_renderer->SetGraphicsBindlessResources(sizeof(UnlitRenderResources), &resources);
+		SetUnlitBindlessResources(s_config.m_renderer, state);
 #endif // ENGINE_RENDER_D3D12
-			s_config.m_renderer->DrawVertexArray(m_vertexs);
+		s_config.m_renderer->DrawVertexArray(batch.m_verts);
+
+		inout_previousState = state;
+		inout_hasPreviousState = true;
+	}
+
+	// Depth tested batches first, so always-on-top geometry really ends up on top
+	void DrawBatches()
+	{
+		DebugRenderMode const modeOrder[] = { DebugRenderMode::USE_DEPTH, DebugRenderMode::X_RAY, DebugRenderMode::ALWAYS };
+		RenderState previousState;
+		bool hasPreviousState = false;
+		for (DebugRenderMode mode : modeOrder)
+		{
+			for (DebugRenderBatch const& batch : s_batches)
+			{
+				if (batch.m_mode != mode || batch.m_verts.empty())
+				{
+					continue;
+				}
+
+				if (mode == DebugRenderMode::ALWAYS)
+				{
+					DrawBatchPass(batch, BlendMode::ALPHA, DepthMode::DISABLED, Rgba8::OPAQUE_WHITE, previousState, hasPreviousState);
+				}
+				else if (mode == DebugRenderMode::USE_DEPTH)
+				{
+					DrawBatchPass(batch, BlendMode::ALPHA, DepthMode::READ_WRITE_LESS_EQUAL, Rgba8::OPAQUE_WHITE, previousState, hasPreviousState);
+				}
+				else if (mode == DebugRenderMode::X_RAY)
+				{
+					// Faded pass through walls, then the normal depth tested pass
+					DrawBatchPass(batch, BlendMode::ALPHA, DepthMode::READ_ONLY_ALWAYS, X_RAY_TINT, previousState, hasPreviousState);
+					DrawBatchPass(batch, BlendMode::OPAQUE, DepthMode::READ_WRITE_LESS_EQUAL, Rgba8::OPAQUE_WHITE, previousState, hasPreviousState);
+				}
+			}
 		}
 	}
 
-	bool DebugRenderObject::IsFinished() const
+	//-----------------------------------------------------------------------------------------------
+	// Unit shapes built once and placed with a transform, instead of redoing the trig on every add.
+	// Cylinder and cone run from the origin to +X with radius 1, the sphere has radius 1
+	std::vector<Vertex_PCU> const& GetUnitSphereVerts()
 	{
-		if (m_duration < 0.f)
+		static std::vector<Vertex_PCU> s_unitSphere;
+		if (s_unitSphere.empty())
 		{
-			return false;
+			AddVertsForSphere3D(s_unitSphere, Vec3(), 1.f);
 		}
-		return m_timer.HasPeriodElapsed();
+		return s_unitSphere;
 	}
 
-	bool DebugRenderObject::IsPriorMessage() const
+	std::vector<Vertex_PCU> const& GetUnitCylinderVerts()
 	{
-		// Infinite and One frame
-		return m_duration <= 0.f;
+		static std::vector<Vertex_PCU> s_unitCylinder;
+		if (s_unitCylinder.empty())
+		{
+			AddVertsForCylinder3D(s_unitCylinder, Vec3(), Vec3(1.f, 0.f, 0.f), 1.f);
+		}
+		return s_unitCylinder;
 	}
 
-	std::vector<DebugRenderObject> s_worldGeometry;
-	std::vector<DebugRenderObject> s_screenGeometry;
-	std::vector<DebugRenderObject> s_screenMessage;
+	std::vector<Vertex_PCU> const& GetUnitConeVerts()
+	{
+		static std::vector<Vertex_PCU> s_unitCone;
+		if (s_unitCone.empty())
+		{
+			AddVertsForCone3D(s_unitCone, Vec3(), Vec3(1.f, 0.f, 0.f), 1.f);
+		}
+		return s_unitCone;
+	}
 
-	void RemoveFinishedDebugRenderObjects(std::vector<DebugRenderObject>& vec)
+	void AddTransformedUnitVerts(std::vector<Vertex_PCU>& verts, std::vector<Vertex_PCU> const& unitVerts, Mat44 const& transform, Rgba8 const& color)
 	{
-		vec.erase(
-			std::remove_if(vec.begin(), vec.end(),
-				[](DebugRenderObject const& obj) -> bool {return obj.IsFinished(); }),
-			vec.end()
-		);
+		size_t firstVert = verts.size();
+		verts.resize(firstVert + unitVerts.size());
+		for (size_t vertIndex = 0; vertIndex < unitVerts.size(); ++vertIndex)
+		{
+			Vertex_PCU& vert = verts[firstVert + vertIndex];
+			vert.m_position = transform.TransformPosition3D(unitVerts[vertIndex].m_position);
+			vert.m_color = color;
+			vert.m_uvTexCoords = unitVerts[vertIndex].m_uvTexCoords;
+		}
+	}
+
+	void AddVertsForDebugSphere(std::vector<Vertex_PCU>& verts, Vec3 const& center, float radius, Rgba8 const& color = Rgba8::OPAQUE_WHITE)
+	{
+		Mat44 transform(Vec3(radius, 0.f, 0.f), Vec3(0.f, radius, 0.f), Vec3(0.f, 0.f, radius), center);
+		AddTransformedUnitVerts(verts, GetUnitSphereVerts(), transform, color);
+	}
+
+	// Same frame as AddVertsForCylinder3D and AddVertsForCone3D build around start to end
+	void AddVertsForDebugSegmentShape(std::vector<Vertex_PCU>& verts, std::vector<Vertex_PCU> const& unitVerts, Vec3 const& start, Vec3 const& end, float radius, Rgba8 const& color)
+	{
+		Vec3 displacement = end - start;
+		float length = displacement.GetLength();
+		if (length <= 0.f)
+		{
+			return;
+		}
+		Mat44 localSpace = Mat44::MakeFromX(displacement);
+		Mat44 transform(localSpace.GetIBasis3D() * length, localSpace.GetJBasis3D() * radius, localSpace.GetKBasis3D() * radius, start);
+		AddTransformedUnitVerts(verts, unitVerts, transform, color);
+	}
+
+	void AddVertsForDebugCylinder(std::vector<Vertex_PCU>& verts, Vec3 const& start, Vec3 const& end, float radius, Rgba8 const& color = Rgba8::OPAQUE_WHITE)
+	{
+		AddVertsForDebugSegmentShape(verts, GetUnitCylinderVerts(), start, end, radius, color);
+	}
+
+	// Proportions of AddVertsForArrow3D
+	void AddVertsForDebugArrow(std::vector<Vertex_PCU>& verts, Vec3 const& start, Vec3 const& end, float radius, Rgba8 const& color = Rgba8::OPAQUE_WHITE)
+	{
+		Vec3 arrowVec = end - start;
+		float arrowLength = arrowVec.GetLength();
+		Vec3 direction = arrowVec.GetNormalized();
+
+		float coneRadius = 2.f * radius;
+		float coneHeight = 3.236f * coneRadius;
+		if (coneHeight > (arrowLength * 0.382f))
+		{
+			coneHeight = arrowLength * 0.382f;
+		}
+		Vec3 coneStart = start + direction * (arrowLength - coneHeight);
+
+		AddVertsForDebugSegmentShape(verts, GetUnitCylinderVerts(), start, coneStart, radius, color);
+		AddVertsForDebugSegmentShape(verts, GetUnitConeVerts(), coneStart, end, coneRadius, color);
 	}
 }
 
@@ -194,7 +447,8 @@ void DebugRenderSystemStartup(const DebugRenderConfig& config)
 	s_config = config;
 	g_theEventSystem->SubscribeEventCallbackFunction("DebugRenderClear", Command_DebugRenderClear);
 	g_theEventSystem->SubscribeEventCallbackFunction("DebugRenderToggle", Command_DebugRenderToggle);
-	s_font = s_config.m_renderer->CreateOrGetBitmapFont((s_config.m_fontPath + s_config.m_fontName).c_str());
+	std::string fontPath = s_config.m_fontPath + s_config.m_fontName;
+	s_font = s_config.m_useSDFFont ? s_config.m_renderer->CreateOrGetSDFFont(fontPath.c_str()) : s_config.m_renderer->CreateOrGetBitmapFont(fontPath.c_str());
 }
 
 void DebugRenderSystemShutdown()
@@ -219,20 +473,41 @@ void DebugRenderSetHidden()
 
 void DebugRenderClear()
 {
-	s_worldGeometry.clear();
-	s_screenGeometry.clear();
+	s_worldGeometry.Clear();
+	s_screenGeometry.Clear();
 	s_screenMessage.clear();
 }
+
+int DebugRenderGetNumWorldObjects()
+{
+	return s_worldGeometry.m_objects.GetCount();
+}
+
+int DebugRenderGetNumScreenObjects()
+{
+	return s_screenGeometry.m_objects.GetCount();
+}
 #pragma endregion
 
 //-----------------------------------------------------------------------------------------------
 #pragma region Output
 void DebugRenderBeginFrame()
 {
+	if (ProfilerIsOverlayVisible())
+	{
+		// One frame messages, rebuilt from the summary of the frame that just ended
+		Strings profilerLines;
+		ProfilerGetSummaryLines(profilerLines);
+		for (int lineIndex = 0; lineIndex < static_cast<int>(profilerLines.size()); ++lineIndex)
+		{
+			DebugAddMessage(profilerLines[lineIndex], 0.f, (lineIndex == 0) ? Rgba8::YELLOW : Rgba8::OPAQUE_WHITE, (lineIndex == 0) ? Rgba8::YELLOW : Rgba8::OPAQUE_WHITE);
+		}
+	}
 }
 
 void DebugRenderWorld(Camera const& camera)
 {
+	PROFILE_SCOPE("DebugRenderWorld");
 	if (!s_isVisible)
 	{
 		return;
@@ -240,11 +515,14 @@ void DebugRenderWorld(Camera const& camera)
 
 	s_config.m_renderer->BeginCamera(camera);
 	s_config.m_renderer->BeginRenderEvent("DebugRenderWorld");
-	int worldGeometryNum = static_cast<int>(s_worldGeometry.size());
+	double currentTime = GetDebugRenderTime();
+	ClearBatches();
+	int worldGeometryNum = s_worldGeometry.m_objects.GetCount();
 	for (int index = 0; index < worldGeometryNum; ++index)
 	{
-		s_worldGeometry[index].Render(camera);
+		AddObjectToBatch(s_worldGeometry.m_objects.GetAtDenseIndex(index), currentTime, camera);
 	}
+	DrawBatches();
 
 	s_config.m_renderer->EndRenderEvent("DebugRenderWorld");
 	s_config.m_renderer->EndCamera(camera);
@@ -252,6 +530,7 @@ void DebugRenderWorld(Camera const& camera)
 
 void DebugRenderScreen(Camera const& camera)
 {
+	PROFILE_SCOPE("DebugRenderScreen");
 	GUARANTEE_OR_DIE(camera.IsMode(Camera::Mode::eMode_Orthographic), "Debug Render Screen Camera is not orthographic!");
 	if (!s_isVisible)
 	{
@@ -261,10 +540,12 @@ void DebugRenderScreen(Camera const& camera)
 	s_config.m_renderer->BeginCamera(camera);
 	s_config.m_renderer->BeginRenderEvent("DebugRenderScreen");
 	//-----------------------------------------------------------------------------------------------
-	int screenGeometryNum = static_cast<int>(s_screenGeometry.size());
+	double currentTime = GetDebugRenderTime();
+	ClearBatches();
+	int screenGeometryNum = s_screenGeometry.m_objects.GetCount();
 	for (int index = 0; index < screenGeometryNum; ++index)
 	{
-		s_screenGeometry[index].Render(camera);
+		AddObjectToBatch(s_screenGeometry.m_objects.GetAtDenseIndex(index), currentTime, camera);
 	}
 
 	//-----------------------------------------------------------------------------------------------
@@ -276,7 +557,7 @@ void DebugRenderScreen(Camera const& camera)
 	for (int index = 0; index < screenMessageNum; ++index)
 	{
 		DebugRenderObject& currentMessage = s_screenMessage[index];
-		if (currentMessage.IsPriorMessage() && !currentMessage.IsFinished())
+		if (currentMessage.IsPriorMessage() && !currentMessage.IsFinished(currentTime))
 		{
 			currentMessage.m_origin = Vec3(cameraBounds.m_mins.x + messageMargin, 
 				cameraBounds.m_maxs.y - static_cast<float>(messageSlot) * (s_config.m_messageCellHeight + 2.f * messageMargin), 
@@ -289,7 +570,7 @@ void DebugRenderScreen(Camera const& camera)
 	for (int index = 0; index < screenMessageNum; ++index)
 	{
 		DebugRenderObject& currentMessage = s_screenMessage[index];
-		if (!currentMessage.IsPriorMessage() && !currentMessage.IsFinished())
+		if (!currentMessage.IsPriorMessage() && !currentMessage.IsFinished(currentTime))
 		{
 			currentMessage.m_origin = Vec3(cameraBounds.m_mins.x + messageMargin,
 				cameraBounds.m_maxs.y - static_cast<float>(messageSlot) * (s_config.m_messageCellHeight + 2.f * messageMargin),
@@ -300,8 +581,9 @@ void DebugRenderScreen(Camera const& camera)
 
 	for (int index = 0; index < screenMessageNum; ++index)
 	{
-		s_screenMessage[index].Render(camera);
+		AddObjectToBatch(s_screenMessage[index], currentTime, camera);
 	}
+	DrawBatches();
 
 	//-----------------------------------------------------------------------------------------------
 	s_config.m_renderer->EndRenderEvent("DebugRenderScreen");
@@ -310,8 +592,10 @@ void DebugRenderScreen(Camera const& camera)
 
 void DebugRenderEndFrame()
 {
-	RemoveFinishedDebugRenderObjects(s_worldGeometry);
-	RemoveFinishedDebugRenderObjects(s_screenGeometry);
+	PROFILE_SCOPE("DebugRenderEndFrame");
+	double currentTime = GetDebugRenderTime();
+	s_worldGeometry.RemoveExpired(currentTime);
+	s_screenGeometry.RemoveExpired(currentTime);
 	RemoveFinishedDebugRenderObjects(s_screenMessage);
 }
 
@@ -322,69 +606,60 @@ void DebugRenderEndFrame()
 #pragma region Geometry
 void DebugAddWorldWirePenumbraNoneCull(Vec3 const& center, Vec3 const& fwdNormal, float radius, float penumbraDot, float duration, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
 	AddVertsForPenumbra3D(obj.m_vertexs, center, fwdNormal, radius, penumbraDot);
 	obj.m_rasterizerMode = RasterizerMode::WIREFRAME_CULL_NONE;
 }
 
 void DebugAddWorldSphere(Vec3 const& center, float radius, float duration, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
-	AddVertsForSphere3D(obj.m_vertexs, center, radius);
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
+	AddVertsForDebugSphere(obj.m_vertexs, center, radius);
 }
 
 void DebugAddWorldWireSphere(Vec3 const& center, float radius, float duration, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
-	AddVertsForSphere3D(obj.m_vertexs, center, radius);
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
+	AddVertsForDebugSphere(obj.m_vertexs, center, radius);
 	obj.m_rasterizerMode = RasterizerMode::WIREFRAME_CULL_BACK;
 }
 
 void DebugAddWorldWireSphereNoneCull(Vec3 const& center, float radius, float duration, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
-	AddVertsForSphere3D(obj.m_vertexs, center, radius);
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
+	AddVertsForDebugSphere(obj.m_vertexs, center, radius);
 	obj.m_rasterizerMode = RasterizerMode::WIREFRAME_CULL_NONE;
 }
 
 void DebugAddWorldCylinder(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
-	AddVertsForCylinder3D(obj.m_vertexs, start, end, radius);
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
+	AddVertsForDebugCylinder(obj.m_vertexs, start, end, radius);
 }
 
 void DebugAddWorldWireCylinder(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
-	AddVertsForCylinder3D(obj.m_vertexs, start, end, radius);
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
+	AddVertsForDebugCylinder(obj.m_vertexs, start, end, radius);
 	obj.m_rasterizerMode = RasterizerMode::WIREFRAME_CULL_BACK;
 }
 
 void DebugAddWorldArrow(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
-	AddVertsForArrow3D(obj.m_vertexs, start, end, radius);
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
+	AddVertsForDebugArrow(obj.m_vertexs, start, end, radius);
 }
 
 void DebugAddWorldWireArrow(Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
-	AddVertsForArrow3D(obj.m_vertexs, start, end, radius);
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
+	AddVertsForDebugArrow(obj.m_vertexs, start, end, radius);
 	obj.m_rasterizerMode = RasterizerMode::WIREFRAME_CULL_BACK;
 }
 
 void DebugAddBasis(Mat44 const& transform, float duration, float length, float radius, float colorScale /*= 1.0f*/, float alphaScale /*= 1.0f*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(Rgba8::OPAQUE_WHITE, Rgba8::OPAQUE_WHITE, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
+	DebugRenderObject& obj = s_worldGeometry.Add(Rgba8::OPAQUE_WHITE, Rgba8::OPAQUE_WHITE, duration, mode);
 
 	Vec3 iBasis = transform.GetIBasis3D();
 	Vec3 jBasis = transform.GetJBasis3D();
@@ -394,32 +669,30 @@ void DebugAddBasis(Mat44 const& transform, float duration, float length, float r
 	unsigned char colorValue = DenormalizeByte(colorScale);
 	unsigned char alphaValue = DenormalizeByte(alphaScale);
 
-	AddVertsForArrow3D(obj.m_vertexs, translation, translation + iBasis * length, radius, Rgba8(colorValue, 0, 0, alphaValue));
-	AddVertsForArrow3D(obj.m_vertexs, translation, translation + jBasis * length, radius, Rgba8(0, colorValue, 0, alphaValue));
-	AddVertsForArrow3D(obj.m_vertexs, translation, translation + kBasis * length, radius, Rgba8(0, 0, colorValue, alphaValue));
+	AddVertsForDebugArrow(obj.m_vertexs, translation, translation + iBasis * length, radius, Rgba8(colorValue, 0, 0, alphaValue));
+	AddVertsForDebugArrow(obj.m_vertexs, translation, translation + jBasis * length, radius, Rgba8(0, colorValue, 0, alphaValue));
+	AddVertsForDebugArrow(obj.m_vertexs, translation, translation + kBasis * length, radius, Rgba8(0, 0, colorValue, alphaValue));
 }
 
 void DebugAddWorldBasis(Mat44 const& transform, float duration, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
 	constexpr float LENGTH = 1.f;
 	constexpr float RADIUS = 0.075f;
-	s_worldGeometry.emplace_back(Rgba8::OPAQUE_WHITE, Rgba8::OPAQUE_WHITE, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
+	DebugRenderObject& obj = s_worldGeometry.Add(Rgba8::OPAQUE_WHITE, Rgba8::OPAQUE_WHITE, duration, mode);
 
 	Vec3 iBasis = transform.GetIBasis3D();
 	Vec3 jBasis = transform.GetJBasis3D();
 	Vec3 kBasis = transform.GetKBasis3D();
 	Vec3 translation = transform.GetTranslation3D();
 
-	AddVertsForArrow3D(obj.m_vertexs, translation, translation + iBasis * LENGTH, RADIUS, Rgba8::RED);
-	AddVertsForArrow3D(obj.m_vertexs, translation, translation + jBasis * LENGTH, RADIUS, Rgba8::GREEN);
-	AddVertsForArrow3D(obj.m_vertexs, translation, translation + kBasis * LENGTH, RADIUS, Rgba8::BLUE);
+	AddVertsForDebugArrow(obj.m_vertexs, translation, translation + iBasis * LENGTH, RADIUS, Rgba8::RED);
+	AddVertsForDebugArrow(obj.m_vertexs, translation, translation + jBasis * LENGTH, RADIUS, Rgba8::GREEN);
+	AddVertsForDebugArrow(obj.m_vertexs, translation, translation + kBasis * LENGTH, RADIUS, Rgba8::BLUE);
 }
 
 void DebugAddWorldText(std::string const& text, Mat44 const& transform, float textHeight, float duration, float cellAspect /*= 1.0f*/, Vec2 const& alignment /*= Vec2(0.5f, 0.5f)*/, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
 	s_font->AddVertsForText3DAtOriginXForward(obj.m_vertexs, textHeight, text, Rgba8::OPAQUE_WHITE, cellAspect, alignment);
 	TransformVertexArray3D(obj.m_vertexs, transform);
 	obj.m_texture = &s_font->GetTexture();
@@ -428,8 +701,7 @@ void DebugAddWorldText(std::string const& text, Mat44 const& transform, float te
 
 void DebugAddWorldBillboardText(std::string const& text, Vec3 const& origin, float textHeight, float duration, float cellAspect /*= 1.0f*/, Vec2 const& alignment /*= Vec2(0.5f, 0.5f)*/, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/, DebugRenderMode mode /*= DebugRenderMode::USE_DEPTH*/)
 {
-	s_worldGeometry.emplace_back(startColor, endColor, duration, mode);
-	DebugRenderObject& obj = s_worldGeometry.back();
+	DebugRenderObject& obj = s_worldGeometry.Add(startColor, endColor, duration, mode);
 	s_font->AddVertsForText3DAtOriginXForward(obj.m_vertexs, textHeight, text, Rgba8::OPAQUE_WHITE, cellAspect, alignment);
 	obj.m_texture = &s_font->GetTexture();
 	obj.m_isBillboard = true;
@@ -439,8 +711,7 @@ void DebugAddWorldBillboardText(std::string const& text, Vec3 const& origin, flo
 
 void DebugAddScreenText(std::string const& text, AABB2 const& box, float cellHeight, Vec2 const& alignment, float duration, float cellAspect /*= 1.0f*/, Rgba8 const& startColor /*= Rgba8::OPAQUE_WHITE*/, Rgba8 const& endColor /*= Rgba8::OPAQUE_WHITE*/)
 {
-	s_screenGeometry.emplace_back(startColor, endColor, duration, DebugRenderMode::ALWAYS);
-	DebugRenderObject& obj = s_screenGeometry.back();
+	DebugRenderObject& obj = s_screenGeometry.Add(startColor, endColor, duration, DebugRenderMode::ALWAYS);
 	s_font->AddVertsForTextInBox2D(obj.m_vertexs, text, box, cellHeight, Rgba8::OPAQUE_WHITE, cellAspect, alignment);
 	obj.m_texture = &s_font->GetTexture();
 	//obj.m_isScreenText = true;
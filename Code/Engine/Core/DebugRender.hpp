@@ -7,6 +7,7 @@
 //-----------------------------------------------------------------------------------------------
 class Renderer;
 class Camera;
+class Clock;
 
 struct Vec2;
 struct Vec3;
@@ -23,8 +24,10 @@ enum class DebugRenderMode
 struct DebugRenderConfig
 {
 	Renderer* m_renderer = nullptr;
+	Clock* m_clock = nullptr; // durations and fades run on it, nullptr is the system clock
 	std::string m_fontPath = "Data/Fonts/";
 	std::string m_fontName = "SquirrelFixedFont";
+	bool m_useSDFFont = false; // one distance field atlas for every text height
 
 
 	float m_messageCellHeight = 20.f; // 800 / 40 lines
@@ -39,6 +42,9 @@ void DebugRenderSystemShutdown();
 void DebugRenderSetVisible();
 void DebugRenderSetHidden();
 void DebugRenderClear();
+// Objects still held, a finished one counts until DebugRenderEndFrame drops its expiry bucket
+int DebugRenderGetNumWorldObjects();
+int DebugRenderGetNumScreenObjects();
 
 // Output
 void DebugRenderBeginFrame();
@@ -4,10 +4,12 @@
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/Timer.hpp"
-#include "Engine/Input/InputSystem.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
+#if !defined(ENGINE_HEADLESS)
+#include "Engine/Input/InputSystem.hpp"
+#endif
 
 
 //-----------------------------------------------------------------------------------------------
@@ -22,6 +24,7 @@ const Rgba8 DevConsole::INFO_TEXT = Rgba8(200, 200, 200);
 const Rgba8 DevConsole::INFO_INSERTION_POINT = Rgba8(255, 255, 255);
 const Rgba8 DevConsole::INFO_ENTERED_TEXT = Rgba8(255, 0, 255);
 
+#if !defined(ENGINE_HEADLESS)
 STATIC bool DevConsole::Event_KeyPressed(EventArgs& args)
 {
 	if (g_theDevConsole == nullptr)
@@ -158,6 +161,13 @@ STATIC bool DevConsole::Event_KeyPressed(EventArgs& args)
 
 	return true;
 }
+#else
+STATIC bool DevConsole::Event_KeyPressed(EventArgs& args)
+{
+	UNUSED(args);
+	return false;
+}
+#endif // !ENGINE_HEADLESS
 
 STATIC bool DevConsole::Event_CharInput(EventArgs& args)
 {
@@ -255,24 +265,28 @@ void DevConsole::Render_OpenFull(AABB2 const& bounds, Renderer& renderer, Bitmap
 		currentRow++;
 	}
 
-#ifdef ENGINE_RENDER_D3D11
+	// Distance fields are filtered, bitmap glyphs are not
+	SamplerMode fontSamplerMode = font.IsSDF() ? SamplerMode::BILINEAR_CLAMP : SamplerMode::POINT_CLAMP;
+	Shader* fontShader = font.IsSDF() ? renderer.CreateOrGetShader(ShaderConfig(SDF_TEXT_SHADER_NAME)) : nullptr;
+
+#if defined(ENGINE_RENDER_D3D11) || defined(ENGINE_RENDER_NULL)
 	renderer.BindTexture(&font.GetTexture());
-	renderer.SetSamplerMode(SamplerMode::POINT_CLAMP);
-#endif // ENGINE_RENDER_D3D11
+	renderer.SetSamplerMode(fontSamplerMode);
+#endif // ENGINE_RENDER_D3D11 || ENGINE_RENDER_NULL
 
 	//No need to Set Model Constants? it is set in BeginCamera
 #ifdef ENGINE_RENDER_D3D12
 	// resource settings
 	UnlitRenderResources resources;
 	resources.diffuseTextureIndex = renderer.GetSrvIndexFromLoadedTexture(&font.GetTexture(), DefaultTexture::WhiteOpaque2D);
-	resources.diffuseSamplerIndex = renderer.GetDefaultSamplerIndex(SamplerMode::POINT_CLAMP);
+	resources.diffuseSamplerIndex = renderer.GetDefaultSamplerIndex(fontSamplerMode);
 	resources.cameraConstantsIndex = renderer.GetCurrentCameraConstantsIndex();
 	resources.modelConstantsIndex = renderer.GetCurrentModelConstantsIndex();
 
 	renderer.SetGraphicsBindlessResources(sizeof(UnlitRenderResources), &resources);
 #endif // ENGINE_RENDER_D3D12
 
-	renderer.BindShader(nullptr);
+	renderer.BindShader(fontShader);
 	renderer.SetBlendMode(BlendMode::ALPHA);
 	renderer.SetRasterizerMode(RasterizerMode::SOLID_CULL_NONE);
 	renderer.SetDepthMode(DepthMode::DISABLED);
@@ -289,10 +303,10 @@ void DevConsole::Render_OpenFull(AABB2 const& bounds, Renderer& renderer, Bitmap
 		constexpr float insertionPointAspectRatio = 0.15f;
 		AddVertsForLineSegment2D(insertionPointVerts, insertionPointStartPos, insertionPointStartPos + Vec2(0.f, insertionPointLength), insertionPointAspectRatio * fontAspectScale * insertionPointLength, DevConsole::INFO_INSERTION_POINT);
 
-#ifdef ENGINE_RENDER_D3D11
+#if defined(ENGINE_RENDER_D3D11) || defined(ENGINE_RENDER_NULL)
 		renderer.BindTexture(nullptr);
 		renderer.SetSamplerMode(SamplerMode::POINT_CLAMP);
-#endif // ENGINE_RENDER_D3D11
+#endif // ENGINE_RENDER_D3D11 || ENGINE_RENDER_NULL
 
 		//No need to Set Model Constants? it is set in BeginCamera
 #ifdef ENGINE_RENDER_D3D12
@@ -418,6 +432,10 @@ void DevConsole::AddText(Rgba8 const& color, std::string const& text)
 	{
 		SaveLine(color, lines[index]);
 	}
+
+#if defined(ENGINE_HEADLESS)
+	DebuggerPrintf("%s\n", text.c_str()); // nothing draws the console, the log is the only output
+#endif
 }
 
 void DevConsole::Render(AABB2 const& bounds, Renderer* rendererOverride /*= nullptr*/) const
@@ -431,16 +449,16 @@ void DevConsole::Render(AABB2 const& bounds, Renderer* rendererOverride /*= null
 	{
 		renderer = rendererOverride;
 	}
-	BitmapFont* font = renderer->CreateOrGetBitmapFont(m_fontFilePathWithoutExtension.c_str());
+	BitmapFont* font = m_config.m_useSDFFont ? renderer->CreateOrGetSDFFont(m_fontFilePathWithoutExtension.c_str()) : renderer->CreateOrGetBitmapFont(m_fontFilePathWithoutExtension.c_str());
 
 	// translucent black quad
 	std::vector<Vertex_PCU> verts;
 	AddVertsForAABB2D(verts, bounds, Rgba8(0, 0, 0, 128));
 
-#ifdef ENGINE_RENDER_D3D11
+#if defined(ENGINE_RENDER_D3D11) || defined(ENGINE_RENDER_NULL)
 	renderer->BindTexture(nullptr);
 	renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-#endif // ENGINE_RENDER_D3D11
+#endif // ENGINE_RENDER_D3D11 || ENGINE_RENDER_NULL
 
 #ifdef ENGINE_RENDER_D3D12
 	// resource settings
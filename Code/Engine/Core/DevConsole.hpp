@@ -21,6 +21,7 @@ struct DevConsoleConfig
 	Renderer* m_defaultRenderer = nullptr; // Renderer created first then dev console
 	Camera* m_camera = nullptr;
 	std::string m_fontName = "SquirrelFixedFont"; // no name extension
+	bool m_useSDFFont = false; // one distance field atlas, sharp at any m_linesOnScreen
 	float m_linesOnScreen = 40.5; // number of lines is fixed
 	float m_fontAspectScale = 0.7f;
 	int m_maxCommandHistory = 128;
@@ -12,9 +12,11 @@ class NamedStrings;
 class EventSystem;
 class DevConsole;
 class InputSystem;
+class VirtualFileSystem;
 
 //-----------------------------------------------------------------------------------------------
 extern NamedStrings g_gameConfigBlackboard;
 extern EventSystem* g_theEventSystem;
 extern DevConsole*	g_theDevConsole;
 extern InputSystem* g_theInput;
+extern VirtualFileSystem* g_theFileSystem;
@@ -13,6 +13,10 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
 #include <iostream>
 
 
@@ -48,7 +52,7 @@ void DebuggerPrintf( char const* messageFormat, ... )
 	char messageLiteral[ MESSAGE_MAX_LENGTH ];
 	va_list variableArgumentList;
 	va_start( variableArgumentList, messageFormat );
-	vsnprintf_s( messageLiteral, MESSAGE_MAX_LENGTH, _TRUNCATE, messageFormat, variableArgumentList );
+	vsnprintf( messageLiteral, MESSAGE_MAX_LENGTH, messageFormat, variableArgumentList );
 	va_end( variableArgumentList );
 	messageLiteral[ MESSAGE_MAX_LENGTH - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
@@ -69,7 +73,7 @@ void DebuggerWPrintf(wchar_t const* messageFormat, ...)
 	wchar_t messageLiteral[MESSAGE_MAX_LENGTH];
 	va_list variableArgumentList;
 	va_start(variableArgumentList, messageFormat);
-	vswprintf_s(messageLiteral, MESSAGE_MAX_LENGTH, messageFormat, variableArgumentList);
+	vswprintf(messageLiteral, MESSAGE_MAX_LENGTH, messageFormat, variableArgumentList);
 	va_end(variableArgumentList);
 	messageLiteral[MESSAGE_MAX_LENGTH - 1] = L'\0'; // auto-terminate
 
@@ -101,6 +105,24 @@ UINT GetWindowsMessageBoxIconFlagForSeverityLevel( MsgSeverityLevel severity )
 #endif
 
 
+//-----------------------------------------------------------------------------------------------
+// Dialogs hide the cursor again on close, and only Windows has a debugger to break into here
+//
+static void RestoreSystemCursor()
+{
+#if defined( PLATFORM_WINDOWS )
+	ShowCursor( TRUE );
+#endif
+}
+
+static void BreakIntoDebugger()
+{
+#if defined( PLATFORM_WINDOWS )
+	__debugbreak();
+#endif
+}
+
+
 //-----------------------------------------------------------------------------------------------
 char const* FindStartOfFileNameWithinFilePath( char const* filePath )
 {
@@ -202,7 +224,29 @@ int SystemDialogue_YesNoCancel( std::string const& messageTitle, std::string con
 
 
 //-----------------------------------------------------------------------------------------------
-__declspec( noreturn ) void FatalError( char const* filePath, char const* functionName, int lineNum, std::string const& reasonForError, char const* conditionText )
+// Windows builds quit quietly once the dialog is dismissed. Headless runs have nobody to read a
+// dialog, so errors must show in the exit status for CI and process supervisors: abort on fatal
+// errors (also leaves a core dump), exit code 1 when a warning chose to quit.
+//
+[[noreturn]] static void ExitAfterError( bool isFatal )
+{
+#if defined( ENGINE_HEADLESS )
+	fflush( stdout );
+	fflush( stderr );
+	if( isFatal )
+	{
+		abort();
+	}
+	exit( 1 );
+#else
+	(void) isFatal;
+	exit( 0 );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+[[noreturn]] void FatalError( char const* filePath, char const* functionName, int lineNum, std::string const& reasonForError, char const* conditionText )
 {
 	std::string errorMessage = reasonForError;
 	if( reasonForError.empty() )
@@ -218,7 +262,7 @@ __declspec( noreturn ) void FatalError( char const* filePath, char const* functi
 	std::string fullMessageTitle = appName + " :: Error";
 	std::string fullMessageText = errorMessage;
 	fullMessageText += "\n\nThe application will now close.\n";
-	bool isDebuggerPresent = (IsDebuggerPresent() == TRUE);
+	bool isDebuggerPresent = IsDebuggerAvailable();
 	if( isDebuggerPresent )
 	{
 		fullMessageText += "\nDEBUGGER DETECTED!\nWould you like to break and debug?\n  (Yes=debug, No=quit)\n";
@@ -244,19 +288,19 @@ __declspec( noreturn ) void FatalError( char const* filePath, char const* functi
 	if( isDebuggerPresent )
 	{
 		bool isAnswerYes = SystemDialogue_YesNo( fullMessageTitle, fullMessageText, MsgSeverityLevel::FATAL );
-		ShowCursor( TRUE );
+		RestoreSystemCursor();
 		if( isAnswerYes )
 		{
-			__debugbreak();
+			BreakIntoDebugger();
 		}
 	}
 	else
 	{
 		SystemDialogue_Okay( fullMessageTitle, fullMessageText, MsgSeverityLevel::FATAL );
-		ShowCursor( TRUE );
+		RestoreSystemCursor();
 	}
 
-	exit( 0 );
+	ExitAfterError( true );
 }
 
 
@@ -277,7 +321,7 @@ void RecoverableWarning( char const* filePath, char const* functionName, int lin
 	std::string fullMessageTitle = appName + " :: Warning";
 	std::string fullMessageText = errorMessage;
 
-	bool isDebuggerPresent = (IsDebuggerPresent() == TRUE);
+	bool isDebuggerPresent = IsDebuggerAvailable();
 	if( isDebuggerPresent )
 	{
 		fullMessageText += "\n\nDEBUGGER DETECTED!\nWould you like to continue running?\n  (Yes=continue, No=quit, Cancel=debug)\n";
@@ -307,23 +351,23 @@ void RecoverableWarning( char const* filePath, char const* functionName, int lin
 	if( isDebuggerPresent )
 	{
 		int answerCode = SystemDialogue_YesNoCancel( fullMessageTitle, fullMessageText, MsgSeverityLevel::WARNING );
-		ShowCursor( TRUE );
+		RestoreSystemCursor();
 		if( answerCode == 0 ) // "NO"
 		{
-			exit( 0 );
+			ExitAfterError( false );
 		}
 		else if( answerCode == -1 ) // "CANCEL"
 		{
-			__debugbreak();
+			BreakIntoDebugger();
 		}
 	}
 	else
 	{
 		bool isAnswerYes = SystemDialogue_YesNo( fullMessageTitle, fullMessageText, MsgSeverityLevel::WARNING );
-		ShowCursor( TRUE );
+		RestoreSystemCursor();
 		if( !isAnswerYes )
 		{
-			exit( 0 );
+			ExitAfterError( false );
 		}
 	}
 }
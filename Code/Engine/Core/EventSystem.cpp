@@ -1,6 +1,7 @@
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Profiler.hpp"
 
 //-----------------------------------------------------------------------------------------------
 EventSystem* g_theEventSystem = nullptr;
@@ -19,12 +20,18 @@ EventSystem::~EventSystem()
 
 void EventSystem::Startup()
 {
-
+	if (m_config.m_startProfiler)
+	{
+		ProfilerStartup(ProfilerConfig());
+	}
 }
 
 void EventSystem::Shutdown()
 {
-
+	if (m_config.m_startProfiler)
+	{
+		ProfilerShutdown();
+	}
 }
 
 void EventSystem::BeginFrame()
@@ -77,6 +84,7 @@ void EventSystem::UnsubscribeEventCallbackFunction(std::string const& eventName,
 
 void EventSystem::FireEvent(std::string const& eventName, EventArgs& args)
 {
+	PROFILE_SCOPE("EventSystem::FireEvent");
 	auto found = m_subscriptionListByEventName.find(eventName);
 	if (found == m_subscriptionListByEventName.end())
 	{
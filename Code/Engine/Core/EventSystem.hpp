@@ -43,7 +43,9 @@ typedef std::vector<EventSubscription> SubscriptionList;
 //-----------------------------------------------------------------------------------------------
 struct EventSystemConfig
 {
-
+	// The profiler's console command needs the event system, so it starts and stops with it.
+	// Call ProfilerStartup first for a non-default ProfilerConfig
+	bool m_startProfiler = true;
 };
 
 //-----------------------------------------------------------------------------------------------
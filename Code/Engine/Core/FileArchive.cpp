@@ -0,0 +1,635 @@
+#include "Engine/Core/FileArchive.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	constexpr uint32_t ARCHIVE_MAGIC = 0x4B415043;	// "CPAK"
+	constexpr uint32_t ARCHIVE_VERSION = 1;
+	static_assert(sizeof(FileArchiveHeader) == 64, "FileArchiveHeader is part of the file format");
+	static_assert(sizeof(FileArchiveEntry) == 48, "FileArchiveEntry is part of the file format");
+
+	uint64_t HashArchivePath(char const* path, size_t length)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (size_t charIndex = 0; charIndex < length; ++charIndex)
+		{
+			hash ^= static_cast<uint8_t>(path[charIndex]);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	inline size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	inline uint32_t Read32(uint8_t const* bytes)
+	{
+		uint32_t value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// LZ4 block format: sequences of a token (literal length << 4 | match length - 4), literal
+	// length extension bytes, literals, a 16 bit offset and match length extension bytes. The
+	// last sequence is literals only, the last 5 bytes are always literals and the last match
+	// starts at least 12 bytes before the end
+	constexpr int LZ4_HASH_BITS = 16;
+	constexpr size_t LZ4_MIN_MATCH = 4;
+	constexpr size_t LZ4_LAST_LITERALS = 5;
+	constexpr size_t LZ4_MATCH_START_LIMIT = 12;
+	constexpr size_t LZ4_MAX_OFFSET = 65535;
+	constexpr uint64_t LZ4_MAX_SOURCE_SIZE = 0xFFFFFFFFull;	// the hash table keeps 32 bit positions
+	constexpr uint64_t LZ4_MAX_EXPANSION = 255;				// a length extension byte is worth 255 bytes, nothing stored is worth more
+
+	void WriteLZ4Length(std::vector<uint8_t>& out, size_t length)
+	{
+		while (length >= 255)
+		{
+			out.push_back(255);
+			length -= 255;
+		}
+		out.push_back(static_cast<uint8_t>(length));
+	}
+
+	void WriteLZ4Sequence(std::vector<uint8_t>& out, uint8_t const* literals, size_t numLiterals, size_t offset, size_t matchLength)
+	{
+		size_t matchCode = (matchLength > 0) ? matchLength - LZ4_MIN_MATCH : 0;
+		out.push_back(static_cast<uint8_t>((std::min<size_t>(numLiterals, 15) << 4) | std::min<size_t>(matchCode, 15)));
+		if (numLiterals >= 15)
+		{
+			WriteLZ4Length(out, numLiterals - 15);
+		}
+		out.insert(out.end(), literals, literals + numLiterals);
+		if (matchLength == 0)
+		{
+			return;
+		}
+		out.push_back(static_cast<uint8_t>(offset));
+		out.push_back(static_cast<uint8_t>(offset >> 8));
+		if (matchCode >= 15)
+		{
+			WriteLZ4Length(out, matchCode - 15);
+		}
+	}
+
+	// Reads a length extension, false if it runs past the end
+	bool ReadLZ4Length(uint8_t const*& in, uint8_t const* inEnd, size_t& length)
+	{
+		uint8_t byte = 255;
+		while (byte == 255)
+		{
+			if (in >= inEnd)
+			{
+				return false;
+			}
+			byte = *in++;
+			length += byte;
+		}
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// Files mapped and compressed together, a budget in m_batchBytes alone would let thousands of
+	// tiny files keep as many mappings open at once
+	constexpr size_t MAX_BATCH_FILES = 256;
+
+	struct PackedFile
+	{
+		std::string				m_path;			// normalized, relative to the packed directory
+		std::string				m_sourcePath;
+		size_t					m_sourceSize = 0;	// when listed, the mapping has the final say
+		MappedFile				m_source;
+		std::vector<uint8_t>	m_compressed;
+		bool					m_isCompressed = false;
+
+		size_t GetStoredSize() const { return m_isCompressed ? m_compressed.size() : m_source.GetSize(); }
+	};
+
+	bool WriteBytes(FILE* file, void const* data, size_t size)
+	{
+		return size == 0 || fwrite(data, 1, size, file) == size;
+	}
+
+	bool WriteZeros(FILE* file, size_t size)
+	{
+		static uint8_t const s_zeros[4096] = {};
+		while (size > 0)
+		{
+			size_t chunkSize = std::min(size, sizeof(s_zeros));
+			if (!WriteBytes(file, s_zeros, chunkSize))
+			{
+				return false;
+			}
+			size -= chunkSize;
+		}
+		return true;
+	}
+
+	bool IsStoredExtension(std::string const& path, Strings const& storedExtensions)
+	{
+		for (std::string const& extension : storedExtensions)
+		{
+			if (path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string NormalizeArchivePath(std::string const& path)
+{
+	std::string normalized;
+	normalized.reserve(path.size());
+	for (char c : path)
+	{
+		c = (c == '\\') ? '/' : c;
+		if (c == '/' && !normalized.empty() && normalized.back() == '/')
+		{
+			continue;
+		}
+		normalized.push_back(static_cast<char>(tolower(static_cast<unsigned char>(c))));
+	}
+	while (normalized.compare(0, 2, "./") == 0)
+	{
+		normalized.erase(0, 2);
+	}
+	if (!normalized.empty() && normalized.front() == '/')
+	{
+		normalized.erase(0, 1);
+	}
+	return normalized;
+}
+
+//-----------------------------------------------------------------------------------------------
+size_t CompressLZ4Block(uint8_t const* source, size_t sourceSize, std::vector<uint8_t>& out_compressed)
+{
+	GUARANTEE_OR_DIE(sourceSize <= LZ4_MAX_SOURCE_SIZE, "CompressLZ4Block sources must be smaller than 4 GB");
+	out_compressed.clear();
+	out_compressed.reserve(sourceSize + sourceSize / 255 + 16);
+
+	size_t anchor = 0;
+	if (sourceSize > LZ4_MATCH_START_LIMIT)
+	{
+		// Positions of recent 4 byte sequences by hash, greedy: the first match found is taken
+		std::vector<uint32_t> hashTable(static_cast<size_t>(1) << LZ4_HASH_BITS, 0xFFFFFFFFu);
+		size_t matchStartEnd = sourceSize - LZ4_MATCH_START_LIMIT;
+		size_t matchEnd = sourceSize - LZ4_LAST_LITERALS;
+		size_t position = 0;
+		while (position < matchStartEnd)
+		{
+			uint32_t sequence = Read32(source + position);
+			uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+			uint32_t candidate = hashTable[hash];
+			hashTable[hash] = static_cast<uint32_t>(position);
+
+			if (candidate == 0xFFFFFFFFu || position - candidate > LZ4_MAX_OFFSET || Read32(source + candidate) != sequence)
+			{
+				// Skip faster through data that does not compress
+				position += 1 + ((position - anchor) >> 6);
+				continue;
+			}
+
+			size_t matchLength = LZ4_MIN_MATCH;
+			while (position + matchLength < matchEnd && source[candidate + matchLength] == source[position + matchLength])
+			{
+				++matchLength;
+			}
+			WriteLZ4Sequence(out_compressed, source + anchor, position - anchor, position - candidate, matchLength);
+			position += matchLength;
+			anchor = position;
+		}
+	}
+	WriteLZ4Sequence(out_compressed, source + anchor, sourceSize - anchor, 0, 0);
+	return out_compressed.size();
+}
+
+bool DecompressLZ4Block(uint8_t const* source, size_t sourceSize, uint8_t* dest, size_t destSize)
+{
+	uint8_t const* in = source;
+	uint8_t const* inEnd = source + sourceSize;
+	uint8_t* out = dest;
+	uint8_t* outEnd = dest + destSize;
+
+	while (in < inEnd)
+	{
+		uint8_t token = *in++;
+		size_t numLiterals = token >> 4;
+		if (numLiterals == 15 && !ReadLZ4Length(in, inEnd, numLiterals))
+		{
+			return false;
+		}
+		if (numLiterals > static_cast<size_t>(inEnd - in) || numLiterals > static_cast<size_t>(outEnd - out))
+		{
+			return false;
+		}
+		memcpy(out, in, numLiterals);
+		in += numLiterals;
+		out += numLiterals;
+		if (in == inEnd)
+		{
+			break;
+		}
+
+		if (inEnd - in < 2)
+		{
+			return false;
+		}
+		size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+		in += 2;
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !ReadLZ4Length(in, inEnd, matchLength))
+		{
+			return false;
+		}
+		matchLength += LZ4_MIN_MATCH;
+		if (offset == 0 || offset > static_cast<size_t>(out - dest) || matchLength > static_cast<size_t>(outEnd - out))
+		{
+			return false;
+		}
+
+		// Overlapping matches repeat the bytes just written, so copy forward one at a time
+		uint8_t const* match = out - offset;
+		if (offset >= matchLength)
+		{
+			memcpy(out, match, matchLength);
+			out += matchLength;
+		}
+		else
+		{
+			for (size_t byteIndex = 0; byteIndex < matchLength; ++byteIndex)
+			{
+				*out++ = *match++;
+			}
+		}
+	}
+	return out == outEnd;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool FileArchive::Open(std::string const& archivePath)
+{
+	Close();
+	if (!m_file.Open(archivePath))
+	{
+		DebuggerPrintf("FileArchive: could not map \"%s\"\n", archivePath.c_str());
+		return false;
+	}
+
+	size_t fileSize = m_file.GetSize();
+	uint8_t const* data = m_file.GetData();
+	if (fileSize < sizeof(FileArchiveHeader))
+	{
+		DebuggerPrintf("FileArchive: \"%s\" is too small to be an archive\n", archivePath.c_str());
+		m_file.Close();
+		return false;
+	}
+	memcpy(static_cast<void*>(&m_header), data, sizeof(m_header));
+
+	bool isValid = m_header.m_magic == ARCHIVE_MAGIC && m_header.m_version == ARCHIVE_VERSION && m_header.m_archiveSize == fileSize &&
+		m_header.m_entriesOffset % alignof(FileArchiveEntry) == 0 &&
+		m_header.m_entriesOffset <= fileSize && m_header.m_numEntries <= (fileSize - m_header.m_entriesOffset) / sizeof(FileArchiveEntry) &&
+		m_header.m_stringsOffset <= fileSize && m_header.m_stringsSize <= fileSize - m_header.m_stringsOffset;
+	if (!isValid)
+	{
+		DebuggerPrintf("FileArchive: \"%s\" has a bad header\n", archivePath.c_str());
+		m_file.Close();
+		return false;
+	}
+
+	// ReadFile allocates m_size up front, so an LZ4 entry may not claim more than its stored bytes can expand to
+	FileArchiveEntry const* entries = reinterpret_cast<FileArchiveEntry const*>(data + m_header.m_entriesOffset);
+	for (uint32_t entryIndex = 0; entryIndex < m_header.m_numEntries; ++entryIndex)
+	{
+		FileArchiveEntry const& entry = entries[entryIndex];
+		bool isEntryValid = entry.m_dataOffset <= fileSize && entry.m_storedSize <= fileSize - entry.m_dataOffset &&
+			static_cast<uint64_t>(entry.m_pathOffset) + entry.m_pathLength <= m_header.m_stringsSize &&
+			((entry.m_compression == static_cast<uint32_t>(FileArchiveCompression::LZ4) &&
+			entry.m_size <= LZ4_MAX_SOURCE_SIZE && entry.m_size <= entry.m_storedSize * LZ4_MAX_EXPANSION) ||
+			(entry.m_compression == static_cast<uint32_t>(FileArchiveCompression::NONE) && entry.m_storedSize == entry.m_size));
+		if (!isEntryValid)
+		{
+			DebuggerPrintf("FileArchive: \"%s\" entry %u is out of bounds\n", archivePath.c_str(), entryIndex);
+			m_file.Close();
+			return false;
+		}
+	}
+
+	m_entries = entries;
+	m_strings = reinterpret_cast<char const*>(data + m_header.m_stringsOffset);
+	return true;
+}
+
+void FileArchive::Close()
+{
+	m_file.Close();
+	m_header = FileArchiveHeader();
+	m_entries = nullptr;
+	m_strings = nullptr;
+}
+
+//-----------------------------------------------------------------------------------------------
+FileArchiveEntry const* FileArchive::FindEntry(std::string const& path) const
+{
+	if (!IsOpen())
+	{
+		return nullptr;
+	}
+
+	std::string normalized = NormalizeArchivePath(path);
+	uint64_t hash = HashArchivePath(normalized.data(), normalized.size());
+	FileArchiveEntry const* entriesEnd = m_entries + m_header.m_numEntries;
+	FileArchiveEntry const* entry = std::lower_bound(m_entries, entriesEnd, hash, [](FileArchiveEntry const& lhs, uint64_t rhs) { return lhs.m_pathHash < rhs; });
+	for (; entry != entriesEnd && entry->m_pathHash == hash; ++entry)
+	{
+		if (entry->m_pathLength == normalized.size() && memcmp(m_strings + entry->m_pathOffset, normalized.data(), normalized.size()) == 0)
+		{
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+bool FileArchive::GetSpan(std::string const& path, ByteSpan& out_span) const
+{
+	FileArchiveEntry const* entry = FindEntry(path);
+	return entry && GetEntrySpan(*entry, out_span);
+}
+
+bool FileArchive::GetEntrySpan(FileArchiveEntry const& entry, ByteSpan& out_span) const
+{
+	if (entry.m_compression != static_cast<uint32_t>(FileArchiveCompression::NONE))
+	{
+		return false;
+	}
+	out_span = ByteSpan(m_file.GetData() + entry.m_dataOffset, static_cast<size_t>(entry.m_size));
+	return true;
+}
+
+bool FileArchive::ReadFile(std::string const& path, std::vector<uint8_t>& out_buffer) const
+{
+	FileArchiveEntry const* entry = FindEntry(path);
+	return entry && ReadEntry(*entry, out_buffer);
+}
+
+bool FileArchive::ReadEntry(FileArchiveEntry const& entry, std::vector<uint8_t>& out_buffer) const
+{
+	uint8_t const* storedData = m_file.GetData() + entry.m_dataOffset;
+	out_buffer.resize(static_cast<size_t>(entry.m_size));
+	if (entry.m_compression == static_cast<uint32_t>(FileArchiveCompression::NONE))
+	{
+		if (entry.m_size > 0)
+		{
+			memcpy(out_buffer.data(), storedData, out_buffer.size());
+		}
+		return true;
+	}
+	if (!DecompressLZ4Block(storedData, static_cast<size_t>(entry.m_storedSize), out_buffer.data(), out_buffer.size()))
+	{
+		DebuggerPrintf("FileArchive: \"%s\" in \"%s\" is corrupt\n", GetEntryPath(entry).c_str(), GetArchivePath().c_str());
+		out_buffer.clear();
+		return false;
+	}
+	return true;
+}
+
+std::string FileArchive::GetEntryPath(FileArchiveEntry const& entry) const
+{
+	return std::string(m_strings + entry.m_pathOffset, entry.m_pathLength);
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string FileArchiveBuildResult::ToString() const
+{
+	return Stringf("%d files, %d compressed, %.1f KB packed into %.1f KB in %.1f ms",
+		m_numFiles, m_numCompressed, static_cast<double>(m_totalFileBytes) / 1024.0, static_cast<double>(m_archiveBytes) / 1024.0, m_seconds * 1000.0);
+}
+
+bool BuildFileArchive(std::string const& sourceDirectory, std::string const& archivePath, FileArchiveBuildConfig const& config, WorkerPool* workers, FileArchiveBuildResult* out_result)
+{
+	double startSeconds = GetCurrentTimeSeconds();
+	GUARANTEE_OR_DIE(config.m_dataAlignment > 0 && (config.m_dataAlignment & (config.m_dataAlignment - 1)) == 0, "FileArchiveBuildConfig::m_dataAlignment must be a power of two");
+
+	// Every regular file, mapped later one batch at a time so the packer never goes through a mounted archive
+	namespace fs = std::filesystem;
+	std::error_code error;
+	fs::path sourceRoot(sourceDirectory);
+	fs::path archiveFullPath = fs::absolute(fs::path(archivePath), error);
+	std::vector<std::unique_ptr<PackedFile>> files;
+	for (fs::recursive_directory_iterator it(sourceRoot, error), end; !error && it != end; it.increment(error))
+	{
+		std::error_code fileError;
+		if (!it->is_regular_file(fileError) || fs::absolute(it->path(), fileError) == archiveFullPath)
+		{
+			continue;
+		}
+		std::unique_ptr<PackedFile> file = std::make_unique<PackedFile>();
+		file->m_path = NormalizeArchivePath(fs::relative(it->path(), sourceRoot, fileError).generic_string());
+		file->m_sourcePath = it->path().string();
+		uintmax_t sourceSize = it->file_size(fileError);
+		if (fileError)
+		{
+			DebuggerPrintf("BuildFileArchive: could not read \"%s\"\n", file->m_sourcePath.c_str());
+			return false;
+		}
+		if (sourceSize > LZ4_MAX_SOURCE_SIZE)
+		{
+			DebuggerPrintf("BuildFileArchive: \"%s\" is 4 GB or larger, too large for an archive entry\n", file->m_sourcePath.c_str());
+			return false;
+		}
+		file->m_sourceSize = static_cast<size_t>(sourceSize);
+		files.push_back(std::move(file));
+	}
+	if (error)
+	{
+		DebuggerPrintf("BuildFileArchive: could not list \"%s\": %s\n", sourceDirectory.c_str(), error.message().c_str());
+		return false;
+	}
+
+	// Sorted by hash for FindEntry's binary search, by path within a hash so builds are reproducible
+	std::vector<uint64_t> hashes(files.size());
+	for (size_t fileIndex = 0; fileIndex < files.size(); ++fileIndex)
+	{
+		hashes[fileIndex] = HashArchivePath(files[fileIndex]->m_path.data(), files[fileIndex]->m_path.size());
+	}
+	std::vector<int> order(files.size());
+	for (size_t fileIndex = 0; fileIndex < files.size(); ++fileIndex)
+	{
+		order[fileIndex] = static_cast<int>(fileIndex);
+	}
+	std::sort(order.begin(), order.end(), [&](int lhs, int rhs)
+		{
+			return (hashes[lhs] != hashes[rhs]) ? hashes[lhs] < hashes[rhs] : files[lhs]->m_path < files[rhs]->m_path;
+		});
+
+	// The tables only need the paths, data offsets and sizes are filled in as entries are written
+	FileArchiveHeader header;
+	header.m_magic = ARCHIVE_MAGIC;
+	header.m_version = ARCHIVE_VERSION;
+	header.m_numEntries = static_cast<uint32_t>(files.size());
+	header.m_dataAlignment = config.m_dataAlignment;
+	header.m_entriesOffset = sizeof(FileArchiveHeader);
+	header.m_stringsOffset = header.m_entriesOffset + files.size() * sizeof(FileArchiveEntry);
+
+	std::vector<FileArchiveEntry> entries(files.size());
+	std::string strings;
+	for (size_t entryIndex = 0; entryIndex < files.size(); ++entryIndex)
+	{
+		PackedFile const& file = *files[order[entryIndex]];
+		FileArchiveEntry& entry = entries[entryIndex];
+		entry.m_pathHash = hashes[order[entryIndex]];
+		entry.m_pathOffset = static_cast<uint32_t>(strings.size());
+		entry.m_pathLength = static_cast<uint32_t>(file.m_path.size());
+		strings += file.m_path;
+	}
+	header.m_stringsSize = strings.size();
+
+	// Streamed: placeholder tables first, then each batch of entries is mapped, compressed and
+	// appended, and the header and entries are written over the placeholders last. The placeholder
+	// header is all zeros, so an archive left behind by an interrupted build never opens
+	FILE* archiveFile = nullptr;
+#if defined(_WIN32)
+	errno_t openError = fopen_s(&archiveFile, archivePath.c_str(), "wb");
+#else
+	int openError = (archiveFile = fopen(archivePath.c_str(), "wb")) ? 0 : errno;
+#endif
+	if (openError != 0)
+	{
+		DebuggerPrintf("BuildFileArchive: could not write \"%s\"\n", archivePath.c_str());
+		return false;
+	}
+	auto abandonArchive = [&](std::string const& reason)
+		{
+			fclose(archiveFile);
+			remove(archivePath.c_str());
+			DebuggerPrintf("BuildFileArchive: %s\n", reason.c_str());
+			return false;
+		};
+
+	FileArchiveHeader placeholderHeader;
+	uint64_t archiveOffset = AlignUp(static_cast<size_t>(header.m_stringsOffset + header.m_stringsSize), config.m_dataAlignment);
+	if (!WriteBytes(archiveFile, &placeholderHeader, sizeof(placeholderHeader))
+		|| !WriteBytes(archiveFile, entries.data(), entries.size() * sizeof(FileArchiveEntry))
+		|| !WriteBytes(archiveFile, strings.data(), strings.size())
+		|| !WriteZeros(archiveFile, static_cast<size_t>(archiveOffset - header.m_stringsOffset - header.m_stringsSize)))
+	{
+		return abandonArchive("could not write \"" + archivePath + "\"");
+	}
+
+	auto compressFile = [&](int fileIndex)
+		{
+			PackedFile& file = *files[fileIndex];
+			size_t size = file.m_source.GetSize();
+			if (!config.m_compress || size == 0 || IsStoredExtension(file.m_path, config.m_storedExtensions))
+			{
+				return;
+			}
+			size_t compressedSize = CompressLZ4Block(file.m_source.GetData(), size, file.m_compressed);
+			file.m_isCompressed = static_cast<double>(compressedSize) <= static_cast<double>(size) * config.m_maxCompressedRatio;
+			if (!file.m_isCompressed)
+			{
+				file.m_compressed = std::vector<uint8_t>();
+			}
+		};
+
+	FileArchiveBuildResult result;
+	result.m_numFiles = static_cast<int>(files.size());
+	size_t batchStart = 0;
+	while (batchStart < files.size())
+	{
+		// At least one file, then up to the byte budget, so one huge file makes a batch of its own
+		size_t batchEnd = batchStart;
+		size_t batchBytes = 0;
+		while (batchEnd < files.size() && (batchEnd == batchStart || (batchBytes < config.m_batchBytes && batchEnd - batchStart < MAX_BATCH_FILES)))
+		{
+			batchBytes += files[order[batchEnd]]->m_sourceSize;
+			++batchEnd;
+		}
+
+		for (size_t entryIndex = batchStart; entryIndex < batchEnd; ++entryIndex)
+		{
+			PackedFile& file = *files[order[entryIndex]];
+			if (!file.m_source.Open(file.m_sourcePath) || file.m_source.GetSize() > LZ4_MAX_SOURCE_SIZE)
+			{
+				return abandonArchive("could not read \"" + file.m_sourcePath + "\"");
+			}
+		}
+
+		int numBatchFiles = static_cast<int>(batchEnd - batchStart);
+		auto compressBatchFile = [&](int batchIndex) { compressFile(order[batchStart + batchIndex]); };
+		if (workers)
+		{
+			workers->ParallelFor(numBatchFiles, compressBatchFile);
+		}
+		else
+		{
+			for (int batchIndex = 0; batchIndex < numBatchFiles; ++batchIndex)
+			{
+				compressBatchFile(batchIndex);
+			}
+		}
+
+		for (size_t entryIndex = batchStart; entryIndex < batchEnd; ++entryIndex)
+		{
+			std::unique_ptr<PackedFile>& file = files[order[entryIndex]];
+			FileArchiveEntry& entry = entries[entryIndex];
+			entry.m_compression = static_cast<uint32_t>(file->m_isCompressed ? FileArchiveCompression::LZ4 : FileArchiveCompression::NONE);
+			entry.m_size = file->m_source.GetSize();
+			entry.m_storedSize = file->GetStoredSize();
+			entry.m_dataOffset = archiveOffset;
+
+			uint8_t const* storedData = file->m_isCompressed ? file->m_compressed.data() : file->m_source.GetData();
+			size_t storedSize = file->GetStoredSize();
+			size_t paddedSize = AlignUp(storedSize, config.m_dataAlignment);
+			if (!WriteBytes(archiveFile, storedData, storedSize) || !WriteZeros(archiveFile, paddedSize - storedSize))
+			{
+				return abandonArchive("could not write \"" + archivePath + "\"");
+			}
+			archiveOffset += paddedSize;
+			result.m_numCompressed += file->m_isCompressed ? 1 : 0;
+			result.m_totalFileBytes += file->m_source.GetSize();
+
+			// Unmaps the source and frees its compressed copy
+			file.reset();
+		}
+		batchStart = batchEnd;
+	}
+	header.m_archiveSize = archiveOffset;
+
+	if (fseek(archiveFile, 0, SEEK_SET) != 0
+		|| !WriteBytes(archiveFile, &header, sizeof(header))
+		|| !WriteBytes(archiveFile, entries.data(), entries.size() * sizeof(FileArchiveEntry)))
+	{
+		return abandonArchive("could not write \"" + archivePath + "\"");
+	}
+	if (fclose(archiveFile) != 0)
+	{
+		remove(archivePath.c_str());
+		DebuggerPrintf("BuildFileArchive: could not write \"%s\"\n", archivePath.c_str());
+		return false;
+	}
+
+	result.m_archiveBytes = static_cast<size_t>(archiveOffset);
+	result.m_seconds = GetCurrentTimeSeconds() - startSeconds;
+	if (out_result)
+	{
+		*out_result = result;
+	}
+	return true;
+}
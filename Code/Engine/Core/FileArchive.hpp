@@ -0,0 +1,123 @@
+#pragma once
+#include "Engine/Core/MappedFile.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class WorkerPool;
+
+//-----------------------------------------------------------------------------------------------
+// Packed archive: many files in one, read through a memory mapping.
+//
+// Layout, little endian:
+//	FileArchiveHeader		64 bytes
+//	FileArchiveEntry[]		sorted by path hash, for a binary search without loading anything
+//	path strings			lower case, '/' separated, relative to the packed directory
+//	file data				every entry starting on a m_dataAlignment boundary
+//
+// Entries are stored as is, so GetSpan hands out the mapped bytes without a copy, or LZ4 block
+// compressed when that saves enough. Already compressed formats (png, jpg, dds, ogg, ...) are
+// always stored, a dds stays directly uploadable from the mapping.
+//
+enum class FileArchiveCompression : uint32_t
+{
+	NONE = 0,
+	LZ4 = 1,	// LZ4 block format, no frame
+};
+
+struct FileArchiveHeader
+{
+	uint32_t	m_magic = 0;
+	uint32_t	m_version = 0;
+	uint32_t	m_numEntries = 0;
+	uint32_t	m_dataAlignment = 0;
+	uint64_t	m_entriesOffset = 0;
+	uint64_t	m_stringsOffset = 0;
+	uint64_t	m_stringsSize = 0;
+	uint64_t	m_archiveSize = 0;
+	uint8_t		m_reserved[16] = {};
+};
+
+struct FileArchiveEntry
+{
+	uint64_t	m_pathHash = 0;		// FNV-1a of the path
+	uint64_t	m_dataOffset = 0;
+	uint64_t	m_storedSize = 0;	// bytes in the archive
+	uint64_t	m_size = 0;			// bytes once decompressed
+	uint32_t	m_pathOffset = 0;	// into the path strings
+	uint32_t	m_pathLength = 0;
+	uint32_t	m_compression = 0;	// FileArchiveCompression
+	uint32_t	m_reserved = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+class FileArchive
+{
+public:
+	FileArchive() = default;
+	FileArchive(FileArchive const& copy) = delete;
+
+	// Maps the archive and checks the header and every entry against the file size
+	bool Open(std::string const& archivePath);
+	void Close();
+	bool IsOpen() const { return m_entries != nullptr; }
+	std::string const& GetArchivePath() const { return m_file.GetFilePath(); }
+
+	// Paths relative to the packed directory, any case, '/' or '\'
+	FileArchiveEntry const* FindEntry(std::string const& path) const;
+	bool HasFile(std::string const& path) const { return FindEntry(path) != nullptr; }
+	// The mapped bytes of an uncompressed entry, valid until Close. False for compressed entries
+	bool GetSpan(std::string const& path, ByteSpan& out_span) const;
+	bool GetEntrySpan(FileArchiveEntry const& entry, ByteSpan& out_span) const;
+	// Copies or decompresses into out_buffer
+	bool ReadFile(std::string const& path, std::vector<uint8_t>& out_buffer) const;
+	bool ReadEntry(FileArchiveEntry const& entry, std::vector<uint8_t>& out_buffer) const;
+
+	int GetNumEntries() const { return static_cast<int>(m_header.m_numEntries); }
+	FileArchiveEntry const& GetEntry(int entryIndex) const { return m_entries[entryIndex]; }
+	std::string GetEntryPath(FileArchiveEntry const& entry) const;
+	size_t GetArchiveSize() const { return m_file.GetSize(); }
+
+private:
+	MappedFile					m_file;
+	FileArchiveHeader			m_header;
+	FileArchiveEntry const*		m_entries = nullptr;
+	char const*					m_strings = nullptr;
+};
+
+//-----------------------------------------------------------------------------------------------
+// Packer
+struct FileArchiveBuildConfig
+{
+	bool		m_compress = true;
+	float		m_maxCompressedRatio = 0.9f;	// compressed entries larger than this fraction are stored instead
+	uint32_t	m_dataAlignment = 64;			// power of two, 64 keeps spans cache line aligned
+	size_t		m_batchBytes = 64 * 1024 * 1024;	// source bytes mapped and compressed at a time, bounds the packer's memory
+	Strings		m_storedExtensions = { ".png", ".jpg", ".jpeg", ".dds", ".ogg", ".mp3", ".wav", ".pak" };
+};
+
+struct FileArchiveBuildResult
+{
+	int		m_numFiles = 0;
+	int		m_numCompressed = 0;
+	size_t	m_totalFileBytes = 0;
+	size_t	m_archiveBytes = 0;
+	double	m_seconds = 0.0;
+
+	std::string ToString() const;
+};
+
+// Packs every file below sourceDirectory. Entry paths are relative to it, so mounting the archive
+// at sourceDirectory's virtual path serves the same paths. An optional WorkerPool compresses in parallel.
+// Entries are written to the file batch by batch, never the whole archive in memory. Fails on any file
+// of 4 GB or more, the LZ4 match finder keeps 32 bit positions
+bool BuildFileArchive(std::string const& sourceDirectory, std::string const& archivePath, FileArchiveBuildConfig const& config = FileArchiveBuildConfig(), WorkerPool* workers = nullptr, FileArchiveBuildResult* out_result = nullptr);
+
+// Lower case, '/' separated, no leading "./" or '/'
+std::string NormalizeArchivePath(std::string const& path);
+
+// LZ4 block format. Compress returns the compressed size and dies on sources of 4 GB or more, Decompress
+// checks every offset and length and fails unless it fills exactly destSize bytes
+size_t CompressLZ4Block(uint8_t const* source, size_t sourceSize, std::vector<uint8_t>& out_compressed);
+bool DecompressLZ4Block(uint8_t const* source, size_t sourceSize, uint8_t* dest, size_t destSize);
@@ -1,13 +1,24 @@
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/VirtualFileSystem.hpp"
 #include <stdio.h>
+#include <errno.h>
 
 
 int FileReadToBuffer(std::vector<uint8_t>& outBuffer, const std::string& fileName)
 {
-	errno_t err;
-	FILE* fp;
-	err = fopen_s(&fp, fileName.c_str(), "rb");
+	// Mounted directories and archives first, then the disk as is
+	if (g_theFileSystem && g_theFileSystem->ReadFile(fileName, outBuffer))
+	{
+		return static_cast<int>(outBuffer.size());
+	}
+
+	FILE* fp = nullptr;
+#if defined(_WIN32)
+	errno_t err = fopen_s(&fp, fileName.c_str(), "rb");
+#else
+	int err = (fp = fopen(fileName.c_str(), "rb")) ? 0 : errno;
+#endif
 	if (err != 0)
 	{
 		ERROR_RECOVERABLE("Could not open file.");
@@ -56,3 +67,53 @@ int FileReadToString(std::string& outString, const std::string& fileName)
 	return result;
 }
 
+int FileWriteFromBuffer(std::vector<uint8_t> const& buffer, const std::string& fileName)
+{
+	FILE* fp = nullptr;
+#if defined(_WIN32)
+	errno_t err = fopen_s(&fp, fileName.c_str(), "wb");
+#else
+	int err = (fp = fopen(fileName.c_str(), "wb")) ? 0 : errno;
+#endif
+	if (err != 0)
+	{
+		ERROR_RECOVERABLE("Could not open file for writing.");
+		return -1;
+	}
+
+	size_t result = fwrite(buffer.data(), sizeof(uint8_t), buffer.size(), fp);
+	fclose(fp);
+	if (result != buffer.size())
+	{
+		ERROR_RECOVERABLE("Error writing file");
+		return -1;
+	}
+	return static_cast<int>(result);
+}
+
+int FileWriteFromString(std::string const& string, const std::string& fileName)
+{
+	std::vector<uint8_t> buffer(string.begin(), string.end());
+	return FileWriteFromBuffer(buffer, fileName);
+}
+
+bool DoesFileExist(const std::string& fileName)
+{
+	if (g_theFileSystem && g_theFileSystem->DoesFileExist(fileName))
+	{
+		return true;
+	}
+
+	FILE* fp = nullptr;
+#if defined(_WIN32)
+	errno_t err = fopen_s(&fp, fileName.c_str(), "rb");
+#else
+	int err = (fp = fopen(fileName.c_str(), "rb")) ? 0 : errno;
+#endif
+	if (err != 0 || fp == nullptr)
+	{
+		return false;
+	}
+	fclose(fp);
+	return true;
+}
@@ -5,3 +5,6 @@
 
 int FileReadToBuffer(std::vector<uint8_t>& outBuffer, const std::string& fileName);
 int FileReadToString(std::string& outString, const std::string& fileName);
+int FileWriteFromBuffer(std::vector<uint8_t> const& buffer, const std::string& fileName);
+int FileWriteFromString(std::string const& string, const std::string& fileName);
+bool DoesFileExist(const std::string& fileName); // quietly, unlike the readers above
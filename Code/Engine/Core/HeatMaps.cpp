@@ -5,6 +5,7 @@
 #include "Engine/Math/Gradient.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include <cfloat>
 
 
 
@@ -1,6 +1,10 @@
 #include "Engine/Core/Image.hpp"
+#include "Engine/Core/ImageProcessing.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/VirtualFileSystem.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include <cstring>
 
 #define STB_IMAGE_IMPLEMENTATION // Exactly one .CPP (this Image.cpp) should #define this before #including stb_image.h
 #include "ThirdParty/stb/stb_image.h"
@@ -26,46 +30,53 @@ Image::~Image()
 Image::Image(char const* imageFilePath, bool flipVertically)
 	:m_imageFilePath(imageFilePath)
 {
-	IntVec2 dimensions = IntVec2::ZERO;		// This will be filled in for us to indicate image width & height
-	int bytesPerTexel = 0;					// ...and how many color components the image had (e.g. 3=RGB=24bit, 4=RGBA=32bit)
+	bool isLoaded = LoadFromFile(imageFilePath, flipVertically);
+	GUARANTEE_OR_DIE(isLoaded, Stringf("Failed to load image \"%s\"", imageFilePath));
+}
 
-	// Load (and decompress) the image RGB(A) bytes from a file on disk into a memory buffer (array of bytes)
-	if (flipVertically)
+bool Image::LoadFromFile(char const* imageFilePath, bool flipVertically /*= true*/)
+{
+	IntVec2 dimensions = IntVec2::ZERO;		// This will be filled in for us to indicate image width & height
+	int fileComponents = 0;					// ...and how many color components the file had, stb expands them all to RGBA
+
+	// Never flipped by stb: its flag is global, and flipping while copying rows below is free. The thread
+	// local flag only matters if somebody else set the global one
+	stbi_set_flip_vertically_on_load_thread(0);
+	unsigned char* texelData = nullptr;
+	ByteSpan fileSpan;
+	std::vector<uint8_t> fileStorage;
+	if (g_theFileSystem && g_theFileSystem->GetFileSpan(imageFilePath, fileSpan, fileStorage))
 	{
-		stbi_set_flip_vertically_on_load(1); // We prefer uvTexCoords has origin (0,0) at BOTTOM LEFT
+		// Decoded straight from the archive mapping when the entry is stored
+		texelData = stbi_load_from_memory(fileSpan.m_data, static_cast<int>(fileSpan.m_size), &dimensions.x, &dimensions.y, &fileComponents, 4);
 	}
 	else
 	{
-		stbi_set_flip_vertically_on_load(0); // DirectX: For Texture Cube
+		texelData = stbi_load(imageFilePath, &dimensions.x, &dimensions.y, &fileComponents, 4);
 	}
-	unsigned char* texelData = stbi_load(imageFilePath, &dimensions.x, &dimensions.y, &bytesPerTexel, 0);
 
-	// Check if the load was successful
-	GUARANTEE_OR_DIE(texelData, Stringf("Failed to load image \"%s\"", imageFilePath));
-	GUARANTEE_OR_DIE(bytesPerTexel >= 3 && bytesPerTexel <= 4, Stringf("CreateTextureFromData failed for \"%s\" - unsupported BPP=%i (must be 3 or 4)", imageFilePath, bytesPerTexel));
-	GUARANTEE_OR_DIE(dimensions.x > 0 && dimensions.y > 0, Stringf("CreateTextureFromData failed for \"%s\" - illegal texture dimensions (%i x %i)", imageFilePath, dimensions.x, dimensions.y));
+	// stb_image returns nullptr for missing, truncated and unsupported files
+	if (texelData == nullptr || dimensions.x <= 0 || dimensions.y <= 0)
+	{
+		stbi_image_free(texelData);
+		return false;
+	}
 
-	// Initialize
+	// Initialize, one row copy each, Rgba8 has the same layout as stb's RGBA bytes
+	static_assert(sizeof(Rgba8) == 4, "Image rows are copied as RGBA bytes");
+	m_imageFilePath = imageFilePath;
 	m_dimensions = dimensions;
+	m_rgbaTexels.resize(static_cast<size_t>(m_dimensions.x) * m_dimensions.y);
 
-	int numTexels = m_dimensions.x * m_dimensions.y;
-	m_rgbaTexels.reserve(numTexels);
-
-	for (int i = 0; i < numTexels; ++i)
+	size_t rowBytes = static_cast<size_t>(m_dimensions.x) * sizeof(Rgba8);
+	for (int rowIndex = 0; rowIndex < m_dimensions.y; ++rowIndex)
 	{
-		int offset = i * bytesPerTexel;
-		Rgba8 color;
-		color.r = texelData[offset];
-		color.g = texelData[offset + 1];
-		color.b = texelData[offset + 2];
-		if (bytesPerTexel == 4)
-		{
-			color.a = texelData[offset + 3];
-		}
-		m_rgbaTexels.push_back(color);
+		int fileRowIndex = flipVertically ? m_dimensions.y - 1 - rowIndex : rowIndex; // We prefer uvTexCoords has origin (0,0) at BOTTOM LEFT
+		memcpy(static_cast<void*>(m_rgbaTexels.data() + static_cast<size_t>(rowIndex) * m_dimensions.x), texelData + fileRowIndex * rowBytes, rowBytes);
 	}
 
 	stbi_image_free(texelData);
+	return true;
 }
 
 
@@ -79,6 +90,16 @@ const void* Image::GetRawData() const
 	return m_rgbaTexels.data();
 }
 
+Rgba8* Image::GetRawTexels()
+{
+	return m_rgbaTexels.data();
+}
+
+Rgba8 const* Image::GetRawTexels() const
+{
+	return m_rgbaTexels.data();
+}
+
 IntVec2 Image::GetDimensions() const
 {
 	return m_dimensions;
@@ -106,48 +127,46 @@ bool Image::IsInBounds(IntVec2 const& texelCoords) const
 
 Image Image::GetBoxBlurred(int blurRadius) const
 {
-	if (blurRadius < 1)
-	{
-		return (*this);
-	}
-
-	Image result = (*this);
+	return GetBoxBlurredImage(*this, blurRadius);
+}
 
-	int numTexelX = m_dimensions.x;
-	int numTexelY = m_dimensions.y;
+//-----------------------------------------------------------------------------------------------
+std::vector<Image> LoadImagesFromFiles(std::vector<std::string> const& imageFilePaths, WorkerPool* workers /*= nullptr*/, bool flipVertically /*= true*/)
+{
+	std::vector<Image> images(imageFilePaths.size());
+	auto loadImage = [&](int imageIndex)
+		{
+			images[imageIndex] = Image(imageFilePaths[imageIndex].c_str(), flipVertically);
+		};
 
-	for (int texelY = 0; texelY < numTexelY; ++texelY)
+	if (workers)
 	{
-		for (int texelX = 0; texelX < numTexelX; ++texelX)
+		workers->ParallelFor(static_cast<int>(images.size()), loadImage);
+	}
+	else
+	{
+		for (int imageIndex = 0; imageIndex < static_cast<int>(images.size()); ++imageIndex)
 		{
-			float sumR = 0.f;
-			float sumG = 0.f;
-			float sumB = 0.f;
-			float sumA = 0.f;
-			int count = 0;
-
-			for (int ky = -blurRadius; ky <= blurRadius; ++ky)
-			{
-				for (int kx = -blurRadius; kx <= blurRadius; ++kx)
-				{
-					int neighborX = texelX + kx;
-					int neighborY = texelY + ky;
-					IntVec2 neighborCoords(neighborX, neighborY);
-					if (IsInBounds(neighborCoords))
-					{
-						Rgba8 neighborColor = GetTexelColor(neighborCoords);
-						sumR += NormalizeByte(neighborColor.r);
-						sumG += NormalizeByte(neighborColor.g);
-						sumB += NormalizeByte(neighborColor.b);
-						sumA += NormalizeByte(neighborColor.a);
-						++count;
-					}
-				}
-			}
-
-			result.SetTexelColor(IntVec2(texelX, texelY), Rgba8(DenormalizeByte(sumR / count), DenormalizeByte(sumG / count), DenormalizeByte(sumB / count), DenormalizeByte(sumA / count)));
+			loadImage(imageIndex);
 		}
 	}
+	return images;
+}
 
-	return result;
+//-----------------------------------------------------------------------------------------------
+bool GetImageFileInfo(char const* imageFilePath, IntVec2& out_dimensions)
+{
+	int numComponents = 0;
+	ByteSpan fileSpan;
+	std::vector<uint8_t> fileStorage;
+	int isImage = 0;
+	if (g_theFileSystem && g_theFileSystem->GetFileSpan(imageFilePath, fileSpan, fileStorage))
+	{
+		isImage = stbi_info_from_memory(fileSpan.m_data, static_cast<int>(fileSpan.m_size), &out_dimensions.x, &out_dimensions.y, &numComponents);
+	}
+	else
+	{
+		isImage = stbi_info(imageFilePath, &out_dimensions.x, &out_dimensions.y, &numComponents);
+	}
+	return isImage != 0 && out_dimensions.x > 0 && out_dimensions.y > 0;
 }
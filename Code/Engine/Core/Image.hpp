@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+class WorkerPool;
+
 //-----------------------------------------------------------------------------------------------
 // Only Support channel size = 8 bit
 // not support hdr image, it needs to use stbi_loadf
@@ -16,11 +18,20 @@ public:
 	~Image();
 	Image(char const* imageFilePath, bool flipVertically = true);
 	Image(IntVec2 size, Rgba8 color, char const* imageFilePath = "UNKNOWN");
+	Image(Image const& copyFrom) = default;
+	Image(Image&& moveFrom) = default;
+	Image& operator=(Image const& copyFrom) = default;
+	Image& operator=(Image&& moveFrom) = default;
 
+	// Like the file constructor, through g_theFileSystem when it resolves the path, but a missing,
+	// truncated or undecodable file returns false and leaves the image as it was instead of dying
+	bool LoadFromFile(char const* imageFilePath, bool flipVertically = true);
 
 	IntVec2		GetDimensions() const;
 	std::string const& GetImageFilePath() const;
 	const void* GetRawData() const;
+	Rgba8* GetRawTexels(); // row-major, for ImageProcessing
+	Rgba8 const* GetRawTexels() const;
 
 	bool	IsInBounds(IntVec2 const& tileCoords) const;
 	Rgba8	GetTexelColor(IntVec2 const& texelCoords) const;
@@ -34,3 +45,8 @@ private:
 	IntVec2			m_dimensions = IntVec2(0, 0);
 	std::vector< Rgba8 >		m_rgbaTexels;  // or Rgba8* m_rgbaTexels = nullptr; if you prefer new[] and delete[]
 };
+
+// Decodes every file on the pool's threads, images keep the order of the paths
+std::vector<Image> LoadImagesFromFiles(std::vector<std::string> const& imageFilePaths, WorkerPool* workers = nullptr, bool flipVertically = true);
+// Reads only the header, through g_theFileSystem when it resolves the path. False if stb_image cannot decode the file
+bool GetImageFileInfo(char const* imageFilePath, IntVec2& out_dimensions);
@@ -0,0 +1,546 @@
+#include "Engine/Core/ImageProcessing.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+	#define IMAGE_PROCESSING_USE_SSE
+	#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Enough rows per band that a band outweighs handing it to a worker
+	constexpr int ROWS_PER_BAND = 32;
+
+	template <typename BandFunction>
+	void ForEachRowBand(int numRows, WorkerPool* workers, BandFunction const& bandFunction)
+	{
+		int numBands = (numRows + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+		if (workers && numBands > 1)
+		{
+			workers->ParallelFor(numBands, [&bandFunction, numRows](int bandIndex)
+				{
+					int firstRow = bandIndex * ROWS_PER_BAND;
+					int endRow = (firstRow + ROWS_PER_BAND < numRows) ? firstRow + ROWS_PER_BAND : numRows;
+					bandFunction(firstRow, endRow);
+				});
+		}
+		else if (numRows > 0)
+		{
+			bandFunction(0, numRows);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// One texel as four floats in 0 to 255, a single SSE register when available
+#ifdef IMAGE_PROCESSING_USE_SSE
+	typedef __m128 Texel4;
+
+	inline Texel4 ZeroTexel4() { return _mm_setzero_ps(); }
+	inline Texel4 LoadTexel4(float const* values) { return _mm_loadu_ps(values); }
+	inline void StoreTexel4(float* values, Texel4 texel) { _mm_storeu_ps(values, texel); }
+	inline Texel4 MultiplyAddTexel4(Texel4 sum, Texel4 texel, float weight) { return _mm_add_ps(sum, _mm_mul_ps(texel, _mm_set1_ps(weight))); }
+
+	inline Texel4 ConvertToTexel4(Rgba8 const& color)
+	{
+		int packed = color.r | (color.g << 8) | (color.b << 16) | (color.a << 24);
+		__m128i const zero = _mm_setzero_si128();
+		__m128i bytes = _mm_cvtsi32_si128(packed);
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+	}
+
+	inline Rgba8 ConvertToRgba8(Texel4 texel)
+	{
+		texel = _mm_min_ps(_mm_max_ps(texel, _mm_setzero_ps()), _mm_set1_ps(255.f));
+		__m128i words = _mm_cvtps_epi32(texel);
+		words = _mm_packs_epi32(words, words);
+		unsigned int packed = static_cast<unsigned int>(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+		return Rgba8(static_cast<unsigned char>(packed), static_cast<unsigned char>(packed >> 8), static_cast<unsigned char>(packed >> 16), static_cast<unsigned char>(packed >> 24));
+	}
+#else
+	struct Texel4
+	{
+		float m_values[4];
+	};
+
+	inline Texel4 ZeroTexel4() { return Texel4{ { 0.f, 0.f, 0.f, 0.f } }; }
+	inline Texel4 LoadTexel4(float const* values) { return Texel4{ { values[0], values[1], values[2], values[3] } }; }
+	inline void StoreTexel4(float* values, Texel4 texel) { memcpy(values, texel.m_values, sizeof(texel.m_values)); }
+
+	inline Texel4 MultiplyAddTexel4(Texel4 sum, Texel4 texel, float weight)
+	{
+		for (int channel = 0; channel < 4; ++channel)
+		{
+			sum.m_values[channel] += texel.m_values[channel] * weight;
+		}
+		return sum;
+	}
+
+	inline Texel4 ConvertToTexel4(Rgba8 const& color)
+	{
+		return Texel4{ { static_cast<float>(color.r), static_cast<float>(color.g), static_cast<float>(color.b), static_cast<float>(color.a) } };
+	}
+
+	inline unsigned char RoundToByte(float value)
+	{
+		value = (value < 0.f) ? 0.f : ((value > 255.f) ? 255.f : value);
+		return static_cast<unsigned char>(value + 0.5f);
+	}
+
+	inline Rgba8 ConvertToRgba8(Texel4 texel)
+	{
+		return Rgba8(RoundToByte(texel.m_values[0]), RoundToByte(texel.m_values[1]), RoundToByte(texel.m_values[2]), RoundToByte(texel.m_values[3]));
+	}
+#endif
+
+	//-------------------------------------------------------------------------------------------
+	// Source texels and weights of every destination texel along one axis, m_maxTaps apart
+	struct FilterTaps
+	{
+		int					m_maxTaps = 0;
+		std::vector<int>	m_firstSource;
+		std::vector<int>	m_numTaps;
+		std::vector<float>	m_weights;
+	};
+
+	typedef float (*FilterKernel)(float distance, float parameter);
+
+	float BoxKernel(float distance, float /*parameter*/)
+	{
+		return (distance >= -0.5f && distance < 0.5f) ? 1.f : 0.f;
+	}
+
+	float TentKernel(float distance, float /*parameter*/)
+	{
+		distance = fabsf(distance);
+		return (distance < 1.f) ? 1.f - distance : 0.f;
+	}
+
+	float Lanczos3Kernel(float distance, float /*parameter*/)
+	{
+		constexpr float PI = 3.14159265358979f;
+		distance = fabsf(distance);
+		if (distance < 1e-5f)
+		{
+			return 1.f;
+		}
+		if (distance >= 3.f)
+		{
+			return 0.f;
+		}
+		float piDistance = PI * distance;
+		return 3.f * sinf(piDistance) * sinf(piDistance / 3.f) / (piDistance * piDistance);
+	}
+
+	float GaussianKernel(float distance, float sigma)
+	{
+		return expf(-(distance * distance) / (2.f * sigma * sigma));
+	}
+
+	// Shrinking widens the kernel by the scale, so every source texel lands under some tap
+	FilterTaps MakeFilterTaps(int sourceSize, int destinationSize, float kernelRadius, FilterKernel kernel, float kernelParameter)
+	{
+		float scale = static_cast<float>(destinationSize) / static_cast<float>(sourceSize);
+		float kernelScale = (scale < 1.f) ? 1.f / scale : 1.f;
+		float support = kernelRadius * kernelScale;
+
+		FilterTaps taps;
+		taps.m_maxTaps = static_cast<int>(ceilf(support * 2.f)) + 2;
+		taps.m_firstSource.resize(destinationSize);
+		taps.m_numTaps.resize(destinationSize);
+		taps.m_weights.assign(static_cast<size_t>(destinationSize) * taps.m_maxTaps, 0.f);
+
+		for (int destination = 0; destination < destinationSize; ++destination)
+		{
+			float center = (static_cast<float>(destination) + 0.5f) / scale;
+			int firstSource = static_cast<int>(floorf(center - support));
+			int lastSource = static_cast<int>(ceilf(center + support));
+			firstSource = (firstSource < 0) ? 0 : firstSource;
+			lastSource = (lastSource > sourceSize - 1) ? sourceSize - 1 : lastSource;
+			if (lastSource - firstSource + 1 > taps.m_maxTaps)
+			{
+				lastSource = firstSource + taps.m_maxTaps - 1;
+			}
+
+			float* weights = taps.m_weights.data() + static_cast<size_t>(destination) * taps.m_maxTaps;
+			float weightSum = 0.f;
+			for (int source = firstSource; source <= lastSource; ++source)
+			{
+				float weight = kernel((static_cast<float>(source) + 0.5f - center) / kernelScale, kernelParameter);
+				weights[source - firstSource] = weight;
+				weightSum += weight;
+			}
+
+			if (weightSum == 0.f)
+			{
+				// Nothing under the kernel, take the nearest texel
+				int nearest = static_cast<int>(center);
+				firstSource = (nearest < sourceSize) ? nearest : sourceSize - 1;
+				lastSource = firstSource;
+				weights[0] = 1.f;
+				weightSum = 1.f;
+			}
+			for (int tapIndex = 0; tapIndex <= lastSource - firstSource; ++tapIndex)
+			{
+				weights[tapIndex] /= weightSum;
+			}
+			taps.m_firstSource[destination] = firstSource;
+			taps.m_numTaps[destination] = lastSource - firstSource + 1;
+		}
+		return taps;
+	}
+
+	Image ApplySeparableFilter(Image const& source, IntVec2 const& newDimensions, FilterTaps const& xTaps, FilterTaps const& yTaps, WorkerPool* workers)
+	{
+		IntVec2 const sourceDimensions = source.GetDimensions();
+		Rgba8 const* sourceTexels = source.GetRawTexels();
+
+		// Horizontal: source rows to float rows of the new width
+		std::vector<float> intermediate(static_cast<size_t>(newDimensions.x) * sourceDimensions.y * 4);
+		ForEachRowBand(sourceDimensions.y, workers, [&](int firstRow, int endRow)
+			{
+				std::vector<float> sourceRow(static_cast<size_t>(sourceDimensions.x) * 4);
+				for (int y = firstRow; y < endRow; ++y)
+				{
+					Rgba8 const* sourceTexelRow = sourceTexels + static_cast<size_t>(y) * sourceDimensions.x;
+					for (int x = 0; x < sourceDimensions.x; ++x)
+					{
+						StoreTexel4(sourceRow.data() + x * 4, ConvertToTexel4(sourceTexelRow[x]));
+					}
+
+					float* intermediateRow = intermediate.data() + static_cast<size_t>(y) * newDimensions.x * 4;
+					for (int x = 0; x < newDimensions.x; ++x)
+					{
+						float const* weights = xTaps.m_weights.data() + static_cast<size_t>(x) * xTaps.m_maxTaps;
+						float const* tapTexels = sourceRow.data() + xTaps.m_firstSource[x] * 4;
+						Texel4 sum = ZeroTexel4();
+						for (int tapIndex = 0; tapIndex < xTaps.m_numTaps[x]; ++tapIndex)
+						{
+							sum = MultiplyAddTexel4(sum, LoadTexel4(tapTexels + tapIndex * 4), weights[tapIndex]);
+						}
+						StoreTexel4(intermediateRow + x * 4, sum);
+					}
+				}
+			});
+
+		// Vertical: whole intermediate rows scaled and summed, then rounded into the result
+		Image result(newDimensions, Rgba8(0, 0, 0, 0), source.GetImageFilePath().c_str());
+		Rgba8* resultTexels = result.GetRawTexels();
+		int const rowFloats = newDimensions.x * 4;
+		ForEachRowBand(newDimensions.y, workers, [&](int firstRow, int endRow)
+			{
+				std::vector<float> sumRow(rowFloats);
+				for (int y = firstRow; y < endRow; ++y)
+				{
+					std::fill(sumRow.begin(), sumRow.end(), 0.f);
+					float const* weights = yTaps.m_weights.data() + static_cast<size_t>(y) * yTaps.m_maxTaps;
+					for (int tapIndex = 0; tapIndex < yTaps.m_numTaps[y]; ++tapIndex)
+					{
+						float const* intermediateRow = intermediate.data() + static_cast<size_t>(yTaps.m_firstSource[y] + tapIndex) * rowFloats;
+						float const weight = weights[tapIndex];
+						for (int valueIndex = 0; valueIndex < rowFloats; valueIndex += 4)
+						{
+							StoreTexel4(sumRow.data() + valueIndex, MultiplyAddTexel4(LoadTexel4(sumRow.data() + valueIndex), LoadTexel4(intermediateRow + valueIndex), weight));
+						}
+					}
+
+					Rgba8* resultRow = resultTexels + static_cast<size_t>(y) * newDimensions.x;
+					for (int x = 0; x < newDimensions.x; ++x)
+					{
+						resultRow[x] = ConvertToRgba8(LoadTexel4(sumRow.data() + x * 4));
+					}
+				}
+			});
+		return result;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+Image GetBoxBlurredImage(Image const& source, int blurRadius, WorkerPool* workers /*= nullptr*/)
+{
+	PROFILE_SCOPE("GetBoxBlurredImage");
+
+	IntVec2 const dimensions = source.GetDimensions();
+	if (blurRadius < 1 || dimensions.x <= 0 || dimensions.y <= 0)
+	{
+		return source;
+	}
+	int const width = dimensions.x;
+	int const height = dimensions.y;
+	Rgba8 const* sourceTexels = source.GetRawTexels();
+
+	// Horizontal: each row's window sums, one running sum per channel
+	std::vector<uint32_t> rowSums(static_cast<size_t>(width) * height * 4);
+	ForEachRowBand(height, workers, [&](int firstRow, int endRow)
+		{
+			for (int y = firstRow; y < endRow; ++y)
+			{
+				Rgba8 const* row = sourceTexels + static_cast<size_t>(y) * width;
+				uint32_t* sums = rowSums.data() + static_cast<size_t>(y) * width * 4;
+				uint32_t sumR = 0;
+				uint32_t sumG = 0;
+				uint32_t sumB = 0;
+				uint32_t sumA = 0;
+				for (int x = 0; x <= blurRadius && x < width; ++x)
+				{
+					sumR += row[x].r;
+					sumG += row[x].g;
+					sumB += row[x].b;
+					sumA += row[x].a;
+				}
+				for (int x = 0; x < width; ++x)
+				{
+					sums[x * 4 + 0] = sumR;
+					sums[x * 4 + 1] = sumG;
+					sums[x * 4 + 2] = sumB;
+					sums[x * 4 + 3] = sumA;
+
+					int leaving = x - blurRadius;
+					if (leaving >= 0)
+					{
+						sumR -= row[leaving].r;
+						sumG -= row[leaving].g;
+						sumB -= row[leaving].b;
+						sumA -= row[leaving].a;
+					}
+					int entering = x + blurRadius + 1;
+					if (entering < width)
+					{
+						sumR += row[entering].r;
+						sumG += row[entering].g;
+						sumB += row[entering].b;
+						sumA += row[entering].a;
+					}
+				}
+			}
+		});
+
+	// Taps inside the image along x, as a reciprocal
+	std::vector<double> inverseCountsX(width);
+	for (int x = 0; x < width; ++x)
+	{
+		int firstX = (x - blurRadius > 0) ? x - blurRadius : 0;
+		int lastX = (x + blurRadius < width - 1) ? x + blurRadius : width - 1;
+		inverseCountsX[x] = 1.0 / static_cast<double>(lastX - firstX + 1);
+	}
+
+	// Vertical: a running sum of row sums per band, updated a whole row at a time. Values are
+	// floor(mean * 256 / 255) like DenormalizeByte; a mean that is not exact sits at least
+	// 1 / (255 * count) from the next step, far more than the double rounding, which the small
+	// bias keeps exact results from falling below
+	Image result(dimensions, Rgba8(0, 0, 0, 0), source.GetImageFilePath().c_str());
+	Rgba8* resultTexels = result.GetRawTexels();
+	int const rowValues = width * 4;
+	ForEachRowBand(height, workers, [&](int firstRow, int endRow)
+		{
+			std::vector<uint64_t> columnSums(rowValues, 0);
+			int firstY = (firstRow - blurRadius > 0) ? firstRow - blurRadius : 0;
+			int lastY = (firstRow + blurRadius < height - 1) ? firstRow + blurRadius : height - 1;
+			for (int y = firstY; y <= lastY; ++y)
+			{
+				uint32_t const* sums = rowSums.data() + static_cast<size_t>(y) * rowValues;
+				for (int valueIndex = 0; valueIndex < rowValues; ++valueIndex)
+				{
+					columnSums[valueIndex] += sums[valueIndex];
+				}
+			}
+
+			for (int y = firstRow; y < endRow; ++y)
+			{
+				int windowFirstY = (y - blurRadius > 0) ? y - blurRadius : 0;
+				int windowLastY = (y + blurRadius < height - 1) ? y + blurRadius : height - 1;
+				double rowScale = 256.0 / (255.0 * static_cast<double>(windowLastY - windowFirstY + 1));
+
+				Rgba8* resultRow = resultTexels + static_cast<size_t>(y) * width;
+				for (int x = 0; x < width; ++x)
+				{
+					double scale = rowScale * inverseCountsX[x];
+					uint64_t const* sums = columnSums.data() + x * 4;
+					uint32_t red = static_cast<uint32_t>(static_cast<double>(sums[0]) * scale + 1e-10);
+					uint32_t green = static_cast<uint32_t>(static_cast<double>(sums[1]) * scale + 1e-10);
+					uint32_t blue = static_cast<uint32_t>(static_cast<double>(sums[2]) * scale + 1e-10);
+					uint32_t alpha = static_cast<uint32_t>(static_cast<double>(sums[3]) * scale + 1e-10);
+					resultRow[x].r = static_cast<unsigned char>((red > 255) ? 255 : red);
+					resultRow[x].g = static_cast<unsigned char>((green > 255) ? 255 : green);
+					resultRow[x].b = static_cast<unsigned char>((blue > 255) ? 255 : blue);
+					resultRow[x].a = static_cast<unsigned char>((alpha > 255) ? 255 : alpha);
+				}
+
+				int leaving = y - blurRadius;
+				if (leaving >= 0)
+				{
+					uint32_t const* sums = rowSums.data() + static_cast<size_t>(leaving) * rowValues;
+					for (int valueIndex = 0; valueIndex < rowValues; ++valueIndex)
+					{
+						columnSums[valueIndex] -= sums[valueIndex];
+					}
+				}
+				int entering = y + blurRadius + 1;
+				if (entering < height)
+				{
+					uint32_t const* sums = rowSums.data() + static_cast<size_t>(entering) * rowValues;
+					for (int valueIndex = 0; valueIndex < rowValues; ++valueIndex)
+					{
+						columnSums[valueIndex] += sums[valueIndex];
+					}
+				}
+			}
+		});
+	return result;
+}
+
+Image GetGaussianBlurredImage(Image const& source, float sigma, WorkerPool* workers /*= nullptr*/)
+{
+	PROFILE_SCOPE("GetGaussianBlurredImage");
+
+	IntVec2 const dimensions = source.GetDimensions();
+	if (sigma <= 0.f || dimensions.x <= 0 || dimensions.y <= 0)
+	{
+		return source;
+	}
+	float radius = ceilf(3.f * sigma);
+	FilterTaps xTaps = MakeFilterTaps(dimensions.x, dimensions.x, radius, GaussianKernel, sigma);
+	FilterTaps yTaps = MakeFilterTaps(dimensions.y, dimensions.y, radius, GaussianKernel, sigma);
+	return ApplySeparableFilter(source, dimensions, xTaps, yTaps, workers);
+}
+
+Image GetResizedImage(Image const& source, IntVec2 const& newDimensions, ImageResizeFilter filter /*= ImageResizeFilter::BILINEAR*/, WorkerPool* workers /*= nullptr*/)
+{
+	PROFILE_SCOPE("GetResizedImage");
+
+	IntVec2 const dimensions = source.GetDimensions();
+	GUARANTEE_OR_DIE(newDimensions.x > 0 && newDimensions.y > 0, Stringf("GetResizedImage: invalid new dimensions %i x %i", newDimensions.x, newDimensions.y));
+	if (dimensions.x <= 0 || dimensions.y <= 0)
+	{
+		return Image(newDimensions, Rgba8(0, 0, 0, 0), source.GetImageFilePath().c_str());
+	}
+
+	FilterKernel kernel = BoxKernel;
+	float radius = 0.5f;
+	if (filter == ImageResizeFilter::BILINEAR)
+	{
+		kernel = TentKernel;
+		radius = 1.f;
+	}
+	else if (filter == ImageResizeFilter::LANCZOS3)
+	{
+		kernel = Lanczos3Kernel;
+		radius = 3.f;
+	}
+	FilterTaps xTaps = MakeFilterTaps(dimensions.x, newDimensions.x, radius, kernel, 0.f);
+	FilterTaps yTaps = MakeFilterTaps(dimensions.y, newDimensions.y, radius, kernel, 0.f);
+	return ApplySeparableFilter(source, newDimensions, xTaps, yTaps, workers);
+}
+
+//-----------------------------------------------------------------------------------------------
+void PremultiplyAlpha(Image& image, WorkerPool* workers /*= nullptr*/)
+{
+	IntVec2 const dimensions = image.GetDimensions();
+	Rgba8* texels = image.GetRawTexels();
+	ForEachRowBand(dimensions.y, workers, [&](int firstRow, int endRow)
+		{
+			Rgba8* texel = texels + static_cast<size_t>(firstRow) * dimensions.x;
+			Rgba8* endTexel = texels + static_cast<size_t>(endRow) * dimensions.x;
+			for (; texel < endTexel; ++texel)
+			{
+				unsigned int alpha = texel->a;
+				texel->r = static_cast<unsigned char>((texel->r * alpha + 127) / 255);
+				texel->g = static_cast<unsigned char>((texel->g * alpha + 127) / 255);
+				texel->b = static_cast<unsigned char>((texel->b * alpha + 127) / 255);
+			}
+		});
+}
+
+void UnpremultiplyAlpha(Image& image, WorkerPool* workers /*= nullptr*/)
+{
+	IntVec2 const dimensions = image.GetDimensions();
+	Rgba8* texels = image.GetRawTexels();
+	ForEachRowBand(dimensions.y, workers, [&](int firstRow, int endRow)
+		{
+			Rgba8* texel = texels + static_cast<size_t>(firstRow) * dimensions.x;
+			Rgba8* endTexel = texels + static_cast<size_t>(endRow) * dimensions.x;
+			for (; texel < endTexel; ++texel)
+			{
+				unsigned int alpha = texel->a;
+				if (alpha == 0)
+				{
+					texel->r = texel->g = texel->b = 0;
+					continue;
+				}
+				unsigned int red = (texel->r * 255u + alpha / 2) / alpha;
+				unsigned int green = (texel->g * 255u + alpha / 2) / alpha;
+				unsigned int blue = (texel->b * 255u + alpha / 2) / alpha;
+				texel->r = static_cast<unsigned char>((red > 255) ? 255 : red);
+				texel->g = static_cast<unsigned char>((green > 255) ? 255 : green);
+				texel->b = static_cast<unsigned char>((blue > 255) ? 255 : blue);
+			}
+		});
+}
+
+//-----------------------------------------------------------------------------------------------
+int GetBytesPerTexel(ImageTexelFormat format)
+{
+	switch (format)
+	{
+	case ImageTexelFormat::RGBA8:	return 4;
+	case ImageTexelFormat::BGRA8:	return 4;
+	case ImageTexelFormat::RGB8:	return 3;
+	case ImageTexelFormat::A8:		return 1;
+	}
+	ERROR_AND_DIE("GetBytesPerTexel: unknown ImageTexelFormat");
+}
+
+void ConvertImageTexels(Image const& image, ImageTexelFormat format, std::vector<unsigned char>& out_bytes, WorkerPool* workers /*= nullptr*/)
+{
+	IntVec2 const dimensions = image.GetDimensions();
+	int const bytesPerTexel = GetBytesPerTexel(format);
+	out_bytes.resize(static_cast<size_t>(dimensions.x) * dimensions.y * bytesPerTexel);
+	if (out_bytes.empty())
+	{
+		return;
+	}
+
+	Rgba8 const* texels = image.GetRawTexels();
+	unsigned char* bytes = out_bytes.data();
+	ForEachRowBand(dimensions.y, workers, [&](int firstRow, int endRow)
+		{
+			size_t firstTexel = static_cast<size_t>(firstRow) * dimensions.x;
+			size_t endTexel = static_cast<size_t>(endRow) * dimensions.x;
+			unsigned char* out = bytes + firstTexel * bytesPerTexel;
+			switch (format)
+			{
+			case ImageTexelFormat::RGBA8:
+				memcpy(out, texels + firstTexel, (endTexel - firstTexel) * sizeof(Rgba8));
+				break;
+			case ImageTexelFormat::BGRA8:
+				for (size_t texelIndex = firstTexel; texelIndex < endTexel; ++texelIndex, out += 4)
+				{
+					out[0] = texels[texelIndex].b;
+					out[1] = texels[texelIndex].g;
+					out[2] = texels[texelIndex].r;
+					out[3] = texels[texelIndex].a;
+				}
+				break;
+			case ImageTexelFormat::RGB8:
+				for (size_t texelIndex = firstTexel; texelIndex < endTexel; ++texelIndex, out += 3)
+				{
+					out[0] = texels[texelIndex].r;
+					out[1] = texels[texelIndex].g;
+					out[2] = texels[texelIndex].b;
+				}
+				break;
+			case ImageTexelFormat::A8:
+				for (size_t texelIndex = firstTexel; texelIndex < endTexel; ++texelIndex, ++out)
+				{
+					*out = texels[texelIndex].a;
+				}
+				break;
+			}
+		});
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <vector>
+
+class WorkerPool;
+
+//-----------------------------------------------------------------------------------------------
+// Image kernels working on whole texel rows instead of GetTexelColor/SetTexelColor.
+//
+// Blurs and resizes are separable: a horizontal pass into a row-major intermediate, then a vertical
+// pass that walks the intermediate row by row, so both passes read memory in order. Every pass is
+// split into bands of rows, an optional WorkerPool runs the bands in parallel. Edges are handled
+// like GetBoxBlurred: taps outside the image are dropped and the remaining weights renormalized.
+//
+enum class ImageResizeFilter
+{
+	BOX,		// area average when shrinking, nearest texel when growing
+	BILINEAR,	// tent, widened when shrinking so every source texel counts
+	LANCZOS3,	// sharpest, can ring on hard edges
+};
+
+enum class ImageTexelFormat
+{
+	RGBA8,
+	BGRA8,
+	RGB8,
+	A8,
+};
+
+// Sliding window mean over a (2 * blurRadius + 1) square, O(1) per texel whatever the radius.
+// Integer sums, so it matches GetBoxBlurred's rounding without its float error
+Image GetBoxBlurredImage(Image const& source, int blurRadius, WorkerPool* workers = nullptr);
+// Taps out to 3 sigma
+Image GetGaussianBlurredImage(Image const& source, float sigma, WorkerPool* workers = nullptr);
+Image GetResizedImage(Image const& source, IntVec2 const& newDimensions, ImageResizeFilter filter = ImageResizeFilter::BILINEAR, WorkerPool* workers = nullptr);
+
+// rgb *= a, rounded, before filtering or mipmapping images with transparent texels
+void PremultiplyAlpha(Image& image, WorkerPool* workers = nullptr);
+void UnpremultiplyAlpha(Image& image, WorkerPool* workers = nullptr);
+
+// Tightly packed rows, in the Image's row order
+void ConvertImageTexels(Image const& image, ImageTexelFormat format, std::vector<unsigned char>& out_bytes, WorkerPool* workers = nullptr);
+int GetBytesPerTexel(ImageTexelFormat format);
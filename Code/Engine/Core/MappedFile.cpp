@@ -0,0 +1,135 @@
+#include "Engine/Core/MappedFile.hpp"
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+//-----------------------------------------------------------------------------------------------
+bool MappedFile::Open(std::string const& filePath)
+{
+	Close();
+
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	// A zero length mapping is an error on Windows, an empty file simply has no data
+	if (fileSize.QuadPart > 0)
+	{
+		HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* view = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (view == nullptr)
+		{
+			if (mappingHandle)
+			{
+				CloseHandle(mappingHandle);
+			}
+			CloseHandle(fileHandle);
+			return false;
+		}
+		m_mappingHandle = mappingHandle;
+		m_data = static_cast<uint8_t const*>(view);
+	}
+
+	m_fileHandle = fileHandle;
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	m_filePath = filePath;
+	m_isOpen = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+	}
+	if (m_fileHandle)
+	{
+		CloseHandle(m_fileHandle);
+	}
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+	m_filePath.clear();
+	m_isOpen = false;
+}
+
+#else
+//-----------------------------------------------------------------------------------------------
+bool MappedFile::Open(std::string const& filePath)
+{
+	Close();
+
+	int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+	{
+		close(fileDescriptor);
+		return false;
+	}
+
+	// The mapping keeps the file alive, the descriptor is not needed past mmap
+	size_t fileSize = static_cast<size_t>(fileStatus.st_size);
+	if (fileSize > 0)
+	{
+		void* view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (view == MAP_FAILED)
+		{
+			close(fileDescriptor);
+			return false;
+		}
+		m_data = static_cast<uint8_t const*>(view);
+	}
+	close(fileDescriptor);
+
+	m_size = fileSize;
+	m_filePath = filePath;
+	m_isOpen = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data)
+	{
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_filePath.clear();
+	m_isOpen = false;
+}
+#endif
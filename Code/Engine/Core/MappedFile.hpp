@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//-----------------------------------------------------------------------------------------------
+// Bytes owned by someone else, valid as long as the owner keeps them
+struct ByteSpan
+{
+	uint8_t const*	m_data = nullptr;
+	size_t			m_size = 0;
+
+	ByteSpan() = default;
+	ByteSpan(uint8_t const* data, size_t size) : m_data(data), m_size(size) {}
+
+	bool IsEmpty() const { return m_size == 0; }
+	uint8_t const* begin() const { return m_data; }
+	uint8_t const* end() const { return m_data + m_size; }
+};
+
+//-----------------------------------------------------------------------------------------------
+// Read only memory mapping of a whole file. The OS pages bytes in on first touch, so opening a
+// large archive costs nothing until it is read, and untouched parts are never read at all.
+//
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(MappedFile const& copy) = delete;
+	MappedFile& operator=(MappedFile const& copy) = delete;
+
+	// False, quietly, if the file cannot be opened or mapped. An empty file opens with no data
+	bool Open(std::string const& filePath);
+	void Close();
+
+	bool IsOpen() const { return m_isOpen; }
+	std::string const& GetFilePath() const { return m_filePath; }
+	uint8_t const* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+	ByteSpan GetSpan() const { return ByteSpan(m_data, m_size); }
+
+private:
+	std::string		m_filePath;
+	uint8_t const*	m_data = nullptr;
+	size_t			m_size = 0;
+	bool			m_isOpen = false;
+#if defined(_WIN32)
+	void*			m_fileHandle = nullptr;
+	void*			m_mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,587 @@
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_USE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_USE_RDTSC
+#else
+#include <chrono>
+#endif
+
+// only be seen in this cpp
+namespace
+{
+	constexpr double	MIN_CALIBRATION_SECONDS = 0.01;
+	constexpr int		MAX_FRAMES_KEPT = 1024;
+
+	struct ProfilerEvent
+	{
+		char const*	m_name = nullptr;
+		uint64_t	m_startTicks = 0;
+		uint64_t	m_endTicks = 0;
+		uint32_t	m_depth = 0;
+	};
+
+	// A ring slot. Relaxed atomics cost plain moves on x86 and make the main thread's reads of a
+	// slot being overwritten well defined; those reads are then thrown away, see ReadThreadEvents
+	struct ProfilerEventSlot
+	{
+		std::atomic<char const*>	m_name{ nullptr };
+		std::atomic<uint64_t>		m_startTicks{ 0 };
+		std::atomic<uint64_t>		m_endTicks{ 0 };
+		std::atomic<uint32_t>		m_depth{ 0 };
+	};
+
+	// Written only by the owning thread, which bumps m_writeCount after each event. Event n lives
+	// in slot n & m_indexMask, so writing event n overwrites event n - capacity.
+	struct ProfilerThreadBuffer
+	{
+		std::vector<ProfilerEventSlot>	m_slots;
+		uint64_t						m_indexMask = 0;
+		std::atomic<uint64_t>			m_writeCount{ 0 };
+		uint32_t						m_depth = 0;
+		uint32_t						m_threadIndex = 0;
+		// Set when the owning thread exits, the next frame folds what is left and recycles the ring
+		std::atomic<bool>				m_isRetired{ false };
+
+		// Main thread only, for the frame summary
+		uint64_t						m_summaryReadCount = 0;
+		std::vector<uint64_t>			m_childTicksByDepth;
+	};
+
+	ProfilerConfig		s_config;
+	bool				s_isStarted = false;
+	std::atomic<bool>	s_isEnabled{ true };
+	bool				s_isOverlayVisible = false;
+
+	std::mutex							s_threadBuffersMutex;
+	std::vector<ProfilerThreadBuffer*>	s_threadBuffers;
+	// Rings of exited threads, handed to the next new thread instead of allocating another
+	std::vector<ProfilerThreadBuffer*>	s_freeThreadBuffers;
+	uint32_t							s_numThreadsSeen = 0;
+	// Bumped on startup and shutdown so threads drop buffer pointers from an earlier session
+	std::atomic<uint32_t>				s_session{ 0 };
+
+	thread_local ProfilerThreadBuffer*	t_threadBuffer = nullptr;
+	thread_local uint32_t				t_threadBufferSession = 0;
+
+	// Destroyed on thread exit, retires the thread's ring. Worker pools and streamers that restart
+	// would otherwise leave one ring per thread they ever ran
+	struct ProfilerThreadBufferOwner
+	{
+		~ProfilerThreadBufferOwner()
+		{
+			std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+			if (t_threadBuffer != nullptr && t_threadBufferSession == s_session.load(std::memory_order_relaxed))
+			{
+				t_threadBuffer->m_isRetired.store(true, std::memory_order_release);
+			}
+			t_threadBuffer = nullptr;
+		}
+	};
+	thread_local ProfilerThreadBufferOwner	t_threadBufferOwner;
+
+	std::vector<ProfilerEvent>	s_eventScratch;		// main thread, events copied out of a ring
+
+	uint64_t	s_baseTicks = 0;
+	double		s_baseSeconds = 0.0;
+	double		s_secondsPerTick = 1e-9;
+
+	uint64_t				s_currentFrameStartTicks = 0;
+	std::vector<uint64_t>	s_frameStartTicks;		// ring of the last MAX_FRAMES_KEPT frame starts
+	uint64_t				s_numFramesStarted = 0;
+
+	std::vector<ProfilerScopeSummary>				s_frameSummary;
+	std::vector<ProfilerScopeSummary>				s_lastFrameSummary;
+	std::unordered_map<std::string_view, int>		s_summaryIndexByName;
+	double											s_lastFrameSeconds = 0.0;
+
+	ProfilerThreadBuffer* GetThreadBuffer()
+	{
+		uint32_t session = s_session.load(std::memory_order_acquire);
+		if ((session & 1) == 0)
+		{
+			return nullptr; // not started, odd sessions are running ones
+		}
+		if (t_threadBuffer != nullptr && t_threadBufferSession == session)
+		{
+			return t_threadBuffer;
+		}
+
+		std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+		if (!s_isStarted)
+		{
+			return nullptr;
+		}
+		ProfilerThreadBuffer* buffer = nullptr;
+		if (!s_freeThreadBuffers.empty())
+		{
+			buffer = s_freeThreadBuffers.back();
+			s_freeThreadBuffers.pop_back();
+			buffer->m_writeCount.store(0, std::memory_order_relaxed);
+			buffer->m_depth = 0;
+			buffer->m_isRetired.store(false, std::memory_order_relaxed);
+			buffer->m_summaryReadCount = 0;
+			buffer->m_childTicksByDepth.clear();
+		}
+		else
+		{
+			uint64_t capacity = 1;
+			while (capacity < static_cast<uint64_t>(s_config.m_eventsPerThread))
+			{
+				capacity <<= 1;
+			}
+			buffer = new ProfilerThreadBuffer();
+			buffer->m_slots = std::vector<ProfilerEventSlot>(capacity);
+			buffer->m_indexMask = capacity - 1;
+		}
+		buffer->m_threadIndex = ++s_numThreadsSeen;
+		s_threadBuffers.push_back(buffer);
+
+		(void) t_threadBufferOwner; // odr-use, so the owner is constructed and destroyed with the thread
+		t_threadBuffer = buffer;
+		t_threadBufferSession = session;
+		return buffer;
+	}
+
+	// Copies events [firstCount, writeCount) of the ring into out_events, keeping only those the
+	// owner did not overwrite meanwhile. Seqlock style: the writer fences before touching a slot,
+	// so any slot value read here that belongs to a newer event makes the write count read after
+	// the acquire fence at least that new. Events that count says may be overwritten are dropped.
+	// Returns the write count the events were read up to
+	uint64_t ReadThreadEvents(ProfilerThreadBuffer const& buffer, uint64_t firstCount, std::vector<ProfilerEvent>& out_events)
+	{
+		out_events.clear();
+		uint64_t capacity = buffer.m_indexMask + 1;
+		uint64_t writeCount = buffer.m_writeCount.load(std::memory_order_acquire);
+		if (writeCount - firstCount > capacity)
+		{
+			firstCount = writeCount - capacity;
+		}
+
+		for (uint64_t readCount = firstCount; readCount < writeCount; ++readCount)
+		{
+			ProfilerEventSlot const& slot = buffer.m_slots[readCount & buffer.m_indexMask];
+			ProfilerEvent event;
+			event.m_name = slot.m_name.load(std::memory_order_relaxed);
+			event.m_startTicks = slot.m_startTicks.load(std::memory_order_relaxed);
+			event.m_endTicks = slot.m_endTicks.load(std::memory_order_relaxed);
+			event.m_depth = slot.m_depth.load(std::memory_order_relaxed);
+			out_events.push_back(event);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t latestWriteCount = buffer.m_writeCount.load(std::memory_order_relaxed);
+		// The owner may be writing event latestWriteCount, overwriting latestWriteCount - capacity
+		if (latestWriteCount >= capacity && latestWriteCount - capacity >= firstCount)
+		{
+			size_t numOverwritten = static_cast<size_t>(std::min(latestWriteCount - capacity + 1 - firstCount, writeCount - firstCount));
+			out_events.erase(out_events.begin(), out_events.begin() + numOverwritten);
+		}
+		return writeCount;
+	}
+
+	void CalibrateTicks(uint64_t currentTicks)
+	{
+		double elapsedSeconds = GetCurrentTimeSeconds() - s_baseSeconds;
+		if (elapsedSeconds >= MIN_CALIBRATION_SECONDS && currentTicks > s_baseTicks)
+		{
+			s_secondsPerTick = elapsedSeconds / static_cast<double>(currentTicks - s_baseTicks);
+		}
+	}
+
+	void FoldEventIntoSummary(ProfilerEvent const& event, uint64_t exclusiveTicks)
+	{
+		std::string_view name(event.m_name);
+		auto found = s_summaryIndexByName.find(name);
+		int summaryIndex;
+		if (found == s_summaryIndexByName.end())
+		{
+			summaryIndex = static_cast<int>(s_frameSummary.size());
+			s_summaryIndexByName.emplace(name, summaryIndex);
+			s_frameSummary.emplace_back();
+			s_frameSummary.back().m_name = event.m_name;
+		}
+		else
+		{
+			summaryIndex = found->second;
+		}
+
+		double seconds = static_cast<double>(event.m_endTicks - event.m_startTicks) * s_secondsPerTick;
+		ProfilerScopeSummary& summary = s_frameSummary[summaryIndex];
+		summary.m_numCalls++;
+		summary.m_inclusiveSeconds += seconds;
+		summary.m_exclusiveSeconds += static_cast<double>(exclusiveTicks) * s_secondsPerTick;
+		summary.m_maxSeconds = (seconds > summary.m_maxSeconds) ? seconds : summary.m_maxSeconds;
+	}
+
+	// Events land in completion order, so all children of a scope are read before the scope
+	// itself. Their time piles up one level deeper and is claimed by the parent when it ends.
+	void FoldThreadBufferIntoSummary(ProfilerThreadBuffer& buffer)
+	{
+		uint64_t writeCount = ReadThreadEvents(buffer, buffer.m_summaryReadCount, s_eventScratch);
+		for (ProfilerEvent const& event : s_eventScratch)
+		{
+			size_t depth = event.m_depth;
+			if (buffer.m_childTicksByDepth.size() < depth + 2)
+			{
+				buffer.m_childTicksByDepth.resize(depth + 2, 0);
+			}
+			uint64_t inclusiveTicks = event.m_endTicks - event.m_startTicks;
+			uint64_t childTicks = buffer.m_childTicksByDepth[depth + 1];
+			buffer.m_childTicksByDepth[depth + 1] = 0;
+			buffer.m_childTicksByDepth[depth] += inclusiveTicks;
+
+			FoldEventIntoSummary(event, (inclusiveTicks > childTicks) ? inclusiveTicks - childTicks : 0);
+		}
+		buffer.m_summaryReadCount = writeCount;
+	}
+
+	void AppendJsonEscaped(std::string& out, char const* text)
+	{
+		for (char const* c = text; *c != '\0'; ++c)
+		{
+			if (*c == '"' || *c == '\\')
+			{
+				out += '\\';
+				out += *c;
+			}
+			else if (static_cast<unsigned char>(*c) < 0x20)
+			{
+				out += ' ';
+			}
+			else
+			{
+				out += *c;
+			}
+		}
+	}
+
+	double TicksToTraceMicroseconds(uint64_t ticks)
+	{
+		return static_cast<double>(ticks - s_baseTicks) * s_secondsPerTick * 1000000.0;
+	}
+
+	void PrintProfilerLine(Rgba8 const& color, std::string const& text)
+	{
+		if (g_theDevConsole)
+		{
+			g_theDevConsole->AddText(color, text);
+		}
+		else
+		{
+			DebuggerPrintf("%s\n", text.c_str());
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+#pragma region Setup
+void ProfilerStartup(ProfilerConfig const& config)
+{
+	{
+		std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+		if (s_isStarted)
+		{
+			return;
+		}
+		s_config = config;
+		s_isStarted = true;
+	}
+
+	s_baseSeconds = GetCurrentTimeSeconds();
+	s_baseTicks = ProfilerGetTicks();
+#if defined(PROFILER_USE_RDTSC)
+	// rdtsc has no documented frequency, measure a first estimate that ProfilerBeginFrame refines
+	while (GetCurrentTimeSeconds() - s_baseSeconds < MIN_CALIBRATION_SECONDS)
+	{
+	}
+	CalibrateTicks(ProfilerGetTicks());
+#endif
+
+	s_currentFrameStartTicks = ProfilerGetTicks();
+	s_frameStartTicks.assign(MAX_FRAMES_KEPT, 0);
+	s_numFramesStarted = 0;
+	s_session.fetch_add(1, std::memory_order_release);
+
+	if (g_theEventSystem)
+	{
+		g_theEventSystem->SubscribeEventCallbackFunction("Profiler", Command_Profiler);
+	}
+}
+
+// Threads still inside a PROFILE_SCOPE must be joined first, their buffers are freed here
+void ProfilerShutdown()
+{
+	if (g_theEventSystem)
+	{
+		g_theEventSystem->UnsubscribeEventCallbackFunction("Profiler", Command_Profiler);
+	}
+
+	std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+	if (!s_isStarted)
+	{
+		return;
+	}
+	s_isStarted = false;
+	s_session.fetch_add(1, std::memory_order_release);
+	for (ProfilerThreadBuffer* buffer : s_threadBuffers)
+	{
+		delete buffer;
+	}
+	for (ProfilerThreadBuffer* buffer : s_freeThreadBuffers)
+	{
+		delete buffer;
+	}
+	s_threadBuffers.clear();
+	s_freeThreadBuffers.clear();
+	s_numThreadsSeen = 0;
+	s_frameSummary.clear();
+	s_lastFrameSummary.clear();
+	s_summaryIndexByName.clear();
+	s_lastFrameSeconds = 0.0;
+}
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+#pragma region Control
+void ProfilerSetEnabled(bool isEnabled)
+{
+	s_isEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+bool ProfilerIsEnabled()
+{
+	return s_isEnabled.load(std::memory_order_relaxed);
+}
+
+void ProfilerSetOverlayVisible(bool isVisible)
+{
+	s_isOverlayVisible = isVisible;
+}
+
+bool ProfilerIsOverlayVisible()
+{
+	return s_isOverlayVisible;
+}
+
+void ProfilerBeginFrame()
+{
+	if (!s_isStarted)
+	{
+		return;
+	}
+
+	uint64_t frameEndTicks = ProfilerGetTicks();
+	CalibrateTicks(frameEndTicks);
+	s_lastFrameSeconds = static_cast<double>(frameEndTicks - s_currentFrameStartTicks) * s_secondsPerTick;
+	s_frameStartTicks[s_numFramesStarted % MAX_FRAMES_KEPT] = s_currentFrameStartTicks;
+	s_numFramesStarted++;
+	s_currentFrameStartTicks = frameEndTicks;
+
+	s_frameSummary.clear();
+	s_summaryIndexByName.clear();
+	{
+		std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+		for (int bufferIndex = 0; bufferIndex < static_cast<int>(s_threadBuffers.size()); ++bufferIndex)
+		{
+			ProfilerThreadBuffer* buffer = s_threadBuffers[bufferIndex];
+			// Checked before folding: once retired the owner writes nothing more, so this fold is its last
+			bool isRetired = buffer->m_isRetired.load(std::memory_order_acquire);
+			FoldThreadBufferIntoSummary(*buffer);
+			if (isRetired)
+			{
+				s_freeThreadBuffers.push_back(buffer);
+				s_threadBuffers[bufferIndex] = s_threadBuffers.back();
+				s_threadBuffers.pop_back();
+				--bufferIndex;
+			}
+		}
+	}
+
+	std::sort(s_frameSummary.begin(), s_frameSummary.end(),
+		[](ProfilerScopeSummary const& a, ProfilerScopeSummary const& b) { return a.m_exclusiveSeconds > b.m_exclusiveSeconds; });
+	s_lastFrameSummary.swap(s_frameSummary);
+}
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+#pragma region Output
+std::vector<ProfilerScopeSummary> const& ProfilerGetLastFrameSummary()
+{
+	return s_lastFrameSummary;
+}
+
+double ProfilerGetLastFrameSeconds()
+{
+	return s_lastFrameSeconds;
+}
+
+void ProfilerGetSummaryLines(Strings& out_lines, int maxScopes /*= -1*/)
+{
+	out_lines.clear();
+	if (maxScopes < 0)
+	{
+		maxScopes = s_config.m_overlayLines;
+	}
+	int numScopes = std::min(maxScopes, static_cast<int>(s_lastFrameSummary.size()));
+
+	out_lines.push_back(Stringf("Frame %.2f ms, %d scopes", s_lastFrameSeconds * 1000.0, static_cast<int>(s_lastFrameSummary.size())));
+	out_lines.push_back("   excl ms   incl ms    max ms  calls  name");
+	for (int index = 0; index < numScopes; ++index)
+	{
+		ProfilerScopeSummary const& summary = s_lastFrameSummary[index];
+		out_lines.push_back(Stringf("%10.3f%10.3f%10.3f%7d  %s",
+			summary.m_exclusiveSeconds * 1000.0, summary.m_inclusiveSeconds * 1000.0, summary.m_maxSeconds * 1000.0,
+			summary.m_numCalls, summary.m_name));
+	}
+}
+
+int ProfilerGetNumThreadBuffers()
+{
+	std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+	return static_cast<int>(s_threadBuffers.size() + s_freeThreadBuffers.size());
+}
+
+bool ProfilerExportChromeTrace(std::string const& filePath)
+{
+	if (!s_isStarted)
+	{
+		return false;
+	}
+
+	std::string json;
+	json.reserve(1024 * 1024);
+	json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Frames\"}}";
+
+	uint64_t firstFrame = (s_numFramesStarted > MAX_FRAMES_KEPT) ? s_numFramesStarted - MAX_FRAMES_KEPT : 0;
+	for (uint64_t frame = firstFrame; frame < s_numFramesStarted; ++frame)
+	{
+		uint64_t startTicks = s_frameStartTicks[frame % MAX_FRAMES_KEPT];
+		uint64_t endTicks = (frame + 1 < s_numFramesStarted) ? s_frameStartTicks[(frame + 1) % MAX_FRAMES_KEPT] : s_currentFrameStartTicks;
+		json += Stringf(",\n{\"name\":\"Frame %llu\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+			static_cast<unsigned long long>(frame), TicksToTraceMicroseconds(startTicks),
+			static_cast<double>(endTicks - startTicks) * s_secondsPerTick * 1000000.0);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+		for (ProfilerThreadBuffer const* buffer : s_threadBuffers)
+		{
+			json += Stringf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}",
+				buffer->m_threadIndex, buffer->m_threadIndex);
+
+			ReadThreadEvents(*buffer, 0, s_eventScratch);
+			for (ProfilerEvent const& event : s_eventScratch)
+			{
+				json += ",\n{\"name\":\"";
+				AppendJsonEscaped(json, event.m_name);
+				json += Stringf("\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+					buffer->m_threadIndex, TicksToTraceMicroseconds(event.m_startTicks),
+					static_cast<double>(event.m_endTicks - event.m_startTicks) * s_secondsPerTick * 1000000.0);
+			}
+		}
+	}
+	json += "\n]}\n";
+
+	return FileWriteFromString(json, filePath) >= 0;
+}
+
+bool Command_Profiler(EventArgs& args)
+{
+	ProfilerSetEnabled(args.GetValue("enabled", ProfilerIsEnabled()));
+	ProfilerSetOverlayVisible(args.GetValue("overlay", ProfilerIsOverlayVisible()));
+
+	std::string exportPath = args.GetValue("export", "");
+	if (!exportPath.empty())
+	{
+		if (ProfilerExportChromeTrace(exportPath))
+		{
+			PrintProfilerLine(DevConsole::INFO_MAJOR, "Profiler trace written to " + exportPath);
+		}
+		else
+		{
+			PrintProfilerLine(DevConsole::ERROR, "Profiler could not write " + exportPath);
+		}
+		return true;
+	}
+
+	Strings lines;
+	ProfilerGetSummaryLines(lines, static_cast<int>(s_lastFrameSummary.size()));
+	PrintProfilerLine(DevConsole::INFO_MAJOR, lines[0] + (ProfilerIsEnabled() ? "" : " (disabled)"));
+	for (int lineIndex = 1; lineIndex < static_cast<int>(lines.size()); ++lineIndex)
+	{
+		PrintProfilerLine(DevConsole::INFO_MINOR, lines[lineIndex]);
+	}
+	return true;
+}
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+uint64_t ProfilerGetTicks()
+{
+#if defined(PROFILER_USE_RDTSC)
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+double ProfilerGetSecondsPerTick()
+{
+	return s_secondsPerTick;
+}
+
+//-----------------------------------------------------------------------------------------------
+ProfileScope::ProfileScope(char const* name)
+{
+	if (!s_isEnabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer == nullptr)
+	{
+		return;
+	}
+	buffer->m_depth++;
+	m_name = name;
+	m_startTicks = ProfilerGetTicks();
+}
+
+ProfileScope::~ProfileScope()
+{
+	if (m_name == nullptr)
+	{
+		return;
+	}
+	uint64_t endTicks = ProfilerGetTicks();
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer == nullptr || buffer->m_depth == 0)
+	{
+		return; // the profiler restarted while this scope was open
+	}
+	buffer->m_depth--;
+
+	// The fence orders the previous count store before the slot stores, see ReadThreadEvents
+	uint64_t writeCount = buffer->m_writeCount.load(std::memory_order_relaxed);
+	ProfilerEventSlot& slot = buffer->m_slots[writeCount & buffer->m_indexMask];
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.m_name.store(m_name, std::memory_order_relaxed);
+	slot.m_startTicks.store(m_startTicks, std::memory_order_relaxed);
+	slot.m_endTicks.store(endTicks, std::memory_order_relaxed);
+	slot.m_depth.store(buffer->m_depth, std::memory_order_relaxed);
+	buffer->m_writeCount.store(writeCount + 1, std::memory_order_release);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// Hierarchical CPU profiler.
+//
+// PROFILE_SCOPE("Name") times the enclosing block. Every thread writes its finished scopes into
+// its own fixed size ring buffer, so recording takes no lock and never allocates; once a ring
+// wraps the oldest events are overwritten. Only the name pointer is stored, pass string literals.
+//
+// Clock::TickSystemClock marks frame boundaries. At each boundary the events of the frame that
+// just ended are folded into a per-name summary, shown by the "Profiler" console command and the
+// DebugRender overlay. Whatever is still in the rings can be exported as Chrome trace JSON for
+// chrome://tracing or ui.perfetto.dev.
+//
+// Define ENGINE_DISABLE_PROFILER to compile every PROFILE_SCOPE out.
+//
+struct ProfilerConfig
+{
+	int m_eventsPerThread = 65536;
+	int m_overlayLines = 16;
+};
+
+struct ProfilerScopeSummary
+{
+	char const*	m_name = nullptr;
+	int			m_numCalls = 0;
+	double		m_inclusiveSeconds = 0.0;
+	double		m_exclusiveSeconds = 0.0;	// minus the time spent in child scopes
+	double		m_maxSeconds = 0.0;			// longest single call
+};
+
+// Setup, EventSystem::Startup and Shutdown call these. A second ProfilerStartup is ignored
+void ProfilerStartup(ProfilerConfig const& config);
+void ProfilerShutdown();
+
+// Control
+void ProfilerSetEnabled(bool isEnabled);
+bool ProfilerIsEnabled();
+void ProfilerSetOverlayVisible(bool isVisible);
+bool ProfilerIsOverlayVisible();
+
+// Called by Clock::TickSystemClock, closes the current frame and builds its summary
+void ProfilerBeginFrame();
+
+// Output, all about the last completed frame. Summary is sorted by exclusive time, highest first
+std::vector<ProfilerScopeSummary> const& ProfilerGetLastFrameSummary();
+double ProfilerGetLastFrameSeconds();
+// maxScopes < 0 uses ProfilerConfig::m_overlayLines
+void ProfilerGetSummaryLines(Strings& out_lines, int maxScopes = -1);
+bool ProfilerExportChromeTrace(std::string const& filePath);
+// Rings in use plus those recycled from exited threads, at most the most threads ever alive at once
+int ProfilerGetNumThreadBuffers();
+
+// Profiler enabled=false overlay=true export=trace.json; no args prints the last frame summary
+bool Command_Profiler(EventArgs& args);
+
+//-----------------------------------------------------------------------------------------------
+uint64_t ProfilerGetTicks();
+double ProfilerGetSecondsPerTick();
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(char const* name);
+	~ProfileScope();
+	ProfileScope(ProfileScope const& copy) = delete;
+	ProfileScope& operator=(ProfileScope const& copy) = delete;
+
+private:
+	char const*	m_name = nullptr;
+	uint64_t	m_startTicks = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if defined(ENGINE_DISABLE_PROFILER)
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#endif
@@ -0,0 +1,132 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+// Handle into a SlotMap. The generation is bumped every time a slot is freed, so a handle kept
+// past the removal of its object fails the lookup instead of silently aliasing the next user.
+//
+struct SlotHandle
+{
+	static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	uint32_t m_index = INVALID_INDEX;
+	uint32_t m_generation = 0;
+
+	bool IsValid() const { return m_index != INVALID_INDEX; }
+	bool operator==(SlotHandle const& other) const { return m_index == other.m_index && m_generation == other.m_generation; }
+	bool operator!=(SlotHandle const& other) const { return !(*this == other); }
+};
+
+//-----------------------------------------------------------------------------------------------
+// Pool of T with O(1) add, remove and handle lookup.
+//
+// Slots are never destroyed, only recycled: Add() hands back an object in whatever state its
+// previous owner left it, so heap buffers inside T keep their capacity across reuse. The owner
+// resets the fields it cares about.
+//
+// Live objects are also tracked in a dense index list for iteration. Remove() swaps the last
+// live entry into the hole, so when removing while iterating, walk the dense indices backwards.
+//
+template<typename T>
+class SlotMap
+{
+public:
+	SlotHandle Add()
+	{
+		uint32_t slotIndex;
+		if (!m_freeSlots.empty())
+		{
+			slotIndex = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			slotIndex = static_cast<uint32_t>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		Slot& slot = m_slots[slotIndex];
+		slot.m_isAlive = true;
+		slot.m_denseIndex = static_cast<uint32_t>(m_dense.size());
+		m_dense.push_back(slotIndex);
+
+		SlotHandle handle;
+		handle.m_index = slotIndex;
+		handle.m_generation = slot.m_generation;
+		return handle;
+	}
+
+	bool Remove(SlotHandle handle)
+	{
+		if (!IsValid(handle))
+		{
+			return false;
+		}
+		Slot& slot = m_slots[handle.m_index];
+		uint32_t lastSlotIndex = m_dense.back();
+		m_dense[slot.m_denseIndex] = lastSlotIndex;
+		m_slots[lastSlotIndex].m_denseIndex = slot.m_denseIndex;
+		m_dense.pop_back();
+
+		slot.m_isAlive = false;
+		slot.m_generation++;
+		m_freeSlots.push_back(handle.m_index);
+		return true;
+	}
+
+	// Removes everything, slot storage is kept for reuse
+	void Clear()
+	{
+		for (uint32_t slotIndex : m_dense)
+		{
+			m_slots[slotIndex].m_isAlive = false;
+			m_slots[slotIndex].m_generation++;
+			m_freeSlots.push_back(slotIndex);
+		}
+		m_dense.clear();
+	}
+
+	bool IsValid(SlotHandle handle) const
+	{
+		return handle.m_index < m_slots.size() && m_slots[handle.m_index].m_isAlive && m_slots[handle.m_index].m_generation == handle.m_generation;
+	}
+
+	T* Get(SlotHandle handle)
+	{
+		return IsValid(handle) ? &m_slots[handle.m_index].m_value : nullptr;
+	}
+
+	T const* Get(SlotHandle handle) const
+	{
+		return IsValid(handle) ? &m_slots[handle.m_index].m_value : nullptr;
+	}
+
+	int GetCount() const { return static_cast<int>(m_dense.size()); }
+	int GetCapacity() const { return static_cast<int>(m_slots.size()); }
+
+	// Dense iteration, [0, GetCount())
+	T& GetAtDenseIndex(int denseIndex) { return m_slots[m_dense[denseIndex]].m_value; }
+	T const& GetAtDenseIndex(int denseIndex) const { return m_slots[m_dense[denseIndex]].m_value; }
+	SlotHandle GetHandleAtDenseIndex(int denseIndex) const
+	{
+		uint32_t slotIndex = m_dense[denseIndex];
+		SlotHandle handle;
+		handle.m_index = slotIndex;
+		handle.m_generation = m_slots[slotIndex].m_generation;
+		return handle;
+	}
+
+private:
+	struct Slot
+	{
+		T			m_value;
+		uint32_t	m_generation = 0;
+		uint32_t	m_denseIndex = 0;
+		bool		m_isAlive = false;
+	};
+
+	std::vector<Slot>		m_slots;
+	std::vector<uint32_t>	m_dense;		// slot index of every live object
+	std::vector<uint32_t>	m_freeSlots;
+};
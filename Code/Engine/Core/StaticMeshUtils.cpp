@@ -77,9 +77,10 @@ void OrthonormalizeTB(Vec3& tangent, Vec3& bitangent, Vec3 const& normal)
 //-----------------------------------------------------------------------------------------------
 bool LoadOBJFromXML(std::vector<Vertex_PCUTBN>& out_verts, const char* modelXmlFilePath)
 {
+	// Read through FileReadToString rather than LoadFile so the XML resolves through g_theFileSystem
+	std::string modelXmlText;
 	XmlDocument modelXML;
-	XmlResult result = modelXML.LoadFile(modelXmlFilePath);
-	if (result != tinyxml2::XML_SUCCESS)
+	if (FileReadToString(modelXmlText, modelXmlFilePath) < 0 || modelXML.Parse(modelXmlText.c_str(), modelXmlText.size()) != tinyxml2::XML_SUCCESS)
 	{
 		ERROR_RECOVERABLE(Stringf("Failed to load OBJ from XML file \"%s\"", modelXmlFilePath));
 		return false;
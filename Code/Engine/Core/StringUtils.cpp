@@ -1,5 +1,7 @@
 #include "Engine/Core/StringUtils.hpp"
 #include <stdarg.h>
+#include <stdio.h>
+#include <wchar.h>
 
 
 //-----------------------------------------------------------------------------------------------
@@ -12,7 +14,7 @@ const std::string Stringf( char const* format, ... )
 	char textLiteral[ STRINGF_STACK_LOCAL_TEMP_LENGTH ];
 	va_list variableArgumentList;
 	va_start( variableArgumentList, format );
-	vsnprintf_s( textLiteral, STRINGF_STACK_LOCAL_TEMP_LENGTH, _TRUNCATE, format, variableArgumentList );	
+	vsnprintf( textLiteral, STRINGF_STACK_LOCAL_TEMP_LENGTH, format, variableArgumentList );	
 	va_end( variableArgumentList );
 	textLiteral[ STRINGF_STACK_LOCAL_TEMP_LENGTH - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
@@ -24,7 +26,7 @@ const std::wstring WStringf(const wchar_t* format, ...)
 	wchar_t textLiteral[STRINGF_STACK_LOCAL_TEMP_LENGTH];
 	va_list variableArgumentList;
 	va_start(variableArgumentList, format);
-	_vsnwprintf_s(textLiteral, STRINGF_STACK_LOCAL_TEMP_LENGTH, _TRUNCATE, format, variableArgumentList);
+	vswprintf(textLiteral, STRINGF_STACK_LOCAL_TEMP_LENGTH, format, variableArgumentList);
 	va_end(variableArgumentList);
 	textLiteral[STRINGF_STACK_LOCAL_TEMP_LENGTH - 1] = L'\0';
 
@@ -52,7 +54,7 @@ const std::string Stringf( int maxLength, char const* format, ... )
 
 	va_list variableArgumentList;
 	va_start( variableArgumentList, format );
-	vsnprintf_s( textLiteral, maxLength, _TRUNCATE, format, variableArgumentList );	
+	vsnprintf( textLiteral, maxLength, format, variableArgumentList );	
 	va_end( variableArgumentList );
 	textLiteral[ maxLength - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
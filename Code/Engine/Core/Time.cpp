@@ -1,13 +1,18 @@
 //-----------------------------------------------------------------------------------------------
 // Time.cpp
-//	
+//
 
 //-----------------------------------------------------------------------------------------------
 #include "Engine/Core/Time.hpp"
+#if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#else
+#include <time.h>
+#endif
 
 
+#if defined(_WIN32)
 //-----------------------------------------------------------------------------------------------
 double InitializeTime( LARGE_INTEGER& out_initialTime )
 {
@@ -31,4 +36,28 @@ double GetCurrentTimeSeconds()
 	return currentSeconds;
 }
 
+#else
+//-----------------------------------------------------------------------------------------------
+// CLOCK_MONOTONIC never jumps with wall clock changes, same guarantee as QueryPerformanceCounter
+static timespec InitializeTime()
+{
+	timespec initialTime;
+	clock_gettime( CLOCK_MONOTONIC, &initialTime );
+	return initialTime;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+double GetCurrentTimeSeconds()
+{
+	static timespec initialTime = InitializeTime();
+	timespec currentTime;
+	clock_gettime( CLOCK_MONOTONIC, &currentTime );
+
+	double currentSeconds = static_cast< double >( currentTime.tv_sec - initialTime.tv_sec )
+		+ static_cast< double >( currentTime.tv_nsec - initialTime.tv_nsec ) * 1e-9;
+	return currentSeconds;
+}
+#endif
+
 
@@ -2,6 +2,7 @@
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/Vertex_PCUTBN.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/AABB3.hpp"
@@ -10,6 +11,7 @@
 #include "Engine/Math/Mat44.hpp"
 #include "Engine/Math/Plane3.hpp"
 #include "Engine/Math/FloatRange.hpp"
+#include <math.h>
 #include "Engine/Math/LineSegment2.hpp"
 #include "Engine/Math/Capsule2.hpp"
 #include "Engine/Math/Triangle2.hpp"
@@ -27,6 +29,7 @@ void TransformVertexArrayXY3D(int numVerts, Vertex_PCU* verts, float uniformScal
 
 void TransformVertexArray3D(std::vector<Vertex_PCU>& verts, Mat44 const& transform)
 {
+	PROFILE_SCOPE("TransformVertexArray3D");
 	int vertsSize = (int)verts.size();
 	for (int index = 0; index < vertsSize; ++index)
 	{
@@ -38,6 +41,7 @@ void TransformVertexArray3D(std::vector<Vertex_PCU>& verts, Mat44 const& transfo
 
 void TransformVertexArray3D(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform, bool changePosition /*= true*/, bool changeTBN /*= true*/)
 {
+	PROFILE_SCOPE("TransformVertexArray3D");
 	int vertsSize = (int)verts.size();
 	for (int index = 0; index < vertsSize; ++index)
 	{
@@ -601,6 +605,7 @@ void AddVertsForAABB3D(std::vector<Vertex_PCUTBN>& verts, std::vector<unsigned i
 
 void AddVertsForSphere3D(std::vector<Vertex_PCU>& verts, Vec3 const& center, float radius, Rgba8 const& color /*= Rgba8::OPAQUE_WHITE*/, AABB2 const& UVs /*= AABB2::ZERO_TO_ONE*/, int numSlices /*= 32*/, int numStacks /*= 16*/)
 {
+	PROFILE_SCOPE("AddVertsForSphere3D");
 	// simple version Change to slides version later
 	float const DEGREES_PER_SLICE = 360.f / static_cast<float>(numSlices);
 	float const DEGREES_PER_STACK = 180.f / static_cast<float>(numStacks);
@@ -631,6 +636,7 @@ void AddVertsForSphere3D(std::vector<Vertex_PCU>& verts, Vec3 const& center, flo
 
 void AddVertsForSphere3D(std::vector<Vertex_PCUTBN>& verts, std::vector<unsigned int>& indexes, Vec3 const& center, float radius, Rgba8 const& color /*= Rgba8::OPAQUE_WHITE*/, AABB2 const& UVs /*= AABB2::ZERO_TO_ONE*/, int numSlices /*= 32*/, int numStacks /*= 16*/)
 {
+	PROFILE_SCOPE("AddVertsForSphere3D");
 	float const DEGREES_PER_SLICE = 360.f / static_cast<float>(numSlices);
 	float const DEGREES_PER_STACK = 180.f / static_cast<float>(numStacks);
 	unsigned int const startIndex = static_cast<unsigned int>(verts.size());
@@ -692,6 +698,7 @@ void AddVertsForSphere3D(std::vector<Vertex_PCUTBN>& verts, std::vector<unsigned
 
 void AddVertsForUVSphere3D(std::vector<Vertex_PCU>& verts, Vec3 const& center, float radius, Rgba8 const& color /*= Rgba8::OPAQUE_WHITE*/, AABB2 const& UVs /*= AABB2::ZERO_TO_ONE*/, int numSlices /*= 32*/, int numStacks /*= 16*/)
 {
+	PROFILE_SCOPE("AddVertsForUVSphere3D");
 	float const DEGREES_PER_SLICE = 360.f / static_cast<float>(numSlices);
 	float const DEGREES_PER_STACK = 180.f / static_cast<float>(numStacks);
 
@@ -747,6 +754,7 @@ void AddVertsForUVSphere3D(std::vector<Vertex_PCU>& verts, Vec3 const& center, f
 
 void AddVertsForCylinder3D(std::vector<Vertex_PCU>& verts, Vec3 const& bottomCenter, Vec3 const& topCenter, float radius, Rgba8 const& color /*= Rgba8::OPAQUE_WHITE*/, AABB2 const& UVs /*= AABB2::ZERO_TO_ONE*/, int numSlices /*= 32*/)
 {
+	PROFILE_SCOPE("AddVertsForCylinder3D");
 	float const DEGREES_PER_SLICE = 360.f / static_cast<float>(numSlices);
 	Mat44 localSpace = Mat44::MakeFromX(topCenter - bottomCenter);
 	Vec3 iBasis = localSpace.GetIBasis3D();
@@ -783,6 +791,7 @@ void AddVertsForCylinder3D(std::vector<Vertex_PCU>& verts, Vec3 const& bottomCen
 
 void AddVertsForCylinder3D(std::vector<Vertex_PCUTBN>& verts, std::vector<unsigned int>& indexes, Vec3 const& bottomCenter, Vec3 const& topCenter, float radius, Rgba8 const& color /*= Rgba8::OPAQUE_WHITE*/, AABB2 const& UVs /*= AABB2::ZERO_TO_ONE*/, int numSlices /*= 32*/)
 {
+	PROFILE_SCOPE("AddVertsForCylinder3D");
 	unsigned int const startIndex = static_cast<unsigned int>(verts.size());
 	float const DEGREES_PER_SLICE = 360.f / static_cast<float>(numSlices);
 
@@ -909,6 +918,7 @@ void AddVertsForArrow3D(std::vector<Vertex_PCU>& verts, Vec3 const& start, Vec3
 
 void AddVertsForCylinderZ3D(std::vector<Vertex_PCU>& verts, Vec2 const& centerXY, FloatRange const& minMaxZ, float radius, int numSlices /*= 32*/, Rgba8 const& color /*= Rgba8::OPAQUE_WHITE*/, AABB2 const& UVs /*= AABB2::ZERO_TO_ONE*/)
 {
+	PROFILE_SCOPE("AddVertsForCylinderZ3D");
 	float const DEGREES_PER_SLICE = 360.f / static_cast<float>(numSlices);
 
 	Vec3 bottomCenter	= Vec3(centerXY.x, centerXY.y, minMaxZ.m_min);
@@ -959,6 +969,7 @@ void AddVertsForCylinderZ3D(std::vector<Vertex_PCU>& verts, Vec2 const& centerXY
 
 void AddVertsForCylinderZ3D(std::vector<Vertex_PCUTBN>& verts, std::vector<unsigned int>& indexes, Vec2 const& centerXY, FloatRange const& minMaxZ, float radius, int numSlices /*= 32*/, Rgba8 const& color /*= Rgba8::OPAQUE_WHITE*/, AABB2 const& UVs /*= AABB2::ZERO_TO_ONE*/)
 {
+	PROFILE_SCOPE("AddVertsForCylinderZ3D");
 	unsigned int const startIndex = static_cast<unsigned int>(verts.size());
 	float const DEGREES_PER_SLICE = 360.f / static_cast<float>(numSlices);
 
@@ -1077,6 +1088,7 @@ void AddVertsForPenumbra3D(std::vector<Vertex_PCU>& verts, Vec3 const& position,
 //-----------------------------------------------------------------------------------------------
 void AddVertsForGridXY(std::vector<Vertex_PCU>& verts, IntVec2 dimensions)
 {
+	PROFILE_SCOPE("AddVertsForGridXY");
 	constexpr float ORIGIN_LINE_WIDTH = 0.1f;
 	constexpr float MAJOR_LINE_WIDTH = 0.05f;
 	constexpr float MINOR_LINE_WIDTH = 0.025f;
@@ -1135,6 +1147,7 @@ void AddVertsForGridXY(std::vector<Vertex_PCU>& verts, IntVec2 dimensions)
 
 void AddVertsForGridPlane3D(std::vector<Vertex_PCU>& verts, Plane3 const& plane, Vec3 const& midPerpdicularPoint /*= Vec3::ZERO*/, Vec2 const& gridSize /*= Vec2(100.f, 100.f)*/, Vec2 const& cellSize /*= Vec2(1.f, 1.f)*/, float gridThickness /*= 0.025f*/, Rgba8 xAxisColor /*= Rgba8::RED*/, Rgba8 yAxisColor /*= Rgba8::GREEN*/)
 {
+	PROFILE_SCOPE("AddVertsForGridPlane3D");
 	constexpr unsigned char MAJOR_AXIS_ALPHA = 200;
 	constexpr unsigned char MINOR_AXIS_ALPHA = 100;
 
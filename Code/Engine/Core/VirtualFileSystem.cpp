@@ -0,0 +1,296 @@
+#include "Engine/Core/VirtualFileSystem.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+VirtualFileSystem* g_theFileSystem = nullptr;
+
+namespace
+{
+	// Slashes and leading "./" or '/' handled like NormalizeArchivePath, but case kept, so the
+	// relative path still names the file on a case sensitive disk
+	std::string GetCleanPath(std::string const& path)
+	{
+		std::string cleanPath = path;
+		std::replace(cleanPath.begin(), cleanPath.end(), '\\', '/');
+		while (!cleanPath.empty())
+		{
+			if (cleanPath.compare(0, 2, "./") == 0)
+			{
+				cleanPath.erase(0, 2);
+			}
+			else if (cleanPath[0] == '/')
+			{
+				cleanPath.erase(0, 1);
+			}
+			else
+			{
+				break;
+			}
+		}
+		return cleanPath;
+	}
+
+	std::string GetNormalizedMountPoint(std::string const& mountPoint)
+	{
+		std::string normalizedMountPoint = NormalizeArchivePath(mountPoint);
+		while (!normalizedMountPoint.empty() && normalizedMountPoint.back() == '/')
+		{
+			normalizedMountPoint.pop_back();
+		}
+		return normalizedMountPoint;
+	}
+
+	void PrintFileSystemLine(Rgba8 const& color, std::string const& text)
+	{
+		if (g_theDevConsole)
+		{
+			g_theDevConsole->AddText(color, text);
+		}
+		else
+		{
+			DebuggerPrintf("%s\n", text.c_str());
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+#pragma region Setup
+VirtualFileSystem::VirtualFileSystem(VirtualFileSystemConfig const& config)
+	: m_config(config)
+{
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+	UnmountAll();
+}
+
+void VirtualFileSystem::Startup()
+{
+	if (m_config.m_registerPackCommand && g_theEventSystem)
+	{
+		g_theEventSystem->SubscribeEventCallbackFunction("PackArchive", Command_PackArchive);
+	}
+}
+
+void VirtualFileSystem::Shutdown()
+{
+	if (m_config.m_registerPackCommand && g_theEventSystem)
+	{
+		g_theEventSystem->UnsubscribeEventCallbackFunction("PackArchive", Command_PackArchive);
+	}
+	UnmountAll();
+}
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+#pragma region Mounts
+bool VirtualFileSystem::MountDirectory(std::string const& mountPoint, std::string const& directoryPath)
+{
+	std::error_code error;
+	if (!std::filesystem::is_directory(directoryPath, error))
+	{
+		DebuggerPrintf("VirtualFileSystem: \"%s\" is not a directory\n", directoryPath.c_str());
+		return false;
+	}
+
+	Mount mount;
+	mount.m_mountPoint = GetNormalizedMountPoint(mountPoint);
+	mount.m_directoryPath = directoryPath;
+	m_mounts.push_back(std::move(mount));
+	return true;
+}
+
+bool VirtualFileSystem::MountArchive(std::string const& mountPoint, std::string const& archivePath)
+{
+	std::unique_ptr<FileArchive> archive = std::make_unique<FileArchive>();
+	if (!archive->Open(archivePath))
+	{
+		DebuggerPrintf("VirtualFileSystem: could not mount archive \"%s\"\n", archivePath.c_str());
+		return false;
+	}
+
+	Mount mount;
+	mount.m_mountPoint = GetNormalizedMountPoint(mountPoint);
+	mount.m_archive = std::move(archive);
+	m_mounts.push_back(std::move(mount));
+	return true;
+}
+
+bool VirtualFileSystem::Unmount(std::string const& mountPoint)
+{
+	std::string normalizedMountPoint = GetNormalizedMountPoint(mountPoint);
+	for (int mountIndex = static_cast<int>(m_mounts.size()) - 1; mountIndex >= 0; --mountIndex)
+	{
+		if (m_mounts[mountIndex].m_mountPoint == normalizedMountPoint)
+		{
+			m_mounts.erase(m_mounts.begin() + mountIndex);
+			return true;
+		}
+	}
+	return false;
+}
+
+void VirtualFileSystem::UnmountAll()
+{
+	m_mounts.clear();
+}
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+#pragma region Reads
+bool VirtualFileSystem::DoesFileExist(std::string const& virtualPath) const
+{
+	std::string cleanPath = GetCleanPath(virtualPath);
+	std::string relativePath;
+	for (auto mountIter = m_mounts.rbegin(); mountIter != m_mounts.rend(); ++mountIter)
+	{
+		if (!GetPathInMount(*mountIter, cleanPath, relativePath))
+		{
+			continue;
+		}
+		if (mountIter->m_archive)
+		{
+			if (mountIter->m_archive->HasFile(relativePath))
+			{
+				return true;
+			}
+		}
+		else
+		{
+			std::error_code error;
+			if (std::filesystem::is_regular_file(mountIter->m_directoryPath + "/" + relativePath, error))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool VirtualFileSystem::ReadFile(std::string const& virtualPath, std::vector<uint8_t>& out_buffer) const
+{
+	std::string cleanPath = GetCleanPath(virtualPath);
+	std::string relativePath;
+	for (auto mountIter = m_mounts.rbegin(); mountIter != m_mounts.rend(); ++mountIter)
+	{
+		if (!GetPathInMount(*mountIter, cleanPath, relativePath))
+		{
+			continue;
+		}
+		if (mountIter->m_archive)
+		{
+			FileArchiveEntry const* entry = mountIter->m_archive->FindEntry(relativePath);
+			if (entry)
+			{
+				return mountIter->m_archive->ReadEntry(*entry, out_buffer);
+			}
+		}
+		else if (ReadDiskFile(mountIter->m_directoryPath + "/" + relativePath, out_buffer))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool VirtualFileSystem::GetFileSpan(std::string const& virtualPath, ByteSpan& out_span, std::vector<uint8_t>& out_storage) const
+{
+	std::string cleanPath = GetCleanPath(virtualPath);
+	std::string relativePath;
+	for (auto mountIter = m_mounts.rbegin(); mountIter != m_mounts.rend(); ++mountIter)
+	{
+		if (!GetPathInMount(*mountIter, cleanPath, relativePath))
+		{
+			continue;
+		}
+		if (mountIter->m_archive)
+		{
+			FileArchive const& archive = *mountIter->m_archive;
+			FileArchiveEntry const* entry = archive.FindEntry(relativePath);
+			if (entry == nullptr)
+			{
+				continue;
+			}
+			if (archive.GetEntrySpan(*entry, out_span))
+			{
+				return true;
+			}
+			if (!archive.ReadEntry(*entry, out_storage))
+			{
+				return false;
+			}
+			out_span = ByteSpan(out_storage.data(), out_storage.size());
+			return true;
+		}
+		if (ReadDiskFile(mountIter->m_directoryPath + "/" + relativePath, out_storage))
+		{
+			out_span = ByteSpan(out_storage.data(), out_storage.size());
+			return true;
+		}
+	}
+	return false;
+}
+
+bool VirtualFileSystem::GetPathInMount(Mount const& mount, std::string const& cleanPath, std::string& out_relativePath)
+{
+	size_t mountLength = mount.m_mountPoint.size();
+	if (mountLength == 0)
+	{
+		out_relativePath = cleanPath;
+		return !cleanPath.empty();
+	}
+	if (cleanPath.size() <= mountLength + 1 || cleanPath[mountLength] != '/')
+	{
+		return false;
+	}
+	for (size_t charIndex = 0; charIndex < mountLength; ++charIndex)
+	{
+		if (std::tolower(static_cast<unsigned char>(cleanPath[charIndex])) != mount.m_mountPoint[charIndex])
+		{
+			return false;
+		}
+	}
+	out_relativePath = cleanPath.substr(mountLength + 1);
+	return true;
+}
+
+bool VirtualFileSystem::ReadDiskFile(std::string const& filePath, std::vector<uint8_t>& out_buffer)
+{
+	MappedFile file;
+	if (!file.Open(filePath))
+	{
+		return false;
+	}
+	out_buffer.assign(file.GetSpan().begin(), file.GetSpan().end());
+	return true;
+}
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+bool Command_PackArchive(EventArgs& args)
+{
+	std::string sourceDirectory = args.GetValue("source", "");
+	std::string archivePath = args.GetValue("archive", "");
+	if (sourceDirectory.empty() || archivePath.empty())
+	{
+		PrintFileSystemLine(DevConsole::ERROR, "Usage: PackArchive source=Data archive=Data.pak compress=true");
+		return true;
+	}
+
+	FileArchiveBuildConfig config;
+	config.m_compress = args.GetValue("compress", config.m_compress);
+	FileArchiveBuildResult result;
+	if (BuildFileArchive(sourceDirectory, archivePath, config, nullptr, &result))
+	{
+		PrintFileSystemLine(DevConsole::INFO_MAJOR, "Packed " + archivePath + ": " + result.ToString());
+	}
+	else
+	{
+		PrintFileSystemLine(DevConsole::ERROR, "PackArchive could not pack " + sourceDirectory + " into " + archivePath);
+	}
+	return true;
+}
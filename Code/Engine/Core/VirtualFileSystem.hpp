@@ -0,0 +1,74 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/FileArchive.hpp"
+#include "Engine/Core/MappedFile.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// Maps virtual paths like "Data/Shaders/Default.hlsl" onto mounted directories and archives.
+//
+// A mount point is a virtual path prefix, "" mounts at the root. Lookups try the most recent
+// mount first, so a patch archive or a loose override directory mounted later wins. Paths match
+// without regard to case or slash direction.
+//
+// With g_theFileSystem set, FileReadToBuffer, FileReadToString, DoesFileExist and Image read
+// through it, falling back to the disk for paths no mount resolves, so existing loaders need no
+// changes. Reads are safe from any thread; mount and unmount only while nothing reads.
+//
+// Usage:
+//	g_theFileSystem = new VirtualFileSystem(VirtualFileSystemConfig());
+//	g_theFileSystem->Startup();
+//	g_theFileSystem->MountArchive("Data", "Data.pak");
+//	g_theFileSystem->MountDirectory("Data", "DataOverrides");	// loose files beat the archive
+//
+// "PackArchive source=Data archive=Data.pak" in the console builds an archive from a directory.
+//
+struct VirtualFileSystemConfig
+{
+	bool m_registerPackCommand = true;
+};
+
+class VirtualFileSystem
+{
+public:
+	explicit VirtualFileSystem(VirtualFileSystemConfig const& config);
+	~VirtualFileSystem();
+	VirtualFileSystem(VirtualFileSystem const& copy) = delete;
+	void Startup();
+	void Shutdown();
+
+	bool MountDirectory(std::string const& mountPoint, std::string const& directoryPath);
+	bool MountArchive(std::string const& mountPoint, std::string const& archivePath);
+	// Removes the most recent mount at mountPoint
+	bool Unmount(std::string const& mountPoint);
+	void UnmountAll();
+	int GetNumMounts() const { return static_cast<int>(m_mounts.size()); }
+
+	bool DoesFileExist(std::string const& virtualPath) const;
+	// Copies, or decompresses, the whole file
+	bool ReadFile(std::string const& virtualPath, std::vector<uint8_t>& out_buffer) const;
+	// Zero copy for entries stored uncompressed in an archive: out_span points into the mapping
+	// and stays valid until unmount. Anything else is read into out_storage and out_span points there
+	bool GetFileSpan(std::string const& virtualPath, ByteSpan& out_span, std::vector<uint8_t>& out_storage) const;
+
+protected:
+	struct Mount
+	{
+		std::string						m_mountPoint;		// normalized, no trailing '/'
+		std::string						m_directoryPath;	// directory mounts
+		std::unique_ptr<FileArchive>	m_archive;			// archive mounts
+	};
+
+	// The rest of path below the mount point, false if path is not under it
+	static bool GetPathInMount(Mount const& mount, std::string const& cleanPath, std::string& out_relativePath);
+	static bool ReadDiskFile(std::string const& filePath, std::vector<uint8_t>& out_buffer);
+
+protected:
+	VirtualFileSystemConfig	m_config;
+	std::vector<Mount>		m_mounts;	// later mounts win
+};
+
+// PackArchive source=Data archive=Data.pak compress=true
+bool Command_PackArchive(EventArgs& args);
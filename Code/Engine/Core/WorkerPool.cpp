@@ -0,0 +1,127 @@
+#include "Engine/Core/WorkerPool.hpp"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------------------------
+WorkerPool::WorkerPool(int numWorkers /*= -1*/)
+{
+	if (numWorkers < 0)
+	{
+		numWorkers = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+	}
+	for (int workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+	{
+		m_threads.emplace_back(&WorkerPool::WorkerMain, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_all();
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void WorkerPool::ParallelFor(int numTasks, std::function<void(int taskIndex)> const& taskFunction)
+{
+	if (numTasks <= 0)
+	{
+		return;
+	}
+	if (numTasks == 1 || m_threads.empty())
+	{
+		for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+		{
+			taskFunction(taskIndex);
+		}
+		return;
+	}
+
+	std::shared_ptr<Job> job = std::make_shared<Job>();
+	job->m_function = taskFunction;
+	job->m_numTasks = numTasks;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+	}
+	m_wakeCondition.notify_all();
+
+	RunJobTasks(job);
+
+	// Every task is claimed, workers may still be running the last ones
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [&]() { return job->m_numDoneTasks.load() == numTasks; });
+}
+
+void WorkerPool::Enqueue(std::function<void()> task)
+{
+	if (m_threads.empty())
+	{
+		task();
+		return;
+	}
+
+	std::shared_ptr<Job> job = std::make_shared<Job>();
+	job->m_function = [task = std::move(task)](int) { task(); };
+	job->m_numTasks = 1;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(std::move(job));
+	}
+	m_wakeCondition.notify_one();
+}
+
+//-----------------------------------------------------------------------------------------------
+void WorkerPool::WorkerMain()
+{
+	for (;;)
+	{
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [this]() { return m_isQuitting || !m_jobs.empty(); });
+			if (m_jobs.empty())
+			{
+				return; // quitting with nothing left queued
+			}
+			job = m_jobs.front();
+		}
+		RunJobTasks(job);
+	}
+}
+
+void WorkerPool::RunJobTasks(std::shared_ptr<Job> const& job)
+{
+	for (;;)
+	{
+		int taskIndex = job->m_nextTask.fetch_add(1);
+		if (taskIndex >= job->m_numTasks)
+		{
+			break;
+		}
+		job->m_function(taskIndex);
+
+		if (job->m_numDoneTasks.fetch_add(1) + 1 == job->m_numTasks)
+		{
+			// Taking the lock orders this with the waiter's check, so the wakeup cannot be lost
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+			}
+			m_doneCondition.notify_all();
+		}
+	}
+
+	// Nothing left to claim, stop handing the job out. Whoever gets here first removes it
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto jobIter = std::find(m_jobs.begin(), m_jobs.end(), job);
+	if (jobIter != m_jobs.end())
+	{
+		m_jobs.erase(jobIter);
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// Fixed set of worker threads for splitting jobs into independent tasks.
+//
+// ParallelFor queues a job whose task indexes are handed out through an atomic counter, the
+// calling thread works on its own job too and returns once every task of it is done. Any number
+// of threads may call ParallelFor at once, and tasks may call ParallelFor on the same pool: the
+// caller can always finish its own job alone, so nested jobs cannot deadlock.
+//
+// Enqueue queues a single task and returns at once. The destructor runs everything still queued
+// before the workers exit.
+//
+class WorkerPool
+{
+public:
+	// numWorkers < 0 starts one worker per hardware thread minus the calling thread
+	explicit WorkerPool(int numWorkers = -1);
+	~WorkerPool();
+	WorkerPool(WorkerPool const& copy) = delete;
+
+	void ParallelFor(int numTasks, std::function<void(int taskIndex)> const& taskFunction);
+	// Runs on the calling thread right away when the pool has no workers
+	void Enqueue(std::function<void()> task);
+
+	int GetNumWorkers() const { return static_cast<int>(m_threads.size()); }
+	// Workers plus the calling thread, a good task count divisor
+	int GetNumThreads() const { return GetNumWorkers() + 1; }
+
+protected:
+	struct Job
+	{
+		std::function<void(int)>	m_function;
+		int							m_numTasks = 0;
+		std::atomic<int>			m_nextTask{ 0 };
+		std::atomic<int>			m_numDoneTasks{ 0 };
+	};
+
+	void WorkerMain();
+	// Claims and runs tasks of job until none are left to claim
+	void RunJobTasks(std::shared_ptr<Job> const& job);
+
+protected:
+	std::vector<std::thread>					m_threads;
+	std::mutex									m_mutex;
+	std::condition_variable						m_wakeCondition;
+	std::condition_variable						m_doneCondition;
+
+	// Jobs with tasks left to claim, oldest first. Guarded by m_mutex
+	std::deque<std::shared_ptr<Job>>			m_jobs;
+	bool										m_isQuitting = false;
+};
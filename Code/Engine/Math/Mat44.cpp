@@ -6,6 +6,7 @@
 #include "Engine/Math/EulerAngles.hpp"
 #include "Engine/Math/Quat.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include <math.h>
 
 
 //-----------------------------------------------------------------------------------------------
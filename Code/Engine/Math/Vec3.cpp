@@ -2,6 +2,7 @@
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include <math.h>
 
 //-----------------------------------------------------------------------------------------------
 const Vec3 Vec3::ZERO		= Vec3(0.f, 0.f, 0.f);
@@ -0,0 +1,157 @@
+#include "Engine/Network/NetBuffer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <cstring>
+
+
+//-----------------------------------------------------------------------------------------------
+NetBufferWriter::NetBufferWriter(std::vector<uint8_t>& buffer)
+	: m_buffer(buffer)
+{
+}
+
+void NetBufferWriter::WriteUInt8(uint8_t value)
+{
+	m_buffer.push_back(value);
+}
+
+void NetBufferWriter::WriteUInt16(uint16_t value)
+{
+	m_buffer.push_back(static_cast<uint8_t>(value & 0xFF));
+	m_buffer.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void NetBufferWriter::WriteUInt32(uint32_t value)
+{
+	m_buffer.push_back(static_cast<uint8_t>(value & 0xFF));
+	m_buffer.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+	m_buffer.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
+	m_buffer.push_back(static_cast<uint8_t>(value >> 24));
+}
+
+void NetBufferWriter::WriteVarUInt(uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		m_buffer.push_back(static_cast<uint8_t>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	m_buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void NetBufferWriter::WriteBytes(void const* data, size_t numBytes)
+{
+	if (numBytes == 0)
+	{
+		return;
+	}
+	size_t oldSize = m_buffer.size();
+	m_buffer.resize(oldSize + numBytes);
+	memcpy(m_buffer.data() + oldSize, data, numBytes);
+}
+
+void NetBufferWriter::PatchUInt8(size_t offset, uint8_t value)
+{
+	GUARANTEE_OR_DIE(offset < m_buffer.size(), "NetBufferWriter::PatchUInt8 offset out of range");
+	m_buffer[offset] = value;
+}
+
+size_t NetBufferWriter::GetSize() const
+{
+	return m_buffer.size();
+}
+
+//-----------------------------------------------------------------------------------------------
+NetBufferReader::NetBufferReader(uint8_t const* data, size_t size)
+	: m_data(data)
+	, m_size(size)
+{
+}
+
+uint8_t NetBufferReader::ReadUInt8()
+{
+	if (m_offset + 1 > m_size)
+	{
+		m_isValid = false;
+		return 0;
+	}
+	return m_data[m_offset++];
+}
+
+uint16_t NetBufferReader::ReadUInt16()
+{
+	if (m_offset + 2 > m_size)
+	{
+		m_isValid = false;
+		return 0;
+	}
+	uint16_t value = static_cast<uint16_t>(m_data[m_offset] | (m_data[m_offset + 1] << 8));
+	m_offset += 2;
+	return value;
+}
+
+uint32_t NetBufferReader::ReadUInt32()
+{
+	if (m_offset + 4 > m_size)
+	{
+		m_isValid = false;
+		return 0;
+	}
+	uint32_t value = static_cast<uint32_t>(m_data[m_offset])
+		| (static_cast<uint32_t>(m_data[m_offset + 1]) << 8)
+		| (static_cast<uint32_t>(m_data[m_offset + 2]) << 16)
+		| (static_cast<uint32_t>(m_data[m_offset + 3]) << 24);
+	m_offset += 4;
+	return value;
+}
+
+uint32_t NetBufferReader::ReadVarUInt()
+{
+	uint32_t value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		uint8_t byte = ReadUInt8();
+		if (!m_isValid)
+		{
+			return 0;
+		}
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return value;
+		}
+	}
+	m_isValid = false; // more than 5 bytes, corrupt
+	return 0;
+}
+
+uint8_t const* NetBufferReader::ReadBytes(size_t numBytes)
+{
+	if (numBytes > m_size - m_offset)
+	{
+		m_isValid = false;
+		return nullptr;
+	}
+	uint8_t const* result = m_data + m_offset;
+	m_offset += numBytes;
+	return result;
+}
+
+size_t NetBufferReader::GetRemainingSize() const
+{
+	return m_size - m_offset;
+}
+
+size_t NetBufferReader::GetConsumedSize() const
+{
+	return m_offset;
+}
+
+bool NetBufferReader::IsValid() const
+{
+	return m_isValid;
+}
+
+bool NetBufferReader::IsAtEnd() const
+{
+	return m_offset == m_size;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//-----------------------------------------------------------------------------------------------
+// Little-endian byte serialization helpers used by the UDP protocol and snapshot delta code.
+// The writer appends to a caller-owned vector so packets can be built in place without copies.
+// The reader never reads past its end, it sets an error flag and returns zero instead, so a
+// malformed packet can be dropped by checking IsValid() once after parsing.
+//
+
+//-----------------------------------------------------------------------------------------------
+class NetBufferWriter
+{
+public:
+	explicit NetBufferWriter(std::vector<uint8_t>& buffer);
+
+	void WriteUInt8(uint8_t value);
+	void WriteUInt16(uint16_t value);
+	void WriteUInt32(uint32_t value);
+	void WriteVarUInt(uint32_t value); // 7 bits per byte, 1-5 bytes
+	void WriteBytes(void const* data, size_t numBytes);
+
+	// Overwrite a value already written, used to patch counts after the payload is known
+	void PatchUInt8(size_t offset, uint8_t value);
+
+	size_t GetSize() const;
+
+private:
+	std::vector<uint8_t>& m_buffer;
+};
+
+//-----------------------------------------------------------------------------------------------
+class NetBufferReader
+{
+public:
+	NetBufferReader(uint8_t const* data, size_t size);
+
+	uint8_t		ReadUInt8();
+	uint16_t	ReadUInt16();
+	uint32_t	ReadUInt32();
+	uint32_t	ReadVarUInt();
+	// Returns a pointer into the source buffer, nullptr if not enough bytes remain
+	uint8_t const* ReadBytes(size_t numBytes);
+
+	size_t	GetRemainingSize() const;
+	size_t	GetConsumedSize() const;
+	bool	IsValid() const;
+	bool	IsAtEnd() const;
+
+private:
+	uint8_t const*	m_data = nullptr;
+	size_t			m_size = 0;
+	size_t			m_offset = 0;
+	bool			m_isValid = true;
+};
+
+//-----------------------------------------------------------------------------------------------
+constexpr size_t GetVarUIntSize(uint32_t value)
+{
+	return (value < (1u << 7)) ? 1 : (value < (1u << 14)) ? 2 : (value < (1u << 21)) ? 3 : (value < (1u << 28)) ? 4 : 5;
+}
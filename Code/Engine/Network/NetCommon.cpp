@@ -0,0 +1,64 @@
+#include "Engine/Network/NetCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+std::string NetAddress::ToString() const
+{
+	return Stringf("%u.%u.%u.%u:%u",
+		(m_ipv4 >> 24) & 0xFF, (m_ipv4 >> 16) & 0xFF, (m_ipv4 >> 8) & 0xFF, m_ipv4 & 0xFF, m_port);
+}
+
+bool NetAddress::FromString(NetAddress& out_address, std::string const& ip, uint16_t port)
+{
+	// dotted decimal only, no name resolution
+	Strings parts = SplitStringOnDelimiter(ip, '.');
+	if (parts.size() != 4)
+	{
+		return false;
+	}
+
+	uint32_t ipv4 = 0;
+	for (std::string const& part : parts)
+	{
+		if (part.empty() || part.size() > 3)
+		{
+			return false;
+		}
+		int value = 0;
+		for (char c : part)
+		{
+			if (c < '0' || c > '9')
+			{
+				return false;
+			}
+			value = value * 10 + (c - '0');
+		}
+		if (value > 255)
+		{
+			return false;
+		}
+		ipv4 = (ipv4 << 8) | static_cast<uint32_t>(value);
+	}
+
+	out_address.m_ipv4 = ipv4;
+	out_address.m_port = port;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string NetConnectionStats::ToString() const
+{
+	std::string result = Stringf("rtt %.1fms | out %llu msgs %llu B | in %llu msgs %llu B | queued %d msgs %llu B",
+		m_roundTripTime * 1000.0,
+		(unsigned long long)m_messagesSent, (unsigned long long)m_bytesSent,
+		(unsigned long long)m_messagesReceived, (unsigned long long)m_bytesReceived,
+		m_queuedMessages, (unsigned long long)m_queuedBytes);
+	if (m_packetsSent > 0 || m_packetsReceived > 0)
+	{
+		result += Stringf(" | pkts out %llu in %llu acked %llu lost %llu resends %llu",
+			(unsigned long long)m_packetsSent, (unsigned long long)m_packetsReceived,
+			(unsigned long long)m_packetsAcked, (unsigned long long)m_packetsLost, (unsigned long long)m_reliableResends);
+	}
+	return result;
+}
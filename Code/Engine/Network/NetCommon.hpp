@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+//-----------------------------------------------------------------------------------------------
+// Shared definitions for the UDP transport (UdpNetworkSystem / NetConnection).
+//
+// Packet layout (all little-endian):
+//	u32 protocolId | u8 packetType | ...
+//	PAYLOAD packets continue with:
+//	u16 sequence | u16 ack | u32 ackBits | u8 messageCount | messages...
+//	each message is: u8 channel | u16 messageId | varuint size | bytes
+//
+
+//-----------------------------------------------------------------------------------------------
+constexpr uint32_t NET_DEFAULT_PROTOCOL_ID = 0x554F4C43; // "CLOU"
+
+// Keep every datagram below the smallest common path MTU so it is never IP fragmented.
+// 1500 (ethernet) - 20 (IPv4) - 8 (UDP) = 1472, leave room for tunnels/VPN headers.
+constexpr size_t NET_MAX_PACKET_SIZE = 1200;
+constexpr size_t NET_PACKET_HEADER_SIZE = 4 + 1;
+constexpr size_t NET_PAYLOAD_HEADER_SIZE = NET_PACKET_HEADER_SIZE + 2 + 2 + 4 + 1;
+constexpr size_t NET_MESSAGE_HEADER_MAX_SIZE = 1 + 2 + 2; // size fits in a 2 byte varuint
+constexpr size_t NET_MAX_MESSAGE_SIZE = NET_MAX_PACKET_SIZE - NET_PAYLOAD_HEADER_SIZE - NET_MESSAGE_HEADER_MAX_SIZE;
+
+// Number of sent packets remembered for acks, must be a power of two
+constexpr int NET_SENT_PACKET_BUFFER_SIZE = 1024;
+// Max reliable messages in flight, the receiver buffers this many out-of-order messages
+constexpr int NET_RELIABLE_WINDOW_SIZE = 256;
+
+//-----------------------------------------------------------------------------------------------
+enum class NetPacketType : uint8_t
+{
+	CONNECT_REQUEST = 0,
+	CONNECT_ACCEPT,
+	CONNECT_DENIED,
+	PAYLOAD,
+	DISCONNECT,
+	COUNT
+};
+
+enum class NetChannel : uint8_t
+{
+	RELIABLE_ORDERED = 0,		// resent until acked, delivered exactly once in send order
+	UNRELIABLE_SEQUENCED,		// sent once, anything older than the newest received is dropped
+	COUNT
+};
+
+enum class NetConnectionState
+{
+	DISCONNECTED = 0,
+	CONNECTING,
+	CONNECTED,
+	COUNT
+};
+
+//-----------------------------------------------------------------------------------------------
+// IPv4 address and port in host byte order
+struct NetAddress
+{
+	uint32_t m_ipv4 = 0;
+	uint16_t m_port = 0;
+
+	bool operator==(NetAddress const& other) const { return m_ipv4 == other.m_ipv4 && m_port == other.m_port; }
+	bool operator!=(NetAddress const& other) const { return !(*this == other); }
+
+	std::string ToString() const;
+	static bool FromString(NetAddress& out_address, std::string const& ip, uint16_t port);
+};
+
+//-----------------------------------------------------------------------------------------------
+// Per-connection traffic counters, shared by the TCP NetworkSystem and the UDP transport.
+// Packet counters stay zero for TCP connections.
+struct NetConnectionStats
+{
+	uint64_t	m_bytesSent = 0;
+	uint64_t	m_bytesReceived = 0;
+	uint64_t	m_messagesSent = 0;
+	uint64_t	m_messagesReceived = 0;
+	uint64_t	m_packetsSent = 0;
+	uint64_t	m_packetsReceived = 0;
+	uint64_t	m_packetsAcked = 0;
+	uint64_t	m_packetsLost = 0;		// sent packets that fell out of the ack window unacked
+	uint64_t	m_reliableResends = 0;
+	int			m_queuedMessages = 0;	// outgoing, not yet on the wire (or not yet acked for reliable)
+	size_t		m_queuedBytes = 0;
+	double		m_roundTripTime = 0.0;	// smoothed, seconds
+
+	std::string ToString() const;
+};
+
+//-----------------------------------------------------------------------------------------------
+// Sequence numbers wrap at 65536, s1 is newer than s2 if it is ahead by less than half the range
+inline bool IsSequenceNewer(uint16_t s1, uint16_t s2)
+{
+	return ((s1 > s2) && (s1 - s2 <= 32768)) || ((s1 < s2) && (s2 - s1 > 32768));
+}
@@ -0,0 +1,154 @@
+#include "Engine/Network/NetConditioner.hpp"
+#include "Engine/Core/NamedStrings.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+std::string NetConditionerConfig::ToString() const
+{
+	if (!m_isEnabled)
+	{
+		return "off";
+	}
+	std::string bandwidth = (m_bandwidthBytesPerSecond > 0) ? Stringf("%d B/s", m_bandwidthBytesPerSecond) : std::string("unlimited");
+	return Stringf("latency %.0fms jitter %.0fms loss %.2f reorder %.2f bandwidth %s",
+		m_latencySeconds * 1000.0, m_jitterSeconds * 1000.0, m_lossChance, m_reorderChance, bandwidth.c_str());
+}
+
+void NetConditionerConfig::SetFromArgs(NamedStrings const& args)
+{
+	m_isEnabled = args.GetValue("enabled", true);
+	m_latencySeconds = 0.001 * static_cast<double>(args.GetValue("latency", static_cast<float>(m_latencySeconds * 1000.0)));
+	m_jitterSeconds = 0.001 * static_cast<double>(args.GetValue("jitter", static_cast<float>(m_jitterSeconds * 1000.0)));
+	m_lossChance = args.GetValue("loss", m_lossChance);
+	m_reorderChance = args.GetValue("reorder", m_reorderChance);
+	m_bandwidthBytesPerSecond = args.GetValue("bandwidth", m_bandwidthBytesPerSecond);
+}
+
+//-----------------------------------------------------------------------------------------------
+NetConditioner::NetConditioner(NetConditionerMode mode)
+	: m_mode(mode)
+{
+}
+
+void NetConditioner::SetConfig(NetConditionerConfig const& config)
+{
+	m_config = config;
+}
+
+NetConditionerConfig const& NetConditioner::GetConfig() const
+{
+	return m_config;
+}
+
+NetConditionerMode NetConditioner::GetMode() const
+{
+	return m_mode;
+}
+
+bool NetConditioner::IsEnabled() const
+{
+	return m_config.m_isEnabled;
+}
+
+void NetConditioner::Enqueue(NetAddress const& address, uint8_t const* data, size_t numBytes, double currentTime)
+{
+	bool isDatagram = (m_mode == NetConditionerMode::DATAGRAM);
+	if (isDatagram)
+	{
+		if (m_config.m_lossChance > 0.f && m_rng.RollRandomWithProbability(m_config.m_lossChance))
+		{
+			m_numDroppedPackets++;
+			return;
+		}
+		if (m_config.m_maxQueuedBytes > 0 && m_pendingBytes + numBytes > m_config.m_maxQueuedBytes)
+		{
+			m_numDroppedPackets++; // tail drop, like a full router queue
+			return;
+		}
+	}
+
+	double deliveryTime = currentTime + m_config.m_latencySeconds;
+	if (m_config.m_jitterSeconds > 0.0)
+	{
+		deliveryTime += m_config.m_jitterSeconds * static_cast<double>(m_rng.RollRandomFloatZeroToOne());
+	}
+	if (isDatagram && m_config.m_reorderChance > 0.f && m_rng.RollRandomWithProbability(m_config.m_reorderChance))
+	{
+		deliveryTime += m_config.m_reorderDelaySeconds;
+	}
+
+	// The bottleneck serializes everything, a packet cannot arrive before the ones ahead of it
+	// have finished crossing the link
+	if (m_config.m_bandwidthBytesPerSecond > 0)
+	{
+		double linkStart = (m_linkBusyUntil > currentTime) ? m_linkBusyUntil : currentTime;
+		m_linkBusyUntil = linkStart + static_cast<double>(numBytes) / static_cast<double>(m_config.m_bandwidthBytesPerSecond);
+		double linkDone = m_linkBusyUntil + (deliveryTime - currentTime);
+		deliveryTime = (linkDone > deliveryTime) ? linkDone : deliveryTime;
+	}
+
+	if (!isDatagram && !m_pendingPackets.empty() && m_pendingPackets.back().m_deliveryTime > deliveryTime)
+	{
+		deliveryTime = m_pendingPackets.back().m_deliveryTime; // jitter must not reorder a stream
+	}
+
+	NetConditionedPacket packet;
+	packet.m_address = address;
+	packet.m_deliveryTime = deliveryTime;
+	packet.m_data.assign(data, data + numBytes);
+	m_pendingBytes += numBytes;
+	InsertSorted(std::move(packet));
+}
+
+bool NetConditioner::PopReadyPacket(NetConditionedPacket& out_packet, double currentTime)
+{
+	if (m_pendingPackets.empty() || m_pendingPackets.front().m_deliveryTime > currentTime)
+	{
+		return false;
+	}
+	out_packet = std::move(m_pendingPackets.front());
+	m_pendingPackets.pop_front();
+	m_pendingBytes -= out_packet.m_data.size();
+	return true;
+}
+
+void NetConditioner::Clear()
+{
+	m_pendingPackets.clear();
+	m_pendingBytes = 0;
+	m_numDroppedPackets = 0;
+	m_linkBusyUntil = 0.0;
+}
+
+int NetConditioner::GetNumPendingPackets() const
+{
+	return static_cast<int>(m_pendingPackets.size());
+}
+
+size_t NetConditioner::GetNumPendingBytes() const
+{
+	return m_pendingBytes;
+}
+
+uint64_t NetConditioner::GetNumDroppedPackets() const
+{
+	return m_numDroppedPackets;
+}
+
+void NetConditioner::InsertSorted(NetConditionedPacket&& packet)
+{
+	// Almost everything lands at the back, only jittered or reordered packets walk forward.
+	// Equal times keep insertion order.
+	auto insertAt = m_pendingPackets.end();
+	while (insertAt != m_pendingPackets.begin())
+	{
+		auto previous = insertAt - 1;
+		if (previous->m_deliveryTime <= packet.m_deliveryTime)
+		{
+			break;
+		}
+		insertAt = previous;
+	}
+	m_pendingPackets.insert(insertAt, std::move(packet));
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Engine/Network/NetCommon.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <string>
+
+class NamedStrings;
+
+//-----------------------------------------------------------------------------------------------
+// Artificial bad network for testing over loopback. Outgoing data is handed to the conditioner
+// instead of the socket, it drops some of it and holds the rest until its delivery time, then
+// the owner sends whatever PopReadyPacket returns.
+//
+// DATAGRAM mode (UDP) applies every setting. STREAM mode (TCP) only delays: a stream cannot lose
+// or reorder bytes, so loss and reorder are ignored and delivery times never go backwards.
+//
+enum class NetConditionerMode
+{
+	DATAGRAM = 0,
+	STREAM,
+	COUNT
+};
+
+//-----------------------------------------------------------------------------------------------
+struct NetConditionerConfig
+{
+	bool	m_isEnabled = false;
+	float	m_lossChance = 0.f;					// [0, 1] chance that a datagram is dropped
+	double	m_latencySeconds = 0.0;				// one way delay added to everything
+	double	m_jitterSeconds = 0.0;				// extra random delay in [0, jitter]
+	float	m_reorderChance = 0.f;				// [0, 1] chance that a datagram is held back
+	double	m_reorderDelaySeconds = 0.05;		// how long a reordered datagram is held back
+	int		m_bandwidthBytesPerSecond = 0;		// bottleneck link speed, 0 is unlimited
+	size_t	m_maxQueuedBytes = 256 * 1024;		// router queue, datagrams beyond it are dropped
+
+	std::string ToString() const;
+	// DevConsole args: enabled=bool latency=ms jitter=ms loss=[0,1] reorder=[0,1] bandwidth=bytes/s
+	// Missing keys keep their current value, enabled defaults to true
+	void SetFromArgs(NamedStrings const& args);
+};
+
+//-----------------------------------------------------------------------------------------------
+struct NetConditionedPacket
+{
+	NetAddress				m_address;
+	double					m_deliveryTime = 0.0;
+	std::vector<uint8_t>	m_data;
+};
+
+//-----------------------------------------------------------------------------------------------
+class NetConditioner
+{
+public:
+	explicit NetConditioner(NetConditionerMode mode = NetConditionerMode::DATAGRAM);
+
+	void SetConfig(NetConditionerConfig const& config);
+	NetConditionerConfig const& GetConfig() const;
+	NetConditionerMode GetMode() const;
+	bool IsEnabled() const;
+
+	// Takes a copy of the data, or silently drops it
+	void Enqueue(NetAddress const& address, uint8_t const* data, size_t numBytes, double currentTime);
+
+	// Returns true and fills out_packet with the next packet due at currentTime
+	bool PopReadyPacket(NetConditionedPacket& out_packet, double currentTime);
+
+	void Clear();
+
+	int GetNumPendingPackets() const;
+	size_t GetNumPendingBytes() const;
+	uint64_t GetNumDroppedPackets() const;
+
+private:
+	void InsertSorted(NetConditionedPacket&& packet);
+
+private:
+	NetConditionerMode					m_mode = NetConditionerMode::DATAGRAM;
+	NetConditionerConfig				m_config;
+	std::deque<NetConditionedPacket>	m_pendingPackets; // sorted by delivery time
+	size_t								m_pendingBytes = 0;
+	uint64_t							m_numDroppedPackets = 0;
+	double								m_linkBusyUntil = 0.0; // bandwidth model, when the bottleneck is free again
+	RandomNumberGenerator				m_rng;
+};
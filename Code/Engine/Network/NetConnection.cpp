@@ -0,0 +1,462 @@
+#include "Engine/Network/NetConnection.hpp"
+#include "Engine/Network/NetBuffer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+constexpr double RELIABLE_RESEND_MIN_SECONDS = 0.1;
+constexpr double RELIABLE_RESEND_RTT_SCALE = 1.25;
+constexpr double RTT_SMOOTHING_FACTOR = 0.1;
+constexpr int MAX_MESSAGES_PER_PACKET = 255;
+
+//-----------------------------------------------------------------------------------------------
+void WriteNetPacketHeader(NetBufferWriter& writer, uint32_t protocolId, NetPacketType type)
+{
+	writer.WriteUInt32(protocolId);
+	writer.WriteUInt8(static_cast<uint8_t>(type));
+}
+
+static size_t GetMessageWireSize(size_t numBytes)
+{
+	return 1 + 2 + GetVarUIntSize(static_cast<uint32_t>(numBytes)) + numBytes;
+}
+
+static void WriteMessage(NetBufferWriter& writer, NetChannel channel, uint16_t messageId, std::vector<uint8_t> const& data)
+{
+	writer.WriteUInt8(static_cast<uint8_t>(channel));
+	writer.WriteUInt16(messageId);
+	writer.WriteVarUInt(static_cast<uint32_t>(data.size()));
+	writer.WriteBytes(data.data(), data.size());
+}
+
+//-----------------------------------------------------------------------------------------------
+NetConnection::NetConnection()
+{
+	Reset();
+}
+
+void NetConnection::Reset()
+{
+	m_address = NetAddress();
+	m_state = NetConnectionState::DISCONNECTED;
+	m_lastReceiveTime = 0.0;
+	m_lastSendTime = 0.0;
+
+	m_localSequence = 0;
+	m_remoteSequence = 0;
+	m_remoteAckBits = 0;
+	m_hasReceivedPacket = false;
+	m_isAckPending = false;
+	m_sentPackets.clear();
+	m_sentPackets.resize(NET_SENT_PACKET_BUFFER_SIZE);
+
+	m_nextReliableSendId = 0;
+	m_nextReliableReceiveId = 0;
+	m_outgoingReliable.clear();
+	m_incomingReliable.clear();
+	m_incomingReliable.resize(NET_RELIABLE_WINDOW_SIZE);
+
+	m_nextUnreliableSendId = 0;
+	m_lastUnreliableReceiveId = 0;
+	m_hasReceivedUnreliable = false;
+	m_outgoingUnreliable.clear();
+
+	m_incomingMessages.clear();
+	m_stats = NetConnectionStats();
+}
+
+void NetConnection::SetState(NetConnectionState state, double currentTime)
+{
+	m_state = state;
+	// Start the timeout from the state change, not from the last packet of a previous session
+	m_lastReceiveTime = currentTime;
+}
+
+NetConnectionState NetConnection::GetState() const
+{
+	return m_state;
+}
+
+NetAddress const& NetConnection::GetAddress() const
+{
+	return m_address;
+}
+
+void NetConnection::SetAddress(NetAddress const& address)
+{
+	m_address = address;
+}
+
+bool NetConnection::QueueMessage(NetChannel channel, void const* data, size_t numBytes)
+{
+	if (numBytes > NET_MAX_MESSAGE_SIZE)
+	{
+		DebuggerPrintf("NetConnection: message of %d bytes exceeds the max message size %d\n", (int)numBytes, (int)NET_MAX_MESSAGE_SIZE);
+		return false;
+	}
+
+	uint8_t const* bytes = static_cast<uint8_t const*>(data);
+	if (channel == NetChannel::RELIABLE_ORDERED)
+	{
+		OutgoingReliableMessage& message = m_outgoingReliable.emplace_back();
+		message.m_id = m_nextReliableSendId++;
+		message.m_data.assign(bytes, bytes + numBytes);
+	}
+	else
+	{
+		NetMessage& message = m_outgoingUnreliable.emplace_back();
+		message.m_channel = channel;
+		message.m_data.assign(bytes, bytes + numBytes);
+	}
+	return true;
+}
+
+bool NetConnection::WritePayloadPacket(std::vector<uint8_t>& outPacket, uint32_t protocolId, double currentTime, double keepAliveSeconds)
+{
+	outPacket.clear();
+
+	double resendDelay = GetReliableResendDelay();
+	int numReliableInWindow = static_cast<int>(m_outgoingReliable.size());
+	if (numReliableInWindow > NET_RELIABLE_WINDOW_SIZE)
+	{
+		numReliableInWindow = NET_RELIABLE_WINDOW_SIZE;
+	}
+
+	bool hasMessageDue = !m_outgoingUnreliable.empty();
+	for (int messageIndex = 0; messageIndex < numReliableInWindow && !hasMessageDue; ++messageIndex)
+	{
+		OutgoingReliableMessage const& message = m_outgoingReliable[messageIndex];
+		hasMessageDue = !message.m_isAcked && (message.m_lastSendTime < 0.0 || currentTime - message.m_lastSendTime >= resendDelay);
+	}
+	bool isKeepAliveDue = (currentTime - m_lastSendTime) >= keepAliveSeconds;
+	if (!hasMessageDue && !m_isAckPending && !isKeepAliveDue)
+	{
+		return false;
+	}
+
+	NetBufferWriter writer(outPacket);
+	WriteNetPacketHeader(writer, protocolId, NetPacketType::PAYLOAD);
+	uint16_t sequence = m_localSequence++;
+	writer.WriteUInt16(sequence);
+	writer.WriteUInt16(m_remoteSequence);
+	writer.WriteUInt32(m_remoteAckBits);
+	size_t messageCountOffset = writer.GetSize();
+	writer.WriteUInt8(0);
+
+	SentPacketRecord& record = m_sentPackets[sequence % NET_SENT_PACKET_BUFFER_SIZE];
+	if (record.m_isValid && !record.m_isAcked)
+	{
+		m_stats.m_packetsLost++;
+	}
+	record.m_sequence = sequence;
+	record.m_isValid = true;
+	record.m_isAcked = false;
+	record.m_sendTime = currentTime;
+	record.m_reliableMessageIds.clear();
+
+	int numMessages = 0;
+
+	// Reliable messages first, they hold up everything behind them on the receiving side
+	for (int messageIndex = 0; messageIndex < numReliableInWindow && numMessages < MAX_MESSAGES_PER_PACKET; ++messageIndex)
+	{
+		OutgoingReliableMessage& message = m_outgoingReliable[messageIndex];
+		if (message.m_isAcked)
+		{
+			continue;
+		}
+		if (message.m_lastSendTime >= 0.0 && currentTime - message.m_lastSendTime < resendDelay)
+		{
+			continue;
+		}
+		if (writer.GetSize() + GetMessageWireSize(message.m_data.size()) > NET_MAX_PACKET_SIZE)
+		{
+			continue; // a smaller one further back may still fit
+		}
+
+		WriteMessage(writer, NetChannel::RELIABLE_ORDERED, message.m_id, message.m_data);
+		if (message.m_lastSendTime >= 0.0)
+		{
+			m_stats.m_reliableResends++;
+		}
+		else
+		{
+			m_stats.m_messagesSent++;
+		}
+		message.m_lastSendTime = currentTime;
+		record.m_reliableMessageIds.push_back(message.m_id);
+		numMessages++;
+	}
+
+	// Unreliable messages fill the rest, the ones that do not fit wait for the next packet
+	size_t numKept = 0;
+	for (size_t messageIndex = 0; messageIndex < m_outgoingUnreliable.size(); ++messageIndex)
+	{
+		NetMessage& message = m_outgoingUnreliable[messageIndex];
+		bool fits = numMessages < MAX_MESSAGES_PER_PACKET && writer.GetSize() + GetMessageWireSize(message.m_data.size()) <= NET_MAX_PACKET_SIZE;
+		if (fits)
+		{
+			WriteMessage(writer, message.m_channel, m_nextUnreliableSendId++, message.m_data);
+			m_stats.m_messagesSent++;
+			numMessages++;
+		}
+		else
+		{
+			if (numKept != messageIndex)
+			{
+				m_outgoingUnreliable[numKept] = std::move(message);
+			}
+			numKept++;
+		}
+	}
+	m_outgoingUnreliable.resize(numKept);
+
+	writer.PatchUInt8(messageCountOffset, static_cast<uint8_t>(numMessages));
+
+	m_isAckPending = false;
+	m_lastSendTime = currentTime;
+	m_stats.m_packetsSent++;
+	m_stats.m_bytesSent += outPacket.size();
+	return true;
+}
+
+bool NetConnection::ReadPayloadPacket(NetBufferReader& reader, double currentTime)
+{
+	uint16_t sequence = reader.ReadUInt16();
+	uint16_t ack = reader.ReadUInt16();
+	uint32_t ackBits = reader.ReadUInt32();
+	int numMessages = reader.ReadUInt8();
+
+	// Validate the whole packet before acting on any of it
+	struct ParsedMessage
+	{
+		NetChannel		m_channel;
+		uint16_t		m_id;
+		uint8_t const*	m_data;
+		size_t			m_size;
+	};
+	ParsedMessage parsedMessages[MAX_MESSAGES_PER_PACKET];
+	for (int messageIndex = 0; messageIndex < numMessages && reader.IsValid(); ++messageIndex)
+	{
+		ParsedMessage& parsed = parsedMessages[messageIndex];
+		uint8_t channel = reader.ReadUInt8();
+		parsed.m_id = reader.ReadUInt16();
+		parsed.m_size = reader.ReadVarUInt();
+		parsed.m_data = reader.ReadBytes(parsed.m_size);
+		if (channel >= static_cast<uint8_t>(NetChannel::COUNT))
+		{
+			return false;
+		}
+		parsed.m_channel = static_cast<NetChannel>(channel);
+	}
+	if (!reader.IsValid() || !reader.IsAtEnd())
+	{
+		return false;
+	}
+
+	m_lastReceiveTime = currentTime;
+	m_stats.m_packetsReceived++;
+	m_stats.m_bytesReceived += reader.GetConsumedSize(); // reader spans the whole packet, header included
+
+	// Update what we will ack back
+	bool isDuplicate = false;
+	if (!m_hasReceivedPacket)
+	{
+		m_remoteSequence = sequence;
+		m_remoteAckBits = 0;
+		m_hasReceivedPacket = true;
+	}
+	else if (IsSequenceNewer(sequence, m_remoteSequence))
+	{
+		uint16_t shift = static_cast<uint16_t>(sequence - m_remoteSequence);
+		m_remoteAckBits = (shift >= 32) ? 0 : (m_remoteAckBits << shift);
+		if (shift <= 32)
+		{
+			m_remoteAckBits |= 1u << (shift - 1);
+		}
+		m_remoteSequence = sequence;
+	}
+	else
+	{
+		uint16_t age = static_cast<uint16_t>(m_remoteSequence - sequence);
+		if (age == 0)
+		{
+			isDuplicate = true;
+		}
+		else if (age <= 32)
+		{
+			uint32_t bit = 1u << (age - 1);
+			isDuplicate = (m_remoteAckBits & bit) != 0;
+			m_remoteAckBits |= bit;
+		}
+	}
+	m_isAckPending = true;
+
+	ProcessAcks(ack, ackBits, currentTime);
+
+	if (isDuplicate)
+	{
+		return true;
+	}
+
+	for (int messageIndex = 0; messageIndex < numMessages; ++messageIndex)
+	{
+		ParsedMessage const& parsed = parsedMessages[messageIndex];
+		if (parsed.m_channel == NetChannel::RELIABLE_ORDERED)
+		{
+			ReceiveReliableMessage(parsed.m_id, parsed.m_data, parsed.m_size);
+		}
+		else
+		{
+			ReceiveUnreliableMessage(parsed.m_id, parsed.m_data, parsed.m_size);
+		}
+	}
+	return true;
+}
+
+void NetConnection::RetrieveIncomingMessages(std::vector<NetMessage>& out_messages)
+{
+	for (NetMessage& message : m_incomingMessages)
+	{
+		out_messages.push_back(std::move(message));
+	}
+	m_incomingMessages.clear();
+}
+
+double NetConnection::GetLastReceiveTime() const
+{
+	return m_lastReceiveTime;
+}
+
+double NetConnection::GetRoundTripTime() const
+{
+	return m_stats.m_roundTripTime;
+}
+
+NetConnectionStats NetConnection::GetStats() const
+{
+	NetConnectionStats stats = m_stats;
+	stats.m_queuedMessages = static_cast<int>(m_outgoingReliable.size() + m_outgoingUnreliable.size());
+	stats.m_queuedBytes = 0;
+	for (OutgoingReliableMessage const& message : m_outgoingReliable)
+	{
+		stats.m_queuedBytes += message.m_data.size();
+	}
+	for (NetMessage const& message : m_outgoingUnreliable)
+	{
+		stats.m_queuedBytes += message.m_data.size();
+	}
+	return stats;
+}
+
+int NetConnection::GetNumPendingReliableMessages() const
+{
+	return static_cast<int>(m_outgoingReliable.size());
+}
+
+void NetConnection::ProcessAcks(uint16_t ack, uint32_t ackBits, double currentTime)
+{
+	for (int bitIndex = 0; bitIndex <= 32; ++bitIndex)
+	{
+		if (bitIndex > 0 && (ackBits & (1u << (bitIndex - 1))) == 0)
+		{
+			continue;
+		}
+		uint16_t ackedSequence = static_cast<uint16_t>(ack - bitIndex);
+		SentPacketRecord& record = m_sentPackets[ackedSequence % NET_SENT_PACKET_BUFFER_SIZE];
+		if (record.m_isValid && !record.m_isAcked && record.m_sequence == ackedSequence)
+		{
+			OnPacketAcked(record, currentTime);
+		}
+	}
+
+	while (!m_outgoingReliable.empty() && m_outgoingReliable.front().m_isAcked)
+	{
+		m_outgoingReliable.pop_front();
+	}
+}
+
+void NetConnection::OnPacketAcked(SentPacketRecord& record, double currentTime)
+{
+	record.m_isAcked = true;
+	m_stats.m_packetsAcked++;
+
+	double sample = currentTime - record.m_sendTime;
+	if (m_stats.m_roundTripTime <= 0.0)
+	{
+		m_stats.m_roundTripTime = sample;
+	}
+	else
+	{
+		m_stats.m_roundTripTime += (sample - m_stats.m_roundTripTime) * RTT_SMOOTHING_FACTOR;
+	}
+
+	if (m_outgoingReliable.empty())
+	{
+		return;
+	}
+	uint16_t oldestId = m_outgoingReliable.front().m_id;
+	for (uint16_t messageId : record.m_reliableMessageIds)
+	{
+		uint16_t offset = static_cast<uint16_t>(messageId - oldestId);
+		if (offset < m_outgoingReliable.size())
+		{
+			m_outgoingReliable[offset].m_isAcked = true;
+		}
+	}
+}
+
+void NetConnection::ReceiveReliableMessage(uint16_t messageId, uint8_t const* data, size_t numBytes)
+{
+	// Anything behind the next expected id was already delivered, anything beyond the window
+	// cannot have been sent yet by a well behaved peer
+	uint16_t offset = static_cast<uint16_t>(messageId - m_nextReliableReceiveId);
+	if (offset >= NET_RELIABLE_WINDOW_SIZE)
+	{
+		return;
+	}
+
+	IncomingReliableSlot& slot = m_incomingReliable[messageId % NET_RELIABLE_WINDOW_SIZE];
+	if (slot.m_isValid && slot.m_id == messageId)
+	{
+		return;
+	}
+	slot.m_id = messageId;
+	slot.m_isValid = true;
+	slot.m_data.assign(data, data + numBytes);
+
+	while (true)
+	{
+		IncomingReliableSlot& next = m_incomingReliable[m_nextReliableReceiveId % NET_RELIABLE_WINDOW_SIZE];
+		if (!next.m_isValid || next.m_id != m_nextReliableReceiveId)
+		{
+			break;
+		}
+		NetMessage& message = m_incomingMessages.emplace_back();
+		m_stats.m_messagesReceived++;
+		message.m_channel = NetChannel::RELIABLE_ORDERED;
+		message.m_data = std::move(next.m_data);
+		next.m_isValid = false;
+		m_nextReliableReceiveId++;
+	}
+}
+
+void NetConnection::ReceiveUnreliableMessage(uint16_t messageId, uint8_t const* data, size_t numBytes)
+{
+	if (m_hasReceivedUnreliable && !IsSequenceNewer(messageId, m_lastUnreliableReceiveId))
+	{
+		return; // older than something already delivered
+	}
+	m_hasReceivedUnreliable = true;
+	m_lastUnreliableReceiveId = messageId;
+
+	NetMessage& message = m_incomingMessages.emplace_back();
+	m_stats.m_messagesReceived++;
+	message.m_channel = NetChannel::UNRELIABLE_SEQUENCED;
+	message.m_data.assign(data, data + numBytes);
+}
+
+double NetConnection::GetReliableResendDelay() const
+{
+	double delay = m_stats.m_roundTripTime * RELIABLE_RESEND_RTT_SCALE;
+	return (delay > RELIABLE_RESEND_MIN_SECONDS) ? delay : RELIABLE_RESEND_MIN_SECONDS;
+}
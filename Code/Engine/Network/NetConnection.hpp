@@ -0,0 +1,124 @@
+#pragma once
+#include "Engine/Network/NetCommon.hpp"
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+class NetBufferWriter;
+class NetBufferReader;
+
+//-----------------------------------------------------------------------------------------------
+struct NetMessage
+{
+	NetChannel				m_channel = NetChannel::RELIABLE_ORDERED;
+	std::vector<uint8_t>	m_data;
+};
+
+//-----------------------------------------------------------------------------------------------
+// One end of a virtual connection over UDP. Pure protocol logic, no sockets: the owner feeds in
+// received payload packets and asks for outgoing ones, so it can be driven over loopback or
+// entirely in memory.
+//
+// Every payload packet carries a 16 bit sequence number plus the newest received remote sequence
+// and a 32 bit field acking the 32 before it, so each ack is repeated in many packets and a lost
+// packet rarely loses an ack. Reliable messages remember which packets carried them and are
+// resent when none of those packets is acked in time. Queued messages of both channels are
+// coalesced into as few packets of at most NET_MAX_PACKET_SIZE bytes as possible.
+//
+class NetConnection
+{
+public:
+	NetConnection();
+
+	void Reset();
+	void SetState(NetConnectionState state, double currentTime);
+	NetConnectionState GetState() const;
+
+	NetAddress const& GetAddress() const;
+	void SetAddress(NetAddress const& address);
+
+	// Returns false if the message is larger than NET_MAX_MESSAGE_SIZE
+	bool QueueMessage(NetChannel channel, void const* data, size_t numBytes);
+
+	// Builds the next payload packet into outPacket (cleared first). Returns false when there
+	// is nothing worth sending: no messages due and no ack or keep-alive owed.
+	bool WritePayloadPacket(std::vector<uint8_t>& outPacket, uint32_t protocolId, double currentTime, double keepAliveSeconds);
+
+	// Parses a payload packet after the protocol id and packet type have been consumed.
+	// Returns false if the packet is malformed, in which case nothing is delivered.
+	bool ReadPayloadPacket(NetBufferReader& reader, double currentTime);
+
+	// Moves messages that are ready for the game into out_messages
+	void RetrieveIncomingMessages(std::vector<NetMessage>& out_messages);
+
+	double GetLastReceiveTime() const;
+	double GetRoundTripTime() const;
+	// Counters plus the current queue depth
+	NetConnectionStats GetStats() const;
+	int GetNumPendingReliableMessages() const;
+
+private:
+	struct SentPacketRecord
+	{
+		uint16_t				m_sequence = 0;
+		bool					m_isValid = false;
+		bool					m_isAcked = false;
+		double					m_sendTime = 0.0;
+		std::vector<uint16_t>	m_reliableMessageIds;
+	};
+
+	struct OutgoingReliableMessage
+	{
+		uint16_t				m_id = 0;
+		bool					m_isAcked = false;
+		double					m_lastSendTime = -1.0;
+		std::vector<uint8_t>	m_data;
+	};
+
+	struct IncomingReliableSlot
+	{
+		uint16_t				m_id = 0;
+		bool					m_isValid = false;
+		std::vector<uint8_t>	m_data;
+	};
+
+	void ProcessAcks(uint16_t ack, uint32_t ackBits, double currentTime);
+	void OnPacketAcked(SentPacketRecord& record, double currentTime);
+	void ReceiveReliableMessage(uint16_t messageId, uint8_t const* data, size_t numBytes);
+	void ReceiveUnreliableMessage(uint16_t messageId, uint8_t const* data, size_t numBytes);
+	double GetReliableResendDelay() const;
+
+private:
+	NetAddress			m_address;
+	NetConnectionState	m_state = NetConnectionState::DISCONNECTED;
+	double				m_lastReceiveTime = 0.0;
+	double				m_lastSendTime = 0.0;
+
+	// Packet level sequencing and acks
+	uint16_t			m_localSequence = 0;
+	uint16_t			m_remoteSequence = 0;
+	uint32_t			m_remoteAckBits = 0;
+	bool				m_hasReceivedPacket = false;
+	bool				m_isAckPending = false;
+	std::vector<SentPacketRecord> m_sentPackets; // ring, indexed by sequence % NET_SENT_PACKET_BUFFER_SIZE
+
+	// Reliable ordered channel
+	uint16_t			m_nextReliableSendId = 0;
+	uint16_t			m_nextReliableReceiveId = 0;
+	std::deque<OutgoingReliableMessage> m_outgoingReliable; // contiguous ids, front is the oldest unacked
+	std::vector<IncomingReliableSlot> m_incomingReliable; // ring, indexed by id % NET_RELIABLE_WINDOW_SIZE
+
+	// Unreliable sequenced channel
+	uint16_t			m_nextUnreliableSendId = 0;
+	uint16_t			m_lastUnreliableReceiveId = 0;
+	bool				m_hasReceivedUnreliable = false;
+	std::vector<NetMessage> m_outgoingUnreliable;
+
+	std::vector<NetMessage> m_incomingMessages;
+
+	NetConnectionStats	m_stats;
+};
+
+//-----------------------------------------------------------------------------------------------
+void WriteNetPacketHeader(NetBufferWriter& writer, uint32_t protocolId, NetPacketType type);
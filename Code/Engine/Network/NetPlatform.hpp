@@ -0,0 +1,59 @@
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+// Socket API for NetworkSystem and UdpNetworkSystem, include from .cpp files only.
+//
+// Windows gets Winsock2. POSIX gets BSD sockets plus the handful of Winsock names the network
+// code uses (SOCKET, closesocket, ioctlsocket, WSAGetLastError, WSAE*), so both platforms share
+// one send/recv path instead of two copies of every system.
+//
+#if defined(_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <WinSock2.h>
+#include <WS2TCPIP.h>
+#include <mstcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+
+constexpr int NET_SEND_FLAGS = 0;
+
+#else
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+
+typedef int SOCKET;
+constexpr SOCKET INVALID_SOCKET = -1;
+constexpr int SOCKET_ERROR = -1;
+
+constexpr int WSAEWOULDBLOCK = EWOULDBLOCK;
+constexpr int WSAEALREADY = EALREADY;
+constexpr int WSAEINPROGRESS = EINPROGRESS;
+constexpr int WSAECONNRESET = ECONNRESET;
+constexpr int WSAEMSGSIZE = EMSGSIZE;
+
+// A peer that closed the connection makes send() fail with EPIPE instead of raising SIGPIPE
+constexpr int NET_SEND_FLAGS = MSG_NOSIGNAL;
+
+struct WSADATA {};
+#define MAKEWORD(low, high) ((unsigned short)(((low) & 0xFF) | (((high) & 0xFF) << 8)))
+
+inline int WSAStartup(unsigned short, WSADATA*) { return 0; }
+inline int WSACleanup() { return 0; }
+inline int WSAGetLastError() { return errno; }
+inline int closesocket(SOCKET sock) { return close(sock); }
+inline int ioctlsocket(SOCKET sock, unsigned long command, unsigned long* argument)
+{
+	int value = static_cast<int>(*argument);
+	return ioctl(sock, command, &value);
+}
+
+#endif
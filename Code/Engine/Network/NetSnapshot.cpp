@@ -0,0 +1,305 @@
+#include "Engine/Network/NetSnapshot.hpp"
+#include "Engine/Network/NetBuffer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+//-----------------------------------------------------------------------------------------------
+constexpr uint32_t SNAPSHOT_WORD_SIZE = 4;
+
+static uint32_t GetNumWords(uint32_t stateSize)
+{
+	return (stateSize + SNAPSHOT_WORD_SIZE - 1) / SNAPSHOT_WORD_SIZE;
+}
+
+static uint32_t GetWordSize(uint32_t stateSize, uint32_t wordIndex)
+{
+	uint32_t start = wordIndex * SNAPSHOT_WORD_SIZE;
+	return (stateSize - start < SNAPSHOT_WORD_SIZE) ? (stateSize - start) : SNAPSHOT_WORD_SIZE;
+}
+
+//-----------------------------------------------------------------------------------------------
+NetSnapshot::NetSnapshot(uint32_t stateSize)
+	: m_stateSize(stateSize)
+{
+	GUARANTEE_OR_DIE(stateSize <= NET_SNAPSHOT_MAX_STATE_SIZE, "NetSnapshot state size exceeds NET_SNAPSHOT_MAX_STATE_SIZE");
+}
+
+void NetSnapshot::Clear()
+{
+	m_entityIds.clear();
+	m_states.clear();
+}
+
+void NetSnapshot::SetEntityState(uint32_t entityId, void const* state)
+{
+	int index = FindInsertIndex(entityId);
+	size_t offset = static_cast<size_t>(index) * m_stateSize;
+	if (index == static_cast<int>(m_entityIds.size()) || m_entityIds[index] != entityId)
+	{
+		m_entityIds.insert(m_entityIds.begin() + index, entityId);
+		m_states.insert(m_states.begin() + offset, m_stateSize, 0);
+	}
+	memcpy(m_states.data() + offset, state, m_stateSize);
+}
+
+bool NetSnapshot::RemoveEntity(uint32_t entityId)
+{
+	int index = FindInsertIndex(entityId);
+	if (index == static_cast<int>(m_entityIds.size()) || m_entityIds[index] != entityId)
+	{
+		return false;
+	}
+	size_t offset = static_cast<size_t>(index) * m_stateSize;
+	m_entityIds.erase(m_entityIds.begin() + index);
+	m_states.erase(m_states.begin() + offset, m_states.begin() + offset + m_stateSize);
+	return true;
+}
+
+uint8_t const* NetSnapshot::GetEntityState(uint32_t entityId) const
+{
+	int index = FindInsertIndex(entityId);
+	if (index == static_cast<int>(m_entityIds.size()) || m_entityIds[index] != entityId)
+	{
+		return nullptr;
+	}
+	return GetEntityStateAtIndex(index);
+}
+
+int NetSnapshot::GetNumEntities() const
+{
+	return static_cast<int>(m_entityIds.size());
+}
+
+uint32_t NetSnapshot::GetEntityIdAtIndex(int index) const
+{
+	return m_entityIds[index];
+}
+
+uint8_t const* NetSnapshot::GetEntityStateAtIndex(int index) const
+{
+	return m_states.data() + static_cast<size_t>(index) * m_stateSize;
+}
+
+uint32_t NetSnapshot::GetStateSize() const
+{
+	return m_stateSize;
+}
+
+int NetSnapshot::FindInsertIndex(uint32_t entityId) const
+{
+	auto found = std::lower_bound(m_entityIds.begin(), m_entityIds.end(), entityId);
+	return static_cast<int>(found - m_entityIds.begin());
+}
+
+//-----------------------------------------------------------------------------------------------
+void WriteSnapshotDelta(NetSnapshot const& baseline, NetSnapshot const& current, std::vector<uint8_t>& out_delta)
+{
+	uint32_t stateSize = current.GetStateSize();
+	GUARANTEE_OR_DIE(baseline.GetStateSize() == stateSize || baseline.GetNumEntities() == 0, "WriteSnapshotDelta state size mismatch");
+
+	uint32_t numWords = GetNumWords(stateSize);
+	uint32_t maskSize = (numWords + 7) / 8;
+	std::vector<uint8_t> zeroState(stateSize, 0);
+	std::vector<uint8_t> mask(maskSize);
+
+	out_delta.clear();
+	NetBufferWriter writer(out_delta);
+	writer.WriteVarUInt(current.m_tick);
+	writer.WriteVarUInt(stateSize);
+
+	// Removed: in baseline, not in current
+	std::vector<uint32_t> removedIds;
+	int baseIndex = 0;
+	int currIndex = 0;
+	int numBase = baseline.GetNumEntities();
+	int numCurr = current.GetNumEntities();
+	while (baseIndex < numBase)
+	{
+		uint32_t baseId = baseline.GetEntityIdAtIndex(baseIndex);
+		while (currIndex < numCurr && current.GetEntityIdAtIndex(currIndex) < baseId)
+		{
+			currIndex++;
+		}
+		if (currIndex == numCurr || current.GetEntityIdAtIndex(currIndex) != baseId)
+		{
+			removedIds.push_back(baseId);
+		}
+		baseIndex++;
+	}
+	writer.WriteVarUInt(static_cast<uint32_t>(removedIds.size()));
+	uint32_t previousId = 0;
+	for (uint32_t removedId : removedIds)
+	{
+		writer.WriteVarUInt(removedId - previousId);
+		previousId = removedId;
+	}
+
+	// Changed or new: count is patched in once known, reserve the widest varuint
+	size_t countOffset = writer.GetSize();
+	writer.WriteBytes("\0\0\0\0\0", 5);
+	uint32_t numChanged = 0;
+	previousId = 0;
+	baseIndex = 0;
+	for (currIndex = 0; currIndex < numCurr; ++currIndex)
+	{
+		uint32_t entityId = current.GetEntityIdAtIndex(currIndex);
+		while (baseIndex < numBase && baseline.GetEntityIdAtIndex(baseIndex) < entityId)
+		{
+			baseIndex++;
+		}
+		uint8_t const* currState = current.GetEntityStateAtIndex(currIndex);
+		uint8_t const* baseState = (baseIndex < numBase && baseline.GetEntityIdAtIndex(baseIndex) == entityId) ? baseline.GetEntityStateAtIndex(baseIndex) : zeroState.data();
+		bool isNew = (baseState == zeroState.data());
+
+		std::fill(mask.begin(), mask.end(), static_cast<uint8_t>(0));
+		bool anyChanged = false;
+		for (uint32_t wordIndex = 0; wordIndex < numWords; ++wordIndex)
+		{
+			uint32_t offset = wordIndex * SNAPSHOT_WORD_SIZE;
+			if (memcmp(currState + offset, baseState + offset, GetWordSize(stateSize, wordIndex)) != 0)
+			{
+				mask[wordIndex / 8] |= static_cast<uint8_t>(1u << (wordIndex % 8));
+				anyChanged = true;
+			}
+		}
+		if (!anyChanged && !isNew)
+		{
+			continue;
+		}
+
+		writer.WriteVarUInt(entityId - previousId);
+		previousId = entityId;
+		writer.WriteBytes(mask.data(), maskSize);
+		for (uint32_t wordIndex = 0; wordIndex < numWords; ++wordIndex)
+		{
+			if (mask[wordIndex / 8] & (1u << (wordIndex % 8)))
+			{
+				writer.WriteBytes(currState + wordIndex * SNAPSHOT_WORD_SIZE, GetWordSize(stateSize, wordIndex));
+			}
+		}
+		numChanged++;
+	}
+
+	// Fixed 5 byte varuint so the patch never shifts the data behind it
+	for (int byteIndex = 0; byteIndex < 5; ++byteIndex)
+	{
+		uint8_t byte = static_cast<uint8_t>((numChanged >> (7 * byteIndex)) & 0x7F);
+		if (byteIndex < 4)
+		{
+			byte |= 0x80;
+		}
+		writer.PatchUInt8(countOffset + byteIndex, byte);
+	}
+}
+
+bool ReadSnapshotDelta(NetSnapshot const& baseline, uint8_t const* delta, size_t deltaSize, NetSnapshot& out_current)
+{
+	NetBufferReader reader(delta, deltaSize);
+	uint32_t tick = reader.ReadVarUInt();
+	uint32_t stateSize = reader.ReadVarUInt();
+	bool isStateSizeFixed = baseline.GetStateSize() != 0 || baseline.GetNumEntities() > 0;
+	if (!reader.IsValid() || stateSize > NET_SNAPSHOT_MAX_STATE_SIZE || (isStateSizeFixed && baseline.GetStateSize() != stateSize))
+	{
+		return false;
+	}
+	uint32_t numWords = GetNumWords(stateSize);
+	uint32_t maskSize = (numWords + 7) / 8;
+
+	uint32_t numRemoved = reader.ReadVarUInt();
+	if (!reader.IsValid() || numRemoved > reader.GetRemainingSize())
+	{
+		return false;
+	}
+	std::vector<uint32_t> removedIds(numRemoved);
+	uint32_t previousId = 0;
+	for (uint32_t removedIndex = 0; removedIndex < numRemoved; ++removedIndex)
+	{
+		previousId += reader.ReadVarUInt();
+		removedIds[removedIndex] = previousId;
+	}
+
+	// Every changed entity costs at least its id and mask, so the count cannot outgrow the delta
+	uint32_t numChanged = reader.ReadVarUInt();
+	if (!reader.IsValid() || static_cast<uint64_t>(numChanged) * (1 + maskSize) > reader.GetRemainingSize())
+	{
+		return false;
+	}
+
+	NetSnapshot result(stateSize);
+	result.m_tick = tick;
+	std::vector<uint8_t> state(stateSize);
+
+	// Merge walk: carry over untouched baseline entities, apply changed ones in id order
+	int baseIndex = 0;
+	int numBase = baseline.GetNumEntities();
+	size_t removedIndex = 0;
+	auto copyBaselineUpTo = [&](uint32_t endId, bool isInclusive)
+	{
+		while (baseIndex < numBase)
+		{
+			uint32_t baseId = baseline.GetEntityIdAtIndex(baseIndex);
+			if (baseId > endId || (!isInclusive && baseId == endId))
+			{
+				break;
+			}
+			while (removedIndex < removedIds.size() && removedIds[removedIndex] < baseId)
+			{
+				removedIndex++;
+			}
+			bool isRemoved = removedIndex < removedIds.size() && removedIds[removedIndex] == baseId;
+			if (!isRemoved)
+			{
+				result.SetEntityState(baseId, baseline.GetEntityStateAtIndex(baseIndex));
+			}
+			baseIndex++;
+		}
+	};
+
+	previousId = 0;
+	for (uint32_t changedIndex = 0; changedIndex < numChanged; ++changedIndex)
+	{
+		uint32_t entityId = previousId + reader.ReadVarUInt();
+		previousId = entityId;
+		uint8_t const* mask = reader.ReadBytes(maskSize);
+		if (!reader.IsValid())
+		{
+			return false;
+		}
+
+		copyBaselineUpTo(entityId, false);
+		if (baseIndex < numBase && baseline.GetEntityIdAtIndex(baseIndex) == entityId)
+		{
+			memcpy(state.data(), baseline.GetEntityStateAtIndex(baseIndex), stateSize);
+			baseIndex++;
+		}
+		else
+		{
+			std::fill(state.begin(), state.end(), static_cast<uint8_t>(0));
+		}
+
+		for (uint32_t wordIndex = 0; wordIndex < numWords; ++wordIndex)
+		{
+			if (mask[wordIndex / 8] & (1u << (wordIndex % 8)))
+			{
+				uint32_t wordSize = GetWordSize(stateSize, wordIndex);
+				uint8_t const* word = reader.ReadBytes(wordSize);
+				if (!reader.IsValid())
+				{
+					return false;
+				}
+				memcpy(state.data() + wordIndex * SNAPSHOT_WORD_SIZE, word, wordSize);
+			}
+		}
+		result.SetEntityState(entityId, state.data());
+	}
+	copyBaselineUpTo(0xFFFFFFFFu, true);
+
+	if (!reader.IsAtEnd())
+	{
+		return false;
+	}
+	out_current = std::move(result);
+	return true;
+}
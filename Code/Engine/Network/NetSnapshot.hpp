@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Largest entity state record, checked by ReadSnapshotDelta before it allocates anything
+constexpr uint32_t NET_SNAPSHOT_MAX_STATE_SIZE = 1024;
+
+//-----------------------------------------------------------------------------------------------
+// Replicated entity state for one tick. Every entity has a fixed size, plain-old-data state
+// record; entities are kept sorted by id so two snapshots can be diffed with a single merge walk.
+//
+// Typical use: the server keeps the snapshots it sent by tick, the client acks the newest tick it
+// received, and the server writes the next snapshot as a delta against that acked one (or against
+// an empty snapshot when nothing has been acked yet). Deltas are sent on the unreliable channel,
+// a lost delta is simply superseded by the next one.
+//
+class NetSnapshot
+{
+public:
+	NetSnapshot() = default;
+	explicit NetSnapshot(uint32_t stateSize);
+
+	void		Clear();
+	void		SetEntityState(uint32_t entityId, void const* state);
+	bool		RemoveEntity(uint32_t entityId);
+	// Returns nullptr if the entity is not in the snapshot
+	uint8_t const* GetEntityState(uint32_t entityId) const;
+
+	int			GetNumEntities() const;
+	uint32_t	GetEntityIdAtIndex(int index) const;
+	uint8_t const* GetEntityStateAtIndex(int index) const;
+	uint32_t	GetStateSize() const;
+
+public:
+	uint32_t	m_tick = 0;
+
+private:
+	int			FindInsertIndex(uint32_t entityId) const;
+
+private:
+	uint32_t				m_stateSize = 0;
+	std::vector<uint32_t>	m_entityIds;	// sorted ascending
+	std::vector<uint8_t>	m_states;		// m_entityIds.size() * m_stateSize bytes
+};
+
+//-----------------------------------------------------------------------------------------------
+// Delta format: only removed ids, and for changed or new entities a bitmask of the changed 4 byte
+// words followed by those words. Unchanged entities cost nothing. Ids are delta coded as varuints.
+// Both snapshots must have the same state size.
+void WriteSnapshotDelta(NetSnapshot const& baseline, NetSnapshot const& current, std::vector<uint8_t>& out_delta);
+
+// Rebuilds the current snapshot from the baseline it was written against.
+// Returns false if the delta is malformed or does not match the baseline. An empty baseline still
+// fixes the state size it was constructed with, only a default constructed one accepts any size
+// up to NET_SNAPSHOT_MAX_STATE_SIZE.
+bool ReadSnapshotDelta(NetSnapshot const& baseline, uint8_t const* delta, size_t deltaSize, NetSnapshot& out_current);
@@ -1,17 +1,82 @@
 #include "Engine/Network/NetworkSystem.hpp"
 #include "Engine/Core/EngineCommon.hpp"
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
-#include <WinSock2.h>
-#include <WS2TCPIP.h>
-#pragma comment(lib, "Ws2_32.lib")
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Network/NetPlatform.hpp"
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#if defined(_WIN32)
+#include <Psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+static NetworkSystem* s_networkSystem = nullptr; // for the DevConsole commands
+
+// Kernel smoothed RTT of a connected TCP socket, 0 if the OS cannot tell (before Windows 10 1703)
+static double GetTcpRoundTripTime(SocketHandle sock)
+{
+	if (sock == INVALID_SOCKET_HANDLE)
+	{
+		return 0.0;
+	}
+#if defined(SIO_TCP_INFO)
+	DWORD version = 0;
+	TCP_INFO_v0 info = {};
+	DWORD bytesReturned = 0;
+	int ret = WSAIoctl((SOCKET)sock, SIO_TCP_INFO, &version, sizeof(version), &info, sizeof(info), &bytesReturned, NULL, NULL);
+	if (ret == SOCKET_ERROR)
+	{
+		return 0.0;
+	}
+	return static_cast<double>(info.RttUs) * 0.000001;
+#elif defined(TCP_INFO)
+	tcp_info info = {};
+	socklen_t infoLength = sizeof(info);
+	if (getsockopt((SOCKET)sock, IPPROTO_TCP, TCP_INFO, &info, &infoLength) != 0)
+	{
+		return 0.0;
+	}
+	return static_cast<double>(info.tcpi_rtt) * 0.000001;
+#else
+	return 0.0;
+#endif
+}
+
+// Resident set of the whole process, 0 if the OS cannot tell
+static size_t GetResidentSetBytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.WorkingSetSize;
+#else
+	FILE* statmFile = fopen("/proc/self/statm", "r");
+	if (statmFile == nullptr)
+	{
+		return 0;
+	}
+	unsigned long long totalPages = 0;
+	unsigned long long residentPages = 0;
+	int numRead = fscanf(statmFile, "%llu %llu", &totalPages, &residentPages);
+	fclose(statmFile);
+	return (numRead == 2) ? static_cast<size_t>(residentPages * static_cast<unsigned long long>(sysconf(_SC_PAGESIZE))) : 0;
+#endif
+}
 
 
 //-----------------------------------------------------------------------------------------------
 NetworkSystem::NetworkSystem(NetworkConfig const& config)
 	: m_config(config)
 {
-	
+	m_clientSendConditioner.SetConfig(m_config.m_conditioner);
 }
 
 void NetworkSystem::Startup()
@@ -25,11 +90,28 @@ void NetworkSystem::Startup()
 	}
 
 	m_state = NetState::IDLE;
+
+	s_networkSystem = this;
+	if (g_theEventSystem)
+	{
+		g_theEventSystem->SubscribeEventCallbackFunction("NetStats", NetworkSystem::Command_NetStats);
+		g_theEventSystem->SubscribeEventCallbackFunction("NetConditioner", NetworkSystem::Command_NetConditioner);
+	}
 }
 
 
 void NetworkSystem::Shutdown()
 {
+	if (g_theEventSystem)
+	{
+		g_theEventSystem->UnsubscribeEventCallbackFunction("NetStats", NetworkSystem::Command_NetStats);
+		g_theEventSystem->UnsubscribeEventCallbackFunction("NetConditioner", NetworkSystem::Command_NetConditioner);
+	}
+	if (s_networkSystem == this)
+	{
+		s_networkSystem = nullptr;
+	}
+
 	StopServer();
 	StopClient();
 	if (m_state != NetState::INACTIVE)
@@ -111,7 +193,7 @@ bool NetworkSystem::StartServer(unsigned short listenPort)
 
 	sockaddr_in addr = {};
 	addr.sin_family = AF_INET;
-	addr.sin_addr.S_un.S_addr = htonl(INADDR_ANY);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
 	addr.sin_port = htons(listenPort);
 
 	ret = bind(listenSock, (sockaddr*)&addr, (int)sizeof(addr));
@@ -144,15 +226,12 @@ void NetworkSystem::StopServer()
 {
 	CloseSocket(m_listenSocket);
 
-	for (NetClientInfo* client : m_serverClients)
+	for (int clientIndex = 0; clientIndex < m_serverClients.GetCount(); ++clientIndex)
 	{
-		if (client)
-		{
-			CloseSocket(client->m_socket);
-		}
+		CloseSocket(m_serverClients.GetAtDenseIndex(clientIndex).m_socket);
 	}
 
-	m_serverClients.clear();
+	m_serverClients.Clear();
 	if (m_state == NetState::SERVER_LISTENING)
 	{
 		m_state = NetState::IDLE;
@@ -199,7 +278,8 @@ bool NetworkSystem::StartClient(std::string const& serverIP, unsigned short serv
 	if (ret == SOCKET_ERROR) 
 	{
 		int errorCode = WSAGetLastError();
-		if (errorCode != WSAEWOULDBLOCK && errorCode != WSAEALREADY) // multiple times? WSAEALREADY
+		// Winsock reports a pending non-blocking connect as WSAEWOULDBLOCK, POSIX as EINPROGRESS
+		if (errorCode != WSAEWOULDBLOCK && errorCode != WSAEALREADY && errorCode != WSAEINPROGRESS) // multiple times? WSAEALREADY
 		{
 			DebuggerPrintf("Client: connect() failed: %s\n", WsaErrorCodeToString(errorCode).c_str());
 			closesocket(connSock);
@@ -210,6 +290,9 @@ bool NetworkSystem::StartClient(std::string const& serverIP, unsigned short serv
 	m_connectionToServerSocket = (SocketHandle)connSock;
 	m_clientRecvBuffer.clear();
 	m_clientSendBuffer.clear();
+	m_clientConditionedSendBuffer.clear();
+	m_clientSendConditioner.Clear();
+	m_clientStats = NetConnectionStats();
 	m_outgoingStrings.clear();
 	m_incomingStrings.clear();
 	m_state = NetState::CLIENT_CONNECTING;
@@ -223,6 +306,8 @@ void NetworkSystem::StopClient()
 
 	m_clientRecvBuffer.clear();
 	m_clientSendBuffer.clear();
+	m_clientConditionedSendBuffer.clear();
+	m_clientSendConditioner.Clear();
 	if (m_state == NetState::CLIENT_CONNECTING || m_state == NetState::CLIENT_CONNECTED)
 	{
 		m_state = NetState::IDLE;
@@ -244,17 +329,82 @@ void NetworkSystem::QueueOutgoingString(const std::string& s)
 	m_outgoingStrings.push_back(s);
 }
 
-void NetworkSystem::QueueOutgoingStringToClient(SocketHandle client, const std::string& s)
+bool NetworkSystem::QueueOutgoingStringToClient(NetClientHandle client, const std::string& s)
+{
+	NetClientInfo* clientInfo = m_serverClients.Get(client);
+	if (clientInfo == nullptr)
+	{
+		return false;
+	}
+	clientInfo->m_outgoingStrings.push_back(s);
+	return true;
+}
+
+int NetworkSystem::GetNumServerClients() const
+{
+	return m_serverClients.GetCount();
+}
+
+NetClientHandle NetworkSystem::GetServerClientHandle(int clientIndex) const
+{
+	if (clientIndex < 0 || clientIndex >= m_serverClients.GetCount())
+	{
+		return NetClientHandle();
+	}
+	return m_serverClients.GetHandleAtDenseIndex(clientIndex);
+}
+
+bool NetworkSystem::IsServerClientConnected(NetClientHandle client) const
+{
+	return m_serverClients.IsValid(client);
+}
+
+void NetworkSystem::DisconnectServerClient(NetClientHandle client)
 {
-	if (m_state != NetState::SERVER_LISTENING) return;
-	for (NetClientInfo* c : m_serverClients) 
+	NetClientInfo* clientInfo = m_serverClients.Get(client);
+	if (clientInfo == nullptr)
 	{
-		if (c != nullptr && c->m_socket == client) 
+		return;
+	}
+	CloseSocket(clientInfo->m_socket);
+	m_serverClients.Remove(client);
+}
+
+void NetworkSystem::SetConditionerConfig(NetConditionerConfig const& config)
+{
+	m_config.m_conditioner = config;
+	m_clientSendConditioner.SetConfig(config);
+	for (int clientIndex = 0; clientIndex < m_serverClients.GetCount(); ++clientIndex)
+	{
+		m_serverClients.GetAtDenseIndex(clientIndex).m_sendConditioner.SetConfig(config);
+	}
+}
+
+NetConditionerConfig const& NetworkSystem::GetConditionerConfig() const
+{
+	return m_config.m_conditioner;
+}
+
+std::vector<NetConnectionStats> NetworkSystem::GetConnectionStats() const
+{
+	std::vector<NetConnectionStats> result;
+	if (m_state == NetState::SERVER_LISTENING)
+	{
+		for (int clientIndex = 0; clientIndex < m_serverClients.GetCount(); ++clientIndex)
 		{
-			c->m_outgoingStrings.push_back(s);
-			break;
+			NetClientInfo const& client = m_serverClients.GetAtDenseIndex(clientIndex);
+			NetConnectionStats& stats = result.emplace_back(client.m_stats);
+			FillQueueStats(stats, client.m_socket, client.m_outgoingStrings, client.m_sendBuffer,
+				client.m_sendConditioner, client.m_conditionedSendBuffer);
 		}
 	}
+	else if (m_state == NetState::CLIENT_CONNECTED)
+	{
+		NetConnectionStats& stats = result.emplace_back(m_clientStats);
+		FillQueueStats(stats, m_connectionToServerSocket, m_outgoingStrings, m_clientSendBuffer,
+			m_clientSendConditioner, m_clientConditionedSendBuffer);
+	}
+	return result;
 }
 
 std::vector<std::string> NetworkSystem::RetrieveIncomingStrings()
@@ -268,7 +418,7 @@ std::vector<std::string> NetworkSystem::RetrieveIncomingStrings()
 	return result;
 }
 
-void NetworkSystem::ExtractIncomingStrings(std::vector<uint8_t>& recvBuffer)
+void NetworkSystem::ExtractIncomingStrings(std::vector<uint8_t>& recvBuffer, NetConnectionStats& stats)
 {
 	size_t start = 0;
 	while (true) 
@@ -278,6 +428,7 @@ void NetworkSystem::ExtractIncomingStrings(std::vector<uint8_t>& recvBuffer)
 
 		size_t end = it - recvBuffer.begin();
 		m_incomingStrings.emplace_back(reinterpret_cast<const char*>(&recvBuffer[start]), end - start);
+		stats.m_messagesReceived++;
 		start = end + 1;
 	}
 	if (start > 0) 
@@ -286,7 +437,7 @@ void NetworkSystem::ExtractIncomingStrings(std::vector<uint8_t>& recvBuffer)
 	}
 }
 
-void NetworkSystem::BufferOutgoingStrings(std::deque<std::string>& stringQueue, std::vector<uint8_t>& sendBuffer)
+void NetworkSystem::BufferOutgoingStrings(std::deque<std::string>& stringQueue, std::vector<uint8_t>& sendBuffer, NetConnectionStats& stats)
 {
 	while (!stringQueue.empty()) 
 	{
@@ -294,17 +445,20 @@ void NetworkSystem::BufferOutgoingStrings(std::deque<std::string>& stringQueue,
 		sendBuffer.insert(sendBuffer.end(), s.begin(), s.end());
 		sendBuffer.push_back('\0');
 		stringQueue.pop_front();
+		stats.m_messagesSent++;
 	}
 }
 
 void NetworkSystem::BroadcastOutgoingStrings(const std::deque<std::string>& stringQueue)
 {
-	for (NetClientInfo* client : m_serverClients) 
+	for (int clientIndex = 0; clientIndex < m_serverClients.GetCount(); ++clientIndex)
 	{
+		NetClientInfo& client = m_serverClients.GetAtDenseIndex(clientIndex);
 		for (const std::string& s : stringQueue) 
 		{
-			client->m_sendBuffer.insert(client->m_sendBuffer.end(), s.begin(), s.end());
-			client->m_sendBuffer.push_back('\0');
+			client.m_sendBuffer.insert(client.m_sendBuffer.end(), s.begin(), s.end());
+			client.m_sendBuffer.push_back('\0');
+			client.m_stats.m_messagesSent++;
 		}
 	}
 }
@@ -331,11 +485,13 @@ void NetworkSystem::AcceptNetClients()
 			continue;
 		}
 
-		NetClientInfo* client = new NetClientInfo();
-		client->m_socket = newClientSock;
-		client->m_recvBuffer.reserve(RECV_BUFFER_SIZE);
-		client->m_sendBuffer.reserve(RECV_BUFFER_SIZE);
-		m_serverClients.push_back(client);
+		NetClientHandle handle = m_serverClients.Add();
+		NetClientInfo& client = *m_serverClients.Get(handle);
+		client.Reset();
+		client.m_socket = (SocketHandle)newClientSock;
+		client.m_recvBuffer.reserve(RECV_BUFFER_SIZE);
+		client.m_sendBuffer.reserve(RECV_BUFFER_SIZE);
+		client.m_sendConditioner.SetConfig(m_config.m_conditioner);
 		DebuggerPrintf("Server: new client accepted\n");
 	}
 }
@@ -347,71 +503,65 @@ void NetworkSystem::ServerSendRecv()
 	BroadcastOutgoingStrings(m_outgoingStrings);
 	m_outgoingStrings.clear();
 	
-	for (NetClientInfo* client : m_serverClients) 
+	for (int clientIndex = 0; clientIndex < m_serverClients.GetCount(); ++clientIndex)
 	{
-		BufferOutgoingStrings(client->m_outgoingStrings, client->m_sendBuffer); // single point
+		NetClientInfo& client = m_serverClients.GetAtDenseIndex(clientIndex);
+		BufferOutgoingStrings(client.m_outgoingStrings, client.m_sendBuffer, client.m_stats); // single point
 	}
 
+	// a pending disconnect releases everything the conditioner still holds
+	double releaseTime = m_pendingDisconnected ? DBL_MAX : GetCurrentTimeSeconds();
+
 
 	//-----------------------------------------------------------------------------------------------
 	// Send and Recv
-	for (NetClientInfo* client : m_serverClients) 
+	// backwards, removing a client swaps the last one into its place
+	for (int clientIndex = m_serverClients.GetCount() - 1; clientIndex >= 0; --clientIndex)
 	{
+		NetClientInfo& client = m_serverClients.GetAtDenseIndex(clientIndex);
+		bool isAlive = true;
+
 		// Send
-		while (!client->m_sendBuffer.empty()) 
+		if (!SendBufferedBytes(client.m_socket, client.m_sendBuffer, client.m_sendConditioner,
+			client.m_conditionedSendBuffer, client.m_stats, releaseTime))
 		{
-			int sent = send((SOCKET)client->m_socket,
-				reinterpret_cast<const char*>(client->m_sendBuffer.data()),
-				(int)client->m_sendBuffer.size(), 0);
-			if (sent > 0) 
-			{
-				client->m_sendBuffer.erase(client->m_sendBuffer.begin(), client->m_sendBuffer.begin() + sent);
-			}
-			else {
-				int errorCode = WSAGetLastError();
-				if (errorCode == WSAEWOULDBLOCK) break;
-				DebuggerPrintf("Server: send() error, closing client: %s\n", WsaErrorCodeToString(errorCode).c_str());
-				CloseSocket(client->m_socket);
-				break;
-			}
-			// sent will not be zero?
+			DebuggerPrintf("Server: send() error, closing client\n");
+			isAlive = false;
 		}
 		// Recv
 		uint8_t temp[RECV_BUFFER_SIZE];
 		int recvCount = 0;
-		while (++recvCount <= MAX_RECV_PER_CLIENT_PER_FRAME)
+		while (isAlive && ++recvCount <= MAX_RECV_PER_CLIENT_PER_FRAME)
 		{
-			int recvd = recv((SOCKET)client->m_socket, (char*)temp, RECV_BUFFER_SIZE, 0);
+			int recvd = recv((SOCKET)client.m_socket, (char*)temp, RECV_BUFFER_SIZE, 0);
 			if (recvd > 0) 
 			{
 				// Read data from the socket into a buffer
-				client->m_recvBuffer.insert(client->m_recvBuffer.end(), temp, temp + recvd);
+				client.m_recvBuffer.insert(client.m_recvBuffer.end(), temp, temp + recvd);
+				client.m_stats.m_bytesReceived += recvd;
 
 				// Process Data
-				ExtractIncomingStrings(client->m_recvBuffer);
+				ExtractIncomingStrings(client.m_recvBuffer, client.m_stats);
 			}
 			else if (recvd == 0) // the connection has been gracefully closed (by peer?)
 			{
 				DebuggerPrintf("Server: client disconnected (recv returns 0)\n");
-				CloseSocket(client->m_socket);
-				break;
+				isAlive = false;
 			}
 			else 
 			{
 				int errorCode = WSAGetLastError();
 				if (errorCode == WSAEWOULDBLOCK) break; // nothing new to recv
 				DebuggerPrintf("Server: recv() error, closing client: %s\n", WsaErrorCodeToString(errorCode).c_str());
-				CloseSocket(client->m_socket);
-				break;
+				isAlive = false;
 			}
 		}
+
+		if (!isAlive)
+		{
+			DisconnectServerClient(m_serverClients.GetHandleAtDenseIndex(clientIndex));
+		}
 	}
-	// clean disconnected client (-1)
-	m_serverClients.erase(
-		std::remove_if(m_serverClients.begin(), m_serverClients.end(),
-			[](NetClientInfo const* c) { return c->m_socket == -1; }),
-		m_serverClients.end()
-	);
 }
 
 void NetworkSystem::ClientConnecting()
@@ -425,7 +575,7 @@ void NetworkSystem::ClientConnecting()
 	FD_SET((SOCKET)m_connectionToServerSocket, &exceptSockets);	// like .push_back()	
 	timeval waitTime = { };
 
-	int ret = select(0, NULL, &writeSockets, &exceptSockets, &waitTime);
+	int ret = select((int)m_connectionToServerSocket + 1, NULL, &writeSockets, &exceptSockets, &waitTime); // nfds is ignored by Winsock
 	// zero if the time limit expired
 	// After select only available fd(socket) is kept in the set
 	if (ret == SOCKET_ERROR)
@@ -436,17 +586,22 @@ void NetworkSystem::ClientConnecting()
 		return;
 	}
 
-	if (FD_ISSET((SOCKET)m_connectionToServerSocket, &exceptSockets)) 
+	// Winsock flags a failed connect in exceptSockets, POSIX marks the socket writable with SO_ERROR set
+	int error = 0;
+	bool isWritable = FD_ISSET((SOCKET)m_connectionToServerSocket, &writeSockets);
+	if (FD_ISSET((SOCKET)m_connectionToServerSocket, &exceptSockets) || isWritable)
 	{
-		int error = 0;
-		int len = sizeof(error);
+		socklen_t len = sizeof(error);
 		getsockopt((SOCKET)m_connectionToServerSocket, SOL_SOCKET, SO_ERROR, (char*)&error, &len);
+	}
+	if (FD_ISSET((SOCKET)m_connectionToServerSocket, &exceptSockets) || (isWritable && error != 0)) 
+	{
 		DebuggerPrintf("Client: connect failed, please start client again, error code: %d (%s)\n", error, WsaErrorCodeToString(error).c_str());
 
 		StopClient();
 		return;
 	}
-	if (FD_ISSET((SOCKET)m_connectionToServerSocket, &writeSockets)) 
+	if (isWritable) 
 	{
 		m_state = NetState::CLIENT_CONNECTED;
 		DebuggerPrintf("Client: connected successfully.\n");
@@ -455,26 +610,15 @@ void NetworkSystem::ClientConnecting()
 
 void NetworkSystem::ClientSendRecv()
 {
-	BufferOutgoingStrings(m_outgoingStrings, m_clientSendBuffer);
+	BufferOutgoingStrings(m_outgoingStrings, m_clientSendBuffer, m_clientStats);
 
-	while (!m_clientSendBuffer.empty()) 
+	double releaseTime = m_pendingDisconnected ? DBL_MAX : GetCurrentTimeSeconds();
+	if (!SendBufferedBytes(m_connectionToServerSocket, m_clientSendBuffer, m_clientSendConditioner,
+		m_clientConditionedSendBuffer, m_clientStats, releaseTime))
 	{
-		int sent = send((SOCKET)m_connectionToServerSocket,
-			reinterpret_cast<const char*>(m_clientSendBuffer.data()),
-			(int)m_clientSendBuffer.size(), 0);
-		if (sent > 0) 
-		{
-			m_clientSendBuffer.erase(m_clientSendBuffer.begin(), m_clientSendBuffer.begin() + sent);
-		}
-		else 
-		{
-			int errorCode = WSAGetLastError();
-			if (errorCode == WSAEWOULDBLOCK) break;
-			DebuggerPrintf("Client: send() error, closing client: %s\n", WsaErrorCodeToString(errorCode).c_str());
-			StopClient();
-			return;
-		}
-		// sent will not be zero?
+		DebuggerPrintf("Client: send() error, closing client\n");
+		StopClient();
+		return;
 	}
 
 	uint8_t temp[RECV_BUFFER_SIZE];
@@ -485,9 +629,10 @@ void NetworkSystem::ClientSendRecv()
 		if (recvd > 0) 
 		{
 			m_clientRecvBuffer.insert(m_clientRecvBuffer.end(), temp, temp + recvd);
+			m_clientStats.m_bytesReceived += recvd;
 
 			// Process data
-			ExtractIncomingStrings(m_clientRecvBuffer);
+			ExtractIncomingStrings(m_clientRecvBuffer, m_clientStats);
 		}
 		else if (recvd == 0) 
 		{
@@ -505,6 +650,129 @@ void NetworkSystem::ClientSendRecv()
 	}
 }
 
+bool NetworkSystem::SendBufferedBytes(SocketHandle sock, std::vector<uint8_t>& sendBuffer, NetConditioner& conditioner,
+	std::vector<uint8_t>& conditionedSendBuffer, NetConnectionStats& stats, double releaseTime)
+{
+	// Without the conditioner the send buffer goes straight to the socket. With it, each frame's
+	// bytes wait in the conditioner as one chunk and move to conditionedSendBuffer once released.
+	// Whatever sits in conditionedSendBuffer always goes first so the stream stays in order.
+	if (conditioner.IsEnabled() && !sendBuffer.empty())
+	{
+		conditioner.Enqueue(NetAddress(), sendBuffer.data(), sendBuffer.size(), GetCurrentTimeSeconds());
+		sendBuffer.clear();
+	}
+	NetConditionedPacket chunk;
+	double chunkReleaseTime = conditioner.IsEnabled() ? releaseTime : DBL_MAX; // turned off, let the rest out
+	while (conditioner.PopReadyPacket(chunk, chunkReleaseTime))
+	{
+		conditionedSendBuffer.insert(conditionedSendBuffer.end(), chunk.m_data.begin(), chunk.m_data.end());
+	}
+	std::vector<uint8_t>& bytesToSend = conditionedSendBuffer.empty() ? sendBuffer : conditionedSendBuffer;
+	if (&bytesToSend == &conditionedSendBuffer && !sendBuffer.empty())
+	{
+		conditionedSendBuffer.insert(conditionedSendBuffer.end(), sendBuffer.begin(), sendBuffer.end());
+		sendBuffer.clear();
+	}
+
+	while (!bytesToSend.empty())
+	{
+		int sent = (int)send((SOCKET)sock, reinterpret_cast<const char*>(bytesToSend.data()), (int)bytesToSend.size(), NET_SEND_FLAGS);
+		if (sent > 0)
+		{
+			bytesToSend.erase(bytesToSend.begin(), bytesToSend.begin() + sent);
+			stats.m_bytesSent += sent;
+		}
+		else
+		{
+			int errorCode = WSAGetLastError();
+			if (errorCode == WSAEWOULDBLOCK) break;
+			DebuggerPrintf("send() error: %s\n", WsaErrorCodeToString(errorCode).c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+void NetworkSystem::FillQueueStats(NetConnectionStats& stats, SocketHandle sock, std::deque<std::string> const& stringQueue,
+	std::vector<uint8_t> const& sendBuffer, NetConditioner const& conditioner, std::vector<uint8_t> const& conditionedSendBuffer) const
+{
+	// Strings already flattened into the send buffers only count as bytes
+	stats.m_queuedMessages = static_cast<int>(stringQueue.size());
+	stats.m_queuedBytes = sendBuffer.size() + conditioner.GetNumPendingBytes() + conditionedSendBuffer.size();
+	for (std::string const& s : stringQueue)
+	{
+		stats.m_queuedBytes += s.size() + 1;
+	}
+	stats.m_roundTripTime = GetTcpRoundTripTime(sock);
+}
+
+bool NetworkSystem::Command_NetStats(EventArgs& args)
+{
+	UNUSED(args);
+	NetworkSystem* system = s_networkSystem;
+	if (system == nullptr || (system->m_state != NetState::SERVER_LISTENING && system->m_state != NetState::CLIENT_CONNECTED))
+	{
+		return false; // UdpNetworkSystem may still answer
+	}
+
+	bool isServer = (system->m_state == NetState::SERVER_LISTENING);
+	Strings lines;
+	lines.push_back(Stringf("TCP %s, conditioner: %s", isServer ? "server" : "client", system->m_config.m_conditioner.ToString().c_str()));
+	std::vector<NetConnectionStats> allStats = system->GetConnectionStats();
+	for (int connectionIndex = 0; connectionIndex < static_cast<int>(allStats.size()); ++connectionIndex)
+	{
+		lines.push_back(Stringf("  #%d: %s", connectionIndex, allStats[connectionIndex].ToString().c_str()));
+	}
+
+	for (int lineIndex = 0; lineIndex < static_cast<int>(lines.size()); ++lineIndex)
+	{
+		if (g_theDevConsole)
+		{
+			g_theDevConsole->AddText((lineIndex == 0) ? DevConsole::INFO_MAJOR : DevConsole::INFO_MINOR, lines[lineIndex]);
+		}
+		else
+		{
+			DebuggerPrintf("%s\n", lines[lineIndex].c_str());
+		}
+	}
+	return false;
+}
+
+bool NetworkSystem::Command_NetConditioner(EventArgs& args)
+{
+	NetworkSystem* system = s_networkSystem;
+	if (system == nullptr)
+	{
+		return false;
+	}
+	NetConditionerConfig config = system->m_config.m_conditioner;
+	config.SetFromArgs(args);
+	system->SetConditionerConfig(config);
+
+	std::string text = "TCP conditioner: " + config.ToString();
+	if (g_theDevConsole)
+	{
+		g_theDevConsole->AddText(DevConsole::INFO_MAJOR, text);
+	}
+	else
+	{
+		DebuggerPrintf("%s\n", text.c_str());
+	}
+	return false;
+}
+
+void NetClientInfo::Reset()
+{
+	// clear() keeps the capacity, a reused slot does not allocate again
+	m_socket = INVALID_SOCKET_HANDLE;
+	m_recvBuffer.clear();
+	m_sendBuffer.clear();
+	m_outgoingStrings.clear();
+	m_sendConditioner.Clear();
+	m_conditionedSendBuffer.clear();
+	m_stats = NetConnectionStats();
+}
+
 void NetworkSystem::CloseSocket(SocketHandle& sock)
 {
 	if (sock != -1) // Invalid Socket
@@ -514,6 +782,139 @@ void NetworkSystem::CloseSocket(SocketHandle& sock)
 	}
 }
 
+//-----------------------------------------------------------------------------------------------
+std::string NetClientChurnBenchmarkResult::ToString() const
+{
+	return Stringf("%s%d waves of %d clients, %d accepted, %d slots used, %d stale handles connected. Server frame: avg %.3f ms, max %.3f ms over %d frames. RSS: start %.1f MB, peak %.1f MB, end %.1f MB",
+		m_isComplete ? "" : "INCOMPLETE ", m_numWaves, m_clientsPerWave, m_numAccepted, m_numSlotsUsed, m_numStaleHandlesConnected,
+		m_averageServerFrameMs, m_maxServerFrameMs, m_numServerFrames,
+		static_cast<double>(m_startResidentBytes) / (1024.0 * 1024.0), static_cast<double>(m_peakResidentBytes) / (1024.0 * 1024.0),
+		static_cast<double>(m_endResidentBytes) / (1024.0 * 1024.0));
+}
+
+NetClientChurnBenchmarkResult RunNetClientChurnBenchmark(unsigned short port, int numWaves, int clientsPerWave)
+{
+	constexpr double WAVE_TIMEOUT_SECONDS = 10.0;
+
+	NetClientChurnBenchmarkResult result;
+	result.m_numWaves = numWaves;
+	result.m_clientsPerWave = clientsPerWave;
+	result.m_startResidentBytes = GetResidentSetBytes();
+	result.m_peakResidentBytes = result.m_startResidentBytes;
+
+	// Every accept and disconnect is logged, printing them would be most of what gets timed
+	std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+	NetworkConfig config;
+	NetworkSystem server(config);
+	server.Startup();
+	std::vector<std::unique_ptr<NetworkSystem>> clients;
+	for (int clientIndex = 0; clientIndex < clientsPerWave; ++clientIndex)
+	{
+		clients.push_back(std::make_unique<NetworkSystem>(config));
+		clients.back()->Startup();
+	}
+
+	double totalServerFrameSeconds = 0.0;
+	auto runFrame = [&]()
+		{
+			double startSeconds = GetCurrentTimeSeconds();
+			server.BeginFrame();
+			server.EndFrame();
+			double frameSeconds = GetCurrentTimeSeconds() - startSeconds;
+			totalServerFrameSeconds += frameSeconds;
+			result.m_maxServerFrameMs = (frameSeconds * 1000.0 > result.m_maxServerFrameMs) ? frameSeconds * 1000.0 : result.m_maxServerFrameMs;
+			result.m_numServerFrames++;
+
+			for (std::unique_ptr<NetworkSystem>& client : clients)
+			{
+				client->BeginFrame();
+				client->EndFrame();
+			}
+		};
+	auto areAllClientsIn = [&]()
+		{
+			for (std::unique_ptr<NetworkSystem> const& client : clients)
+			{
+				if (client->GetState() != NetState::CLIENT_CONNECTED)
+				{
+					return false;
+				}
+			}
+			return server.GetNumServerClients() == clientsPerWave;
+		};
+
+	bool isComplete = server.StartServer(port);
+	std::vector<NetClientHandle> previousWaveHandles;
+	std::vector<NetClientHandle> waveHandles;
+	for (int waveIndex = 0; waveIndex < numWaves && isComplete; ++waveIndex)
+	{
+		for (std::unique_ptr<NetworkSystem>& client : clients)
+		{
+			isComplete = client->StartClient("127.0.0.1", port) && isComplete;
+		}
+		double timeoutSeconds = GetCurrentTimeSeconds() + WAVE_TIMEOUT_SECONDS;
+		while (isComplete && !areAllClientsIn() && GetCurrentTimeSeconds() < timeoutSeconds)
+		{
+			runFrame();
+		}
+		isComplete = isComplete && areAllClientsIn();
+		result.m_numAccepted += server.GetNumServerClients();
+
+		// The new wave took over the old slots, the old handles must not reach the new clients
+		for (NetClientHandle handle : previousWaveHandles)
+		{
+			result.m_numStaleHandlesConnected += server.IsServerClientConnected(handle) ? 1 : 0;
+		}
+		waveHandles.clear();
+		for (int clientIndex = 0; clientIndex < server.GetNumServerClients(); ++clientIndex)
+		{
+			waveHandles.push_back(server.GetServerClientHandle(clientIndex));
+			int numSlotsUsed = static_cast<int>(waveHandles.back().m_index) + 1;
+			result.m_numSlotsUsed = (numSlotsUsed > result.m_numSlotsUsed) ? numSlotsUsed : result.m_numSlotsUsed;
+		}
+
+		if (waveIndex % 2 == 0)
+		{
+			for (NetClientHandle handle : waveHandles)
+			{
+				server.DisconnectServerClient(handle);
+			}
+		}
+		for (std::unique_ptr<NetworkSystem>& client : clients)
+		{
+			client->StopClient();
+		}
+		while (server.GetNumServerClients() > 0 && GetCurrentTimeSeconds() < timeoutSeconds)
+		{
+			runFrame();
+		}
+		isComplete = isComplete && server.GetNumServerClients() == 0;
+		previousWaveHandles.swap(waveHandles);
+
+		size_t residentBytes = GetResidentSetBytes();
+		result.m_peakResidentBytes = (residentBytes > result.m_peakResidentBytes) ? residentBytes : result.m_peakResidentBytes;
+	}
+
+	for (std::unique_ptr<NetworkSystem>& client : clients)
+	{
+		client->Shutdown();
+	}
+	server.Shutdown();
+	std::cout.rdbuf(coutBuffer);
+
+	result.m_isComplete = isComplete;
+	result.m_averageServerFrameMs = (result.m_numServerFrames > 0) ? totalServerFrameSeconds * 1000.0 / result.m_numServerFrames : 0.0;
+	result.m_endResidentBytes = GetResidentSetBytes();
+	return result;
+}
+
+#if !defined(_WIN32)
+std::string WsaErrorCodeToString(int errorCode)
+{
+	return Stringf("errno %d: %s", errorCode, strerror(errorCode));
+}
+#else
 std::string WsaErrorCodeToString(int errorCode)
 {
 	switch (errorCode)
@@ -617,3 +1018,4 @@ std::string WsaErrorCodeToString(int errorCode)
 		return "Unknown Winsock error code: " + std::to_string(errorCode);
 	}
 }
+#endif // !_WIN32
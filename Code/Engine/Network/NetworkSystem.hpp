@@ -1,4 +1,8 @@
 #pragma once
+#include "Engine/Network/NetCommon.hpp"
+#include "Engine/Network/NetConditioner.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/SlotMap.hpp"
 #include <string>
 #include <vector>
 #include <deque>
@@ -10,6 +14,10 @@ This Network System is very simple, it can only poll string(check \0) from the b
 we do not support any protocol
 and it will store strings to send, and at begin frame or endframe it send these out.
 only TCP + IPV4
+
+Every connection keeps NetConnectionStats, and outgoing bytes can go through a STREAM mode
+NetConditioner (latency, jitter, bandwidth) before they reach send(). See the "NetStats" and
+"NetConditioner" DevConsole commands.
 */
 
 
@@ -19,7 +27,7 @@ std::string WsaErrorCodeToString(int errorCode);
 //-----------------------------------------------------------------------------------------------
 struct NetworkConfig
 {
-
+	NetConditionerConfig m_conditioner;
 };
 
 //-----------------------------------------------------------------------------------------------
@@ -33,14 +41,24 @@ enum class NetState
 	COUNT
 };
 
+// Pooled by the server, a slot and its buffers are reused by the next accepted client
 struct NetClientInfo
 {
+	void Reset();
+
 	SocketHandle			m_socket = INVALID_SOCKET_HANDLE;
 	std::vector<uint8_t>	m_recvBuffer;
 	std::vector<uint8_t>	m_sendBuffer;
 	std::deque<std::string> m_outgoingStrings;
+
+	NetConditioner			m_sendConditioner = NetConditioner(NetConditionerMode::STREAM);
+	std::vector<uint8_t>	m_conditionedSendBuffer; // released by the conditioner, not yet accepted by send()
+	NetConnectionStats		m_stats;
 };
 
+// Stays safe to hold after the client disconnects, lookups with it just fail
+typedef SlotHandle NetClientHandle;
+
 //-----------------------------------------------------------------------------------------------
 class NetworkSystem
 {
@@ -67,11 +85,25 @@ public:
 
 	// Server Broadcast or Client send to server
 	void QueueOutgoingString(const std::string& s);
-	// Single point to client (not used now)
-	void QueueOutgoingStringToClient(SocketHandle client, const std::string& s);
+	// Single point to client
+	bool QueueOutgoingStringToClient(NetClientHandle client, const std::string& s);
+
+	// Server: connected clients, in no particular order, the order changes when one leaves
+	int GetNumServerClients() const;
+	NetClientHandle GetServerClientHandle(int clientIndex) const;
+	bool IsServerClientConnected(NetClientHandle client) const;
+	void DisconnectServerClient(NetClientHandle client);
 
 	std::vector<std::string> RetrieveIncomingStrings();
 
+	void SetConditionerConfig(NetConditionerConfig const& config);
+	NetConditionerConfig const& GetConditionerConfig() const;
+	// Server: one entry per client, Client: the server connection
+	std::vector<NetConnectionStats> GetConnectionStats() const;
+
+	static bool Command_NetStats(EventArgs& args);
+	static bool Command_NetConditioner(EventArgs& args);
+
 	bool m_pendingDisconnected = false; // will try to send the last message and stop
 private:
 	NetworkConfig m_config;
@@ -81,7 +113,7 @@ private:
 	//-----------------------------------------------------------------------------------------------
 	// Server
 	SocketHandle m_listenSocket = INVALID_SOCKET_HANDLE;
-	std::vector<NetClientInfo*> m_serverClients;
+	SlotMap<NetClientInfo> m_serverClients;
 
 private:
 	//-----------------------------------------------------------------------------------------------
@@ -89,6 +121,9 @@ private:
 	SocketHandle m_connectionToServerSocket = INVALID_SOCKET_HANDLE;
 	std::vector<uint8_t> m_clientRecvBuffer;
 	std::vector<uint8_t> m_clientSendBuffer;
+	NetConditioner m_clientSendConditioner = NetConditioner(NetConditionerMode::STREAM);
+	std::vector<uint8_t> m_clientConditionedSendBuffer;
+	NetConnectionStats m_clientStats;
 
 private:
 	// Game Code will interact with these strings
@@ -97,9 +132,14 @@ private:
 
 	//void BufferOutgoingStrings(std::vector<uint8_t>& sendBuffer);
 
-	void ExtractIncomingStrings(std::vector<uint8_t>& recvBuffer);
-	void BufferOutgoingStrings(std::deque<std::string>& stringQueue, std::vector<uint8_t>& sendBuffer);
+	void ExtractIncomingStrings(std::vector<uint8_t>& recvBuffer, NetConnectionStats& stats);
+	void BufferOutgoingStrings(std::deque<std::string>& stringQueue, std::vector<uint8_t>& sendBuffer, NetConnectionStats& stats);
 	void BroadcastOutgoingStrings(const std::deque<std::string>& stringQueue);
+	// Returns false on a socket error, the caller closes the connection
+	bool SendBufferedBytes(SocketHandle sock, std::vector<uint8_t>& sendBuffer, NetConditioner& conditioner,
+		std::vector<uint8_t>& conditionedSendBuffer, NetConnectionStats& stats, double releaseTime);
+	void FillQueueStats(NetConnectionStats& stats, SocketHandle sock, std::deque<std::string> const& stringQueue,
+		std::vector<uint8_t> const& sendBuffer, NetConditioner const& conditioner, std::vector<uint8_t> const& conditionedSendBuffer) const;
 
 	static constexpr size_t RECV_BUFFER_SIZE = 2048;
 	static constexpr int MAX_RECV_PER_CLIENT_PER_FRAME = 10;
@@ -114,3 +154,27 @@ private:
 	void CloseSocket(SocketHandle& sock);
 };
 
+
+//-----------------------------------------------------------------------------------------------
+struct NetClientChurnBenchmarkResult
+{
+	bool	m_isComplete = false;				// false if the port was taken or a wave timed out
+	int		m_numWaves = 0;
+	int		m_clientsPerWave = 0;
+	int		m_numAccepted = 0;
+	int		m_numSlotsUsed = 0;					// highest slot index + 1, stays at clientsPerWave when slots are reused
+	int		m_numStaleHandlesConnected = 0;		// handles of gone clients that still resolved, must be 0
+	int		m_numServerFrames = 0;
+	double	m_averageServerFrameMs = 0.0;
+	double	m_maxServerFrameMs = 0.0;
+	size_t	m_startResidentBytes = 0;			// 0 where the platform cannot tell
+	size_t	m_peakResidentBytes = 0;
+	size_t	m_endResidentBytes = 0;
+
+	std::string ToString() const;
+};
+
+// Connects clientsPerWave loopback clients to a server on port, then drops them all, numWaves
+// times. Even waves are kicked by the server, odd waves leave on their own. Times the server's
+// BeginFrame + EndFrame and samples the resident set after every wave
+NetClientChurnBenchmarkResult RunNetClientChurnBenchmark(unsigned short port, int numWaves, int clientsPerWave);
@@ -0,0 +1,616 @@
+#include "Engine/Network/UdpNetworkSystem.hpp"
+#include "Engine/Network/NetBuffer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Network/NetPlatform.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+constexpr int DISCONNECT_PACKET_REPEAT_COUNT = 3; // nobody acks a disconnect, send a few
+
+static UdpNetworkSystem* s_udpNetworkSystem = nullptr; // for the DevConsole commands
+
+//-----------------------------------------------------------------------------------------------
+UdpNetworkSystem::UdpNetworkSystem(UdpNetworkConfig const& config)
+	: m_config(config)
+{
+	m_conditioner.SetConfig(m_config.m_conditioner);
+}
+
+void UdpNetworkSystem::Startup()
+{
+	WSADATA wsaData;
+	int errorCode = WSAStartup(MAKEWORD(2, 2), &wsaData); // ref counted, fine next to NetworkSystem
+	if (errorCode != 0)
+	{
+		ERROR_AND_DIE(Stringf("WSAStartup failed: %s", WsaErrorCodeToString(errorCode).c_str()));
+	}
+
+	m_packetScratch.reserve(NET_MAX_PACKET_SIZE);
+	m_state = NetState::IDLE;
+
+	s_udpNetworkSystem = this;
+	if (g_theEventSystem)
+	{
+		g_theEventSystem->SubscribeEventCallbackFunction("NetStats", UdpNetworkSystem::Command_NetStats);
+		g_theEventSystem->SubscribeEventCallbackFunction("NetConditioner", UdpNetworkSystem::Command_NetConditioner);
+	}
+}
+
+void UdpNetworkSystem::Shutdown()
+{
+	if (g_theEventSystem)
+	{
+		g_theEventSystem->UnsubscribeEventCallbackFunction("NetStats", UdpNetworkSystem::Command_NetStats);
+		g_theEventSystem->UnsubscribeEventCallbackFunction("NetConditioner", UdpNetworkSystem::Command_NetConditioner);
+	}
+	if (s_udpNetworkSystem == this)
+	{
+		s_udpNetworkSystem = nullptr;
+	}
+
+	StopServer();
+	StopClient();
+	if (m_state != NetState::INACTIVE)
+	{
+		int ret = WSACleanup();
+		if (ret == SOCKET_ERROR)
+		{
+			int errorCode = WSAGetLastError();
+			ERROR_RECOVERABLE(Stringf("WSACleanup failed: %s", WsaErrorCodeToString(errorCode).c_str()));
+		}
+		m_state = NetState::INACTIVE;
+	}
+}
+
+void UdpNetworkSystem::BeginFrame()
+{
+	if (m_state != NetState::SERVER_LISTENING && m_state != NetState::CLIENT_CONNECTING && m_state != NetState::CLIENT_CONNECTED)
+	{
+		return;
+	}
+
+	double currentTime = GetCurrentTimeSeconds();
+	FlushConditioner(currentTime);
+	ReceivePackets(currentTime);
+	UpdateConnections(currentTime);
+}
+
+void UdpNetworkSystem::EndFrame()
+{
+	if (m_state != NetState::SERVER_LISTENING && m_state != NetState::CLIENT_CONNECTING && m_state != NetState::CLIENT_CONNECTED)
+	{
+		return;
+	}
+
+	double currentTime = GetCurrentTimeSeconds();
+	SendPackets(currentTime);
+	FlushConditioner(currentTime);
+}
+
+bool UdpNetworkSystem::StartServer(unsigned short listenPort)
+{
+	if (m_state != NetState::IDLE)
+	{
+		DebuggerPrintf("UDP Server: Could not start server, network system is not idle.\n");
+		return false;
+	}
+	if (!OpenSocket(listenPort))
+	{
+		return false;
+	}
+
+	m_connections.clear();
+	m_connections.resize(m_config.m_maxConnections);
+	m_incomingMessages.clear();
+	m_conditioner.Clear();
+	m_state = NetState::SERVER_LISTENING;
+	DebuggerPrintf("UDP Server: start listening on port %d\n", listenPort);
+	return true;
+}
+
+void UdpNetworkSystem::StopServer()
+{
+	if (m_state != NetState::SERVER_LISTENING)
+	{
+		return;
+	}
+	DisconnectAll(GetCurrentTimeSeconds());
+	CloseSocket();
+	m_connections.clear();
+	m_conditioner.Clear();
+	m_state = NetState::IDLE;
+}
+
+bool UdpNetworkSystem::StartClient(std::string const& serverIP, unsigned short serverPort)
+{
+	if (m_state != NetState::IDLE)
+	{
+		DebuggerPrintf("UDP Client: Could not start client, network system is not idle.\n");
+		return false;
+	}
+
+	NetAddress serverAddress;
+	if (!NetAddress::FromString(serverAddress, serverIP, serverPort))
+	{
+		DebuggerPrintf("UDP Client: invalid server IP: %s\n", serverIP.c_str());
+		return false;
+	}
+	if (!OpenSocket(0)) // any local port
+	{
+		return false;
+	}
+
+	double currentTime = GetCurrentTimeSeconds();
+	m_connections.clear();
+	m_connections.resize(1);
+	m_connections[0].SetAddress(serverAddress);
+	m_connections[0].SetState(NetConnectionState::CONNECTING, currentTime);
+	m_lastConnectRequestTime = -1.0;
+	m_incomingMessages.clear();
+	m_conditioner.Clear();
+	m_state = NetState::CLIENT_CONNECTING;
+	DebuggerPrintf("UDP Client: connecting to %s\n", serverAddress.ToString().c_str());
+	return true;
+}
+
+void UdpNetworkSystem::StopClient()
+{
+	if (m_state != NetState::CLIENT_CONNECTING && m_state != NetState::CLIENT_CONNECTED)
+	{
+		return;
+	}
+	DisconnectAll(GetCurrentTimeSeconds());
+	CloseSocket();
+	m_connections.clear();
+	m_conditioner.Clear();
+	m_state = NetState::IDLE;
+}
+
+NetState UdpNetworkSystem::GetState() const
+{
+	return m_state;
+}
+
+int UdpNetworkSystem::GetMaxConnections() const
+{
+	return static_cast<int>(m_connections.size());
+}
+
+bool UdpNetworkSystem::IsConnected(int connectionIndex) const
+{
+	NetConnection const* connection = GetConnection(connectionIndex);
+	return connection != nullptr && connection->GetState() == NetConnectionState::CONNECTED;
+}
+
+NetConnection const* UdpNetworkSystem::GetConnection(int connectionIndex) const
+{
+	if (connectionIndex < 0 || connectionIndex >= static_cast<int>(m_connections.size()))
+	{
+		return nullptr;
+	}
+	return &m_connections[connectionIndex];
+}
+
+bool UdpNetworkSystem::QueueOutgoingMessage(int connectionIndex, NetChannel channel, void const* data, size_t numBytes)
+{
+	if (m_state == NetState::CLIENT_CONNECTING || m_state == NetState::CLIENT_CONNECTED)
+	{
+		connectionIndex = 0; // queued while connecting goes out once accepted
+	}
+	if (connectionIndex < 0 || connectionIndex >= static_cast<int>(m_connections.size()))
+	{
+		return false;
+	}
+	NetConnection& connection = m_connections[connectionIndex];
+	if (connection.GetState() == NetConnectionState::DISCONNECTED)
+	{
+		return false;
+	}
+	return connection.QueueMessage(channel, data, numBytes);
+}
+
+bool UdpNetworkSystem::QueueOutgoingMessage(int connectionIndex, NetChannel channel, std::string const& s)
+{
+	return QueueOutgoingMessage(connectionIndex, channel, s.data(), s.size());
+}
+
+void UdpNetworkSystem::BroadcastOutgoingMessage(NetChannel channel, void const* data, size_t numBytes)
+{
+	for (NetConnection& connection : m_connections)
+	{
+		if (connection.GetState() != NetConnectionState::DISCONNECTED)
+		{
+			connection.QueueMessage(channel, data, numBytes);
+		}
+	}
+}
+
+std::vector<NetIncomingMessage> UdpNetworkSystem::RetrieveIncomingMessages()
+{
+	std::vector<NetIncomingMessage> result;
+	result.swap(m_incomingMessages);
+	return result;
+}
+
+void UdpNetworkSystem::SetConditionerConfig(NetConditionerConfig const& config)
+{
+	m_config.m_conditioner = config;
+	m_conditioner.SetConfig(config);
+}
+
+NetConditioner& UdpNetworkSystem::GetConditioner()
+{
+	return m_conditioner;
+}
+
+//-----------------------------------------------------------------------------------------------
+static void PrintNetLine(Rgba8 const& color, std::string const& text)
+{
+	if (g_theDevConsole)
+	{
+		g_theDevConsole->AddText(color, text);
+	}
+	else
+	{
+		DebuggerPrintf("%s\n", text.c_str());
+	}
+}
+
+// Both commands return false so NetworkSystem gets them too
+bool UdpNetworkSystem::Command_NetStats(EventArgs& args)
+{
+	UNUSED(args);
+	UdpNetworkSystem* system = s_udpNetworkSystem;
+	if (system == nullptr || system->m_state == NetState::INACTIVE || system->m_state == NetState::IDLE)
+	{
+		return false;
+	}
+
+	PrintNetLine(DevConsole::INFO_MAJOR, Stringf("UDP %s, conditioner: %s",
+		(system->m_state == NetState::SERVER_LISTENING) ? "server" : "client",
+		system->m_conditioner.GetConfig().ToString().c_str()));
+	if (system->m_conditioner.IsEnabled())
+	{
+		PrintNetLine(DevConsole::INFO_MINOR, Stringf("  conditioner queue %d pkts %llu B, dropped %llu",
+			system->m_conditioner.GetNumPendingPackets(),
+			(unsigned long long)system->m_conditioner.GetNumPendingBytes(),
+			(unsigned long long)system->m_conditioner.GetNumDroppedPackets()));
+	}
+	for (int connectionIndex = 0; connectionIndex < static_cast<int>(system->m_connections.size()); ++connectionIndex)
+	{
+		NetConnection const& connection = system->m_connections[connectionIndex];
+		if (connection.GetState() == NetConnectionState::DISCONNECTED)
+		{
+			continue;
+		}
+		PrintNetLine(DevConsole::INFO_MINOR, Stringf("  #%d %s: %s", connectionIndex,
+			connection.GetAddress().ToString().c_str(), connection.GetStats().ToString().c_str()));
+	}
+	return false;
+}
+
+bool UdpNetworkSystem::Command_NetConditioner(EventArgs& args)
+{
+	UdpNetworkSystem* system = s_udpNetworkSystem;
+	if (system == nullptr)
+	{
+		return false;
+	}
+	NetConditionerConfig config = system->m_config.m_conditioner;
+	config.SetFromArgs(args);
+	system->SetConditionerConfig(config);
+	PrintNetLine(DevConsole::INFO_MAJOR, "UDP conditioner: " + config.ToString());
+	return false;
+}
+
+bool UdpNetworkSystem::OpenSocket(unsigned short port)
+{
+	SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock == INVALID_SOCKET)
+	{
+		int errorCode = WSAGetLastError();
+		DebuggerPrintf("UDP: Could not create a socket: %s\n", WsaErrorCodeToString(errorCode).c_str());
+		return false;
+	}
+
+	unsigned long mode = 1; // non-blocking
+	int ret = ioctlsocket(sock, FIONBIO, &mode);
+	if (ret == SOCKET_ERROR)
+	{
+		int errorCode = WSAGetLastError();
+		DebuggerPrintf("UDP: Could not set the socket to non-blocking: %s\n", WsaErrorCodeToString(errorCode).c_str());
+		closesocket(sock);
+		return false;
+	}
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	ret = bind(sock, (sockaddr*)&addr, (int)sizeof(addr));
+	if (ret == SOCKET_ERROR)
+	{
+		int errorCode = WSAGetLastError();
+		DebuggerPrintf("UDP: Could not bind the socket to port %d: %s\n", port, WsaErrorCodeToString(errorCode).c_str());
+		closesocket(sock);
+		return false;
+	}
+
+	m_socket = (SocketHandle)sock;
+	return true;
+}
+
+void UdpNetworkSystem::CloseSocket()
+{
+	if (m_socket != INVALID_SOCKET_HANDLE)
+	{
+		closesocket((SOCKET)m_socket);
+		m_socket = INVALID_SOCKET_HANDLE;
+	}
+}
+
+void UdpNetworkSystem::ReceivePackets(double currentTime)
+{
+	uint8_t buffer[NET_MAX_PACKET_SIZE];
+	while (m_socket != INVALID_SOCKET_HANDLE)
+	{
+		sockaddr_in fromAddr = {};
+		socklen_t fromLength = (socklen_t)sizeof(fromAddr);
+		int received = (int)recvfrom((SOCKET)m_socket, (char*)buffer, (int)sizeof(buffer), 0, (sockaddr*)&fromAddr, &fromLength);
+		if (received == SOCKET_ERROR)
+		{
+			int errorCode = WSAGetLastError();
+			if (errorCode == WSAEWOULDBLOCK) break; // nothing new to recv
+			if (errorCode == WSAECONNRESET || errorCode == WSAEMSGSIZE) continue; // ICMP port unreachable from an earlier send, or oversized datagram
+			DebuggerPrintf("UDP: recvfrom() error: %s\n", WsaErrorCodeToString(errorCode).c_str());
+			break;
+		}
+
+		NetAddress from;
+		from.m_ipv4 = ntohl(fromAddr.sin_addr.s_addr);
+		from.m_port = ntohs(fromAddr.sin_port);
+		ProcessPacket(from, buffer, static_cast<size_t>(received), currentTime);
+	}
+}
+
+void UdpNetworkSystem::ProcessPacket(NetAddress const& from, uint8_t const* data, size_t numBytes, double currentTime)
+{
+	NetBufferReader reader(data, numBytes);
+	uint32_t protocolId = reader.ReadUInt32();
+	uint8_t packetType = reader.ReadUInt8();
+	if (!reader.IsValid() || protocolId != m_config.m_protocolId || packetType >= static_cast<uint8_t>(NetPacketType::COUNT))
+	{
+		return; // not ours
+	}
+
+	int connectionIndex = FindConnection(from);
+	NetPacketType type = static_cast<NetPacketType>(packetType);
+
+	if (m_state == NetState::SERVER_LISTENING)
+	{
+		if (type == NetPacketType::CONNECT_REQUEST)
+		{
+			if (connectionIndex < 0)
+			{
+				connectionIndex = FindFreeConnection();
+				if (connectionIndex < 0)
+				{
+					SendControlPacket(from, NetPacketType::CONNECT_DENIED, currentTime);
+					return;
+				}
+				NetConnection& connection = m_connections[connectionIndex];
+				connection.Reset();
+				connection.SetAddress(from);
+				connection.SetState(NetConnectionState::CONNECTED, currentTime);
+				DebuggerPrintf("UDP Server: client %d connected from %s\n", connectionIndex, from.ToString().c_str());
+			}
+			// Also re-sent for duplicate requests, the first accept may have been lost
+			SendControlPacket(from, NetPacketType::CONNECT_ACCEPT, currentTime);
+			return;
+		}
+	}
+	else if (connectionIndex >= 0 && m_connections[connectionIndex].GetState() == NetConnectionState::CONNECTING)
+	{
+		if (type == NetPacketType::CONNECT_ACCEPT)
+		{
+			m_connections[connectionIndex].SetState(NetConnectionState::CONNECTED, currentTime);
+			m_state = NetState::CLIENT_CONNECTED;
+			DebuggerPrintf("UDP Client: connected to %s\n", from.ToString().c_str());
+			return;
+		}
+		if (type == NetPacketType::CONNECT_DENIED)
+		{
+			DebuggerPrintf("UDP Client: connection denied by %s\n", from.ToString().c_str());
+			m_connections[connectionIndex].Reset();
+			StopClient();
+			return;
+		}
+	}
+
+	if (connectionIndex < 0)
+	{
+		return;
+	}
+	NetConnection& connection = m_connections[connectionIndex];
+	if (connection.GetState() != NetConnectionState::CONNECTED)
+	{
+		return;
+	}
+
+	if (type == NetPacketType::DISCONNECT)
+	{
+		DebuggerPrintf("UDP: %s disconnected\n", from.ToString().c_str());
+		connection.Reset();
+		if (m_state == NetState::CLIENT_CONNECTED)
+		{
+			StopClient();
+		}
+		return;
+	}
+
+	if (type == NetPacketType::PAYLOAD)
+	{
+		if (!connection.ReadPayloadPacket(reader, currentTime))
+		{
+			DebuggerPrintf("UDP: dropped malformed packet from %s\n", from.ToString().c_str());
+			return;
+		}
+
+		m_messageScratch.clear();
+		connection.RetrieveIncomingMessages(m_messageScratch);
+		for (NetMessage& message : m_messageScratch)
+		{
+			NetIncomingMessage& incoming = m_incomingMessages.emplace_back();
+			incoming.m_connectionIndex = connectionIndex;
+			incoming.m_channel = message.m_channel;
+			incoming.m_data = std::move(message.m_data);
+		}
+	}
+}
+
+void UdpNetworkSystem::UpdateConnections(double currentTime)
+{
+	for (int connectionIndex = 0; connectionIndex < static_cast<int>(m_connections.size()); ++connectionIndex)
+	{
+		NetConnection& connection = m_connections[connectionIndex];
+		if (connection.GetState() == NetConnectionState::DISCONNECTED)
+		{
+			continue;
+		}
+
+		if (currentTime - connection.GetLastReceiveTime() > m_config.m_connectionTimeoutSeconds)
+		{
+			DebuggerPrintf("UDP: connection %d to %s timed out\n", connectionIndex, connection.GetAddress().ToString().c_str());
+			connection.Reset();
+			if (m_state == NetState::CLIENT_CONNECTING || m_state == NetState::CLIENT_CONNECTED)
+			{
+				StopClient();
+				return;
+			}
+			continue;
+		}
+
+		if (connection.GetState() == NetConnectionState::CONNECTING &&
+			(m_lastConnectRequestTime < 0.0 || currentTime - m_lastConnectRequestTime >= m_config.m_connectRetrySeconds))
+		{
+			SendControlPacket(connection.GetAddress(), NetPacketType::CONNECT_REQUEST, currentTime);
+			m_lastConnectRequestTime = currentTime;
+		}
+	}
+}
+
+void UdpNetworkSystem::SendPackets(double currentTime)
+{
+	for (NetConnection& connection : m_connections)
+	{
+		if (connection.GetState() != NetConnectionState::CONNECTED)
+		{
+			continue;
+		}
+		for (int packetIndex = 0; packetIndex < m_config.m_maxPacketsPerConnectionPerFrame; ++packetIndex)
+		{
+			if (!connection.WritePayloadPacket(m_packetScratch, m_config.m_protocolId, currentTime, m_config.m_keepAliveSeconds))
+			{
+				break;
+			}
+			SendRawPacket(connection.GetAddress(), m_packetScratch.data(), m_packetScratch.size(), currentTime);
+		}
+	}
+}
+
+void UdpNetworkSystem::SendControlPacket(NetAddress const& to, NetPacketType type, double currentTime)
+{
+	m_packetScratch.clear();
+	NetBufferWriter writer(m_packetScratch);
+	WriteNetPacketHeader(writer, m_config.m_protocolId, type);
+	SendRawPacket(to, m_packetScratch.data(), m_packetScratch.size(), currentTime);
+}
+
+void UdpNetworkSystem::SendRawPacket(NetAddress const& to, uint8_t const* data, size_t numBytes, double currentTime)
+{
+	if (m_conditioner.IsEnabled())
+	{
+		m_conditioner.Enqueue(to, data, numBytes, currentTime);
+		return;
+	}
+	SendToSocket(to, data, numBytes);
+}
+
+void UdpNetworkSystem::SendToSocket(NetAddress const& to, uint8_t const* data, size_t numBytes)
+{
+	if (m_socket == INVALID_SOCKET_HANDLE)
+	{
+		return;
+	}
+
+	sockaddr_in toAddr = {};
+	toAddr.sin_family = AF_INET;
+	toAddr.sin_addr.s_addr = htonl(to.m_ipv4);
+	toAddr.sin_port = htons(to.m_port);
+	int sent = (int)sendto((SOCKET)m_socket, (char const*)data, (int)numBytes, NET_SEND_FLAGS, (sockaddr*)&toAddr, (int)sizeof(toAddr));
+	if (sent == SOCKET_ERROR)
+	{
+		int errorCode = WSAGetLastError();
+		if (errorCode != WSAEWOULDBLOCK) // a full send buffer is just packet loss for UDP
+		{
+			DebuggerPrintf("UDP: sendto() %s error: %s\n", to.ToString().c_str(), WsaErrorCodeToString(errorCode).c_str());
+		}
+	}
+}
+
+void UdpNetworkSystem::FlushConditioner(double currentTime)
+{
+	NetConditionedPacket packet;
+	while (m_conditioner.PopReadyPacket(packet, currentTime))
+	{
+		SendToSocket(packet.m_address, packet.m_data.data(), packet.m_data.size());
+	}
+}
+
+void UdpNetworkSystem::DisconnectAll(double currentTime)
+{
+	UNUSED(currentTime);
+	m_packetScratch.clear();
+	NetBufferWriter writer(m_packetScratch);
+	WriteNetPacketHeader(writer, m_config.m_protocolId, NetPacketType::DISCONNECT);
+
+	for (NetConnection& connection : m_connections)
+	{
+		if (connection.GetState() == NetConnectionState::CONNECTED)
+		{
+			// bypass the conditioner, the socket is about to close
+			for (int repeat = 0; repeat < DISCONNECT_PACKET_REPEAT_COUNT; ++repeat)
+			{
+				SendToSocket(connection.GetAddress(), m_packetScratch.data(), m_packetScratch.size());
+			}
+		}
+		connection.Reset();
+	}
+}
+
+int UdpNetworkSystem::FindConnection(NetAddress const& address) const
+{
+	for (int connectionIndex = 0; connectionIndex < static_cast<int>(m_connections.size()); ++connectionIndex)
+	{
+		NetConnection const& connection = m_connections[connectionIndex];
+		if (connection.GetState() != NetConnectionState::DISCONNECTED && connection.GetAddress() == address)
+		{
+			return connectionIndex;
+		}
+	}
+	return -1;
+}
+
+int UdpNetworkSystem::FindFreeConnection() const
+{
+	for (int connectionIndex = 0; connectionIndex < static_cast<int>(m_connections.size()); ++connectionIndex)
+	{
+		if (m_connections[connectionIndex].GetState() == NetConnectionState::DISCONNECTED)
+		{
+			return connectionIndex;
+		}
+	}
+	return -1;
+}
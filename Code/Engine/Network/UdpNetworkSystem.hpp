@@ -0,0 +1,122 @@
+#pragma once
+#include "Engine/Network/NetworkSystem.hpp"
+#include "Engine/Network/NetCommon.hpp"
+#include "Engine/Network/NetConnection.hpp"
+#include "Engine/Network/NetConditioner.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+/*
+UDP transport, runs next to the TCP NetworkSystem and is meant for game traffic that must not be
+head-of-line blocked by a single lost packet.
+
+One non-blocking UDP socket. The server keeps one NetConnection per client address, the client
+keeps a single NetConnection (index 0) to the server.
+
+Handshake: client sends CONNECT_REQUEST every m_connectRetrySeconds until it gets CONNECT_ACCEPT
+(or CONNECT_DENIED when the server is full). Either side drops the connection after
+m_connectionTimeoutSeconds without a packet; connected peers send keep-alives when idle.
+
+Frame flow: BeginFrame receives and processes packets, game code reads messages and queues new
+ones, EndFrame coalesces queued messages into MTU sized packets and sends them.
+
+DevConsole: "NetStats" prints per-connection counters, "NetConditioner latency=100 jitter=20
+loss=0.05 reorder=0.1 bandwidth=64000" (ms, chances, bytes/s) simulates a bad network on the
+sending side. Both commands are shared with NetworkSystem and reach every running system.
+*/
+
+//-----------------------------------------------------------------------------------------------
+struct UdpNetworkConfig
+{
+	uint32_t	m_protocolId = NET_DEFAULT_PROTOCOL_ID;
+	int			m_maxConnections = 16;
+	double		m_connectionTimeoutSeconds = 5.0;
+	double		m_connectRetrySeconds = 0.25;
+	double		m_keepAliveSeconds = 0.1;
+	int			m_maxPacketsPerConnectionPerFrame = 16;
+	NetConditionerConfig m_conditioner;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct NetIncomingMessage
+{
+	int						m_connectionIndex = -1;
+	NetChannel				m_channel = NetChannel::RELIABLE_ORDERED;
+	std::vector<uint8_t>	m_data;
+};
+
+//-----------------------------------------------------------------------------------------------
+class UdpNetworkSystem
+{
+public:
+	UdpNetworkSystem(UdpNetworkConfig const& config);
+	~UdpNetworkSystem() = default;
+	UdpNetworkSystem(const UdpNetworkSystem&) = delete;
+	UdpNetworkSystem& operator=(const UdpNetworkSystem&) = delete;
+
+	void Startup();
+	void Shutdown();
+
+	void BeginFrame();
+	void EndFrame();
+
+	bool StartServer(unsigned short listenPort);
+	void StopServer();
+
+	bool StartClient(std::string const& serverIP, unsigned short serverPort);
+	void StopClient();
+
+public:
+	NetState GetState() const;
+	int GetMaxConnections() const;
+	bool IsConnected(int connectionIndex) const;
+	NetConnection const* GetConnection(int connectionIndex) const;
+
+	// Client: connectionIndex is ignored, always sends to the server
+	bool QueueOutgoingMessage(int connectionIndex, NetChannel channel, void const* data, size_t numBytes);
+	bool QueueOutgoingMessage(int connectionIndex, NetChannel channel, std::string const& s);
+	// Server: every connected client, Client: the server
+	void BroadcastOutgoingMessage(NetChannel channel, void const* data, size_t numBytes);
+
+	std::vector<NetIncomingMessage> RetrieveIncomingMessages();
+
+	void SetConditionerConfig(NetConditionerConfig const& config);
+	NetConditioner& GetConditioner();
+
+	static bool Command_NetStats(EventArgs& args);
+	static bool Command_NetConditioner(EventArgs& args);
+
+private:
+	bool OpenSocket(unsigned short port);
+	void CloseSocket();
+
+	void ReceivePackets(double currentTime);
+	void ProcessPacket(NetAddress const& from, uint8_t const* data, size_t numBytes, double currentTime);
+	void UpdateConnections(double currentTime);
+	void SendPackets(double currentTime);
+	void SendControlPacket(NetAddress const& to, NetPacketType type, double currentTime);
+	void SendRawPacket(NetAddress const& to, uint8_t const* data, size_t numBytes, double currentTime);
+	void SendToSocket(NetAddress const& to, uint8_t const* data, size_t numBytes);
+	void FlushConditioner(double currentTime);
+	void DisconnectAll(double currentTime);
+
+	int FindConnection(NetAddress const& address) const;
+	int FindFreeConnection() const;
+
+private:
+	UdpNetworkConfig m_config;
+	NetState m_state = NetState::INACTIVE;
+	SocketHandle m_socket = INVALID_SOCKET_HANDLE;
+
+	std::vector<NetConnection> m_connections;
+	double m_lastConnectRequestTime = -1.0;
+
+	NetConditioner m_conditioner;
+	std::vector<NetIncomingMessage> m_incomingMessages;
+
+	std::vector<uint8_t> m_packetScratch;
+	std::vector<NetMessage> m_messageScratch;
+};
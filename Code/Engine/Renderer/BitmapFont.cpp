@@ -1,5 +1,6 @@
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Math/MathUtils.hpp"
@@ -15,15 +16,23 @@ BitmapFont::BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& fon
 {
 }
 
+BitmapFont::BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& atlasTexture, SDFFontAtlas const& atlas)
+	: m_fontFilePathNameWithNoExtension(fontFilePathNameWithNoExtension)
+	, m_fontGlyphsSpriteSheet(atlasTexture, atlas.m_glyphGridLayout)
+	, m_sdfGlyphs(atlas.m_glyphs)
+{
+}
+
 Texture& BitmapFont::GetTexture()
 {
 	return m_fontGlyphsSpriteSheet.GetTexture();
 }
 
-void BitmapFont::AddVertsForText2D(std::vector<Vertex_PCU>& verts, Vec2 const& textMins, float cellHeight, std::string const& text, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, float cellAspectScale /*= 1.f*/)
+void BitmapFont::AddVertsForText2D(std::vector<Vertex_PCU>& verts, Vec2 const& textMins, float cellHeight, std::string_view text, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, float cellAspectScale /*= 1.f*/) const
 {
 	// TODO if the length of character is not 1-byte, we create new method?
 	float currentOffsetX = 0.f;
+	float const cellScaleX = cellHeight * cellAspectScale;
 
 	for (size_t i = 0; i < text.length(); ++i)
 	{
@@ -31,99 +40,205 @@ void BitmapFont::AddVertsForText2D(std::vector<Vertex_PCU>& verts, Vec2 const& t
 		float glyphAspect = GetGlyphAspect(glyphUnicode);
 		float cellWidth = cellHeight * glyphAspect * cellAspectScale;
 
-		Vec2 offset(currentOffsetX, 0.f);
-		AABB2 bounds = AABB2(textMins + offset, textMins + Vec2(cellWidth, cellHeight) + offset);
-		AABB2 UVs = m_fontGlyphsSpriteSheet.GetSpriteUVs(glyphUnicode);
+		AABB2 quadBounds;
+		AABB2 UVs;
+		GetGlyphQuad(glyphUnicode, quadBounds, UVs);
+		Vec2 penPos(textMins.x + currentOffsetX, textMins.y);
+		AABB2 bounds = AABB2(penPos + Vec2(quadBounds.m_mins.x * cellScaleX, quadBounds.m_mins.y * cellHeight), penPos + Vec2(quadBounds.m_maxs.x * cellScaleX, quadBounds.m_maxs.y * cellHeight));
 		AddVertsForAABB2D(verts, bounds, tint, UVs);
 
 		currentOffsetX += cellWidth;
 	}
 }
 
-// if alignment is outside of ZERO_TO_ONE
-void BitmapFont::AddVertsForTextInBox2D(std::vector<Vertex_PCU>& verts, std::string const& text, AABB2 const& box, float cellHeight, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, float cellAspectScale /*= 1.f*/, Vec2 const& alignment /*= Vec2(0.5f, 0.5f)*/, TextBoxMode mode /*= TextBoxMode::SHRINK_TO_FIT*/, int maxGlyphsToDraw /*= 99999999*/)
+//-----------------------------------------------------------------------------------------------
+// FNV-1a over the text bytes and every layout parameter, position and tint are not part of the key
+static uint64_t HashTextLayoutKey(std::string_view text, Vec2 const& boxDimensions, float cellHeight, float cellAspectScale, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw)
 {
-	Strings textLines = SplitStringOnDelimiter(text, '\n');
+	uint64_t constexpr FNV_OFFSET_BASIS = 14695981039346656037ull;
+	uint64_t constexpr FNV_PRIME = 1099511628211ull;
 
-	float adjustedCellHeight = cellHeight;
-	
-	if (mode == TextBoxMode::SHRINK_TO_FIT)
-	{
-		float paragraphHeight = static_cast<float>(textLines.size()) * cellHeight;
-		float paragraphWidth = 0.f;
-		for (size_t lineIndex = 0; lineIndex < textLines.size(); ++lineIndex)
+	uint64_t hash = FNV_OFFSET_BASIS;
+	auto hashBytes = [&hash](void const* data, size_t numBytes)
 		{
-			float lineWidth = GetTextWidth(cellHeight, textLines[lineIndex], cellAspectScale);
-			if (lineWidth > paragraphWidth)
+			unsigned char const* bytes = static_cast<unsigned char const*>(data);
+			for (size_t byteIndex = 0; byteIndex < numBytes; ++byteIndex)
 			{
-				paragraphWidth = lineWidth;
+				hash ^= bytes[byteIndex];
+				hash *= FNV_PRIME;
 			}
-		}
-		if (paragraphWidth > box.GetDimensions().x || paragraphHeight > box.GetDimensions().y)
-		{
-			float widthRatio = box.GetDimensions().x / paragraphWidth;
-			float HeightRatio = box.GetDimensions().y / paragraphHeight;
-			float minRatio = (widthRatio < HeightRatio) ? widthRatio : HeightRatio;
-			adjustedCellHeight *= minRatio;
-		}
-	}
+		};
+
+	hashBytes(text.data(), text.size());
+	float const params[] = { boxDimensions.x, boxDimensions.y, cellHeight, cellAspectScale, alignment.x, alignment.y };
+	hashBytes(params, sizeof(params));
+	int const modeAndGlyphs[] = { static_cast<int>(mode), maxGlyphsToDraw };
+	hashBytes(modeAndGlyphs, sizeof(modeAndGlyphs));
+	return hash;
+}
 
-	std::vector<AABB2> lineBoxs;
-	lineBoxs.reserve(textLines.size());
-	for (size_t lineIndex = 0; lineIndex < textLines.size(); ++lineIndex)
+// if alignment is outside of ZERO_TO_ONE
+void BitmapFont::AddVertsForTextInBox2D(std::vector<Vertex_PCU>& verts, std::string_view text, AABB2 const& box, float cellHeight, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, float cellAspectScale /*= 1.f*/, Vec2 const& alignment /*= Vec2(0.5f, 0.5f)*/, TextBoxMode mode /*= TextBoxMode::SHRINK_TO_FIT*/, int maxGlyphsToDraw /*= 99999999*/)
+{
+	if (m_layoutCacheCapacity <= 0)
 	{
-		float lineWidth = GetTextWidth(adjustedCellHeight, textLines[lineIndex], cellAspectScale);
-		lineBoxs.push_back(AABB2(Vec2::ZERO, Vec2(lineWidth, adjustedCellHeight)));
+		AddVertsForTextInBox2DUncached(verts, text, box, cellHeight, tint, cellAspectScale, alignment, mode, maxGlyphsToDraw);
+		return;
 	}
 
-	// the pivot of All Boxes are the same
-	float const boxPivotX = Interpolate(box.m_mins.x, box.m_maxs.x, alignment.x);
-	float const boxPivotY = Interpolate(box.m_mins.y, box.m_maxs.y, alignment.y);
+	// The layout only depends on the box size, it is cached relative to the box mins
+	Vec2 boxDimensions = box.GetDimensions();
+	uint64_t hash = HashTextLayoutKey(text, boxDimensions, cellHeight, cellAspectScale, alignment, mode, maxGlyphsToDraw);
+
+	int entryIndex = -1;
+	bool isCacheHit = false;
+	auto found = m_layoutCacheLookup.find(hash);
+	if (found != m_layoutCacheLookup.end())
+	{
+		// The hash only finds the entry, the key itself decides
+		entryIndex = found->second;
+		TextLayoutCacheEntry const& entry = m_layoutCache[entryIndex];
+		isCacheHit = entry.m_text == text && entry.m_boxDimensions == boxDimensions && entry.m_cellHeight == cellHeight && entry.m_cellAspectScale == cellAspectScale
+			&& entry.m_alignment == alignment && entry.m_mode == mode && entry.m_maxGlyphsToDraw == maxGlyphsToDraw;
+		UnlinkLayoutCacheEntry(entryIndex);
+	}
+	else if (static_cast<int>(m_layoutCache.size()) < m_layoutCacheCapacity)
+	{
+		entryIndex = static_cast<int>(m_layoutCache.size());
+		m_layoutCache.emplace_back();
+	}
+	else
+	{
+		// Reuse the least recently used entry, its text and verts keep their capacity
+		entryIndex = m_oldestLayoutEntry;
+		m_layoutCacheLookup.erase(m_layoutCache[entryIndex].m_hash);
+		UnlinkLayoutCacheEntry(entryIndex);
+	}
 
-	float paragraphHeight = static_cast<float>(textLines.size()) * adjustedCellHeight;
+	if (isCacheHit)
+	{
+		++m_numLayoutCacheHits;
+	}
+	else
+	{
+		++m_numLayoutCacheMisses;
+
+		TextLayoutCacheEntry& entry = m_layoutCache[entryIndex];
+		entry.m_hash = hash;
+		entry.m_text.assign(text.data(), text.size());
+		entry.m_boxDimensions = boxDimensions;
+		entry.m_cellHeight = cellHeight;
+		entry.m_cellAspectScale = cellAspectScale;
+		entry.m_alignment = alignment;
+		entry.m_mode = mode;
+		entry.m_maxGlyphsToDraw = maxGlyphsToDraw;
+		entry.m_verts.clear();
+		AddVertsForTextInBox2DUncached(entry.m_verts, text, AABB2(Vec2::ZERO, boxDimensions), cellHeight, Rgba8::OPAQUE_WHITE, cellAspectScale, alignment, mode, maxGlyphsToDraw);
+		m_layoutCacheLookup[hash] = entryIndex;
+	}
+	LinkLayoutCacheEntryAsNewest(entryIndex);
 
-	for (size_t boxIndex = 0; boxIndex < lineBoxs.size(); ++boxIndex)
+	std::vector<Vertex_PCU> const& layoutVerts = m_layoutCache[entryIndex].m_verts;
+	size_t firstVert = verts.size();
+	verts.resize(firstVert + layoutVerts.size());
+	Vec3 translation(box.m_mins.x, box.m_mins.y, 0.f);
+	for (size_t vertIndex = 0; vertIndex < layoutVerts.size(); ++vertIndex)
 	{
-		AABB2& lineBox = lineBoxs[boxIndex];
-		Vec2 translation;
-		float lineBoxPivotX = Interpolate(lineBox.m_mins.x, lineBox.m_maxs.x, alignment.x);
-		translation.x = boxPivotX - lineBoxPivotX;
-		
-		translation.y = boxPivotY - adjustedCellHeight * static_cast<float>(boxIndex + 1) + (1.f - alignment.y) * paragraphHeight;
-
-		lineBox.Translate(translation);
+		Vertex_PCU& vert = verts[firstVert + vertIndex];
+		vert.m_position = layoutVerts[vertIndex].m_position + translation;
+		vert.m_color = tint;
+		vert.m_uvTexCoords = layoutVerts[vertIndex].m_uvTexCoords;
 	}
+}
+
+void BitmapFont::AddVertsForTextInBox2DUncached(std::vector<Vertex_PCU>& verts, std::string_view text, AABB2 const& box, float cellHeight, Rgba8 const& tint, float cellAspectScale, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw) const
+{
+	int numLines = 0;
+	float adjustedCellHeight = GetCellHeightForTextInBox2D(text, box.GetDimensions(), cellHeight, cellAspectScale, mode, numLines);
+
+	// the pivot of All Boxes are the same
+	float const boxPivotX = Interpolate(box.m_mins.x, box.m_maxs.x, alignment.x);
+	float const boxPivotY = Interpolate(box.m_mins.y, box.m_maxs.y, alignment.y);
 
+	float paragraphHeight = static_cast<float>(numLines) * adjustedCellHeight;
 
-	// Final step: after moving and resizing the box, add verts with in maxGlyphsToDraw
+	// Lines are views into text, every line box is placed and filled in one go, with in maxGlyphsToDraw
 	int glyphsDrawn = 0;
-	for (size_t boxIndex = 0; boxIndex < lineBoxs.size(); ++boxIndex)
+	size_t lineStart = 0;
+	for (int lineIndex = 0; lineIndex < numLines; ++lineIndex)
 	{
-		AABB2& lineBox = lineBoxs[boxIndex];
-		std::string lineText = textLines[boxIndex];
-		int lineTextLength = static_cast<int>(lineText.length());
+		size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos)
+		{
+			lineEnd = text.size();
+		}
+		std::string_view lineText = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
 
 		int remainingGlyphs = maxGlyphsToDraw - glyphsDrawn;
 		if (remainingGlyphs <= 0)
 		{
 			break;
 		}
-		if (lineTextLength <= remainingGlyphs)
+
+		float lineWidth = GetTextWidth(adjustedCellHeight, lineText, cellAspectScale);
+		Vec2 lineMins;
+		lineMins.x = boxPivotX - alignment.x * lineWidth;
+		lineMins.y = boxPivotY - adjustedCellHeight * static_cast<float>(lineIndex + 1) + (1.f - alignment.y) * paragraphHeight;
+
+		int lineTextLength = static_cast<int>(lineText.length());
+		if (lineTextLength > remainingGlyphs)
 		{
-			AddVertsForText2D(verts, lineBox.m_mins, adjustedCellHeight, lineText, tint, cellAspectScale);
-			glyphsDrawn += lineTextLength;
+			lineText = lineText.substr(0, remainingGlyphs);
+			lineTextLength = remainingGlyphs;
 		}
-		else
+		AddVertsForText2D(verts, lineMins, adjustedCellHeight, lineText, tint, cellAspectScale);
+		glyphsDrawn += lineTextLength;
+	}
+}
+
+float BitmapFont::GetCellHeightForTextInBox2D(std::string_view text, Vec2 const& boxDimensions, float cellHeight, float cellAspectScale, TextBoxMode mode, int& out_numLines) const
+{
+	// Same lines as SplitStringOnDelimiter: n delimiters make n + 1 lines
+	out_numLines = 1;
+	float paragraphWidth = 0.f;
+	size_t lineStart = 0;
+	for (;;)
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		if (mode == TextBoxMode::SHRINK_TO_FIT)
+		{
+			std::string_view lineText = text.substr(lineStart, (lineEnd == std::string_view::npos) ? std::string_view::npos : lineEnd - lineStart);
+			float lineWidth = GetTextWidth(cellHeight, lineText, cellAspectScale);
+			if (lineWidth > paragraphWidth)
+			{
+				paragraphWidth = lineWidth;
+			}
+		}
+		if (lineEnd == std::string_view::npos)
 		{
-			std::string cutText = lineText.substr(0, remainingGlyphs);
-			AddVertsForText2D(verts, lineBox.m_mins, adjustedCellHeight, cutText, tint, cellAspectScale);
-			glyphsDrawn += remainingGlyphs;
 			break;
 		}
+		lineStart = lineEnd + 1;
+		++out_numLines;
+	}
+
+	float adjustedCellHeight = cellHeight;
+	if (mode == TextBoxMode::SHRINK_TO_FIT)
+	{
+		float paragraphHeight = static_cast<float>(out_numLines) * cellHeight;
+		if (paragraphWidth > boxDimensions.x || paragraphHeight > boxDimensions.y)
+		{
+			float widthRatio = boxDimensions.x / paragraphWidth;
+			float HeightRatio = boxDimensions.y / paragraphHeight;
+			float minRatio = (widthRatio < HeightRatio) ? widthRatio : HeightRatio;
+			adjustedCellHeight *= minRatio;
+		}
 	}
+	return adjustedCellHeight;
 }
 
-void BitmapFont::AddVertsForTextOnSpline2D(std::vector<Vertex_PCU>& verts, Spline2D const& spline, float cellHeight, std::string const& text, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, float cellAspectScale /*= 1.f*/, float startOffsetAlongSpline /*= 0.f*/, float baselineOffset /*= 0.f*/) const
+void BitmapFont::AddVertsForTextOnSpline2D(std::vector<Vertex_PCU>& verts, Spline2D const& spline, float cellHeight, std::string_view text, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, float cellAspectScale /*= 1.f*/, float startOffsetAlongSpline /*= 0.f*/, float baselineOffset /*= 0.f*/) const
 {
 	float maxSplineLength = spline.GetSplineLength();
 	float currentDistAlongSpline = startOffsetAlongSpline;
@@ -149,12 +264,19 @@ void BitmapFont::AddVertsForTextOnSpline2D(std::vector<Vertex_PCU>& verts, Splin
 
 		Vec2 basePoint = splinePointPos + jBasis * baselineOffset;
 
-		Vec2 BL = basePoint - iBasis * (0.5f * cellWidth);
-		Vec2 BR = basePoint + iBasis * (0.5f * cellWidth);
-		Vec2 TR = BR + jBasis * cellHeight;
-		Vec2 TL = BL + jBasis * cellHeight;
+		AABB2 quadBounds;
+		AABB2 UVs;
+		GetGlyphQuad(glyphUnicode, quadBounds, UVs);
+		Vec2 penPos = basePoint - iBasis * (0.5f * cellWidth);
+		Vec2 quadMinX = iBasis * (quadBounds.m_mins.x * cellHeight * cellAspectScale);
+		Vec2 quadMaxX = iBasis * (quadBounds.m_maxs.x * cellHeight * cellAspectScale);
+		Vec2 quadMinY = jBasis * (quadBounds.m_mins.y * cellHeight);
+		Vec2 quadMaxY = jBasis * (quadBounds.m_maxs.y * cellHeight);
 
-		AABB2 UVs = m_fontGlyphsSpriteSheet.GetSpriteUVs(glyphUnicode);
+		Vec2 BL = penPos + quadMinX + quadMinY;
+		Vec2 BR = penPos + quadMaxX + quadMinY;
+		Vec2 TR = penPos + quadMaxX + quadMaxY;
+		Vec2 TL = penPos + quadMinX + quadMaxY;
 
 		AddVertsForQuad2D(verts, BL, BR, TR, TL, tint, UVs);
 		// Second Half
@@ -162,105 +284,69 @@ void BitmapFont::AddVertsForTextOnSpline2D(std::vector<Vertex_PCU>& verts, Splin
 	}
 }
 
-void BitmapFont::AddVertsForText3DAtOriginXForward(std::vector<Vertex_PCU>& verts, float cellHeight, std::string const& text, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, float cellAspect /*= 1.0f*/, Vec2 const& alignment /*= Vec2(0.5f, 0.5f)*/, int maxGlyphsToDraw /*= 999*/)
+void BitmapFont::AddVertsForText3DAtOriginXForward(std::vector<Vertex_PCU>& verts, float cellHeight, std::string_view text, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, float cellAspect /*= 1.0f*/, Vec2 const& alignment /*= Vec2(0.5f, 0.5f)*/, int maxGlyphsToDraw /*= 999*/)
 {
-	std::string cutText = text.substr(0, maxGlyphsToDraw);
+	std::string_view cutText = text.substr(0, maxGlyphsToDraw);
 
 	Vec3 iBasis = Vec3(0.f, 1.f, 0.f);
 	Vec3 jBasis = Vec3(0.f, 0.f, 1.f);
 	Vec3 kBasis = Vec3(1.f, 0.f, 0.f);
 
-	std::vector<Vertex_PCU> textVerts;
-	AddVertsForText2D(textVerts, Vec2::ZERO, cellHeight, cutText, tint, cellAspect);
-
 	float width = GetTextWidth(cellHeight, cutText, cellAspect);
 	float height = cellHeight;
 
 	Vec3 translation = Vec3(0.f, -alignment.x * width, -alignment.y * height);
 	Mat44 transform = Mat44(iBasis, jBasis, kBasis, translation);
 
-	TransformVertexArray3D(textVerts, transform);
-
-	verts.reserve(verts.size() + textVerts.size());
-
-	for (Vertex_PCU const& vertex : textVerts)
+	// Text verts are appended and then transformed where they are
+	size_t firstVert = verts.size();
+	AddVertsForText2D(verts, Vec2::ZERO, cellHeight, cutText, tint, cellAspect);
+	for (size_t vertIndex = firstVert; vertIndex < verts.size(); ++vertIndex)
 	{
-		verts.push_back(vertex);
+		verts[vertIndex].m_position = transform.TransformPosition3D(verts[vertIndex].m_position);
 	}
 }
 
-void BitmapFont::GetInsertionPointForTextInBox2D(float& outInsertionPointHeight, Vec2& outInsertionPointBottomCenterPos, int insertionPointPosition, std::string const& text, AABB2 const& box, float cellHeight, float cellAspectScale /*= 1.f*/, Vec2 const& alignment /*= Vec2(0.5f, 0.5f)*/, TextBoxMode mode /*= TextBoxMode::SHRINK_TO_FIT*/)
+void BitmapFont::GetInsertionPointForTextInBox2D(float& outInsertionPointHeight, Vec2& outInsertionPointBottomCenterPos, int insertionPointPosition, std::string_view text, AABB2 const& box, float cellHeight, float cellAspectScale /*= 1.f*/, Vec2 const& alignment /*= Vec2(0.5f, 0.5f)*/, TextBoxMode mode /*= TextBoxMode::SHRINK_TO_FIT*/)
 {
-	GUARANTEE_OR_DIE(insertionPointPosition <= text.length() && insertionPointPosition >= 0, "Insertion Point Position Out of Range!");
-	Strings textLines = SplitStringOnDelimiter(text, '\n');
+	GUARANTEE_OR_DIE(insertionPointPosition <= static_cast<int>(text.length()) && insertionPointPosition >= 0, "Insertion Point Position Out of Range!");
 
-	float adjustedCellHeight = cellHeight;
-
-	if (mode == TextBoxMode::SHRINK_TO_FIT)
-	{
-		float paragraphHeight = static_cast<float>(textLines.size()) * cellHeight;
-		float paragraphWidth = 0.f;
-		for (size_t lineIndex = 0; lineIndex < textLines.size(); ++lineIndex)
-		{
-			float lineWidth = GetTextWidth(cellHeight, textLines[lineIndex], cellAspectScale);
-			if (lineWidth > paragraphWidth)
-			{
-				paragraphWidth = lineWidth;
-			}
-		}
-		if (paragraphWidth > box.GetDimensions().x || paragraphHeight > box.GetDimensions().y)
-		{
-			float widthRatio = box.GetDimensions().x / paragraphWidth;
-			float HeightRatio = box.GetDimensions().y / paragraphHeight;
-			float minRatio = (widthRatio < HeightRatio) ? widthRatio : HeightRatio;
-			adjustedCellHeight *= minRatio;
-		}
-	}
-
-	std::vector<AABB2> lineBoxs;
-	lineBoxs.reserve(textLines.size());
-	for (size_t lineIndex = 0; lineIndex < textLines.size(); ++lineIndex)
-	{
-		float lineWidth = GetTextWidth(adjustedCellHeight, textLines[lineIndex], cellAspectScale);
-		lineBoxs.push_back(AABB2(Vec2::ZERO, Vec2(lineWidth, adjustedCellHeight)));
-	}
+	int numLines = 0;
+	float adjustedCellHeight = GetCellHeightForTextInBox2D(text, box.GetDimensions(), cellHeight, cellAspectScale, mode, numLines);
 
 	// the pivot of All Boxes are the same
 	float const boxPivotX = Interpolate(box.m_mins.x, box.m_maxs.x, alignment.x);
 	float const boxPivotY = Interpolate(box.m_mins.y, box.m_maxs.y, alignment.y);
 
-	float paragraphHeight = static_cast<float>(textLines.size()) * adjustedCellHeight;
-
-	for (size_t boxIndex = 0; boxIndex < lineBoxs.size(); ++boxIndex)
-	{
-		AABB2& lineBox = lineBoxs[boxIndex];
-		Vec2 translation;
-		float lineBoxPivotX = Interpolate(lineBox.m_mins.x, lineBox.m_maxs.x, alignment.x);
-		translation.x = boxPivotX - lineBoxPivotX;
-
-		translation.y = boxPivotY - adjustedCellHeight * static_cast<float>(boxIndex + 1) + (1.f - alignment.y) * paragraphHeight;
-
-		lineBox.Translate(translation);
-	}
-
+	float paragraphHeight = static_cast<float>(numLines) * adjustedCellHeight;
 
-	// Final step: after moving and resizing the box, find insertion point position
+	// Final step: place the line box of the insertion point, find insertion point position in it
 	outInsertionPointHeight = adjustedCellHeight;
 	outInsertionPointBottomCenterPos = Vec2();
 
 	int remainingInsertionPointPosition = insertionPointPosition;
-	for (size_t boxIndex = 0; boxIndex < lineBoxs.size(); ++boxIndex)
+	size_t lineStart = 0;
+	for (int lineIndex = 0; lineIndex < numLines; ++lineIndex)
 	{
-		AABB2& lineBox = lineBoxs[boxIndex];
-		std::string lineText = textLines[boxIndex];
+		size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos)
+		{
+			lineEnd = text.size();
+		}
+		std::string_view lineText = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
 		int lineTextLength = static_cast<int>(lineText.length());
 
 		// insertion point is in current line
 		if (remainingInsertionPointPosition <= lineTextLength)
 		{
-			std::string cutText = lineText.substr(0, remainingInsertionPointPosition);
-			float offset = GetTextWidth(adjustedCellHeight, cutText, cellAspectScale);
-			outInsertionPointBottomCenterPos = lineBox.m_mins + Vec2(offset, 0.f);
+			float lineWidth = GetTextWidth(adjustedCellHeight, lineText, cellAspectScale);
+			Vec2 lineMins;
+			lineMins.x = boxPivotX - alignment.x * lineWidth;
+			lineMins.y = boxPivotY - adjustedCellHeight * static_cast<float>(lineIndex + 1) + (1.f - alignment.y) * paragraphHeight;
+
+			float offset = GetTextWidth(adjustedCellHeight, lineText.substr(0, remainingInsertionPointPosition), cellAspectScale);
+			outInsertionPointBottomCenterPos = lineMins + Vec2(offset, 0.f);
 			return;
 		}
 
@@ -269,7 +355,7 @@ void BitmapFont::GetInsertionPointForTextInBox2D(float& outInsertionPointHeight,
 	}
 }
 
-float BitmapFont::GetTextWidth(float cellHeight, std::string const& text, float cellAspectScale /*= 1.f*/)
+float BitmapFont::GetTextWidth(float cellHeight, std::string_view text, float cellAspectScale /*= 1.f*/) const
 {
 	// TODO if the length of character is not 1-byte, we create new method?
 	float totalWidth = 0.f;
@@ -284,9 +370,146 @@ float BitmapFont::GetTextWidth(float cellHeight, std::string const& text, float
 	return totalWidth;
 }
 
-float BitmapFont::GetGlyphAspect(int glyphUnicode) const
+void BitmapFont::SetLayoutCacheCapacity(int capacity)
+{
+	ClearLayoutCache();
+	m_layoutCacheCapacity = (capacity > 0) ? capacity : 0;
+}
+
+void BitmapFont::ClearLayoutCache()
+{
+	m_layoutCache.clear();
+	m_layoutCacheLookup.clear();
+	m_newestLayoutEntry = -1;
+	m_oldestLayoutEntry = -1;
+	m_numLayoutCacheHits = 0;
+	m_numLayoutCacheMisses = 0;
+}
+
+TextLayoutCacheStats BitmapFont::GetLayoutCacheStats() const
 {
-	UNUSED(glyphUnicode);
+	TextLayoutCacheStats stats;
+	stats.m_numHits = m_numLayoutCacheHits;
+	stats.m_numMisses = m_numLayoutCacheMisses;
+	stats.m_numEntries = static_cast<int>(m_layoutCache.size());
+	stats.m_capacity = m_layoutCacheCapacity;
+	return stats;
+}
 
+void BitmapFont::UnlinkLayoutCacheEntry(int entryIndex)
+{
+	TextLayoutCacheEntry& entry = m_layoutCache[entryIndex];
+	if (entry.m_prev >= 0)
+	{
+		m_layoutCache[entry.m_prev].m_next = entry.m_next;
+	}
+	else if (m_newestLayoutEntry == entryIndex)
+	{
+		m_newestLayoutEntry = entry.m_next;
+	}
+	if (entry.m_next >= 0)
+	{
+		m_layoutCache[entry.m_next].m_prev = entry.m_prev;
+	}
+	else if (m_oldestLayoutEntry == entryIndex)
+	{
+		m_oldestLayoutEntry = entry.m_prev;
+	}
+	entry.m_prev = -1;
+	entry.m_next = -1;
+}
+
+void BitmapFont::LinkLayoutCacheEntryAsNewest(int entryIndex)
+{
+	TextLayoutCacheEntry& entry = m_layoutCache[entryIndex];
+	entry.m_prev = -1;
+	entry.m_next = m_newestLayoutEntry;
+	if (m_newestLayoutEntry >= 0)
+	{
+		m_layoutCache[m_newestLayoutEntry].m_prev = entryIndex;
+	}
+	m_newestLayoutEntry = entryIndex;
+	if (m_oldestLayoutEntry < 0)
+	{
+		m_oldestLayoutEntry = entryIndex;
+	}
+}
+
+float BitmapFont::GetGlyphAspect(int glyphUnicode) const
+{
+	if (IsSDF() && glyphUnicode >= 0 && glyphUnicode < static_cast<int>(m_sdfGlyphs.size()))
+	{
+		return m_sdfGlyphs[glyphUnicode].m_advance;
+	}
 	return m_fontDefaultAspect;
 }
+
+void BitmapFont::GetGlyphQuad(int glyphUnicode, AABB2& out_quadBounds, AABB2& out_uvs) const
+{
+	if (IsSDF() && glyphUnicode >= 0 && glyphUnicode < static_cast<int>(m_sdfGlyphs.size()))
+	{
+		// Padded cell, so the distance falloff around the glyph is drawn too
+		SDFGlyphMetrics const& metrics = m_sdfGlyphs[glyphUnicode];
+		out_quadBounds = metrics.m_quadBounds;
+		out_uvs = metrics.m_uvs;
+		return;
+	}
+	out_quadBounds = AABB2(0.f, 0.f, GetGlyphAspect(glyphUnicode), 1.f);
+	out_uvs = m_fontGlyphsSpriteSheet.GetSpriteUVs(glyphUnicode);
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string TextBenchmarkResult::ToString() const
+{
+	return Stringf("%d labels, %d verts per frame over %d frames. Uncached %.3f ms/frame, cached %.3f ms/frame (%llu hits, %llu misses, %d/%d entries)",
+		m_numLabels, m_numVerts, m_numFrames, m_uncachedMsPerFrame, m_cachedMsPerFrame,
+		static_cast<unsigned long long>(m_cacheStats.m_numHits), static_cast<unsigned long long>(m_cacheStats.m_numMisses), m_cacheStats.m_numEntries, m_cacheStats.m_capacity);
+}
+
+TextBenchmarkResult RunTextBenchmark(BitmapFont& font, int numLabels, int numFrames)
+{
+	TextBenchmarkResult result;
+	result.m_numLabels = numLabels;
+	result.m_numFrames = numFrames;
+
+	// Labels repeat a few distinct texts at different places, like name plates and DevConsole lines
+	int constexpr NUM_DISTINCT_TEXTS = 128;
+	std::vector<std::string> texts;
+	texts.reserve(NUM_DISTINCT_TEXTS);
+	for (int textIndex = 0; textIndex < NUM_DISTINCT_TEXTS; ++textIndex)
+	{
+		texts.push_back(Stringf("Entity %d\nHealth %d / 100", textIndex, (textIndex * 37) % 100));
+	}
+	Vec2 const labelDimensions(120.f, 24.f);
+
+	std::vector<Vertex_PCU> verts;
+	auto runFrames = [&]()
+		{
+			double startSeconds = GetCurrentTimeSeconds();
+			for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+			{
+				verts.clear();
+				for (int labelIndex = 0; labelIndex < numLabels; ++labelIndex)
+				{
+					Vec2 labelMins(static_cast<float>((labelIndex % 100) * 128), static_cast<float>((labelIndex / 100) * 32 + frameIndex));
+					AABB2 labelBox(labelMins, labelMins + labelDimensions);
+					font.AddVertsForTextInBox2D(verts, texts[labelIndex % NUM_DISTINCT_TEXTS], labelBox, 12.f, Rgba8::OPAQUE_WHITE, 1.f, Vec2(0.f, 0.5f));
+				}
+			}
+			return (GetCurrentTimeSeconds() - startSeconds) * 1000.0 / static_cast<double>(numFrames > 0 ? numFrames : 1);
+		};
+
+	TextLayoutCacheStats previousStats = font.GetLayoutCacheStats();
+	int previousCapacity = previousStats.m_capacity;
+
+	font.SetLayoutCacheCapacity(0);
+	result.m_uncachedMsPerFrame = runFrames();
+
+	font.SetLayoutCacheCapacity(previousCapacity > NUM_DISTINCT_TEXTS ? previousCapacity : NUM_DISTINCT_TEXTS);
+	result.m_cachedMsPerFrame = runFrames();
+	result.m_cacheStats = font.GetLayoutCacheStats();
+	result.m_numVerts = static_cast<int>(verts.size());
+
+	font.SetLayoutCacheCapacity(previousCapacity);
+	return result;
+}
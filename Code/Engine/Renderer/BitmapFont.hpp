@@ -1,13 +1,16 @@
 #pragma once
 #include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Renderer/SDFFontAtlas.hpp"
 #include "Engine/Renderer/SpriteSheet.hpp"
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 //-----------------------------------------------------------------------------------------------
 class Texture;
 class Spline2D;
-struct Vertex_PCU;
 struct Vec2;
 struct Rgba8;
 
@@ -18,6 +21,15 @@ enum class TextBoxMode
 	OVERRUN
 };
 
+//-----------------------------------------------------------------------------------------------
+struct TextLayoutCacheStats
+{
+	uint64_t	m_numHits = 0;
+	uint64_t	m_numMisses = 0;
+	int			m_numEntries = 0;
+	int			m_capacity = 0;
+};
+
 
 //-----------------------------------------------------------------------------------------------
 class BitmapFont
@@ -25,39 +37,100 @@ class BitmapFont
 	friend class Renderer; // Only the Renderer can create new BitmapFont Objects!
 	friend class DX11Renderer;
 	friend class DX12Renderer;
+	friend class NullRenderer;
 
 private:
 	BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& fontTexture);
+	// Signed distance field font, atlasTexture holds atlas.m_image
+	BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& atlasTexture, SDFFontAtlas const& atlas);
 
 public:
 	Texture& GetTexture();
-	void AddVertsForText2D(std::vector<Vertex_PCU>& verts, Vec2 const& textMins, float cellHeight, std::string const& text, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, float cellAspectScale = 1.f);
-	void AddVertsForTextInBox2D(std::vector<Vertex_PCU>& verts, std::string const& text, AABB2 const& box, float cellHeight, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, 
+	// SDF fonts draw with SDF_TEXT_SHADER_NAME and a bilinear sampler, at any cell height
+	bool IsSDF() const { return !m_sdfGlyphs.empty(); }
+	void AddVertsForText2D(std::vector<Vertex_PCU>& verts, Vec2 const& textMins, float cellHeight, std::string_view text, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, float cellAspectScale = 1.f) const;
+	// Laid out boxes are kept in a small LRU cache, a repeated text in a same sized box only copies, moves and tints its quads
+	void AddVertsForTextInBox2D(std::vector<Vertex_PCU>& verts, std::string_view text, AABB2 const& box, float cellHeight, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, 
 								float cellAspectScale = 1.f, Vec2 const& alignment = Vec2(0.5f, 0.5f), TextBoxMode mode = TextBoxMode::SHRINK_TO_FIT, int maxGlyphsToDraw = 99999999);
-	void AddVertsForTextOnSpline2D(std::vector<Vertex_PCU>& verts, Spline2D const& spline, float cellHeight, std::string const& text, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, float cellAspectScale = 1.f,
+	void AddVertsForTextOnSpline2D(std::vector<Vertex_PCU>& verts, Spline2D const& spline, float cellHeight, std::string_view text, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, float cellAspectScale = 1.f,
 								float startOffsetAlongSpline = 0.f, float baselineOffset = 0.f) const;
 	
 	void AddVertsForText3DAtOriginXForward(std::vector<Vertex_PCU>& verts,
-		float cellHeight, std::string const& text, Rgba8 const& tint = Rgba8::OPAQUE_WHITE,
+		float cellHeight, std::string_view text, Rgba8 const& tint = Rgba8::OPAQUE_WHITE,
 		float cellAspect = 1.0f, Vec2 const& alignment = Vec2(0.5f, 0.5f),
 		int maxGlyphsToDraw = 999);
 	
 
 
 	
-	void GetInsertionPointForTextInBox2D(float& outInsertionPointHeight, Vec2& outInsertionPointBottomCenterPos, int insertionPointPosition, std::string const& text, AABB2 const& box, float cellHeight, 
+	void GetInsertionPointForTextInBox2D(float& outInsertionPointHeight, Vec2& outInsertionPointBottomCenterPos, int insertionPointPosition, std::string_view text, AABB2 const& box, float cellHeight, 
 		float cellAspectScale = 1.f, Vec2 const& alignment = Vec2(0.5f, 0.5f), TextBoxMode mode = TextBoxMode::SHRINK_TO_FIT);
-	float GetTextWidth(float cellHeight, std::string const& text, float cellAspectScale = 1.f);
+	float GetTextWidth(float cellHeight, std::string_view text, float cellAspectScale = 1.f) const;
+
+	// 0 turns the layout cache off
+	void SetLayoutCacheCapacity(int capacity);
+	void ClearLayoutCache();
+	TextLayoutCacheStats GetLayoutCacheStats() const;
 
 protected:
-	float GetGlyphAspect(int glyphUnicode) const; // For now this will always return m_fontDefaultAspect
+	float GetGlyphAspect(int glyphUnicode) const; // m_fontDefaultAspect, or the advance of an SDF glyph
+	// Quad of the glyph relative to the pen position, x in cell widths and y in cell heights
+	void GetGlyphQuad(int glyphUnicode, AABB2& out_quadBounds, AABB2& out_uvs) const;
+
+	// Layout without the cache, allocation free apart from growing verts
+	void AddVertsForTextInBox2DUncached(std::vector<Vertex_PCU>& verts, std::string_view text, AABB2 const& box, float cellHeight, Rgba8 const& tint,
+										float cellAspectScale, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw) const;
+	float GetCellHeightForTextInBox2D(std::string_view text, Vec2 const& boxDimensions, float cellHeight, float cellAspectScale, TextBoxMode mode, int& out_numLines) const;
+
+	struct TextLayoutCacheEntry
+	{
+		uint64_t				m_hash = 0;
+		std::string				m_text;
+		Vec2					m_boxDimensions;
+		float					m_cellHeight = 0.f;
+		float					m_cellAspectScale = 0.f;
+		Vec2					m_alignment;
+		TextBoxMode				m_mode = TextBoxMode::SHRINK_TO_FIT;
+		int						m_maxGlyphsToDraw = 0;
+		std::vector<Vertex_PCU>	m_verts;	// relative to the box mins, white
+		int						m_prev = -1;	// towards the most recently used
+		int						m_next = -1;
+	};
+
+	void UnlinkLayoutCacheEntry(int entryIndex);
+	void LinkLayoutCacheEntryAsNewest(int entryIndex);
 
 protected:
 	std::string m_fontFilePathNameWithNoExtension;
 	SpriteSheet m_fontGlyphsSpriteSheet;
 	float m_fontDefaultAspect = 1.0f;
+	std::vector<SDFGlyphMetrics> m_sdfGlyphs; // empty for bitmap fonts
+
+	std::vector<TextLayoutCacheEntry>	m_layoutCache;
+	std::unordered_map<uint64_t, int>	m_layoutCacheLookup;
+	int									m_layoutCacheCapacity = 256;
+	int									m_newestLayoutEntry = -1;
+	int									m_oldestLayoutEntry = -1;
+	uint64_t							m_numLayoutCacheHits = 0;
+	uint64_t							m_numLayoutCacheMisses = 0;
 };
 
+//-----------------------------------------------------------------------------------------------
+struct TextBenchmarkResult
+{
+	int		m_numLabels = 0;
+	int		m_numFrames = 0;
+	int		m_numVerts = 0;				// per frame
+	double	m_uncachedMsPerFrame = 0.0;
+	double	m_cachedMsPerFrame = 0.0;
+	TextLayoutCacheStats m_cacheStats;
+
+	std::string ToString() const;
+};
+
+// Lays out numLabels DevConsole style labels into boxes every frame, with the cache off and on
+TextBenchmarkResult RunTextBenchmark(BitmapFont& font, int numLabels, int numFrames);
+
 
 /* Usage
 // ...once, during initialization
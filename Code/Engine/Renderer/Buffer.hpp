@@ -1,5 +1,7 @@
 #pragma once
+#if !defined(ENGINE_HEADLESS)
 #include "Game/EngineBuildPreferences.hpp"
+#endif
 
 
 /**************************************************************************************
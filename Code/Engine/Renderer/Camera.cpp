@@ -2,7 +2,9 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Math/Vec4.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#if !defined(ENGINE_HEADLESS)
 #include "Engine/Window/Window.hpp"
+#endif
 
 
 void Camera::SetOrthographicView(Vec2 const& bottomLeft, Vec2 const& topRight, float near /*= 0.0f*/, float far /*= 1.0f*/)
@@ -12,6 +14,7 @@ void Camera::SetOrthographicView(Vec2 const& bottomLeft, Vec2 const& topRight, f
 	m_orthographicTopRight = topRight;
 	m_orthographicNear = near;
 	m_orthographicFar = far;
+	SetProjectionDirty();
 }
 
 void Camera::SetPerspectiveView(float aspect, float fov, float near, float far)
@@ -21,17 +24,20 @@ void Camera::SetPerspectiveView(float aspect, float fov, float near, float far)
 	m_perspectiveFOV = fov;
 	m_perspectiveNear = near;
 	m_perspectiveFar = far;
+	SetProjectionDirty();
 }
 
 void Camera::SetPositionAndOrientation(Vec3 const& position, EulerAngles const& orientation)
 {
 	m_position = position;
 	m_orientation = orientation;
+	SetViewDirty();
 }
 
 void Camera::SetPosition(Vec3 const& position)
 {
 	m_position = position;
+	SetViewDirty();
 }
 
 Vec3 Camera::GetPosition() const
@@ -42,6 +48,7 @@ Vec3 Camera::GetPosition() const
 void Camera::SetOrientation(EulerAngles const& orientation)
 {
 	m_orientation = orientation;
+	SetViewDirty();
 }
 
 EulerAngles Camera::GetOrientation() const
@@ -51,25 +58,21 @@ EulerAngles Camera::GetOrientation() const
 
 Mat44 Camera::GetCameraToWorldTransform() const
 {
-	Mat44 result = m_orientation.GetAsMatrix_IFwd_JLeft_KUp();
-	result.SetTranslation3D(m_position);
-	return result;
+	UpdateViewTransforms();
+	return m_cameraToWorldTransform;
 }
 
 Mat44 Camera::GetWorldToCameraTransform() const
 {
-	Mat44 result = GetCameraToWorldTransform();
-	return result.GetOrthonormalInverse();
-	//Mat44 result = m_orientation.GetAsMatrix_IFwd_JLeft_KUp();
-	//result.TransposeIJK();
-	//result.Append(Mat44::MakeTranslation3D(-m_position));
-	//return result;
+	UpdateViewTransforms();
+	return m_worldToCameraTransform;
 }
 
 void Camera::SetCameraToRenderTransform(Mat44 const& m)
 {
 	// Must be supplied by game code when configuring the camera.
 	m_cameraToRenderTransform = m;
+	SetProjectionDirty();
 }
 
 Mat44 Camera::GetCameraToRenderTransform() const
@@ -82,6 +85,18 @@ Mat44 Camera::GetRenderToClipTransform() const
 	return GetProjectionMatrix();
 }
 
+Mat44 Camera::GetWorldToClipTransform() const
+{
+	if (m_isWorldToClipDirty)
+	{
+		m_worldToClipTransform = GetRenderToClipTransform();
+		m_worldToClipTransform.Append(GetCameraToRenderTransform());
+		m_worldToClipTransform.Append(GetWorldToCameraTransform());
+		m_isWorldToClipDirty = false;
+	}
+	return m_worldToClipTransform;
+}
+
 Vec2 Camera::GetOrthographicBottomLeft() const
 {
 	return m_orthographicBottomLeft;
@@ -96,6 +111,7 @@ void Camera::Translate2D(Vec2 const& translation2D)
 {
 	m_orthographicBottomLeft += translation2D;
 	m_orthographicTopRight += translation2D;
+	SetProjectionDirty();
 }
 
 Mat44 Camera::GetOrthographicMatrix() const
@@ -110,28 +126,34 @@ Mat44 Camera::GetPerspectiveMatrix() const
 
 Mat44 Camera::GetProjectionMatrix() const
 {
-	if (m_mode == eMode_Orthographic)
+	if (m_isProjectionDirty)
 	{
-		return GetOrthographicMatrix();
+		if (m_mode == eMode_Orthographic)
+		{
+			m_renderToClipTransform = GetOrthographicMatrix();
+		}
+		else if (m_mode == eMode_Perspective)
+		{
+			m_renderToClipTransform = GetPerspectiveMatrix();
+		}
+		else
+		{
+			m_renderToClipTransform = Mat44();
+		}
+		m_isProjectionDirty = false;
 	}
-	if (m_mode == eMode_Perspective)
-	{
-		return GetPerspectiveMatrix();
-	}
-
-	return Mat44();
+	return m_renderToClipTransform;
 }
 
 Mat44 Camera::GetClipToWorldTransform() const
 {
-	Mat44 result;
-	// Get World To Clip
-	result.Append(GetRenderToClipTransform());
-	result.Append(GetCameraToRenderTransform());
-	result.Append(GetWorldToCameraTransform());
-	// Inverse: clip to world
-	result.Inverse();
-	return result;
+	if (m_isClipToWorldDirty)
+	{
+		m_clipToWorldTransform = GetWorldToClipTransform();
+		m_clipToWorldTransform.Inverse();
+		m_isClipToWorldDirty = false;
+	}
+	return m_clipToWorldTransform;
 }
 
 bool Camera::IsMode(Mode mode) const
@@ -155,59 +177,64 @@ void Camera::GetDirectXViewport(Vec2 const& clientDimensions, float& topLeftX, f
 
 bool Camera::ProjectWorldToScreenPoint(Vec3 const& worldPos, Vec2& out_screenPos) const
 {
-	Mat44 const WorldToCameraTransform = GetWorldToCameraTransform();	// View Transform
-	Mat44 const CameraToRenderTransform = GetCameraToRenderTransform();	// Non-standard transform
-	Mat44 const RenderToClipTransform = GetRenderToClipTransform();	// Projection transform
-
-	Vec4 worldSpacePosition = Vec4(worldPos.x, worldPos.y, worldPos.z, 1.f);
-	Mat44 worldToClipTransform = RenderToClipTransform;
-	worldToClipTransform.Append(CameraToRenderTransform);
-	worldToClipTransform.Append(WorldToCameraTransform);
+	return ProjectWorldToScreenPoints(&worldPos, 1, &out_screenPos) == 1;
+}
 
-	Vec4 clipSpacePosition = worldToClipTransform.TransformHomogeneous3D(worldSpacePosition);
+bool Camera::ProjectWorldToViewportPoint(Vec3 const& worldPos, Vec2& out_viewportPos) const
+{
+	return ProjectWorldToViewportPoints(&worldPos, 1, &out_viewportPos) == 1;
+}
 
-	bool isInsideView = clipSpacePosition.w > 0.f;
-	if (!isInsideView)
+int Camera::ProjectWorldToScreenPoints(Vec3 const* worldPositions, int numPoints, Vec2* out_screenPositions, bool* out_isInFront /*= nullptr*/) const
+{
+#if defined(ENGINE_HEADLESS)
+	UNUSED(worldPositions);
+	UNUSED(out_screenPositions);
+	for (int pointIndex = 0; out_isInFront && pointIndex < numPoints; ++pointIndex)
 	{
-		return false;
+		out_isInFront[pointIndex] = false;
 	}
-
-	float invW = 1.f / clipSpacePosition.w;
-	Vec2 ndcSpacePosition = Vec2(clipSpacePosition.x * invW, clipSpacePosition.y * invW);
+	return 0; // no window, so there is no screen to project onto
+#else
 	Vec2 clientDimensions = Vec2(Window::s_mainWindow->GetClientDimensions());
-
 	AABB2 viewportBoundsInScreenCoords = AABB2(clientDimensions * m_normalizedViewport.m_mins, clientDimensions * m_normalizedViewport.m_maxs);
-
-	Vec2 uv = Vec2(ndcSpacePosition.x * 0.5f + 0.5f, ndcSpacePosition.y * 0.5f + 0.5f);
-	out_screenPos = viewportBoundsInScreenCoords.GetPointAtUV(uv);
-	return true;
+	return ProjectWorldPointsIntoBounds(worldPositions, numPoints, viewportBoundsInScreenCoords, out_screenPositions, out_isInFront);
+#endif
 }
 
-bool Camera::ProjectWorldToViewportPoint(Vec3 const& worldPos, Vec2& out_viewportPos) const
+int Camera::ProjectWorldToViewportPoints(Vec3 const* worldPositions, int numPoints, Vec2* out_viewportPositions, bool* out_isInFront /*= nullptr*/) const
 {
 	// The Viewport space is normalized and relative to the camera
-	Mat44 const WorldToCameraTransform = GetWorldToCameraTransform();	// View Transform
-	Mat44 const CameraToRenderTransform = GetCameraToRenderTransform();	// Non-standard transform
-	Mat44 const RenderToClipTransform = GetRenderToClipTransform();	// Projection transform
-
-	Vec4 worldSpacePosition = Vec4(worldPos.x, worldPos.y, worldPos.z, 1.f);
-	Mat44 worldToClipTransform = RenderToClipTransform;
-	worldToClipTransform.Append(CameraToRenderTransform);
-	worldToClipTransform.Append(WorldToCameraTransform);
+	return ProjectWorldPointsIntoBounds(worldPositions, numPoints, AABB2::ZERO_TO_ONE, out_viewportPositions, out_isInFront);
+}
 
-	Vec4 clipSpacePosition = worldToClipTransform.TransformHomogeneous3D(worldSpacePosition);
+int Camera::ProjectWorldPointsIntoBounds(Vec3 const* worldPositions, int numPoints, AABB2 const& bounds, Vec2* out_positions, bool* out_isInFront) const
+{
+	Mat44 const worldToClipTransform = GetWorldToClipTransform();
 
-	bool isInsideView = clipSpacePosition.w > 0.f;
-	if (!isInsideView)
+	int numInFront = 0;
+	for (int pointIndex = 0; pointIndex < numPoints; ++pointIndex)
 	{
-		return false;
+		Vec3 const& worldPos = worldPositions[pointIndex];
+		Vec4 clipSpacePosition = worldToClipTransform.TransformHomogeneous3D(Vec4(worldPos.x, worldPos.y, worldPos.z, 1.f));
+
+		bool isInsideView = clipSpacePosition.w > 0.f;
+		if (out_isInFront)
+		{
+			out_isInFront[pointIndex] = isInsideView;
+		}
+		if (!isInsideView)
+		{
+			continue;
+		}
+
+		float invW = 1.f / clipSpacePosition.w;
+		Vec2 ndcSpacePosition = Vec2(clipSpacePosition.x * invW, clipSpacePosition.y * invW);
+		Vec2 uv = Vec2(ndcSpacePosition.x * 0.5f + 0.5f, ndcSpacePosition.y * 0.5f + 0.5f);
+		out_positions[pointIndex] = bounds.GetPointAtUV(uv);
+		++numInFront;
 	}
-
-	float invW = 1.f / clipSpacePosition.w;
-	Vec2 ndcSpacePosition = Vec2(clipSpacePosition.x * invW, clipSpacePosition.y * invW);
-	
-	out_viewportPos = Vec2(ndcSpacePosition.x * 0.5f + 0.5f, ndcSpacePosition.y * 0.5f + 0.5f);
-	return true;
+	return numInFront;
 }
 
 
@@ -229,15 +256,41 @@ bool Camera::ScreenPointToRay(Vec3& out_rayStart, Vec3& out_rayFwdNormal, Vec2 c
 	localPoint.y = tanHalfFov * m_perspectiveAspect * -viewportNormalizedCoordinate.x;
 	localPoint.z = tanHalfFov * viewportNormalizedCoordinate.y;
 
-	Mat44 rot = m_orientation.GetAsMatrix_IFwd_JLeft_KUp();
-
-	Vec3 direction = rot.TransformVectorQuantity3D(localPoint);
+	UpdateViewTransforms();
+	Vec3 direction = m_cameraToWorldTransform.TransformVectorQuantity3D(localPoint);
 
 	out_rayStart = m_position;
 	out_rayFwdNormal = direction.GetNormalized();
 	return true;
 }
 
+//-----------------------------------------------------------------------------------------------
+void Camera::SetViewDirty()
+{
+	m_isViewDirty = true;
+	m_isWorldToClipDirty = true;
+	m_isClipToWorldDirty = true;
+}
+
+void Camera::SetProjectionDirty()
+{
+	m_isProjectionDirty = true;
+	m_isWorldToClipDirty = true;
+	m_isClipToWorldDirty = true;
+}
+
+void Camera::UpdateViewTransforms() const
+{
+	if (!m_isViewDirty)
+	{
+		return;
+	}
+	m_cameraToWorldTransform = m_orientation.GetAsMatrix_IFwd_JLeft_KUp();
+	m_cameraToWorldTransform.SetTranslation3D(m_position);
+	m_worldToCameraTransform = m_cameraToWorldTransform.GetOrthonormalInverse();
+	m_isViewDirty = false;
+}
+
 //-----------------------------------------------------------------------------------------------
 void Camera::SetOrthoView(Vec2 const& bottomLeft, Vec2 const& topRight)
 {
@@ -44,6 +44,8 @@ public:
 	Mat44 GetPerspectiveMatrix() const;
 	Mat44 GetProjectionMatrix() const;
 
+	// Render to clip * camera to render * world to camera
+	Mat44 GetWorldToClipTransform() const;
 	Mat44 GetClipToWorldTransform() const;
 
 	bool IsMode(Mode mode) const;
@@ -53,6 +55,11 @@ public:
 
 	bool ProjectWorldToScreenPoint(Vec3 const& worldPos, Vec2& out_screenPos) const;
 	bool ProjectWorldToViewportPoint(Vec3 const& worldPos, Vec2& out_viewportPos) const;
+	// Batch versions for many points a frame, such as nameplates and debug text. Points behind the
+	// camera keep their output untouched and get false in out_isInFront, which may be nullptr.
+	// Return the number of points in front of the camera
+	int ProjectWorldToScreenPoints(Vec3 const* worldPositions, int numPoints, Vec2* out_screenPositions, bool* out_isInFront = nullptr) const;
+	int ProjectWorldToViewportPoints(Vec3 const* worldPositions, int numPoints, Vec2* out_viewportPositions, bool* out_isInFront = nullptr) const;
 
 	bool ScreenPointToRay(Vec3& out_rayStart, Vec3& out_rayFwdNormal, Vec2 const& clientUV) const;
 
@@ -61,6 +68,12 @@ public:
 	Vec2 GetOrthoBottomLeft() const;
 	Vec2 GetOrthoTopRight() const;
 
+protected:
+	void SetViewDirty();
+	void SetProjectionDirty();
+	void UpdateViewTransforms() const;
+	int ProjectWorldPointsIntoBounds(Vec3 const* worldPositions, int numPoints, AABB2 const& bounds, Vec2* out_positions, bool* out_isInFront) const;
+
 protected:
 	Mode m_mode = eMode_Orthographic;
 
@@ -82,4 +95,16 @@ protected:
 
 	AABB2 m_normalizedViewport = AABB2::ZERO_TO_ONE;
 
+	// Derived transforms, rebuilt on first use after a setter changes what they depend on.
+	// Position and orientation dirty the view, projection settings and camera to render dirty the
+	// projection, either one dirties world to clip and its inverse
+	mutable Mat44 m_cameraToWorldTransform;
+	mutable Mat44 m_worldToCameraTransform;
+	mutable Mat44 m_renderToClipTransform;
+	mutable Mat44 m_worldToClipTransform;
+	mutable Mat44 m_clipToWorldTransform;
+	mutable bool m_isViewDirty = true;
+	mutable bool m_isProjectionDirty = true;
+	mutable bool m_isWorldToClipDirty = true;
+	mutable bool m_isClipToWorldDirty = true;
 };
@@ -1,4 +1,13 @@
 #include "Engine/Renderer/ConstantBuffer.hpp"
+
+#ifdef ENGINE_RENDER_NULL
+ConstantBuffer::ConstantBuffer(unsigned int id, size_t size)
+	: m_id(id)
+	, m_size(size)
+{
+}
+
+#else
 #include "Engine/Core/EngineCommon.hpp"
 #include <d3d11.h>
 
@@ -40,3 +49,4 @@ void ConstantBuffer::Create()
 		ERROR_AND_DIE("Could not create constant buffer.");
 	}
 }
+#endif // ENGINE_RENDER_NULL
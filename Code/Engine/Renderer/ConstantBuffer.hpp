@@ -1,5 +1,23 @@
 #pragma once
+#include "Engine/Renderer/RendererCommon.hpp"
 
+#ifdef ENGINE_RENDER_NULL
+//-----------------------------------------------------------------------------------------------
+class ConstantBuffer
+{
+	friend class NullRenderer;
+
+public:
+	ConstantBuffer(unsigned int id, size_t size);
+	ConstantBuffer(const ConstantBuffer& copy) = delete;
+	virtual ~ConstantBuffer() = default;
+
+private:
+	unsigned int m_id = 0;
+	size_t m_size = 0;
+};
+
+#else
 //-----------------------------------------------------------------------------------------------
 struct ID3D11Device;
 struct ID3D11Buffer;
@@ -23,4 +41,5 @@ private:
 	ID3D11Buffer* m_buffer = nullptr;
 	size_t m_size = 0;
 };
+#endif // ENGINE_RENDER_NULL
 
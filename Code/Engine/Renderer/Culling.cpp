@@ -0,0 +1,785 @@
+#include "Engine/Renderer/Culling.hpp"
+#include "Engine/Renderer/Camera.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+	#define CULLING_USE_SSE
+	#include <xmmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Bit after the plane bits in a test mask, set while the max distance still needs testing
+	constexpr unsigned int DISTANCE_TEST_BIT = 1u << Frustum::NUM_PLANES;
+
+	// Objects per task for CullFlat, rounded to a multiple of four
+	constexpr int MIN_OBJECTS_PER_FLAT_TASK = 2048;
+	// Work is split into this many tasks per thread, so a slow thread does not hold up the rest
+	constexpr int TASKS_PER_THREAD = 4;
+
+	struct ActivePlanes
+	{
+		float	m_normalX[Frustum::NUM_PLANES];
+		float	m_normalY[Frustum::NUM_PLANES];
+		float	m_normalZ[Frustum::NUM_PLANES];
+		float	m_distance[Frustum::NUM_PLANES];
+		int		m_numPlanes = 0;
+		bool	m_testDistance = false;
+	};
+
+	ActivePlanes GetActivePlanes(Frustum const& frustum, unsigned int testMask)
+	{
+		ActivePlanes active;
+		for (int planeIndex = 0; planeIndex < Frustum::NUM_PLANES; ++planeIndex)
+		{
+			if (testMask & (1u << planeIndex))
+			{
+				Plane3 const& plane = frustum.m_planes[planeIndex];
+				active.m_normalX[active.m_numPlanes] = plane.m_normal.x;
+				active.m_normalY[active.m_numPlanes] = plane.m_normal.y;
+				active.m_normalZ[active.m_numPlanes] = plane.m_normal.z;
+				active.m_distance[active.m_numPlanes] = plane.m_distance;
+				++active.m_numPlanes;
+			}
+		}
+		active.m_testDistance = (testMask & DISTANCE_TEST_BIT) != 0;
+		return active;
+	}
+
+	unsigned int GetFullTestMask(Frustum const& frustum)
+	{
+		return Frustum::ALL_PLANES_MASK | ((frustum.m_maxDistance > 0.f) ? DISTANCE_TEST_BIT : 0u);
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// Tests objects [firstObject, endObject) of the arrays and appends the visible ones. An object
+	// is culled by a plane when either its sphere or its box is fully behind it, the nearer of the
+	// two reaches decides. With remap the appended index is remap[objectIndex]
+	template<typename TArrays>
+	void CullRange(TArrays const& bounds, int firstObject, int endObject, Frustum const& frustum, unsigned int testMask, int const* remap, std::vector<int>& out_visibleIndexes)
+	{
+		ActivePlanes const active = GetActivePlanes(frustum, testMask);
+		float const* centerX = bounds.m_centerX.data();
+		float const* centerY = bounds.m_centerY.data();
+		float const* centerZ = bounds.m_centerZ.data();
+		float const* radius = bounds.m_radius.data();
+		float const* extentX = bounds.m_extentX.data();
+		float const* extentY = bounds.m_extentY.data();
+		float const* extentZ = bounds.m_extentZ.data();
+
+		int objectIndex = firstObject;
+
+#ifdef CULLING_USE_SSE
+		__m128 const signMask = _mm_set1_ps(-0.f);
+		__m128 const viewX = _mm_set1_ps(frustum.m_viewPosition.x);
+		__m128 const viewY = _mm_set1_ps(frustum.m_viewPosition.y);
+		__m128 const viewZ = _mm_set1_ps(frustum.m_viewPosition.z);
+		__m128 const maxDistance = _mm_set1_ps(frustum.m_maxDistance);
+
+		for (; objectIndex + 4 <= endObject; objectIndex += 4)
+		{
+			__m128 x = _mm_loadu_ps(centerX + objectIndex);
+			__m128 y = _mm_loadu_ps(centerY + objectIndex);
+			__m128 z = _mm_loadu_ps(centerZ + objectIndex);
+			__m128 r = _mm_loadu_ps(radius + objectIndex);
+			__m128 ex = _mm_loadu_ps(extentX + objectIndex);
+			__m128 ey = _mm_loadu_ps(extentY + objectIndex);
+			__m128 ez = _mm_loadu_ps(extentZ + objectIndex);
+			__m128 isOutside = _mm_setzero_ps();
+
+			for (int planeIndex = 0; planeIndex < active.m_numPlanes; ++planeIndex)
+			{
+				__m128 nx = _mm_set1_ps(active.m_normalX[planeIndex]);
+				__m128 ny = _mm_set1_ps(active.m_normalY[planeIndex]);
+				__m128 nz = _mm_set1_ps(active.m_normalZ[planeIndex]);
+				__m128 altitude = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_mul_ps(nz, z)), _mm_set1_ps(active.m_distance[planeIndex]));
+				__m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex), _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)), _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+				__m128 reach = _mm_min_ps(r, boxRadius);
+				isOutside = _mm_or_ps(isOutside, _mm_cmplt_ps(altitude, _mm_xor_ps(reach, signMask)));
+			}
+
+			if (active.m_testDistance)
+			{
+				__m128 dx = _mm_sub_ps(x, viewX);
+				__m128 dy = _mm_sub_ps(y, viewY);
+				__m128 dz = _mm_sub_ps(z, viewZ);
+				__m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+				__m128 reach = _mm_add_ps(maxDistance, r);
+				isOutside = _mm_or_ps(isOutside, _mm_cmpgt_ps(distanceSquared, _mm_mul_ps(reach, reach)));
+			}
+
+			int visibleLanes = ~_mm_movemask_ps(isOutside) & 0xF;
+			while (visibleLanes != 0)
+			{
+				int lane = 0;
+				while ((visibleLanes & (1 << lane)) == 0)
+				{
+					++lane;
+				}
+				visibleLanes &= ~(1 << lane);
+				out_visibleIndexes.push_back(remap ? remap[objectIndex + lane] : objectIndex + lane);
+			}
+		}
+#endif // CULLING_USE_SSE
+
+		for (; objectIndex < endObject; ++objectIndex)
+		{
+			float x = centerX[objectIndex];
+			float y = centerY[objectIndex];
+			float z = centerZ[objectIndex];
+			float r = radius[objectIndex];
+			bool isOutside = false;
+
+			for (int planeIndex = 0; planeIndex < active.m_numPlanes && !isOutside; ++planeIndex)
+			{
+				float nx = active.m_normalX[planeIndex];
+				float ny = active.m_normalY[planeIndex];
+				float nz = active.m_normalZ[planeIndex];
+				float altitude = nx * x + ny * y + nz * z - active.m_distance[planeIndex];
+				float boxRadius = fabsf(nx) * extentX[objectIndex] + fabsf(ny) * extentY[objectIndex] + fabsf(nz) * extentZ[objectIndex];
+				float reach = (r < boxRadius) ? r : boxRadius;
+				isOutside = altitude < -reach;
+			}
+
+			if (active.m_testDistance && !isOutside)
+			{
+				float dx = x - frustum.m_viewPosition.x;
+				float dy = y - frustum.m_viewPosition.y;
+				float dz = z - frustum.m_viewPosition.z;
+				float reach = frustum.m_maxDistance + r;
+				isOutside = dx * dx + dy * dy + dz * dz > reach * reach;
+			}
+
+			if (!isOutside)
+			{
+				out_visibleIndexes.push_back(remap ? remap[objectIndex] : objectIndex);
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC Frustum Frustum::MakeFromCamera(Camera const& camera, float maxDistance /*= 0.f*/)
+{
+	Frustum frustum = MakeFromWorldToClip(camera.GetWorldToClipTransform());
+	frustum.m_viewPosition = camera.GetPosition();
+	frustum.m_maxDistance = maxDistance;
+	return frustum;
+}
+
+STATIC Frustum Frustum::MakeFromWorldToClip(Mat44 const& worldToClipTransform)
+{
+	// Row i of the matrix gives clip component i as a plane equation in world space; a point is
+	// inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w
+	float const* m = worldToClipTransform.m_values;
+	float rows[4][4];
+	for (int row = 0; row < 4; ++row)
+	{
+		rows[row][0] = m[Mat44::Ix + row];
+		rows[row][1] = m[Mat44::Jx + row];
+		rows[row][2] = m[Mat44::Kx + row];
+		rows[row][3] = m[Mat44::Tx + row];
+	}
+
+	float planeEquations[NUM_PLANES][4];
+	for (int component = 0; component < 4; ++component)
+	{
+		planeEquations[PLANE_LEFT][component] = rows[3][component] + rows[0][component];
+		planeEquations[PLANE_RIGHT][component] = rows[3][component] - rows[0][component];
+		planeEquations[PLANE_BOTTOM][component] = rows[3][component] + rows[1][component];
+		planeEquations[PLANE_TOP][component] = rows[3][component] - rows[1][component];
+		planeEquations[PLANE_NEAR][component] = rows[2][component];
+		planeEquations[PLANE_FAR][component] = rows[3][component] - rows[2][component];
+	}
+
+	Frustum frustum;
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; ++planeIndex)
+	{
+		float const* equation = planeEquations[planeIndex];
+		Vec3 normal(equation[0], equation[1], equation[2]);
+		float length = normal.GetLength();
+		GUARANTEE_OR_DIE(length > 0.f, "Frustum::MakeFromWorldToClip given a degenerate transform.");
+
+		// a*x + b*y + c*z + d >= 0 inside, so N.P >= -d / length
+		frustum.m_planes[planeIndex] = Plane3(normal / length, -equation[3] / length);
+	}
+	return frustum;
+}
+
+int Frustum::ClassifySphere(Vec3 const& center, float radius) const
+{
+	int result = 1;
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; ++planeIndex)
+	{
+		int side = ClassifySphereAgainstPlane3D(center, radius, m_planes[planeIndex]);
+		if (side < 0)
+		{
+			return -1;
+		}
+		if (side == 0)
+		{
+			result = 0;
+		}
+	}
+
+	if (m_maxDistance > 0.f)
+	{
+		float distance = (center - m_viewPosition).GetLength();
+		if (distance - radius > m_maxDistance)
+		{
+			return -1;
+		}
+		if (distance + radius > m_maxDistance)
+		{
+			result = 0;
+		}
+	}
+	return result;
+}
+
+int Frustum::ClassifyAABB(AABB3 const& box) const
+{
+	int result = 1;
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; ++planeIndex)
+	{
+		int side = ClassifyAABBAgainstPlane3D(box, m_planes[planeIndex]);
+		if (side < 0)
+		{
+			return -1;
+		}
+		if (side == 0)
+		{
+			result = 0;
+		}
+	}
+
+	if (m_maxDistance > 0.f)
+	{
+		if ((box.GetNearestPoint(m_viewPosition) - m_viewPosition).GetLengthSquared() > m_maxDistance * m_maxDistance)
+		{
+			return -1;
+		}
+		Vec3 farthestOffset;
+		farthestOffset.x = (fabsf(box.m_mins.x - m_viewPosition.x) > fabsf(box.m_maxs.x - m_viewPosition.x)) ? box.m_mins.x - m_viewPosition.x : box.m_maxs.x - m_viewPosition.x;
+		farthestOffset.y = (fabsf(box.m_mins.y - m_viewPosition.y) > fabsf(box.m_maxs.y - m_viewPosition.y)) ? box.m_mins.y - m_viewPosition.y : box.m_maxs.y - m_viewPosition.y;
+		farthestOffset.z = (fabsf(box.m_mins.z - m_viewPosition.z) > fabsf(box.m_maxs.z - m_viewPosition.z)) ? box.m_mins.z - m_viewPosition.z : box.m_maxs.z - m_viewPosition.z;
+		if (farthestOffset.GetLengthSquared() > m_maxDistance * m_maxDistance)
+		{
+			result = 0;
+		}
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+void CullingSet::Clear()
+{
+	m_bounds = BoundsArrays();
+	m_bvhBounds = BoundsArrays();
+	m_nodes.clear();
+	m_bvhOrder.clear();
+	m_isBVHBuilt = false;
+	m_isBVHStale = false;
+}
+
+void CullingSet::Reserve(int numObjects)
+{
+	m_bounds.m_centerX.reserve(numObjects);
+	m_bounds.m_centerY.reserve(numObjects);
+	m_bounds.m_centerZ.reserve(numObjects);
+	m_bounds.m_radius.reserve(numObjects);
+	m_bounds.m_extentX.reserve(numObjects);
+	m_bounds.m_extentY.reserve(numObjects);
+	m_bounds.m_extentZ.reserve(numObjects);
+}
+
+int CullingSet::AddSphere(Vec3 const& center, float radius)
+{
+	int objectIndex = GetNumObjects();
+	SetObject(objectIndex, center, radius, Vec3(radius, radius, radius));
+	return objectIndex;
+}
+
+int CullingSet::AddAABB(AABB3 const& box)
+{
+	int objectIndex = GetNumObjects();
+	SetAABB(objectIndex, box);
+	return objectIndex;
+}
+
+void CullingSet::SetSphere(int objectIndex, Vec3 const& center, float radius)
+{
+	SetObject(objectIndex, center, radius, Vec3(radius, radius, radius));
+}
+
+void CullingSet::SetAABB(int objectIndex, AABB3 const& box)
+{
+	Vec3 halfExtents = (box.m_maxs - box.m_mins) * 0.5f;
+	SetObject(objectIndex, box.GetCenter(), halfExtents.GetLength(), halfExtents);
+}
+
+void CullingSet::SetObject(int objectIndex, Vec3 const& center, float radius, Vec3 const& halfExtents)
+{
+	if (objectIndex == GetNumObjects())
+	{
+		m_bounds.m_centerX.push_back(center.x);
+		m_bounds.m_centerY.push_back(center.y);
+		m_bounds.m_centerZ.push_back(center.z);
+		m_bounds.m_radius.push_back(radius);
+		m_bounds.m_extentX.push_back(halfExtents.x);
+		m_bounds.m_extentY.push_back(halfExtents.y);
+		m_bounds.m_extentZ.push_back(halfExtents.z);
+
+		// New objects are not in the tree yet
+		m_isBVHBuilt = false;
+		return;
+	}
+
+	m_bounds.m_centerX[objectIndex] = center.x;
+	m_bounds.m_centerY[objectIndex] = center.y;
+	m_bounds.m_centerZ[objectIndex] = center.z;
+	m_bounds.m_radius[objectIndex] = radius;
+	m_bounds.m_extentX[objectIndex] = halfExtents.x;
+	m_bounds.m_extentY[objectIndex] = halfExtents.y;
+	m_bounds.m_extentZ[objectIndex] = halfExtents.z;
+	m_isBVHStale = m_isBVHBuilt;
+}
+
+//-----------------------------------------------------------------------------------------------
+int CullingSet::CullFlat(Frustum const& frustum, std::vector<int>& out_visibleIndexes, WorkerPool* workers /*= nullptr*/)
+{
+	PROFILE_SCOPE("CullingSet::CullFlat");
+	double startSeconds = GetCurrentTimeSeconds();
+
+	int numObjects = GetNumObjects();
+	int numThreads = workers ? workers->GetNumThreads() : 1;
+	int objectsPerTask = (numObjects + numThreads * TASKS_PER_THREAD - 1) / (numThreads * TASKS_PER_THREAD);
+	objectsPerTask = (objectsPerTask < MIN_OBJECTS_PER_FLAT_TASK) ? MIN_OBJECTS_PER_FLAT_TASK : ((objectsPerTask + 3) & ~3);
+	int numTasks = (numObjects + objectsPerTask - 1) / objectsPerTask;
+
+	unsigned int testMask = GetFullTestMask(frustum);
+	out_visibleIndexes.clear();
+	if (numTasks <= 1 || workers == nullptr)
+	{
+		CullRange(m_bounds, 0, numObjects, frustum, testMask, nullptr, out_visibleIndexes);
+	}
+	else
+	{
+		if (static_cast<int>(m_taskOutputs.size()) < numTasks)
+		{
+			m_taskOutputs.resize(numTasks);
+		}
+		workers->ParallelFor(numTasks, [&](int taskIndex)
+			{
+				TaskOutput& output = m_taskOutputs[taskIndex];
+				output.m_visibleIndexes.clear();
+				int firstObject = taskIndex * objectsPerTask;
+				int endObject = (firstObject + objectsPerTask < numObjects) ? firstObject + objectsPerTask : numObjects;
+				CullRange(m_bounds, firstObject, endObject, frustum, testMask, nullptr, output.m_visibleIndexes);
+			});
+		JoinTaskOutputs(numTasks, out_visibleIndexes);
+	}
+
+	m_lastStats = CullingStats();
+	m_lastStats.m_numObjects = numObjects;
+	m_lastStats.m_numVisible = static_cast<int>(out_visibleIndexes.size());
+	m_lastStats.m_numObjectsTested = numObjects;
+	m_lastStats.m_seconds = GetCurrentTimeSeconds() - startSeconds;
+	return m_lastStats.m_numVisible;
+}
+
+int CullingSet::CullHierarchical(Frustum const& frustum, std::vector<int>& out_visibleIndexes, WorkerPool* workers /*= nullptr*/)
+{
+	PROFILE_SCOPE("CullingSet::CullHierarchical");
+	double startSeconds = GetCurrentTimeSeconds();
+
+	out_visibleIndexes.clear();
+	m_lastStats = CullingStats();
+	m_lastStats.m_numObjects = GetNumObjects();
+	if (GetNumObjects() == 0)
+	{
+		return 0;
+	}
+
+	if (!m_isBVHBuilt)
+	{
+		BuildBVH(m_maxObjectsPerLeaf);
+	}
+	else if (m_isBVHStale)
+	{
+		GatherBVHOrderBounds();
+		RefitBVH();
+		m_isBVHStale = false;
+	}
+
+	m_tasks.clear();
+	CullTask rootTask;
+	rootTask.m_testMask = GetFullTestMask(frustum);
+	if (ClassifyNode(frustum, m_nodes[0], rootTask.m_testMask) >= 0)
+	{
+		m_tasks.push_back(rootTask);
+	}
+	int numNodesVisited = 1;
+
+	// Split straddling subtrees until every thread has a few tasks, keeping the BVH order
+	int numThreads = workers ? workers->GetNumThreads() : 1;
+	int targetNumTasks = (numThreads > 1) ? numThreads * TASKS_PER_THREAD : 1;
+	bool didSplit = true;
+	while (static_cast<int>(m_tasks.size()) < targetNumTasks && didSplit)
+	{
+		didSplit = false;
+		m_nextTasks.clear();
+		for (CullTask const& task : m_tasks)
+		{
+			BVHNode const& node = m_nodes[task.m_nodeIndex];
+			if (node.m_firstChild < 0 || task.m_testMask == 0)
+			{
+				m_nextTasks.push_back(task);
+				continue;
+			}
+
+			didSplit = true;
+			for (int childIndex = node.m_firstChild; childIndex <= node.m_firstChild + 1; ++childIndex)
+			{
+				CullTask childTask;
+				childTask.m_nodeIndex = childIndex;
+				childTask.m_testMask = task.m_testMask;
+				++numNodesVisited;
+				if (ClassifyNode(frustum, m_nodes[childIndex], childTask.m_testMask) >= 0)
+				{
+					m_nextTasks.push_back(childTask);
+				}
+			}
+		}
+		m_tasks.swap(m_nextTasks);
+	}
+
+	int numTasks = static_cast<int>(m_tasks.size());
+	if (static_cast<int>(m_taskOutputs.size()) < numTasks)
+	{
+		m_taskOutputs.resize(numTasks);
+	}
+	auto cullTask = [&](int taskIndex)
+		{
+			TaskOutput& output = m_taskOutputs[taskIndex];
+			output.m_visibleIndexes.clear();
+			output.m_numTested = 0;
+			output.m_numNodesVisited = 0;
+			CullNode(frustum, m_tasks[taskIndex], output);
+		};
+	if (workers)
+	{
+		workers->ParallelFor(numTasks, cullTask);
+	}
+	else
+	{
+		for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+		{
+			cullTask(taskIndex);
+		}
+	}
+	JoinTaskOutputs(numTasks, out_visibleIndexes);
+
+	for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+	{
+		m_lastStats.m_numObjectsTested += m_taskOutputs[taskIndex].m_numTested;
+		numNodesVisited += m_taskOutputs[taskIndex].m_numNodesVisited;
+	}
+	m_lastStats.m_numNodesVisited = numNodesVisited;
+	m_lastStats.m_numVisible = static_cast<int>(out_visibleIndexes.size());
+	m_lastStats.m_seconds = GetCurrentTimeSeconds() - startSeconds;
+	return m_lastStats.m_numVisible;
+}
+
+//-----------------------------------------------------------------------------------------------
+void CullingSet::BuildBVH(int maxObjectsPerLeaf /*= 16*/)
+{
+	PROFILE_SCOPE("CullingSet::BuildBVH");
+
+	m_maxObjectsPerLeaf = (maxObjectsPerLeaf < 1) ? 1 : maxObjectsPerLeaf;
+	int numObjects = GetNumObjects();
+	m_nodes.clear();
+	m_bvhOrder.resize(numObjects);
+	for (int objectIndex = 0; objectIndex < numObjects; ++objectIndex)
+	{
+		m_bvhOrder[objectIndex] = objectIndex;
+	}
+
+	if (numObjects > 0)
+	{
+		m_nodes.reserve(2 * (numObjects / m_maxObjectsPerLeaf) + 1);
+		m_nodes.emplace_back();
+		BuildNode(0, 0, numObjects);
+	}
+
+	GatherBVHOrderBounds();
+	RefitBVH();
+	m_isBVHBuilt = true;
+	m_isBVHStale = false;
+}
+
+void CullingSet::BuildNode(int nodeIndex, int firstObject, int numObjects)
+{
+	m_nodes[nodeIndex].m_firstObject = firstObject;
+	m_nodes[nodeIndex].m_numObjects = numObjects;
+	if (numObjects <= m_maxObjectsPerLeaf)
+	{
+		return;
+	}
+
+	// Split at the median center along the axis where the centers spread the most
+	std::vector<float> const* centers[3] = { &m_bounds.m_centerX, &m_bounds.m_centerY, &m_bounds.m_centerZ };
+	int splitAxis = 0;
+	float largestSpread = -1.f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float minCenter = (*centers[axis])[m_bvhOrder[firstObject]];
+		float maxCenter = minCenter;
+		for (int orderIndex = firstObject + 1; orderIndex < firstObject + numObjects; ++orderIndex)
+		{
+			float center = (*centers[axis])[m_bvhOrder[orderIndex]];
+			minCenter = (center < minCenter) ? center : minCenter;
+			maxCenter = (center > maxCenter) ? center : maxCenter;
+		}
+		if (maxCenter - minCenter > largestSpread)
+		{
+			largestSpread = maxCenter - minCenter;
+			splitAxis = axis;
+		}
+	}
+
+	std::vector<float> const& axisCenters = *centers[splitAxis];
+	int numLeftObjects = numObjects / 2;
+	auto first = m_bvhOrder.begin() + firstObject;
+	std::nth_element(first, first + numLeftObjects, first + numObjects, [&axisCenters](int a, int b) { return axisCenters[a] < axisCenters[b]; });
+
+	int firstChild = static_cast<int>(m_nodes.size());
+	m_nodes[nodeIndex].m_firstChild = firstChild;
+	m_nodes.resize(m_nodes.size() + 2);
+	BuildNode(firstChild, firstObject, numLeftObjects);
+	BuildNode(firstChild + 1, firstObject + numLeftObjects, numObjects - numLeftObjects);
+}
+
+void CullingSet::GatherBVHOrderBounds()
+{
+	int numObjects = static_cast<int>(m_bvhOrder.size());
+	std::vector<float> const* sources[7] = { &m_bounds.m_centerX, &m_bounds.m_centerY, &m_bounds.m_centerZ, &m_bounds.m_radius, &m_bounds.m_extentX, &m_bounds.m_extentY, &m_bounds.m_extentZ };
+	std::vector<float>* destinations[7] = { &m_bvhBounds.m_centerX, &m_bvhBounds.m_centerY, &m_bvhBounds.m_centerZ, &m_bvhBounds.m_radius, &m_bvhBounds.m_extentX, &m_bvhBounds.m_extentY, &m_bvhBounds.m_extentZ };
+	for (int arrayIndex = 0; arrayIndex < 7; ++arrayIndex)
+	{
+		std::vector<float> const& source = *sources[arrayIndex];
+		std::vector<float>& destination = *destinations[arrayIndex];
+		destination.resize(numObjects);
+		for (int orderIndex = 0; orderIndex < numObjects; ++orderIndex)
+		{
+			destination[orderIndex] = source[m_bvhOrder[orderIndex]];
+		}
+	}
+}
+
+void CullingSet::RefitBVH()
+{
+	// Children always come after their parent, so walking backwards fits children first
+	for (int nodeIndex = static_cast<int>(m_nodes.size()) - 1; nodeIndex >= 0; --nodeIndex)
+	{
+		BVHNode& node = m_nodes[nodeIndex];
+		if (node.m_firstChild >= 0)
+		{
+			BVHNode const& left = m_nodes[node.m_firstChild];
+			BVHNode const& right = m_nodes[node.m_firstChild + 1];
+			node.m_mins = Vec3(std::min(left.m_mins.x, right.m_mins.x), std::min(left.m_mins.y, right.m_mins.y), std::min(left.m_mins.z, right.m_mins.z));
+			node.m_maxs = Vec3(std::max(left.m_maxs.x, right.m_maxs.x), std::max(left.m_maxs.y, right.m_maxs.y), std::max(left.m_maxs.z, right.m_maxs.z));
+			continue;
+		}
+
+		node.m_mins = Vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+		node.m_maxs = Vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (int orderIndex = node.m_firstObject; orderIndex < node.m_firstObject + node.m_numObjects; ++orderIndex)
+		{
+			// Reach of whichever bound is larger along each axis, covering both sphere and box
+			float radius = m_bvhBounds.m_radius[orderIndex];
+			Vec3 center(m_bvhBounds.m_centerX[orderIndex], m_bvhBounds.m_centerY[orderIndex], m_bvhBounds.m_centerZ[orderIndex]);
+			Vec3 reach(std::max(radius, m_bvhBounds.m_extentX[orderIndex]), std::max(radius, m_bvhBounds.m_extentY[orderIndex]), std::max(radius, m_bvhBounds.m_extentZ[orderIndex]));
+			node.m_mins = Vec3(std::min(node.m_mins.x, center.x - reach.x), std::min(node.m_mins.y, center.y - reach.y), std::min(node.m_mins.z, center.z - reach.z));
+			node.m_maxs = Vec3(std::max(node.m_maxs.x, center.x + reach.x), std::max(node.m_maxs.y, center.y + reach.y), std::max(node.m_maxs.z, center.z + reach.z));
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+int CullingSet::ClassifyNode(Frustum const& frustum, BVHNode const& node, unsigned int& inout_testMask) const
+{
+	Vec3 center = (node.m_mins + node.m_maxs) * 0.5f;
+	Vec3 halfExtents = (node.m_maxs - node.m_mins) * 0.5f;
+
+	for (int planeIndex = 0; planeIndex < Frustum::NUM_PLANES; ++planeIndex)
+	{
+		unsigned int planeBit = 1u << planeIndex;
+		if ((inout_testMask & planeBit) == 0)
+		{
+			continue;
+		}
+
+		Plane3 const& plane = frustum.m_planes[planeIndex];
+		float altitude = plane.GetSignedDistanceToPoint(center);
+		float boxRadius = fabsf(plane.m_normal.x) * halfExtents.x + fabsf(plane.m_normal.y) * halfExtents.y + fabsf(plane.m_normal.z) * halfExtents.z;
+		if (altitude < -boxRadius)
+		{
+			return -1;
+		}
+		if (altitude >= boxRadius)
+		{
+			inout_testMask &= ~planeBit;
+		}
+	}
+
+	if (inout_testMask & DISTANCE_TEST_BIT)
+	{
+		Vec3 const& view = frustum.m_viewPosition;
+		Vec3 nearestOffset(GetClamped(view.x, node.m_mins.x, node.m_maxs.x) - view.x, GetClamped(view.y, node.m_mins.y, node.m_maxs.y) - view.y, GetClamped(view.z, node.m_mins.z, node.m_maxs.z) - view.z);
+		float maxDistanceSquared = frustum.m_maxDistance * frustum.m_maxDistance;
+		if (nearestOffset.GetLengthSquared() > maxDistanceSquared)
+		{
+			return -1;
+		}
+		Vec3 farthestOffset(std::max(fabsf(node.m_mins.x - view.x), fabsf(node.m_maxs.x - view.x)), std::max(fabsf(node.m_mins.y - view.y), fabsf(node.m_maxs.y - view.y)),
+			std::max(fabsf(node.m_mins.z - view.z), fabsf(node.m_maxs.z - view.z)));
+		if (farthestOffset.GetLengthSquared() <= maxDistanceSquared)
+		{
+			inout_testMask &= ~DISTANCE_TEST_BIT;
+		}
+	}
+	return (inout_testMask == 0) ? 1 : 0;
+}
+
+void CullingSet::CullNode(Frustum const& frustum, CullTask const& task, TaskOutput& output) const
+{
+	BVHNode const& node = m_nodes[task.m_nodeIndex];
+	if (task.m_testMask == 0)
+	{
+		output.m_visibleIndexes.insert(output.m_visibleIndexes.end(), m_bvhOrder.begin() + node.m_firstObject, m_bvhOrder.begin() + node.m_firstObject + node.m_numObjects);
+		return;
+	}
+	if (node.m_firstChild < 0)
+	{
+		CullRange(m_bvhBounds, node.m_firstObject, node.m_firstObject + node.m_numObjects, frustum, task.m_testMask, m_bvhOrder.data(), output.m_visibleIndexes);
+		output.m_numTested += node.m_numObjects;
+		return;
+	}
+
+	for (int childIndex = node.m_firstChild; childIndex <= node.m_firstChild + 1; ++childIndex)
+	{
+		CullTask childTask;
+		childTask.m_nodeIndex = childIndex;
+		childTask.m_testMask = task.m_testMask;
+		++output.m_numNodesVisited;
+		if (ClassifyNode(frustum, m_nodes[childIndex], childTask.m_testMask) >= 0)
+		{
+			CullNode(frustum, childTask, output);
+		}
+	}
+}
+
+void CullingSet::JoinTaskOutputs(int numTasks, std::vector<int>& out_visibleIndexes)
+{
+	size_t numVisible = 0;
+	for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+	{
+		numVisible += m_taskOutputs[taskIndex].m_visibleIndexes.size();
+	}
+	out_visibleIndexes.reserve(numVisible);
+	for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+	{
+		std::vector<int> const& taskVisible = m_taskOutputs[taskIndex].m_visibleIndexes;
+		out_visibleIndexes.insert(out_visibleIndexes.end(), taskVisible.begin(), taskVisible.end());
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string CullingBenchmarkResult::ToString() const
+{
+	return Stringf("%d objects, %d visible, %d threads. Objects culled per ms: reference %.0f, flat %.0f, flat parallel %.0f, hierarchical %.0f, hierarchical parallel %.0f",
+		m_numObjects, m_numVisible, m_numThreads, m_referenceObjectsPerMs, m_flatObjectsPerMs, m_flatParallelObjectsPerMs, m_hierarchicalObjectsPerMs, m_hierarchicalParallelObjectsPerMs);
+}
+
+CullingBenchmarkResult RunCullingBenchmark(int numObjects, int numIterations, WorkerPool* workers)
+{
+	RandomNumberGenerator rng;
+	CullingSet cullingSet;
+	cullingSet.Reserve(numObjects);
+	std::vector<Vec3> centers;
+	std::vector<float> radii;
+	centers.reserve(numObjects);
+	radii.reserve(numObjects);
+	for (int objectIndex = 0; objectIndex < numObjects; ++objectIndex)
+	{
+		Vec3 center(rng.RollRandomFloatInRange(-500.f, 500.f), rng.RollRandomFloatInRange(-500.f, 500.f), rng.RollRandomFloatInRange(-100.f, 100.f));
+		if (objectIndex % 2 == 0)
+		{
+			float radius = rng.RollRandomFloatInRange(0.5f, 5.f);
+			cullingSet.AddSphere(center, radius);
+			radii.push_back(radius);
+		}
+		else
+		{
+			Vec3 halfExtents(rng.RollRandomFloatInRange(0.5f, 5.f), rng.RollRandomFloatInRange(0.5f, 5.f), rng.RollRandomFloatInRange(0.5f, 5.f));
+			cullingSet.AddAABB(AABB3(center - halfExtents, center + halfExtents));
+			radii.push_back(halfExtents.GetLength());
+		}
+		centers.push_back(center);
+	}
+
+	Camera camera;
+	camera.SetPerspectiveView(16.f / 9.f, 60.f, 0.1f, 1000.f);
+	camera.SetCameraToRenderTransform(Mat44::DIRECTX_C2R);
+	camera.SetPositionAndOrientation(Vec3(-200.f, 0.f, 10.f), EulerAngles(20.f, 0.f, 0.f));
+	Frustum frustum = Frustum::MakeFromCamera(camera, 600.f);
+
+	CullingBenchmarkResult result;
+	result.m_numObjects = numObjects;
+	result.m_numThreads = workers ? workers->GetNumThreads() : 1;
+	numIterations = (numIterations < 1) ? 1 : numIterations;
+	double numObjectsCulled = static_cast<double>(numObjects) * numIterations;
+	std::vector<int> visibleIndexes;
+	visibleIndexes.reserve(numObjects);
+
+	auto timeObjectsPerMs = [&](auto const& cullOnce)
+		{
+			cullOnce();
+			double startSeconds = GetCurrentTimeSeconds();
+			for (int iteration = 0; iteration < numIterations; ++iteration)
+			{
+				cullOnce();
+			}
+			double milliseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+			return (milliseconds > 0.0) ? numObjectsCulled / milliseconds : 0.0;
+		};
+
+	result.m_referenceObjectsPerMs = timeObjectsPerMs([&]()
+		{
+			visibleIndexes.clear();
+			for (int objectIndex = 0; objectIndex < numObjects; ++objectIndex)
+			{
+				if (frustum.ClassifySphere(centers[objectIndex], radii[objectIndex]) >= 0)
+				{
+					visibleIndexes.push_back(objectIndex);
+				}
+			}
+		});
+	result.m_flatObjectsPerMs = timeObjectsPerMs([&]() { cullingSet.CullFlat(frustum, visibleIndexes); });
+	result.m_numVisible = static_cast<int>(visibleIndexes.size());
+	result.m_flatParallelObjectsPerMs = timeObjectsPerMs([&]() { cullingSet.CullFlat(frustum, visibleIndexes, workers); });
+	result.m_hierarchicalObjectsPerMs = timeObjectsPerMs([&]() { cullingSet.CullHierarchical(frustum, visibleIndexes); });
+	result.m_hierarchicalParallelObjectsPerMs = timeObjectsPerMs([&]() { cullingSet.CullHierarchical(frustum, visibleIndexes, workers); });
+	return result;
+}
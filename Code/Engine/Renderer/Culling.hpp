@@ -0,0 +1,170 @@
+#pragma once
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/Plane3.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <string>
+#include <vector>
+
+class Camera;
+class WorkerPool;
+
+//-----------------------------------------------------------------------------------------------
+// Six world space planes facing into the view volume, plus an optional spherical max distance.
+//
+// Classify functions follow ClassifyAABBAgainstPlane3D: 1 fully inside, 0 straddling, -1 outside.
+//
+struct Frustum
+{
+	enum
+	{
+		PLANE_LEFT,
+		PLANE_RIGHT,
+		PLANE_BOTTOM,
+		PLANE_TOP,
+		PLANE_NEAR,
+		PLANE_FAR,
+		NUM_PLANES
+	};
+	static constexpr unsigned int ALL_PLANES_MASK = (1u << NUM_PLANES) - 1;
+
+	Plane3	m_planes[NUM_PLANES];
+	Vec3	m_viewPosition;
+	float	m_maxDistance = 0.f;	// <= 0 turns the distance test off
+
+	// Planes come from the camera's world to clip transform (D3D clip space, 0 <= z <= w)
+	static Frustum MakeFromCamera(Camera const& camera, float maxDistance = 0.f);
+	static Frustum MakeFromWorldToClip(Mat44 const& worldToClipTransform);
+
+	int ClassifySphere(Vec3 const& center, float radius) const;
+	int ClassifyAABB(AABB3 const& box) const;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct CullingStats
+{
+	int		m_numObjects = 0;
+	int		m_numVisible = 0;
+	int		m_numObjectsTested = 0;		// objects that went through the plane tests
+	int		m_numNodesVisited = 0;		// hierarchical culling only
+	double	m_seconds = 0.0;
+};
+
+//-----------------------------------------------------------------------------------------------
+// Bounding volumes of many objects, culled against a Frustum into a list of visible indexes.
+//
+// Every object has a center, a bounding sphere radius and AABB half extents, both kept in flat
+// per-component arrays. Both bounds enclose the object, so it is culled by a plane as soon as either
+// one is fully behind it: an AddAABB object is culled as tightly as its box and an AddSphere object
+// as its sphere. Groups of four objects are tested with SSE where available.
+//
+// CullFlat tests every object. CullHierarchical walks a BVH over the objects, skips whole
+// subtrees outside a plane and stops testing planes a subtree is fully inside; the BVH is built
+// on first use and refitted after objects move, call BuildBVH again after many objects moved far.
+// Both take an optional WorkerPool, output is the same with or without it.
+//
+class CullingSet
+{
+public:
+	void Clear();
+	void Reserve(int numObjects);
+
+	// Return the object index, stable until Clear
+	int AddSphere(Vec3 const& center, float radius);
+	int AddAABB(AABB3 const& box);
+	void SetSphere(int objectIndex, Vec3 const& center, float radius);
+	void SetAABB(int objectIndex, AABB3 const& box);
+
+	// Visible indexes ascending. Returns the number of visible objects
+	int CullFlat(Frustum const& frustum, std::vector<int>& out_visibleIndexes, WorkerPool* workers = nullptr);
+	// Visible indexes in BVH order, which keeps neighbours in space together
+	int CullHierarchical(Frustum const& frustum, std::vector<int>& out_visibleIndexes, WorkerPool* workers = nullptr);
+
+	void BuildBVH(int maxObjectsPerLeaf = 16);
+
+	int GetNumObjects() const { return static_cast<int>(m_bounds.m_centerX.size()); }
+	int GetNumBVHNodes() const { return static_cast<int>(m_nodes.size()); }
+	CullingStats const& GetLastStats() const { return m_lastStats; }
+
+protected:
+	// Flat arrays of one object order, either the add order or the BVH leaf order
+	struct BoundsArrays
+	{
+		std::vector<float> m_centerX;
+		std::vector<float> m_centerY;
+		std::vector<float> m_centerZ;
+		std::vector<float> m_radius;
+		std::vector<float> m_extentX;
+		std::vector<float> m_extentY;
+		std::vector<float> m_extentZ;
+	};
+
+	// Bounds hold each object's sphere and box, so a node outside a plane culls every object in it
+	struct BVHNode
+	{
+		Vec3	m_mins;
+		Vec3	m_maxs;
+		int		m_firstChild = -1;	// children are m_firstChild and m_firstChild + 1, -1 for a leaf
+		int		m_firstObject = 0;	// the subtree's objects, a range of m_bvhOrder
+		int		m_numObjects = 0;
+	};
+
+	// A node already known to be at least partly visible, with the planes it still straddles
+	struct CullTask
+	{
+		int				m_nodeIndex = 0;
+		unsigned int	m_testMask = 0;
+	};
+
+	struct TaskOutput
+	{
+		std::vector<int>	m_visibleIndexes;
+		int					m_numTested = 0;
+		int					m_numNodesVisited = 0;
+	};
+
+	void SetObject(int objectIndex, Vec3 const& center, float radius, Vec3 const& halfExtents);
+	void BuildNode(int nodeIndex, int firstObject, int numObjects);
+	void GatherBVHOrderBounds();
+	void RefitBVH();
+	int ClassifyNode(Frustum const& frustum, BVHNode const& node, unsigned int& inout_testMask) const;
+	void CullNode(Frustum const& frustum, CullTask const& task, TaskOutput& output) const;
+	void JoinTaskOutputs(int numTasks, std::vector<int>& out_visibleIndexes);
+
+protected:
+	BoundsArrays			m_bounds;
+
+	// BVH over the objects. m_bvhBounds holds the same bounds permuted into m_bvhOrder, so every
+	// leaf is a contiguous range of the flat arrays
+	std::vector<BVHNode>	m_nodes;
+	std::vector<int>		m_bvhOrder;
+	BoundsArrays			m_bvhBounds;
+	int						m_maxObjectsPerLeaf = 16;
+	bool					m_isBVHBuilt = false;
+	bool					m_isBVHStale = false;
+
+	// Joined in task order, so the output does not depend on which thread ran what
+	std::vector<TaskOutput>	m_taskOutputs;
+	std::vector<CullTask>	m_tasks;
+	std::vector<CullTask>	m_nextTasks;
+	CullingStats			m_lastStats;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct CullingBenchmarkResult
+{
+	int		m_numObjects = 0;
+	int		m_numVisible = 0;
+	int		m_numThreads = 1;
+	double	m_referenceObjectsPerMs = 0.0;		// one Frustum::ClassifySphere call per object
+	double	m_flatObjectsPerMs = 0.0;
+	double	m_flatParallelObjectsPerMs = 0.0;
+	double	m_hierarchicalObjectsPerMs = 0.0;
+	double	m_hierarchicalParallelObjectsPerMs = 0.0;
+
+	std::string ToString() const;
+};
+
+// Scatters numObjects random boxes and spheres around a perspective camera and times every
+// culling path. workers may be nullptr, the parallel numbers then match the serial ones
+CullingBenchmarkResult RunCullingBenchmark(int numObjects, int numIterations, WorkerPool* workers);
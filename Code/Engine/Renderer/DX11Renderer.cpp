@@ -5,6 +5,7 @@
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
@@ -14,6 +15,7 @@
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Window/Window.hpp"
 #include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/TextureCook.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Renderer/Camera.hpp"
@@ -97,6 +99,7 @@ void DX11Renderer::Startup()
 
 void DX11Renderer::BeginFrame()
 {
+	PROFILE_SCOPE("Renderer::BeginFrame");
 	// Set render target
 	m_deviceContext->OMSetRenderTargets(1, &m_renderTargetView, m_depthStencilDSV);
 	ImGuiBeginFrame();
@@ -104,6 +107,7 @@ void DX11Renderer::BeginFrame()
 
 void DX11Renderer::EndFrame()
 {
+	PROFILE_SCOPE("Renderer::EndFrame");
 	ImGuiEndFrame();
 	// Present
 	HRESULT hr;
@@ -146,6 +150,8 @@ void DX11Renderer::Shutdown()
 	m_immediateVBO = nullptr;
 	delete m_immediateIBO;
 	m_immediateIBO = nullptr;
+	delete m_instanceVBO;
+	m_instanceVBO = nullptr;
 	delete m_cameraCBO;
 	m_cameraCBO = nullptr;
 	delete m_modelCBO;
@@ -251,6 +257,7 @@ void DX11Renderer::EndCamera(Camera const& camera)
 
 void DX11Renderer::DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes)
 {
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
 	m_immediateVBO->m_stride = sizeof(Vertex_PCU);
 	CopyCPUToGPU(vertexes, numVertexes * m_immediateVBO->GetStride(), m_immediateVBO);
 	DrawVertexBuffer(m_immediateVBO, numVertexes);
@@ -258,6 +265,7 @@ void DX11Renderer::DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes)
 
 void DX11Renderer::DrawVertexArray(std::vector<Vertex_PCU> const& verts)
 {
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
 	m_immediateVBO->m_stride = sizeof(Vertex_PCU);
 	CopyCPUToGPU(verts.data(), static_cast<unsigned int>(verts.size()) * m_immediateVBO->GetStride(), m_immediateVBO);
 	DrawVertexBuffer(m_immediateVBO, static_cast<unsigned int>(verts.size()));
@@ -266,6 +274,7 @@ void DX11Renderer::DrawVertexArray(std::vector<Vertex_PCU> const& verts)
 
 void DX11Renderer::DrawVertexArray(std::vector<Vertex_PCUTBN> const& verts)
 {
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
 	m_immediateVBO->m_stride = sizeof(Vertex_PCUTBN);
 	CopyCPUToGPU(verts.data(), static_cast<unsigned int>(verts.size()) * m_immediateVBO->GetStride(), m_immediateVBO);
 	DrawVertexBuffer(m_immediateVBO, static_cast<unsigned int>(verts.size()));
@@ -273,6 +282,7 @@ void DX11Renderer::DrawVertexArray(std::vector<Vertex_PCUTBN> const& verts)
 
 void DX11Renderer::DrawIndexedVertexArray(std::vector<Vertex_PCU> const& verts, std::vector<unsigned int> const& indexes)
 {
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexArray");
 	m_immediateVBO->m_stride = sizeof(Vertex_PCU);
 	CopyCPUToGPU(verts.data(), static_cast<unsigned int>(verts.size()) * m_immediateVBO->GetStride(), m_immediateVBO);
 	CopyCPUToGPU(indexes.data(), static_cast<unsigned int>(indexes.size()) * m_immediateIBO->GetStride(), m_immediateIBO);
@@ -281,6 +291,7 @@ void DX11Renderer::DrawIndexedVertexArray(std::vector<Vertex_PCU> const& verts,
 
 void DX11Renderer::DrawIndexedVertexArray(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indexes)
 {
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexArray");
 	m_immediateVBO->m_stride = sizeof(Vertex_PCUTBN);
 	CopyCPUToGPU(verts.data(), static_cast<unsigned int>(verts.size()) * m_immediateVBO->GetStride(), m_immediateVBO);
 	CopyCPUToGPU(indexes.data(), static_cast<unsigned int>(indexes.size()) * m_immediateIBO->GetStride(), m_immediateIBO);
@@ -301,6 +312,26 @@ Texture* DX11Renderer::CreateOrGetTextureFromFile(char const* imageFilePath)
 	return newTexture;
 }
 
+Texture* DX11Renderer::CreateOrGetTextureFromImage(Image const& image)
+{
+	Texture* existingTexture = GetTextureForFileName(image.GetImageFilePath().c_str());
+	if (existingTexture)
+	{
+		return existingTexture;
+	}
+	return CreateTextureFromImage(image);
+}
+
+Texture* DX11Renderer::CreateOrGetTextureFromCooked(CookedTexture const& cooked)
+{
+	Texture* existingTexture = GetTextureForFileName(cooked.m_name.c_str());
+	if (existingTexture)
+	{
+		return existingTexture;
+	}
+	return CreateTextureFromCooked(cooked);
+}
+
 Texture* DX11Renderer::CreateOrGetTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config)
 {
 	// See if we already have this texture previously loaded
@@ -346,6 +377,16 @@ BitmapFont* DX11Renderer::CreateOrGetBitmapFont(char const* bitmapFontFilePathWi
 	return newBitmapFont;
 }
 
+BitmapFont* DX11Renderer::CreateOrGetSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config /*= SDFFontConfig()*/)
+{
+	BitmapFont* existingSDFFont = GetBitmapFont(bitmapFontFilePathWithNoExtension, true);
+	if (existingSDFFont)
+	{
+		return existingSDFFont;
+	}
+	return CreateSDFFont(bitmapFontFilePathWithNoExtension, config);
+}
+
 Shader* DX11Renderer::CreateOrGetShader(char const* shaderName, VertexType type /*= VertexType::VERTEX_PCU*/)
 {
 	Shader* existingShader = GetShader(shaderName);
@@ -440,6 +481,50 @@ Texture* DX11Renderer::CreateTextureFromImage(Image const& image)
 	return newTexture;
 }
 
+Texture* DX11Renderer::CreateTextureFromCooked(CookedTexture const& cooked)
+{
+	GUARANTEE_OR_DIE(!cooked.m_mips.empty(), Stringf("CreateTextureFromCooked: \"%s\" has no mips", cooked.m_name.c_str()));
+
+	Texture* newTexture = new Texture();
+	newTexture->m_name = cooked.m_name;
+	newTexture->m_dimensions = cooked.m_dimensions;
+
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = cooked.m_dimensions.x;
+	textureDesc.Height = cooked.m_dimensions.y;
+	textureDesc.MipLevels = static_cast<UINT>(cooked.m_mips.size());
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = cooked.m_format;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	// Straight from the cooked bytes, SysMemPitch is a row of 4x4 blocks for BC formats
+	std::vector<D3D11_SUBRESOURCE_DATA> mipData(cooked.m_mips.size());
+	for (size_t mipIndex = 0; mipIndex < cooked.m_mips.size(); ++mipIndex)
+	{
+		mipData[mipIndex].pSysMem = cooked.m_data.data() + cooked.m_mips[mipIndex].m_dataOffset;
+		mipData[mipIndex].SysMemPitch = cooked.m_mips[mipIndex].m_rowPitch;
+		mipData[mipIndex].SysMemSlicePitch = static_cast<UINT>(cooked.m_mips[mipIndex].m_numBytes);
+	}
+
+	HRESULT hr;
+	hr = m_device->CreateTexture2D(&textureDesc, mipData.data(), &newTexture->m_texture);
+	if (!SUCCEEDED(hr))
+	{
+		ERROR_AND_DIE(Stringf("CreateTextureFromCooked failed for \"%s\".", cooked.m_name.c_str()));
+	}
+
+	hr = m_device->CreateShaderResourceView(newTexture->m_texture, NULL, &newTexture->m_shaderResourceView);
+	if (!SUCCEEDED(hr))
+	{
+		ERROR_AND_DIE(Stringf("CreateShaderResourceView failed for \"%s\".", cooked.m_name.c_str()));
+	}
+
+	m_loadedTextures.push_back(newTexture);
+	return newTexture;
+}
+
 Texture* DX11Renderer::CreateTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config)
 {
 	Image images[6] = {
@@ -509,11 +594,11 @@ Texture* DX11Renderer::CreateTextureCubeFromSixFaces(TextureCubeSixFacesConfig c
 	return newTexture;
 }
 
-BitmapFont* DX11Renderer::GetBitmapFont(char const* bitmapFontFilePathWithNoExtension)
+BitmapFont* DX11Renderer::GetBitmapFont(char const* bitmapFontFilePathWithNoExtension, bool isSDF /*= false*/)
 {
 	for (int i = 0; i < static_cast<int>(m_loadedFonts.size()); ++i)
 	{
-		if (m_loadedFonts[i]->m_fontFilePathNameWithNoExtension == bitmapFontFilePathWithNoExtension)
+		if (m_loadedFonts[i]->m_fontFilePathNameWithNoExtension == bitmapFontFilePathWithNoExtension && m_loadedFonts[i]->IsSDF() == isSDF)
 		{
 			return m_loadedFonts[i];
 		}
@@ -531,6 +616,17 @@ BitmapFont* DX11Renderer::CreateBitmapFont(char const* bitmapFontFilePathWithNoE
 	return newFont;
 }
 
+BitmapFont* DX11Renderer::CreateSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config)
+{
+	std::string imageFilePath(bitmapFontFilePathWithNoExtension);
+	imageFilePath += ".png";
+	SDFFontAtlas atlas = GenerateSDFFontAtlas(Image(imageFilePath.c_str()), config);
+	Texture* atlasTexture = CreateTextureFromImage(atlas.m_image);
+	BitmapFont* newFont = new BitmapFont(bitmapFontFilePathWithNoExtension, *atlasTexture, atlas);
+	m_loadedFonts.push_back(newFont);
+	return newFont;
+}
+
 Shader* DX11Renderer::GetShader(char const* shaderName)
 {
 	for (int i = 0; i < static_cast<int>(m_loadedShaders.size()); ++i)
@@ -728,6 +824,36 @@ ID3D11InputLayout* DX11Renderer::CreateInputLayout(std::vector<unsigned char> co
 		return result;
 	}
 
+	else if (type == VertexType::VERTEX_PCU_INSTANCED)
+	{
+		// Slot 1 steps once per instance, the Mat44 goes in as its four basis columns
+		D3D11_INPUT_ELEMENT_DESC inputElementDesc[] = {
+			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"INSTANCE_TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+			{"INSTANCE_TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+			{"INSTANCE_TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+			{"INSTANCE_TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+			{"INSTANCE_COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		};
+
+		ID3D11InputLayout* result;
+		UINT numElements = ARRAYSIZE(inputElementDesc);
+		HRESULT hr;
+		hr = m_device->CreateInputLayout(
+			inputElementDesc, numElements,
+			byteCode.data(),
+			byteCode.size(),
+			&result
+		);
+		if (!SUCCEEDED(hr))
+		{
+			ERROR_AND_DIE("Could not create input layout.");
+		}
+		return result;
+	}
+
 	ERROR_AND_DIE("Could not create vertex layout. Not supported VertexType");
 }
 
@@ -941,6 +1067,14 @@ void DX11Renderer::BindVertexBuffer(VertexBuffer* vbo)
 	m_deviceContext->IASetVertexBuffers(0, 1, &vbo->m_buffer, &stride, &startOffset);
 }
 
+void DX11Renderer::BindVertexBufferWithInstances(VertexBuffer* vbo)
+{
+	ID3D11Buffer* buffers[2] = { vbo->m_buffer, m_instanceVBO->m_buffer };
+	UINT strides[2] = { vbo->GetStride(), m_instanceVBO->GetStride() };
+	UINT startOffsets[2] = { 0, 0 };
+	m_deviceContext->IASetVertexBuffers(0, 2, buffers, strides, startOffsets);
+}
+
 void DX11Renderer::BindIndexBuffer(IndexBuffer* ibo)
 {
 	m_deviceContext->IASetIndexBuffer(ibo->m_buffer, DXGI_FORMAT_R32_UINT, 0); // unsigned int 4 byte
@@ -948,6 +1082,7 @@ void DX11Renderer::BindIndexBuffer(IndexBuffer* ibo)
 
 void DX11Renderer::DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount)
 {
+	PROFILE_SCOPE("Renderer::DrawVertexBuffer");
 	BindVertexBuffer(vbo);
 	BindPrimitiveTopology();
 
@@ -957,6 +1092,7 @@ void DX11Renderer::DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount)
 
 void DX11Renderer::DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount)
 {
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexBuffer");
 	BindVertexBuffer(vbo);
 	BindIndexBuffer(ibo);
 	BindPrimitiveTopology();
@@ -965,6 +1101,35 @@ void DX11Renderer::DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo,
 	m_deviceContext->DrawIndexed(indexCount, 0, 0);
 }
 
+void DX11Renderer::SetInstanceData(int numInstances, InstanceData const* instances)
+{
+	CopyCPUToGPU(instances, static_cast<unsigned int>(numInstances * sizeof(InstanceData)), m_instanceVBO);
+	m_numUploadedInstances = numInstances;
+}
+
+void DX11Renderer::DrawVertexBufferInstanced(VertexBuffer* vbo, unsigned int vertexCount, int numInstances)
+{
+	PROFILE_SCOPE("Renderer::DrawVertexBufferInstanced");
+	GUARANTEE_RECOVERABLE(numInstances <= m_numUploadedInstances, "Drawing more instances than SetInstanceData uploaded.");
+	BindVertexBufferWithInstances(vbo);
+	BindPrimitiveTopology();
+
+	SetStatesIfChanged();
+	m_deviceContext->DrawInstanced(vertexCount, static_cast<UINT>(numInstances), 0, 0);
+}
+
+void DX11Renderer::DrawIndexedVertexBufferInstanced(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount, int numInstances)
+{
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexBufferInstanced");
+	GUARANTEE_RECOVERABLE(numInstances <= m_numUploadedInstances, "Drawing more instances than SetInstanceData uploaded.");
+	BindVertexBufferWithInstances(vbo);
+	BindIndexBuffer(ibo);
+	BindPrimitiveTopology();
+
+	SetStatesIfChanged();
+	m_deviceContext->DrawIndexedInstanced(indexCount, static_cast<UINT>(numInstances), 0, 0, 0);
+}
+
 //-----------------------------------------------------------------------------------------------
 // Renderer Startup
 //-----------------------------------------------------------------------------------------------
@@ -1058,6 +1223,10 @@ void DX11Renderer::CreateDefaultShaderAndTexture()
 	//-----------------------------------------------------------------------------------------------
 	m_defaultShader = CreateShader("Default", g_defaultShaderSource);
 	BindShader(m_defaultShader);
+	// CreateOrGetShader("DefaultInstanced", VertexType::VERTEX_PCU_INSTANCED) finds it by name
+	CreateShader("DefaultInstanced", g_defaultInstancedShaderSource, VertexType::VERTEX_PCU_INSTANCED);
+	// Bound by name for BitmapFont::IsSDF() fonts
+	CreateShader(SDF_TEXT_SHADER_NAME, g_sdfTextShaderSource);
 
 	//-----------------------------------------------------------------------------------------------
 	m_defaultTexture = CreateTextureFromImage(Image(IntVec2(2, 2), Rgba8::OPAQUE_WHITE, "DefaultDiffuse"));
@@ -1075,6 +1244,7 @@ void DX11Renderer::CreateBuffers()
 {
 	m_immediateVBO = CreateVertexBuffer(1 * sizeof(Vertex_PCU), sizeof(Vertex_PCU));
 	m_immediateIBO = CreateIndexBuffer(1 * sizeof(unsigned int));
+	m_instanceVBO = CreateVertexBuffer(64 * sizeof(InstanceData), sizeof(InstanceData));
 	m_engineCBO = CreateConstantBuffer(sizeof(EngineConstants));
 	m_perFrameCBO = CreateConstantBuffer(sizeof(PerFrameConstants));
 	m_lightCBO = CreateConstantBuffer(sizeof(LightConstants));
@@ -58,8 +58,13 @@ public:
 	void DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount) override;
 	void DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount) override;
 
+	void SetInstanceData(int numInstances, InstanceData const* instances) override;
+	void DrawVertexBufferInstanced(VertexBuffer* vbo, unsigned int vertexCount, int numInstances) override;
+	void DrawIndexedVertexBufferInstanced(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount, int numInstances) override;
+
 protected:
 	void BindVertexBuffer(VertexBuffer* vbo);
+	void BindVertexBufferWithInstances(VertexBuffer* vbo);
 	void BindIndexBuffer(IndexBuffer* ibo);
 	void BindPrimitiveTopology();
 
@@ -96,9 +101,12 @@ public:
 	// Manage Resources - Public
 	//-----------------------------------------------------------------------------------------------
 	Texture* CreateOrGetTextureFromFile(char const* imageFilePath) override;
+	Texture* CreateOrGetTextureFromImage(Image const& image) override;
+	Texture* CreateOrGetTextureFromCooked(CookedTexture const& cooked) override;
 	Texture* CreateOrGetTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config) override;
 
 	BitmapFont* CreateOrGetBitmapFont(char const* bitmapFontFilePathWithNoExtension) override;
+	BitmapFont* CreateOrGetSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config = SDFFontConfig()) override;
 
 	Shader* CreateOrGetShader(char const* shaderName, VertexType type = VertexType::VERTEX_PCU) override;
 
@@ -113,10 +121,12 @@ protected:
 	Texture* GetTextureForFileName(char const* imageFilePath);
 	Texture* CreateTextureFromFile(char const* imageFilePath);
 	Texture* CreateTextureFromImage(Image const& image);
+	Texture* CreateTextureFromCooked(CookedTexture const& cooked);
 	Texture* CreateTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config);
 
-	BitmapFont* GetBitmapFont(char const* bitmapFontFilePathWithNoExtension);
+	BitmapFont* GetBitmapFont(char const* bitmapFontFilePathWithNoExtension, bool isSDF = false);
 	BitmapFont* CreateBitmapFont(char const* bitmapFontFilePathWithNoExtension);
+	BitmapFont* CreateSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config);
 
 	Shader* GetShader(char const* shaderName);
 	Shader* CreateShader(char const* shaderName, VertexType type = VertexType::VERTEX_PCU);
@@ -175,6 +185,8 @@ protected:
 
 	VertexBuffer* m_immediateVBO = nullptr;
 	IndexBuffer* m_immediateIBO = nullptr;
+	VertexBuffer* m_instanceVBO = nullptr; // second vertex stream of instanced draws
+	int m_numUploadedInstances = 0;
 
 	ConstantBuffer* m_engineCBO = nullptr;
 	ConstantBuffer* m_perFrameCBO = nullptr;
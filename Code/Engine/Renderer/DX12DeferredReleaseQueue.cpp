@@ -6,31 +6,14 @@
 
 DX12DeferredReleaseQueue::~DX12DeferredReleaseQueue()
 {
-	for (DeferredReleaseItem& item : m_queue)
-	{
-		if (item.type == DeferredReleaseType::Resource)
-		{
-			if (item.resource)
-			{
-				item.resource->Release();
-			}
-		}
-		else if (item.type == DeferredReleaseType::Descriptor)
-		{
-			if (item.heap && item.index != uint32_t(-1))
-			{
-				item.heap->FreePersistent(item.index);
-			}
-		}
-	}
-	m_queue.clear();
+	m_queue.ReleaseAll(ReleaseItem);
 }
 
 void DX12DeferredReleaseQueue::EnqueueResource(uint64_t fenceValue, IUnknown* resource)
 {
 	if (resource)
 	{
-		m_queue.emplace_back(fenceValue, resource);
+		m_queue.Enqueue(fenceValue, DeferredReleaseItem(resource));
 	}
 }
 
@@ -38,38 +21,30 @@ void DX12DeferredReleaseQueue::EnqueueDescriptor(uint64_t fenceValue, DX12Descri
 {
 	if (heap && index != uint32_t(-1))
 	{
-		m_queue.emplace_back(fenceValue, heap, index);
+		m_queue.Enqueue(fenceValue, DeferredReleaseItem(heap, index));
 	}
 }
 
 void DX12DeferredReleaseQueue::Process(uint64_t completedFenceValue)
 {
-	auto it = m_queue.begin();
-	while (it != m_queue.end())
+	m_queue.Process(completedFenceValue, ReleaseItem);
+}
+
+void DX12DeferredReleaseQueue::ReleaseItem(DeferredReleaseItem& item)
+{
+	if (item.type == DeferredReleaseType::Resource)
 	{
-		if (it->fenceValue <= completedFenceValue)
+		if (item.resource)
 		{
-			if (it->type == DeferredReleaseType::Resource)
-			{
-				if (it->resource)
-				{
-					it->resource->Release();
-				}
-			}
-			else if (it->type == DeferredReleaseType::Descriptor)
-			{
-				if (it->heap && it->index != uint32_t(-1))
-				{
-					it->heap->FreePersistent(it->index);
-				}
-			}
-			it = m_queue.erase(it);
+			item.resource->Release();
 		}
-		else
+	}
+	else if (item.type == DeferredReleaseType::Descriptor)
+	{
+		if (item.heap && item.index != uint32_t(-1))
 		{
-			++it;
+			item.heap->FreePersistent(item.index);
 		}
 	}
 }
 #endif // ENGINE_RENDER_D3D12
-
@@ -2,7 +2,7 @@
 #include "Game/EngineBuildPreferences.hpp"
 
 #ifdef ENGINE_RENDER_D3D12
-#include <vector>
+#include "Engine/Renderer/FenceBucketQueue.hpp"
 #include <cstdint>
 
 struct IUnknown;
@@ -16,9 +16,9 @@ enum class DeferredReleaseType
 };
 
 
+// The fence value is the bucket's, not stored per item
 struct DeferredReleaseItem
 {
-	uint64_t fenceValue;
 	DeferredReleaseType type = DeferredReleaseType::Resource;
 
 	// Resource
@@ -28,15 +28,13 @@ struct DeferredReleaseItem
 	DX12DescriptorHeap* heap = nullptr;
 	uint32_t index = uint32_t(-1);
 
-	DeferredReleaseItem(uint64_t f, IUnknown* res)
-		: fenceValue(f)
-		, type(DeferredReleaseType::Resource)
+	explicit DeferredReleaseItem(IUnknown* res)
+		: type(DeferredReleaseType::Resource)
 		, resource(res) 
 	{}
 
-	DeferredReleaseItem(uint64_t f, DX12DescriptorHeap* h, uint32_t idx)
-		: fenceValue(f)
-		, type(DeferredReleaseType::Descriptor)
+	DeferredReleaseItem(DX12DescriptorHeap* h, uint32_t idx)
+		: type(DeferredReleaseType::Descriptor)
 		, heap(h)
 		, index(idx)
 	{}
@@ -53,12 +51,16 @@ public:
 
 	void EnqueueResource(uint64_t fenceValue, IUnknown* resource);
 	void EnqueueDescriptor(uint64_t fenceValue, DX12DescriptorHeap* heap, uint32_t index);
+	// Only touches the fence buckets that are done, a level unload of thousands of items is one bucket
 	void Process(uint64_t completedFenceValue);
 
+	size_t GetNumPending() const { return m_queue.GetNumPending(); }
 
+private:
+	static void ReleaseItem(DeferredReleaseItem& item);
 
 private:
-	std::vector<DeferredReleaseItem> m_queue;
+	FenceBucketQueue<DeferredReleaseItem> m_queue;
 
 };
 #endif // ENGINE_RENDER_D3D12
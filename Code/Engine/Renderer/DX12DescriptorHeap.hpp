@@ -3,13 +3,15 @@
 
 #ifdef ENGINE_RENDER_D3D12
 
+#include "Engine/Renderer/DescriptorAllocator.hpp"
 #include <d3d12.h>
 
 //https://github.com/TheRealMJP/DXRPathTracer
 struct PersistentDescriptorAlloc
 {
-	D3D12_CPU_DESCRIPTOR_HANDLE m_handles[FRAMES_IN_FLIGHT] = { }; // need to m_device->CreateXXXView(resource, resDesc, )
+	D3D12_CPU_DESCRIPTOR_HANDLE m_handle = { }; // need to m_device->CreateXXXView(resource, resDesc, ), the first one of a range
 	uint32_t m_index = uint32_t(-1);
+	uint32_t m_count = 0;
 };
 
 struct TempDescriptorAlloc
@@ -20,58 +22,48 @@ struct TempDescriptorAlloc
 };
 
 // Wrapper for Descriptor Heap
+// One heap shared by every frame in flight: [0, numPersistent) is handed out as contiguous ranges
+// and stays until freed, the rest is a ring of temporary descriptors that come back once the GPU
+// has passed the fence of the frame that took them.
 class DX12DescriptorHeap
 {
 public:
 	DX12DescriptorHeap(uint32_t numPersistent, uint32_t numTemporary, D3D12_DESCRIPTOR_HEAP_TYPE heapType, bool isShaderVisible);
 	~DX12DescriptorHeap();
 
-	void BeginFrame();
-	
-	PersistentDescriptorAlloc AllocatePersistent();
+	// Recycle temporary descriptors of the frames the GPU is done with
+	void BeginFrame(uint64_t completedFenceValue);
+	// Temporary descriptors taken since the last call are in use until fenceValue
+	void EndFrame(uint64_t fenceValue);
+
+	PersistentDescriptorAlloc AllocatePersistent(uint32_t count = 1);
+	// Frees the whole range allocated at idx
 	void FreePersistent(uint32_t& idx);
 
 	TempDescriptorAlloc AllocateTemporary(uint32_t count);
 
-	// Get Current Frame Handle from Index
 	D3D12_CPU_DESCRIPTOR_HANDLE CPUHandleFromIndex(uint32_t descriptorIdx) const;
 	D3D12_GPU_DESCRIPTOR_HANDLE GPUHandleFromIndex(uint32_t descriptorIdx) const;
 	uint32_t GetDescriptorSize() const { return m_descriptorSize; }
-	ID3D12DescriptorHeap* GetCurrentHeap() const;
+	ID3D12DescriptorHeap* GetHeap() const { return m_heap; }
 	uint32_t GetTotalNumDescriptors() const { return m_numPersistent + m_numTemporary; }
-	uint32_t GetNumHeaps() const { return m_numHeaps; }
+	DescriptorRangeAllocator const& GetPersistentAllocator() const { return m_persistentAllocator; }
+	DescriptorRing const& GetTemporaryRing() const { return m_temporaryRing; }
 
 private:
-	ID3D12DescriptorHeap* m_heaps[FRAMES_IN_FLIGHT] = { };
+	ID3D12DescriptorHeap* m_heap = nullptr;
 
-	// Persistent Descriptor
 	uint32_t m_numPersistent = 0;
-	uint32_t m_persistentAllocated = 0;
-	std::vector<bool> m_persistentInUse;
-	std::vector<uint32_t> m_deadList; // recycled persistent descriptor index, it works like an array-based stack 
-	
 	uint32_t m_numTemporary = 0;
-	uint32_t m_temporaryAllocated = 0;
-
-	uint32_t m_heapIndex = 0;         // current heap index for frame in flight
-	uint32_t m_numHeaps = 0;          // = FRAMES_IN_FLIGHT or 1
+	DescriptorRangeAllocator m_persistentAllocator;
+	DescriptorRing m_temporaryRing; // indexes relative to m_numPersistent
 
 	uint32_t m_descriptorSize = 0;   // size for single descriptor
-	bool m_isShaderVisible = false;     
+	bool m_isShaderVisible = false;
 
 	D3D12_DESCRIPTOR_HEAP_TYPE m_heapType = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart[FRAMES_IN_FLIGHT] = { };
-	D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart[FRAMES_IN_FLIGHT] = { };
-
-	// Do not store cpu/gpu handle, if it is using frame in flight, just use index
-	//void FreePersistent(D3D12_CPU_DESCRIPTOR_HANDLE& handle);
-	//void FreePersistent(D3D12_GPU_DESCRIPTOR_HANDLE& handle);
-	//uint32_t IndexFromHandle(D3D12_CPU_DESCRIPTOR_HANDLE handle) const;
-	//uint32_t IndexFromHandle(D3D12_GPU_DESCRIPTOR_HANDLE handle) const;
-
-
-	D3D12_CPU_DESCRIPTOR_HANDLE CPUHandleFromIndex(uint32_t descriptorIdx, uint32_t heapIdx) const;
-	D3D12_GPU_DESCRIPTOR_HANDLE GPUHandleFromIndex(uint32_t descriptorIdx, uint32_t heapIdx) const;
+	D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart = { };
+	D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart = { };
 };
 
 #endif // ENGINE_RENDER_D3D12
@@ -5,127 +5,79 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "ThirdParty/directx/d3dx12.h"
 
-// Some Alignment math
-namespace DX12Math
-{
-	inline size_t AlignUpWithMask(size_t value, size_t mask)
-	{
-		return ((value + mask) & ~mask);
-	}
-
-	inline size_t AlignDownWithMask(size_t value, size_t mask)
-	{
-		return (value & ~mask);
-	}
-
-	inline size_t AlignUp(size_t value, size_t alignment)
-	{
-		return AlignUpWithMask(value, alignment - 1);
-	}
-
-	inline size_t AlignDown(size_t value, size_t alignment)
-	{
-		return AlignDownWithMask(value, alignment - 1);
-	}
-
-	inline bool IsAligned(size_t value, size_t alignment)
-	{
-		return 0 == (value & (alignment - 1));
-	}
-
 
-	inline size_t AlignUpDiv(size_t value, size_t alignment)
-	{
-		return ((value + alignment - 1) / alignment) * alignment;
-	}
-}
-
-
-DX12LinearAllocator::DX12LinearAllocator(ID3D12Device* device, size_t totalSize)
-	: m_totalSize(totalSize), m_curOffset(0)
+DX12LinearAllocator::DX12LinearAllocator(ID3D12Device* device, size_t pageSize)
+	: LinearPageAllocator(pageSize)
+	, m_device(device)
 {
-	D3D12_HEAP_PROPERTIES heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	D3D12_RESOURCE_DESC resDesc = CD3DX12_RESOURCE_DESC::Buffer(totalSize);
-
-	HRESULT hr = device->CreateCommittedResource(
-		&heapProp,
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&m_uploadBuffer));
-
-	if (FAILED(hr))
-	{
-		ERROR_AND_DIE("Could not create upload heap for DX12LinearAllocator");
-	}
-
-	m_uploadBuffer->Map(0, nullptr, &m_mappedPtr);
 }
 
 DX12LinearAllocator::~DX12LinearAllocator()
 {
-	if (m_uploadBuffer)
-	{
-		m_uploadBuffer->Unmap(0, nullptr);
-		m_uploadBuffer->Release();
-	}
+	DestroyAllPages();
 }
 
 DynAlloc DX12LinearAllocator::Allocate(size_t sizeInBytes, size_t alignment /*= D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT*/)
 {
-	size_t const alignmentMask = alignment - 1;
-	GUARANTEE_OR_DIE((alignmentMask & alignment) == 0, "alignment is not a power of two.");
-
-	size_t const alignedSize = DX12Math::AlignUpWithMask(sizeInBytes, alignmentMask);
+	return MakeDynAlloc(AllocateRange(sizeInBytes, alignment));
+}
 
-	m_curOffset = DX12Math::AlignUpWithMask(m_curOffset, alignmentMask);
+DynAlloc DX12LinearAllocator::AllocateAnyAlign(size_t sizeInBytes, size_t alignment /*= D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT*/)
+{
+	return MakeDynAlloc(AllocateRangeAnyAlign(sizeInBytes, alignment));
+}
 
-	if (m_curOffset + alignedSize > m_totalSize)
-	{
-		ERROR_AND_DIE("Linear Allocator is out of memory!");
-	}
+DynAlloc DX12LinearAllocator::MakeDynAlloc(LinearPageAllocation const& range) const
+{
+	UploadPage const& page = m_uploadPages[range.m_pageIndex];
 
 	DynAlloc alloc;
-	alloc.m_buffer = m_uploadBuffer; // Base resource
-	alloc.m_dataPtr = static_cast<uint8_t*>(m_mappedPtr) + m_curOffset;
-	alloc.m_gpuAddress = m_uploadBuffer->GetGPUVirtualAddress() + m_curOffset;
-	alloc.m_size = alignedSize;
-	alloc.m_offset = m_curOffset;
-
-	m_curOffset += alignedSize;
-
+	alloc.m_buffer = page.m_uploadBuffer; // Base resource
+	alloc.m_dataPtr = static_cast<uint8_t*>(page.m_mappedPtr) + range.m_offset;
+	alloc.m_gpuAddress = page.m_uploadBuffer->GetGPUVirtualAddress() + range.m_offset;
+	alloc.m_size = range.m_size;
+	alloc.m_offset = range.m_offset;
 	return alloc;
 }
 
-DynAlloc DX12LinearAllocator::AllocateAnyAlign(size_t sizeInBytes, size_t alignment /*= D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT*/)
+void DX12LinearAllocator::CreatePage(int pageIndex, size_t capacity)
 {
-	GUARANTEE_OR_DIE(alignment > 0, "alignment must be greater than zero.");
+	if (pageIndex >= static_cast<int>(m_uploadPages.size()))
+	{
+		m_uploadPages.resize(pageIndex + 1);
+	}
+	UploadPage& page = m_uploadPages[pageIndex];
 
-	size_t const alignedSize = DX12Math::AlignUpDiv(sizeInBytes, alignment);
+	D3D12_HEAP_PROPERTIES heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	D3D12_RESOURCE_DESC resDesc = CD3DX12_RESOURCE_DESC::Buffer(capacity);
 
-	m_curOffset = DX12Math::AlignUpDiv(m_curOffset, alignment);
+	HRESULT hr = m_device->CreateCommittedResource(
+		&heapProp,
+		D3D12_HEAP_FLAG_NONE,
+		&resDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&page.m_uploadBuffer));
 
-	if (m_curOffset + alignedSize > m_totalSize)
+	if (FAILED(hr))
 	{
-		ERROR_AND_DIE("Linear Allocator is out of memory!");
+		ERROR_AND_DIE("Could not create upload heap page for DX12LinearAllocator");
 	}
 
-	DynAlloc alloc;
-	alloc.m_buffer = m_uploadBuffer; // Base resource
-	alloc.m_dataPtr = static_cast<uint8_t*>(m_mappedPtr) + m_curOffset;
-	alloc.m_gpuAddress = m_uploadBuffer->GetGPUVirtualAddress() + m_curOffset;
-	alloc.m_size = alignedSize;
-	alloc.m_offset = m_curOffset;
-
-	m_curOffset += alignedSize;
-
-	return alloc;
+	page.m_uploadBuffer->SetName(L"DX12LinearAllocator Page");
+	page.m_uploadBuffer->Map(0, nullptr, &page.m_mappedPtr);
 }
 
-void DX12LinearAllocator::Reset()
+void DX12LinearAllocator::DestroyPage(int pageIndex)
 {
-	m_curOffset = 0;
+	UploadPage& page = m_uploadPages[pageIndex];
+	if (page.m_uploadBuffer)
+	{
+		page.m_uploadBuffer->Unmap(0, nullptr);
+		page.m_uploadBuffer->Release();
+	}
+	page.m_uploadBuffer = nullptr;
+	page.m_mappedPtr = nullptr;
 }
 
 #endif // ENGINE_RENDER_D3D12
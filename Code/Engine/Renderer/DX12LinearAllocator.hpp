@@ -2,7 +2,9 @@
 #include "Game/EngineBuildPreferences.hpp"
 
 #ifdef ENGINE_RENDER_D3D12
+#include "Engine/Renderer/LinearPageAllocator.hpp"
 #include <d3d12.h>
+#include <vector>
 
 struct DynAlloc
 {
@@ -15,83 +17,53 @@ struct DynAlloc
 };
 
 
-class DX12LinearAllocator
+// Upload heap pages behind LinearPageAllocator, one mapped committed buffer per page
+class DX12LinearAllocator : public LinearPageAllocator
 {
 public:
-	DX12LinearAllocator(ID3D12Device* device, size_t totalSize);
+	DX12LinearAllocator(ID3D12Device* device, size_t pageSize);
 	~DX12LinearAllocator();
 
 	// Alignment: cb - 256; vb/ib - 4 or16
 	DynAlloc Allocate(size_t sizeInBytes, size_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
 	DynAlloc AllocateAnyAlign(size_t sizeInBytes, size_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
 
-	// Reset after the frame has complete its GPU work
-	void Reset();
-
-	//ID3D12Resource* GetResource() const { return m_uploadBuffer; }
+protected:
+	void CreatePage(int pageIndex, size_t capacity) override;
+	void DestroyPage(int pageIndex) override;
+	DynAlloc MakeDynAlloc(LinearPageAllocation const& range) const;
 
 private:
-	size_t m_totalSize;
-	size_t m_curOffset;
-	ID3D12Resource* m_uploadBuffer = nullptr;
-	void* m_mappedPtr = nullptr;
+	struct UploadPage
+	{
+		ID3D12Resource* m_uploadBuffer = nullptr;
+		void* m_mappedPtr = nullptr;
+	};
+
+	ID3D12Device* m_device = nullptr;
+	std::vector<UploadPage> m_uploadPages;
 };
 #endif // ENGINE_RENDER_D3D12
 
 
 /*
-constexpr int FrameCount = 3;
-DX12LinearAllocator* m_frameAllocators[FrameCount];
-
-// initialization
-for (int i = 0; i < FrameCount; ++i)
-{
-	m_frameAllocators[i] = std::make_unique<LinearAllocator>(device, 2 * 1024 * 1024); // 2MB
-}
+// initialization, one allocator shared by every frame in flight
+m_linearAllocator = new DX12LinearAllocator(device, 4 * 1024 * 1024); // 4MB pages
 
-// remember to clear it at the beginning of this frame, before record command
-void BeginFrame(UINT frameIndex)
+// remember to recycle at the beginning of this frame, before record command
+void BeginFrame()
 {
-	m_frameAllocators[frameIndex]->Reset();
+	m_linearAllocator->BeginFrame(m_fence->GetCompletedValue());
 }
 
-auto alloc = m_frameAllocators[frameIndex]->Allocate(sizeof(MyCB));
-memcpy(alloc.cpuPtr, &cbData, sizeof(MyCB));
-D3D12_GPU_VIRTUAL_ADDRESS cbAddress = alloc.gpuAddress;
-
-struct VSConstants
-{
-	Matrix4 modelToProjection;
-	Matrix4 modelToShadow;
-	XMFLOAT3 viewerPos;
-} vsConstants;
-vsConstants.modelToProjection = ViewProjMat;
-vsConstants.modelToShadow = m_SunShadow.GetShadowMatrix();
-XMStoreFloat3(&vsConstants.viewerPos, viewerPos);
-
-gfxContext.SetDynamicConstantBufferView(Renderer::kMeshConstants, sizeof(vsConstants), &vsConstants);
+auto alloc = m_linearAllocator->Allocate(sizeof(MyCB));
+memcpy(alloc.m_dataPtr, &cbData, sizeof(MyCB));
+D3D12_GPU_VIRTUAL_ADDRESS cbAddress = alloc.m_gpuAddress;
 
-
-inline void GraphicsContext::SetDynamicConstantBufferView( UINT RootIndex, size_t BufferSize, const void* BufferData )
-{
-	ASSERT(BufferData != nullptr && Math::IsAligned(BufferData, 16));
-	DynAlloc cb = m_CpuLinearAllocator.Allocate(BufferSize);
-	memcpy(cb.DataPtr, BufferData, BufferSize);
-	m_CommandList->SetGraphicsRootConstantBufferView(RootIndex, cb.GpuAddress);
-}
-
-void Render(UINT frameIndex)
+// hand this frame's pages to the fence that covers them
+void EndFrame()
 {
-	// 1. Begin Frame reset linear allocator
-	m_frameAllocators[frameIndex]->Reset();
-
-	// 2. 
-	auto alloc = m_frameAllocators[frameIndex]->Allocate(sizeof(MyCB));
-	memcpy(alloc.cpuPtr, &cb, sizeof(MyCB));
-
-	// 3. 
-	cmdList->SetGraphicsRootConstantBufferView(0, alloc.gpuAddress);
-
-	// ...
+	uint64_t fenceValue = ExecuteCommandList();
+	m_linearAllocator->RetireUsedPages(fenceValue);
 }
 */
@@ -4,31 +4,32 @@
 #ifdef ENGINE_RENDER_D3D12
 
 #include "Engine/Core/EngineCommon.hpp"
-#include "Engine/Core/HashCombine.hpp"
 #include "Engine/Renderer/DX12Renderer.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Renderer/DX12GraphicsCommon.hpp"
 #include "ThirdParty/directx/d3dx12.h"
 
-#include <map>
-
-static std::map<size_t, ID3D12PipelineState*> s_graphicPSOHashMap;
-static std::map<size_t, ID3D12PipelineState*> s_computePSOHashMap;
+static PipelineIdRegistry s_pipelineIds;
+static FlatPipelineCache<ID3D12PipelineState*> s_graphicsPSOCache;
+static FlatPipelineCache<ID3D12PipelineState*> s_computePSOCache;
 
 
 STATIC void PSO::DestroyAll()
 {
-	for (auto& it : s_graphicPSOHashMap)
-	{
-		DX_SAFE_RELEASE(it.second);
-	}
-	s_graphicPSOHashMap.clear();
+	s_graphicsPSOCache.ForEach([](uint64_t, ID3D12PipelineState*& pso) { DX_SAFE_RELEASE(pso); });
+	s_graphicsPSOCache.Clear();
+
+	s_computePSOCache.ForEach([](uint64_t, ID3D12PipelineState*& pso) { DX_SAFE_RELEASE(pso); });
+	s_computePSOCache.Clear();
+}
 
-	for (auto& it : s_computePSOHashMap)
+static uint32_t GetPipelineShaderId(Shader* shader)
+{
+	if (shader->m_pipelineShaderId == 0)
 	{
-		DX_SAFE_RELEASE(it.second);
+		shader->m_pipelineShaderId = s_pipelineIds.InternShaderName(shader->GetName());
 	}
-	s_computePSOHashMap.clear();
+	return shader->m_pipelineShaderId;
 }
 
 
@@ -77,13 +78,49 @@ GraphicsPSO::GraphicsPSO(const wchar_t* name /*= L"Unnamed Graphics PSO"*/)
 	m_PSODesc.NumRenderTargets = 1;
 	m_PSODesc.RTVFormats[0] = DX12Graphics::BackBufferFormat;
 	m_PSODesc.DSVFormat = DX12Graphics::DepthStencilFormat;
+
+	// The key and the desc have to agree from the start, the setters skip values the key already has
+	m_renderTargetLayout.Set(1, &DX12Graphics::BackBufferFormat, DX12Graphics::DepthStencilFormat, 1, 0);
+	m_key.SetRenderTargetLayoutId(s_pipelineIds.InternRenderTargetLayout(m_renderTargetLayout));
+	m_key.SetInputLayout(VertexType::VERTEX_PCU);
+	m_key.SetBlendMode(BlendMode::ALPHA);
+	ApplyBlendMode(BlendMode::ALPHA);
+	m_key.SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+	ApplyRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+	m_key.SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
+	ApplyDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
 }
 
 void GraphicsPSO::SetBlendMode(BlendMode blendMode)
 {
-	m_blendMode = blendMode;
+	if (m_key.SetBlendMode(blendMode))
+	{
+		ApplyBlendMode(blendMode);
+		m_isDirty = true;
+	}
+}
 
-	switch (m_blendMode)
+void GraphicsPSO::SetRasterizerMode(RasterizerMode rasterizerMode)
+{
+	if (m_key.SetRasterizerMode(rasterizerMode))
+	{
+		ApplyRasterizerMode(rasterizerMode);
+		m_isDirty = true;
+	}
+}
+
+void GraphicsPSO::SetDepthMode(DepthMode depthMode)
+{
+	if (m_key.SetDepthMode(depthMode))
+	{
+		ApplyDepthMode(depthMode);
+		m_isDirty = true;
+	}
+}
+
+void GraphicsPSO::ApplyBlendMode(BlendMode blendMode)
+{
+	switch (blendMode)
 	{
 	case BlendMode::OPAQUE:
 		m_PSODesc.BlendState = DX12Graphics::BlendOpaque;
@@ -99,11 +136,9 @@ void GraphicsPSO::SetBlendMode(BlendMode blendMode)
 	}
 }
 
-void GraphicsPSO::SetRasterizerMode(RasterizerMode rasterizerMode)
+void GraphicsPSO::ApplyRasterizerMode(RasterizerMode rasterizerMode)
 {
-	m_rasterizerMode = rasterizerMode;
-
-	switch (m_rasterizerMode)
+	switch (rasterizerMode)
 	{
 	case RasterizerMode::SOLID_CULL_NONE:
 		m_PSODesc.RasterizerState = DX12Graphics::RasterizerSolidCullNone;
@@ -123,11 +158,9 @@ void GraphicsPSO::SetRasterizerMode(RasterizerMode rasterizerMode)
 	}
 }
 
-void GraphicsPSO::SetDepthMode(DepthMode depthMode)
+void GraphicsPSO::ApplyDepthMode(DepthMode depthMode)
 {
-	m_depthMode = depthMode;
-
-	switch (m_depthMode)
+	switch (depthMode)
 	{
 	case DepthMode::DISABLED:
 		m_PSODesc.DepthStencilState = DX12Graphics::DepthStateDisabled;
@@ -167,7 +200,16 @@ void GraphicsPSO::SetDepthMode(DepthMode depthMode)
 
 void GraphicsPSO::SetShader(Shader* shader)
 {
-	m_shaderName = shader->GetName();
+	if (shader == m_shader)
+	{
+		return;
+	}
+	m_shader = shader;
+	// Shaders with the same name share an id, and so their PSOs, like they did when keyed by name
+	if (m_key.SetShaderId(GetPipelineShaderId(shader)))
+	{
+		m_isDirty = true;
+	}
 
 	m_PSODesc.VS.pShaderBytecode = (shader->m_vertexShaderByteCode.size() > 0)? shader->m_vertexShaderByteCode.data(): nullptr;
 	m_PSODesc.VS.BytecodeLength = shader->m_vertexShaderByteCode.size();
@@ -179,14 +221,18 @@ void GraphicsPSO::SetShader(Shader* shader)
 	m_PSODesc.GS.BytecodeLength = shader->m_geometryShaderByteCode.size();
 
 
-	m_inputLayoutMode = shader->m_inputLayoutMode;
+	if (m_key.SetInputLayout(shader->m_inputLayoutMode))
+	{
+		m_isDirty = true;
+	}
 
-	switch (m_inputLayoutMode)
+	switch (shader->m_inputLayoutMode)
 	{
 	case VertexType::VERTEX_NONE:
 		m_PSODesc.InputLayout = { nullptr, 0 };
 		break;
 	case VertexType::VERTEX_PCU:
+	case VertexType::VERTEX_PCU_INSTANCED: // instances come from a StructuredBuffer, not a vertex stream
 		m_PSODesc.InputLayout = { g_InputLayout_PCU, _countof(g_InputLayout_PCU) };
 		break;
 	case VertexType::VERTEX_PCUTBN:
@@ -200,6 +246,18 @@ void GraphicsPSO::SetShader(Shader* shader)
 
 void GraphicsPSO::SetRenderTargetFormats(UINT numRTVs, DXGI_FORMAT const* rtvFormats, DXGI_FORMAT dsvFormat, UINT msaaCount /*= 1*/, UINT msaaQuality /*= 0*/)
 {
+	RenderTargetLayout layout;
+	layout.Set(numRTVs, rtvFormats, dsvFormat, msaaCount, msaaQuality);
+	if (layout == m_renderTargetLayout)
+	{
+		return;
+	}
+	m_renderTargetLayout = layout;
+	if (m_key.SetRenderTargetLayoutId(s_pipelineIds.InternRenderTargetLayout(layout)))
+	{
+		m_isDirty = true;
+	}
+
 	for (UINT i = 0; i < numRTVs; ++i)
 	{
 		m_PSODesc.RTVFormats[i] = rtvFormats[i];
@@ -221,15 +279,28 @@ void GraphicsPSO::SetRenderTargetFormats(UINT numRTVs, DXGI_FORMAT const* rtvFor
 
 void GraphicsPSO::Finalize()
 {
+	if (!m_isDirty)
+	{
+		return;
+	}
+	m_isDirty = false;
+
 	GUARANTEE_OR_DIE(m_rootSignature != nullptr, "Graphics PSO does not have a rootsignature.");
-	m_PSODesc.pRootSignature = m_rootSignature; // may need to be hashed
+	GUARANTEE_OR_DIE(m_shader != nullptr, "Graphics PSO does not have a shader.");
+	m_PSODesc.pRootSignature = m_rootSignature; // may need to be keyed
 
-	size_t hashKey = GetHashKey();
+	// Set back to what the last draw used
+	uint64_t key = m_key.GetValue();
+	if (key == m_finalizedKey && m_PSO != nullptr)
+	{
+		return;
+	}
+	m_finalizedKey = key;
 
-	auto found = s_graphicPSOHashMap.find(hashKey);
-	if (found != s_graphicPSOHashMap.end())
+	ID3D12PipelineState** found = s_graphicsPSOCache.Find(key);
+	if (found != nullptr)
 	{
-		m_PSO = found->second;
+		m_PSO = *found;
 		return;
 	}
 
@@ -239,7 +310,7 @@ void GraphicsPSO::Finalize()
 		ERROR_AND_DIE("Failed to create Graphics PSO!");
 	}
 
-	s_graphicPSOHashMap[hashKey] = m_PSO;
+	s_graphicsPSOCache.Insert(key, m_PSO);
 
 	static int i = 0;
 	++i;
@@ -248,38 +319,6 @@ void GraphicsPSO::Finalize()
 }
 
 
-size_t GraphicsPSO::GetHashKey() const
-{
-	size_t seed = 0;
-	hash_combine(seed, m_shaderName);
-	hash_combine(seed, m_inputLayoutMode);
-	hash_combine(seed, m_blendMode);
-	hash_combine(seed, m_rasterizerMode);
-	hash_combine(seed, m_depthMode);
-
-
-	// Not important to hash now
-	hash_combine(seed, m_PSODesc.NumRenderTargets);
-	for (UINT i = 0; i < 8; ++i) 
-	{
-		if (i < m_PSODesc.NumRenderTargets) 
-		{
-			hash_combine(seed, m_PSODesc.RTVFormats[i]);
-		}
-		else 
-		{
-			hash_combine(seed, DXGI_FORMAT_UNKNOWN);
-		}
-	}
-
-	hash_combine(seed, m_PSODesc.DSVFormat);
-	hash_combine(seed, m_PSODesc.SampleDesc.Count);
-	hash_combine(seed, m_PSODesc.SampleDesc.Quality);
-	hash_combine(seed, m_PSODesc.PrimitiveTopologyType);
-
-	return seed;
-}
-
 ComputePSO::ComputePSO(const wchar_t* name /*= L"Unnamed Compute PSO"*/)
 	: PSO(name)
 {
@@ -289,8 +328,17 @@ ComputePSO::ComputePSO(const wchar_t* name /*= L"Unnamed Compute PSO"*/)
 
 void ComputePSO::SetShader(Shader* shader)
 {
-	m_shaderName = shader->GetName();
-
+	if (shader == m_shader)
+	{
+		return;
+	}
+	m_shader = shader;
+	uint64_t key = MakeComputePipelineKey(GetPipelineShaderId(shader));
+	if (key != m_key)
+	{
+		m_key = key;
+		m_isDirty = true;
+	}
 
 	m_PSODesc.CS.pShaderBytecode = (shader->m_computeShaderByteCode.size() > 0) ? shader->m_computeShaderByteCode.data() : nullptr;
 	m_PSODesc.CS.BytecodeLength = shader->m_computeShaderByteCode.size();
@@ -298,15 +346,26 @@ void ComputePSO::SetShader(Shader* shader)
 
 void ComputePSO::Finalize()
 {
+	if (!m_isDirty)
+	{
+		return;
+	}
+	m_isDirty = false;
+
 	GUARANTEE_OR_DIE(m_rootSignature != nullptr, "Compute PSO does not have a rootsignature.");
-	m_PSODesc.pRootSignature = m_rootSignature; // may need to be hashed
+	GUARANTEE_OR_DIE(m_shader != nullptr, "Compute PSO does not have a shader.");
+	m_PSODesc.pRootSignature = m_rootSignature; // may need to be keyed
 
-	size_t hashKey = GetHashKey();
+	if (m_key == m_finalizedKey && m_PSO != nullptr)
+	{
+		return;
+	}
+	m_finalizedKey = m_key;
 
-	auto found = s_computePSOHashMap.find(hashKey);
-	if (found != s_computePSOHashMap.end())
+	ID3D12PipelineState** found = s_computePSOCache.Find(m_key);
+	if (found != nullptr)
 	{
-		m_PSO = found->second;
+		m_PSO = *found;
 		return;
 	}
 
@@ -316,7 +375,7 @@ void ComputePSO::Finalize()
 		ERROR_AND_DIE("Failed to create Compute PSO!");
 	}
 
-	s_computePSOHashMap[hashKey] = m_PSO;
+	s_computePSOCache.Insert(m_key, m_PSO);
 
 	static int i = 0;
 	++i;
@@ -324,13 +383,5 @@ void ComputePSO::Finalize()
 	m_PSO->SetName(newName.c_str());
 }
 
-size_t ComputePSO::GetHashKey() const
-{
-	size_t seed = 0;
-	hash_combine(seed, m_shaderName);
-
-	return seed;
-}
-
 #endif // ENGINE_RENDER_D3D12
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Engine/Renderer/RendererCommon.hpp"
+#include "Engine/Renderer/PipelineStateCache.hpp"
 
 
 #ifdef ENGINE_RENDER_D3D12
@@ -19,7 +20,11 @@ public:
 
 	void SetRootSignature(ID3D12RootSignature* rootSig)
 	{
-		m_rootSignature = rootSig;
+		if (rootSig != m_rootSignature)
+		{
+			m_rootSignature = rootSig;
+			m_isDirty = true;
+		}
 	}
 
 	ID3D12RootSignature* GetRootSignature() const
@@ -34,9 +39,13 @@ protected:
 	ID3D12PipelineState* m_PSO = nullptr;
 
 	ID3D12RootSignature* m_rootSignature = nullptr;
+
+	// Set by the setters when the desired state really changed, Finalize does nothing while it is clear
+	bool m_isDirty = true;
+	uint64_t m_finalizedKey = 0;
 };
 
-// We do not hash the root signature for now, different root sigs will use different shaders.
+// We do not key the root signature for now, different root sigs will use different shaders.
 // Fixed SampleMask, StreamOutput(not set), TopologyType(triangle), NumRenderTarget(1), RTVFormat[8], DSVFormat, SampleDesc(1,0)
 // TopologyType is triangle, but Topology can be triangle list triangle
 class GraphicsPSO : public PSO
@@ -53,20 +62,22 @@ public:
 	// for deferred rendering render 3 G-Buffer
 	void SetRenderTargetFormats(UINT numRTVs, DXGI_FORMAT const* rtvFormats, DXGI_FORMAT dsvFormat, UINT msaaCount = 1, UINT msaaQuality = 0);
 
+	// Cheap when nothing changed since the last call, otherwise one lookup in the PSO cache
 	void Finalize();
 
+	uint64_t GetKey() const { return m_key.GetValue(); }
+
 private:
-	size_t GetHashKey() const;
+	void ApplyBlendMode(BlendMode blendMode);
+	void ApplyRasterizerMode(RasterizerMode rasterizerMode);
+	void ApplyDepthMode(DepthMode depthMode);
 
 private:
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC m_PSODesc = {};
 
-	// Hash
-	std::string		m_shaderName;
-	VertexType		m_inputLayoutMode = VertexType::VERTEX_PCU;
-	BlendMode       m_blendMode = BlendMode::ALPHA;
-	RasterizerMode  m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
-	DepthMode       m_depthMode = DepthMode::READ_WRITE_LESS_EQUAL;
+	GraphicsPipelineKey	m_key;
+	Shader*				m_shader = nullptr;
+	RenderTargetLayout	m_renderTargetLayout;
 };
 
 class ComputePSO : public PSO
@@ -79,12 +90,10 @@ public:
 	void Finalize();
 
 private:
-	size_t GetHashKey() const;
-
 	D3D12_COMPUTE_PIPELINE_STATE_DESC m_PSODesc = {};
 
-	// Hash
-	std::string		m_shaderName;
+	Shader*		m_shader = nullptr;
+	uint64_t	m_key = 0;
 };
 
 
@@ -6,11 +6,13 @@
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/Vertex_PCUTBN.hpp"
 #include "Engine/Window/Window.hpp"
 #include "Engine/Renderer/Buffer.hpp"
 #include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/TextureCook.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Renderer/Camera.hpp"
 #include "Engine/Renderer/Shader.hpp"
@@ -161,6 +163,7 @@ void DX12Renderer::Startup()
 
 void DX12Renderer::BeginFrame()
 {
+	PROFILE_SCOPE("Renderer::BeginFrame");
 	// Execute the commands before the first frame begin 
 	// or commandList is opened when not between Renderer::BeginFrame and Renderer::EndFrame
 	if (/*m_currFrameResource == nullptr ||*/ m_isCommandListOpened)
@@ -172,18 +175,19 @@ void DX12Renderer::BeginFrame()
 	m_currFrameResourceIndex = (m_currFrameResourceIndex + 1) % FRAMES_IN_FLIGHT;
 	m_currFrameResource = m_frameResources[m_currFrameResourceIndex];
 
-	m_rtvDescriptorHeap->BeginFrame();
-	m_dsvDescriptorHeap->BeginFrame();
-	m_cbvSrvUavDescriptorHeap->BeginFrame();
-	m_samplerDescriptorHeap->BeginFrame();
-
 	// wait until the GPU has completed commands up to this fence point
 	if (m_currFrameResource->m_fenceValue != 0)
 	{
 		WaitForFenceValue(m_currFrameResource->m_fenceValue);
 	}
 
-	m_deferredReleaseQueue->Process(m_currFrameResource->m_fenceValue);
+	uint64_t completedFenceValue = m_fence->GetCompletedValue();
+	m_rtvDescriptorHeap->BeginFrame(completedFenceValue);
+	m_dsvDescriptorHeap->BeginFrame(completedFenceValue);
+	m_cbvSrvUavDescriptorHeap->BeginFrame(completedFenceValue);
+	m_samplerDescriptorHeap->BeginFrame(completedFenceValue);
+
+	m_deferredReleaseQueue->Process(completedFenceValue);
 
 
 
@@ -193,7 +197,7 @@ void DX12Renderer::BeginFrame()
 	// Reset command list, current frame command allocator, current frame linear allocator
 	GUARANTEE_OR_DIE(SUCCEEDED(GetCurrentCommandAllocator()->Reset()), "Cannot reset current frame command allocator");
 	GUARANTEE_OR_DIE(SUCCEEDED(m_commandList->Reset(GetCurrentCommandAllocator(), nullptr)), "Could not reset the command list");
-	GetCurrentLinearAllocator()->Reset();
+	m_linearAllocator->BeginFrame(completedFenceValue);
 
 	//-----------------------------------------------------------------------------------------------
 	m_curGraphicsRootSignature = nullptr;
@@ -207,7 +211,7 @@ void DX12Renderer::BeginFrame()
 	// This is in order to make sure the correct heap pointers are available when the root signature is set. 
 	// Additionally, SetDescriptorHeaps may not be called after SetGraphicsRootSignature or SetComputeRootSignature with different heap pointers 
 	// before a Draw or Dispatch.
-	ID3D12DescriptorHeap* descriptorHeaps[] = { m_cbvSrvUavDescriptorHeap->GetCurrentHeap(), m_samplerDescriptorHeap->GetCurrentHeap() };
+	ID3D12DescriptorHeap* descriptorHeaps[] = { m_cbvSrvUavDescriptorHeap->GetHeap(), m_samplerDescriptorHeap->GetHeap() };
 	m_commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
 	m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST); // Fixed Primitive Topology
 
@@ -230,6 +234,8 @@ void DX12Renderer::BeginFrame()
 	m_tempLightConstantsIndex = INVALID_INDEX_U32;
 	m_tempCameraConstantsIndex = INVALID_INDEX_U32;
 	m_tempModelConstantsIndex = INVALID_INDEX_U32;
+	m_tempInstanceDataIndex = INVALID_INDEX_U32;
+	m_numUploadedInstances = 0;
 
 	m_tempEngineConstantsIndex = AllocateTempConstantBuffer(sizeof(EngineConstants), &m_engineConstants);
 	m_tempLightConstantsIndex = AllocateTempConstantBuffer(sizeof(LightConstants), &m_lightConstants);
@@ -250,6 +256,7 @@ void DX12Renderer::BeginFrame()
 
 void DX12Renderer::EndFrame()
 {
+	PROFILE_SCOPE("Renderer::EndFrame");
 	ImGuiEndFrame();
 
 	// Indicate that the back buffer will now be used to present.
@@ -258,6 +265,11 @@ void DX12Renderer::EndFrame()
 
 	uint64_t fenceSignaled = ExecuteCommandList();
 	m_currFrameResource->m_fenceValue = fenceSignaled;
+	m_linearAllocator->RetireUsedPages(fenceSignaled);
+	m_rtvDescriptorHeap->EndFrame(fenceSignaled);
+	m_dsvDescriptorHeap->EndFrame(fenceSignaled);
+	m_cbvSrvUavDescriptorHeap->EndFrame(fenceSignaled);
+	m_samplerDescriptorHeap->EndFrame(fenceSignaled);
 
 	HRESULT hr = m_swapChain->Present(0, 0);
 	if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
@@ -479,6 +491,27 @@ void DX12Renderer::CopyCPUToGPU(const void* data, unsigned int size, IndexBuffer
 	ibo->Upload(m_commandList, data, size);
 }
 
+// Default heap buffers keep their contents, only a grow (which recreates the buffer) uploads everything
+void DX12Renderer::CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, VertexBuffer* vbo)
+{
+	if (vbo->GetSize() < bufferSize)
+	{
+		vbo->Upload(m_commandList, bufferData, bufferSize);
+		return;
+	}
+	vbo->UploadRange(m_commandList, static_cast<unsigned char const*>(bufferData) + dirtyOffset, dirtySize, dirtyOffset, bufferSize);
+}
+
+void DX12Renderer::CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, IndexBuffer* ibo)
+{
+	if (ibo->GetSize() < bufferSize)
+	{
+		ibo->Upload(m_commandList, bufferData, bufferSize);
+		return;
+	}
+	ibo->UploadRange(m_commandList, static_cast<unsigned char const*>(bufferData) + dirtyOffset, dirtySize, dirtyOffset, bufferSize);
+}
+
 void DX12Renderer::CopyCPUToGPU(const void* data, unsigned int size, ConstantBuffer* cbo)
 {
 	UNUSED(data);
@@ -489,6 +522,7 @@ void DX12Renderer::CopyCPUToGPU(const void* data, unsigned int size, ConstantBuf
 
 void DX12Renderer::DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes)
 {
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
 	SetDynamicVertexBuffer(0, numVertexes, sizeof(Vertex_PCU), vertexes);
 	m_desiredGraphicsPSO->Finalize();
 	SetPipelineState(*m_desiredGraphicsPSO);
@@ -497,6 +531,7 @@ void DX12Renderer::DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes)
 
 void DX12Renderer::DrawVertexArray(std::vector<Vertex_PCU> const& verts)
 {
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
 	SetDynamicVertexBuffer(0, verts.size(), sizeof(Vertex_PCU), verts.data());
 	m_desiredGraphicsPSO->Finalize();
 	SetPipelineState(*m_desiredGraphicsPSO);
@@ -505,6 +540,7 @@ void DX12Renderer::DrawVertexArray(std::vector<Vertex_PCU> const& verts)
 
 void DX12Renderer::DrawVertexArray(std::vector<Vertex_PCUTBN> const& verts)
 {
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
 	SetDynamicVertexBuffer(0, verts.size(), sizeof(Vertex_PCUTBN), verts.data());
 	m_desiredGraphicsPSO->Finalize();
 	SetPipelineState(*m_desiredGraphicsPSO);
@@ -513,6 +549,7 @@ void DX12Renderer::DrawVertexArray(std::vector<Vertex_PCUTBN> const& verts)
 
 void DX12Renderer::DrawIndexedVertexArray(std::vector<Vertex_PCU> const& verts, std::vector<unsigned int> const& indexes)
 {
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexArray");
 	SetDynamicVertexBuffer(0, verts.size(), sizeof(Vertex_PCU), verts.data());
 	SetDynamicIndexBuffer(indexes.size(), indexes.data());
 	m_desiredGraphicsPSO->Finalize();
@@ -522,6 +559,7 @@ void DX12Renderer::DrawIndexedVertexArray(std::vector<Vertex_PCU> const& verts,
 
 void DX12Renderer::DrawIndexedVertexArray(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indexes)
 {
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexArray");
 	SetDynamicVertexBuffer(0, verts.size(), sizeof(Vertex_PCUTBN), verts.data());
 	SetDynamicIndexBuffer(indexes.size(), indexes.data());
 	m_desiredGraphicsPSO->Finalize();
@@ -531,6 +569,7 @@ void DX12Renderer::DrawIndexedVertexArray(std::vector<Vertex_PCUTBN> const& vert
 
 void DX12Renderer::DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount)
 {
+	PROFILE_SCOPE("Renderer::DrawVertexBuffer");
 	SetVertexBuffer(0, vbo->GetVertexBufferView());
 	m_desiredGraphicsPSO->Finalize();
 	SetPipelineState(*m_desiredGraphicsPSO);
@@ -539,6 +578,7 @@ void DX12Renderer::DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount)
 
 void DX12Renderer::DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount)
 {
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexBuffer");
 	SetVertexBuffer(0, vbo->GetVertexBufferView());
 	SetIndexBuffer(ibo->GetIndexBufferView());
 	m_desiredGraphicsPSO->Finalize();
@@ -546,6 +586,34 @@ void DX12Renderer::DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo,
 	DrawIndexed(indexCount);
 }
 
+void DX12Renderer::SetInstanceData(int numInstances, InstanceData const* instances)
+{
+	GUARANTEE_OR_DIE(numInstances > 0, "SetInstanceData needs at least one instance.");
+	m_tempInstanceDataIndex = AllocateTempStructuredBuffer(numInstances * sizeof(InstanceData), instances, sizeof(InstanceData), static_cast<unsigned int>(numInstances));
+	m_numUploadedInstances = numInstances;
+}
+
+void DX12Renderer::DrawVertexBufferInstanced(VertexBuffer* vbo, unsigned int vertexCount, int numInstances)
+{
+	PROFILE_SCOPE("Renderer::DrawVertexBufferInstanced");
+	GUARANTEE_RECOVERABLE(numInstances <= m_numUploadedInstances, "Drawing more instances than SetInstanceData uploaded.");
+	SetVertexBuffer(0, vbo->GetVertexBufferView());
+	m_desiredGraphicsPSO->Finalize();
+	SetPipelineState(*m_desiredGraphicsPSO);
+	DrawInstanced(vertexCount, static_cast<unsigned int>(numInstances));
+}
+
+void DX12Renderer::DrawIndexedVertexBufferInstanced(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount, int numInstances)
+{
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexBufferInstanced");
+	GUARANTEE_RECOVERABLE(numInstances <= m_numUploadedInstances, "Drawing more instances than SetInstanceData uploaded.");
+	SetVertexBuffer(0, vbo->GetVertexBufferView());
+	SetIndexBuffer(ibo->GetIndexBufferView());
+	m_desiredGraphicsPSO->Finalize();
+	SetPipelineState(*m_desiredGraphicsPSO);
+	DrawIndexedInstanced(indexCount, static_cast<unsigned int>(numInstances), 0, 0, 0);
+}
+
 void DX12Renderer::DrawProcedural(unsigned int vertexCount)
 {
 	// Not use vertex buffer, only use uint vertexID : SV_VertexID
@@ -745,6 +813,26 @@ Texture* DX12Renderer::CreateOrGetTextureFromFile(char const* imageFilePath)
 }
 
 
+Texture* DX12Renderer::CreateOrGetTextureFromImage(Image const& image)
+{
+	Texture* existingTexture = GetTextureForFileName(image.GetImageFilePath().c_str());
+	if (existingTexture)
+	{
+		return existingTexture;
+	}
+	return CreateTextureFromImage(image);
+}
+
+Texture* DX12Renderer::CreateOrGetTextureFromCooked(CookedTexture const& cooked)
+{
+	Texture* existingTexture = GetTextureForFileName(cooked.m_name.c_str());
+	if (existingTexture)
+	{
+		return existingTexture;
+	}
+	return CreateTextureFromCooked(cooked);
+}
+
 Texture* DX12Renderer::CreateOrGetTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config)
 {
 	// See if we already have this texture previously loaded
@@ -778,6 +866,16 @@ BitmapFont* DX12Renderer::CreateOrGetBitmapFont(char const* bitmapFontFilePathWi
 	return newBitmapFont;
 }
 
+BitmapFont* DX12Renderer::CreateOrGetSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config /*= SDFFontConfig()*/)
+{
+	BitmapFont* existingSDFFont = GetBitmapFont(bitmapFontFilePathWithNoExtension, true);
+	if (existingSDFFont)
+	{
+		return existingSDFFont;
+	}
+	return CreateSDFFont(bitmapFontFilePathWithNoExtension, config);
+}
+
 Shader* DX12Renderer::CreateOrGetShader(char const* shaderName, VertexType type /*= VertexType::VERTEX_PCU*/)
 {
 	//ERROR_AND_DIE("Please use ShaderConfig to create shader, DXC and SM6.6 is required");
@@ -915,10 +1013,7 @@ Texture* DX12Renderer::CreateTextureFromImage(Image const& image)
 	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 	srvDesc.Texture2D.MipLevels = 1; // same as desc.miplevels
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateShaderResourceView(resource, &srvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateShaderResourceView(resource, &srvDesc, alloc.m_handle);
 
 	Texture* newTexture = new Texture(this);
 	newTexture->m_name = image.GetImageFilePath();
@@ -941,6 +1036,111 @@ Texture* DX12Renderer::CreateTextureFromImage(Image const& image)
 	return newTexture;
 }
 
+Texture* DX12Renderer::CreateTextureFromCooked(CookedTexture const& cooked)
+{
+	GUARANTEE_OR_DIE(!cooked.m_mips.empty(), Stringf("CreateTextureFromCooked: \"%s\" has no mips", cooked.m_name.c_str()));
+	UINT16 numMips = static_cast<UINT16>(cooked.m_mips.size());
+
+	// 1. create default heap with every mip
+	D3D12_RESOURCE_DESC textureDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+		cooked.m_format,
+		cooked.m_dimensions.x,
+		cooked.m_dimensions.y,
+		1,
+		numMips
+	);
+
+	ID3D12Resource* resource = nullptr;
+	D3D12_HEAP_PROPERTIES heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	HRESULT hr = m_device->CreateCommittedResource(
+		&heapProp,
+		D3D12_HEAP_FLAG_NONE,
+		&textureDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(&resource)
+	);
+
+	GUARANTEE_OR_DIE(SUCCEEDED(hr), "Could not create cooked texture default heap");
+#ifdef _DEBUG
+	resource->SetName(ToWString(cooked.m_name).c_str());
+#endif // _DEBUG
+
+	// 2. create temp upload heap big enough for all subresources
+	ID3D12Resource* textureUploadHeap = nullptr;
+	UINT64 uploadBufferSize = 0;
+	m_device->GetCopyableFootprints(&textureDesc, 0, numMips, 0, nullptr, nullptr, nullptr, &uploadBufferSize);
+
+	D3D12_HEAP_PROPERTIES heapProp1 = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	D3D12_RESOURCE_DESC textureDesc1 = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
+
+	hr = m_device->CreateCommittedResource(
+		&heapProp1,
+		D3D12_HEAP_FLAG_NONE,
+		&textureDesc1,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&textureUploadHeap)
+	);
+	GUARANTEE_OR_DIE(SUCCEEDED(hr), "Could not create cooked texture upload heap");
+
+	textureUploadHeap->SetName(L"Cooked texture upload heap");
+
+	// 3. upload data, one subresource per mip. RowPitch is a row of 4x4 blocks for BC formats
+	std::vector<D3D12_SUBRESOURCE_DATA> mipData(numMips);
+	for (UINT16 mipIndex = 0; mipIndex < numMips; ++mipIndex)
+	{
+		CookedTextureMip const& mip = cooked.m_mips[mipIndex];
+		mipData[mipIndex].pData = cooked.m_data.data() + mip.m_dataOffset;
+		mipData[mipIndex].RowPitch = mip.m_rowPitch;
+		mipData[mipIndex].SlicePitch = mip.m_numBytes;
+	}
+
+	UpdateSubresources(m_commandList, resource, textureUploadHeap, 0, 0, numMips, mipData.data());
+
+	// 4. Transition state
+	CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+		resource,
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+	);
+	m_commandList->ResourceBarrier(1, &barrier);
+
+	// release temp upload heap
+	EnqueueDeferredRelease(textureUploadHeap);
+
+	// 5. Allocate a SRV Descriptor
+	PersistentDescriptorAlloc alloc = m_cbvSrvUavDescriptorHeap->AllocatePersistent();
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format = cooked.m_format;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MipLevels = numMips;
+
+	m_device->CreateShaderResourceView(resource, &srvDesc, alloc.m_handle);
+
+	Texture* newTexture = new Texture(this);
+	newTexture->m_name = cooked.m_name;
+	newTexture->m_dimensions = cooked.m_dimensions;
+	newTexture->m_depth = 1;
+	newTexture->m_resource = resource;
+	newTexture->m_srvHeapIndex = alloc.m_index;
+
+	newTexture->m_mipLevels = numMips;
+	newTexture->m_sampleCount = 1;
+	newTexture->m_sampleQuality = 0;
+	newTexture->m_format = cooked.m_format;
+
+	newTexture->m_supportSRV = true;
+	newTexture->m_currentResourceState = static_cast<unsigned int>(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	newTexture->m_resourceDimension = DXResourceDimension::TEXTURE2D;
+
+	m_loadedTextures.push_back(newTexture);
+
+	return newTexture;
+}
+
 Texture* DX12Renderer::CreateTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config)
 {
 	Image images[6] = {
@@ -1047,10 +1247,7 @@ Texture* DX12Renderer::CreateTextureCubeFromSixFaces(TextureCubeSixFacesConfig c
 	srvDesc.TextureCube.MipLevels = 1;
 	srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateShaderResourceView(resource, &srvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateShaderResourceView(resource, &srvDesc, alloc.m_handle);
 
 	Texture* newTexture = new Texture(this);
 	newTexture->m_name = config.m_name;
@@ -1073,11 +1270,11 @@ Texture* DX12Renderer::CreateTextureCubeFromSixFaces(TextureCubeSixFacesConfig c
 	return newTexture;
 }
 
-BitmapFont* DX12Renderer::GetBitmapFont(char const* bitmapFontFilePathWithNoExtension)
+BitmapFont* DX12Renderer::GetBitmapFont(char const* bitmapFontFilePathWithNoExtension, bool isSDF /*= false*/)
 {
 	for (int i = 0; i < static_cast<int>(m_loadedFonts.size()); ++i)
 	{
-		if (m_loadedFonts[i]->m_fontFilePathNameWithNoExtension == bitmapFontFilePathWithNoExtension)
+		if (m_loadedFonts[i]->m_fontFilePathNameWithNoExtension == bitmapFontFilePathWithNoExtension && m_loadedFonts[i]->IsSDF() == isSDF)
 		{
 			return m_loadedFonts[i];
 		}
@@ -1095,6 +1292,17 @@ BitmapFont* DX12Renderer::CreateBitmapFont(char const* bitmapFontFilePathWithNoE
 	return newFont;
 }
 
+BitmapFont* DX12Renderer::CreateSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config)
+{
+	std::string imageFilePath(bitmapFontFilePathWithNoExtension);
+	imageFilePath += ".png";
+	SDFFontAtlas atlas = GenerateSDFFontAtlas(Image(imageFilePath.c_str()), config);
+	Texture* atlasTexture = CreateTextureFromImage(atlas.m_image);
+	BitmapFont* newFont = new BitmapFont(bitmapFontFilePathWithNoExtension, *atlasTexture, atlas);
+	m_loadedFonts.push_back(newFont);
+	return newFont;
+}
+
 Shader* DX12Renderer::GetShader(char const* shaderName)
 {
 	for (int i = 0; i < static_cast<int>(m_loadedShaders.size()); ++i)
@@ -1613,7 +1821,7 @@ void DX12Renderer::CreateDescriptorHeaps()
 
 	m_rtvDescriptorHeap = new DX12DescriptorHeap(256, 0, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, false);
 	m_dsvDescriptorHeap = new DX12DescriptorHeap(256, 0, D3D12_DESCRIPTOR_HEAP_TYPE_DSV, false);
-	m_cbvSrvUavDescriptorHeap = new DX12DescriptorHeap(2048, 2048, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+	m_cbvSrvUavDescriptorHeap = new DX12DescriptorHeap(2048, 2048 * FRAMES_IN_FLIGHT, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
 	m_samplerDescriptorHeap = new DX12DescriptorHeap(256, 0, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, true);
 
 	m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
@@ -1644,10 +1852,7 @@ void DX12Renderer::CreateRenderTargetViews()
 
 		//m_swapChainBufferRtvIndex[i] = alloc.m_index;
 
-		for (uint32_t j = 0; j < m_rtvDescriptorHeap->GetNumHeaps(); ++j)
-		{ 
-			m_device->CreateRenderTargetView(m_swapChainBuffer[i], nullptr, alloc.m_handles[j]);
-		}
+		m_device->CreateRenderTargetView(m_swapChainBuffer[i], nullptr, alloc.m_handle);
 	}
 }
 
@@ -2063,55 +2268,36 @@ void DX12Renderer::InitializeDefaultSamplers()
 	PersistentDescriptorAlloc alloc;
 
 	alloc = m_samplerDescriptorHeap->AllocatePersistent();
-	for (uint32_t i = 0; i < m_samplerDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateSampler(&samplerDesc_pointWrap, alloc.m_handles[i]);
-	}
+	m_device->CreateSampler(&samplerDesc_pointWrap, alloc.m_handle);
 	m_defaultSamplers[(int)SamplerMode::POINT_WARP] = alloc.m_index;
 
 	alloc = m_samplerDescriptorHeap->AllocatePersistent();
-	for (uint32_t i = 0; i < m_samplerDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateSampler(&samplerDesc_pointClamp, alloc.m_handles[i]);
-	}
+	m_device->CreateSampler(&samplerDesc_pointClamp, alloc.m_handle);
 	m_defaultSamplers[(int)SamplerMode::POINT_CLAMP] = alloc.m_index;
 
 	alloc = m_samplerDescriptorHeap->AllocatePersistent();
-	for (uint32_t i = 0; i < m_samplerDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateSampler(&samplerDesc_linearWrap, alloc.m_handles[i]);
-	}
+	m_device->CreateSampler(&samplerDesc_linearWrap, alloc.m_handle);
 	m_defaultSamplers[(int)SamplerMode::BILINEAR_WRAP] = alloc.m_index;
 
 	alloc = m_samplerDescriptorHeap->AllocatePersistent();
-	for (uint32_t i = 0; i < m_samplerDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateSampler(&samplerDesc_linearClamp, alloc.m_handles[i]);
-	}
+	m_device->CreateSampler(&samplerDesc_linearClamp, alloc.m_handle);
 	m_defaultSamplers[(int)SamplerMode::BILINEAR_CLAMP] = alloc.m_index;
 
 	alloc = m_samplerDescriptorHeap->AllocatePersistent();
-	for (uint32_t i = 0; i < m_samplerDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateSampler(&samplerDesc_anisoWrap, alloc.m_handles[i]);
-	}
+	m_device->CreateSampler(&samplerDesc_anisoWrap, alloc.m_handle);
 	m_defaultSamplers[(int)SamplerMode::ANISO_WARP] = alloc.m_index;
 
 	alloc = m_samplerDescriptorHeap->AllocatePersistent();
-	for (uint32_t i = 0; i < m_samplerDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateSampler(&samplerDesc_anisoClamp, alloc.m_handles[i]);
-	}
+	m_device->CreateSampler(&samplerDesc_anisoClamp, alloc.m_handle);
 	m_defaultSamplers[(int)SamplerMode::ANISO_CLAMP] = alloc.m_index;
 }
 
 void DX12Renderer::InitializeFrameResources()
 {
-	m_mainLinearAllocator = new DX12LinearAllocator(m_device, MAX_MAIN_LINEAR_ALLOCATOR_SIZE);
+	m_linearAllocator = new DX12LinearAllocator(m_device, LINEAR_ALLOCATOR_PAGE_SIZE);
 	for (int i = 0; i < FRAMES_IN_FLIGHT; ++i)
 	{
 		m_frameResources[i] = new FrameResource();
-		m_frameResources[i]->m_linearAllocator = new DX12LinearAllocator(m_device, MAX_LINEAR_ALLOCATOR_SIZE);
 		
 		HRESULT hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&(m_frameResources[i]->m_commandAllocator)));
 		GUARANTEE_OR_DIE(SUCCEEDED(hr), "Could not create command allocator.");
@@ -2124,13 +2310,11 @@ void DX12Renderer::DestroyFrameResources()
 	for (int i = 0; i < FRAMES_IN_FLIGHT; ++i)
 	{
 		DX_SAFE_RELEASE(m_frameResources[i]->m_commandAllocator);
-		delete m_frameResources[i]->m_linearAllocator;
-		m_frameResources[i]->m_linearAllocator = nullptr;
 		delete m_frameResources[i];
 		m_frameResources[i] = nullptr;
 	}
-	delete m_mainLinearAllocator;
-	m_mainLinearAllocator = nullptr;
+	delete m_linearAllocator;
+	m_linearAllocator = nullptr;
 }
 
 void DX12Renderer::SetDebugNameForBasicDXObjects()
@@ -2182,11 +2366,7 @@ D3D12_CPU_DESCRIPTOR_HANDLE DX12Renderer::GetCPUHandleFromDescriptorHandle(Descr
 
 DX12LinearAllocator* DX12Renderer::GetCurrentLinearAllocator() const
 {
-	if (IsBeforeTheFirstFrame())
-	{
-		return m_mainLinearAllocator;
-	}
-	return m_currFrameResource->m_linearAllocator;
+	return m_linearAllocator;
 }
 
 uint64_t DX12Renderer::Signal()
@@ -2602,10 +2782,7 @@ DescriptorHandle DX12Renderer::AllocateSRV(Texture& texture, DXGI_FORMAT format
 		}
 	}
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateShaderResourceView(texture.m_resource, &srvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateShaderResourceView(texture.m_resource, &srvDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
@@ -2644,10 +2821,7 @@ DescriptorHandle DX12Renderer::AllocateUAV(Texture& texture, DXGI_FORMAT format
 		return {};
 	}
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateUnorderedAccessView(texture.m_resource, nullptr, &uavDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateUnorderedAccessView(texture.m_resource, nullptr, &uavDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
@@ -2686,10 +2860,7 @@ DescriptorHandle DX12Renderer::AllocateRTV(Texture& texture, DXGI_FORMAT format
 		return {};
 	}
 
-	for (uint32_t i = 0; i < m_rtvDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateRenderTargetView(texture.m_resource, &rtvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateRenderTargetView(texture.m_resource, &rtvDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::RTV;
@@ -2723,10 +2894,7 @@ DescriptorHandle DX12Renderer::AllocateDSV(Texture& texture, DXGI_FORMAT format
 
 	dsvDesc.Flags = D3D12_DSV_FLAG_NONE;
 
-	for (uint32_t i = 0; i < m_dsvDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateDepthStencilView(texture.m_resource, &dsvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateDepthStencilView(texture.m_resource, &dsvDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::DSV;
@@ -2895,10 +3063,7 @@ DescriptorHandle DX12Renderer::AllocateConstantBufferView(Buffer const& buffer)
 	cbvDesc.BufferLocation = buffer.m_resource->GetGPUVirtualAddress();
 	cbvDesc.SizeInBytes = (UINT)buffer.m_size;
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateConstantBufferView(&cbvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateConstantBufferView(&cbvDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
@@ -2919,10 +3084,7 @@ DescriptorHandle DX12Renderer::AllocateStructuredBufferSRV(Buffer const& buffer,
 	srvDesc.Buffer.StructureByteStride = elementSize;
 	srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateShaderResourceView(buffer.m_resource, &srvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateShaderResourceView(buffer.m_resource, &srvDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
@@ -2946,10 +3108,7 @@ DescriptorHandle DX12Renderer::AllocateStructuredBufferUAV(Buffer const& buffer,
 	uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
 
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateUnorderedAccessView(buffer.m_resource, nullptr, &uavDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateUnorderedAccessView(buffer.m_resource, nullptr, &uavDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
@@ -2970,10 +3129,7 @@ DescriptorHandle DX12Renderer::AllocateRawBufferSRV(const Buffer& buffer, unsign
 	srvDesc.Buffer.StructureByteStride = 0;
 	srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW; // must have raw flag
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateShaderResourceView(buffer.m_resource, &srvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateShaderResourceView(buffer.m_resource, &srvDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
@@ -2996,10 +3152,7 @@ DescriptorHandle DX12Renderer::AllocateRawBufferUAV(const Buffer& buffer, unsign
 	uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW; // must have raw flag
 
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateUnorderedAccessView(buffer.m_resource, nullptr, &uavDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateUnorderedAccessView(buffer.m_resource, nullptr, &uavDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
@@ -3020,10 +3173,7 @@ DescriptorHandle DX12Renderer::AllocateFormattedBufferSRV(Buffer const& buffer,
 	srvDesc.Buffer.StructureByteStride = 0;
 	srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateShaderResourceView(buffer.m_resource, &srvDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateShaderResourceView(buffer.m_resource, &srvDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
@@ -3046,10 +3196,7 @@ DescriptorHandle DX12Renderer::AllocateFormattedBufferUAV(Buffer const& buffer,
 	uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
 
 
-	for (uint32_t i = 0; i < m_cbvSrvUavDescriptorHeap->GetNumHeaps(); ++i)
-	{
-		m_device->CreateUnorderedAccessView(buffer.m_resource, nullptr, &uavDesc, alloc.m_handles[i]);
-	}
+	m_device->CreateUnorderedAccessView(buffer.m_resource, nullptr, &uavDesc, alloc.m_handle);
 
 	DescriptorHandle result;
 	result.m_type = DescriptorHeapType::CBV_SRV_UAV;
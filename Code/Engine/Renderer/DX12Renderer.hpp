@@ -91,6 +91,8 @@ public:
 	void CopyCPUToGPU(const void* data, unsigned int size, VertexBuffer* vbo) override;
 	void CopyCPUToGPU(const void* data, unsigned int size, IndexBuffer* ibo) override;
 	void CopyCPUToGPU(const void* data, unsigned int size, ConstantBuffer* cbo) override;
+	void CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, VertexBuffer* vbo) override;
+	void CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, IndexBuffer* ibo) override;
 public:
 	void DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes) override;
 	void DrawVertexArray(std::vector<Vertex_PCU> const& verts) override;
@@ -101,6 +103,10 @@ public:
 	void DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount) override;
 	void DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount) override;
 
+	void SetInstanceData(int numInstances, InstanceData const* instances) override;
+	void DrawVertexBufferInstanced(VertexBuffer* vbo, unsigned int vertexCount, int numInstances) override;
+	void DrawIndexedVertexBufferInstanced(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount, int numInstances) override;
+
 	void DrawProcedural(unsigned int vertexCount) override;
 
 public:
@@ -146,6 +152,7 @@ public:
 	uint32_t GetCurrentLightConstantsIndex() const override { return m_tempLightConstantsIndex; }
 	uint32_t GetCurrentCameraConstantsIndex() const override { return m_tempCameraConstantsIndex; }
 	uint32_t GetCurrentModelConstantsIndex() const override { return m_tempModelConstantsIndex; }
+	uint32_t GetCurrentInstanceDataIndex() const override { return m_tempInstanceDataIndex; }
 
 
 protected:
@@ -161,6 +168,7 @@ protected:
 	- LightConstants		: Remember Last Frame Data
 	- CameraConstants		: Clear each frame
 	- ModelConstants		: Clear each frame
+	- InstanceData			: Clear each frame
 	*/
 	// Remember to reset to -1 in Begin Frame
 	// descriptorHeap->AllocateTemporary(1)
@@ -169,12 +177,16 @@ protected:
 	uint32_t m_tempLightConstantsIndex = INVALID_INDEX_U32;
 	uint32_t m_tempCameraConstantsIndex = INVALID_INDEX_U32;
 	uint32_t m_tempModelConstantsIndex = INVALID_INDEX_U32;
+	uint32_t m_tempInstanceDataIndex = INVALID_INDEX_U32;
+	int m_numUploadedInstances = 0;
 
 public:
 	//-----------------------------------------------------------------------------------------------
 	// Manage Resources - Public
 	//-----------------------------------------------------------------------------------------------
 	Texture* CreateOrGetTextureFromFile(char const* imageFilePath) override;
+	Texture* CreateOrGetTextureFromImage(Image const& image) override;
+	Texture* CreateOrGetTextureFromCooked(CookedTexture const& cooked) override;
 	Texture* CreateOrGetTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config) override;
 
 	// If not loaded, create by yourself, please use the allocated index
@@ -182,6 +194,7 @@ public:
 	uint32_t GetDefaultSamplerIndex(SamplerMode mode) const override { return m_defaultSamplers[(int)mode]; }
 
 	BitmapFont* CreateOrGetBitmapFont(char const* bitmapFontFilePathWithNoExtension) override;
+	BitmapFont* CreateOrGetSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config = SDFFontConfig()) override;
 
 	// D3D Compile, not used
 	Shader* CreateOrGetShader(char const* shaderName, VertexType type = VertexType::VERTEX_PCU) override;
@@ -197,12 +210,14 @@ protected:
 	Texture* GetTextureForFileName(char const* imageFilePath);
 	Texture* CreateTextureFromFile(char const* imageFilePath);
 	Texture* CreateTextureFromImage(Image const& image);
+	Texture* CreateTextureFromCooked(CookedTexture const& cooked);
 	Texture* CreateTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config);
 	
 	uint32_t GetDefaultTextureSrvIndex(DefaultTexture type);
 
-	BitmapFont* GetBitmapFont(char const* bitmapFontFilePathWithNoExtension);
+	BitmapFont* GetBitmapFont(char const* bitmapFontFilePathWithNoExtension, bool isSDF = false);
 	BitmapFont* CreateBitmapFont(char const* bitmapFontFilePathWithNoExtension);
+	BitmapFont* CreateSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config);
 
 	Shader* GetShader(char const* shaderName);
 	Shader* CreateShader(char const* shaderName, VertexType type = VertexType::VERTEX_PCU);
@@ -410,7 +425,6 @@ protected:
 protected:
 	struct FrameResource 
 	{
-		DX12LinearAllocator* m_linearAllocator = nullptr;
 		ID3D12CommandAllocator* m_commandAllocator = nullptr;
 		uint64_t m_fenceValue = 0;
 	};
@@ -447,7 +461,8 @@ protected:
 	// However, a command allocator must only be reset after the GPU has finished executing all commands recording with it.
 	// if you never reset the command allocator, the app will render normally. but the memory will be used up very soon.
 	ID3D12CommandAllocator*			m_mainCommandAllocator = nullptr;
-	DX12LinearAllocator*			m_mainLinearAllocator = nullptr;
+	// Upload pages shared by every frame in flight, pages go back to the pool once their fence passes
+	DX12LinearAllocator*			m_linearAllocator = nullptr;
 	bool							m_isCommandListOpened = false; // is opened when not between Renderer::BeginFrame and Renderer::EndFrame
 
 
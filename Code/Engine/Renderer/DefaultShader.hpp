@@ -64,6 +64,132 @@ float4 PixelMain(v2p_t input) : SV_Target0
 }
 )";
 
+// Default shader with the model transform and color read per instance, VertexType::VERTEX_PCU_INSTANCED
+inline const char* g_defaultInstancedShaderSource = R"(
+cbuffer CameraConstants: register(b2)
+{
+	float4x4 	WorldToCameraTransform;	// View transform
+	float4x4 	CameraToRenderTransform;	// Non-standard transform from game to DirectX conventions
+	float4x4 	RenderToClipTransform;		// Projection transform
+	float3	 	CameraWorldPosition;       // Camera World Position
+	float		padding_20;
+};
+
+Texture2D diffuseTexture : register(t0);
+SamplerState diffuseSampler : register(s0);
+
+//-----------------------------------------------------------------------------------------------
+struct vs_input_t
+{
+	float3 modelSpacePosition : POSITION;
+	float4 color : COLOR;
+	float2 uv : TEXCOORD;
+
+	float4 instanceI : INSTANCE_TRANSFORM0;
+	float4 instanceJ : INSTANCE_TRANSFORM1;
+	float4 instanceK : INSTANCE_TRANSFORM2;
+	float4 instanceT : INSTANCE_TRANSFORM3;
+	float4 instanceColor : INSTANCE_COLOR;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct v2p_t
+{
+	float4 clipSpacePosition : SV_Position;
+	float4 color : COLOR;
+	float2 uv : TEXCOORD;
+};
+
+
+v2p_t VertexMain(vs_input_t input)
+{
+	float3 p = input.modelSpacePosition;
+	float4 worldSpacePosition = input.instanceI * p.x + input.instanceJ * p.y + input.instanceK * p.z + input.instanceT;
+	float4 cameraSpacePosition = mul(WorldToCameraTransform, worldSpacePosition);
+	float4 renderSpacePosition = mul(CameraToRenderTransform, cameraSpacePosition);
+	float4 clipSpacePosition = mul(RenderToClipTransform, renderSpacePosition);
+
+	v2p_t v2p;
+	v2p.clipSpacePosition = clipSpacePosition;
+	v2p.color = input.color * input.instanceColor;
+	v2p.uv = input.uv;
+	return v2p;
+}
+
+float4 PixelMain(v2p_t input) : SV_Target0
+{
+	float4 textureColor = diffuseTexture.Sample(diffuseSampler, input.uv);
+	float4 color = textureColor * input.color;
+	clip(color.a - 0.01f);
+	return float4(color);
+}
+)";
+
+// Text of BitmapFont::IsSDF() fonts, the atlas alpha is the distance to the glyph edge (0.5 on it).
+// The edge is smoothed over about one screen pixel at any cell height
+inline const char* g_sdfTextShaderSource = R"(
+cbuffer CameraConstants: register(b2)
+{
+	float4x4 	WorldToCameraTransform;	// View transform
+	float4x4 	CameraToRenderTransform;	// Non-standard transform from game to DirectX conventions
+	float4x4 	RenderToClipTransform;		// Projection transform
+	float3	 	CameraWorldPosition;       // Camera World Position
+	float		padding_20;
+};
+
+cbuffer ModelConstants: register(b3)
+{
+	float4x4 ModelToWorldTransform;    // Model Transform
+	float4 ModelColor;
+};
+
+Texture2D sdfTexture : register(t0);
+SamplerState sdfSampler : register(s0);
+
+//-----------------------------------------------------------------------------------------------
+struct vs_input_t
+{
+	float3 modelSpacePosition : POSITION;
+	float4 color : COLOR;
+	float2 uv : TEXCOORD;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct v2p_t
+{
+	float4 clipSpacePosition : SV_Position;
+	float4 color : COLOR;
+	float2 uv : TEXCOORD;
+};
+
+
+v2p_t VertexMain(vs_input_t input)
+{
+	float4 modelSpacePosition = float4(input.modelSpacePosition, 1);
+	float4 worldSpacePosition = mul(ModelToWorldTransform, modelSpacePosition);
+	float4 cameraSpacePosition = mul(WorldToCameraTransform, worldSpacePosition);
+	float4 renderSpacePosition = mul(CameraToRenderTransform, cameraSpacePosition);
+	float4 clipSpacePosition = mul(RenderToClipTransform, renderSpacePosition);
+
+	v2p_t v2p;
+	v2p.clipSpacePosition = clipSpacePosition;
+	v2p.color = input.color;
+	v2p.uv = input.uv;
+	return v2p;
+}
+
+float4 PixelMain(v2p_t input) : SV_Target0
+{
+	float distance = sdfTexture.Sample(sdfSampler, input.uv).a;
+	float edgeWidth = max(fwidth(distance) * 0.7f, 0.001f);
+	float coverage = smoothstep(0.5f - edgeWidth, 0.5f + edgeWidth, distance);
+	float4 color = input.color * ModelColor;
+	color.a *= coverage;
+	clip(color.a - 0.01f);
+	return float4(color);
+}
+)";
+
 #endif // ENGINE_RENDER_D3D11
 
 #ifdef ENGINE_RENDER_D3D12
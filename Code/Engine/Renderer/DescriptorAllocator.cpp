@@ -0,0 +1,278 @@
+#include "Engine/Renderer/DescriptorAllocator.hpp"
+#include "Engine/Renderer/RendererCommon.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include <iterator>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+DescriptorRangeAllocator::DescriptorRangeAllocator(uint32_t capacity /*= 0*/)
+{
+	Reset(capacity);
+}
+
+void DescriptorRangeAllocator::Reset(uint32_t capacity)
+{
+	m_capacity = capacity;
+	m_numAllocated = 0;
+	m_freeByOffset.clear();
+	m_freeBySize.clear();
+	m_allocatedSizes.clear();
+	if (capacity > 0)
+	{
+		AddFreeBlock(0, capacity);
+	}
+}
+
+uint32_t DescriptorRangeAllocator::Allocate(uint32_t count)
+{
+	if (count == 0)
+	{
+		return INVALID_INDEX_U32;
+	}
+
+	auto sizeIter = m_freeBySize.lower_bound(count);
+	if (sizeIter == m_freeBySize.end())
+	{
+		return INVALID_INDEX_U32;
+	}
+
+	uint32_t blockStart = sizeIter->second;
+	uint32_t blockCount = sizeIter->first;
+	RemoveFreeBlock(m_freeByOffset.find(blockStart));
+	if (blockCount > count)
+	{
+		AddFreeBlock(blockStart + count, blockCount - count);
+	}
+
+	m_allocatedSizes[blockStart] = count;
+	m_numAllocated += count;
+	return blockStart;
+}
+
+bool DescriptorRangeAllocator::Free(uint32_t startIndex)
+{
+	auto allocatedIter = m_allocatedSizes.find(startIndex);
+	if (allocatedIter == m_allocatedSizes.end())
+	{
+		return false;
+	}
+
+	uint32_t blockStart = startIndex;
+	uint32_t blockCount = allocatedIter->second;
+	m_allocatedSizes.erase(allocatedIter);
+	m_numAllocated -= blockCount;
+
+	// Merge with the free neighbours on both sides
+	auto nextIter = m_freeByOffset.lower_bound(blockStart);
+	if (nextIter != m_freeByOffset.begin())
+	{
+		auto prevIter = std::prev(nextIter);
+		if (prevIter->first + prevIter->second == blockStart)
+		{
+			blockStart = prevIter->first;
+			blockCount += prevIter->second;
+			RemoveFreeBlock(prevIter);
+		}
+	}
+	nextIter = m_freeByOffset.lower_bound(blockStart + blockCount);
+	if (nextIter != m_freeByOffset.end() && nextIter->first == blockStart + blockCount)
+	{
+		blockCount += nextIter->second;
+		RemoveFreeBlock(nextIter);
+	}
+
+	AddFreeBlock(blockStart, blockCount);
+	return true;
+}
+
+uint32_t DescriptorRangeAllocator::GetRangeSize(uint32_t startIndex) const
+{
+	auto allocatedIter = m_allocatedSizes.find(startIndex);
+	return (allocatedIter == m_allocatedSizes.end()) ? 0 : allocatedIter->second;
+}
+
+uint32_t DescriptorRangeAllocator::GetLargestFreeBlock() const
+{
+	return m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first;
+}
+
+float DescriptorRangeAllocator::GetFragmentation() const
+{
+	uint32_t numFree = m_capacity - m_numAllocated;
+	if (numFree == 0)
+	{
+		return 0.f;
+	}
+	return 1.f - static_cast<float>(GetLargestFreeBlock()) / static_cast<float>(numFree);
+}
+
+void DescriptorRangeAllocator::AddFreeBlock(uint32_t startIndex, uint32_t count)
+{
+	m_freeByOffset[startIndex] = count;
+	m_freeBySize.emplace(count, startIndex);
+}
+
+void DescriptorRangeAllocator::RemoveFreeBlock(std::map<uint32_t, uint32_t>::iterator offsetIter)
+{
+	auto sizeRange = m_freeBySize.equal_range(offsetIter->second);
+	for (auto sizeIter = sizeRange.first; sizeIter != sizeRange.second; ++sizeIter)
+	{
+		if (sizeIter->second == offsetIter->first)
+		{
+			m_freeBySize.erase(sizeIter);
+			break;
+		}
+	}
+	m_freeByOffset.erase(offsetIter);
+}
+
+//-----------------------------------------------------------------------------------------------
+DescriptorRing::DescriptorRing(uint32_t capacity /*= 0*/)
+{
+	Reset(capacity);
+}
+
+void DescriptorRing::Reset(uint32_t capacity)
+{
+	m_capacity = capacity;
+	m_head = 0;
+	m_numUsed = 0;
+	m_numOpen = 0;
+	m_peakUsed = 0;
+	m_retiredFrames.clear();
+}
+
+uint32_t DescriptorRing::Allocate(uint32_t count)
+{
+	if (count == 0 || count > m_capacity)
+	{
+		return INVALID_INDEX_U32;
+	}
+	if (m_numUsed == 0)
+	{
+		m_head = 0;
+	}
+
+	uint32_t numFree = m_capacity - m_numUsed;
+	uint32_t numSkipped = 0;
+	if (m_head + count > m_capacity)
+	{
+		// The range cannot wrap, the tail up to the end stays unused until this frame retires
+		numSkipped = m_capacity - m_head;
+	}
+	if (numSkipped + count > numFree)
+	{
+		return INVALID_INDEX_U32;
+	}
+
+	uint32_t startIndex = (numSkipped > 0) ? 0 : m_head;
+	m_head = (startIndex + count) % m_capacity;
+	m_numUsed += numSkipped + count;
+	m_numOpen += numSkipped + count;
+	if (m_numUsed > m_peakUsed)
+	{
+		m_peakUsed = m_numUsed;
+	}
+	return startIndex;
+}
+
+void DescriptorRing::RetireFrame(uint64_t fenceValue)
+{
+	if (m_numOpen == 0)
+	{
+		return;
+	}
+	GUARANTEE_OR_DIE(m_retiredFrames.empty() || m_retiredFrames.back().m_fenceValue <= fenceValue, "Descriptor ring frames must be retired in fence order.");
+
+	RetiredFrame frame;
+	frame.m_fenceValue = fenceValue;
+	frame.m_count = m_numOpen;
+	m_retiredFrames.push_back(frame);
+	m_numOpen = 0;
+}
+
+void DescriptorRing::Recycle(uint64_t completedFenceValue)
+{
+	while (!m_retiredFrames.empty() && m_retiredFrames.front().m_fenceValue <= completedFenceValue)
+	{
+		m_numUsed -= m_retiredFrames.front().m_count;
+		m_retiredFrames.pop_front();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string DescriptorAllocatorBenchmarkResult::ToString() const
+{
+	return Stringf("%u descriptors, %d operations, %d failed, peak %u. Free blocks %d, largest %u, fragmentation %.3f. Range operations per ms %.0f, ring allocations per ms %.0f",
+		m_capacity, m_numOperations, m_numFailedAllocations, m_peakAllocated, m_numFreeBlocks, m_largestFreeBlock, m_fragmentation, m_rangeOperationsPerMs, m_ringAllocationsPerMs);
+}
+
+DescriptorAllocatorBenchmarkResult RunDescriptorAllocatorBenchmark(uint32_t capacity, int numOperations, uint32_t maxTableSize /*= 32*/)
+{
+	RandomNumberGenerator rng;
+	DescriptorAllocatorBenchmarkResult result;
+	result.m_capacity = capacity;
+	result.m_numOperations = numOperations;
+	maxTableSize = (maxTableSize < 2) ? 2 : maxTableSize;
+
+	DescriptorRangeAllocator rangeAllocator(capacity);
+	std::vector<uint32_t> liveRanges;
+	liveRanges.reserve(capacity);
+
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int operation = 0; operation < numOperations; ++operation)
+	{
+		bool shouldAllocate = liveRanges.empty() || (rangeAllocator.GetNumAllocated() < capacity / 2 && rng.RollRandomWithProbability(0.6f));
+		if (shouldAllocate)
+		{
+			// Mostly single textures and buffers, now and then a material or bindless table
+			uint32_t count = rng.RollRandomWithProbability(0.8f) ? 1u : static_cast<uint32_t>(rng.RollRandomIntInRange(2, static_cast<int>(maxTableSize)));
+			uint32_t startIndex = rangeAllocator.Allocate(count);
+			if (startIndex == INVALID_INDEX_U32)
+			{
+				++result.m_numFailedAllocations;
+				continue;
+			}
+			liveRanges.push_back(startIndex);
+			if (rangeAllocator.GetNumAllocated() > result.m_peakAllocated)
+			{
+				result.m_peakAllocated = rangeAllocator.GetNumAllocated();
+			}
+		}
+		else
+		{
+			int liveIndex = rng.RollRandomIntLessThan(static_cast<int>(liveRanges.size()));
+			rangeAllocator.Free(liveRanges[liveIndex]);
+			liveRanges[liveIndex] = liveRanges.back();
+			liveRanges.pop_back();
+		}
+	}
+	double milliseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+	result.m_rangeOperationsPerMs = (milliseconds > 0.0) ? numOperations / milliseconds : 0.0;
+	result.m_numFreeBlocks = rangeAllocator.GetNumFreeBlocks();
+	result.m_largestFreeBlock = rangeAllocator.GetLargestFreeBlock();
+	result.m_fragmentation = rangeAllocator.GetFragmentation();
+
+	// Three frames in flight, each taking a few single descriptors and tables
+	DescriptorRing ring(capacity);
+	uint64_t fenceValue = 0;
+	int numRingAllocations = 0;
+	startSeconds = GetCurrentTimeSeconds();
+	while (numRingAllocations < numOperations)
+	{
+		ring.Recycle((fenceValue >= FRAMES_IN_FLIGHT) ? fenceValue - FRAMES_IN_FLIGHT + 1 : 0);
+		uint32_t numFrameAllocations = capacity / (4 * FRAMES_IN_FLIGHT) + 1;
+		for (uint32_t allocIndex = 0; allocIndex < numFrameAllocations && numRingAllocations < numOperations; ++allocIndex)
+		{
+			ring.Allocate((allocIndex % 8 == 0) ? 4u : 1u);
+			++numRingAllocations;
+		}
+		ring.RetireFrame(++fenceValue);
+	}
+	milliseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+	result.m_ringAllocationsPerMs = (milliseconds > 0.0) ? numRingAllocations / milliseconds : 0.0;
+	return result;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+//-----------------------------------------------------------------------------------------------
+// Index bookkeeping of a descriptor heap, no graphics API in here. Both hand out index ranges of
+// [0, capacity), the heap adds its own base offset and turns them into handles.
+//-----------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------
+// Contiguous ranges for persistent descriptors and descriptor tables.
+//
+// Free blocks are kept by offset, to merge a freed range with its neighbours, and by size, to
+// take the smallest block that fits. Best fit keeps the large blocks whole for large tables.
+//
+class DescriptorRangeAllocator
+{
+public:
+	explicit DescriptorRangeAllocator(uint32_t capacity = 0);
+	void Reset(uint32_t capacity);
+
+	// Start index of count contiguous descriptors, INVALID_INDEX_U32 when no free block is big enough
+	uint32_t Allocate(uint32_t count);
+	// Frees the whole range that started at startIndex, returns false if none did
+	bool Free(uint32_t startIndex);
+
+	uint32_t GetCapacity() const { return m_capacity; }
+	uint32_t GetNumAllocated() const { return m_numAllocated; }
+	uint32_t GetRangeSize(uint32_t startIndex) const;
+	int GetNumFreeBlocks() const { return static_cast<int>(m_freeByOffset.size()); }
+	uint32_t GetLargestFreeBlock() const;
+	// 0 when every free descriptor is one block, towards 1 the more it is split up
+	float GetFragmentation() const;
+
+protected:
+	void AddFreeBlock(uint32_t startIndex, uint32_t count);
+	void RemoveFreeBlock(std::map<uint32_t, uint32_t>::iterator offsetIter);
+
+protected:
+	uint32_t									m_capacity = 0;
+	uint32_t									m_numAllocated = 0;
+	std::map<uint32_t, uint32_t>				m_freeByOffset;		// start -> count
+	std::multimap<uint32_t, uint32_t>			m_freeBySize;		// count -> start
+	std::unordered_map<uint32_t, uint32_t>		m_allocatedSizes;	// start -> count
+};
+
+//-----------------------------------------------------------------------------------------------
+// Fence tracked ring for descriptors that live for one frame.
+//
+// Allocations are contiguous, a range that would cross the end skips the tail and starts over at
+// 0. RetireFrame tags everything allocated since the last retire with a fence value and Recycle
+// frees it once the GPU has passed that fence, so one ring is shared by every frame in flight.
+//
+class DescriptorRing
+{
+public:
+	explicit DescriptorRing(uint32_t capacity = 0);
+	void Reset(uint32_t capacity);
+
+	// Start index of count contiguous descriptors, INVALID_INDEX_U32 when the ring is full
+	uint32_t Allocate(uint32_t count);
+	void RetireFrame(uint64_t fenceValue);
+	void Recycle(uint64_t completedFenceValue);
+
+	uint32_t GetCapacity() const { return m_capacity; }
+	uint32_t GetNumUsed() const { return m_numUsed; }
+	uint32_t GetPeakUsed() const { return m_peakUsed; }
+
+protected:
+	struct RetiredFrame
+	{
+		uint64_t m_fenceValue = 0;
+		uint32_t m_count = 0;
+	};
+
+	uint32_t					m_capacity = 0;
+	uint32_t					m_head = 0;			// next index handed out
+	uint32_t					m_numUsed = 0;		// from the oldest live frame up to m_head, skipped tails included
+	uint32_t					m_numOpen = 0;		// used since the last retire
+	uint32_t					m_peakUsed = 0;
+	std::deque<RetiredFrame>	m_retiredFrames;	// ascending fence values
+};
+
+//-----------------------------------------------------------------------------------------------
+struct DescriptorAllocatorBenchmarkResult
+{
+	uint32_t	m_capacity = 0;
+	int			m_numOperations = 0;
+	int			m_numFailedAllocations = 0;
+	uint32_t	m_peakAllocated = 0;
+	int			m_numFreeBlocks = 0;
+	uint32_t	m_largestFreeBlock = 0;
+	float		m_fragmentation = 0.f;
+	double		m_rangeOperationsPerMs = 0.0;
+	double		m_ringAllocationsPerMs = 0.0;
+
+	std::string ToString() const;
+};
+
+// Churns a DescriptorRangeAllocator with random single descriptors and tables of up to
+// maxTableSize, about half the capacity live at a time, then reports how split up it ended and
+// how fast both allocators ran
+DescriptorAllocatorBenchmarkResult RunDescriptorAllocatorBenchmark(uint32_t capacity, int numOperations, uint32_t maxTableSize = 32);
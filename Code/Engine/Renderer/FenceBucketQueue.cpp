@@ -0,0 +1,78 @@
+#include "Engine/Renderer/FenceBucketQueue.hpp"
+#include "Engine/Renderer/RendererCommon.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+
+//-----------------------------------------------------------------------------------------------
+std::string DeferredReleaseBenchmarkResult::ToString() const
+{
+	return Stringf("%d items over %d frames. Reference %.3f ms, fence buckets %.3f ms", m_numItems, m_numFrames, m_referenceMs, m_bucketMs);
+}
+
+DeferredReleaseBenchmarkResult RunDeferredReleaseBenchmark(int numItems, int numFrames)
+{
+	struct MockItem
+	{
+		uint64_t	m_fenceValue = 0;
+		int			m_id = 0;
+	};
+
+	DeferredReleaseBenchmarkResult result;
+	result.m_numItems = numItems;
+	result.m_numFrames = numFrames;
+	int constexpr ITEMS_PER_FRAME = 4;
+	int const unloadFrame = numFrames / 4;
+
+	int numReleasedReference = 0;
+	int numReleasedBuckets = 0;
+
+	// Same enqueue and process pattern for both, only the queue differs
+	auto runFrames = [&](auto const& enqueue, auto const& process)
+		{
+			double startSeconds = GetCurrentTimeSeconds();
+			uint64_t nextFenceValue = 1;
+			for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+			{
+				uint64_t completedFenceValue = (nextFenceValue > FRAMES_IN_FLIGHT) ? nextFenceValue - FRAMES_IN_FLIGHT : 0;
+				process(completedFenceValue);
+
+				int numFrameItems = (frameIndex == unloadFrame) ? numItems : ITEMS_PER_FRAME;
+				for (int itemIndex = 0; itemIndex < numFrameItems; ++itemIndex)
+				{
+					enqueue(nextFenceValue, itemIndex);
+				}
+				++nextFenceValue;
+			}
+			process(UINT64_MAX);
+			return (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+		};
+
+	std::vector<MockItem> referenceQueue;
+	result.m_referenceMs = runFrames(
+		[&](uint64_t fenceValue, int id) { referenceQueue.push_back(MockItem{ fenceValue, id }); },
+		[&](uint64_t completedFenceValue)
+		{
+			auto it = referenceQueue.begin();
+			while (it != referenceQueue.end())
+			{
+				if (it->m_fenceValue <= completedFenceValue)
+				{
+					++numReleasedReference;
+					it = referenceQueue.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		});
+
+	FenceBucketQueue<MockItem> bucketQueue;
+	result.m_bucketMs = runFrames(
+		[&](uint64_t fenceValue, int id) { bucketQueue.Enqueue(fenceValue, MockItem{ fenceValue, id }); },
+		[&](uint64_t completedFenceValue) { bucketQueue.Process(completedFenceValue, [&](MockItem&) { ++numReleasedBuckets; }); });
+
+	GUARANTEE_RECOVERABLE(numReleasedReference == numReleasedBuckets, "Deferred release benchmark queues released different item counts.");
+	return result;
+}
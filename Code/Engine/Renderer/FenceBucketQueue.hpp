@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// Items waiting for the GPU to pass a fence value, grouped in one bucket per fence value.
+//
+// Fence values only grow, so buckets sit in a ring in fence order: Enqueue appends to the newest
+// bucket or opens the next one, and Process releases whole buckets from the oldest end and stops
+// at the first one still in flight. It never looks at pending items. A fence value lower than the
+// newest bucket's goes into the newest bucket, released later than asked, which is always safe.
+// Emptied buckets keep their storage for the next fence value.
+//
+template<typename T>
+class FenceBucketQueue
+{
+public:
+	void Enqueue(uint64_t fenceValue, T const& item);
+
+	// releaseFunction(T&) is called for every item of every bucket with a fence value <= completed
+	template<typename ReleaseFunction>
+	void Process(uint64_t completedFenceValue, ReleaseFunction&& releaseFunction);
+	template<typename ReleaseFunction>
+	void ReleaseAll(ReleaseFunction&& releaseFunction);
+
+	size_t GetNumPending() const { return m_numPending; }
+	int GetNumBuckets() const { return m_numBuckets; }
+
+protected:
+	struct Bucket
+	{
+		uint64_t		m_fenceValue = 0;
+		std::vector<T>	m_items;
+	};
+
+	Bucket& GetBucket(int ringOffset) { return m_buckets[(m_firstBucket + ringOffset) % m_buckets.size()]; }
+	void GrowRing();
+
+protected:
+	std::vector<Bucket>	m_buckets;		// ring storage, m_numBuckets live from m_firstBucket
+	int					m_firstBucket = 0;
+	int					m_numBuckets = 0;
+	size_t				m_numPending = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+void FenceBucketQueue<T>::Enqueue(uint64_t fenceValue, T const& item)
+{
+	if (m_numBuckets == 0 || fenceValue > GetBucket(m_numBuckets - 1).m_fenceValue)
+	{
+		if (m_numBuckets == static_cast<int>(m_buckets.size()))
+		{
+			GrowRing();
+		}
+		++m_numBuckets;
+		GetBucket(m_numBuckets - 1).m_fenceValue = fenceValue;
+	}
+	GetBucket(m_numBuckets - 1).m_items.push_back(item);
+	++m_numPending;
+}
+
+template<typename T>
+template<typename ReleaseFunction>
+void FenceBucketQueue<T>::Process(uint64_t completedFenceValue, ReleaseFunction&& releaseFunction)
+{
+	while (m_numBuckets > 0)
+	{
+		Bucket& bucket = GetBucket(0);
+		if (bucket.m_fenceValue > completedFenceValue)
+		{
+			return;
+		}
+
+		for (T& item : bucket.m_items)
+		{
+			releaseFunction(item);
+		}
+		m_numPending -= bucket.m_items.size();
+		bucket.m_items.clear();
+
+		m_firstBucket = (m_firstBucket + 1) % static_cast<int>(m_buckets.size());
+		--m_numBuckets;
+	}
+}
+
+template<typename T>
+template<typename ReleaseFunction>
+void FenceBucketQueue<T>::ReleaseAll(ReleaseFunction&& releaseFunction)
+{
+	Process(UINT64_MAX, releaseFunction);
+}
+
+template<typename T>
+void FenceBucketQueue<T>::GrowRing()
+{
+	// Unroll the ring so the live buckets start at 0 again, their item storage moves along
+	std::vector<Bucket> buckets(m_buckets.empty() ? 8 : m_buckets.size() * 2);
+	for (int ringOffset = 0; ringOffset < m_numBuckets; ++ringOffset)
+	{
+		buckets[ringOffset] = std::move(GetBucket(ringOffset));
+	}
+	m_buckets.swap(buckets);
+	m_firstBucket = 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+struct DeferredReleaseBenchmarkResult
+{
+	int		m_numItems = 0;
+	int		m_numFrames = 0;
+	double	m_referenceMs = 0.0;	// one vector, erase per released item
+	double	m_bucketMs = 0.0;
+
+	std::string ToString() const;
+};
+
+// A level unload of numItems releases at once plus a few items every frame, processed over
+// numFrames with three frames in flight, against a counting release callback
+DeferredReleaseBenchmarkResult RunDeferredReleaseBenchmark(int numItems, int numFrames);
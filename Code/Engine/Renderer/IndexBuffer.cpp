@@ -113,11 +113,17 @@ void IndexBuffer::Upload(ID3D12GraphicsCommandList* cmdList, void const* data, u
 	{
 		Resize(dataSize);
 	}
+	UploadRange(cmdList, data, dataSize, 0, dataSize);
+}
+
+void IndexBuffer::UploadRange(ID3D12GraphicsCommandList* cmdList, void const* data, unsigned int dataSize, unsigned int destOffset, unsigned int bufferDataSize)
+{
+	GUARANTEE_OR_DIE(destOffset + dataSize <= m_size && bufferDataSize <= m_size, "Buffer range upload is out of bounds");
 
 	// if some one upload a smaller data, the view will change, although no effect. 
 	// because draw call will require a vertex/index count to draw.
 	// it restricts the maximum amount you can use
-	m_actualDataSize = dataSize;
+	m_actualDataSize = bufferDataSize;
 
 	DX12LinearAllocator* allocator = m_renderer->GetCurrentLinearAllocator();
 	size_t alignment = 16;
@@ -146,7 +152,7 @@ void IndexBuffer::Upload(ID3D12GraphicsCommandList* cmdList, void const* data, u
 	}
 
 	cmdList->CopyBufferRegion(
-		m_defaultBuffer, 0,
+		m_defaultBuffer, destOffset,
 		uploadAlloc.m_buffer, uploadAlloc.m_offset,
 		dataSize
 	);
@@ -245,3 +251,16 @@ void IndexBuffer::CreateDefaultBuffer()
 
 
 #endif // ENGINE_RENDER_D3D12
+
+#ifdef ENGINE_RENDER_NULL
+IndexBuffer::IndexBuffer(unsigned int id, unsigned int size)
+	: m_id(id)
+	, m_size(size)
+{
+}
+
+void IndexBuffer::Resize(unsigned int size)
+{
+	m_size = size;
+}
+#endif // ENGINE_RENDER_NULL
@@ -50,6 +50,9 @@ public:
 	void Create();
 	void Resize(unsigned int size);
 	void Upload(ID3D12GraphicsCommandList* cmdList, void const* data, unsigned int dataSize);
+	// Writes dataSize bytes at destOffset and keeps the rest, the buffer then holds bufferDataSize bytes.
+	// Cannot grow the buffer
+	void UploadRange(ID3D12GraphicsCommandList* cmdList, void const* data, unsigned int dataSize, unsigned int destOffset, unsigned int bufferDataSize);
 
 	unsigned int GetSize() const { return m_size; }
 	unsigned int GetStride() const { return sizeof(unsigned int); }
@@ -75,3 +78,29 @@ private:
 	//D3D12_RESOURCE_STATES m_currentResourceState = D3D12_RESOURCE_STATE_COPY_DEST;
 };
 #endif // ENGINE_RENDER_D3D12
+
+#ifdef ENGINE_RENDER_NULL
+//-----------------------------------------------------------------------------------------------
+// No GPU memory behind it, NullRenderer only tracks the size and records the id
+class IndexBuffer
+{
+	friend class NullRenderer;
+
+public:
+	IndexBuffer(const IndexBuffer& copy) = delete;
+	void operator=(IndexBuffer const& copy) = delete;
+	virtual ~IndexBuffer() = default;
+
+	IndexBuffer(unsigned int id, unsigned int size);
+
+	void Resize(unsigned int size);
+
+	unsigned int GetSize() const { return m_size; }
+	unsigned int GetStride() const { return sizeof(unsigned int); }
+	unsigned int GetCount() const { return m_size / GetStride(); }
+
+private:
+	unsigned int m_id = 0;
+	unsigned int m_size = 0;
+};
+#endif // ENGINE_RENDER_NULL
@@ -0,0 +1,318 @@
+#include "Engine/Renderer/InstanceBatch.hpp"
+#include "Engine/Renderer/Culling.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/Camera.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Plane3.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include <cmath>
+
+//-----------------------------------------------------------------------------------------------
+void InstanceBatch::Clear()
+{
+	m_transforms.clear();
+	m_colors.clear();
+	m_boundsX.clear();
+	m_boundsY.clear();
+	m_boundsZ.clear();
+	m_boundsRadius.clear();
+	m_packed.clear();
+}
+
+void InstanceBatch::Reserve(int numInstances)
+{
+	m_transforms.reserve(numInstances);
+	m_colors.reserve(numInstances);
+	m_boundsX.reserve(numInstances);
+	m_boundsY.reserve(numInstances);
+	m_boundsZ.reserve(numInstances);
+	m_boundsRadius.reserve(numInstances);
+	m_packed.reserve(numInstances);
+}
+
+int InstanceBatch::AddInstance(Mat44 const& modelToWorldTransform, Rgba8 const& color /*= Rgba8::OPAQUE_WHITE*/)
+{
+	m_transforms.push_back(modelToWorldTransform);
+	m_colors.push_back(color);
+	m_boundsX.push_back(0.f);
+	m_boundsY.push_back(0.f);
+	m_boundsZ.push_back(0.f);
+	m_boundsRadius.push_back(0.f);
+
+	int instanceIndex = static_cast<int>(m_transforms.size()) - 1;
+	UpdateBounds(instanceIndex);
+	return instanceIndex;
+}
+
+void InstanceBatch::SetInstance(int instanceIndex, Mat44 const& modelToWorldTransform, Rgba8 const& color)
+{
+	m_transforms[instanceIndex] = modelToWorldTransform;
+	m_colors[instanceIndex] = color;
+	UpdateBounds(instanceIndex);
+}
+
+void InstanceBatch::SetLocalBounds(Vec3 const& center, float radius)
+{
+	m_localBoundsCenter = center;
+	m_localBoundsRadius = radius;
+	for (int instanceIndex = 0; instanceIndex < GetNumInstances(); ++instanceIndex)
+	{
+		UpdateBounds(instanceIndex);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+int InstanceBatch::PackAll()
+{
+	m_packed.clear();
+	for (int instanceIndex = 0; instanceIndex < GetNumInstances(); ++instanceIndex)
+	{
+		PackInstance(instanceIndex);
+	}
+	return GetNumPacked();
+}
+
+int InstanceBatch::CullAndPack(Plane3 const* planes, int numPlanes, Vec3 const& viewPosition, float maxDistance /*= 0.f*/)
+{
+	PROFILE_SCOPE("InstanceBatch::CullAndPack");
+
+	m_packed.clear();
+	int numInstances = GetNumInstances();
+	float const* boundsX = m_boundsX.data();
+	float const* boundsY = m_boundsY.data();
+	float const* boundsZ = m_boundsZ.data();
+	float const* boundsRadius = m_boundsRadius.data();
+
+	for (int instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex)
+	{
+		float x = boundsX[instanceIndex];
+		float y = boundsY[instanceIndex];
+		float z = boundsZ[instanceIndex];
+		float radius = boundsRadius[instanceIndex];
+
+		if (maxDistance > 0.f)
+		{
+			float dx = x - viewPosition.x;
+			float dy = y - viewPosition.y;
+			float dz = z - viewPosition.z;
+			float reach = maxDistance + radius;
+			if (dx * dx + dy * dy + dz * dz > reach * reach)
+			{
+				continue;
+			}
+		}
+
+		bool isVisible = true;
+		for (int planeIndex = 0; planeIndex < numPlanes; ++planeIndex)
+		{
+			Plane3 const& plane = planes[planeIndex];
+			float altitude = plane.m_normal.x * x + plane.m_normal.y * y + plane.m_normal.z * z - plane.m_distance;
+			if (altitude < -radius)
+			{
+				isVisible = false;
+				break;
+			}
+		}
+
+		if (isVisible)
+		{
+			PackInstance(instanceIndex);
+		}
+	}
+	return GetNumPacked();
+}
+
+int InstanceBatch::CullAndPack(Frustum const& frustum)
+{
+	return CullAndPack(frustum.m_planes, Frustum::NUM_PLANES, frustum.m_viewPosition, frustum.m_maxDistance);
+}
+
+//-----------------------------------------------------------------------------------------------
+void InstanceBatch::Draw(Renderer* renderer, RenderState const& material, VertexBuffer* vbo, unsigned int vertexCount) const
+{
+	if (BindForDraw(renderer, material))
+	{
+		renderer->DrawVertexBufferInstanced(vbo, vertexCount, GetNumPacked());
+	}
+}
+
+void InstanceBatch::DrawIndexed(Renderer* renderer, RenderState const& material, VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount) const
+{
+	if (BindForDraw(renderer, material))
+	{
+		renderer->DrawIndexedVertexBufferInstanced(vbo, ibo, indexCount, GetNumPacked());
+	}
+}
+
+bool InstanceBatch::BindForDraw(Renderer* renderer, RenderState const& material) const
+{
+	if (m_packed.empty())
+	{
+		return false;
+	}
+
+	RenderState state = material;
+#if defined(ENGINE_RENDER_D3D11) || defined(ENGINE_RENDER_NULL)
+	if (state.m_shader == nullptr)
+	{
+		state.m_shader = renderer->CreateOrGetShader("DefaultInstanced", VertexType::VERTEX_PCU_INSTANCED);
+	}
+#endif // ENGINE_RENDER_D3D11 || ENGINE_RENDER_NULL
+	GUARANTEE_OR_DIE(state.m_shader != nullptr, "Instanced draws need a shader that reads StructuredBuffer<InstanceData>.");
+
+	BindRenderState(renderer, state);
+	renderer->SetInstanceData(GetNumPacked(), m_packed.data());
+
+#ifdef ENGINE_RENDER_D3D12
+	InstancedUnlitRenderResources resources;
+	resources.diffuseTextureIndex = renderer->GetSrvIndexFromLoadedTexture(state.m_texture);
+	resources.diffuseSamplerIndex = renderer->GetDefaultSamplerIndex(state.m_samplerMode);
+	resources.cameraConstantsIndex = renderer->GetCurrentCameraConstantsIndex();
+	resources.instanceDataIndex = renderer->GetCurrentInstanceDataIndex();
+	renderer->SetGraphicsBindlessResources(sizeof(InstancedUnlitRenderResources), &resources);
+#endif // ENGINE_RENDER_D3D12
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+void InstanceBatch::UpdateBounds(int instanceIndex)
+{
+	Mat44 const& transform = m_transforms[instanceIndex];
+	Vec3 worldCenter = transform.TransformPosition3D(m_localBoundsCenter);
+
+	float scaleSquared = transform.GetIBasis3D().GetLengthSquared();
+	float jScaleSquared = transform.GetJBasis3D().GetLengthSquared();
+	float kScaleSquared = transform.GetKBasis3D().GetLengthSquared();
+	scaleSquared = (jScaleSquared > scaleSquared) ? jScaleSquared : scaleSquared;
+	scaleSquared = (kScaleSquared > scaleSquared) ? kScaleSquared : scaleSquared;
+
+	m_boundsX[instanceIndex] = worldCenter.x;
+	m_boundsY[instanceIndex] = worldCenter.y;
+	m_boundsZ[instanceIndex] = worldCenter.z;
+	m_boundsRadius[instanceIndex] = m_localBoundsRadius * sqrtf(scaleSquared);
+}
+
+void InstanceBatch::PackInstance(int instanceIndex)
+{
+	m_packed.emplace_back();
+	InstanceData& instance = m_packed.back();
+	instance.ModelToWorldTransform = m_transforms[instanceIndex];
+	m_colors[instanceIndex].GetAsFloats(instance.ModelColor);
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string InstanceBatchBenchmarkResult::ToString() const
+{
+	return Stringf("%d instances, %d visible, %d frames. Per object draws: %.3f ms/frame, %d draws. InstanceBatch: %.3f ms/frame, %d draws, %zu bytes uploaded, CullAndPack %.3f ms",
+		m_numInstances, m_numVisible, m_numFrames, m_perObjectMsPerFrame, m_perObjectDrawCalls, m_instancedMsPerFrame, m_instancedDrawCalls,
+		m_instancedBytesPerFrame, m_cullAndPackMsPerFrame);
+}
+
+InstanceBatchBenchmarkResult RunInstanceBatchBenchmark(Renderer* renderer, int numInstances, int numFrames)
+{
+	InstanceBatchBenchmarkResult result;
+	result.m_numInstances = numInstances;
+	result.m_numFrames = numFrames;
+	if (numFrames <= 0)
+	{
+		return result;
+	}
+
+	std::vector<Vertex_PCU> cubeVerts;
+	AddVertsForAABB3D(cubeVerts, AABB3(Vec3(-0.5f, -0.5f, -0.5f), Vec3(0.5f, 0.5f, 0.5f)));
+	unsigned int vertexCount = static_cast<unsigned int>(cubeVerts.size());
+	unsigned int vertexBytes = vertexCount * sizeof(Vertex_PCU);
+	VertexBuffer* cubeVBO = renderer->CreateVertexBuffer(vertexBytes, sizeof(Vertex_PCU));
+	renderer->CopyCPUToGPU(cubeVerts.data(), vertexBytes, cubeVBO);
+
+	// The per object path keeps its own copies, the way a game's entities would
+	float const cubeRadius = 0.87f;
+	RandomNumberGenerator rng;
+	InstanceBatch batch;
+	batch.Reserve(numInstances);
+	batch.SetLocalBounds(Vec3(), cubeRadius);
+	std::vector<Mat44> transforms;
+	std::vector<Rgba8> colors;
+	std::vector<Vec3> centers;
+	std::vector<float> radii;
+	transforms.reserve(numInstances);
+	colors.reserve(numInstances);
+	centers.reserve(numInstances);
+	radii.reserve(numInstances);
+	for (int instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex)
+	{
+		Vec3 position(rng.RollRandomFloatInRange(-500.f, 500.f), rng.RollRandomFloatInRange(-500.f, 500.f), rng.RollRandomFloatInRange(-100.f, 100.f));
+		float scale = rng.RollRandomFloatInRange(1.f, 10.f);
+		Mat44 transform = Mat44::MakeTranslation3D(position);
+		transform.AppendScaleUniform3D(scale);
+		Rgba8 color(static_cast<unsigned char>(instanceIndex), 128, 255, 255);
+
+		batch.AddInstance(transform, color);
+		transforms.push_back(transform);
+		colors.push_back(color);
+		centers.push_back(position);
+		radii.push_back(cubeRadius * scale);
+	}
+
+	Camera camera;
+	camera.SetPerspectiveView(16.f / 9.f, 60.f, 0.1f, 1000.f);
+	camera.SetCameraToRenderTransform(Mat44::DIRECTX_C2R);
+	camera.SetPositionAndOrientation(Vec3(-200.f, 0.f, 10.f), EulerAngles(20.f, 0.f, 0.f));
+	Frustum frustum = Frustum::MakeFromCamera(camera, 600.f);
+	RenderState material;
+
+	// What a game without instancing does: every visible object sets its constants and draws
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+	{
+		renderer->BeginFrame();
+		BindRenderState(renderer, material);
+		result.m_perObjectDrawCalls = 0;
+		for (int instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex)
+		{
+			if (frustum.ClassifySphere(centers[instanceIndex], radii[instanceIndex]) < 0)
+			{
+				continue;
+			}
+			renderer->SetModelConstants(transforms[instanceIndex], colors[instanceIndex]);
+#ifdef ENGINE_RENDER_D3D12
+			SetUnlitBindlessResources(renderer, material);
+#endif // ENGINE_RENDER_D3D12
+			renderer->DrawVertexBuffer(cubeVBO, vertexCount);
+			++result.m_perObjectDrawCalls;
+		}
+		renderer->EndFrame();
+	}
+	result.m_perObjectMsPerFrame = (GetCurrentTimeSeconds() - startSeconds) * 1000.0 / static_cast<double>(numFrames);
+
+	startSeconds = GetCurrentTimeSeconds();
+	for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+	{
+		batch.CullAndPack(frustum);
+	}
+	result.m_cullAndPackMsPerFrame = (GetCurrentTimeSeconds() - startSeconds) * 1000.0 / static_cast<double>(numFrames);
+
+	startSeconds = GetCurrentTimeSeconds();
+	for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+	{
+		renderer->BeginFrame();
+		batch.CullAndPack(frustum);
+		batch.Draw(renderer, material, cubeVBO, vertexCount);
+		renderer->EndFrame();
+	}
+	result.m_instancedMsPerFrame = (GetCurrentTimeSeconds() - startSeconds) * 1000.0 / static_cast<double>(numFrames);
+	result.m_numVisible = batch.GetNumPacked();
+	result.m_instancedDrawCalls = (batch.GetNumPacked() > 0) ? 1 : 0;
+	result.m_instancedBytesPerFrame = batch.GetNumPacked() * sizeof(InstanceData);
+
+	delete cubeVBO;
+	return result;
+}
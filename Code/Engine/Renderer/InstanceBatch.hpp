@@ -0,0 +1,94 @@
+#pragma once
+#include "Engine/Renderer/RendererCommon.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include <string>
+#include <vector>
+
+class Renderer;
+class VertexBuffer;
+class IndexBuffer;
+struct Plane3;
+struct Frustum;
+struct RenderState;
+
+//-----------------------------------------------------------------------------------------------
+// The instances of one mesh, drawn with a single instanced draw call.
+//
+// Instances are kept as added. Every frame PackAll or CullAndPack writes the InstanceData array
+// that gets uploaded, so culled instances cost neither upload nor vertex work. Culling runs on
+// world space bounding spheres kept in flat arrays next to the transforms, refreshed when an
+// instance or the local bounds change.
+//
+// With a nullptr shader in the material, DX11 and the null renderer use "DefaultInstanced".
+// DX12 needs a shader reading StructuredBuffer<InstanceData> through InstancedUnlitRenderResources.
+//
+class InstanceBatch
+{
+public:
+	void Clear();
+	void Reserve(int numInstances);
+
+	// Returns the index of the instance, stable until Clear
+	int AddInstance(Mat44 const& modelToWorldTransform, Rgba8 const& color = Rgba8::OPAQUE_WHITE);
+	void SetInstance(int instanceIndex, Mat44 const& modelToWorldTransform, Rgba8 const& color);
+
+	// Bounding sphere of the mesh in model space, scaled by each instance's largest axis scale
+	void SetLocalBounds(Vec3 const& center, float radius);
+
+	// Both return the number of packed instances
+	int PackAll();
+	// Keeps instances whose sphere is not entirely behind any plane, planes face into the visible
+	// volume. maxDistance <= 0 turns the distance test off
+	int CullAndPack(Plane3 const* planes, int numPlanes, Vec3 const& viewPosition, float maxDistance = 0.f);
+	int CullAndPack(Frustum const& frustum);
+
+	// Uploads the packed instances and draws them, nothing happens when none are packed
+	void Draw(Renderer* renderer, RenderState const& material, VertexBuffer* vbo, unsigned int vertexCount) const;
+	void DrawIndexed(Renderer* renderer, RenderState const& material, VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount) const;
+
+	int GetNumInstances() const { return static_cast<int>(m_transforms.size()); }
+	int GetNumPacked() const { return static_cast<int>(m_packed.size()); }
+	InstanceData const* GetPackedData() const { return m_packed.data(); }
+
+protected:
+	void UpdateBounds(int instanceIndex);
+	void PackInstance(int instanceIndex);
+	bool BindForDraw(Renderer* renderer, RenderState const& material) const;
+
+protected:
+	std::vector<Mat44>			m_transforms;
+	std::vector<Rgba8>			m_colors;
+
+	// World space bounding spheres, one array per component
+	std::vector<float>			m_boundsX;
+	std::vector<float>			m_boundsY;
+	std::vector<float>			m_boundsZ;
+	std::vector<float>			m_boundsRadius;
+
+	std::vector<InstanceData>	m_packed;
+
+	Vec3	m_localBoundsCenter;
+	float	m_localBoundsRadius = 0.f;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct InstanceBatchBenchmarkResult
+{
+	int		m_numInstances = 0;
+	int		m_numVisible = 0;
+	int		m_numFrames = 0;
+	double	m_perObjectMsPerFrame = 0.0;		// ClassifySphere, SetModelConstants and a draw per visible instance
+	int		m_perObjectDrawCalls = 0;
+	double	m_cullAndPackMsPerFrame = 0.0;		// CullAndPack alone
+	double	m_instancedMsPerFrame = 0.0;		// CullAndPack, upload and one instanced draw
+	int		m_instancedDrawCalls = 0;
+	size_t	m_instancedBytesPerFrame = 0;
+
+	std::string ToString() const;
+};
+
+// Scatters numInstances cubes around a perspective camera, then draws the visible ones every frame
+// one draw each and through an InstanceBatch
+InstanceBatchBenchmarkResult RunInstanceBatchBenchmark(Renderer* renderer, int numInstances, int numFrames);
@@ -0,0 +1,236 @@
+#include "Engine/Renderer/LinearPageAllocator.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+// Some Alignment math
+namespace
+{
+	inline size_t AlignUpWithMask(size_t value, size_t mask)
+	{
+		return ((value + mask) & ~mask);
+	}
+
+	inline size_t AlignUpDiv(size_t value, size_t alignment)
+	{
+		return ((value + alignment - 1) / alignment) * alignment;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string LinearAllocatorStats::ToString() const
+{
+	return Stringf("pageSize=%llu pages=%d free=%d pageBytes=%llu created=%d frames=%llu lastFrame=%llu/%d peakFrame=%llu/%d avgFrame=%.0f",
+		(unsigned long long)m_pageSize, m_numPages, m_numFreePages, (unsigned long long)m_numPageBytes, m_numPagesCreated,
+		(unsigned long long)m_numFrames, (unsigned long long)m_lastFrameBytes, m_lastFramePages,
+		(unsigned long long)m_peakFrameBytes, m_peakFramePages, m_averageFrameBytes);
+}
+
+//-----------------------------------------------------------------------------------------------
+LinearPageAllocator::LinearPageAllocator(size_t pageSize)
+	: m_pageSize(pageSize)
+{
+	GUARANTEE_OR_DIE(pageSize > 0, "Linear allocator page size must be greater than zero.");
+	m_stats.m_pageSize = pageSize;
+}
+
+LinearPageAllocator::~LinearPageAllocator()
+{
+	DestroyAllPages();
+}
+
+//-----------------------------------------------------------------------------------------------
+LinearPageAllocation LinearPageAllocator::AllocateRange(size_t sizeInBytes, size_t alignment)
+{
+	GUARANTEE_OR_DIE(alignment > 0 && ((alignment - 1) & alignment) == 0, "alignment is not a power of two.");
+	return AllocateAligned(sizeInBytes, alignment);
+}
+
+LinearPageAllocation LinearPageAllocator::AllocateRangeAnyAlign(size_t sizeInBytes, size_t alignment)
+{
+	GUARANTEE_OR_DIE(alignment > 0, "alignment must be greater than zero.");
+	return AllocateAligned(sizeInBytes, alignment);
+}
+
+LinearPageAllocation LinearPageAllocator::AllocateAligned(size_t sizeInBytes, size_t alignment)
+{
+	bool const isPowerOfTwo = (alignment & (alignment - 1)) == 0;
+	size_t const alignedSize = isPowerOfTwo ? AlignUpWithMask(sizeInBytes, alignment - 1) : AlignUpDiv(sizeInBytes, alignment);
+
+	LinearPageAllocation alloc;
+	alloc.m_size = alignedSize;
+
+	// Too big for any page, it gets one of its own and the current page keeps going
+	if (alignedSize > m_pageSize)
+	{
+		alloc.m_pageIndex = AcquirePage(alignedSize);
+		alloc.m_offset = 0;
+		m_usedPages.push_back(alloc.m_pageIndex);
+		m_stats.m_frameBytes += alignedSize;
+		++m_stats.m_framePages;
+		return alloc;
+	}
+
+	if (m_currentPage >= 0)
+	{
+		size_t const alignedOffset = isPowerOfTwo ? AlignUpWithMask(m_currentOffset, alignment - 1) : AlignUpDiv(m_currentOffset, alignment);
+		if (alignedOffset + alignedSize <= m_pages[m_currentPage].m_capacity)
+		{
+			alloc.m_pageIndex = m_currentPage;
+			alloc.m_offset = alignedOffset;
+			m_stats.m_frameBytes += alignedOffset + alignedSize - m_currentOffset;
+			m_currentOffset = alignedOffset + alignedSize;
+			return alloc;
+		}
+	}
+
+	// Page overflow, the tail of the old page stays unused until it is recycled
+	m_currentPage = AcquirePage(m_pageSize);
+	m_usedPages.push_back(m_currentPage);
+	++m_stats.m_framePages;
+
+	alloc.m_pageIndex = m_currentPage;
+	alloc.m_offset = 0;
+	m_stats.m_frameBytes += alignedSize;
+	m_currentOffset = alignedSize;
+	return alloc;
+}
+
+//-----------------------------------------------------------------------------------------------
+void LinearPageAllocator::BeginFrame(uint64_t completedFenceValue)
+{
+	// Allocations before the first frame, e.g. startup uploads, do not count as a frame
+	if (m_hasBegunFrame)
+	{
+		m_stats.m_lastFrameBytes = m_stats.m_frameBytes;
+		m_stats.m_lastFramePages = m_stats.m_framePages;
+		if (m_stats.m_frameBytes > m_stats.m_peakFrameBytes)
+		{
+			m_stats.m_peakFrameBytes = m_stats.m_frameBytes;
+		}
+		if (m_stats.m_framePages > m_stats.m_peakFramePages)
+		{
+			m_stats.m_peakFramePages = m_stats.m_framePages;
+		}
+		++m_stats.m_numFrames;
+		m_stats.m_averageFrameBytes += (static_cast<double>(m_stats.m_frameBytes) - m_stats.m_averageFrameBytes) / static_cast<double>(m_stats.m_numFrames);
+	}
+	m_hasBegunFrame = true;
+	m_stats.m_frameBytes = 0;
+	m_stats.m_framePages = 0;
+
+	RecyclePages(completedFenceValue);
+}
+
+void LinearPageAllocator::RetireUsedPages(uint64_t fenceValue)
+{
+	if (m_usedPages.empty())
+	{
+		return;
+	}
+	GUARANTEE_OR_DIE(m_retiredPages.empty() || m_retiredPages.back().m_fenceValue <= fenceValue, "Linear allocator pages must be retired in fence order.");
+
+	m_retiredPages.emplace_back();
+	m_retiredPages.back().m_fenceValue = fenceValue;
+	m_retiredPages.back().m_pageIndexes.swap(m_usedPages);
+
+	m_currentPage = -1;
+	m_currentOffset = 0;
+}
+
+void LinearPageAllocator::RecyclePages(uint64_t completedFenceValue)
+{
+	while (!m_retiredPages.empty() && m_retiredPages.front().m_fenceValue <= completedFenceValue)
+	{
+		for (int pageIndex : m_retiredPages.front().m_pageIndexes)
+		{
+			ReleasePage(pageIndex);
+		}
+		m_retiredPages.pop_front();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void LinearPageAllocator::CreatePage(int pageIndex, size_t capacity)
+{
+	UNUSED(pageIndex);
+	UNUSED(capacity);
+}
+
+void LinearPageAllocator::DestroyPage(int pageIndex)
+{
+	UNUSED(pageIndex);
+}
+
+void LinearPageAllocator::DestroyAllPages()
+{
+	for (int pageIndex = 0; pageIndex < static_cast<int>(m_pages.size()); ++pageIndex)
+	{
+		if (m_pages[pageIndex].m_isAlive)
+		{
+			DestroyPage(pageIndex);
+		}
+	}
+	m_pages.clear();
+	m_freePages.clear();
+	m_unusedPageSlots.clear();
+	m_usedPages.clear();
+	m_retiredPages.clear();
+	m_currentPage = -1;
+	m_currentOffset = 0;
+
+	m_stats.m_numPages = 0;
+	m_stats.m_numFreePages = 0;
+	m_stats.m_numPageBytes = 0;
+}
+
+int LinearPageAllocator::AcquirePage(size_t capacity)
+{
+	bool const isDedicated = capacity > m_pageSize;
+	if (!isDedicated && !m_freePages.empty())
+	{
+		int pageIndex = m_freePages.back();
+		m_freePages.pop_back();
+		--m_stats.m_numFreePages;
+		return pageIndex;
+	}
+
+	int pageIndex = static_cast<int>(m_pages.size());
+	if (!m_unusedPageSlots.empty())
+	{
+		pageIndex = m_unusedPageSlots.back();
+		m_unusedPageSlots.pop_back();
+	}
+	else
+	{
+		m_pages.emplace_back();
+	}
+
+	Page& page = m_pages[pageIndex];
+	page.m_capacity = isDedicated ? capacity : m_pageSize;
+	page.m_isDedicated = isDedicated;
+	page.m_isAlive = true;
+	CreatePage(pageIndex, page.m_capacity);
+
+	++m_stats.m_numPages;
+	++m_stats.m_numPagesCreated;
+	m_stats.m_numPageBytes += page.m_capacity;
+	return pageIndex;
+}
+
+void LinearPageAllocator::ReleasePage(int pageIndex)
+{
+	Page& page = m_pages[pageIndex];
+	if (!page.m_isDedicated)
+	{
+		m_freePages.push_back(pageIndex);
+		++m_stats.m_numFreePages;
+		return;
+	}
+
+	// Dedicated pages are sized for one request, pooling them would only pin the memory
+	DestroyPage(pageIndex);
+	page.m_isAlive = false;
+	m_unusedPageSlots.push_back(pageIndex);
+	--m_stats.m_numPages;
+	m_stats.m_numPageBytes -= page.m_capacity;
+}
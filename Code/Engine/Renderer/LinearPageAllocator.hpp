@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+struct LinearPageAllocation
+{
+	int		m_pageIndex = -1;
+	size_t	m_offset = 0;	// from the start of the page
+	size_t	m_size = 0;		// aligned size
+};
+
+//-----------------------------------------------------------------------------------------------
+struct LinearAllocatorStats
+{
+	size_t		m_pageSize = 0;
+	int			m_numPages = 0;				// alive pages, in use or pooled
+	int			m_numFreePages = 0;
+	size_t		m_numPageBytes = 0;			// capacity of every alive page
+	int			m_numPagesCreated = 0;		// lifetime, grows only when a frame overflows the pool
+
+	size_t		m_frameBytes = 0;			// the frame being recorded, so far
+	int			m_framePages = 0;
+	size_t		m_lastFrameBytes = 0;
+	int			m_lastFramePages = 0;
+	size_t		m_peakFrameBytes = 0;
+	int			m_peakFramePages = 0;
+	double		m_averageFrameBytes = 0.0;
+	uint64_t	m_numFrames = 0;
+
+	std::string ToString() const;
+};
+
+//-----------------------------------------------------------------------------------------------
+// Offset, alignment and page bookkeeping of a paged per-frame linear allocator, with no graphics
+// API in it.
+//
+// Allocations bump an offset inside the current page. A frame that overflows it takes another
+// page from the pool, or creates one, and a request larger than a page gets a dedicated page of
+// its own. RetireUsedPages hands every page touched so far to a fence value, and BeginFrame puts
+// them back in the pool once the GPU has passed that fence, so the pool settles at what the
+// frames in flight really use instead of one worst case buffer per frame.
+//
+// The backend owns the memory behind a page index through CreatePage and DestroyPage. A derived
+// class must call DestroyAllPages in its destructor, the base one cannot reach the overrides.
+//
+class LinearPageAllocator
+{
+public:
+	explicit LinearPageAllocator(size_t pageSize);
+	virtual ~LinearPageAllocator();
+	LinearPageAllocator(LinearPageAllocator const& copy) = delete;
+
+	// Alignment must be a power of two, cb - 256; vb/ib - 4 or 16
+	LinearPageAllocation AllocateRange(size_t sizeInBytes, size_t alignment);
+	// Any alignment, e.g. the element stride of a structured buffer
+	LinearPageAllocation AllocateRangeAnyAlign(size_t sizeInBytes, size_t alignment);
+
+	// Start of a frame: closes the stats of the last one and recycles pages the GPU is done with
+	void BeginFrame(uint64_t completedFenceValue);
+	// After the commands reading this frame's allocations are submitted with fenceValue
+	void RetireUsedPages(uint64_t fenceValue);
+	void RecyclePages(uint64_t completedFenceValue);
+
+	size_t GetPageSize() const { return m_pageSize; }
+	size_t GetPageCapacity(int pageIndex) const { return m_pages[pageIndex].m_capacity; }
+	LinearAllocatorStats const& GetStats() const { return m_stats; }
+
+protected:
+	virtual void CreatePage(int pageIndex, size_t capacity);
+	virtual void DestroyPage(int pageIndex);
+	void DestroyAllPages();
+
+	LinearPageAllocation AllocateAligned(size_t sizeInBytes, size_t alignment);
+	int AcquirePage(size_t capacity);
+	void ReleasePage(int pageIndex);
+
+protected:
+	struct Page
+	{
+		size_t	m_capacity = 0;
+		bool	m_isDedicated = false;
+		bool	m_isAlive = false;
+	};
+
+	struct RetiredPages
+	{
+		uint64_t			m_fenceValue = 0;
+		std::vector<int>	m_pageIndexes;
+	};
+
+	size_t						m_pageSize = 0;
+	std::vector<Page>			m_pages;
+	std::vector<int>			m_freePages;		// standard pages ready for reuse
+	std::vector<int>			m_unusedPageSlots;	// indexes of destroyed dedicated pages
+	std::vector<int>			m_usedPages;		// touched since the last retire
+	std::deque<RetiredPages>	m_retiredPages;		// ascending fence values
+
+	int							m_currentPage = -1;
+	size_t						m_currentOffset = 0;
+	bool						m_hasBegunFrame = false;
+	LinearAllocatorStats		m_stats;
+};
@@ -0,0 +1,791 @@
+#include "Engine/Renderer/NullRenderer.hpp"
+
+#ifdef ENGINE_RENDER_NULL
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/TextureCook.hpp"
+#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/Shader.hpp"
+#include "Engine/Renderer/Camera.hpp"
+#include "Engine/Renderer/ConstantBuffer.hpp"
+#include "Engine/Renderer/IndexBuffer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "ThirdParty/stb/stb_image.h"
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	constexpr size_t INITIAL_STREAM_CAPACITY = 1024 * 1024;
+
+	void PrintNullRendererLine(Rgba8 const& color, std::string const& text)
+	{
+		if (g_theDevConsole)
+		{
+			g_theDevConsole->AddText(color, text);
+		}
+		else
+		{
+			DebuggerPrintf("%s\n", text.c_str());
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+NullRenderer::NullRenderer(RendererConfig const& config)
+	: Renderer(config)
+{
+	for (int slot = 0; slot < NUM_TEXTURE_SLOT; ++slot)
+	{
+		m_boundTextureIdBySlot[slot] = INVALID_INDEX_U32;
+	}
+	for (int slot = 0; slot < NUM_SAMPLER_SLOT; ++slot)
+	{
+		m_boundSamplerModeBySlot[slot] = INVALID_INDEX_U32;
+	}
+}
+
+void NullRenderer::Startup()
+{
+	m_frameStream.Reserve(INITIAL_STREAM_CAPACITY);
+	m_lastFrameStream.Reserve(INITIAL_STREAM_CAPACITY);
+
+	CreateDefaultShaderAndTexture();
+	CreateBuffers();
+
+	if (g_theEventSystem)
+	{
+		g_theEventSystem->SubscribeEventCallbackFunction("NullRenderer", Command_NullRenderer);
+	}
+}
+
+void NullRenderer::BeginFrame()
+{
+	PROFILE_SCOPE("Renderer::BeginFrame");
+	m_frameStream.Write(RenderCommandType::BEGIN_FRAME);
+}
+
+void NullRenderer::EndFrame()
+{
+	PROFILE_SCOPE("Renderer::EndFrame");
+	m_frameStream.Write(RenderCommandType::END_FRAME);
+
+	// Swap instead of copy, both streams keep their capacity so steady state frames do not allocate
+	m_frameCounters.m_numCommands = static_cast<uint64_t>(m_frameStream.GetNumCommands());
+	std::swap(m_frameStream, m_lastFrameStream);
+	m_frameStream.Clear();
+
+	m_lastFrameCounters = m_frameCounters;
+	m_totalCounters.Accumulate(m_frameCounters);
+	m_frameCounters.Reset();
+	++m_numFramesRecorded;
+}
+
+void NullRenderer::Shutdown()
+{
+	if (g_theEventSystem)
+	{
+		g_theEventSystem->UnsubscribeEventCallbackFunction("NullRenderer", Command_NullRenderer);
+	}
+
+	for (int fontIndex = 0; fontIndex < (int)m_loadedFonts.size(); ++fontIndex)
+	{
+		delete m_loadedFonts[fontIndex];
+		m_loadedFonts[fontIndex] = nullptr;
+	}
+	m_loadedFonts.clear();
+
+	for (int textureIndex = 0; textureIndex < (int)m_loadedTextures.size(); ++textureIndex)
+	{
+		delete m_loadedTextures[textureIndex];
+		m_loadedTextures[textureIndex] = nullptr;
+	}
+	m_loadedTextures.clear();
+	m_defaultTexture = nullptr;
+	m_defaultNormalTexture = nullptr;
+	m_defaultSpecGlossEmitTexture = nullptr;
+
+	for (int shaderIndex = 0; shaderIndex < (int)m_loadedShaders.size(); ++shaderIndex)
+	{
+		delete m_loadedShaders[shaderIndex];
+		m_loadedShaders[shaderIndex] = nullptr;
+	}
+	m_loadedShaders.clear();
+	m_defaultShader = nullptr;
+
+	delete m_immediateVBO;
+	m_immediateVBO = nullptr;
+	delete m_immediateIBO;
+	m_immediateIBO = nullptr;
+}
+
+void NullRenderer::ClearScreen(Rgba8 const& clearColor)
+{
+	RenderCommandClear clear;
+	clearColor.GetAsFloats(clear.m_color);
+	m_frameStream.Write(RenderCommandType::CLEAR_SCREEN, &clear, sizeof(clear));
+}
+
+void NullRenderer::BeginCamera(Camera const& camera)
+{
+	SetModelConstants();
+
+	CameraConstants cameraConstants;
+	cameraConstants.WorldToCameraTransform = camera.GetWorldToCameraTransform();
+	cameraConstants.CameraToRenderTransform = camera.GetCameraToRenderTransform();
+	cameraConstants.RenderToClipTransform = camera.GetRenderToClipTransform();
+	cameraConstants.CameraWorldPosition = camera.GetPosition();
+
+	m_frameStream.Write(RenderCommandType::BEGIN_CAMERA, &cameraConstants, sizeof(CameraConstants));
+	++m_frameCounters.m_numCameras;
+	++m_frameCounters.m_numConstantUpdates;
+	m_frameCounters.m_numBytesCopied += sizeof(CameraConstants);
+}
+
+void NullRenderer::EndCamera(Camera const& camera)
+{
+	UNUSED(camera);
+	m_frameStream.Write(RenderCommandType::END_CAMERA);
+}
+
+//-----------------------------------------------------------------------------------------------
+VertexBuffer* NullRenderer::CreateVertexBuffer(const unsigned int size, unsigned int stride)
+{
+	return new VertexBuffer(m_nextBufferId++, size, stride);
+}
+
+IndexBuffer* NullRenderer::CreateIndexBuffer(const unsigned int size)
+{
+	return new IndexBuffer(m_nextBufferId++, size);
+}
+
+ConstantBuffer* NullRenderer::CreateConstantBuffer(const unsigned int size)
+{
+	return new ConstantBuffer(m_nextBufferId++, size);
+}
+
+void NullRenderer::CopyCPUToGPU(const void* data, unsigned int size, VertexBuffer* vbo)
+{
+	if (vbo->GetSize() < size)
+	{
+		vbo->Resize(size);
+	}
+	RecordCopy(RenderBufferType::VERTEX, vbo->m_id, data, size);
+}
+
+void NullRenderer::CopyCPUToGPU(const void* data, unsigned int size, IndexBuffer* ibo)
+{
+	if (ibo->GetSize() < size)
+	{
+		ibo->Resize(size);
+	}
+	RecordCopy(RenderBufferType::INDEX, ibo->m_id, data, size);
+}
+
+void NullRenderer::CopyCPUToGPU(const void* data, unsigned int size, ConstantBuffer* cbo)
+{
+	GUARANTEE_OR_DIE(size <= cbo->m_size, "Constant buffer is too small for the data.");
+	RecordCopy(RenderBufferType::CONSTANT, cbo->m_id, data, size);
+}
+
+// Growing a buffer loses its contents on a real device, so that uploads everything
+void NullRenderer::CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, VertexBuffer* vbo)
+{
+	if (vbo->GetSize() < bufferSize)
+	{
+		CopyCPUToGPU(bufferData, bufferSize, vbo);
+		return;
+	}
+	RecordCopy(RenderBufferType::VERTEX, vbo->m_id, static_cast<unsigned char const*>(bufferData) + dirtyOffset, dirtySize, dirtyOffset);
+}
+
+void NullRenderer::CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, IndexBuffer* ibo)
+{
+	if (ibo->GetSize() < bufferSize)
+	{
+		CopyCPUToGPU(bufferData, bufferSize, ibo);
+		return;
+	}
+	RecordCopy(RenderBufferType::INDEX, ibo->m_id, static_cast<unsigned char const*>(bufferData) + dirtyOffset, dirtySize, dirtyOffset);
+}
+
+//-----------------------------------------------------------------------------------------------
+void NullRenderer::DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes)
+{
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
+	m_immediateVBO->m_stride = sizeof(Vertex_PCU);
+	CopyCPUToGPU(vertexes, numVertexes * m_immediateVBO->GetStride(), m_immediateVBO);
+	DrawVertexBuffer(m_immediateVBO, numVertexes);
+}
+
+void NullRenderer::DrawVertexArray(std::vector<Vertex_PCU> const& verts)
+{
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
+	m_immediateVBO->m_stride = sizeof(Vertex_PCU);
+	CopyCPUToGPU(verts.data(), static_cast<unsigned int>(verts.size()) * m_immediateVBO->GetStride(), m_immediateVBO);
+	DrawVertexBuffer(m_immediateVBO, static_cast<unsigned int>(verts.size()));
+}
+
+void NullRenderer::DrawVertexArray(std::vector<Vertex_PCUTBN> const& verts)
+{
+	PROFILE_SCOPE("Renderer::DrawVertexArray");
+	m_immediateVBO->m_stride = sizeof(Vertex_PCUTBN);
+	CopyCPUToGPU(verts.data(), static_cast<unsigned int>(verts.size()) * m_immediateVBO->GetStride(), m_immediateVBO);
+	DrawVertexBuffer(m_immediateVBO, static_cast<unsigned int>(verts.size()));
+}
+
+void NullRenderer::DrawIndexedVertexArray(std::vector<Vertex_PCU> const& verts, std::vector<unsigned int> const& indexes)
+{
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexArray");
+	m_immediateVBO->m_stride = sizeof(Vertex_PCU);
+	CopyCPUToGPU(verts.data(), static_cast<unsigned int>(verts.size()) * m_immediateVBO->GetStride(), m_immediateVBO);
+	CopyCPUToGPU(indexes.data(), static_cast<unsigned int>(indexes.size()) * m_immediateIBO->GetStride(), m_immediateIBO);
+	DrawIndexedVertexBuffer(m_immediateVBO, m_immediateIBO, static_cast<unsigned int>(indexes.size()));
+}
+
+void NullRenderer::DrawIndexedVertexArray(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indexes)
+{
+	PROFILE_SCOPE("Renderer::DrawIndexedVertexArray");
+	m_immediateVBO->m_stride = sizeof(Vertex_PCUTBN);
+	CopyCPUToGPU(verts.data(), static_cast<unsigned int>(verts.size()) * m_immediateVBO->GetStride(), m_immediateVBO);
+	CopyCPUToGPU(indexes.data(), static_cast<unsigned int>(indexes.size()) * m_immediateIBO->GetStride(), m_immediateIBO);
+	DrawIndexedVertexBuffer(m_immediateVBO, m_immediateIBO, static_cast<unsigned int>(indexes.size()));
+}
+
+void NullRenderer::DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount)
+{
+	RenderCommandDraw draw;
+	draw.m_vertexBufferId = vbo->m_id;
+	draw.m_stride = vbo->GetStride();
+	draw.m_count = vertexCount;
+	m_frameStream.Write(RenderCommandType::DRAW, &draw, sizeof(draw));
+
+	++m_frameCounters.m_numDrawCalls;
+	m_frameCounters.m_numVertexes += vertexCount;
+}
+
+void NullRenderer::DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount)
+{
+	RenderCommandDraw draw;
+	draw.m_vertexBufferId = vbo->m_id;
+	draw.m_indexBufferId = ibo->m_id;
+	draw.m_stride = vbo->GetStride();
+	draw.m_count = indexCount;
+	m_frameStream.Write(RenderCommandType::DRAW_INDEXED, &draw, sizeof(draw));
+
+	++m_frameCounters.m_numDrawCalls;
+	m_frameCounters.m_numIndexes += indexCount;
+}
+
+void NullRenderer::SetInstanceData(int numInstances, InstanceData const* instances)
+{
+	uint32_t numBytes = static_cast<uint32_t>(numInstances * sizeof(InstanceData));
+
+	RenderCommandCopy copy;
+	copy.m_bufferType = RenderBufferType::INSTANCE;
+	copy.m_numBytes = numBytes;
+	copy.m_numRecordedBytes = m_recordUploadData ? numBytes : 0;
+	m_frameStream.Write(RenderCommandType::COPY_TO_BUFFER, &copy, sizeof(copy), instances, copy.m_numRecordedBytes);
+	m_frameCounters.m_numBytesCopied += numBytes;
+	m_numUploadedInstances = numInstances;
+}
+
+void NullRenderer::DrawVertexBufferInstanced(VertexBuffer* vbo, unsigned int vertexCount, int numInstances)
+{
+	GUARANTEE_RECOVERABLE(numInstances <= m_numUploadedInstances, "Drawing more instances than SetInstanceData uploaded.");
+
+	RenderCommandDrawInstanced draw;
+	draw.m_draw.m_vertexBufferId = vbo->m_id;
+	draw.m_draw.m_stride = vbo->GetStride();
+	draw.m_draw.m_count = vertexCount;
+	draw.m_numInstances = static_cast<uint32_t>(numInstances);
+	m_frameStream.Write(RenderCommandType::DRAW_INSTANCED, &draw, sizeof(draw));
+
+	++m_frameCounters.m_numDrawCalls;
+	m_frameCounters.m_numInstances += numInstances;
+	m_frameCounters.m_numVertexes += static_cast<uint64_t>(vertexCount) * numInstances;
+}
+
+void NullRenderer::DrawIndexedVertexBufferInstanced(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount, int numInstances)
+{
+	GUARANTEE_RECOVERABLE(numInstances <= m_numUploadedInstances, "Drawing more instances than SetInstanceData uploaded.");
+
+	RenderCommandDrawInstanced draw;
+	draw.m_draw.m_vertexBufferId = vbo->m_id;
+	draw.m_draw.m_indexBufferId = ibo->m_id;
+	draw.m_draw.m_stride = vbo->GetStride();
+	draw.m_draw.m_count = indexCount;
+	draw.m_numInstances = static_cast<uint32_t>(numInstances);
+	m_frameStream.Write(RenderCommandType::DRAW_INDEXED_INSTANCED, &draw, sizeof(draw));
+
+	++m_frameCounters.m_numDrawCalls;
+	m_frameCounters.m_numInstances += numInstances;
+	m_frameCounters.m_numIndexes += static_cast<uint64_t>(indexCount) * numInstances;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Set Renderer States
+//-----------------------------------------------------------------------------------------------
+void NullRenderer::SetStateIfChanged(uint32_t& boundValue, uint32_t value, RenderCommandType type, int slot /*= 0*/)
+{
+	if (boundValue == value)
+	{
+		++m_frameCounters.m_numRedundantStateChanges;
+		return;
+	}
+
+	boundValue = value;
+	RenderCommandState state;
+	state.m_value = value;
+	state.m_slot = slot;
+	m_frameStream.Write(type, &state, sizeof(state));
+	++m_frameCounters.m_numStateChanges;
+}
+
+void NullRenderer::BindShader(Shader* shader)
+{
+	if (shader == nullptr)
+	{
+		shader = m_defaultShader;
+	}
+	SetStateIfChanged(m_boundShaderId, shader->m_id, RenderCommandType::BIND_SHADER);
+}
+
+void NullRenderer::SetBlendMode(BlendMode blendMode)
+{
+	SetStateIfChanged(m_boundBlendMode, static_cast<uint32_t>(blendMode), RenderCommandType::SET_BLEND_MODE);
+}
+
+void NullRenderer::SetRasterizerMode(RasterizerMode rasterizerMode)
+{
+	SetStateIfChanged(m_boundRasterizerMode, static_cast<uint32_t>(rasterizerMode), RenderCommandType::SET_RASTERIZER_MODE);
+}
+
+void NullRenderer::SetDepthMode(DepthMode depthMode)
+{
+	SetStateIfChanged(m_boundDepthMode, static_cast<uint32_t>(depthMode), RenderCommandType::SET_DEPTH_MODE);
+}
+
+void NullRenderer::SetRenderTargetFormats(const std::vector<DXGI_FORMAT>& rtvFormats /*= { DXGI_FORMAT_R8G8B8A8_UNORM }*/, DXGI_FORMAT dsvFormat /*= DXGI_FORMAT_D24_UNORM_S8_UINT*/, unsigned int msaaCount /*= 1*/, unsigned int msaaQuality /*= 0*/)
+{
+	GUARANTEE_OR_DIE(rtvFormats.size() <= RenderCommandRenderTargets::MAX_RTVS, "Too many render target formats.");
+
+	RenderCommandRenderTargets targets;
+	targets.m_numRtvs = static_cast<uint32_t>(rtvFormats.size());
+	for (int rtvIndex = 0; rtvIndex < static_cast<int>(rtvFormats.size()); ++rtvIndex)
+	{
+		targets.m_rtvFormats[rtvIndex] = static_cast<uint32_t>(rtvFormats[rtvIndex]);
+	}
+	targets.m_dsvFormat = static_cast<uint32_t>(dsvFormat);
+	targets.m_msaaCount = msaaCount;
+	targets.m_msaaQuality = msaaQuality;
+
+	if (m_hasBoundRenderTargets && memcmp(&targets, &m_boundRenderTargets, sizeof(targets)) == 0)
+	{
+		++m_frameCounters.m_numRedundantStateChanges;
+		return;
+	}
+
+	m_boundRenderTargets = targets;
+	m_hasBoundRenderTargets = true;
+	m_frameStream.Write(RenderCommandType::SET_RENDER_TARGET_FORMATS, &targets, sizeof(targets));
+	++m_frameCounters.m_numStateChanges;
+}
+
+void NullRenderer::BindTexture(Texture const* texture, int slot /*= 0*/)
+{
+	GUARANTEE_OR_DIE(slot >= 0 && slot < NUM_TEXTURE_SLOT, "Texture slot out of range.");
+
+	if (texture == nullptr)
+	{
+		if (slot == 1)
+		{
+			texture = m_defaultNormalTexture;
+		}
+		else if (slot == 2)
+		{
+			texture = m_defaultSpecGlossEmitTexture;
+		}
+		else
+		{
+			texture = m_defaultTexture;
+		}
+	}
+	SetStateIfChanged(m_boundTextureIdBySlot[slot], texture->m_id, RenderCommandType::BIND_TEXTURE, slot);
+}
+
+void NullRenderer::SetSamplerMode(SamplerMode samplerMode, int slot /*= 0*/)
+{
+	GUARANTEE_OR_DIE(slot >= 0 && slot < NUM_SAMPLER_SLOT, "Sampler slot out of range.");
+	SetStateIfChanged(m_boundSamplerModeBySlot[slot], static_cast<uint32_t>(samplerMode), RenderCommandType::SET_SAMPLER_MODE, slot);
+}
+
+//-----------------------------------------------------------------------------------------------
+void NullRenderer::UpdateConstants(int slot, void const* data, unsigned int size)
+{
+	RenderCommandConstants constants;
+	constants.m_slot = slot;
+	constants.m_numBytes = size;
+	constants.m_numRecordedBytes = m_recordUploadData ? size : 0;
+	m_frameStream.Write(RenderCommandType::SET_CONSTANTS, &constants, sizeof(constants), data, constants.m_numRecordedBytes);
+
+	++m_frameCounters.m_numConstantUpdates;
+	m_frameCounters.m_numBytesCopied += size;
+}
+
+void NullRenderer::RecordCopy(RenderBufferType bufferType, uint32_t bufferId, void const* data, unsigned int size, unsigned int destOffset /*= 0*/)
+{
+	RenderCommandCopy copy;
+	copy.m_bufferType = bufferType;
+	copy.m_bufferId = bufferId;
+	copy.m_numBytes = size;
+	copy.m_numRecordedBytes = m_recordUploadData ? size : 0;
+	copy.m_destOffset = destOffset;
+	m_frameStream.Write(RenderCommandType::COPY_TO_BUFFER, &copy, sizeof(copy), data, copy.m_numRecordedBytes);
+	m_frameCounters.m_numBytesCopied += size;
+}
+
+void NullRenderer::SetModelConstants(Mat44 const& modelToWorldTransform /*= Mat44()*/, Rgba8 const& modelColor /*= Rgba8::OPAQUE_WHITE*/)
+{
+	ModelConstants modelConstants;
+
+	modelConstants.ModelToWorldTransform = modelToWorldTransform;
+	modelColor.GetAsFloats(modelConstants.ModelColor);
+
+	UpdateConstants(k_modelConstantsSlot, &modelConstants, sizeof(ModelConstants));
+}
+
+void NullRenderer::SetEngineConstants(int debugInt /*= 0*/, float debugFloat /*= 0.f*/)
+{
+	EngineConstants engineConstants;
+
+	engineConstants.m_debugInt = debugInt;
+	engineConstants.m_debugFloat = debugFloat;
+
+	UpdateConstants(k_engineConstantsSlot, &engineConstants, sizeof(EngineConstants));
+}
+
+void NullRenderer::SetLightConstants(Vec3 const& sunDirection /*= Vec3(2.f, -1.f, -1.f)*/, float sunIntensity /*= 0.85f*/, float ambientIntensity /*= 0.35f*/)
+{
+	// Deprecated: It only keeps sun light
+	UNUSED(ambientIntensity);
+	LightConstants lightConstants;
+
+	Rgba8 color = Rgba8::OPAQUE_WHITE;
+	color.ScaleAlpha(sunIntensity);
+	color.GetAsFloats(lightConstants.m_sunColor);
+	lightConstants.m_sunNormal = sunDirection.GetNormalized();
+
+	UpdateConstants(k_lightConstantsSlot, &lightConstants, sizeof(LightConstants));
+}
+
+void NullRenderer::SetLightConstants(LightConstants const& lightConstants)
+{
+	UpdateConstants(k_lightConstantsSlot, &lightConstants, sizeof(LightConstants));
+}
+
+void NullRenderer::SetPerFrameConstants(PerFrameConstants const& perframeConstants)
+{
+	UpdateConstants(k_perFrameConstantsSlot, &perframeConstants, sizeof(PerFrameConstants));
+}
+
+//-----------------------------------------------------------------------------------------------
+// Manage Resources
+//-----------------------------------------------------------------------------------------------
+Texture* NullRenderer::CreateOrGetTextureFromFile(char const* imageFilePath)
+{
+	Texture* existingTexture = GetTextureForFileName(imageFilePath);
+	if (existingTexture)
+	{
+		return existingTexture;
+	}
+	return CreateTextureFromFile(imageFilePath);
+}
+
+Texture* NullRenderer::CreateOrGetTextureFromImage(Image const& image)
+{
+	Texture* existingTexture = GetTextureForFileName(image.GetImageFilePath().c_str());
+	if (existingTexture)
+	{
+		return existingTexture;
+	}
+	return CreateTexture(image.GetImageFilePath().c_str(), image.GetDimensions());
+}
+
+Texture* NullRenderer::CreateOrGetTextureFromCooked(CookedTexture const& cooked)
+{
+	Texture* existingTexture = GetTextureForFileName(cooked.m_name.c_str());
+	if (existingTexture)
+	{
+		return existingTexture;
+	}
+	return CreateTexture(cooked.m_name.c_str(), cooked.m_dimensions);
+}
+
+Texture* NullRenderer::CreateOrGetTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config)
+{
+	Texture* existingTexture = GetTextureForFileName(config.m_name.c_str());
+	if (existingTexture)
+	{
+		return existingTexture;
+	}
+
+	Texture* faceTexture = CreateOrGetTextureFromFile(config.m_rightImageFilePath.c_str());
+	return CreateTexture(config.m_name.c_str(), faceTexture->GetDimensions());
+}
+
+BitmapFont* NullRenderer::CreateOrGetBitmapFont(char const* bitmapFontFilePathWithNoExtension)
+{
+	BitmapFont* existingBitmapFont = GetBitmapFont(bitmapFontFilePathWithNoExtension);
+	if (existingBitmapFont)
+	{
+		return existingBitmapFont;
+	}
+
+	std::string imageFilePath(bitmapFontFilePathWithNoExtension);
+	imageFilePath += ".png";
+	Texture* fontTexture = CreateOrGetTextureFromFile(imageFilePath.c_str());
+	BitmapFont* newFont = new BitmapFont(bitmapFontFilePathWithNoExtension, *fontTexture);
+	m_loadedFonts.push_back(newFont);
+	return newFont;
+}
+
+BitmapFont* NullRenderer::CreateOrGetSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config /*= SDFFontConfig()*/)
+{
+	BitmapFont* existingSDFFont = GetBitmapFont(bitmapFontFilePathWithNoExtension, true);
+	if (existingSDFFont)
+	{
+		return existingSDFFont;
+	}
+
+	// The atlas is really generated, it is CPU work a headless run should measure. A missing png
+	// gets an empty glyph sheet, every glyph then only advances
+	std::string imageFilePath(bitmapFontFilePathWithNoExtension);
+	imageFilePath += ".png";
+	IntVec2 dimensions;
+	int numComponents = 0;
+	Image glyphSheet;
+	if (stbi_info(imageFilePath.c_str(), &dimensions.x, &dimensions.y, &numComponents) != 0)
+	{
+		glyphSheet = Image(imageFilePath.c_str());
+	}
+	else
+	{
+		DebuggerPrintf("NullRenderer: could not read image \"%s\", using an empty glyph sheet\n", imageFilePath.c_str());
+		glyphSheet = Image(config.m_glyphGridLayout, Rgba8(0, 0, 0, 0), imageFilePath.c_str());
+	}
+
+	SDFFontAtlas atlas = GenerateSDFFontAtlas(glyphSheet, config);
+	Texture* atlasTexture = CreateTexture(atlas.m_image.GetImageFilePath().c_str(), atlas.m_image.GetDimensions());
+	BitmapFont* newFont = new BitmapFont(bitmapFontFilePathWithNoExtension, *atlasTexture, atlas);
+	m_loadedFonts.push_back(newFont);
+	return newFont;
+}
+
+Shader* NullRenderer::CreateOrGetShader(char const* shaderName, VertexType type /*= VertexType::VERTEX_PCU*/)
+{
+	return CreateOrGetShader(ShaderConfig(shaderName), type);
+}
+
+void NullRenderer::AttachGeometryShader(Shader* shader, char const* shaderName)
+{
+	// Nothing is compiled, the shader id already identifies the pipeline in the stream
+	UNUSED(shader);
+	UNUSED(shaderName);
+}
+
+Shader* NullRenderer::CreateOrGetShader(ShaderConfig const& config, VertexType type /*= VertexType::VERTEX_PCU*/)
+{
+	Shader* existingShader = GetShader(config.m_name.c_str());
+	if (existingShader)
+	{
+		return existingShader;
+	}
+	return CreateShader(config, type);
+}
+
+Texture* NullRenderer::GetTextureForFileName(char const* imageFilePath)
+{
+	for (int i = 0; i < static_cast<int>(m_loadedTextures.size()); ++i)
+	{
+		if (m_loadedTextures[i]->m_name == imageFilePath)
+		{
+			return m_loadedTextures[i];
+		}
+	}
+	return nullptr;
+}
+
+Texture* NullRenderer::CreateTexture(char const* name, IntVec2 const& dimensions)
+{
+	Texture* newTexture = new Texture();
+	newTexture->m_name = name;
+	newTexture->m_dimensions = dimensions;
+	newTexture->m_id = static_cast<unsigned int>(m_loadedTextures.size()) + 1;
+	m_loadedTextures.push_back(newTexture);
+	return newTexture;
+}
+
+Texture* NullRenderer::CreateTextureFromFile(char const* imageFilePath)
+{
+	// Only the header is read for the dimensions, decoding would only add load time. Headless
+	// machines often run without the art, so a missing file gets a 1x1 texture instead of dying
+	IntVec2 dimensions(1, 1);
+	int numComponents = 0;
+	if (stbi_info(imageFilePath, &dimensions.x, &dimensions.y, &numComponents) == 0)
+	{
+		DebuggerPrintf("NullRenderer: could not read image \"%s\", using 1x1\n", imageFilePath);
+		dimensions = IntVec2(1, 1);
+	}
+	return CreateTexture(imageFilePath, dimensions);
+}
+
+BitmapFont* NullRenderer::GetBitmapFont(char const* bitmapFontFilePathWithNoExtension, bool isSDF /*= false*/)
+{
+	for (int i = 0; i < static_cast<int>(m_loadedFonts.size()); ++i)
+	{
+		if (m_loadedFonts[i]->m_fontFilePathNameWithNoExtension == bitmapFontFilePathWithNoExtension && m_loadedFonts[i]->IsSDF() == isSDF)
+		{
+			return m_loadedFonts[i];
+		}
+	}
+	return nullptr;
+}
+
+Shader* NullRenderer::GetShader(char const* shaderName)
+{
+	for (int i = 0; i < static_cast<int>(m_loadedShaders.size()); ++i)
+	{
+		if (m_loadedShaders[i]->m_config.m_name == shaderName)
+		{
+			return m_loadedShaders[i];
+		}
+	}
+	return nullptr;
+}
+
+Shader* NullRenderer::CreateShader(ShaderConfig const& config, VertexType type)
+{
+	Shader* newShader = new Shader(config);
+	newShader->m_id = static_cast<unsigned int>(m_loadedShaders.size()) + 1;
+	newShader->m_inputLayoutMode = type;
+	m_loadedShaders.push_back(newShader);
+	return newShader;
+}
+
+void NullRenderer::CreateDefaultShaderAndTexture()
+{
+	m_defaultShader = CreateShader(ShaderConfig("Default"), VertexType::VERTEX_PCU);
+	BindShader(m_defaultShader);
+
+	m_defaultTexture = CreateTexture("DefaultDiffuse", IntVec2(2, 2));
+	BindTexture(m_defaultTexture, 0);
+	m_defaultNormalTexture = CreateTexture("DefaultNormal", IntVec2(2, 2));
+	BindTexture(m_defaultNormalTexture, 1);
+	m_defaultSpecGlossEmitTexture = CreateTexture("DefaultSpecGlossEmit", IntVec2(2, 2));
+	BindTexture(m_defaultSpecGlossEmitTexture, 2);
+}
+
+void NullRenderer::CreateBuffers()
+{
+	m_immediateVBO = CreateVertexBuffer(1 * sizeof(Vertex_PCU), sizeof(Vertex_PCU));
+	m_immediateIBO = CreateIndexBuffer(1 * sizeof(unsigned int));
+}
+
+//-----------------------------------------------------------------------------------------------
+void NullRenderer::BeginRenderEvent(char const* eventName)
+{
+	m_frameStream.Write(RenderCommandType::BEGIN_EVENT, eventName, static_cast<uint32_t>(strlen(eventName)));
+}
+
+void NullRenderer::EndRenderEvent(char const* optional_eventName)
+{
+	uint32_t nameLength = optional_eventName ? static_cast<uint32_t>(strlen(optional_eventName)) : 0;
+	m_frameStream.Write(RenderCommandType::END_EVENT, optional_eventName, nameLength);
+}
+
+void NullRenderer::OnResize()
+{
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool NullRenderer::Command_NullRenderer(EventArgs& args)
+{
+	NullRenderer* renderer = static_cast<NullRenderer*>(Renderer::s_mainRenderer);
+	if (renderer == nullptr)
+	{
+		return false;
+	}
+
+	renderer->SetRecordUploadData(args.GetValue("recordData", renderer->IsRecordingUploadData()));
+
+	std::string dumpPath = args.GetValue("dump", "");
+	if (!dumpPath.empty())
+	{
+		Strings lines;
+		renderer->m_lastFrameStream.GetDumpLines(lines);
+		std::string dump;
+		for (int lineIndex = 0; lineIndex < static_cast<int>(lines.size()); ++lineIndex)
+		{
+			dump += lines[lineIndex];
+			dump += '\n';
+		}
+
+		if (FileWriteFromString(dump, dumpPath) >= 0)
+		{
+			PrintNullRendererLine(DevConsole::INFO_MAJOR, Stringf("NullRenderer: %d commands dumped to %s", static_cast<int>(lines.size()), dumpPath.c_str()));
+		}
+		else
+		{
+			PrintNullRendererLine(DevConsole::ERROR, "NullRenderer could not write " + dumpPath);
+		}
+		return true;
+	}
+
+	std::string savePath = args.GetValue("save", "");
+	if (!savePath.empty())
+	{
+		if (renderer->m_lastFrameStream.SaveToFile(savePath))
+		{
+			PrintNullRendererLine(DevConsole::INFO_MAJOR, "NullRenderer: last frame saved to " + savePath);
+		}
+		else
+		{
+			PrintNullRendererLine(DevConsole::ERROR, "NullRenderer could not write " + savePath);
+		}
+		return true;
+	}
+
+	// Replays a saved stream into counters, e.g. to compare a capture against the current build
+	std::string loadPath = args.GetValue("load", "");
+	if (!loadPath.empty())
+	{
+		RenderCommandStream loadedStream;
+		if (!loadedStream.LoadFromFile(loadPath))
+		{
+			PrintNullRendererLine(DevConsole::ERROR, "NullRenderer could not read " + loadPath);
+			return true;
+		}
+		PrintNullRendererLine(DevConsole::INFO_MAJOR, Stringf("%s (%d bytes)", loadPath.c_str(), static_cast<int>(loadedStream.GetSizeBytes())));
+		PrintNullRendererLine(DevConsole::INFO_MINOR, loadedStream.ComputeCounters().ToString());
+		return true;
+	}
+
+	PrintNullRendererLine(DevConsole::INFO_MAJOR, Stringf("NullRenderer: %d frames, last frame %d bytes%s", renderer->m_numFramesRecorded,
+		static_cast<int>(renderer->m_lastFrameStream.GetSizeBytes()), renderer->m_recordUploadData ? "" : " (upload data not recorded)"));
+	PrintNullRendererLine(DevConsole::INFO_MINOR, "Last frame: " + renderer->m_lastFrameCounters.ToString());
+	PrintNullRendererLine(DevConsole::INFO_MINOR, "Total: " + renderer->m_totalCounters.ToString());
+	return true;
+}
+
+#endif // ENGINE_RENDER_NULL
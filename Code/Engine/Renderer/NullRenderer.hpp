@@ -0,0 +1,182 @@
+#pragma once
+#include "Engine/Renderer/Renderer.hpp"
+
+#ifdef ENGINE_RENDER_NULL
+#include "Engine/Renderer/RenderCommandStream.hpp"
+#include "Engine/Core/EventSystem.hpp"
+
+//-----------------------------------------------------------------------------------------------
+// Renderer without a device. Every call is recorded into a RenderCommandStream and counted, so
+// the CPU cost of building and submitting a frame (DebugRender, DevConsole, BitmapFont, ...) can
+// be measured and regression tested on machines without a GPU.
+//
+// State setters compare against what is bound: real changes are recorded, the rest only count as
+// redundant. The stream of the last completed frame is kept until the next EndFrame.
+//
+// Console: NullRenderer [recordData=bool] [dump=file.txt] [save=file.rcs] [load=file.rcs]
+//
+class NullRenderer : public Renderer
+{
+public:
+	NullRenderer(RendererConfig const& config);
+	virtual ~NullRenderer() = default;
+	void Startup() override;
+	void BeginFrame() override;
+	void EndFrame() override;
+	void Shutdown() override;
+
+	void ClearScreen(Rgba8 const& clearColor) override;
+	void BeginCamera(Camera const& camera) override;
+	void EndCamera(Camera const& camera) override;
+
+public:
+	VertexBuffer* CreateVertexBuffer(const unsigned int size, unsigned int stride) override;
+	IndexBuffer* CreateIndexBuffer(const unsigned int size) override;
+	ConstantBuffer* CreateConstantBuffer(const unsigned int size) override;
+
+	void CopyCPUToGPU(const void* data, unsigned int size, VertexBuffer* vbo) override;
+	void CopyCPUToGPU(const void* data, unsigned int size, IndexBuffer* ibo) override;
+	void CopyCPUToGPU(const void* data, unsigned int size, ConstantBuffer* cbo) override;
+	void CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, VertexBuffer* vbo) override;
+	void CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, IndexBuffer* ibo) override;
+
+	// Draw Calls
+	void DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes) override;
+	void DrawVertexArray(std::vector<Vertex_PCU> const& verts) override;
+	void DrawVertexArray(std::vector<Vertex_PCUTBN> const& verts) override;
+	void DrawIndexedVertexArray(std::vector<Vertex_PCU> const& verts, std::vector<unsigned int> const& indexes) override;
+	void DrawIndexedVertexArray(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indexes) override;
+
+	void DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount) override;
+	void DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount) override;
+
+	void SetInstanceData(int numInstances, InstanceData const* instances) override;
+	void DrawVertexBufferInstanced(VertexBuffer* vbo, unsigned int vertexCount, int numInstances) override;
+	void DrawIndexedVertexBufferInstanced(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount, int numInstances) override;
+
+public:
+	//-----------------------------------------------------------------------------------------------
+	// Set Renderer States
+	//-----------------------------------------------------------------------------------------------
+	void BindShader(Shader* shader) override;
+	void SetBlendMode(BlendMode blendMode) override;
+	void SetRasterizerMode(RasterizerMode rasterizerMode) override;
+	void SetDepthMode(DepthMode depthMode) override;
+
+	void SetRenderTargetFormats(const std::vector<DXGI_FORMAT>& rtvFormats = { DXGI_FORMAT_R8G8B8A8_UNORM },
+		DXGI_FORMAT dsvFormat = DXGI_FORMAT_D24_UNORM_S8_UINT,
+		unsigned int msaaCount = 1,
+		unsigned int msaaQuality = 0) override;
+
+	void BindTexture(Texture const* texture, int slot = 0) override;
+	void SetSamplerMode(SamplerMode samplerMode, int slot = 0) override;
+
+	void SetModelConstants(Mat44 const& modelToWorldTransform = Mat44(), Rgba8 const& modelColor = Rgba8::OPAQUE_WHITE) override;
+	void SetEngineConstants(int debugInt = 0, float debugFloat = 0.f) override;
+	void SetLightConstants(Vec3 const& sunDirection = Vec3(2.f, -1.f, -1.f), float sunIntensity = 0.85f, float ambientIntensity = 0.35f) override;
+	void SetLightConstants(LightConstants const& lightConstants) override;
+	void SetPerFrameConstants(PerFrameConstants const& perframeConstants) override;
+
+protected:
+	void SetStateIfChanged(uint32_t& boundValue, uint32_t value, RenderCommandType type, int slot = 0);
+	void UpdateConstants(int slot, void const* data, unsigned int size);
+	void RecordCopy(RenderBufferType bufferType, uint32_t bufferId, void const* data, unsigned int size, unsigned int destOffset = 0);
+
+public:
+	//-----------------------------------------------------------------------------------------------
+	// Manage Resources - Public
+	//-----------------------------------------------------------------------------------------------
+	Texture* CreateOrGetTextureFromFile(char const* imageFilePath) override;
+	Texture* CreateOrGetTextureFromImage(Image const& image) override;
+	Texture* CreateOrGetTextureFromCooked(CookedTexture const& cooked) override;
+	Texture* CreateOrGetTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config) override;
+
+	BitmapFont* CreateOrGetBitmapFont(char const* bitmapFontFilePathWithNoExtension) override;
+	BitmapFont* CreateOrGetSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config = SDFFontConfig()) override;
+
+	Shader* CreateOrGetShader(char const* shaderName, VertexType type = VertexType::VERTEX_PCU) override;
+	void AttachGeometryShader(Shader* shader, char const* shaderName) override;
+	Shader* CreateOrGetShader(ShaderConfig const& config, VertexType type = VertexType::VERTEX_PCU) override;
+
+protected:
+	//-----------------------------------------------------------------------------------------------
+	// Manage Resources - Protected
+	//-----------------------------------------------------------------------------------------------
+	Texture* GetTextureForFileName(char const* imageFilePath);
+	Texture* CreateTexture(char const* name, IntVec2 const& dimensions);
+	Texture* CreateTextureFromFile(char const* imageFilePath);
+
+	BitmapFont* GetBitmapFont(char const* bitmapFontFilePathWithNoExtension, bool isSDF = false);
+	Shader* GetShader(char const* shaderName);
+	Shader* CreateShader(ShaderConfig const& config, VertexType type);
+
+	void CreateDefaultShaderAndTexture();
+	void CreateBuffers();
+
+public:
+	//-----------------------------------------------------------------------------------------------
+	// Recording
+	//-----------------------------------------------------------------------------------------------
+	RenderCommandStream const& GetLastFrameStream() const { return m_lastFrameStream; }
+	RenderCounters const& GetLastFrameCounters() const { return m_lastFrameCounters; }
+	RenderCounters const& GetTotalCounters() const { return m_totalCounters; }
+	int GetNumFramesRecorded() const { return m_numFramesRecorded; }
+
+	// Copying uploaded bytes into the stream matches the memcpy cost of a real upload, but
+	// makes the stream big. Sizes are always recorded
+	void SetRecordUploadData(bool recordUploadData) { m_recordUploadData = recordUploadData; }
+	bool IsRecordingUploadData() const { return m_recordUploadData; }
+
+	static bool Command_NullRenderer(EventArgs& args);
+
+protected:
+	static constexpr int NUM_TEXTURE_SLOT = 8;
+	static constexpr int NUM_SAMPLER_SLOT = 3;
+
+	RenderCommandStream m_frameStream;
+	RenderCommandStream m_lastFrameStream;
+	RenderCounters m_frameCounters;
+	RenderCounters m_lastFrameCounters;
+	RenderCounters m_totalCounters;
+	int m_numFramesRecorded = 0;
+	bool m_recordUploadData = true;
+	int m_numUploadedInstances = 0;
+
+	// INVALID_INDEX_U32 until first set, so the first set always counts as a change
+	uint32_t m_boundShaderId = INVALID_INDEX_U32;
+	uint32_t m_boundBlendMode = INVALID_INDEX_U32;
+	uint32_t m_boundRasterizerMode = INVALID_INDEX_U32;
+	uint32_t m_boundDepthMode = INVALID_INDEX_U32;
+	uint32_t m_boundTextureIdBySlot[NUM_TEXTURE_SLOT];
+	uint32_t m_boundSamplerModeBySlot[NUM_SAMPLER_SLOT];
+	RenderCommandRenderTargets m_boundRenderTargets;
+	bool m_hasBoundRenderTargets = false;
+
+protected:
+	//-----------------------------------------------------------------------------------------------
+	// Manage Resources - data
+	//-----------------------------------------------------------------------------------------------
+	std::vector<Texture*> m_loadedTextures;
+	std::vector<BitmapFont*> m_loadedFonts;
+	std::vector<Shader*> m_loadedShaders;
+	const Texture* m_defaultTexture = nullptr;
+	const Texture* m_defaultNormalTexture = nullptr;
+	const Texture* m_defaultSpecGlossEmitTexture = nullptr;
+	Shader* m_defaultShader = nullptr;
+
+	unsigned int m_nextBufferId = 1;
+	VertexBuffer* m_immediateVBO = nullptr;
+	IndexBuffer* m_immediateIBO = nullptr;
+
+public:
+	//-----------------------------------------------------------------------------------------------
+	// For RenderDoc
+	//-----------------------------------------------------------------------------------------------
+	void BeginRenderEvent(char const* eventName) override;
+	void EndRenderEvent(char const* optional_eventName) override;
+
+public:
+	void OnResize() override;
+};
+
+#endif // ENGINE_RENDER_NULL
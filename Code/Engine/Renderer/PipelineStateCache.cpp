@@ -0,0 +1,211 @@
+#include "Engine/Renderer/PipelineStateCache.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/HashCombine.hpp"
+#include "Engine/Core/Time.hpp"
+#include <map>
+
+//-----------------------------------------------------------------------------------------------
+void RenderTargetLayout::Set(uint32_t numRenderTargets, DXGI_FORMAT const* rtvFormats, DXGI_FORMAT dsvFormat, uint32_t msaaCount, uint32_t msaaQuality)
+{
+	GUARANTEE_OR_DIE(numRenderTargets <= MAX_RENDER_TARGETS, "Too many render targets.");
+	m_numRenderTargets = numRenderTargets;
+	for (uint32_t rtvIndex = 0; rtvIndex < MAX_RENDER_TARGETS; ++rtvIndex)
+	{
+		m_rtvFormats[rtvIndex] = (rtvIndex < numRenderTargets) ? rtvFormats[rtvIndex] : DXGI_FORMAT_UNKNOWN;
+	}
+	m_dsvFormat = dsvFormat;
+	m_msaaCount = msaaCount;
+	m_msaaQuality = msaaQuality;
+}
+
+bool RenderTargetLayout::operator==(RenderTargetLayout const& other) const
+{
+	if (m_numRenderTargets != other.m_numRenderTargets || m_dsvFormat != other.m_dsvFormat
+		|| m_msaaCount != other.m_msaaCount || m_msaaQuality != other.m_msaaQuality)
+	{
+		return false;
+	}
+	for (uint32_t rtvIndex = 0; rtvIndex < m_numRenderTargets; ++rtvIndex)
+	{
+		if (m_rtvFormats[rtvIndex] != other.m_rtvFormats[rtvIndex])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+uint32_t PipelineIdRegistry::InternShaderName(std::string const& shaderName)
+{
+	auto found = m_shaderIds.find(shaderName);
+	if (found != m_shaderIds.end())
+	{
+		return found->second;
+	}
+
+	uint32_t shaderId = static_cast<uint32_t>(m_shaderIds.size()) + 1;
+	GUARANTEE_OR_DIE(shaderId < (1u << GraphicsPipelineKey::SHADER_BITS), "Out of pipeline shader ids.");
+	m_shaderIds[shaderName] = shaderId;
+	return shaderId;
+}
+
+uint32_t PipelineIdRegistry::InternRenderTargetLayout(RenderTargetLayout const& layout)
+{
+	// Most calls set the same layout again, try it first
+	if (m_lastLayoutId != 0 && m_renderTargetLayouts[m_lastLayoutId - 1] == layout)
+	{
+		return m_lastLayoutId;
+	}
+
+	for (size_t layoutIndex = 0; layoutIndex < m_renderTargetLayouts.size(); ++layoutIndex)
+	{
+		if (m_renderTargetLayouts[layoutIndex] == layout)
+		{
+			m_lastLayoutId = static_cast<uint32_t>(layoutIndex) + 1;
+			return m_lastLayoutId;
+		}
+	}
+
+	m_renderTargetLayouts.push_back(layout);
+	m_lastLayoutId = static_cast<uint32_t>(m_renderTargetLayouts.size());
+	GUARANTEE_OR_DIE(m_lastLayoutId < (1u << GraphicsPipelineKey::RENDER_TARGETS_BITS), "Out of render target layout ids.");
+	return m_lastLayoutId;
+}
+
+void PipelineIdRegistry::Clear()
+{
+	m_shaderIds.clear();
+	m_renderTargetLayouts.clear();
+	m_lastLayoutId = 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC uint64_t GraphicsPipelineKey::Pack(uint32_t shaderId, uint32_t renderTargetLayoutId, VertexType inputLayout, BlendMode blendMode, RasterizerMode rasterizerMode, DepthMode depthMode)
+{
+	GraphicsPipelineKey key;
+	key.SetShaderId(shaderId);
+	key.SetRenderTargetLayoutId(renderTargetLayoutId);
+	key.SetInputLayout(inputLayout);
+	key.SetBlendMode(blendMode);
+	key.SetRasterizerMode(rasterizerMode);
+	key.SetDepthMode(depthMode);
+	return key.GetValue();
+}
+
+bool GraphicsPipelineKey::SetBits(int shift, int numBits, uint32_t fieldValue)
+{
+	uint64_t fieldMask = ((1ull << numBits) - 1) << shift;
+	uint64_t newValue = (m_value & ~fieldMask) | ((static_cast<uint64_t>(fieldValue) << shift) & fieldMask);
+	if (newValue == m_value)
+	{
+		return false;
+	}
+	m_value = newValue;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string PipelineCacheBenchmarkResult::ToString() const
+{
+	return Stringf("%d draws over %d states, change every %d draws. Reference %.3f ms, packed key %.3f ms (%d cache lookups)",
+		m_numDraws, m_numStates, m_drawsPerStateChange, m_referenceMs, m_packedKeyMs, m_numPackedKeyLookups);
+}
+
+PipelineCacheBenchmarkResult RunPipelineCacheBenchmark(int numDraws, int numStates, int drawsPerStateChange)
+{
+	struct MockState
+	{
+		std::string		m_shaderName;
+		uint32_t		m_shaderId = 0;
+		VertexType		m_inputLayout = VertexType::VERTEX_PCU;
+		BlendMode		m_blendMode = BlendMode::OPAQUE;
+		RasterizerMode	m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
+		DepthMode		m_depthMode = DepthMode::READ_WRITE_LESS_EQUAL;
+	};
+
+	PipelineCacheBenchmarkResult result;
+	result.m_numDraws = numDraws;
+	result.m_numStates = numStates;
+	result.m_drawsPerStateChange = drawsPerStateChange > 0 ? drawsPerStateChange : 1;
+
+	PipelineIdRegistry registry;
+	RenderTargetLayout renderTargets;
+	uint32_t renderTargetLayoutId = registry.InternRenderTargetLayout(renderTargets);
+	std::vector<MockState> states(numStates);
+	for (int stateIndex = 0; stateIndex < numStates; ++stateIndex)
+	{
+		MockState& state = states[stateIndex];
+		state.m_shaderName = Stringf("Data/Shaders/BenchmarkShader%d", stateIndex / 4);
+		state.m_shaderId = registry.InternShaderName(state.m_shaderName);
+		state.m_blendMode = static_cast<BlendMode>(stateIndex % static_cast<int>(BlendMode::COUNT));
+		state.m_depthMode = static_cast<DepthMode>(stateIndex % static_cast<int>(DepthMode::COUNT));
+	}
+
+	// What GraphicsPSO::Finalize did per draw before: hash the name and every field, then a map lookup
+	std::map<size_t, int> referenceCache;
+	uint64_t referenceChecksum = 0;
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int drawIndex = 0; drawIndex < numDraws; ++drawIndex)
+	{
+		MockState const& state = states[(drawIndex / result.m_drawsPerStateChange) % numStates];
+		size_t seed = 0;
+		hash_combine(seed, state.m_shaderName);
+		hash_combine(seed, static_cast<int>(state.m_inputLayout));
+		hash_combine(seed, static_cast<int>(state.m_blendMode));
+		hash_combine(seed, static_cast<int>(state.m_rasterizerMode));
+		hash_combine(seed, static_cast<int>(state.m_depthMode));
+		hash_combine(seed, renderTargets.m_numRenderTargets);
+		for (int rtvIndex = 0; rtvIndex < RenderTargetLayout::MAX_RENDER_TARGETS; ++rtvIndex)
+		{
+			hash_combine(seed, static_cast<int>(renderTargets.m_rtvFormats[rtvIndex]));
+		}
+		hash_combine(seed, static_cast<int>(renderTargets.m_dsvFormat));
+		hash_combine(seed, renderTargets.m_msaaCount);
+		hash_combine(seed, renderTargets.m_msaaQuality);
+
+		auto found = referenceCache.find(seed);
+		if (found == referenceCache.end())
+		{
+			found = referenceCache.emplace(seed, static_cast<int>(referenceCache.size())).first;
+		}
+		referenceChecksum += static_cast<uint64_t>(found->second);
+	}
+	result.m_referenceMs = (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+
+	// The setters the renderer calls per draw, a lookup only when one of them changed the key
+	FlatPipelineCache<int> packedCache;
+	GraphicsPipelineKey key;
+	key.SetRenderTargetLayoutId(renderTargetLayoutId);
+	bool isDirty = true;
+	int currentValue = 0;
+	uint64_t packedChecksum = 0;
+	startSeconds = GetCurrentTimeSeconds();
+	for (int drawIndex = 0; drawIndex < numDraws; ++drawIndex)
+	{
+		MockState const& state = states[(drawIndex / result.m_drawsPerStateChange) % numStates];
+		isDirty |= key.SetShaderId(state.m_shaderId);
+		isDirty |= key.SetInputLayout(state.m_inputLayout);
+		isDirty |= key.SetBlendMode(state.m_blendMode);
+		isDirty |= key.SetRasterizerMode(state.m_rasterizerMode);
+		isDirty |= key.SetDepthMode(state.m_depthMode);
+		if (isDirty)
+		{
+			int* found = packedCache.Find(key.GetValue());
+			if (found == nullptr)
+			{
+				packedCache.Insert(key.GetValue(), packedCache.GetSize());
+				found = packedCache.Find(key.GetValue());
+			}
+			currentValue = *found;
+			isDirty = false;
+		}
+		packedChecksum += static_cast<uint64_t>(currentValue);
+	}
+	result.m_packedKeyMs = (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+	result.m_numPackedKeyLookups = static_cast<int>(packedCache.GetNumLookups());
+
+	// Both must have resolved every draw to the same pipeline, in the same order of first use
+	GUARANTEE_OR_DIE(referenceChecksum == packedChecksum, "Pipeline cache benchmark paths disagree.");
+	return result;
+}
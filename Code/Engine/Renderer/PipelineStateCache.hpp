@@ -0,0 +1,277 @@
+#pragma once
+#include "Engine/Renderer/RendererCommon.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// Pipeline state keys and cache, without any graphics API in them.
+//
+// A pipeline state is named by one 64 bit key. Strings and format lists are interned to small
+// ids once, the enum fields are packed into bits, so building and comparing a key costs a few
+// shifts. DX12 GraphicsPSO/ComputePSO keep a key up to date as the desired state changes and
+// look it up in a FlatPipelineCache only when it actually changed.
+//
+// Graphics key, low bits first:
+//   shader id(24) render target layout id(16) input layout(2) blend(2) rasterizer(3) depth(3) ... compute(1) valid(1)
+//
+constexpr uint64_t PIPELINE_KEY_VALID_BIT	= 1ull << 63; // a built key is never 0, which marks empty cache slots
+constexpr uint64_t PIPELINE_KEY_COMPUTE_BIT	= 1ull << 62;
+
+//-----------------------------------------------------------------------------------------------
+struct RenderTargetLayout
+{
+	static constexpr int MAX_RENDER_TARGETS = 8;
+
+	uint32_t	m_numRenderTargets = 1;
+	DXGI_FORMAT	m_rtvFormats[MAX_RENDER_TARGETS] = { DXGI_FORMAT_R8G8B8A8_UNORM };
+	DXGI_FORMAT	m_dsvFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+	uint32_t	m_msaaCount = 1;
+	uint32_t	m_msaaQuality = 0;
+
+	// Unused render target slots are always DXGI_FORMAT_UNKNOWN
+	void Set(uint32_t numRenderTargets, DXGI_FORMAT const* rtvFormats, DXGI_FORMAT dsvFormat, uint32_t msaaCount, uint32_t msaaQuality);
+	bool operator==(RenderTargetLayout const& other) const;
+};
+
+//-----------------------------------------------------------------------------------------------
+// Hands out ids from 1 up, the same value always gets the same id. Ids are never reused, they
+// live as long as the program
+class PipelineIdRegistry
+{
+public:
+	uint32_t InternShaderName(std::string const& shaderName);
+	uint32_t InternRenderTargetLayout(RenderTargetLayout const& layout);
+
+	int GetNumShaderIds() const { return static_cast<int>(m_shaderIds.size()); }
+	int GetNumRenderTargetLayouts() const { return static_cast<int>(m_renderTargetLayouts.size()); }
+
+	void Clear();
+
+protected:
+	std::unordered_map<std::string, uint32_t> m_shaderIds;
+	// A handful per program, a linear search beats hashing nine formats
+	std::vector<RenderTargetLayout> m_renderTargetLayouts;
+	uint32_t m_lastLayoutId = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+// The packed key of the desired graphics state. Every setter returns true only when the field
+// really changed, so the owner can keep a dirty flag without comparing anything else
+class GraphicsPipelineKey
+{
+public:
+	static constexpr int SHADER_SHIFT = 0;			static constexpr int SHADER_BITS = 24;
+	static constexpr int RENDER_TARGETS_SHIFT = 24;	static constexpr int RENDER_TARGETS_BITS = 16;
+	static constexpr int INPUT_LAYOUT_SHIFT = 40;	static constexpr int INPUT_LAYOUT_BITS = 2;
+	static constexpr int BLEND_SHIFT = 42;			static constexpr int BLEND_BITS = 2;
+	static constexpr int RASTERIZER_SHIFT = 44;		static constexpr int RASTERIZER_BITS = 3;
+	static constexpr int DEPTH_SHIFT = 47;			static constexpr int DEPTH_BITS = 3;
+
+	// A new enum value must not silently spill into the next field
+	static_assert(static_cast<int>(VertexType::COUNT) <= (1 << INPUT_LAYOUT_BITS), "VertexType outgrew its pipeline key bits");
+	static_assert(static_cast<int>(BlendMode::COUNT) <= (1 << BLEND_BITS), "BlendMode outgrew its pipeline key bits");
+	static_assert(static_cast<int>(RasterizerMode::COUNT) <= (1 << RASTERIZER_BITS), "RasterizerMode outgrew its pipeline key bits");
+	static_assert(static_cast<int>(DepthMode::COUNT) <= (1 << DEPTH_BITS), "DepthMode outgrew its pipeline key bits");
+	static_assert(RENDER_TARGETS_SHIFT == SHADER_SHIFT + SHADER_BITS && INPUT_LAYOUT_SHIFT == RENDER_TARGETS_SHIFT + RENDER_TARGETS_BITS
+		&& BLEND_SHIFT == INPUT_LAYOUT_SHIFT + INPUT_LAYOUT_BITS && RASTERIZER_SHIFT == BLEND_SHIFT + BLEND_BITS
+		&& DEPTH_SHIFT == RASTERIZER_SHIFT + RASTERIZER_BITS, "Pipeline key fields must not overlap");
+	static_assert(DEPTH_SHIFT + DEPTH_BITS <= 62, "Pipeline key fields run into the compute and valid bits");
+
+	GraphicsPipelineKey() = default;
+	explicit GraphicsPipelineKey(uint64_t value) : m_value(value) {}
+
+	bool SetShaderId(uint32_t shaderId)					{ return SetBits(SHADER_SHIFT, SHADER_BITS, shaderId); }
+	bool SetRenderTargetLayoutId(uint32_t layoutId)		{ return SetBits(RENDER_TARGETS_SHIFT, RENDER_TARGETS_BITS, layoutId); }
+	bool SetInputLayout(VertexType inputLayout)			{ return SetBits(INPUT_LAYOUT_SHIFT, INPUT_LAYOUT_BITS, static_cast<uint32_t>(inputLayout)); }
+	bool SetBlendMode(BlendMode blendMode)				{ return SetBits(BLEND_SHIFT, BLEND_BITS, static_cast<uint32_t>(blendMode)); }
+	bool SetRasterizerMode(RasterizerMode rasterizer)	{ return SetBits(RASTERIZER_SHIFT, RASTERIZER_BITS, static_cast<uint32_t>(rasterizer)); }
+	bool SetDepthMode(DepthMode depthMode)				{ return SetBits(DEPTH_SHIFT, DEPTH_BITS, static_cast<uint32_t>(depthMode)); }
+
+	uint32_t GetShaderId() const				{ return GetBits(SHADER_SHIFT, SHADER_BITS); }
+	uint32_t GetRenderTargetLayoutId() const	{ return GetBits(RENDER_TARGETS_SHIFT, RENDER_TARGETS_BITS); }
+	VertexType GetInputLayout() const			{ return static_cast<VertexType>(GetBits(INPUT_LAYOUT_SHIFT, INPUT_LAYOUT_BITS)); }
+	BlendMode GetBlendMode() const				{ return static_cast<BlendMode>(GetBits(BLEND_SHIFT, BLEND_BITS)); }
+	RasterizerMode GetRasterizerMode() const	{ return static_cast<RasterizerMode>(GetBits(RASTERIZER_SHIFT, RASTERIZER_BITS)); }
+	DepthMode GetDepthMode() const				{ return static_cast<DepthMode>(GetBits(DEPTH_SHIFT, DEPTH_BITS)); }
+
+	uint64_t GetValue() const { return m_value; }
+
+	static uint64_t Pack(uint32_t shaderId, uint32_t renderTargetLayoutId, VertexType inputLayout, BlendMode blendMode, RasterizerMode rasterizerMode, DepthMode depthMode);
+
+protected:
+	bool SetBits(int shift, int numBits, uint32_t fieldValue);
+	uint32_t GetBits(int shift, int numBits) const { return static_cast<uint32_t>((m_value >> shift) & ((1ull << numBits) - 1)); }
+
+protected:
+	uint64_t m_value = PIPELINE_KEY_VALID_BIT;
+};
+
+inline uint64_t MakeComputePipelineKey(uint32_t shaderId)
+{
+	return PIPELINE_KEY_VALID_BIT | PIPELINE_KEY_COMPUTE_BIT | shaderId;
+}
+
+//-----------------------------------------------------------------------------------------------
+struct PipelineCacheBenchmarkResult
+{
+	int		m_numDraws = 0;
+	int		m_numStates = 0;
+	int		m_drawsPerStateChange = 0;
+	double	m_referenceMs = 0.0;	// shader name and state hashed per draw, std::map lookup
+	double	m_packedKeyMs = 0.0;	// packed key setters, dirty flag, FlatPipelineCache on change
+	int		m_numPackedKeyLookups = 0;
+
+	std::string ToString() const;
+};
+
+// Resolves numDraws draws cycling through numStates pipeline states, changing state every
+// drawsPerStateChange draws, the old way and through GraphicsPipelineKey
+PipelineCacheBenchmarkResult RunPipelineCacheBenchmark(int numDraws, int numStates, int drawsPerStateChange);
+
+//-----------------------------------------------------------------------------------------------
+// Open addressed map from a pipeline key to T, linear probing in a power of two table kept at
+// most half full. Key 0 marks an empty slot. Entries are only added, Clear drops them all
+template <typename T>
+class FlatPipelineCache
+{
+public:
+	explicit FlatPipelineCache(uint32_t initialCapacity = 64);
+
+	// Returns nullptr when the key is not in the cache
+	T* Find(uint64_t key);
+	void Insert(uint64_t key, T const& value);
+	void Clear();
+
+	template <typename Callback>
+	void ForEach(Callback callback);
+
+	int GetSize() const { return static_cast<int>(m_size); }
+	int GetCapacity() const { return static_cast<int>(m_keys.size()); }
+	uint64_t GetNumLookups() const { return m_numLookups; }
+	uint64_t GetNumProbes() const { return m_numProbes; }
+
+protected:
+	uint32_t GetHomeSlot(uint64_t key) const;
+	void Grow();
+
+protected:
+	std::vector<uint64_t> m_keys;
+	std::vector<T> m_values;
+	uint32_t m_size = 0;
+	uint32_t m_mask = 0;
+	int m_shift = 0;
+	uint64_t m_numLookups = 0;
+	uint64_t m_numProbes = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+template <typename T>
+FlatPipelineCache<T>::FlatPipelineCache(uint32_t initialCapacity /*= 64*/)
+{
+	uint32_t capacity = 16;
+	while (capacity < initialCapacity)
+	{
+		capacity <<= 1;
+	}
+	m_keys.assign(capacity, 0);
+	m_values.assign(capacity, T());
+	m_mask = capacity - 1;
+	m_shift = 64;
+	for (uint32_t bits = capacity; bits > 1; bits >>= 1)
+	{
+		--m_shift;
+	}
+}
+
+template <typename T>
+uint32_t FlatPipelineCache<T>::GetHomeSlot(uint64_t key) const
+{
+	// Fibonacci hashing, the top bits of the product mix every field of the key
+	return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> m_shift) & m_mask;
+}
+
+template <typename T>
+T* FlatPipelineCache<T>::Find(uint64_t key)
+{
+	++m_numLookups;
+	for (uint32_t slot = GetHomeSlot(key);; slot = (slot + 1) & m_mask)
+	{
+		++m_numProbes;
+		if (m_keys[slot] == key)
+		{
+			return &m_values[slot];
+		}
+		if (m_keys[slot] == 0)
+		{
+			return nullptr;
+		}
+	}
+}
+
+template <typename T>
+void FlatPipelineCache<T>::Insert(uint64_t key, T const& value)
+{
+	if ((m_size + 1) * 2 > m_keys.size())
+	{
+		Grow();
+	}
+
+	uint32_t slot = GetHomeSlot(key);
+	while (m_keys[slot] != 0 && m_keys[slot] != key)
+	{
+		slot = (slot + 1) & m_mask;
+	}
+	if (m_keys[slot] == 0)
+	{
+		++m_size;
+	}
+	m_keys[slot] = key;
+	m_values[slot] = value;
+}
+
+template <typename T>
+void FlatPipelineCache<T>::Clear()
+{
+	m_keys.assign(m_keys.size(), 0);
+	m_values.assign(m_values.size(), T());
+	m_size = 0;
+}
+
+template <typename T>
+template <typename Callback>
+void FlatPipelineCache<T>::ForEach(Callback callback)
+{
+	for (size_t slot = 0; slot < m_keys.size(); ++slot)
+	{
+		if (m_keys[slot] != 0)
+		{
+			callback(m_keys[slot], m_values[slot]);
+		}
+	}
+}
+
+template <typename T>
+void FlatPipelineCache<T>::Grow()
+{
+	std::vector<uint64_t> oldKeys;
+	std::vector<T> oldValues;
+	oldKeys.swap(m_keys);
+	oldValues.swap(m_values);
+
+	uint32_t capacity = static_cast<uint32_t>(oldKeys.size()) * 2;
+	m_keys.assign(capacity, 0);
+	m_values.assign(capacity, T());
+	m_mask = capacity - 1;
+	--m_shift;
+	m_size = 0;
+
+	for (size_t slot = 0; slot < oldKeys.size(); ++slot)
+	{
+		if (oldKeys[slot] != 0)
+		{
+			Insert(oldKeys[slot], oldValues[slot]);
+		}
+	}
+}
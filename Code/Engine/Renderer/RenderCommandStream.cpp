@@ -0,0 +1,364 @@
+#include "Engine/Renderer/RenderCommandStream.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include <cstring>
+#include <type_traits>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	constexpr char		STREAM_FILE_MAGIC[4] = { 'R', 'C', 'S', '1' };
+	constexpr size_t	COMMAND_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+
+	char const* const s_commandNames[(int)RenderCommandType::COUNT] =
+	{
+		"BEGIN_FRAME",
+		"END_FRAME",
+		"CLEAR_SCREEN",
+		"BEGIN_CAMERA",
+		"END_CAMERA",
+		"COPY_TO_BUFFER",
+		"DRAW",
+		"DRAW_INDEXED",
+		"BIND_SHADER",
+		"SET_BLEND_MODE",
+		"SET_RASTERIZER_MODE",
+		"SET_DEPTH_MODE",
+		"SET_SAMPLER_MODE",
+		"BIND_TEXTURE",
+		"SET_CONSTANTS",
+		"SET_RENDER_TARGET_FORMATS",
+		"BEGIN_EVENT",
+		"END_EVENT",
+		"DRAW_INSTANCED",
+		"DRAW_INDEXED_INSTANCED",
+	};
+
+	char const* GetBufferTypeName(RenderBufferType type)
+	{
+		switch (type)
+		{
+		case RenderBufferType::VERTEX:		return "vbo";
+		case RenderBufferType::INDEX:		return "ibo";
+		case RenderBufferType::CONSTANT:	return "cbo";
+		case RenderBufferType::INSTANCE:	return "instances";
+		}
+		return "?";
+	}
+
+	// Payloads are written with memcpy, read them back the same way since they are not aligned.
+	// CameraConstants is not trivially copyable only because Vec3 and Mat44 spell out their copy
+	// constructors, its bytes are still the whole value
+	template<typename T>
+	T ReadPayload(uint8_t const* payload, uint32_t payloadSize)
+	{
+		static_assert(std::is_standard_layout_v<T>, "Render command payloads are copied as bytes");
+		T result;
+		memcpy(static_cast<void*>(&result), payload, payloadSize < sizeof(T) ? payloadSize : sizeof(T));
+		return result;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+char const* GetRenderCommandName(RenderCommandType type)
+{
+	if (type >= RenderCommandType::COUNT)
+	{
+		return "UNKNOWN";
+	}
+	return s_commandNames[(int)type];
+}
+
+//-----------------------------------------------------------------------------------------------
+void RenderCounters::Reset()
+{
+	*this = RenderCounters();
+}
+
+void RenderCounters::Accumulate(RenderCounters const& other)
+{
+	m_numCommands += other.m_numCommands;
+	m_numDrawCalls += other.m_numDrawCalls;
+	m_numVertexes += other.m_numVertexes;
+	m_numIndexes += other.m_numIndexes;
+	m_numStateChanges += other.m_numStateChanges;
+	m_numRedundantStateChanges += other.m_numRedundantStateChanges;
+	m_numConstantUpdates += other.m_numConstantUpdates;
+	m_numBytesCopied += other.m_numBytesCopied;
+	m_numCameras += other.m_numCameras;
+	m_numInstances += other.m_numInstances;
+}
+
+std::string RenderCounters::ToString() const
+{
+	return Stringf("commands=%llu draws=%llu verts=%llu indexes=%llu instances=%llu stateChanges=%llu redundant=%llu constants=%llu bytesCopied=%llu cameras=%llu",
+		(unsigned long long)m_numCommands, (unsigned long long)m_numDrawCalls, (unsigned long long)m_numVertexes, (unsigned long long)m_numIndexes, (unsigned long long)m_numInstances,
+		(unsigned long long)m_numStateChanges, (unsigned long long)m_numRedundantStateChanges, (unsigned long long)m_numConstantUpdates,
+		(unsigned long long)m_numBytesCopied, (unsigned long long)m_numCameras);
+}
+
+//-----------------------------------------------------------------------------------------------
+void RenderCommandStream::Clear()
+{
+	m_bytes.clear();
+	m_numCommands = 0;
+}
+
+void RenderCommandStream::Reserve(size_t numBytes)
+{
+	m_bytes.reserve(numBytes);
+}
+
+void RenderCommandStream::Write(RenderCommandType type, void const* payload /*= nullptr*/, uint32_t payloadSize /*= 0*/)
+{
+	Write(type, payload, payloadSize, nullptr, 0);
+}
+
+void RenderCommandStream::Write(RenderCommandType type, void const* payload, uint32_t payloadSize, void const* extra, uint32_t extraSize)
+{
+	uint32_t totalSize = payloadSize + extraSize;
+	size_t offset = m_bytes.size();
+	m_bytes.resize(offset + COMMAND_HEADER_SIZE + totalSize);
+
+	uint8_t* write = m_bytes.data() + offset;
+	*write = static_cast<uint8_t>(type);
+	memcpy(write + 1, &totalSize, sizeof(uint32_t));
+	write += COMMAND_HEADER_SIZE;
+
+	if (payloadSize > 0)
+	{
+		memcpy(write, payload, payloadSize);
+	}
+	if (extraSize > 0)
+	{
+		memcpy(write + payloadSize, extra, extraSize);
+	}
+	++m_numCommands;
+}
+
+bool RenderCommandStream::ReadCommand(size_t& inout_offset, RenderCommandType& out_type, uint8_t const*& out_payload, uint32_t& out_payloadSize) const
+{
+	if (inout_offset + COMMAND_HEADER_SIZE > m_bytes.size())
+	{
+		return false;
+	}
+
+	uint8_t const* read = m_bytes.data() + inout_offset;
+	uint32_t payloadSize = 0;
+	memcpy(&payloadSize, read + 1, sizeof(uint32_t));
+	if (inout_offset + COMMAND_HEADER_SIZE + payloadSize > m_bytes.size())
+	{
+		return false;
+	}
+
+	out_type = static_cast<RenderCommandType>(*read);
+	out_payload = read + COMMAND_HEADER_SIZE;
+	out_payloadSize = payloadSize;
+	inout_offset += COMMAND_HEADER_SIZE + payloadSize;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+RenderCounters RenderCommandStream::ComputeCounters() const
+{
+	RenderCounters counters;
+
+	size_t offset = 0;
+	RenderCommandType type;
+	uint8_t const* payload = nullptr;
+	uint32_t payloadSize = 0;
+	while (ReadCommand(offset, type, payload, payloadSize))
+	{
+		++counters.m_numCommands;
+		switch (type)
+		{
+		case RenderCommandType::BEGIN_CAMERA:
+			// the payload is what gets uploaded as camera constants
+			++counters.m_numCameras;
+			++counters.m_numConstantUpdates;
+			counters.m_numBytesCopied += payloadSize;
+			break;
+		case RenderCommandType::COPY_TO_BUFFER:
+			counters.m_numBytesCopied += ReadPayload<RenderCommandCopy>(payload, payloadSize).m_numBytes;
+			break;
+		case RenderCommandType::DRAW:
+			++counters.m_numDrawCalls;
+			counters.m_numVertexes += ReadPayload<RenderCommandDraw>(payload, payloadSize).m_count;
+			break;
+		case RenderCommandType::DRAW_INDEXED:
+			++counters.m_numDrawCalls;
+			counters.m_numIndexes += ReadPayload<RenderCommandDraw>(payload, payloadSize).m_count;
+			break;
+		case RenderCommandType::DRAW_INSTANCED:
+		case RenderCommandType::DRAW_INDEXED_INSTANCED:
+		{
+			RenderCommandDrawInstanced draw = ReadPayload<RenderCommandDrawInstanced>(payload, payloadSize);
+			uint64_t count = static_cast<uint64_t>(draw.m_draw.m_count) * draw.m_numInstances;
+			++counters.m_numDrawCalls;
+			counters.m_numInstances += draw.m_numInstances;
+			if (type == RenderCommandType::DRAW_INSTANCED)
+			{
+				counters.m_numVertexes += count;
+			}
+			else
+			{
+				counters.m_numIndexes += count;
+			}
+			break;
+		}
+		case RenderCommandType::BIND_SHADER:
+		case RenderCommandType::SET_BLEND_MODE:
+		case RenderCommandType::SET_RASTERIZER_MODE:
+		case RenderCommandType::SET_DEPTH_MODE:
+		case RenderCommandType::SET_SAMPLER_MODE:
+		case RenderCommandType::BIND_TEXTURE:
+		case RenderCommandType::SET_RENDER_TARGET_FORMATS:
+			++counters.m_numStateChanges;
+			break;
+		case RenderCommandType::SET_CONSTANTS:
+		{
+			RenderCommandConstants constants = ReadPayload<RenderCommandConstants>(payload, payloadSize);
+			++counters.m_numConstantUpdates;
+			counters.m_numBytesCopied += constants.m_numBytes;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	return counters;
+}
+
+void RenderCommandStream::GetDumpLines(Strings& out_lines, int maxCommands /*= -1*/) const
+{
+	size_t offset = 0;
+	RenderCommandType type;
+	uint8_t const* payload = nullptr;
+	uint32_t payloadSize = 0;
+	int commandIndex = 0;
+	while ((maxCommands < 0 || commandIndex < maxCommands) && ReadCommand(offset, type, payload, payloadSize))
+	{
+		std::string args;
+		switch (type)
+		{
+		case RenderCommandType::CLEAR_SCREEN:
+		{
+			RenderCommandClear clear = ReadPayload<RenderCommandClear>(payload, payloadSize);
+			args = Stringf("color=(%.2f, %.2f, %.2f, %.2f)", clear.m_color[0], clear.m_color[1], clear.m_color[2], clear.m_color[3]);
+			break;
+		}
+		case RenderCommandType::BEGIN_CAMERA:
+		{
+			CameraConstants camera = ReadPayload<CameraConstants>(payload, payloadSize);
+			args = Stringf("pos=(%.2f, %.2f, %.2f)", camera.CameraWorldPosition.x, camera.CameraWorldPosition.y, camera.CameraWorldPosition.z);
+			break;
+		}
+		case RenderCommandType::COPY_TO_BUFFER:
+		{
+			RenderCommandCopy copy = ReadPayload<RenderCommandCopy>(payload, payloadSize);
+			args = Stringf("%s=%u offset=%u bytes=%u recorded=%u", GetBufferTypeName(copy.m_bufferType), copy.m_bufferId, copy.m_destOffset, copy.m_numBytes, copy.m_numRecordedBytes);
+			break;
+		}
+		case RenderCommandType::DRAW:
+		{
+			RenderCommandDraw draw = ReadPayload<RenderCommandDraw>(payload, payloadSize);
+			args = Stringf("vbo=%u stride=%u vertexes=%u", draw.m_vertexBufferId, draw.m_stride, draw.m_count);
+			break;
+		}
+		case RenderCommandType::DRAW_INDEXED:
+		{
+			RenderCommandDraw draw = ReadPayload<RenderCommandDraw>(payload, payloadSize);
+			args = Stringf("vbo=%u ibo=%u stride=%u indexes=%u", draw.m_vertexBufferId, draw.m_indexBufferId, draw.m_stride, draw.m_count);
+			break;
+		}
+		case RenderCommandType::DRAW_INSTANCED:
+		{
+			RenderCommandDrawInstanced draw = ReadPayload<RenderCommandDrawInstanced>(payload, payloadSize);
+			args = Stringf("vbo=%u stride=%u vertexes=%u instances=%u", draw.m_draw.m_vertexBufferId, draw.m_draw.m_stride, draw.m_draw.m_count, draw.m_numInstances);
+			break;
+		}
+		case RenderCommandType::DRAW_INDEXED_INSTANCED:
+		{
+			RenderCommandDrawInstanced draw = ReadPayload<RenderCommandDrawInstanced>(payload, payloadSize);
+			args = Stringf("vbo=%u ibo=%u stride=%u indexes=%u instances=%u", draw.m_draw.m_vertexBufferId, draw.m_draw.m_indexBufferId, draw.m_draw.m_stride, draw.m_draw.m_count, draw.m_numInstances);
+			break;
+		}
+		case RenderCommandType::BIND_SHADER:
+		case RenderCommandType::SET_BLEND_MODE:
+		case RenderCommandType::SET_RASTERIZER_MODE:
+		case RenderCommandType::SET_DEPTH_MODE:
+		{
+			args = Stringf("%u", ReadPayload<RenderCommandState>(payload, payloadSize).m_value);
+			break;
+		}
+		case RenderCommandType::SET_SAMPLER_MODE:
+		case RenderCommandType::BIND_TEXTURE:
+		{
+			RenderCommandState state = ReadPayload<RenderCommandState>(payload, payloadSize);
+			args = Stringf("%u slot=%d", state.m_value, state.m_slot);
+			break;
+		}
+		case RenderCommandType::SET_CONSTANTS:
+		{
+			RenderCommandConstants constants = ReadPayload<RenderCommandConstants>(payload, payloadSize);
+			args = Stringf("slot=%d bytes=%u recorded=%u", constants.m_slot, constants.m_numBytes, constants.m_numRecordedBytes);
+			break;
+		}
+		case RenderCommandType::SET_RENDER_TARGET_FORMATS:
+		{
+			RenderCommandRenderTargets targets = ReadPayload<RenderCommandRenderTargets>(payload, payloadSize);
+			args = Stringf("rtvs=%u rtv0=%u dsv=%u msaa=%u", targets.m_numRtvs, targets.m_rtvFormats[0], targets.m_dsvFormat, targets.m_msaaCount);
+			break;
+		}
+		case RenderCommandType::BEGIN_EVENT:
+		case RenderCommandType::END_EVENT:
+			args = std::string(reinterpret_cast<char const*>(payload), payloadSize);
+			break;
+		default:
+			break;
+		}
+
+		out_lines.push_back(Stringf("%6d %-26s %s", commandIndex, GetRenderCommandName(type), args.c_str()));
+		++commandIndex;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+bool RenderCommandStream::SaveToFile(std::string const& filePath) const
+{
+	std::vector<uint8_t> fileBuffer;
+	fileBuffer.resize(sizeof(STREAM_FILE_MAGIC) + sizeof(uint32_t) + m_bytes.size());
+
+	uint32_t numCommands = static_cast<uint32_t>(m_numCommands);
+	memcpy(fileBuffer.data(), STREAM_FILE_MAGIC, sizeof(STREAM_FILE_MAGIC));
+	memcpy(fileBuffer.data() + sizeof(STREAM_FILE_MAGIC), &numCommands, sizeof(uint32_t));
+	if (!m_bytes.empty())
+	{
+		memcpy(fileBuffer.data() + sizeof(STREAM_FILE_MAGIC) + sizeof(uint32_t), m_bytes.data(), m_bytes.size());
+	}
+
+	return FileWriteFromBuffer(fileBuffer, filePath) >= 0;
+}
+
+bool RenderCommandStream::LoadFromFile(std::string const& filePath)
+{
+	std::vector<uint8_t> fileBuffer;
+	if (FileReadToBuffer(fileBuffer, filePath) < 0)
+	{
+		return false;
+	}
+
+	size_t const headerSize = sizeof(STREAM_FILE_MAGIC) + sizeof(uint32_t);
+	if (fileBuffer.size() < headerSize || memcmp(fileBuffer.data(), STREAM_FILE_MAGIC, sizeof(STREAM_FILE_MAGIC)) != 0)
+	{
+		DebuggerPrintf("RenderCommandStream: %s is not a command stream file\n", filePath.c_str());
+		return false;
+	}
+
+	uint32_t numCommands = 0;
+	memcpy(&numCommands, fileBuffer.data() + sizeof(STREAM_FILE_MAGIC), sizeof(uint32_t));
+	m_bytes.assign(fileBuffer.begin() + headerSize, fileBuffer.end());
+	m_numCommands = static_cast<int>(numCommands);
+	return true;
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include "Engine/Renderer/RendererCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// Compact binary log of the calls made on a Renderer, written by NullRenderer.
+//
+// Every command is [uint8 type][uint32 payload size][payload]. Payloads are the plain structs
+// below, COPY_TO_BUFFER and SET_CONSTANTS may be followed by the uploaded bytes. The stream has
+// no pointers in it, so it can be saved, loaded on another machine, dumped as text or replayed
+// into RenderCounters.
+//
+enum class RenderCommandType : uint8_t
+{
+	BEGIN_FRAME,
+	END_FRAME,
+	CLEAR_SCREEN,
+	BEGIN_CAMERA,
+	END_CAMERA,
+	COPY_TO_BUFFER,
+	DRAW,
+	DRAW_INDEXED,
+	BIND_SHADER,
+	SET_BLEND_MODE,
+	SET_RASTERIZER_MODE,
+	SET_DEPTH_MODE,
+	SET_SAMPLER_MODE,
+	BIND_TEXTURE,
+	SET_CONSTANTS,
+	SET_RENDER_TARGET_FORMATS,
+	BEGIN_EVENT,
+	END_EVENT,
+	DRAW_INSTANCED,
+	DRAW_INDEXED_INSTANCED,
+	COUNT
+};
+
+char const* GetRenderCommandName(RenderCommandType type);
+
+enum class RenderBufferType : uint8_t
+{
+	VERTEX,
+	INDEX,
+	CONSTANT,
+	INSTANCE,
+};
+
+//-----------------------------------------------------------------------------------------------
+// Payloads
+//-----------------------------------------------------------------------------------------------
+struct RenderCommandClear
+{
+	float		m_color[4] = {};
+};
+
+struct RenderCommandCopy
+{
+	RenderBufferType	m_bufferType = RenderBufferType::VERTEX;
+	uint32_t			m_bufferId = 0;
+	uint32_t			m_numBytes = 0;
+	uint32_t			m_numRecordedBytes = 0; // 0 when upload data recording is off
+	uint32_t			m_destOffset = 0;		// last, so streams saved before it load with 0
+};
+
+struct RenderCommandDraw
+{
+	uint32_t	m_vertexBufferId = 0;
+	uint32_t	m_indexBufferId = 0; // DRAW_INDEXED only
+	uint32_t	m_stride = 0;
+	uint32_t	m_count = 0; // vertexes for DRAW, indexes for DRAW_INDEXED
+};
+
+struct RenderCommandDrawInstanced
+{
+	RenderCommandDraw	m_draw; // m_count is per instance
+	uint32_t			m_numInstances = 0;
+};
+
+// Shader and texture binds store the resource id, the modes store the enum value
+struct RenderCommandState
+{
+	uint32_t	m_value = 0;
+	int32_t		m_slot = 0;
+};
+
+struct RenderCommandConstants
+{
+	int32_t		m_slot = 0;
+	uint32_t	m_numBytes = 0;
+	uint32_t	m_numRecordedBytes = 0;
+};
+
+struct RenderCommandRenderTargets
+{
+	static constexpr int MAX_RTVS = 8;
+	uint32_t	m_numRtvs = 0;
+	uint32_t	m_rtvFormats[MAX_RTVS] = {};
+	uint32_t	m_dsvFormat = 0;
+	uint32_t	m_msaaCount = 1;
+	uint32_t	m_msaaQuality = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct RenderCounters
+{
+	uint64_t	m_numCommands = 0;
+	uint64_t	m_numDrawCalls = 0;
+	uint64_t	m_numVertexes = 0;
+	uint64_t	m_numIndexes = 0;		// instanced draws count every instance
+	uint64_t	m_numInstances = 0;
+	uint64_t	m_numStateChanges = 0;
+	uint64_t	m_numRedundantStateChanges = 0; // set to what was already bound, not recorded
+	uint64_t	m_numConstantUpdates = 0;
+	uint64_t	m_numBytesCopied = 0;
+	uint64_t	m_numCameras = 0;
+
+	void Reset();
+	void Accumulate(RenderCounters const& other);
+	std::string ToString() const;
+};
+
+//-----------------------------------------------------------------------------------------------
+class RenderCommandStream
+{
+public:
+	void Clear();
+	void Reserve(size_t numBytes);
+
+	void Write(RenderCommandType type, void const* payload = nullptr, uint32_t payloadSize = 0);
+	// payload followed by extra bytes, used for uploaded data
+	void Write(RenderCommandType type, void const* payload, uint32_t payloadSize, void const* extra, uint32_t extraSize);
+
+	// Walks the stream, inout_offset starts at 0. Returns false at the end or on a truncated command
+	bool ReadCommand(size_t& inout_offset, RenderCommandType& out_type, uint8_t const*& out_payload, uint32_t& out_payloadSize) const;
+
+	// Replays the stream into counters, redundant state changes are never recorded so they stay 0
+	RenderCounters ComputeCounters() const;
+	// One line per command, maxCommands < 0 dumps everything
+	void GetDumpLines(Strings& out_lines, int maxCommands = -1) const;
+
+	bool SaveToFile(std::string const& filePath) const;
+	bool LoadFromFile(std::string const& filePath);
+
+	size_t GetSizeBytes() const { return m_bytes.size(); }
+	int GetNumCommands() const { return m_numCommands; }
+	std::vector<uint8_t> const& GetBytes() const { return m_bytes; }
+
+private:
+	std::vector<uint8_t>	m_bytes;
+	int						m_numCommands = 0;
+};
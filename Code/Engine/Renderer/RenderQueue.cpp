@@ -0,0 +1,327 @@
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	constexpr int NUM_STATE_FIELDS = 6; // shader, texture, blend, depth, rasterizer, sampler
+
+	constexpr uint64_t PASS_MASK		= 0xF;
+	constexpr uint64_t MODE_MASK		= 0x3;
+	constexpr uint64_t SHADER_MASK		= 0xFFF;
+	constexpr uint64_t TEXTURE_MASK		= 0xFFFF;
+	constexpr uint64_t SAMPLER_MASK		= 0x7;
+	constexpr uint64_t DEPTH_MASK		= 0x7FFFFF;
+
+	// The bits of a positive float sort like the float itself, keep the top 23 below the sign
+	uint64_t GetDepthBits(float viewDepth)
+	{
+		if (!(viewDepth > 0.f))
+		{
+			return 0;
+		}
+		uint32_t floatBits = 0;
+		memcpy(&floatBits, &viewDepth, sizeof(float));
+		return (floatBits >> 8) & DEPTH_MASK;
+	}
+
+	int CountStateChanges(RenderState const& a, RenderState const& b)
+	{
+		return (a.m_shader != b.m_shader) + (a.m_texture != b.m_texture) + (a.m_blendMode != b.m_blendMode)
+			+ (a.m_depthMode != b.m_depthMode) + (a.m_rasterizerMode != b.m_rasterizerMode) + (a.m_samplerMode != b.m_samplerMode);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+bool RenderState::operator==(RenderState const& compare) const
+{
+	return CountStateChanges(*this, compare) == 0;
+}
+
+int BindRenderState(Renderer* renderer, RenderState const& state, RenderState const* previousState /*= nullptr*/)
+{
+	int numChanges = 0;
+	if (!previousState || previousState->m_shader != state.m_shader)
+	{
+		renderer->BindShader(state.m_shader);
+		++numChanges;
+	}
+	if (!previousState || previousState->m_blendMode != state.m_blendMode)
+	{
+		renderer->SetBlendMode(state.m_blendMode);
+		++numChanges;
+	}
+	if (!previousState || previousState->m_depthMode != state.m_depthMode)
+	{
+		renderer->SetDepthMode(state.m_depthMode);
+		++numChanges;
+	}
+	if (!previousState || previousState->m_rasterizerMode != state.m_rasterizerMode)
+	{
+		renderer->SetRasterizerMode(state.m_rasterizerMode);
+		++numChanges;
+	}
+
+	// DX12 passes texture and sampler as bindless indexes with each draw, only count them there
+	if (!previousState || previousState->m_texture != state.m_texture)
+	{
+#if defined(ENGINE_RENDER_D3D11) || defined(ENGINE_RENDER_NULL)
+		renderer->BindTexture(state.m_texture);
+#endif // ENGINE_RENDER_D3D11 || ENGINE_RENDER_NULL
+		++numChanges;
+	}
+	if (!previousState || previousState->m_samplerMode != state.m_samplerMode)
+	{
+#if defined(ENGINE_RENDER_D3D11) || defined(ENGINE_RENDER_NULL)
+		renderer->SetSamplerMode(state.m_samplerMode);
+#endif // ENGINE_RENDER_D3D11 || ENGINE_RENDER_NULL
+		++numChanges;
+	}
+	return numChanges;
+}
+
+#ifdef ENGINE_RENDER_D3D12
+void SetUnlitBindlessResources(Renderer* renderer, RenderState const& state)
+{
+	UnlitRenderResources resources;
+	resources.diffuseTextureIndex = renderer->GetSrvIndexFromLoadedTexture(state.m_texture);
+	resources.diffuseSamplerIndex = renderer->GetDefaultSamplerIndex(state.m_samplerMode);
+	resources.cameraConstantsIndex = renderer->GetCurrentCameraConstantsIndex();
+	resources.modelConstantsIndex = renderer->GetCurrentModelConstantsIndex();
+	renderer->SetGraphicsBindlessResources(sizeof(UnlitRenderResources), &resources);
+}
+#endif // ENGINE_RENDER_D3D12
+
+//-----------------------------------------------------------------------------------------------
+void RenderQueueStats::Reset()
+{
+	*this = RenderQueueStats();
+}
+
+void RenderQueueStats::Accumulate(RenderQueueStats const& other)
+{
+	m_numItems += other.m_numItems;
+	m_numDrawCalls += other.m_numDrawCalls;
+	m_numStateChanges += other.m_numStateChanges;
+	m_numSubmitOrderStateChanges += other.m_numSubmitOrderStateChanges;
+	m_numStateSetsSaved += other.m_numStateSetsSaved;
+	m_numModelConstantsSkipped += other.m_numModelConstantsSkipped;
+}
+
+std::string RenderQueueStats::ToString() const
+{
+	return Stringf("items=%d draws=%d stateChanges=%d (submit order %d) stateSetsSaved=%d modelConstantsSkipped=%d",
+		m_numItems, m_numDrawCalls, m_numStateChanges, m_numSubmitOrderStateChanges, m_numStateSetsSaved, m_numModelConstantsSkipped);
+}
+
+//-----------------------------------------------------------------------------------------------
+void RadixSortRenderItems(std::vector<RenderSortItem>& items, std::vector<RenderSortItem>& scratch)
+{
+	size_t const numItems = items.size();
+	if (numItems < 2)
+	{
+		return;
+	}
+	scratch.resize(numItems);
+
+	// All eight histograms in one read of the keys
+	uint32_t histograms[8][256] = {};
+	for (size_t itemIndex = 0; itemIndex < numItems; ++itemIndex)
+	{
+		uint64_t key = items[itemIndex].m_key;
+		for (int byteIndex = 0; byteIndex < 8; ++byteIndex)
+		{
+			++histograms[byteIndex][(key >> (byteIndex * 8)) & 0xFF];
+		}
+	}
+
+	RenderSortItem* source = items.data();
+	RenderSortItem* destination = scratch.data();
+	for (int byteIndex = 0; byteIndex < 8; ++byteIndex)
+	{
+		uint32_t* histogram = histograms[byteIndex];
+		int shift = byteIndex * 8;
+		if (histogram[(source[0].m_key >> shift) & 0xFF] == numItems)
+		{
+			continue; // every key has this byte, the pass would not move anything
+		}
+
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < 256; ++bucket)
+		{
+			uint32_t count = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += count;
+		}
+
+		for (size_t itemIndex = 0; itemIndex < numItems; ++itemIndex)
+		{
+			RenderSortItem const& item = source[itemIndex];
+			destination[histogram[(item.m_key >> shift) & 0xFF]++] = item;
+		}
+		std::swap(source, destination);
+	}
+
+	if (source != items.data())
+	{
+		items.swap(scratch);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+RenderQueue::RenderQueue(Renderer* renderer)
+	: m_renderer(renderer)
+{
+}
+
+void RenderQueue::BeginFrame()
+{
+	m_lastFrameStats = m_frameStats;
+	m_frameStats.Reset();
+}
+
+void RenderQueue::Submit(int pass, RenderState const& state, int numVertexes, Vertex_PCU const* vertexes, Mat44 const& modelToWorldTransform /*= Mat44()*/, Rgba8 const& modelColor /*= Rgba8::OPAQUE_WHITE*/, float viewDepth /*= 0.f*/)
+{
+	GUARANTEE_OR_DIE(pass >= 0 && pass < MAX_PASSES, "RenderQueue pass out of range.");
+	if (numVertexes <= 0)
+	{
+		return;
+	}
+
+	QueuedItem item;
+	item.m_state = state;
+	item.m_modelToWorldTransform = modelToWorldTransform;
+	item.m_modelColor = modelColor;
+	item.m_firstVertex = static_cast<int>(m_vertexes.size());
+	item.m_numVertexes = numVertexes;
+	m_vertexes.insert(m_vertexes.end(), vertexes, vertexes + numVertexes);
+
+	RenderSortItem sortItem;
+	sortItem.m_key = MakeSortKey(pass, state, viewDepth);
+	sortItem.m_index = static_cast<uint32_t>(m_items.size());
+	m_sortItems.push_back(sortItem);
+	m_items.push_back(item);
+}
+
+void RenderQueue::Submit(int pass, RenderState const& state, std::vector<Vertex_PCU> const& verts, Mat44 const& modelToWorldTransform /*= Mat44()*/, Rgba8 const& modelColor /*= Rgba8::OPAQUE_WHITE*/, float viewDepth /*= 0.f*/)
+{
+	Submit(pass, state, static_cast<int>(verts.size()), verts.data(), modelToWorldTransform, modelColor, viewDepth);
+}
+
+//-----------------------------------------------------------------------------------------------
+void RenderQueue::Flush()
+{
+	PROFILE_SCOPE("RenderQueue::Flush");
+
+	RenderQueueStats stats;
+	stats.m_numItems = static_cast<int>(m_items.size());
+	if (m_items.empty())
+	{
+		m_lastFlushStats = stats;
+		return;
+	}
+
+	// What the same draws would have cost unsorted, for the stats only
+	stats.m_numSubmitOrderStateChanges = NUM_STATE_FIELDS;
+	for (int itemIndex = 1; itemIndex < static_cast<int>(m_items.size()); ++itemIndex)
+	{
+		stats.m_numSubmitOrderStateChanges += CountStateChanges(m_items[itemIndex - 1].m_state, m_items[itemIndex].m_state);
+	}
+
+	RadixSortRenderItems(m_sortItems, m_sortScratch);
+
+	m_renderer->SetRenderTargetFormats();
+
+	QueuedItem const* previousItem = nullptr;
+	for (int sortIndex = 0; sortIndex < static_cast<int>(m_sortItems.size()); ++sortIndex)
+	{
+		QueuedItem const& item = m_items[m_sortItems[sortIndex].m_index];
+
+		stats.m_numStateChanges += BindRenderState(m_renderer, item.m_state, previousItem ? &previousItem->m_state : nullptr);
+
+		if (previousItem && previousItem->m_modelColor == item.m_modelColor
+			&& memcmp(previousItem->m_modelToWorldTransform.m_values, item.m_modelToWorldTransform.m_values, sizeof(item.m_modelToWorldTransform.m_values)) == 0)
+		{
+			++stats.m_numModelConstantsSkipped;
+		}
+		else
+		{
+			m_renderer->SetModelConstants(item.m_modelToWorldTransform, item.m_modelColor);
+		}
+
+#ifdef ENGINE_RENDER_D3D12
+		SetUnlitBindlessResources(m_renderer, item.m_state);
+#endif // ENGINE_RENDER_D3D12
+
+		m_renderer->DrawVertexArray(item.m_numVertexes, m_vertexes.data() + item.m_firstVertex);
+		++stats.m_numDrawCalls;
+		previousItem = &item;
+	}
+
+	stats.m_numStateSetsSaved = stats.m_numItems * NUM_STATE_FIELDS - stats.m_numStateChanges;
+	m_lastFlushStats = stats;
+	m_frameStats.Accumulate(stats);
+	Clear();
+}
+
+void RenderQueue::Clear()
+{
+	m_items.clear();
+	m_vertexes.clear();
+	m_sortItems.clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+uint64_t RenderQueue::MakeSortKey(int pass, RenderState const& state, float viewDepth)
+{
+	uint64_t passBits = static_cast<uint64_t>(pass) & PASS_MASK;
+	uint64_t blendBits = static_cast<uint64_t>(state.m_blendMode) & MODE_MASK;
+	uint64_t depthModeBits = static_cast<uint64_t>(state.m_depthMode) & MODE_MASK;
+	uint64_t rasterizerBits = static_cast<uint64_t>(state.m_rasterizerMode) & MODE_MASK;
+	uint64_t shaderBits = GetResourceId(state.m_shader, m_lastShader, m_lastShaderId) & SHADER_MASK;
+	uint64_t textureBits = GetResourceId(state.m_texture, m_lastTexture, m_lastTextureId) & TEXTURE_MASK;
+	uint64_t samplerBits = static_cast<uint64_t>(state.m_samplerMode) & SAMPLER_MASK;
+	uint64_t depthBits = GetDepthBits(viewDepth);
+
+	if (state.m_blendMode == BlendMode::OPAQUE)
+	{
+		return (passBits << 60) | (blendBits << 58) | (depthModeBits << 56) | (rasterizerBits << 54)
+			| (shaderBits << 42) | (textureBits << 26) | (samplerBits << 23) | depthBits;
+	}
+
+	uint64_t backToFrontBits = DEPTH_MASK - depthBits;
+	return (passBits << 60) | (blendBits << 58) | (backToFrontBits << 35) | (depthModeBits << 33) | (rasterizerBits << 31)
+		| (shaderBits << 19) | (textureBits << 3) | samplerBits;
+}
+
+uint32_t RenderQueue::GetResourceId(void const* resource, void const*& lastResource, uint32_t& lastId)
+{
+	if (resource == nullptr)
+	{
+		return 0;
+	}
+	if (resource == lastResource)
+	{
+		return lastId; // runs of the same shader or texture skip the map
+	}
+
+	auto found = m_resourceIds.find(resource);
+	uint32_t id = 0;
+	if (found == m_resourceIds.end())
+	{
+		id = static_cast<uint32_t>(m_resourceIds.size()) + 1;
+		m_resourceIds[resource] = id;
+	}
+	else
+	{
+		id = found->second;
+	}
+
+	lastResource = resource;
+	lastId = id;
+	return id;
+}
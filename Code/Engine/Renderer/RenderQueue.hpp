@@ -0,0 +1,133 @@
+#pragma once
+#include "Engine/Renderer/RendererCommon.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Renderer;
+
+//-----------------------------------------------------------------------------------------------
+// Deferred draw submission on top of Renderer.
+//
+// Submit() copies the vertexes and the render state of a draw into the queue and builds a 64 bit
+// sort key for it. Flush() radix sorts the keys, then issues the draws through the Renderer,
+// skipping every state setter whose value is already bound. Call Flush() between BeginCamera and
+// EndCamera, it empties the queue.
+//
+// Key layout, high bits first:
+//   opaque:       pass(4) blend(2) depth mode(2) rasterizer(2) shader(12) texture(16) sampler(3) depth(23)
+//   transparent:  pass(4) blend(2) inverted depth(23) depth mode(2) rasterizer(2) shader(12) texture(16) sampler(3)
+// Opaque draws group by state and go front to back inside a group, alpha and additive draws go
+// back to front so blending stays correct. The sort is stable, equal keys keep submission order.
+//
+struct RenderState
+{
+	Shader*			m_shader = nullptr;		// nullptr is the default shader
+	Texture const*	m_texture = nullptr;	// nullptr is the default white texture
+	BlendMode		m_blendMode = BlendMode::OPAQUE;
+	DepthMode		m_depthMode = DepthMode::READ_WRITE_LESS_EQUAL;
+	RasterizerMode	m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
+	SamplerMode		m_samplerMode = SamplerMode::POINT_CLAMP;
+
+	bool operator==(RenderState const& compare) const;
+	bool operator!=(RenderState const& compare) const { return !(*this == compare); }
+};
+
+// Calls the Renderer setters for every field of state that differs from previousState, or for all
+// of them when previousState is nullptr. Returns the number of setters called. On DX12 texture and
+// sampler are bindless, the caller passes them with the draw
+int BindRenderState(Renderer* renderer, RenderState const& state, RenderState const* previousState = nullptr);
+
+#ifdef ENGINE_RENDER_D3D12
+// Hands the texture and sampler of state, with the current camera and model constants, to the next
+// draw through UnlitRenderResources. Call it after SetModelConstants, before every draw
+void SetUnlitBindlessResources(Renderer* renderer, RenderState const& state);
+#endif // ENGINE_RENDER_D3D12
+
+//-----------------------------------------------------------------------------------------------
+struct RenderQueueStats
+{
+	int m_numItems = 0;
+	int m_numDrawCalls = 0;
+	int m_numStateChanges = 0;				// issued by Flush after sorting
+	int m_numSubmitOrderStateChanges = 0;	// the same draws in submission order, redundant sets skipped
+	int m_numStateSetsSaved = 0;			// against setting every state for every draw, like immediate callers do
+	int m_numModelConstantsSkipped = 0;		// same transform and color as the previous draw
+
+	void Reset();
+	void Accumulate(RenderQueueStats const& other);
+	std::string ToString() const;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct RenderSortItem
+{
+	uint64_t m_key = 0;
+	uint32_t m_index = 0;
+};
+
+// Stable LSD radix sort by m_key, 8 bits per pass. Passes where every key has the same byte are
+// skipped, so keys that only differ in a few fields sort in a few passes. scratch is reused
+void RadixSortRenderItems(std::vector<RenderSortItem>& items, std::vector<RenderSortItem>& scratch);
+
+//-----------------------------------------------------------------------------------------------
+class RenderQueue
+{
+public:
+	static constexpr int MAX_PASSES = 16;
+
+	explicit RenderQueue(Renderer* renderer);
+
+	// Starts new frame stats, the previous frame's are kept in GetLastFrameStats
+	void BeginFrame();
+
+	// viewDepth is the distance along the camera forward, only its order matters
+	void Submit(int pass, RenderState const& state, int numVertexes, Vertex_PCU const* vertexes,
+		Mat44 const& modelToWorldTransform = Mat44(), Rgba8 const& modelColor = Rgba8::OPAQUE_WHITE, float viewDepth = 0.f);
+	void Submit(int pass, RenderState const& state, std::vector<Vertex_PCU> const& verts,
+		Mat44 const& modelToWorldTransform = Mat44(), Rgba8 const& modelColor = Rgba8::OPAQUE_WHITE, float viewDepth = 0.f);
+
+	void Flush();
+	void Clear();
+
+	int GetNumQueuedItems() const { return static_cast<int>(m_items.size()); }
+	RenderQueueStats const& GetLastFlushStats() const { return m_lastFlushStats; }
+	RenderQueueStats const& GetFrameStats() const { return m_frameStats; }
+	RenderQueueStats const& GetLastFrameStats() const { return m_lastFrameStats; }
+
+	uint64_t MakeSortKey(int pass, RenderState const& state, float viewDepth);
+
+protected:
+	struct QueuedItem
+	{
+		RenderState	m_state;
+		Mat44		m_modelToWorldTransform;
+		Rgba8		m_modelColor;
+		int			m_firstVertex = 0;
+		int			m_numVertexes = 0;
+	};
+
+	uint32_t GetResourceId(void const* resource, void const*& lastResource, uint32_t& lastId);
+
+protected:
+	Renderer* m_renderer = nullptr;
+
+	std::vector<QueuedItem>			m_items;
+	std::vector<Vertex_PCU>			m_vertexes;
+	std::vector<RenderSortItem>		m_sortItems;
+	std::vector<RenderSortItem>		m_sortScratch;
+
+	// Small ids for shaders and textures, stable for the life of the queue. They only steer the
+	// grouping, Flush compares the real pointers, so ids that wrap in the key are harmless
+	std::unordered_map<void const*, uint32_t> m_resourceIds;
+	void const*	m_lastShader = nullptr;
+	uint32_t	m_lastShaderId = 0;
+	void const*	m_lastTexture = nullptr;
+	uint32_t	m_lastTextureId = 0;
+
+	RenderQueueStats m_lastFlushStats;
+	RenderQueueStats m_frameStats;
+	RenderQueueStats m_lastFrameStats;
+};
@@ -1,5 +1,21 @@
 #include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
 
 Renderer* Renderer::s_mainRenderer = nullptr;
 
 const std::string WINDOW_RESIZE_EVENT = "WindowResized";
+
+//-----------------------------------------------------------------------------------------------
+void Renderer::CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, VertexBuffer* vbo)
+{
+	UNUSED(dirtyOffset);
+	UNUSED(dirtySize);
+	CopyCPUToGPU(bufferData, bufferSize, vbo);
+}
+
+void Renderer::CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, IndexBuffer* ibo)
+{
+	UNUSED(dirtyOffset);
+	UNUSED(dirtySize);
+	CopyCPUToGPU(bufferData, bufferSize, ibo);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Engine/Renderer/RendererCommon.hpp"
+#include "Engine/Renderer/SDFFontAtlas.hpp"
 #include <vector>
 #include <string>
 
@@ -27,6 +28,11 @@ public:
 	virtual void CopyCPUToGPU(const void* data, unsigned int size, VertexBuffer* vbo) = 0;
 	virtual void CopyCPUToGPU(const void* data, unsigned int size, IndexBuffer* ibo) = 0;
 	virtual void CopyCPUToGPU(const void* data, unsigned int size, ConstantBuffer* cbo) = 0;
+	// bufferData is the CPU copy of the whole buffer, only [dirtyOffset, dirtyOffset + dirtySize) changed.
+	// By default everything is uploaded, as DX11 dynamic buffers are discarded on every write;
+	// backends that can write part of a buffer override these
+	virtual void CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, VertexBuffer* vbo);
+	virtual void CopyCPUToGPURange(const void* bufferData, unsigned int bufferSize, unsigned int dirtyOffset, unsigned int dirtySize, IndexBuffer* ibo);
 
     // Draw Calls
 	virtual void DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes) = 0;
@@ -38,6 +44,12 @@ public:
 	virtual void DrawVertexBuffer(VertexBuffer* vbo, unsigned int vertexCount) = 0;
 	virtual void DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount) = 0;
 
+	// Instancing: upload the instance data once, then draw the mesh numInstances times. The bound
+	// shader reads it as VERTEX_PCU_INSTANCED (DX11) or StructuredBuffer<InstanceData> (DX12)
+	virtual void SetInstanceData(int numInstances, InstanceData const* instances) = 0;
+	virtual void DrawVertexBufferInstanced(VertexBuffer* vbo, unsigned int vertexCount, int numInstances) = 0;
+	virtual void DrawIndexedVertexBufferInstanced(VertexBuffer* vbo, IndexBuffer* ibo, unsigned int indexCount, int numInstances) = 0;
+
 
 #ifdef ENGINE_RENDER_D3D12
 	virtual void DrawProcedural(unsigned int vertexCount) = 0;
@@ -88,6 +100,7 @@ public:
 	virtual uint32_t GetCurrentLightConstantsIndex() const = 0;
 	virtual uint32_t GetCurrentCameraConstantsIndex() const = 0;
 	virtual uint32_t GetCurrentModelConstantsIndex() const = 0;
+	virtual uint32_t GetCurrentInstanceDataIndex() const = 0;
 #endif // ENGINE_RENDER_D3D12
 
 public:
@@ -95,6 +108,8 @@ public:
     // Manage Resources - Public
     //-----------------------------------------------------------------------------------------------
     virtual Texture* CreateOrGetTextureFromFile(char const* imageFilePath) = 0;
+    virtual Texture* CreateOrGetTextureFromImage(Image const& image) = 0; // keyed by the image file path, for generated images like atlas pages
+    virtual Texture* CreateOrGetTextureFromCooked(CookedTexture const& cooked) = 0; // every mip in the cooked format, keyed by the cooked name
     virtual Texture* CreateOrGetTextureCubeFromSixFaces(TextureCubeSixFacesConfig const& config) = 0;
 
 #ifdef ENGINE_RENDER_D3D12
@@ -103,6 +118,8 @@ public:
 #endif // ENGINE_RENDER_D3D12
 
     virtual BitmapFont* CreateOrGetBitmapFont(char const* bitmapFontFilePathWithNoExtension) = 0;
+	// Same png as CreateOrGetBitmapFont, turned into a signed distance field atlas at load
+	virtual BitmapFont* CreateOrGetSDFFont(char const* bitmapFontFilePathWithNoExtension, SDFFontConfig const& config = SDFFontConfig()) = 0;
 
     // Only Support VS+PS
     virtual Shader* CreateOrGetShader(char const* shaderName, VertexType type = VertexType::VERTEX_PCU) = 0;
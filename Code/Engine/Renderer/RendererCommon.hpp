@@ -1,5 +1,7 @@
 #pragma once
+#if !defined(ENGINE_HEADLESS)
 #include "Game/EngineBuildPreferences.hpp"
+#endif
 
 #include "Engine/Math/Mat44.hpp"
 #include "Engine/Math/Vec3.hpp"
@@ -8,9 +10,13 @@
 
 #include <string>
 #include <vector>
+#if defined(_WIN32)
 #include <dxgiformat.h>
+#else
+#include "Engine/Renderer/DXGIFormat.hpp"
+#endif
 
-#if defined(ENGINE_RENDER_D3D11) && defined(ENGINE_RENDER_D3D12)
+#if (defined(ENGINE_RENDER_D3D11) + defined(ENGINE_RENDER_D3D12) + defined(ENGINE_RENDER_NULL)) > 1
 #error "Using Multiple RHI"
 #endif
 
@@ -33,6 +39,7 @@ struct Rgba8;
 struct Vertex_PCU;
 struct Vertex_PCUTBN;
 struct ShaderConfig;
+struct CookedTexture;
 
 
 constexpr uint32_t INVALID_INDEX_U32 = static_cast<uint32_t>(-1);
@@ -91,6 +98,7 @@ enum class VertexType
 	VERTEX_NONE,
 	VERTEX_PCU,
 	VERTEX_PCUTBN,
+	VERTEX_PCU_INSTANCED,	// PCU in slot 0, InstanceData per instance in slot 1. DX12 reads instances from a buffer, same layout as PCU
 	COUNT
 };
 
@@ -143,6 +151,13 @@ struct ModelConstants
 };
 constexpr int k_modelConstantsSlot = 3;
 
+// ModelConstants of one instance in an instanced draw
+struct InstanceData
+{
+	Mat44 ModelToWorldTransform;
+	float ModelColor[4];
+};
+
 //-----------------------------------------------------------------------------------------------
 struct Light
 {
@@ -234,13 +249,21 @@ struct TextureCubeSixFacesConfig
 	std::string m_backwardImageFilePath;
 };
 
+//-----------------------------------------------------------------------------------------------
+// Shader for BitmapFont::IsSDF() fonts. DX11 compiles it from g_sdfTextShaderSource at startup,
+// DX12 loads it from file like Unlit and takes UnlitRenderResources
+#ifdef ENGINE_RENDER_D3D12
+constexpr char const* SDF_TEXT_SHADER_NAME = "Data/Shaders/SDFText";
+#else
+constexpr char const* SDF_TEXT_SHADER_NAME = "SDFText";
+#endif // ENGINE_RENDER_D3D12
+
 //-----------------------------------------------------------------------------------------------
 // DX12 Renderer Settings
 //-----------------------------------------------------------------------------------------------
 constexpr unsigned int SWAP_CHAIN_BUFFER_COUNT = 2;
 constexpr unsigned int FRAMES_IN_FLIGHT = 3;
-constexpr size_t MAX_LINEAR_ALLOCATOR_SIZE = 64 * 1024 * 1024; // 64MB
-constexpr size_t MAX_MAIN_LINEAR_ALLOCATOR_SIZE = 64 * 1024 * 1024; // 64MB
+constexpr size_t LINEAR_ALLOCATOR_PAGE_SIZE = 4 * 1024 * 1024; // 4MB, frames that need more take more pages
 constexpr unsigned int IMGUI_SRV_HEAP_SIZE = 64;
 
 
@@ -434,6 +457,15 @@ struct UnlitRenderResources
 	uint32_t modelConstantsIndex = INVALID_INDEX_U32;
 };
 
+struct InstancedUnlitRenderResources
+{
+	uint32_t diffuseTextureIndex = INVALID_INDEX_U32;
+	uint32_t diffuseSamplerIndex = INVALID_INDEX_U32;
+
+	uint32_t cameraConstantsIndex = INVALID_INDEX_U32;
+	uint32_t instanceDataIndex = INVALID_INDEX_U32; // StructuredBuffer<InstanceData>, index with SV_InstanceID
+};
+
 struct DiffuseRenderResources
 {
 	uint32_t diffuseTextureIndex = INVALID_INDEX_U32;
@@ -0,0 +1,247 @@
+#include "Engine/Renderer/SDFFontAtlas.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cmath>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Distance field texels per atlas texel, in each direction
+	constexpr int SDF_SUPERSAMPLE = 4;
+	constexpr float SDF_FAR = 1e20f;
+
+	bool IsInkTexel(Rgba8 const& texel)
+	{
+		unsigned char brightness = texel.r;
+		brightness = (texel.g > brightness) ? texel.g : brightness;
+		brightness = (texel.b > brightness) ? texel.b : brightness;
+		return texel.a >= 128 && brightness >= 128;
+	}
+
+	// Felzenszwalb and Huttenlocher's exact squared distance transform of one row or column, in
+	// place. scratch holds the lower envelope of the parabolas rooted at every sample
+	void DistanceTransform1D(float* values, int count, int stride, std::vector<float>& scratchValues, std::vector<int>& scratchRoots, std::vector<float>& scratchBounds)
+	{
+		scratchValues.resize(count);
+		scratchRoots.resize(count);
+		scratchBounds.resize(count + 1);
+		for (int i = 0; i < count; ++i)
+		{
+			scratchValues[i] = values[i * stride];
+		}
+
+		auto getIntersection = [&](int q, int root)
+			{
+				return ((scratchValues[q] + static_cast<float>(q * q)) - (scratchValues[root] + static_cast<float>(root * root))) / static_cast<float>(2 * q - 2 * root);
+			};
+
+		int numParabolas = 0;
+		scratchRoots[0] = 0;
+		scratchBounds[0] = -SDF_FAR;
+		scratchBounds[1] = SDF_FAR;
+		for (int q = 1; q < count; ++q)
+		{
+			// scratchBounds[0] is far enough left that the first parabola is never dropped
+			float intersection = getIntersection(q, scratchRoots[numParabolas]);
+			while (intersection <= scratchBounds[numParabolas])
+			{
+				--numParabolas;
+				intersection = getIntersection(q, scratchRoots[numParabolas]);
+			}
+			++numParabolas;
+			scratchRoots[numParabolas] = q;
+			scratchBounds[numParabolas] = intersection;
+			scratchBounds[numParabolas + 1] = SDF_FAR;
+		}
+
+		int parabola = 0;
+		for (int q = 0; q < count; ++q)
+		{
+			while (scratchBounds[parabola + 1] < static_cast<float>(q))
+			{
+				++parabola;
+			}
+			int root = scratchRoots[parabola];
+			float offset = static_cast<float>(q - root);
+			values[q * stride] = offset * offset + scratchValues[root];
+		}
+	}
+
+	struct SDFGlyphScratch
+	{
+		std::vector<unsigned char>	m_isInside;
+		std::vector<float>			m_distanceToInside;
+		std::vector<float>			m_distanceToOutside;
+		std::vector<float>			m_lineValues;
+		std::vector<int>			m_lineRoots;
+		std::vector<float>			m_lineBounds;
+	};
+
+	void DistanceTransform2D(std::vector<float>& squaredDistances, int size, SDFGlyphScratch& scratch)
+	{
+		for (int y = 0; y < size; ++y)
+		{
+			DistanceTransform1D(&squaredDistances[y * size], size, 1, scratch.m_lineValues, scratch.m_lineRoots, scratch.m_lineBounds);
+		}
+		for (int x = 0; x < size; ++x)
+		{
+			DistanceTransform1D(&squaredDistances[x], size, size, scratch.m_lineValues, scratch.m_lineRoots, scratch.m_lineBounds);
+		}
+	}
+
+	void GenerateGlyph(int glyphIndex, Image const& glyphSheet, SDFFontConfig const& config, IntVec2 const& sourceCellSize, SDFFontAtlas& inout_atlas, SDFGlyphScratch& scratch)
+	{
+		IntVec2 const& gridLayout = config.m_glyphGridLayout;
+		int const column = glyphIndex % gridLayout.x;
+		int const row = glyphIndex / gridLayout.x;
+
+		// Grid row 0 is at the top, Image rows start at the bottom
+		IntVec2 const sourceCellMins(column * sourceCellSize.x, (gridLayout.y - 1 - row) * sourceCellSize.y);
+		int const atlasCellSize = config.m_atlasGlyphSize;
+		IntVec2 const atlasCellMins(column * atlasCellSize, (gridLayout.y - 1 - row) * atlasCellSize);
+
+		// Ink columns give the metrics
+		int inkMinX = sourceCellSize.x;
+		int inkMaxX = -1;
+		for (int y = 0; y < sourceCellSize.y; ++y)
+		{
+			for (int x = 0; x < sourceCellSize.x; ++x)
+			{
+				if (IsInkTexel(glyphSheet.GetTexelColor(sourceCellMins + IntVec2(x, y))))
+				{
+					inkMinX = (x < inkMinX) ? x : inkMinX;
+					inkMaxX = (x > inkMaxX) ? x : inkMaxX;
+				}
+			}
+		}
+		bool const hasInk = inkMaxX >= 0;
+
+		int const padding = config.m_spreadTexels;
+		int const contentSize = atlasCellSize - 2 * padding;
+		float const paddingInCells = static_cast<float>(padding) / static_cast<float>(contentSize);
+
+		SDFGlyphMetrics& metrics = inout_atlas.m_glyphs[glyphIndex];
+		float penOffsetX = 0.f;
+		metrics.m_advance = 1.f;
+		if (!hasInk)
+		{
+			metrics.m_advance = config.m_isMonospace ? 1.f : config.m_emptyGlyphAdvance;
+		}
+		else if (!config.m_isMonospace)
+		{
+			// Half a source texel of bearing on either side of the ink
+			float const sourceTexelWidth = 1.f / static_cast<float>(sourceCellSize.x);
+			penOffsetX = (0.5f - static_cast<float>(inkMinX)) * sourceTexelWidth;
+			metrics.m_advance = static_cast<float>(inkMaxX - inkMinX + 2) * sourceTexelWidth;
+		}
+		metrics.m_quadBounds = AABB2(penOffsetX - paddingInCells, -paddingInCells, penOffsetX + 1.f + paddingInCells, 1.f + paddingInCells);
+
+		Vec2 const atlasDimensions(static_cast<float>(inout_atlas.m_image.GetDimensions().x), static_cast<float>(inout_atlas.m_image.GetDimensions().y));
+		metrics.m_uvs = AABB2(static_cast<float>(atlasCellMins.x) / atlasDimensions.x, static_cast<float>(atlasCellMins.y) / atlasDimensions.y,
+			static_cast<float>(atlasCellMins.x + atlasCellSize) / atlasDimensions.x, static_cast<float>(atlasCellMins.y + atlasCellSize) / atlasDimensions.y);
+
+		if (!hasInk)
+		{
+			return; // the atlas starts out fully outside
+		}
+
+		// Supersampled inside mask of the whole padded cell, source texels are repeated
+		int const fieldSize = atlasCellSize * SDF_SUPERSAMPLE;
+		int const numFieldTexels = fieldSize * fieldSize;
+		scratch.m_isInside.assign(numFieldTexels, 0);
+		scratch.m_distanceToInside.assign(numFieldTexels, SDF_FAR);
+		scratch.m_distanceToOutside.assign(numFieldTexels, SDF_FAR);
+		for (int fieldY = 0; fieldY < fieldSize; ++fieldY)
+		{
+			float contentV = ((static_cast<float>(fieldY) + 0.5f) / SDF_SUPERSAMPLE - static_cast<float>(padding)) / static_cast<float>(contentSize);
+			int sourceY = static_cast<int>(floorf(contentV * static_cast<float>(sourceCellSize.y)));
+			for (int fieldX = 0; fieldX < fieldSize; ++fieldX)
+			{
+				float contentU = ((static_cast<float>(fieldX) + 0.5f) / SDF_SUPERSAMPLE - static_cast<float>(padding)) / static_cast<float>(contentSize);
+				int sourceX = static_cast<int>(floorf(contentU * static_cast<float>(sourceCellSize.x)));
+
+				bool isInside = sourceX >= 0 && sourceX < sourceCellSize.x && sourceY >= 0 && sourceY < sourceCellSize.y
+					&& IsInkTexel(glyphSheet.GetTexelColor(sourceCellMins + IntVec2(sourceX, sourceY)));
+				int fieldIndex = fieldY * fieldSize + fieldX;
+				scratch.m_isInside[fieldIndex] = isInside ? 1 : 0;
+				if (isInside)
+				{
+					scratch.m_distanceToInside[fieldIndex] = 0.f;
+				}
+				else
+				{
+					scratch.m_distanceToOutside[fieldIndex] = 0.f;
+				}
+			}
+		}
+		DistanceTransform2D(scratch.m_distanceToInside, fieldSize, scratch);
+		DistanceTransform2D(scratch.m_distanceToOutside, fieldSize, scratch);
+
+		// Every atlas texel takes the mean signed distance of its four central field texels
+		float const spreadInFieldTexels = static_cast<float>(config.m_spreadTexels * SDF_SUPERSAMPLE);
+		int const centerOffset = SDF_SUPERSAMPLE / 2;
+		for (int atlasY = 0; atlasY < atlasCellSize; ++atlasY)
+		{
+			for (int atlasX = 0; atlasX < atlasCellSize; ++atlasX)
+			{
+				float signedDistance = 0.f;
+				for (int sampleIndex = 0; sampleIndex < 4; ++sampleIndex)
+				{
+					int fieldX = atlasX * SDF_SUPERSAMPLE + centerOffset - 1 + (sampleIndex & 1);
+					int fieldY = atlasY * SDF_SUPERSAMPLE + centerOffset - 1 + (sampleIndex >> 1);
+					int fieldIndex = fieldY * fieldSize + fieldX;
+					// Edges lie half a field texel between inside and outside texels
+					signedDistance += scratch.m_isInside[fieldIndex] ? (sqrtf(scratch.m_distanceToOutside[fieldIndex]) - 0.5f) : (0.5f - sqrtf(scratch.m_distanceToInside[fieldIndex]));
+				}
+				signedDistance *= 0.25f;
+
+				float encoded = GetClamped(0.5f + 0.5f * signedDistance / spreadInFieldTexels, 0.f, 1.f);
+				unsigned char alpha = static_cast<unsigned char>(encoded * 255.f + 0.5f);
+				inout_atlas.m_image.SetTexelColor(atlasCellMins + IntVec2(atlasX, atlasY), Rgba8(255, 255, 255, alpha));
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+SDFFontAtlas GenerateSDFFontAtlas(Image const& glyphSheet, SDFFontConfig const& config /*= SDFFontConfig()*/, WorkerPool* workers /*= nullptr*/)
+{
+	IntVec2 const& gridLayout = config.m_glyphGridLayout;
+	IntVec2 const sheetDimensions = glyphSheet.GetDimensions();
+	GUARANTEE_OR_DIE(gridLayout.x > 0 && gridLayout.y > 0 && sheetDimensions.x >= gridLayout.x && sheetDimensions.y >= gridLayout.y,
+		Stringf("Cannot make an SDF font atlas from \"%s\", it is smaller than its glyph grid", glyphSheet.GetImageFilePath().c_str()));
+	GUARANTEE_OR_DIE(config.m_spreadTexels >= 1 && config.m_atlasGlyphSize > 2 * config.m_spreadTexels, "SDF font atlas cells must be larger than their padding");
+
+	SDFFontAtlas atlas;
+	atlas.m_glyphGridLayout = gridLayout;
+	IntVec2 const atlasDimensions(gridLayout.x * config.m_atlasGlyphSize, gridLayout.y * config.m_atlasGlyphSize);
+	std::string atlasName = glyphSheet.GetImageFilePath() + ".sdf";
+	atlas.m_image = Image(atlasDimensions, Rgba8(255, 255, 255, 0), atlasName.c_str());
+
+	int const numGlyphs = gridLayout.x * gridLayout.y;
+	atlas.m_glyphs.resize(numGlyphs);
+	IntVec2 const sourceCellSize(sheetDimensions.x / gridLayout.x, sheetDimensions.y / gridLayout.y);
+
+	// One task per grid row, every task has its own scratch buffers and writes its own cells
+	std::vector<SDFGlyphScratch> rowScratch(gridLayout.y);
+	auto generateRow = [&](int row)
+		{
+			for (int column = 0; column < gridLayout.x; ++column)
+			{
+				GenerateGlyph(row * gridLayout.x + column, glyphSheet, config, sourceCellSize, atlas, rowScratch[row]);
+			}
+		};
+	if (workers)
+	{
+		workers->ParallelFor(gridLayout.y, generateRow);
+	}
+	else
+	{
+		for (int row = 0; row < gridLayout.y; ++row)
+		{
+			generateRow(row);
+		}
+	}
+	return atlas;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <vector>
+
+class WorkerPool;
+
+//-----------------------------------------------------------------------------------------------
+// Signed distance field atlas made at load time from a grid bitmap font like SquirrelFixedFont.
+//
+// Every glyph keeps its grid cell in the atlas, so SpriteSheet UVs still find it, but the cell
+// holds the distance to the glyph edge instead of the glyph: 0.5 on the edge, more inside, with
+// m_spreadTexels of padding around it. Distances are measured on a supersampled copy of the
+// glyph bitmap, so one small atlas draws sharp glyphs at any cell height.
+//
+struct SDFFontConfig
+{
+	IntVec2	m_glyphGridLayout = IntVec2(16, 16);
+	int		m_atlasGlyphSize = 32;			// texels per atlas cell, padding included
+	int		m_spreadTexels = 4;				// encoded distance range and cell padding, in atlas texels
+	bool	m_isMonospace = false;			// false advances by the ink width of every glyph
+	float	m_emptyGlyphAdvance = 0.5f;		// advance of glyphs without ink like space, in cell widths
+};
+
+//-----------------------------------------------------------------------------------------------
+// x is in cell widths (cellHeight * cellAspectScale), y in cell heights
+struct SDFGlyphMetrics
+{
+	AABB2	m_uvs;				// whole atlas cell, padding included
+	AABB2	m_quadBounds;		// of m_uvs, relative to the pen position on the baseline
+	float	m_advance = 1.f;	// pen movement to the next glyph
+};
+
+struct SDFFontAtlas
+{
+	Image							m_image;	// distance in alpha, white rgb
+	std::vector<SDFGlyphMetrics>	m_glyphs;	// one per grid cell
+	IntVec2							m_glyphGridLayout;
+};
+
+// glyphSheet is a grid bitmap font as loaded by Image, ink is where alpha and brightness are both
+// over half. Glyphs are independent, an optional WorkerPool builds them in parallel.
+SDFFontAtlas GenerateSDFFontAtlas(Image const& glyphSheet, SDFFontConfig const& config = SDFFontConfig(), WorkerPool* workers = nullptr);
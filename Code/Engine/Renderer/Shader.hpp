@@ -23,6 +23,7 @@ class Shader
 	friend class Renderer;
 	friend class DX11Renderer;
 	friend class DX12Renderer;
+	friend class NullRenderer;
 	friend class GraphicsPSO;
 	friend class ComputePSO;
 
@@ -55,8 +56,14 @@ private:
 	std::vector<unsigned char> m_computeShaderByteCode;
 
 	VertexType m_inputLayoutMode = VertexType::VERTEX_PCU;
+	uint32_t m_pipelineShaderId = 0; // interned from the name by the first PSO it is set on
 #endif // ENGINE_RENDER_D3D12
 
+#ifdef ENGINE_RENDER_NULL
+	unsigned int m_id = 0;
+	VertexType m_inputLayoutMode = VertexType::VERTEX_PCU;
+#endif // ENGINE_RENDER_NULL
+
 
 };
 
@@ -54,10 +54,10 @@ void Skybox::Render(Camera const& camera, Renderer* rendererOverride /*= nullptr
 		skyBoxMat44.SetTranslation3D(camera.GetPosition());
 		renderer->SetModelConstants(skyBoxMat44);
 
-#ifdef ENGINE_RENDER_D3D11
+#if defined(ENGINE_RENDER_D3D11) || defined(ENGINE_RENDER_NULL)
 		renderer->BindTexture(m_texture);
 		renderer->SetSamplerMode(SamplerMode::BILINEAR_WRAP);
-#endif // ENGINE_RENDER_D3D11
+#endif // ENGINE_RENDER_D3D11 || ENGINE_RENDER_NULL
 
 #ifdef ENGINE_RENDER_D3D12
 		// resource settings
@@ -0,0 +1,265 @@
+#include "Engine/Renderer/SpriteBatch.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/SpriteAnimDefinition.hpp"
+#include "Engine/Renderer/SpriteDefinition.hpp"
+#include "Engine/Renderer/SpriteSheet.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+//-----------------------------------------------------------------------------------------------
+SpriteBatch::SpriteBatch(Renderer* renderer)
+	: m_renderer(renderer)
+{
+	m_state.m_blendMode = BlendMode::ALPHA;
+	m_state.m_depthMode = DepthMode::DISABLED;
+	m_state.m_rasterizerMode = RasterizerMode::SOLID_CULL_NONE;
+}
+
+//-----------------------------------------------------------------------------------------------
+void SpriteBatch::Submit(SpriteDefinition const& sprite, AABB2 const& bounds, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, int layer /*= 0*/)
+{
+	Vec2 halfDimensions = (bounds.m_maxs - bounds.m_mins) * 0.5f;
+
+	Sprite newSprite;
+	newSprite.m_center = bounds.m_mins + halfDimensions;
+	newSprite.m_halfIBasis = Vec2(halfDimensions.x, 0.f);
+	newSprite.m_halfJBasis = Vec2(0.f, halfDimensions.y);
+	newSprite.m_uvs = sprite.GetUVs();
+	newSprite.m_texture = &sprite.GetTexture();
+	newSprite.m_tint = tint;
+
+	RenderSortItem sortItem;
+	sortItem.m_key = (static_cast<uint64_t>(static_cast<uint32_t>(layer) ^ 0x80000000u) << 32) | GetTextureId(newSprite.m_texture);
+	sortItem.m_index = static_cast<uint32_t>(m_sprites.size());
+	m_sortItems.push_back(sortItem);
+	m_sprites.push_back(newSprite);
+}
+
+void SpriteBatch::Submit(SpriteDefinition const& sprite, Vec2 const& center, Vec2 const& dimensions, float orientationDegrees, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, int layer /*= 0*/)
+{
+	Submit(sprite, AABB2(center - dimensions * 0.5f, center + dimensions * 0.5f), tint, layer);
+	if (orientationDegrees != 0.f)
+	{
+		Vec2 iBasis(CosDegrees(orientationDegrees), SinDegrees(orientationDegrees));
+		Sprite& newSprite = m_sprites.back();
+		newSprite.m_halfIBasis = iBasis * (dimensions.x * 0.5f);
+		newSprite.m_halfJBasis = Vec2(-iBasis.y, iBasis.x) * (dimensions.y * 0.5f);
+	}
+}
+
+void SpriteBatch::Submit(SpriteAnimDefinition const& anim, float animSeconds, Vec2 const& center, Vec2 const& dimensions, float orientationDegrees, Rgba8 const& tint /*= Rgba8::OPAQUE_WHITE*/, int layer /*= 0*/)
+{
+	Submit(anim.GetSpriteDefAtTime(animSeconds), center, dimensions, orientationDegrees, tint, layer);
+}
+
+//-----------------------------------------------------------------------------------------------
+void SpriteBatch::Flush(WorkerPool* workers /*= nullptr*/)
+{
+	PROFILE_SCOPE("SpriteBatch::Flush");
+
+	int const numSprites = static_cast<int>(m_sprites.size());
+	m_lastNumSprites = numSprites;
+	m_lastNumDrawCalls = 0;
+	if (numSprites == 0)
+	{
+		return;
+	}
+
+	RadixSortRenderItems(m_sortItems, m_sortScratch);
+
+	if (static_cast<int>(m_vertexes.size()) < numSprites * 6)
+	{
+		m_vertexes.resize(numSprites * 6);
+	}
+	int constexpr SPRITES_PER_TASK = 4096;
+	int numTasks = (numSprites + SPRITES_PER_TASK - 1) / SPRITES_PER_TASK;
+	if (workers && numTasks > 1)
+	{
+		workers->ParallelFor(numTasks, [this, numSprites](int taskIndex)
+			{
+				int firstSortIndex = taskIndex * SPRITES_PER_TASK;
+				int numTaskSprites = (numSprites - firstSortIndex < SPRITES_PER_TASK) ? numSprites - firstSortIndex : SPRITES_PER_TASK;
+				WriteVertexes(firstSortIndex, numTaskSprites);
+			});
+	}
+	else
+	{
+		WriteVertexes(0, numSprites);
+	}
+
+	m_renderer->SetRenderTargetFormats();
+	m_renderer->SetModelConstants();
+
+	RenderState runState = m_state;
+	RenderState const* previousState = nullptr;
+	RenderState boundState;
+	int runStart = 0;
+	for (int sortIndex = 1; sortIndex <= numSprites; ++sortIndex)
+	{
+		Texture const* runTexture = m_sprites[m_sortItems[runStart].m_index].m_texture;
+		if (sortIndex < numSprites && m_sprites[m_sortItems[sortIndex].m_index].m_texture == runTexture)
+		{
+			continue;
+		}
+
+		runState.m_texture = runTexture;
+		BindRenderState(m_renderer, runState, previousState);
+		boundState = runState;
+		previousState = &boundState;
+
+#ifdef ENGINE_RENDER_D3D12
+		SetUnlitBindlessResources(m_renderer, runState);
+#endif // ENGINE_RENDER_D3D12
+
+		m_renderer->DrawVertexArray((sortIndex - runStart) * 6, m_vertexes.data() + runStart * 6);
+		++m_lastNumDrawCalls;
+		runStart = sortIndex;
+	}
+
+	Clear();
+}
+
+void SpriteBatch::Clear()
+{
+	m_sprites.clear();
+	m_sortItems.clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+uint32_t SpriteBatch::GetTextureId(Texture const* texture)
+{
+	if (texture == m_lastTexture)
+	{
+		return m_lastTextureId; // sprites from the same sheet usually come in runs
+	}
+
+	auto found = m_textureIds.find(texture);
+	uint32_t id = 0;
+	if (found == m_textureIds.end())
+	{
+		id = static_cast<uint32_t>(m_textureIds.size()) + 1;
+		m_textureIds[texture] = id;
+	}
+	else
+	{
+		id = found->second;
+	}
+
+	m_lastTexture = texture;
+	m_lastTextureId = id;
+	return id;
+}
+
+void SpriteBatch::WriteVertexes(int firstSortIndex, int numSprites)
+{
+	// Member by member: the Vec2, Vec3 and Rgba8 constructors and assignments are not inline, and
+	// calling them for every corner costs more than the rest of Flush
+	auto setVertex = [](Vertex_PCU& vertex, float x, float y, float u, float v, Rgba8 const& tint)
+		{
+			vertex.m_position.x = x;
+			vertex.m_position.y = y;
+			vertex.m_position.z = 0.f;
+			vertex.m_color.r = tint.r;
+			vertex.m_color.g = tint.g;
+			vertex.m_color.b = tint.b;
+			vertex.m_color.a = tint.a;
+			vertex.m_uvTexCoords.x = u;
+			vertex.m_uvTexCoords.y = v;
+		};
+
+	Vertex_PCU* vertex = m_vertexes.data() + firstSortIndex * 6;
+	for (int sortIndex = firstSortIndex; sortIndex < firstSortIndex + numSprites; ++sortIndex)
+	{
+		Sprite const& sprite = m_sprites[m_sortItems[sortIndex].m_index];
+		float const iX = sprite.m_halfIBasis.x;
+		float const iY = sprite.m_halfIBasis.y;
+		float const jX = sprite.m_halfJBasis.x;
+		float const jY = sprite.m_halfJBasis.y;
+		float const uvMinX = sprite.m_uvs.m_mins.x;
+		float const uvMinY = sprite.m_uvs.m_mins.y;
+		float const uvMaxX = sprite.m_uvs.m_maxs.x;
+		float const uvMaxY = sprite.m_uvs.m_maxs.y;
+
+		// Same corners and winding as AddVertsForAABB2D
+		setVertex(vertex[0], sprite.m_center.x - iX - jX, sprite.m_center.y - iY - jY, uvMinX, uvMinY, sprite.m_tint);
+		setVertex(vertex[1], sprite.m_center.x + iX - jX, sprite.m_center.y + iY - jY, uvMaxX, uvMinY, sprite.m_tint);
+		setVertex(vertex[2], sprite.m_center.x + iX + jX, sprite.m_center.y + iY + jY, uvMaxX, uvMaxY, sprite.m_tint);
+		setVertex(vertex[3], sprite.m_center.x - iX - jX, sprite.m_center.y - iY - jY, uvMinX, uvMinY, sprite.m_tint);
+		setVertex(vertex[4], sprite.m_center.x + iX + jX, sprite.m_center.y + iY + jY, uvMaxX, uvMaxY, sprite.m_tint);
+		setVertex(vertex[5], sprite.m_center.x - iX + jX, sprite.m_center.y - iY + jY, uvMinX, uvMaxY, sprite.m_tint);
+		vertex += 6;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string SpriteBatchBenchmarkResult::ToString() const
+{
+	return Stringf("%d sprites, %d textures, %d frames. Per sprite draws: %.3f ms/frame, %d draws. SpriteBatch: %.3f ms/frame, %d draws",
+		m_numSprites, m_numTextures, m_numFrames, m_immediateMsPerFrame, m_immediateDrawCalls, m_batchedMsPerFrame, m_batchedDrawCalls);
+}
+
+SpriteBatchBenchmarkResult RunSpriteBatchBenchmark(Renderer* renderer, std::vector<SpriteSheet const*> const& sheets, int numSprites, int numFrames, WorkerPool* workers /*= nullptr*/)
+{
+	SpriteBatchBenchmarkResult result;
+	result.m_numSprites = numSprites;
+	result.m_numTextures = static_cast<int>(sheets.size());
+	result.m_numFrames = numFrames;
+	if (sheets.empty() || numFrames <= 0)
+	{
+		return result;
+	}
+
+	// Entities interleave sheets and layers like a game's entity list does
+	int constexpr NUM_LAYERS = 4;
+	Vec2 const spriteDimensions(16.f, 16.f);
+	auto getSpriteDef = [&sheets](int spriteIndex) -> SpriteDefinition const&
+		{
+			SpriteSheet const& sheet = *sheets[spriteIndex % sheets.size()];
+			return sheet.GetSpriteDef((spriteIndex / static_cast<int>(sheets.size())) % sheet.GetNumSprites());
+		};
+	auto getSpriteBounds = [&spriteDimensions](int spriteIndex, int frameIndex)
+		{
+			Vec2 mins(static_cast<float>((spriteIndex % 400) * 4 + frameIndex), static_cast<float>((spriteIndex / 400) % 200 * 4));
+			return AABB2(mins, mins + spriteDimensions);
+		};
+
+	std::vector<Vertex_PCU> spriteVerts;
+	spriteVerts.reserve(6);
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+	{
+		renderer->BeginFrame();
+		for (int spriteIndex = 0; spriteIndex < numSprites; ++spriteIndex)
+		{
+			SpriteDefinition const& spriteDef = getSpriteDef(spriteIndex);
+			spriteVerts.clear();
+			AddVertsForAABB2D(spriteVerts, getSpriteBounds(spriteIndex, frameIndex), Rgba8::OPAQUE_WHITE, spriteDef.GetUVs());
+			renderer->BindTexture(&spriteDef.GetTexture());
+			renderer->DrawVertexArray(spriteVerts);
+		}
+		renderer->EndFrame();
+	}
+	result.m_immediateMsPerFrame = (GetCurrentTimeSeconds() - startSeconds) * 1000.0 / static_cast<double>(numFrames);
+	result.m_immediateDrawCalls = numSprites;
+
+	SpriteBatch spriteBatch(renderer);
+	startSeconds = GetCurrentTimeSeconds();
+	for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+	{
+		renderer->BeginFrame();
+		for (int spriteIndex = 0; spriteIndex < numSprites; ++spriteIndex)
+		{
+			spriteBatch.Submit(getSpriteDef(spriteIndex), getSpriteBounds(spriteIndex, frameIndex), Rgba8::OPAQUE_WHITE, spriteIndex % NUM_LAYERS);
+		}
+		spriteBatch.Flush(workers);
+		renderer->EndFrame();
+	}
+	result.m_batchedMsPerFrame = (GetCurrentTimeSeconds() - startSeconds) * 1000.0 / static_cast<double>(numFrames);
+	result.m_batchedDrawCalls = spriteBatch.GetLastNumDrawCalls();
+	return result;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Renderer;
+class SpriteDefinition;
+class SpriteAnimDefinition;
+class SpriteSheet;
+class WorkerPool;
+
+//-----------------------------------------------------------------------------------------------
+// Collects the 2D sprites of a frame and draws them with one draw per run of the same texture.
+//
+// Submit only records the sprite. Flush sorts the sprites by layer, lower layers first, and by
+// texture inside a layer, writes all their vertexes into one array kept between frames and draws
+// every texture run straight from it. Sprites on the same layer and texture keep submission order,
+// sprites on the same layer with different textures are not ordered against each other.
+//
+// Usage:
+//	m_spriteBatch.Submit(playerAnim, m_animSeconds, m_position, Vec2(1.f, 1.f), m_orientation, Rgba8::OPAQUE_WHITE, LAYER_ACTORS);
+//	...
+//	g_theRenderer->BeginCamera(m_screenCamera);
+//	m_spriteBatch.Flush();
+//	g_theRenderer->EndCamera(m_screenCamera);
+//
+class SpriteBatch
+{
+public:
+	explicit SpriteBatch(Renderer* renderer);
+	SpriteBatch(SpriteBatch const& copy) = delete;
+
+	// Texture of each run replaces m_texture, the rest is bound once per Flush. Defaults to alpha
+	// blending without depth or culling
+	void SetRenderState(RenderState const& state) { m_state = state; }
+	RenderState const& GetRenderState() const { return m_state; }
+
+	void Submit(SpriteDefinition const& sprite, AABB2 const& bounds, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, int layer = 0);
+	void Submit(SpriteDefinition const& sprite, Vec2 const& center, Vec2 const& dimensions, float orientationDegrees, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, int layer = 0);
+	void Submit(SpriteAnimDefinition const& anim, float animSeconds, Vec2 const& center, Vec2 const& dimensions, float orientationDegrees, Rgba8 const& tint = Rgba8::OPAQUE_WHITE, int layer = 0);
+
+	// Call between BeginCamera and EndCamera, it empties the batch. An optional WorkerPool writes
+	// the vertexes in parallel
+	void Flush(WorkerPool* workers = nullptr);
+	void Clear();
+
+	int GetNumSprites() const { return static_cast<int>(m_sprites.size()); }
+	int GetLastNumSprites() const { return m_lastNumSprites; }
+	int GetLastNumDrawCalls() const { return m_lastNumDrawCalls; }
+
+protected:
+	struct Sprite
+	{
+		Vec2			m_center;
+		Vec2			m_halfIBasis;	// center to the right edge
+		Vec2			m_halfJBasis;	// center to the top edge
+		AABB2			m_uvs;
+		Texture const*	m_texture = nullptr;
+		Rgba8			m_tint;
+	};
+
+	uint32_t GetTextureId(Texture const* texture);
+	void WriteVertexes(int firstSortIndex, int numSprites);
+
+protected:
+	Renderer* m_renderer = nullptr;
+	RenderState m_state;
+
+	std::vector<Sprite>				m_sprites;
+	std::vector<RenderSortItem>		m_sortItems;
+	std::vector<RenderSortItem>		m_sortScratch;
+	std::vector<Vertex_PCU>			m_vertexes;	// only grows, six per sprite in sorted order
+
+	std::unordered_map<Texture const*, uint32_t> m_textureIds;
+	Texture const*	m_lastTexture = nullptr;
+	uint32_t		m_lastTextureId = 0;
+
+	int m_lastNumSprites = 0;
+	int m_lastNumDrawCalls = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+struct SpriteBatchBenchmarkResult
+{
+	int		m_numSprites = 0;
+	int		m_numTextures = 0;
+	int		m_numFrames = 0;
+	double	m_immediateMsPerFrame = 0.0;	// AddVertsForAABB2D and DrawVertexArray per sprite
+	int		m_immediateDrawCalls = 0;		// per frame
+	double	m_batchedMsPerFrame = 0.0;
+	int		m_batchedDrawCalls = 0;			// per frame
+
+	std::string ToString() const;
+};
+
+// Draws numSprites sprites spread over the sprites of sheets, one texture per sheet, every frame,
+// once one draw per sprite and once through a SpriteBatch. Meant for the null renderer: it begins
+// and ends its own frames, so the measured time is CPU submission only
+SpriteBatchBenchmarkResult RunSpriteBatchBenchmark(Renderer* renderer, std::vector<SpriteSheet const*> const& sheets, int numSprites, int numFrames, WorkerPool* workers = nullptr);
@@ -28,6 +28,16 @@ SpriteSheet::SpriteSheet(Texture& texture, IntVec2 const& simpleGridLayout)
 
 }
 
+SpriteSheet::SpriteSheet(Texture& texture, std::vector<AABB2> const& spriteUVs)
+	: m_texture(texture)
+{
+	m_spriteDefs.reserve(spriteUVs.size());
+	for (int spriteIndex = 0; spriteIndex < static_cast<int>(spriteUVs.size()); ++spriteIndex)
+	{
+		m_spriteDefs.emplace_back(SpriteDefinition(*this, spriteIndex, spriteUVs[spriteIndex].m_mins, spriteUVs[spriteIndex].m_maxs));
+	}
+}
+
 Texture& SpriteSheet::GetTexture() const
 {
 	return m_texture;
@@ -12,6 +12,7 @@ class SpriteSheet
 {
 public:
 	explicit SpriteSheet(Texture& texture, IntVec2 const& simpleGridLayout);
+	explicit SpriteSheet(Texture& texture, std::vector<AABB2> const& spriteUVs); // packed sheets like TextureAtlasPage
 
 	Texture&					GetTexture() const;
 	int							GetNumSprites() const;
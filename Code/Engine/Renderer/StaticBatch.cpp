@@ -0,0 +1,315 @@
+#include "Engine/Renderer/StaticBatch.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Renderer/IndexBuffer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------------------------
+StaticBatch::StaticBatch(Renderer* renderer)
+	: m_renderer(renderer)
+{
+}
+
+StaticBatch::~StaticBatch()
+{
+	Clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+StaticBatchHandle StaticBatch::Add(RenderState const& material, std::vector<Vertex_PCU> const& verts, Mat44 const& modelToWorldTransform /*= Mat44()*/)
+{
+	return Add(material, verts, std::vector<unsigned int>(), modelToWorldTransform);
+}
+
+StaticBatchHandle StaticBatch::Add(RenderState const& material, std::vector<Vertex_PCU> const& verts, std::vector<unsigned int> const& indexes, Mat44 const& modelToWorldTransform /*= Mat44()*/)
+{
+	if (verts.empty())
+	{
+		return StaticBatchHandle();
+	}
+
+	int materialIndex = GetOrCreateMaterialIndex(material);
+	Material& batchMaterial = m_materials[materialIndex];
+
+	StaticBatchHandle handle = m_entries.Add();
+	Entry& entry = *m_entries.Get(handle);
+	entry.m_modelToWorldTransform = modelToWorldTransform;
+	entry.m_modelVerts.assign(verts.begin(), verts.end());
+	entry.m_modelIndexes.assign(indexes.begin(), indexes.end());
+	entry.m_materialEntryIndex = static_cast<int>(batchMaterial.m_entryHandles.size());
+	batchMaterial.m_entryHandles.push_back(handle);
+
+	StaticBatchRange& range = entry.m_range;
+	range.m_materialIndex = materialIndex;
+	range.m_firstVertex = static_cast<int>(batchMaterial.m_verts.size());
+	range.m_numVertexes = static_cast<int>(verts.size());
+	range.m_firstIndex = static_cast<int>(batchMaterial.m_indexes.size());
+	range.m_numIndexes = indexes.empty() ? range.m_numVertexes : static_cast<int>(indexes.size());
+
+	batchMaterial.m_verts.resize(range.m_firstVertex + range.m_numVertexes);
+	WriteWorldVerts(entry);
+
+	unsigned int baseVertex = static_cast<unsigned int>(range.m_firstVertex);
+	batchMaterial.m_indexes.reserve(range.m_firstIndex + range.m_numIndexes);
+	for (int index = 0; index < range.m_numIndexes; ++index)
+	{
+		batchMaterial.m_indexes.push_back(baseVertex + (indexes.empty() ? static_cast<unsigned int>(index) : indexes[index]));
+	}
+
+	batchMaterial.MarkVertexesDirty(range.m_firstVertex, range.m_numVertexes);
+	batchMaterial.MarkIndexesDirty(range.m_firstIndex, range.m_numIndexes);
+	return handle;
+}
+
+bool StaticBatch::UpdateTransform(StaticBatchHandle handle, Mat44 const& modelToWorldTransform)
+{
+	Entry* entry = m_entries.Get(handle);
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	entry->m_modelToWorldTransform = modelToWorldTransform;
+	WriteWorldVerts(*entry);
+	m_materials[entry->m_range.m_materialIndex].MarkVertexesDirty(entry->m_range.m_firstVertex, entry->m_range.m_numVertexes);
+	return true;
+}
+
+bool StaticBatch::Remove(StaticBatchHandle handle)
+{
+	Entry* entry = m_entries.Get(handle);
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	StaticBatchRange range = entry->m_range;
+	Material& batchMaterial = m_materials[range.m_materialIndex];
+
+	// The material's last entry takes over this one's place in its list
+	StaticBatchHandle movedHandle = batchMaterial.m_entryHandles.back();
+	m_entries.Get(movedHandle)->m_materialEntryIndex = entry->m_materialEntryIndex;
+	batchMaterial.m_entryHandles[entry->m_materialEntryIndex] = movedHandle;
+	batchMaterial.m_entryHandles.pop_back();
+	m_entries.Remove(handle);
+
+	// Vertexes and indexes are appended and compacted in the same order, so the entry that ends
+	// the vertexes also ends the indexes
+	if (range.m_firstVertex + range.m_numVertexes == static_cast<int>(batchMaterial.m_verts.size()))
+	{
+		batchMaterial.m_verts.resize(range.m_firstVertex);
+		batchMaterial.m_indexes.resize(range.m_firstIndex);
+	}
+	else
+	{
+		// Degenerate triangles draw nothing and leave every other index where it is
+		auto firstIndex = batchMaterial.m_indexes.begin() + range.m_firstIndex;
+		std::fill(firstIndex, firstIndex + range.m_numIndexes, static_cast<unsigned int>(range.m_firstVertex));
+		batchMaterial.MarkIndexesDirty(range.m_firstIndex, range.m_numIndexes);
+		batchMaterial.m_numDeadVertexes += range.m_numVertexes;
+		batchMaterial.m_numDeadIndexes += range.m_numIndexes;
+	}
+
+	int numLiveVertexes = static_cast<int>(batchMaterial.m_verts.size()) - batchMaterial.m_numDeadVertexes;
+	int numLiveIndexes = static_cast<int>(batchMaterial.m_indexes.size()) - batchMaterial.m_numDeadIndexes;
+	if (batchMaterial.m_numDeadVertexes > numLiveVertexes || batchMaterial.m_numDeadIndexes > numLiveIndexes)
+	{
+		Compact(range.m_materialIndex);
+	}
+	return true;
+}
+
+void StaticBatch::Clear()
+{
+	for (Material& batchMaterial : m_materials)
+	{
+		delete batchMaterial.m_vbo;
+		delete batchMaterial.m_ibo;
+	}
+	m_materials.clear();
+	m_entries.Clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+void StaticBatch::Render()
+{
+	PROFILE_SCOPE("StaticBatch::Render");
+
+	m_lastNumDrawCalls = 0;
+	m_lastNumUploads = 0;
+	m_lastNumUploadedBytes = 0;
+
+	m_renderer->SetModelConstants();
+
+	RenderState const* previousState = nullptr;
+	for (Material& batchMaterial : m_materials)
+	{
+		if (batchMaterial.m_indexes.empty())
+		{
+			continue;
+		}
+		if (batchMaterial.m_dirtyVertexBegin < batchMaterial.m_dirtyVertexEnd || batchMaterial.m_dirtyIndexBegin < batchMaterial.m_dirtyIndexEnd)
+		{
+			Upload(batchMaterial);
+		}
+
+		BindRenderState(m_renderer, batchMaterial.m_state, previousState);
+#ifdef ENGINE_RENDER_D3D12
+		SetUnlitBindlessResources(m_renderer, batchMaterial.m_state);
+#endif // ENGINE_RENDER_D3D12
+		m_renderer->DrawIndexedVertexBuffer(batchMaterial.m_vbo, batchMaterial.m_ibo, static_cast<unsigned int>(batchMaterial.m_indexes.size()));
+
+		++m_lastNumDrawCalls;
+		previousState = &batchMaterial.m_state;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+StaticBatchRange StaticBatch::GetRange(StaticBatchHandle handle) const
+{
+	Entry const* entry = m_entries.Get(handle);
+	return entry ? entry->m_range : StaticBatchRange();
+}
+
+int StaticBatch::GetNumVertexes() const
+{
+	int numVertexes = 0;
+	for (Material const& batchMaterial : m_materials)
+	{
+		numVertexes += static_cast<int>(batchMaterial.m_verts.size()) - batchMaterial.m_numDeadVertexes;
+	}
+	return numVertexes;
+}
+
+int StaticBatch::GetNumIndexes() const
+{
+	int numIndexes = 0;
+	for (Material const& batchMaterial : m_materials)
+	{
+		numIndexes += static_cast<int>(batchMaterial.m_indexes.size()) - batchMaterial.m_numDeadIndexes;
+	}
+	return numIndexes;
+}
+
+//-----------------------------------------------------------------------------------------------
+int StaticBatch::GetOrCreateMaterialIndex(RenderState const& state)
+{
+	for (int materialIndex = 0; materialIndex < static_cast<int>(m_materials.size()); ++materialIndex)
+	{
+		if (m_materials[materialIndex].m_state == state)
+		{
+			return materialIndex;
+		}
+	}
+
+	m_materials.emplace_back();
+	m_materials.back().m_state = state;
+	return static_cast<int>(m_materials.size()) - 1;
+}
+
+void StaticBatch::WriteWorldVerts(Entry const& entry)
+{
+	Vertex_PCU* worldVerts = m_materials[entry.m_range.m_materialIndex].m_verts.data() + entry.m_range.m_firstVertex;
+	for (int vertIndex = 0; vertIndex < entry.m_range.m_numVertexes; ++vertIndex)
+	{
+		worldVerts[vertIndex] = entry.m_modelVerts[vertIndex];
+		worldVerts[vertIndex].m_position = entry.m_modelToWorldTransform.TransformPosition3D(entry.m_modelVerts[vertIndex].m_position);
+	}
+}
+
+void StaticBatch::Compact(int materialIndex)
+{
+	PROFILE_SCOPE("StaticBatch::Compact");
+
+	Material& batchMaterial = m_materials[materialIndex];
+	std::vector<StaticBatchRange*> ranges;
+	ranges.reserve(batchMaterial.m_entryHandles.size());
+	for (StaticBatchHandle entryHandle : batchMaterial.m_entryHandles)
+	{
+		ranges.push_back(&m_entries.Get(entryHandle)->m_range);
+	}
+	std::sort(ranges.begin(), ranges.end(), [](StaticBatchRange const* a, StaticBatchRange const* b) { return a->m_firstVertex < b->m_firstVertex; });
+
+	// Slide every range down over the holes, its indexes move by the same amount
+	int writeVertex = 0;
+	int writeIndex = 0;
+	for (StaticBatchRange* range : ranges)
+	{
+		if (range->m_firstVertex != writeVertex)
+		{
+			std::copy(batchMaterial.m_verts.begin() + range->m_firstVertex, batchMaterial.m_verts.begin() + range->m_firstVertex + range->m_numVertexes,
+				batchMaterial.m_verts.begin() + writeVertex);
+		}
+
+		unsigned int shift = static_cast<unsigned int>(range->m_firstVertex - writeVertex);
+		for (int index = 0; index < range->m_numIndexes; ++index)
+		{
+			batchMaterial.m_indexes[writeIndex + index] = batchMaterial.m_indexes[range->m_firstIndex + index] - shift;
+		}
+
+		range->m_firstVertex = writeVertex;
+		range->m_firstIndex = writeIndex;
+		writeVertex += range->m_numVertexes;
+		writeIndex += range->m_numIndexes;
+	}
+
+	batchMaterial.m_verts.resize(writeVertex);
+	batchMaterial.m_indexes.resize(writeIndex);
+	batchMaterial.m_numDeadVertexes = 0;
+	batchMaterial.m_numDeadIndexes = 0;
+	batchMaterial.MarkVertexesDirty(0, writeVertex);
+	batchMaterial.MarkIndexesDirty(0, writeIndex);
+}
+
+void StaticBatch::Upload(Material& batchMaterial)
+{
+	unsigned int vertexBytes = static_cast<unsigned int>(batchMaterial.m_verts.size() * sizeof(Vertex_PCU));
+	unsigned int indexBytes = static_cast<unsigned int>(batchMaterial.m_indexes.size() * sizeof(unsigned int));
+
+	if (batchMaterial.m_vbo == nullptr)
+	{
+		batchMaterial.m_vbo = m_renderer->CreateVertexBuffer(vertexBytes, sizeof(Vertex_PCU));
+	}
+	if (batchMaterial.m_ibo == nullptr)
+	{
+		batchMaterial.m_ibo = m_renderer->CreateIndexBuffer(indexBytes);
+	}
+
+	// Removing the last entry shrinks the arrays under a range marked earlier
+	int dirtyVertexEnd = std::min(batchMaterial.m_dirtyVertexEnd, static_cast<int>(batchMaterial.m_verts.size()));
+	if (batchMaterial.m_dirtyVertexBegin < dirtyVertexEnd)
+	{
+		unsigned int dirtyBytes = static_cast<unsigned int>((dirtyVertexEnd - batchMaterial.m_dirtyVertexBegin) * sizeof(Vertex_PCU));
+		m_renderer->CopyCPUToGPURange(batchMaterial.m_verts.data(), vertexBytes, static_cast<unsigned int>(batchMaterial.m_dirtyVertexBegin * sizeof(Vertex_PCU)), dirtyBytes, batchMaterial.m_vbo);
+		m_lastNumUploadedBytes += static_cast<int>(dirtyBytes);
+	}
+
+	int dirtyIndexEnd = std::min(batchMaterial.m_dirtyIndexEnd, static_cast<int>(batchMaterial.m_indexes.size()));
+	if (batchMaterial.m_dirtyIndexBegin < dirtyIndexEnd)
+	{
+		unsigned int dirtyBytes = static_cast<unsigned int>((dirtyIndexEnd - batchMaterial.m_dirtyIndexBegin) * sizeof(unsigned int));
+		m_renderer->CopyCPUToGPURange(batchMaterial.m_indexes.data(), indexBytes, static_cast<unsigned int>(batchMaterial.m_dirtyIndexBegin * sizeof(unsigned int)), dirtyBytes, batchMaterial.m_ibo);
+		m_lastNumUploadedBytes += static_cast<int>(dirtyBytes);
+	}
+
+	batchMaterial.m_dirtyVertexBegin = batchMaterial.m_dirtyVertexEnd = 0;
+	batchMaterial.m_dirtyIndexBegin = batchMaterial.m_dirtyIndexEnd = 0;
+	++m_lastNumUploads;
+}
+
+//-----------------------------------------------------------------------------------------------
+void StaticBatch::Material::MarkVertexesDirty(int firstVertex, int numVertexes)
+{
+	bool wasClean = m_dirtyVertexBegin >= m_dirtyVertexEnd;
+	m_dirtyVertexBegin = wasClean ? firstVertex : std::min(m_dirtyVertexBegin, firstVertex);
+	m_dirtyVertexEnd = wasClean ? firstVertex + numVertexes : std::max(m_dirtyVertexEnd, firstVertex + numVertexes);
+}
+
+void StaticBatch::Material::MarkIndexesDirty(int firstIndex, int numIndexes)
+{
+	bool wasClean = m_dirtyIndexBegin >= m_dirtyIndexEnd;
+	m_dirtyIndexBegin = wasClean ? firstIndex : std::min(m_dirtyIndexBegin, firstIndex);
+	m_dirtyIndexEnd = wasClean ? firstIndex + numIndexes : std::max(m_dirtyIndexEnd, firstIndex + numIndexes);
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Core/SlotMap.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <vector>
+
+class Renderer;
+class VertexBuffer;
+class IndexBuffer;
+
+typedef SlotHandle StaticBatchHandle;
+
+//-----------------------------------------------------------------------------------------------
+struct StaticBatchRange
+{
+	int m_materialIndex = -1;
+	int m_firstVertex = 0;
+	int m_numVertexes = 0;
+	int m_firstIndex = 0;
+	int m_numIndexes = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+// Merges static geometry, for example level pieces built with VertexUtils, into one vertex and
+// one index buffer per material, so it draws with one DrawIndexedVertexBuffer per material.
+//
+// Vertexes are baked to world space when added. Every entry remembers its model space mesh and
+// its range in the shared buffers: UpdateTransform rewrites only that range, Remove turns its
+// indexes into degenerate triangles and leaves its vertexes as a hole. A material compacts once
+// holes outnumber its live vertexes or indexes, so removing a whole level stays linear. Each
+// material tracks the element ranges changed since its last upload and Render uploads only those.
+//
+class StaticBatch
+{
+public:
+	explicit StaticBatch(Renderer* renderer);
+	~StaticBatch();
+	StaticBatch(StaticBatch const& copy) = delete;
+
+	// Without indexes the vertexes are taken as a triangle list
+	StaticBatchHandle Add(RenderState const& material, std::vector<Vertex_PCU> const& verts, Mat44 const& modelToWorldTransform = Mat44());
+	StaticBatchHandle Add(RenderState const& material, std::vector<Vertex_PCU> const& verts, std::vector<unsigned int> const& indexes, Mat44 const& modelToWorldTransform = Mat44());
+	bool UpdateTransform(StaticBatchHandle handle, Mat44 const& modelToWorldTransform);
+	bool Remove(StaticBatchHandle handle);
+	void Clear();
+
+	// Uploads changed materials, then draws every material once with an identity model transform.
+	// Call between BeginCamera and EndCamera
+	void Render();
+
+	bool IsValid(StaticBatchHandle handle) const { return m_entries.IsValid(handle); }
+	StaticBatchRange GetRange(StaticBatchHandle handle) const;
+
+	int GetNumEntries() const { return m_entries.GetCount(); }
+	int GetNumMaterials() const { return static_cast<int>(m_materials.size()); }
+	int GetNumVertexes() const;
+	int GetNumIndexes() const;
+	int GetLastNumDrawCalls() const { return m_lastNumDrawCalls; }
+	int GetLastNumUploads() const { return m_lastNumUploads; }
+	int GetLastNumUploadedBytes() const { return m_lastNumUploadedBytes; }
+
+protected:
+	struct Entry
+	{
+		StaticBatchRange			m_range;
+		int							m_materialEntryIndex = -1; // in its material's m_entryHandles
+		Mat44						m_modelToWorldTransform;
+		std::vector<Vertex_PCU>		m_modelVerts;
+		std::vector<unsigned int>	m_modelIndexes; // empty for a triangle list
+	};
+
+	struct Material
+	{
+		RenderState					m_state;
+		std::vector<Vertex_PCU>		m_verts;
+		std::vector<unsigned int>	m_indexes;
+		std::vector<StaticBatchHandle>	m_entryHandles; // in no particular order
+		VertexBuffer*				m_vbo = nullptr;
+		IndexBuffer*				m_ibo = nullptr;
+		int							m_numDeadVertexes = 0;
+		int							m_numDeadIndexes = 0;
+
+		// Element ranges changed since the last upload, empty when begin >= end
+		int							m_dirtyVertexBegin = 0;
+		int							m_dirtyVertexEnd = 0;
+		int							m_dirtyIndexBegin = 0;
+		int							m_dirtyIndexEnd = 0;
+
+		void MarkVertexesDirty(int firstVertex, int numVertexes);
+		void MarkIndexesDirty(int firstIndex, int numIndexes);
+	};
+
+	int GetOrCreateMaterialIndex(RenderState const& state);
+	void WriteWorldVerts(Entry const& entry);
+	void Compact(int materialIndex);
+	void Upload(Material& material);
+
+protected:
+	Renderer* m_renderer = nullptr;
+	SlotMap<Entry> m_entries;
+	std::vector<Material> m_materials;
+	int m_lastNumDrawCalls = 0;
+	int m_lastNumUploads = 0;
+	int m_lastNumUploadedBytes = 0;
+};
@@ -1,7 +1,9 @@
 #pragma once
+#if !defined(ENGINE_HEADLESS)
 #include "Game/EngineBuildPreferences.hpp"
+#endif
 
-// For Math Unit Tests (No Renderer Subsystem)
+// For Math Unit Tests (No Renderer Subsystem) and the recording NullRenderer
 #if !defined(ENGINE_RENDER_D3D11) && !defined(ENGINE_RENDER_D3D12)
 #include "Engine/Math/IntVec2.hpp"
 #include <string>
@@ -9,6 +11,8 @@
 //------------------------------------------------------------------------------------------------
 class Texture
 {
+	friend class NullRenderer;
+
 private:
 	Texture() = default; // can't instantiate directly; must ask Renderer to do it for you
 	Texture(Texture const& copy) = delete; // No copying allowed!  This represents GPU memory.
@@ -21,6 +25,7 @@ public:
 protected:
 	std::string			m_name;
 	IntVec2				m_dimensions;
+	unsigned int		m_id = 0; // what NullRenderer records when the texture is bound
 };
 #endif
 
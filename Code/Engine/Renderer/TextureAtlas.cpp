@@ -0,0 +1,303 @@
+#include "Engine/Renderer/TextureAtlas.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	int GetNextPowerOfTwo(int value)
+	{
+		int powerOfTwo = 1;
+		while (powerOfTwo < value)
+		{
+			powerOfTwo <<= 1;
+		}
+		return powerOfTwo;
+	}
+
+	bool DoRectsOverlap(IntVec2 const& minsA, IntVec2 const& sizeA, IntVec2 const& minsB, IntVec2 const& sizeB)
+	{
+		return minsA.x < minsB.x + sizeB.x && minsB.x < minsA.x + sizeA.x && minsA.y < minsB.y + sizeB.y && minsB.y < minsA.y + sizeA.y;
+	}
+
+	bool IsRectInside(IntVec2 const& innerMins, IntVec2 const& innerSize, IntVec2 const& outerMins, IntVec2 const& outerSize)
+	{
+		return innerMins.x >= outerMins.x && innerMins.y >= outerMins.y
+			&& innerMins.x + innerSize.x <= outerMins.x + outerSize.x && innerMins.y + innerSize.y <= outerMins.y + outerSize.y;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void MaxRectsPacker::Reset(IntVec2 const& binDimensions)
+{
+	m_binDimensions = binDimensions;
+	m_usedDimensions = IntVec2(0, 0);
+	m_usedArea = 0;
+	m_freeRects.clear();
+	m_freeRects.push_back(FreeRect{ IntVec2(0, 0), binDimensions });
+}
+
+bool MaxRectsPacker::Insert(IntVec2 const& size, IntVec2& out_mins)
+{
+	// Best short side fit, the long side breaks ties
+	int bestShortSide = INT_MAX;
+	int bestLongSide = INT_MAX;
+	int bestFreeRect = -1;
+	for (int freeIndex = 0; freeIndex < static_cast<int>(m_freeRects.size()); ++freeIndex)
+	{
+		FreeRect const& freeRect = m_freeRects[freeIndex];
+		if (freeRect.m_size.x < size.x || freeRect.m_size.y < size.y)
+		{
+			continue;
+		}
+
+		int leftoverX = freeRect.m_size.x - size.x;
+		int leftoverY = freeRect.m_size.y - size.y;
+		int shortSide = (leftoverX < leftoverY) ? leftoverX : leftoverY;
+		int longSide = (leftoverX < leftoverY) ? leftoverY : leftoverX;
+		if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+		{
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+			bestFreeRect = freeIndex;
+		}
+	}
+	if (bestFreeRect < 0)
+	{
+		return false;
+	}
+
+	out_mins = m_freeRects[bestFreeRect].m_mins;
+	SplitFreeRects(out_mins, size);
+	PruneFreeRects();
+
+	m_usedArea += size.x * size.y;
+	m_usedDimensions.x = (out_mins.x + size.x > m_usedDimensions.x) ? out_mins.x + size.x : m_usedDimensions.x;
+	m_usedDimensions.y = (out_mins.y + size.y > m_usedDimensions.y) ? out_mins.y + size.y : m_usedDimensions.y;
+	return true;
+}
+
+float MaxRectsPacker::GetOccupancy() const
+{
+	int binArea = m_binDimensions.x * m_binDimensions.y;
+	return (binArea > 0) ? static_cast<float>(m_usedArea) / static_cast<float>(binArea) : 0.f;
+}
+
+void MaxRectsPacker::SplitFreeRects(IntVec2 const& placedMins, IntVec2 const& placedSize)
+{
+	// Every free rectangle the placed one overlaps gives way to its up to four maximal leftovers
+	m_newFreeRects.clear();
+	IntVec2 const placedMaxs(placedMins.x + placedSize.x, placedMins.y + placedSize.y);
+	for (FreeRect const& freeRect : m_freeRects)
+	{
+		if (!DoRectsOverlap(freeRect.m_mins, freeRect.m_size, placedMins, placedSize))
+		{
+			m_newFreeRects.push_back(freeRect);
+			continue;
+		}
+
+		IntVec2 const freeMaxs(freeRect.m_mins.x + freeRect.m_size.x, freeRect.m_mins.y + freeRect.m_size.y);
+		if (placedMins.x > freeRect.m_mins.x)
+		{
+			m_newFreeRects.push_back(FreeRect{ freeRect.m_mins, IntVec2(placedMins.x - freeRect.m_mins.x, freeRect.m_size.y) });
+		}
+		if (placedMaxs.x < freeMaxs.x)
+		{
+			m_newFreeRects.push_back(FreeRect{ IntVec2(placedMaxs.x, freeRect.m_mins.y), IntVec2(freeMaxs.x - placedMaxs.x, freeRect.m_size.y) });
+		}
+		if (placedMins.y > freeRect.m_mins.y)
+		{
+			m_newFreeRects.push_back(FreeRect{ freeRect.m_mins, IntVec2(freeRect.m_size.x, placedMins.y - freeRect.m_mins.y) });
+		}
+		if (placedMaxs.y < freeMaxs.y)
+		{
+			m_newFreeRects.push_back(FreeRect{ IntVec2(freeRect.m_mins.x, placedMaxs.y), IntVec2(freeRect.m_size.x, freeMaxs.y - placedMaxs.y) });
+		}
+	}
+	m_freeRects.swap(m_newFreeRects);
+}
+
+void MaxRectsPacker::PruneFreeRects()
+{
+	// Free rectangles inside another one add nothing, identical ones keep the first
+	for (int outerIndex = 0; outerIndex < static_cast<int>(m_freeRects.size()); ++outerIndex)
+	{
+		for (int innerIndex = outerIndex + 1; innerIndex < static_cast<int>(m_freeRects.size()); ++innerIndex)
+		{
+			FreeRect const& outer = m_freeRects[outerIndex];
+			FreeRect const& inner = m_freeRects[innerIndex];
+			if (IsRectInside(inner.m_mins, inner.m_size, outer.m_mins, outer.m_size))
+			{
+				m_freeRects.erase(m_freeRects.begin() + innerIndex);
+				--innerIndex;
+			}
+			else if (IsRectInside(outer.m_mins, outer.m_size, inner.m_mins, inner.m_size))
+			{
+				m_freeRects.erase(m_freeRects.begin() + outerIndex);
+				--outerIndex;
+				break;
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+float TextureAtlasPage::GetOccupancy() const
+{
+	IntVec2 dimensions = m_image.GetDimensions();
+	int pageTexels = dimensions.x * dimensions.y;
+	return (pageTexels > 0) ? static_cast<float>(m_numSpriteTexels) / static_cast<float>(pageTexels) : 0.f;
+}
+
+int TextureAtlas::FindSprite(std::string const& name) const
+{
+	for (int spriteIndex = 0; spriteIndex < static_cast<int>(m_sprites.size()); ++spriteIndex)
+	{
+		if (m_sprites[spriteIndex].m_name == name)
+		{
+			return spriteIndex;
+		}
+	}
+	return -1;
+}
+
+float TextureAtlas::GetOccupancy() const
+{
+	int64_t spriteTexels = 0;
+	int64_t pageTexels = 0;
+	for (TextureAtlasPage const& page : m_pages)
+	{
+		spriteTexels += page.m_numSpriteTexels;
+		pageTexels += static_cast<int64_t>(page.m_image.GetDimensions().x) * page.m_image.GetDimensions().y;
+	}
+	return (pageTexels > 0) ? static_cast<float>(spriteTexels) / static_cast<float>(pageTexels) : 0.f;
+}
+
+std::string TextureAtlas::GetStatsString() const
+{
+	std::string stats = Stringf("%d sprites on %d pages, %.1f%% occupied:", static_cast<int>(m_sprites.size()), static_cast<int>(m_pages.size()), GetOccupancy() * 100.f);
+	for (TextureAtlasPage const& page : m_pages)
+	{
+		stats += Stringf(" %dx%d (%d sprites, %.1f%%)", page.m_image.GetDimensions().x, page.m_image.GetDimensions().y, static_cast<int>(page.m_spriteUVs.size()), page.GetOccupancy() * 100.f);
+	}
+	return stats;
+}
+
+//-----------------------------------------------------------------------------------------------
+TextureAtlas BuildTextureAtlas(std::vector<Image const*> const& images, TextureAtlasConfig const& config /*= TextureAtlasConfig()*/, char const* atlasName /*= "TextureAtlas"*/)
+{
+	TextureAtlas atlas;
+	int const numImages = static_cast<int>(images.size());
+	atlas.m_sprites.resize(numImages);
+	int const padding = (config.m_padding > 0) ? config.m_padding : 0;
+
+	// Largest side first, then largest area, packs tightest
+	std::vector<int> packOrder(numImages);
+	for (int imageIndex = 0; imageIndex < numImages; ++imageIndex)
+	{
+		packOrder[imageIndex] = imageIndex;
+	}
+	std::stable_sort(packOrder.begin(), packOrder.end(), [&images](int indexA, int indexB)
+		{
+			IntVec2 sizeA = images[indexA]->GetDimensions();
+			IntVec2 sizeB = images[indexB]->GetDimensions();
+			int maxSideA = (sizeA.x > sizeA.y) ? sizeA.x : sizeA.y;
+			int maxSideB = (sizeB.x > sizeB.y) ? sizeB.x : sizeB.y;
+			if (maxSideA != maxSideB)
+			{
+				return maxSideA > maxSideB;
+			}
+			return sizeA.x * sizeA.y > sizeB.x * sizeB.y;
+		});
+
+	// Place everything first, pages are trimmed before any texel is copied
+	std::vector<MaxRectsPacker> packers;
+	for (int imageIndex : packOrder)
+	{
+		IntVec2 dimensions = images[imageIndex]->GetDimensions();
+		IntVec2 paddedSize(dimensions.x + 2 * padding, dimensions.y + 2 * padding);
+
+		TextureAtlasSprite& sprite = atlas.m_sprites[imageIndex];
+		sprite.m_name = images[imageIndex]->GetImageFilePath();
+		sprite.m_dimensions = dimensions;
+
+		IntVec2 paddedMins;
+		for (int pageIndex = 0; pageIndex < static_cast<int>(packers.size()); ++pageIndex)
+		{
+			if (packers[pageIndex].Insert(paddedSize, paddedMins))
+			{
+				sprite.m_pageIndex = pageIndex;
+				break;
+			}
+		}
+		if (sprite.m_pageIndex < 0)
+		{
+			// An image bigger than a page fills a page of exactly its size, nothing else fits there
+			bool isOversized = paddedSize.x > config.m_pageDimensions.x || paddedSize.y > config.m_pageDimensions.y;
+			IntVec2 binDimensions = isOversized ? paddedSize : config.m_pageDimensions;
+			packers.emplace_back();
+			packers.back().Reset(binDimensions);
+			packers.back().Insert(paddedSize, paddedMins);
+			sprite.m_pageIndex = static_cast<int>(packers.size()) - 1;
+		}
+		sprite.m_texelMins = IntVec2(paddedMins.x + padding, paddedMins.y + padding);
+	}
+
+	atlas.m_pages.resize(packers.size());
+	for (int pageIndex = 0; pageIndex < static_cast<int>(packers.size()); ++pageIndex)
+	{
+		IntVec2 pageDimensions = packers[pageIndex].GetBinDimensions();
+		if (config.m_trimToPowerOfTwo)
+		{
+			IntVec2 usedDimensions = packers[pageIndex].GetUsedDimensions();
+			pageDimensions.x = std::min(GetNextPowerOfTwo(usedDimensions.x), pageDimensions.x);
+			pageDimensions.y = std::min(GetNextPowerOfTwo(usedDimensions.y), pageDimensions.y);
+		}
+		std::string pageName = Stringf("%s_Page%d", atlasName, pageIndex);
+		atlas.m_pages[pageIndex].m_image = Image(pageDimensions, Rgba8(0, 0, 0, 0), pageName.c_str());
+	}
+
+	// Sprites go onto their pages in input order, so sprite indexes in a page follow it too
+	int const extrusion = config.m_extrudeEdges ? padding : 0;
+	for (int imageIndex = 0; imageIndex < numImages; ++imageIndex)
+	{
+		Image const& image = *images[imageIndex];
+		TextureAtlasSprite& sprite = atlas.m_sprites[imageIndex];
+		TextureAtlasPage& page = atlas.m_pages[sprite.m_pageIndex];
+
+		IntVec2 const dimensions = sprite.m_dimensions;
+		for (int y = -extrusion; y < dimensions.y + extrusion; ++y)
+		{
+			int sourceY = std::clamp(y, 0, dimensions.y - 1);
+			for (int x = -extrusion; x < dimensions.x + extrusion; ++x)
+			{
+				int sourceX = std::clamp(x, 0, dimensions.x - 1);
+				page.m_image.SetTexelColor(sprite.m_texelMins + IntVec2(x, y), image.GetTexelColor(IntVec2(sourceX, sourceY)));
+			}
+		}
+
+		Vec2 const pageDimensions(static_cast<float>(page.m_image.GetDimensions().x), static_cast<float>(page.m_image.GetDimensions().y));
+		Vec2 const uvMins(static_cast<float>(sprite.m_texelMins.x) / pageDimensions.x, static_cast<float>(sprite.m_texelMins.y) / pageDimensions.y);
+		Vec2 const uvMaxs(static_cast<float>(sprite.m_texelMins.x + dimensions.x) / pageDimensions.x, static_cast<float>(sprite.m_texelMins.y + dimensions.y) / pageDimensions.y);
+		sprite.m_spriteIndex = static_cast<int>(page.m_spriteUVs.size());
+		page.m_spriteUVs.push_back(AABB2(uvMins, uvMaxs));
+		page.m_numSpriteTexels += dimensions.x * dimensions.y;
+	}
+	return atlas;
+}
+
+TextureAtlas BuildTextureAtlasFromFiles(std::vector<std::string> const& imageFilePaths, TextureAtlasConfig const& config /*= TextureAtlasConfig()*/, char const* atlasName /*= "TextureAtlas"*/)
+{
+	std::vector<Image> images = LoadImagesFromFiles(imageFilePaths);
+
+	std::vector<Image const*> imagePointers;
+	imagePointers.reserve(images.size());
+	for (Image const& image : images)
+	{
+		imagePointers.push_back(&image);
+	}
+	return BuildTextureAtlas(imagePointers, config, atlasName);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// MaxRects bin packer: keeps every maximal free rectangle of the bin, places a rectangle where it
+// leaves the shortest leftover side, then splits and prunes the free rectangles it overlaps.
+//
+class MaxRectsPacker
+{
+public:
+	void Reset(IntVec2 const& binDimensions);
+	// False when size fits nowhere, out_mins is the placed rectangle's corner
+	bool Insert(IntVec2 const& size, IntVec2& out_mins);
+
+	IntVec2 GetBinDimensions() const { return m_binDimensions; }
+	IntVec2 GetUsedDimensions() const { return m_usedDimensions; } // bounds of everything placed
+	int GetUsedArea() const { return m_usedArea; }
+	float GetOccupancy() const;
+
+protected:
+	struct FreeRect
+	{
+		IntVec2 m_mins;
+		IntVec2 m_size;
+	};
+
+	void SplitFreeRects(IntVec2 const& placedMins, IntVec2 const& placedSize);
+	void PruneFreeRects();
+
+protected:
+	IntVec2					m_binDimensions;
+	IntVec2					m_usedDimensions;
+	int						m_usedArea = 0;
+	std::vector<FreeRect>	m_freeRects;
+	std::vector<FreeRect>	m_newFreeRects;	// scratch for SplitFreeRects
+};
+
+//-----------------------------------------------------------------------------------------------
+struct TextureAtlasConfig
+{
+	IntVec2	m_pageDimensions = IntVec2(2048, 2048);	// largest page, bigger images get a page of their own
+	int		m_padding = 2;							// texels between sprites
+	bool	m_extrudeEdges = true;					// fill the padding with the sprite's edge texels, so filtering does not bleed
+	bool	m_trimToPowerOfTwo = true;				// pages shrink to the power of two that holds their sprites
+};
+
+struct TextureAtlasSprite
+{
+	std::string	m_name;				// image file path
+	int			m_pageIndex = -1;
+	int			m_spriteIndex = -1;	// in the page, for SpriteSheet
+	IntVec2		m_texelMins;
+	IntVec2		m_dimensions;
+};
+
+struct TextureAtlasPage
+{
+	Image				m_image;		// give to Renderer::CreateOrGetTextureFromImage
+	std::vector<AABB2>	m_spriteUVs;	// give to the SpriteSheet constructor with the page texture
+	int					m_numSpriteTexels = 0;
+
+	float GetOccupancy() const;	// sprite texels over page texels, padding not counted
+};
+
+//-----------------------------------------------------------------------------------------------
+// Images packed into as few pages as fit, largest first. Sprites keep the order images were given
+// in, so sprite i is image i.
+//
+// Usage:
+//	TextureAtlas atlas = BuildTextureAtlasFromFiles(spriteFilePaths);
+//	Texture* pageTexture = renderer->CreateOrGetTextureFromImage(atlas.m_pages[0].m_image);
+//	SpriteSheet pageSheet(*pageTexture, atlas.m_pages[0].m_spriteUVs);
+//
+struct TextureAtlas
+{
+	std::vector<TextureAtlasPage>		m_pages;
+	std::vector<TextureAtlasSprite>		m_sprites;
+
+	int FindSprite(std::string const& name) const; // -1 if not there
+	float GetOccupancy() const;
+	std::string GetStatsString() const;
+};
+
+TextureAtlas BuildTextureAtlas(std::vector<Image const*> const& images, TextureAtlasConfig const& config = TextureAtlasConfig(), char const* atlasName = "TextureAtlas");
+TextureAtlas BuildTextureAtlasFromFiles(std::vector<std::string> const& imageFilePaths, TextureAtlasConfig const& config = TextureAtlasConfig(), char const* atlasName = "TextureAtlas");
@@ -0,0 +1,1260 @@
+#include "Engine/Renderer/TextureCook.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Rows of texels per mip filtering task, rows of 4x4 blocks per encoding task
+	constexpr int TEXEL_ROWS_PER_BAND = 32;
+	constexpr int BLOCK_ROWS_PER_BAND = 4;
+
+	template <typename BandFunction>
+	void ForEachBand(int numRows, int rowsPerBand, WorkerPool* workers, BandFunction const& bandFunction)
+	{
+		int numBands = (numRows + rowsPerBand - 1) / rowsPerBand;
+		if (workers && numBands > 1)
+		{
+			workers->ParallelFor(numBands, [&bandFunction, numRows, rowsPerBand](int bandIndex)
+				{
+					int firstRow = bandIndex * rowsPerBand;
+					int endRow = (firstRow + rowsPerBand < numRows) ? firstRow + rowsPerBand : numRows;
+					bandFunction(firstRow, endRow);
+				});
+		}
+		else if (numRows > 0)
+		{
+			bandFunction(0, numRows);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// sRGB transfer function both ways, 14 bits of linear keep the darkest bytes exact
+	constexpr int LINEAR_TABLE_SIZE = 16384;
+
+	struct SRGBTables
+	{
+		float	m_toLinear[256];
+		uint8_t	m_fromLinear[LINEAR_TABLE_SIZE];
+
+		SRGBTables()
+		{
+			for (int index = 0; index < 256; ++index)
+			{
+				float encoded = static_cast<float>(index) / 255.f;
+				m_toLinear[index] = (encoded <= 0.04045f) ? encoded / 12.92f : powf((encoded + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int index = 0; index < LINEAR_TABLE_SIZE; ++index)
+			{
+				float linear = static_cast<float>(index) / static_cast<float>(LINEAR_TABLE_SIZE - 1);
+				float encoded = (linear <= 0.0031308f) ? linear * 12.92f : 1.055f * powf(linear, 1.f / 2.4f) - 0.055f;
+				m_fromLinear[index] = static_cast<uint8_t>(encoded * 255.f + 0.5f);
+			}
+		}
+	};
+
+	SRGBTables const& GetSRGBTables()
+	{
+		static SRGBTables const s_tables;
+		return s_tables;
+	}
+
+	inline float Clamp01(float value)
+	{
+		return (value < 0.f) ? 0.f : ((value > 1.f) ? 1.f : value);
+	}
+
+	inline uint8_t ToByte(float value01)
+	{
+		return static_cast<uint8_t>(Clamp01(value01) * 255.f + 0.5f);
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// Premultiplied rgba floats in 0 to 1, linear light when the source was sRGB, Image row order
+	struct LinearImage
+	{
+		IntVec2				m_dimensions;
+		std::vector<float>	m_values;
+	};
+
+	LinearImage ConvertToLinear(Image const& image, bool isSRGB, WorkerPool* workers)
+	{
+		LinearImage linear;
+		linear.m_dimensions = image.GetDimensions();
+		linear.m_values.resize(4 * static_cast<size_t>(linear.m_dimensions.x) * linear.m_dimensions.y);
+
+		SRGBTables const& tables = GetSRGBTables();
+		Rgba8 const* texels = image.GetRawTexels();
+		int width = linear.m_dimensions.x;
+		ForEachBand(linear.m_dimensions.y, TEXEL_ROWS_PER_BAND, workers, [&](int firstRow, int endRow)
+			{
+				for (size_t texelIndex = static_cast<size_t>(firstRow) * width; texelIndex < static_cast<size_t>(endRow) * width; ++texelIndex)
+				{
+					Rgba8 const& texel = texels[texelIndex];
+					float* values = &linear.m_values[4 * texelIndex];
+					float alpha = static_cast<float>(texel.a) / 255.f;
+					values[0] = (isSRGB ? tables.m_toLinear[texel.r] : static_cast<float>(texel.r) / 255.f) * alpha;
+					values[1] = (isSRGB ? tables.m_toLinear[texel.g] : static_cast<float>(texel.g) / 255.f) * alpha;
+					values[2] = (isSRGB ? tables.m_toLinear[texel.b] : static_cast<float>(texel.b) / 255.f) * alpha;
+					values[3] = alpha;
+				}
+			});
+		return linear;
+	}
+
+	Image ConvertFromLinear(LinearImage const& linear, bool isSRGB, std::string const& imageFilePath, WorkerPool* workers)
+	{
+		Image image(linear.m_dimensions, Rgba8(0, 0, 0, 0), imageFilePath.c_str());
+
+		SRGBTables const& tables = GetSRGBTables();
+		Rgba8* texels = image.GetRawTexels();
+		int width = linear.m_dimensions.x;
+		ForEachBand(linear.m_dimensions.y, TEXEL_ROWS_PER_BAND, workers, [&](int firstRow, int endRow)
+			{
+				for (size_t texelIndex = static_cast<size_t>(firstRow) * width; texelIndex < static_cast<size_t>(endRow) * width; ++texelIndex)
+				{
+					float const* values = &linear.m_values[4 * texelIndex];
+					float alpha = Clamp01(values[3]);
+					float unpremultiply = (alpha > 0.f) ? 1.f / alpha : 0.f;
+					uint8_t bytes[3];
+					for (int channel = 0; channel < 3; ++channel)
+					{
+						float value = Clamp01(values[channel] * unpremultiply);
+						bytes[channel] = isSRGB ? tables.m_fromLinear[static_cast<int>(value * static_cast<float>(LINEAR_TABLE_SIZE - 1) + 0.5f)] : ToByte(value);
+					}
+					Rgba8& texel = texels[texelIndex];
+					texel.r = bytes[0];
+					texel.g = bytes[1];
+					texel.b = bytes[2];
+					texel.a = ToByte(alpha);
+				}
+			});
+		return image;
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// Source texels and weights of every destination texel along one axis, m_maxTaps apart
+	struct DownsampleTaps
+	{
+		int					m_maxTaps = 0;
+		std::vector<int>	m_firstSource;
+		std::vector<int>	m_numTaps;
+		std::vector<float>	m_weights;
+	};
+
+	// Kaiser window reaching 2 destination texels out, alpha 4 as in most mip tools
+	constexpr float KAISER_RADIUS = 2.f;
+	constexpr float KAISER_ALPHA = 4.f;
+
+	float BesselI0(float x)
+	{
+		float sum = 1.f;
+		float term = 1.f;
+		float halfX = 0.5f * x;
+		for (int k = 1; k < 20; ++k)
+		{
+			term *= (halfX / static_cast<float>(k)) * (halfX / static_cast<float>(k));
+			sum += term;
+			if (term < sum * 1e-7f)
+			{
+				break;
+			}
+		}
+		return sum;
+	}
+
+	float KaiserSinc(float distance)
+	{
+		constexpr float PI = 3.14159265358979f;
+		float windowPosition = distance / KAISER_RADIUS;
+		if (windowPosition <= -1.f || windowPosition >= 1.f)
+		{
+			return 0.f;
+		}
+		float sinc = (fabsf(distance) < 1e-5f) ? 1.f : sinf(PI * distance) / (PI * distance);
+		return sinc * BesselI0(KAISER_ALPHA * sqrtf(1.f - windowPosition * windowPosition)) / BesselI0(KAISER_ALPHA);
+	}
+
+	DownsampleTaps MakeDownsampleTaps(int sourceSize, int destSize, MipFilter filter)
+	{
+		float scale = static_cast<float>(sourceSize) / static_cast<float>(destSize);
+		float radius = (filter == MipFilter::BOX) ? 0.5f * scale : KAISER_RADIUS * scale;
+
+		DownsampleTaps taps;
+		taps.m_maxTaps = static_cast<int>(ceilf(2.f * radius)) + 2;
+		taps.m_firstSource.resize(destSize);
+		taps.m_numTaps.resize(destSize);
+		taps.m_weights.assign(static_cast<size_t>(destSize) * taps.m_maxTaps, 0.f);
+
+		for (int destIndex = 0; destIndex < destSize; ++destIndex)
+		{
+			float center = (static_cast<float>(destIndex) + 0.5f) * scale;
+			int firstSource = std::max(static_cast<int>(floorf(center - radius)), 0);
+			int endSource = std::min(static_cast<int>(ceilf(center + radius)), sourceSize);
+			float* weights = &taps.m_weights[static_cast<size_t>(destIndex) * taps.m_maxTaps];
+
+			// Taps outside the image are dropped and the rest renormalized, like ImageProcessing
+			int numTaps = 0;
+			float weightSum = 0.f;
+			for (int sourceIndex = firstSource; sourceIndex < endSource && numTaps < taps.m_maxTaps; ++sourceIndex)
+			{
+				float weight = 0.f;
+				if (filter == MipFilter::BOX)
+				{
+					float coverageMin = std::max(static_cast<float>(sourceIndex), center - radius);
+					float coverageMax = std::min(static_cast<float>(sourceIndex + 1), center + radius);
+					weight = std::max(coverageMax - coverageMin, 0.f);
+				}
+				else
+				{
+					weight = KaiserSinc((static_cast<float>(sourceIndex) + 0.5f - center) / scale);
+				}
+				weights[numTaps++] = weight;
+				weightSum += weight;
+			}
+			if (weightSum != 0.f)
+			{
+				for (int tapIndex = 0; tapIndex < numTaps; ++tapIndex)
+				{
+					weights[tapIndex] /= weightSum;
+				}
+			}
+			taps.m_firstSource[destIndex] = firstSource;
+			taps.m_numTaps[destIndex] = numTaps;
+		}
+		return taps;
+	}
+
+	// Horizontal pass into a dest width by source height intermediate, then a vertical pass
+	// adding whole intermediate rows
+	LinearImage Downsample(LinearImage const& source, IntVec2 const& destDimensions, MipFilter filter, WorkerPool* workers)
+	{
+		int sourceWidth = source.m_dimensions.x;
+		int destWidth = destDimensions.x;
+		DownsampleTaps columnTaps = MakeDownsampleTaps(sourceWidth, destWidth, filter);
+		DownsampleTaps rowTaps = MakeDownsampleTaps(source.m_dimensions.y, destDimensions.y, filter);
+
+		std::vector<float> intermediate(4 * static_cast<size_t>(destWidth) * source.m_dimensions.y);
+		ForEachBand(source.m_dimensions.y, TEXEL_ROWS_PER_BAND, workers, [&](int firstRow, int endRow)
+			{
+				for (int rowIndex = firstRow; rowIndex < endRow; ++rowIndex)
+				{
+					float const* sourceRow = &source.m_values[4 * static_cast<size_t>(rowIndex) * sourceWidth];
+					float* destRow = &intermediate[4 * static_cast<size_t>(rowIndex) * destWidth];
+					for (int destX = 0; destX < destWidth; ++destX)
+					{
+						float const* weights = &columnTaps.m_weights[static_cast<size_t>(destX) * columnTaps.m_maxTaps];
+						float const* sourceTexel = sourceRow + 4 * columnTaps.m_firstSource[destX];
+						float sum[4] = { 0.f, 0.f, 0.f, 0.f };
+						for (int tapIndex = 0; tapIndex < columnTaps.m_numTaps[destX]; ++tapIndex, sourceTexel += 4)
+						{
+							for (int channel = 0; channel < 4; ++channel)
+							{
+								sum[channel] += sourceTexel[channel] * weights[tapIndex];
+							}
+						}
+						memcpy(destRow + 4 * destX, sum, sizeof(sum));
+					}
+				}
+			});
+
+		LinearImage dest;
+		dest.m_dimensions = destDimensions;
+		dest.m_values.assign(4 * static_cast<size_t>(destWidth) * destDimensions.y, 0.f);
+		size_t rowValues = 4 * static_cast<size_t>(destWidth);
+		ForEachBand(destDimensions.y, TEXEL_ROWS_PER_BAND, workers, [&](int firstRow, int endRow)
+			{
+				for (int destY = firstRow; destY < endRow; ++destY)
+				{
+					float* destRow = &dest.m_values[destY * rowValues];
+					float const* weights = &rowTaps.m_weights[static_cast<size_t>(destY) * rowTaps.m_maxTaps];
+					for (int tapIndex = 0; tapIndex < rowTaps.m_numTaps[destY]; ++tapIndex)
+					{
+						float const* sourceRow = &intermediate[(rowTaps.m_firstSource[destY] + tapIndex) * rowValues];
+						float weight = weights[tapIndex];
+						for (size_t valueIndex = 0; valueIndex < rowValues; ++valueIndex)
+						{
+							destRow[valueIndex] += sourceRow[valueIndex] * weight;
+						}
+					}
+				}
+			});
+		return dest;
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// Shared by the block encoders: 16 texels as floats in 0 to 255
+	typedef float BlockValues[16][4];
+
+	void GetBlockValues(Rgba8 const texels[16], BlockValues& out_values)
+	{
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			out_values[texelIndex][0] = static_cast<float>(texels[texelIndex].r);
+			out_values[texelIndex][1] = static_cast<float>(texels[texelIndex].g);
+			out_values[texelIndex][2] = static_cast<float>(texels[texelIndex].b);
+			out_values[texelIndex][3] = static_cast<float>(texels[texelIndex].a);
+		}
+	}
+
+	// Ends of the selected texels' range along their principal axis, found by power iteration
+	// from the bounding box diagonal. A flat block gets its mean as both ends
+	void FindPrincipalEndpoints(BlockValues const& values, bool const isSelected[16], int numChannels, float out_start[4], float out_end[4])
+	{
+		float mean[4] = {};
+		float minimum[4] = { 255.f, 255.f, 255.f, 255.f };
+		float maximum[4] = {};
+		int numSelected = 0;
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			if (isSelected && !isSelected[texelIndex])
+			{
+				continue;
+			}
+			++numSelected;
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				mean[channel] += values[texelIndex][channel];
+				minimum[channel] = std::min(minimum[channel], values[texelIndex][channel]);
+				maximum[channel] = std::max(maximum[channel], values[texelIndex][channel]);
+			}
+		}
+		for (int channel = 0; channel < 4; ++channel)
+		{
+			mean[channel] = (numSelected > 0) ? mean[channel] / static_cast<float>(numSelected) : 0.f;
+			out_start[channel] = mean[channel];
+			out_end[channel] = mean[channel];
+		}
+
+		float covariance[4][4] = {};
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			if (isSelected && !isSelected[texelIndex])
+			{
+				continue;
+			}
+			for (int row = 0; row < numChannels; ++row)
+			{
+				for (int column = 0; column < numChannels; ++column)
+				{
+					covariance[row][column] += (values[texelIndex][row] - mean[row]) * (values[texelIndex][column] - mean[column]);
+				}
+			}
+		}
+
+		float axis[4] = {};
+		float axisLength = 0.f;
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			axis[channel] = maximum[channel] - minimum[channel];
+			axisLength += axis[channel] * axis[channel];
+		}
+		if (axisLength <= 0.f)
+		{
+			return;
+		}
+		for (int iteration = 0; iteration < 8; ++iteration)
+		{
+			float next[4] = {};
+			float nextLength = 0.f;
+			for (int row = 0; row < numChannels; ++row)
+			{
+				for (int column = 0; column < numChannels; ++column)
+				{
+					next[row] += covariance[row][column] * axis[column];
+				}
+				nextLength += next[row] * next[row];
+			}
+			if (nextLength <= 0.f)
+			{
+				break;
+			}
+			float scale = 1.f / sqrtf(nextLength);
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				axis[channel] = next[channel] * scale;
+			}
+		}
+		axisLength = 0.f;
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			axisLength += axis[channel] * axis[channel];
+		}
+		float normalize = 1.f / sqrtf(axisLength);
+
+		float minProjection = 0.f;
+		float maxProjection = 0.f;
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			if (isSelected && !isSelected[texelIndex])
+			{
+				continue;
+			}
+			float projection = 0.f;
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				projection += (values[texelIndex][channel] - mean[channel]) * axis[channel] * normalize;
+			}
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			out_start[channel] = std::clamp(mean[channel] + axis[channel] * normalize * minProjection, 0.f, 255.f);
+			out_end[channel] = std::clamp(mean[channel] + axis[channel] * normalize * maxProjection, 0.f, 255.f);
+		}
+	}
+
+	// Best endpoints in the least squares sense for the chosen indexes, texel = lerp(start, end, weight).
+	// False when every selected texel uses the same weight
+	bool SolveEndpoints(BlockValues const& values, bool const isSelected[16], float const weights[16], int numChannels, float out_start[4], float out_end[4])
+	{
+		float startStart = 0.f;
+		float startEnd = 0.f;
+		float endEnd = 0.f;
+		float startSum[4] = {};
+		float endSum[4] = {};
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			if (isSelected && !isSelected[texelIndex])
+			{
+				continue;
+			}
+			float endWeight = weights[texelIndex];
+			float startWeight = 1.f - endWeight;
+			startStart += startWeight * startWeight;
+			startEnd += startWeight * endWeight;
+			endEnd += endWeight * endWeight;
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				startSum[channel] += startWeight * values[texelIndex][channel];
+				endSum[channel] += endWeight * values[texelIndex][channel];
+			}
+		}
+		float determinant = startStart * endEnd - startEnd * startEnd;
+		if (fabsf(determinant) < 1e-6f)
+		{
+			return false;
+		}
+		float inverse = 1.f / determinant;
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			out_start[channel] = std::clamp((endEnd * startSum[channel] - startEnd * endSum[channel]) * inverse, 0.f, 255.f);
+			out_end[channel] = std::clamp((startStart * endSum[channel] - startEnd * startSum[channel]) * inverse, 0.f, 255.f);
+		}
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// BC1 color: two 565 endpoints and 2 bit indexes. c0 > c1 is the 4 color mode, otherwise
+	// 3 colors and transparent black, which BC3's color half never uses
+	uint16_t PackRgb565(float const rgb[3])
+	{
+		int r = std::clamp(static_cast<int>(rgb[0] * 31.f / 255.f + 0.5f), 0, 31);
+		int g = std::clamp(static_cast<int>(rgb[1] * 63.f / 255.f + 0.5f), 0, 63);
+		int b = std::clamp(static_cast<int>(rgb[2] * 31.f / 255.f + 0.5f), 0, 31);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void UnpackRgb565(uint16_t packed, int out_rgb[3])
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		out_rgb[0] = (r << 3) | (r >> 2);
+		out_rgb[1] = (g << 2) | (g >> 4);
+		out_rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	// Returns true if the fourth entry is transparent black
+	bool BuildColorPalette(uint16_t color0, uint16_t color1, bool isAlwaysFourColor, int out_palette[4][4])
+	{
+		UnpackRgb565(color0, out_palette[0]);
+		UnpackRgb565(color1, out_palette[1]);
+		out_palette[0][3] = 255;
+		out_palette[1][3] = 255;
+		out_palette[2][3] = 255;
+		bool isFourColor = isAlwaysFourColor || color0 > color1;
+		for (int channel = 0; channel < 3; ++channel)
+		{
+			int value0 = out_palette[0][channel];
+			int value1 = out_palette[1][channel];
+			if (isFourColor)
+			{
+				out_palette[2][channel] = (2 * value0 + value1 + 1) / 3;
+				out_palette[3][channel] = (value0 + 2 * value1 + 1) / 3;
+			}
+			else
+			{
+				out_palette[2][channel] = (value0 + value1 + 1) / 2;
+				out_palette[3][channel] = 0;
+			}
+		}
+		out_palette[3][3] = isFourColor ? 255 : 0;
+		return !isFourColor;
+	}
+
+	struct ColorBlockFit
+	{
+		uint16_t	m_color0 = 0;
+		uint16_t	m_color1 = 0;
+		uint8_t		m_indexes[16] = {};
+		float		m_error = 0.f;
+	};
+
+	ColorBlockFit FitColorBlock(BlockValues const& values, bool const isOpaque[16], bool useTransparentMode, bool isAlwaysFourColor, float const start[4], float const end[4])
+	{
+		ColorBlockFit fit;
+		fit.m_color0 = PackRgb565(start);
+		fit.m_color1 = PackRgb565(end);
+		if (useTransparentMode ? (fit.m_color0 > fit.m_color1) : (fit.m_color0 < fit.m_color1))
+		{
+			std::swap(fit.m_color0, fit.m_color1);
+		}
+
+		int palette[4][4];
+		bool hasTransparentEntry = BuildColorPalette(fit.m_color0, fit.m_color1, isAlwaysFourColor, palette);
+		int numColorEntries = hasTransparentEntry ? 3 : 4;
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			if (!isOpaque[texelIndex])
+			{
+				fit.m_indexes[texelIndex] = 3;
+				continue;
+			}
+			float bestError = 1e30f;
+			for (int entryIndex = 0; entryIndex < numColorEntries; ++entryIndex)
+			{
+				float error = 0.f;
+				for (int channel = 0; channel < 3; ++channel)
+				{
+					float difference = values[texelIndex][channel] - static_cast<float>(palette[entryIndex][channel]);
+					error += difference * difference;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					fit.m_indexes[texelIndex] = static_cast<uint8_t>(entryIndex);
+				}
+			}
+			fit.m_error += bestError;
+		}
+		return fit;
+	}
+
+	void EncodeColorBlock(Rgba8 const texels[16], bool isBC1, uint8_t out_block[8])
+	{
+		BlockValues values;
+		GetBlockValues(texels, values);
+		bool isOpaque[16];
+		bool hasTransparent = false;
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			isOpaque[texelIndex] = !isBC1 || texels[texelIndex].a >= 128;
+			hasTransparent |= !isOpaque[texelIndex];
+		}
+
+		float start[4];
+		float end[4];
+		FindPrincipalEndpoints(values, isOpaque, 3, start, end);
+		ColorBlockFit best = FitColorBlock(values, isOpaque, hasTransparent, !isBC1, start, end);
+
+		// Two rounds of refitting the endpoints to the chosen indexes
+		for (int iteration = 0; iteration < 2 && best.m_error > 0.f; ++iteration)
+		{
+			int palette[4][4];
+			bool isThreeColor = BuildColorPalette(best.m_color0, best.m_color1, !isBC1, palette);
+			float const fourColorWeights[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+			float const threeColorWeights[4] = { 0.f, 1.f, 0.5f, 0.f };
+			float weights[16];
+			for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+			{
+				weights[texelIndex] = isThreeColor ? threeColorWeights[best.m_indexes[texelIndex]] : fourColorWeights[best.m_indexes[texelIndex]];
+			}
+			if (!SolveEndpoints(values, isOpaque, weights, 3, start, end))
+			{
+				break;
+			}
+			ColorBlockFit refit = FitColorBlock(values, isOpaque, hasTransparent, !isBC1, start, end);
+			if (refit.m_error >= best.m_error)
+			{
+				break;
+			}
+			best = refit;
+		}
+
+		uint32_t indexBits = 0;
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			indexBits |= static_cast<uint32_t>(best.m_indexes[texelIndex]) << (2 * texelIndex);
+		}
+		out_block[0] = static_cast<uint8_t>(best.m_color0);
+		out_block[1] = static_cast<uint8_t>(best.m_color0 >> 8);
+		out_block[2] = static_cast<uint8_t>(best.m_color1);
+		out_block[3] = static_cast<uint8_t>(best.m_color1 >> 8);
+		for (int byteIndex = 0; byteIndex < 4; ++byteIndex)
+		{
+			out_block[4 + byteIndex] = static_cast<uint8_t>(indexBits >> (8 * byteIndex));
+		}
+	}
+
+	void DecodeColorBlock(uint8_t const block[8], bool isBC1, Rgba8 out_texels[16])
+	{
+		uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+		uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+		int palette[4][4];
+		BuildColorPalette(color0, color1, !isBC1, palette);
+		uint32_t indexBits = static_cast<uint32_t>(block[4]) | (static_cast<uint32_t>(block[5]) << 8) | (static_cast<uint32_t>(block[6]) << 16) | (static_cast<uint32_t>(block[7]) << 24);
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			int const* entry = palette[(indexBits >> (2 * texelIndex)) & 3];
+			out_texels[texelIndex] = Rgba8(static_cast<unsigned char>(entry[0]), static_cast<unsigned char>(entry[1]), static_cast<unsigned char>(entry[2]), static_cast<unsigned char>(entry[3]));
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// BC3 alpha: two 8 bit endpoints and 3 bit indexes. a0 > a1 interpolates 6 values between
+	// them, otherwise 4 values plus exact 0 and 255
+	void BuildAlphaPalette(int alpha0, int alpha1, int out_palette[8])
+	{
+		out_palette[0] = alpha0;
+		out_palette[1] = alpha1;
+		if (alpha0 > alpha1)
+		{
+			for (int entryIndex = 2; entryIndex < 8; ++entryIndex)
+			{
+				out_palette[entryIndex] = ((8 - entryIndex) * alpha0 + (entryIndex - 1) * alpha1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int entryIndex = 2; entryIndex < 6; ++entryIndex)
+			{
+				out_palette[entryIndex] = ((6 - entryIndex) * alpha0 + (entryIndex - 1) * alpha1 + 2) / 5;
+			}
+			out_palette[6] = 0;
+			out_palette[7] = 255;
+		}
+	}
+
+	int FitAlphaBlock(Rgba8 const texels[16], int alpha0, int alpha1, uint64_t& out_indexBits)
+	{
+		int palette[8];
+		BuildAlphaPalette(alpha0, alpha1, palette);
+		int totalError = 0;
+		out_indexBits = 0;
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			int bestError = 1 << 30;
+			int bestEntry = 0;
+			for (int entryIndex = 0; entryIndex < 8; ++entryIndex)
+			{
+				int difference = static_cast<int>(texels[texelIndex].a) - palette[entryIndex];
+				if (difference * difference < bestError)
+				{
+					bestError = difference * difference;
+					bestEntry = entryIndex;
+				}
+			}
+			totalError += bestError;
+			out_indexBits |= static_cast<uint64_t>(bestEntry) << (3 * texelIndex);
+		}
+		return totalError;
+	}
+
+	void EncodeAlphaBlock(Rgba8 const texels[16], uint8_t out_block[8])
+	{
+		int minAlpha = 255;
+		int maxAlpha = 0;
+		int minInnerAlpha = 255;
+		int maxInnerAlpha = 0;
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			int alpha = texels[texelIndex].a;
+			minAlpha = std::min(minAlpha, alpha);
+			maxAlpha = std::max(maxAlpha, alpha);
+			if (alpha != 0 && alpha != 255)
+			{
+				minInnerAlpha = std::min(minInnerAlpha, alpha);
+				maxInnerAlpha = std::max(maxInnerAlpha, alpha);
+			}
+		}
+
+		// Full range with 8 entries, and when the block reaches 0 or 255 the 6 entry mode spanning
+		// only the values between, keep whichever is closer
+		int alpha0 = maxAlpha;
+		int alpha1 = minAlpha;
+		uint64_t indexBits = 0;
+		int error = FitAlphaBlock(texels, alpha0, alpha1, indexBits);
+		if (error > 0 && (minAlpha == 0 || maxAlpha == 255))
+		{
+			if (minInnerAlpha > maxInnerAlpha)
+			{
+				minInnerAlpha = maxInnerAlpha = 0;
+			}
+			uint64_t innerIndexBits = 0;
+			int innerError = FitAlphaBlock(texels, minInnerAlpha, maxInnerAlpha, innerIndexBits);
+			if (innerError < error)
+			{
+				alpha0 = minInnerAlpha;
+				alpha1 = maxInnerAlpha;
+				indexBits = innerIndexBits;
+			}
+		}
+
+		out_block[0] = static_cast<uint8_t>(alpha0);
+		out_block[1] = static_cast<uint8_t>(alpha1);
+		for (int byteIndex = 0; byteIndex < 6; ++byteIndex)
+		{
+			out_block[2 + byteIndex] = static_cast<uint8_t>(indexBits >> (8 * byteIndex));
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// BC7 mode 6: one subset, 7 bit rgba endpoints with a p bit each, 4 bit indexes
+	constexpr int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct Mode6Fit
+	{
+		int		m_endpoints[2][4] = {};	// 8 bit, the low bit is the p bit
+		uint8_t	m_indexes[16] = {};
+		float	m_error = 0.f;
+	};
+
+	// The p bit shared by all four channels of one endpoint, whichever lands closer
+	void QuantizeMode6Endpoint(float const endpoint[4], bool isOpaque, int out_endpoint[4])
+	{
+		float bestError = 1e30f;
+		for (int pBit = isOpaque ? 1 : 0; pBit < 2; ++pBit)
+		{
+			int quantized[4];
+			float error = 0.f;
+			for (int channel = 0; channel < 4; ++channel)
+			{
+				int value = std::clamp(static_cast<int>((endpoint[channel] - static_cast<float>(pBit)) * 0.5f + 0.5f), 0, 127);
+				quantized[channel] = (value << 1) | pBit;
+				float difference = static_cast<float>(quantized[channel]) - endpoint[channel];
+				error += difference * difference;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				memcpy(out_endpoint, quantized, sizeof(quantized));
+			}
+		}
+	}
+
+	Mode6Fit FitMode6(BlockValues const& values, bool isOpaque, float const start[4], float const end[4])
+	{
+		Mode6Fit fit;
+		QuantizeMode6Endpoint(start, isOpaque, fit.m_endpoints[0]);
+		QuantizeMode6Endpoint(end, isOpaque, fit.m_endpoints[1]);
+
+		float palette[16][4];
+		for (int entryIndex = 0; entryIndex < 16; ++entryIndex)
+		{
+			for (int channel = 0; channel < 4; ++channel)
+			{
+				palette[entryIndex][channel] = static_cast<float>(((64 - BC7_WEIGHTS4[entryIndex]) * fit.m_endpoints[0][channel] + BC7_WEIGHTS4[entryIndex] * fit.m_endpoints[1][channel] + 32) >> 6);
+			}
+		}
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			float bestError = 1e30f;
+			for (int entryIndex = 0; entryIndex < 16; ++entryIndex)
+			{
+				float error = 0.f;
+				for (int channel = 0; channel < 4; ++channel)
+				{
+					float difference = values[texelIndex][channel] - palette[entryIndex][channel];
+					error += difference * difference;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					fit.m_indexes[texelIndex] = static_cast<uint8_t>(entryIndex);
+				}
+			}
+			fit.m_error += bestError;
+		}
+		return fit;
+	}
+
+	struct BitWriter
+	{
+		uint8_t*	m_bytes = nullptr;	// zeroed by the caller
+		int			m_bitPosition = 0;
+
+		void Write(uint32_t value, int numBits)
+		{
+			for (int bitIndex = 0; bitIndex < numBits; ++bitIndex, ++m_bitPosition)
+			{
+				if ((value >> bitIndex) & 1)
+				{
+					m_bytes[m_bitPosition >> 3] |= static_cast<uint8_t>(1 << (m_bitPosition & 7));
+				}
+			}
+		}
+	};
+
+	struct BitReader
+	{
+		uint8_t const*	m_bytes = nullptr;
+		int				m_bitPosition = 0;
+
+		uint32_t Read(int numBits)
+		{
+			uint32_t value = 0;
+			for (int bitIndex = 0; bitIndex < numBits; ++bitIndex, ++m_bitPosition)
+			{
+				value |= static_cast<uint32_t>((m_bytes[m_bitPosition >> 3] >> (m_bitPosition & 7)) & 1) << bitIndex;
+			}
+			return value;
+		}
+	};
+
+	//-------------------------------------------------------------------------------------------
+	DXGI_FORMAT GetCookedFormat(TextureCookFormat format, bool isSRGBFormat)
+	{
+		switch (format)
+		{
+		case TextureCookFormat::BC1: return isSRGBFormat ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+		case TextureCookFormat::BC3: return isSRGBFormat ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+		case TextureCookFormat::BC7: return isSRGBFormat ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+		default: return isSRGBFormat ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+		}
+	}
+
+	// 8 or 16 for block compressed formats, 0 for RGBA8, -1 for anything LoadCookedTexture refuses
+	int GetBytesPerBlock(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			return 8;
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return 16;
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+			return 0;
+		default:
+			return -1;
+		}
+	}
+
+	// Fills in every mip's dimensions, pitch and offset, mips tightly packed largest first. Returns the total size
+	size_t ComputeMipLayout(DXGI_FORMAT format, IntVec2 const& dimensions, int numMips, std::vector<CookedTextureMip>& out_mips)
+	{
+		int bytesPerBlock = GetBytesPerBlock(format);
+		out_mips.resize(numMips);
+		size_t dataOffset = 0;
+		IntVec2 mipDimensions = dimensions;
+		for (int mipIndex = 0; mipIndex < numMips; ++mipIndex)
+		{
+			CookedTextureMip& mip = out_mips[mipIndex];
+			mip.m_dimensions = mipDimensions;
+			if (bytesPerBlock > 0)
+			{
+				mip.m_rowPitch = static_cast<uint32_t>(std::max((mipDimensions.x + 3) / 4, 1) * bytesPerBlock);
+				mip.m_numRows = static_cast<uint32_t>(std::max((mipDimensions.y + 3) / 4, 1));
+			}
+			else
+			{
+				mip.m_rowPitch = static_cast<uint32_t>(mipDimensions.x * 4);
+				mip.m_numRows = static_cast<uint32_t>(mipDimensions.y);
+			}
+			mip.m_dataOffset = dataOffset;
+			mip.m_numBytes = static_cast<size_t>(mip.m_rowPitch) * mip.m_numRows;
+			dataOffset += mip.m_numBytes;
+			mipDimensions = IntVec2(std::max(mipDimensions.x / 2, 1), std::max(mipDimensions.y / 2, 1));
+		}
+		return dataOffset;
+	}
+
+	void EncodeMip(Image const& mipImage, TextureCookFormat format, CookedTextureMip const& mip, uint8_t* out_data, WorkerPool* workers)
+	{
+		IntVec2 dimensions = mipImage.GetDimensions();
+		Rgba8 const* texels = mipImage.GetRawTexels();
+		if (format == TextureCookFormat::RGBA8)
+		{
+			memcpy(out_data, texels, mip.m_numBytes);
+			return;
+		}
+
+		int numBlocksX = static_cast<int>(mip.m_rowPitch) / ((format == TextureCookFormat::BC1) ? 8 : 16);
+		ForEachBand(static_cast<int>(mip.m_numRows), BLOCK_ROWS_PER_BAND, workers, [&](int firstBlockRow, int endBlockRow)
+			{
+				Rgba8 blockTexels[16];
+				for (int blockY = firstBlockRow; blockY < endBlockRow; ++blockY)
+				{
+					uint8_t* blockRow = out_data + static_cast<size_t>(blockY) * mip.m_rowPitch;
+					for (int blockX = 0; blockX < numBlocksX; ++blockX)
+					{
+						// Edge blocks of sizes that are not a multiple of 4 repeat the last row and column
+						for (int texelY = 0; texelY < 4; ++texelY)
+						{
+							int y = std::min(4 * blockY + texelY, dimensions.y - 1);
+							for (int texelX = 0; texelX < 4; ++texelX)
+							{
+								int x = std::min(4 * blockX + texelX, dimensions.x - 1);
+								blockTexels[4 * texelY + texelX] = texels[static_cast<size_t>(y) * dimensions.x + x];
+							}
+						}
+						switch (format)
+						{
+						case TextureCookFormat::BC1: EncodeBC1Block(blockTexels, blockRow + 8 * blockX); break;
+						case TextureCookFormat::BC3: EncodeBC3Block(blockTexels, blockRow + 16 * blockX); break;
+						default: EncodeBC7Block(blockTexels, blockRow + 16 * blockX); break;
+						}
+					}
+				}
+			});
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// DDS with the DX10 extension header, so the DXGI format is stored as is
+	constexpr uint32_t DDS_MAGIC = 0x20534444;			// "DDS "
+	constexpr uint32_t DDS_HEADER_SIZE = 124;
+	constexpr uint32_t DDS_PIXEL_FORMAT_SIZE = 32;
+	constexpr uint32_t DDS_FOURCC_DX10 = 0x30315844;	// "DX10"
+	constexpr uint32_t DDSD_CAPS = 0x1;
+	constexpr uint32_t DDSD_HEIGHT = 0x2;
+	constexpr uint32_t DDSD_WIDTH = 0x4;
+	constexpr uint32_t DDSD_PITCH = 0x8;
+	constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+	constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+	constexpr uint32_t DDPF_FOURCC = 0x4;
+	constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+	constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+	constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+	constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+	constexpr size_t DDS_DATA_OFFSET = 4 + DDS_HEADER_SIZE + 20;
+
+	// 32 bit words of the file, magic first
+	enum DDSWord
+	{
+		DDS_WORD_MAGIC = 0,
+		DDS_WORD_SIZE,
+		DDS_WORD_FLAGS,
+		DDS_WORD_HEIGHT,
+		DDS_WORD_WIDTH,
+		DDS_WORD_PITCH_OR_LINEAR_SIZE,
+		DDS_WORD_DEPTH,
+		DDS_WORD_MIP_COUNT,
+		DDS_WORD_PIXEL_FORMAT_SIZE = 19,
+		DDS_WORD_PIXEL_FORMAT_FLAGS,
+		DDS_WORD_FOURCC,
+		DDS_WORD_CAPS = 27,
+		DDS_WORD_DXGI_FORMAT = 32,
+		DDS_WORD_RESOURCE_DIMENSION,
+		DDS_WORD_MISC_FLAG,
+		DDS_WORD_ARRAY_SIZE,
+		DDS_WORD_MISC_FLAGS2,
+		NUM_DDS_WORDS
+	};
+	static_assert(NUM_DDS_WORDS * 4 == DDS_DATA_OFFSET, "DDS header words out of sync with the header sizes");
+
+	inline void WriteWord(std::vector<uint8_t>& buffer, int wordIndex, uint32_t value)
+	{
+		for (int byteIndex = 0; byteIndex < 4; ++byteIndex)
+		{
+			buffer[4 * wordIndex + byteIndex] = static_cast<uint8_t>(value >> (8 * byteIndex));
+		}
+	}
+
+	inline uint32_t ReadWord(std::vector<uint8_t> const& buffer, int wordIndex)
+	{
+		uint8_t const* bytes = &buffer[4 * wordIndex];
+		return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) | (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+std::vector<Image> GenerateMipChain(Image const& image, MipFilter filter, bool isSRGB, WorkerPool* workers)
+{
+	std::vector<Image> mips;
+	mips.push_back(image);
+
+	// Every level from the one above, in linear premultiplied floats so nothing rounds between levels
+	IntVec2 dimensions = image.GetDimensions();
+	if (dimensions.x <= 0 || dimensions.y <= 0)
+	{
+		return mips;
+	}
+	LinearImage level = ConvertToLinear(image, isSRGB, workers);
+	while (dimensions.x > 1 || dimensions.y > 1)
+	{
+		dimensions = IntVec2(std::max(dimensions.x / 2, 1), std::max(dimensions.y / 2, 1));
+		level = Downsample(level, dimensions, filter, workers);
+		mips.push_back(ConvertFromLinear(level, isSRGB, image.GetImageFilePath(), workers));
+	}
+	return mips;
+}
+
+//-----------------------------------------------------------------------------------------------
+CookedTexture CookTexture(Image const& image, TextureCookConfig const& config, WorkerPool* workers)
+{
+	CookedTexture cooked;
+	cooked.m_name = image.GetImageFilePath();
+	cooked.m_dimensions = image.GetDimensions();
+	cooked.m_format = GetCookedFormat(config.m_format, config.m_useSRGBFormat);
+
+	std::vector<Image> mips;
+	if (config.m_generateMips)
+	{
+		mips = GenerateMipChain(image, config.m_mipFilter, config.m_isSRGB, workers);
+	}
+	else
+	{
+		mips.push_back(image);
+	}
+
+	cooked.m_data.resize(ComputeMipLayout(cooked.m_format, cooked.m_dimensions, static_cast<int>(mips.size()), cooked.m_mips));
+	for (size_t mipIndex = 0; mipIndex < mips.size(); ++mipIndex)
+	{
+		CookedTextureMip const& mip = cooked.m_mips[mipIndex];
+		EncodeMip(mips[mipIndex], config.m_format, mip, cooked.m_data.data() + mip.m_dataOffset, workers);
+	}
+	return cooked;
+}
+
+//-----------------------------------------------------------------------------------------------
+void EncodeBC1Block(Rgba8 const texels[16], uint8_t out_block[8])
+{
+	EncodeColorBlock(texels, true, out_block);
+}
+
+void EncodeBC3Block(Rgba8 const texels[16], uint8_t out_block[16])
+{
+	EncodeAlphaBlock(texels, out_block);
+	EncodeColorBlock(texels, false, out_block + 8);
+}
+
+void EncodeBC7Block(Rgba8 const texels[16], uint8_t out_block[16])
+{
+	BlockValues values;
+	GetBlockValues(texels, values);
+	bool isOpaque = true;
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		isOpaque &= (texels[texelIndex].a == 255);
+	}
+
+	// Opaque blocks keep alpha out of the fit and both p bits set, so alpha decodes to exactly 255
+	float start[4];
+	float end[4];
+	FindPrincipalEndpoints(values, nullptr, isOpaque ? 3 : 4, start, end);
+	if (isOpaque)
+	{
+		start[3] = 255.f;
+		end[3] = 255.f;
+	}
+	Mode6Fit best = FitMode6(values, isOpaque, start, end);
+
+	for (int iteration = 0; iteration < 2 && best.m_error > 0.f; ++iteration)
+	{
+		float weights[16];
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			weights[texelIndex] = static_cast<float>(BC7_WEIGHTS4[best.m_indexes[texelIndex]]) / 64.f;
+		}
+		if (!SolveEndpoints(values, nullptr, weights, isOpaque ? 3 : 4, start, end))
+		{
+			break;
+		}
+		Mode6Fit refit = FitMode6(values, isOpaque, start, end);
+		if (refit.m_error >= best.m_error)
+		{
+			break;
+		}
+		best = refit;
+	}
+
+	// The first index is stored with 3 bits, so its top bit has to be 0
+	if (best.m_indexes[0] >= 8)
+	{
+		for (int channel = 0; channel < 4; ++channel)
+		{
+			std::swap(best.m_endpoints[0][channel], best.m_endpoints[1][channel]);
+		}
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			best.m_indexes[texelIndex] = static_cast<uint8_t>(15 - best.m_indexes[texelIndex]);
+		}
+	}
+
+	memset(out_block, 0, 16);
+	BitWriter writer;
+	writer.m_bytes = out_block;
+	writer.Write(1 << 6, 7);
+	for (int channel = 0; channel < 4; ++channel)
+	{
+		writer.Write(static_cast<uint32_t>(best.m_endpoints[0][channel] >> 1), 7);
+		writer.Write(static_cast<uint32_t>(best.m_endpoints[1][channel] >> 1), 7);
+	}
+	writer.Write(static_cast<uint32_t>(best.m_endpoints[0][0] & 1), 1);
+	writer.Write(static_cast<uint32_t>(best.m_endpoints[1][0] & 1), 1);
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		writer.Write(best.m_indexes[texelIndex], (texelIndex == 0) ? 3 : 4);
+	}
+}
+
+void DecodeBC1Block(uint8_t const block[8], Rgba8 out_texels[16])
+{
+	DecodeColorBlock(block, true, out_texels);
+}
+
+void DecodeBC3Block(uint8_t const block[16], Rgba8 out_texels[16])
+{
+	DecodeColorBlock(block + 8, false, out_texels);
+	int palette[8];
+	BuildAlphaPalette(block[0], block[1], palette);
+	uint64_t indexBits = 0;
+	for (int byteIndex = 0; byteIndex < 6; ++byteIndex)
+	{
+		indexBits |= static_cast<uint64_t>(block[2 + byteIndex]) << (8 * byteIndex);
+	}
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		out_texels[texelIndex].a = static_cast<unsigned char>(palette[(indexBits >> (3 * texelIndex)) & 7]);
+	}
+}
+
+void DecodeBC7Block(uint8_t const block[16], Rgba8 out_texels[16])
+{
+	// Other modes decode to transparent black, like a reserved mode does on the GPU
+	if ((block[0] & 0x7F) != 0x40)
+	{
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			out_texels[texelIndex] = Rgba8(0, 0, 0, 0);
+		}
+		return;
+	}
+
+	BitReader reader;
+	reader.m_bytes = block;
+	reader.Read(7);
+	int endpoints[2][4];
+	for (int channel = 0; channel < 4; ++channel)
+	{
+		endpoints[0][channel] = static_cast<int>(reader.Read(7)) << 1;
+		endpoints[1][channel] = static_cast<int>(reader.Read(7)) << 1;
+	}
+	int pBits[2];
+	pBits[0] = static_cast<int>(reader.Read(1));
+	pBits[1] = static_cast<int>(reader.Read(1));
+	for (int channel = 0; channel < 4; ++channel)
+	{
+		endpoints[0][channel] |= pBits[0];
+		endpoints[1][channel] |= pBits[1];
+	}
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		int weight = BC7_WEIGHTS4[reader.Read((texelIndex == 0) ? 3 : 4)];
+		unsigned char channels[4];
+		for (int channel = 0; channel < 4; ++channel)
+		{
+			channels[channel] = static_cast<unsigned char>(((64 - weight) * endpoints[0][channel] + weight * endpoints[1][channel] + 32) >> 6);
+		}
+		out_texels[texelIndex] = Rgba8(channels[0], channels[1], channels[2], channels[3]);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+bool WriteCookedTexture(CookedTexture const& cooked, std::string const& filePath)
+{
+	int bytesPerBlock = GetBytesPerBlock(cooked.m_format);
+	if (bytesPerBlock < 0 || cooked.m_mips.empty())
+	{
+		DebuggerPrintf("WriteCookedTexture: \"%s\" has no mips or an unsupported format %d\n", cooked.m_name.c_str(), static_cast<int>(cooked.m_format));
+		return false;
+	}
+
+	std::vector<uint8_t> buffer(DDS_DATA_OFFSET + cooked.m_data.size(), 0);
+	WriteWord(buffer, DDS_WORD_MAGIC, DDS_MAGIC);
+	WriteWord(buffer, DDS_WORD_SIZE, DDS_HEADER_SIZE);
+	WriteWord(buffer, DDS_WORD_FLAGS, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | ((bytesPerBlock > 0) ? DDSD_LINEARSIZE : DDSD_PITCH));
+	WriteWord(buffer, DDS_WORD_HEIGHT, static_cast<uint32_t>(cooked.m_dimensions.y));
+	WriteWord(buffer, DDS_WORD_WIDTH, static_cast<uint32_t>(cooked.m_dimensions.x));
+	WriteWord(buffer, DDS_WORD_PITCH_OR_LINEAR_SIZE, (bytesPerBlock > 0) ? static_cast<uint32_t>(cooked.m_mips[0].m_numBytes) : cooked.m_mips[0].m_rowPitch);
+	WriteWord(buffer, DDS_WORD_MIP_COUNT, static_cast<uint32_t>(cooked.m_mips.size()));
+	WriteWord(buffer, DDS_WORD_PIXEL_FORMAT_SIZE, DDS_PIXEL_FORMAT_SIZE);
+	WriteWord(buffer, DDS_WORD_PIXEL_FORMAT_FLAGS, DDPF_FOURCC);
+	WriteWord(buffer, DDS_WORD_FOURCC, DDS_FOURCC_DX10);
+	WriteWord(buffer, DDS_WORD_CAPS, DDSCAPS_TEXTURE | ((cooked.m_mips.size() > 1) ? (DDSCAPS_COMPLEX | DDSCAPS_MIPMAP) : 0));
+	WriteWord(buffer, DDS_WORD_DXGI_FORMAT, static_cast<uint32_t>(cooked.m_format));
+	WriteWord(buffer, DDS_WORD_RESOURCE_DIMENSION, DDS_DIMENSION_TEXTURE2D);
+	WriteWord(buffer, DDS_WORD_ARRAY_SIZE, 1);
+	std::copy(cooked.m_data.begin(), cooked.m_data.end(), buffer.begin() + DDS_DATA_OFFSET);
+
+	if (FileWriteFromBuffer(buffer, filePath) < 0)
+	{
+		DebuggerPrintf("WriteCookedTexture: could not write \"%s\"\n", filePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool LoadCookedTexture(std::string const& filePath, CookedTexture& out_cooked)
+{
+	std::vector<uint8_t> buffer;
+	if (FileReadToBuffer(buffer, filePath) < 0)
+	{
+		DebuggerPrintf("LoadCookedTexture: could not read \"%s\"\n", filePath.c_str());
+		return false;
+	}
+	if (buffer.size() < DDS_DATA_OFFSET || ReadWord(buffer, DDS_WORD_MAGIC) != DDS_MAGIC || ReadWord(buffer, DDS_WORD_SIZE) != DDS_HEADER_SIZE ||
+		ReadWord(buffer, DDS_WORD_FOURCC) != DDS_FOURCC_DX10)
+	{
+		DebuggerPrintf("LoadCookedTexture: \"%s\" is not a DDS file with a DX10 header\n", filePath.c_str());
+		return false;
+	}
+	if (ReadWord(buffer, DDS_WORD_RESOURCE_DIMENSION) != DDS_DIMENSION_TEXTURE2D || ReadWord(buffer, DDS_WORD_ARRAY_SIZE) != 1)
+	{
+		DebuggerPrintf("LoadCookedTexture: \"%s\" is not a single 2D texture\n", filePath.c_str());
+		return false;
+	}
+
+	DXGI_FORMAT format = static_cast<DXGI_FORMAT>(ReadWord(buffer, DDS_WORD_DXGI_FORMAT));
+	IntVec2 dimensions(static_cast<int>(ReadWord(buffer, DDS_WORD_WIDTH)), static_cast<int>(ReadWord(buffer, DDS_WORD_HEIGHT)));
+	uint32_t numMips = std::max(ReadWord(buffer, DDS_WORD_MIP_COUNT), 1u);
+	if (GetBytesPerBlock(format) < 0 || dimensions.x <= 0 || dimensions.y <= 0 || numMips > 32)
+	{
+		DebuggerPrintf("LoadCookedTexture: \"%s\" has an unsupported format %d or size %d x %d with %u mips\n", filePath.c_str(), static_cast<int>(format), dimensions.x, dimensions.y, numMips);
+		return false;
+	}
+
+	CookedTexture cooked;
+	cooked.m_name = filePath;
+	cooked.m_dimensions = dimensions;
+	cooked.m_format = format;
+	size_t numBytes = ComputeMipLayout(format, dimensions, static_cast<int>(numMips), cooked.m_mips);
+	if (buffer.size() - DDS_DATA_OFFSET < numBytes)
+	{
+		DebuggerPrintf("LoadCookedTexture: \"%s\" is cut short, %d of %d bytes of texels\n", filePath.c_str(), static_cast<int>(buffer.size() - DDS_DATA_OFFSET), static_cast<int>(numBytes));
+		return false;
+	}
+	cooked.m_data.assign(buffer.begin() + DDS_DATA_OFFSET, buffer.begin() + DDS_DATA_OFFSET + numBytes);
+	out_cooked = std::move(cooked);
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool CookTextureFile(std::string const& imageFilePath, std::string const& cookedFilePath, TextureCookConfig const& config, WorkerPool* workers)
+{
+	Image image(imageFilePath.c_str());
+	CookedTexture cooked = CookTexture(image, config, workers);
+	cooked.m_name = cookedFilePath;
+	return WriteCookedTexture(cooked, cookedFilePath);
+}
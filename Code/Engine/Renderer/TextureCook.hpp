@@ -0,0 +1,89 @@
+#pragma once
+#include "Engine/Renderer/RendererCommon.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class WorkerPool;
+
+//-----------------------------------------------------------------------------------------------
+// Offline texture cooking: a full mip chain, block compressed on the CPU, saved in a DDS file
+// (DX10 header) that CreateOrGetTextureFromCooked uploads as is.
+//
+// Mips are filtered in linear light when m_isSRGB is set, so dark and bright texels average the
+// way the eye sees them, and with premultiplied alpha so transparent texels do not bleed their
+// color. The format stays UNORM like CreateTextureFromImage unless m_useSRGBFormat asks. Rows stay in Image order, bottom row first, like every texture the
+// engine creates from an Image, so the files only round trip through this engine.
+//
+// Usage, in a cook tool or at first load:
+//	CookTextureFile("Data/Images/Tiles.png", "Data/Cooked/Tiles.dds", TextureCookConfig(), &workers);
+//	...
+//	CookedTexture cooked;
+//	if (LoadCookedTexture("Data/Cooked/Tiles.dds", cooked))
+//	{
+//		Texture* tiles = g_theRenderer->CreateOrGetTextureFromCooked(cooked);
+//	}
+//
+enum class TextureCookFormat
+{
+	RGBA8,	// 4 bytes per texel, mips only
+	BC1,	// 0.5 bytes per texel, rgb with 1 bit alpha
+	BC3,	// 1 byte per texel, rgb and smooth alpha
+	BC7,	// 1 byte per texel, rgba, best quality (mode 6 only)
+};
+
+enum class MipFilter
+{
+	BOX,	// 2x2 average
+	KAISER,	// Kaiser windowed sinc, sharper minified textures
+};
+
+struct TextureCookConfig
+{
+	TextureCookFormat	m_format = TextureCookFormat::BC7;
+	MipFilter			m_mipFilter = MipFilter::BOX;
+	bool				m_isSRGB = true;		// color textures, off for normal maps, masks and data
+	bool				m_useSRGBFormat = false;	// _SRGB DXGI format, only for shaders that light in linear space
+	bool				m_generateMips = true;
+};
+
+struct CookedTextureMip
+{
+	IntVec2		m_dimensions;
+	size_t		m_dataOffset = 0;	// into CookedTexture::m_data
+	size_t		m_numBytes = 0;
+	uint32_t	m_rowPitch = 0;		// bytes per row of texels, or of 4x4 blocks
+	uint32_t	m_numRows = 0;		// texel rows, or block rows
+};
+
+struct CookedTexture
+{
+	std::string						m_name;			// file the texture came from, the key for CreateOrGetTextureFromCooked
+	IntVec2							m_dimensions;
+	DXGI_FORMAT						m_format = DXGI_FORMAT_UNKNOWN;
+	std::vector<CookedTextureMip>	m_mips;			// largest first
+	std::vector<uint8_t>			m_data;
+
+	size_t GetNumBytes() const { return m_data.size(); }
+};
+
+// Down to 1x1, level 0 is a copy of image
+std::vector<Image> GenerateMipChain(Image const& image, MipFilter filter = MipFilter::BOX, bool isSRGB = true, WorkerPool* workers = nullptr);
+
+CookedTexture CookTexture(Image const& image, TextureCookConfig const& config = TextureCookConfig(), WorkerPool* workers = nullptr);
+
+// Block encoders, texels are a 4x4 block in rows. Exposed for tools and the cooking benchmark
+void EncodeBC1Block(Rgba8 const texels[16], uint8_t out_block[8]);
+void EncodeBC3Block(Rgba8 const texels[16], uint8_t out_block[16]);
+void EncodeBC7Block(Rgba8 const texels[16], uint8_t out_block[16]);
+void DecodeBC1Block(uint8_t const block[8], Rgba8 out_texels[16]);
+void DecodeBC3Block(uint8_t const block[16], Rgba8 out_texels[16]);
+void DecodeBC7Block(uint8_t const block[16], Rgba8 out_texels[16]); // mode 6 blocks only
+
+// Both print the reason with DebuggerPrintf and return false on failure
+bool WriteCookedTexture(CookedTexture const& cooked, std::string const& filePath);
+bool LoadCookedTexture(std::string const& filePath, CookedTexture& out_cooked);
+
+bool CookTextureFile(std::string const& imageFilePath, std::string const& cookedFilePath, TextureCookConfig const& config = TextureCookConfig(), WorkerPool* workers = nullptr);
@@ -0,0 +1,275 @@
+#include "Engine/Renderer/TextureStreamer.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <cctype>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	bool IsCookedTextureFile(std::string const& filePath)
+	{
+		if (filePath.size() < 4)
+		{
+			return false;
+		}
+		std::string extension = filePath.substr(filePath.size() - 4);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+		return extension == ".dds";
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+std::string TextureStreamerStats::ToString() const
+{
+	return Stringf("%d requested, %d ready, %d failed, %d decoding, %d waiting. Last frame: %d uploads, %.1f KB, %.3f ms. Max frame %.3f ms, %d hitch frames, %d budget limited frames. Load %.1f ms average, %.1f ms max, decode %.1f ms total",
+		m_numRequested, m_numReady, m_numFailed, m_numDecoding, m_numWaitingForUpload,
+		m_lastFrameUploads, static_cast<double>(m_lastFrameUploadBytes) / 1024.0, m_lastFrameUploadSeconds * 1000.0,
+		m_maxFrameUploadSeconds * 1000.0, m_numHitchFrames, m_numBudgetLimitedFrames,
+		m_averageLoadSeconds * 1000.0, m_maxLoadSeconds * 1000.0, m_totalDecodeSeconds * 1000.0);
+}
+
+//-----------------------------------------------------------------------------------------------
+size_t TextureStreamer::DecodeJob::GetUploadBytes() const
+{
+	if (m_isCooked)
+	{
+		return m_cooked.GetNumBytes();
+	}
+	return static_cast<size_t>(m_image.GetDimensions().x) * m_image.GetDimensions().y * sizeof(Rgba8);
+}
+
+//-----------------------------------------------------------------------------------------------
+TextureStreamer::TextureStreamer(Renderer* renderer, TextureStreamerConfig const& config)
+	: m_renderer(renderer)
+	, m_config(config)
+{
+	int numThreads = std::max(m_config.m_numDecodeThreads, 1);
+	for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+	{
+		m_threads.emplace_back(&TextureStreamer::DecodeThreadMain, this);
+	}
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_all();
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+StreamedTextureHandle TextureStreamer::RequestTexture(std::string const& filePath)
+{
+	auto found = m_handlesByPath.find(filePath);
+	if (found != m_handlesByPath.end())
+	{
+		return found->second;
+	}
+
+	StreamedTextureHandle handle = m_requests.Add();
+	Request& request = *m_requests.Get(handle);
+	request.m_filePath = filePath;
+	request.m_state = StreamedTextureState::DECODING;
+	request.m_texture = nullptr;
+	request.m_requestSeconds = GetCurrentTimeSeconds();
+	m_handlesByPath[filePath] = handle;
+
+	std::unique_ptr<DecodeJob> job = std::make_unique<DecodeJob>();
+	job->m_handle = handle;
+	job->m_filePath = filePath;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_decodeQueue.push_back(std::move(job));
+	}
+	m_wakeCondition.notify_one();
+
+	++m_numInFlight;
+	++m_stats.m_numRequested;
+	++m_stats.m_numDecoding;
+	return handle;
+}
+
+Texture* TextureStreamer::GetTexture(StreamedTextureHandle handle) const
+{
+	Request const* request = m_requests.Get(handle);
+	return request ? request->m_texture : nullptr;
+}
+
+StreamedTextureState TextureStreamer::GetState(StreamedTextureHandle handle) const
+{
+	Request const* request = m_requests.Get(handle);
+	return request ? request->m_state : StreamedTextureState::INVALID;
+}
+
+//-----------------------------------------------------------------------------------------------
+void TextureStreamer::Update()
+{
+	CollectDecodedJobs(false);
+
+	// Oldest first, as many as the budget allows, but always one so nothing starves
+	double startSeconds = GetCurrentTimeSeconds();
+	int numUploads = 0;
+	size_t numUploadBytes = 0;
+	{
+		PROFILE_SCOPE("TextureStreamer Upload");
+		while (!m_uploadQueue.empty() && numUploads < m_config.m_maxUploadsPerFrame)
+		{
+			size_t jobBytes = m_uploadQueue.front()->GetUploadBytes();
+			if (numUploads > 0 && numUploadBytes + jobBytes > m_config.m_maxUploadBytesPerFrame)
+			{
+				break;
+			}
+			Upload(*m_uploadQueue.front());
+			m_uploadQueue.pop_front();
+			++numUploads;
+			numUploadBytes += jobBytes;
+		}
+	}
+	double uploadSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	m_stats.m_lastFrameUploads = numUploads;
+	m_stats.m_lastFrameUploadBytes = numUploadBytes;
+	m_stats.m_lastFrameUploadSeconds = uploadSeconds;
+	m_stats.m_maxFrameUploadSeconds = std::max(m_stats.m_maxFrameUploadSeconds, uploadSeconds);
+	m_stats.m_totalUploadBytes += numUploadBytes;
+	if (uploadSeconds > m_config.m_hitchUploadSeconds)
+	{
+		++m_stats.m_numHitchFrames;
+	}
+	if (!m_uploadQueue.empty())
+	{
+		++m_stats.m_numBudgetLimitedFrames;
+	}
+	RefreshCounts();
+}
+
+void TextureStreamer::FinishAllRequests()
+{
+	PROFILE_SCOPE("TextureStreamer FinishAllRequests");
+	while (m_numInFlight > 0)
+	{
+		CollectDecodedJobs(m_uploadQueue.empty());
+		while (!m_uploadQueue.empty())
+		{
+			m_stats.m_totalUploadBytes += m_uploadQueue.front()->GetUploadBytes();
+			Upload(*m_uploadQueue.front());
+			m_uploadQueue.pop_front();
+		}
+	}
+	RefreshCounts();
+}
+
+//-----------------------------------------------------------------------------------------------
+void TextureStreamer::DecodeThreadMain()
+{
+	while (true)
+	{
+		std::unique_ptr<DecodeJob> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [this]() { return m_isQuitting || !m_decodeQueue.empty(); });
+			if (m_isQuitting)
+			{
+				return;
+			}
+			job = std::move(m_decodeQueue.front());
+			m_decodeQueue.pop_front();
+		}
+
+		Decode(*job);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_decodedQueue.push_back(std::move(job));
+		}
+		m_decodedCondition.notify_one();
+	}
+}
+
+void TextureStreamer::Decode(DecodeJob& job)
+{
+	PROFILE_SCOPE("TextureStreamer Decode");
+	double startSeconds = GetCurrentTimeSeconds();
+
+	// Checked first, a missing file would stop FileReadToBuffer with a dialog. Truncated or
+	// undecodable images fail in Image::LoadFromFile, which does not die like the constructor
+	job.m_isCooked = IsCookedTextureFile(job.m_filePath);
+	if (!DoesFileExist(job.m_filePath))
+	{
+		DebuggerPrintf("TextureStreamer: \"%s\" does not exist\n", job.m_filePath.c_str());
+	}
+	else if (job.m_isCooked)
+	{
+		job.m_succeeded = LoadCookedTexture(job.m_filePath, job.m_cooked);
+	}
+	else
+	{
+		job.m_succeeded = job.m_image.LoadFromFile(job.m_filePath.c_str());
+		if (!job.m_succeeded)
+		{
+			DebuggerPrintf("TextureStreamer: \"%s\" is not an image stb_image can decode\n", job.m_filePath.c_str());
+		}
+	}
+	job.m_decodeSeconds = GetCurrentTimeSeconds() - startSeconds;
+}
+
+// Moves finished decodes to the upload queue, failures are settled right away
+void TextureStreamer::CollectDecodedJobs(bool waitForOne)
+{
+	std::deque<std::unique_ptr<DecodeJob>> decodedJobs;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (waitForOne)
+		{
+			m_decodedCondition.wait(lock, [this]() { return !m_decodedQueue.empty(); });
+		}
+		decodedJobs.swap(m_decodedQueue);
+	}
+
+	for (std::unique_ptr<DecodeJob>& job : decodedJobs)
+	{
+		m_stats.m_totalDecodeSeconds += job->m_decodeSeconds;
+		Request* request = m_requests.Get(job->m_handle);
+		if (job->m_succeeded)
+		{
+			request->m_state = StreamedTextureState::DECODED;
+			m_uploadQueue.push_back(std::move(job));
+		}
+		else
+		{
+			request->m_state = StreamedTextureState::FAILED;
+			--m_numInFlight;
+			++m_stats.m_numFailed;
+		}
+	}
+}
+
+void TextureStreamer::Upload(DecodeJob& job)
+{
+	Request* request = m_requests.Get(job.m_handle);
+	request->m_texture = job.m_isCooked ? m_renderer->CreateOrGetTextureFromCooked(job.m_cooked) : m_renderer->CreateOrGetTextureFromImage(job.m_image);
+	request->m_state = StreamedTextureState::READY;
+	--m_numInFlight;
+
+	double loadSeconds = GetCurrentTimeSeconds() - request->m_requestSeconds;
+	m_totalLoadSeconds += loadSeconds;
+	++m_stats.m_numReady;
+	m_stats.m_averageLoadSeconds = m_totalLoadSeconds / static_cast<double>(m_stats.m_numReady);
+	m_stats.m_maxLoadSeconds = std::max(m_stats.m_maxLoadSeconds, loadSeconds);
+}
+
+void TextureStreamer::RefreshCounts()
+{
+	m_stats.m_numWaitingForUpload = static_cast<int>(m_uploadQueue.size());
+	m_stats.m_numDecoding = m_numInFlight - m_stats.m_numWaitingForUpload;
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/SlotMap.hpp"
+#include "Engine/Renderer/TextureCook.hpp"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Renderer;
+class Texture;
+
+typedef SlotHandle StreamedTextureHandle;
+
+//-----------------------------------------------------------------------------------------------
+// Loads textures in the background instead of stalling CreateOrGetTextureFromFile.
+//
+// RequestTexture returns a handle at once and queues the file for its own decode threads: .dds
+// files go through LoadCookedTexture, everything else through Image. Update, once a frame on the
+// render thread, uploads decoded textures oldest first until the frame's upload budget is spent,
+// at least one per frame so a texture larger than the byte budget still gets through.
+//
+// Until its upload GetTexture returns nullptr, and BindTexture(nullptr) binds the renderer's
+// default texture, so the placeholder needs no special case at the call site. Decoding and
+// uploads show in the profiler as "TextureStreamer Decode" and "TextureStreamer Upload".
+//
+// Usage:
+//	m_wallsHandle = m_textureStreamer->RequestTexture("Data/Images/Walls.png");
+//	...
+//	m_textureStreamer->Update();	// after BeginFrame
+//	g_theRenderer->BindTexture(m_textureStreamer->GetTexture(m_wallsHandle));
+//
+struct TextureStreamerConfig
+{
+	int		m_numDecodeThreads = 2;
+	int		m_maxUploadsPerFrame = 4;
+	size_t	m_maxUploadBytesPerFrame = 8 * 1024 * 1024;
+	double	m_hitchUploadSeconds = 0.004;	// frames spending longer on uploads count as hitches
+};
+
+enum class StreamedTextureState
+{
+	INVALID,	// unknown handle
+	DECODING,	// queued for or on a decode thread
+	DECODED,	// waiting for upload budget
+	READY,
+	FAILED,		// missing or undecodable file, GetTexture stays nullptr
+};
+
+struct TextureStreamerStats
+{
+	int		m_numRequested = 0;
+	int		m_numReady = 0;
+	int		m_numFailed = 0;
+	int		m_numDecoding = 0;
+	int		m_numWaitingForUpload = 0;
+
+	int		m_lastFrameUploads = 0;
+	size_t	m_lastFrameUploadBytes = 0;
+	double	m_lastFrameUploadSeconds = 0.0;
+	double	m_maxFrameUploadSeconds = 0.0;
+	int		m_numHitchFrames = 0;			// upload time over m_hitchUploadSeconds
+	int		m_numBudgetLimitedFrames = 0;	// frames that left decoded textures for later
+	size_t	m_totalUploadBytes = 0;
+
+	double	m_totalDecodeSeconds = 0.0;		// summed over decode threads
+	double	m_averageLoadSeconds = 0.0;		// request to ready
+	double	m_maxLoadSeconds = 0.0;
+
+	std::string ToString() const;
+};
+
+class TextureStreamer
+{
+public:
+	explicit TextureStreamer(Renderer* renderer, TextureStreamerConfig const& config = TextureStreamerConfig());
+	~TextureStreamer();
+	TextureStreamer(TextureStreamer const& copy) = delete;
+
+	// Requesting a file again returns the first handle
+	StreamedTextureHandle RequestTexture(std::string const& filePath);
+
+	Texture* GetTexture(StreamedTextureHandle handle) const;
+	StreamedTextureState GetState(StreamedTextureHandle handle) const;
+	bool IsIdle() const { return m_numInFlight == 0; }
+
+	// Once a frame on the render thread, uploads within the budget and updates the stats
+	void Update();
+	// For loading screens: blocks until every request is ready or failed, ignoring the budget
+	void FinishAllRequests();
+
+	TextureStreamerStats const& GetStats() const { return m_stats; }
+
+protected:
+	struct Request
+	{
+		std::string				m_filePath;
+		StreamedTextureState	m_state = StreamedTextureState::INVALID;
+		Texture*				m_texture = nullptr;
+		double					m_requestSeconds = 0.0;
+	};
+
+	// Owned by exactly one queue at a time, so decode threads never touch m_requests
+	struct DecodeJob
+	{
+		StreamedTextureHandle	m_handle;
+		std::string				m_filePath;
+		bool					m_isCooked = false;
+		bool					m_succeeded = false;
+		Image					m_image;
+		CookedTexture			m_cooked;
+		double					m_decodeSeconds = 0.0;
+
+		size_t GetUploadBytes() const;
+	};
+
+	void DecodeThreadMain();
+	static void Decode(DecodeJob& job);
+	void CollectDecodedJobs(bool waitForOne);
+	void Upload(DecodeJob& job);
+	void RefreshCounts();
+
+protected:
+	Renderer*				m_renderer = nullptr;
+	TextureStreamerConfig	m_config;
+
+	SlotMap<Request>									m_requests;
+	std::unordered_map<std::string, StreamedTextureHandle>	m_handlesByPath;
+	std::deque<std::unique_ptr<DecodeJob>>				m_uploadQueue;	// render thread only
+	int													m_numInFlight = 0;	// decoding or waiting for upload
+
+	std::vector<std::thread>				m_threads;
+	std::mutex								m_mutex;
+	std::condition_variable					m_wakeCondition;
+	std::condition_variable					m_decodedCondition;
+	std::deque<std::unique_ptr<DecodeJob>>	m_decodeQueue;		// under m_mutex
+	std::deque<std::unique_ptr<DecodeJob>>	m_decodedQueue;		// under m_mutex
+	bool									m_isQuitting = false;
+
+	TextureStreamerStats	m_stats;
+	double					m_totalLoadSeconds = 0.0;
+};
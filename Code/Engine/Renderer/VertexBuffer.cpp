@@ -111,11 +111,17 @@ void VertexBuffer::Upload(ID3D12GraphicsCommandList* cmdList, void const* data,
 	{
 		Resize(dataSize);
 	}
+	UploadRange(cmdList, data, dataSize, 0, dataSize);
+}
+
+void VertexBuffer::UploadRange(ID3D12GraphicsCommandList* cmdList, void const* data, unsigned int dataSize, unsigned int destOffset, unsigned int bufferDataSize)
+{
+	GUARANTEE_OR_DIE(destOffset + dataSize <= m_size && bufferDataSize <= m_size, "Buffer range upload is out of bounds");
 
 	// if some one upload a smaller data, the view will change, although no effect. 
 	// because draw call will require a vertex/index count to draw.
 	// it restricts the maximum amount you can use
-	m_actualDataSize = dataSize;
+	m_actualDataSize = bufferDataSize;
 
 	DX12LinearAllocator* allocator = m_renderer->GetCurrentLinearAllocator();
 	size_t alignment = 16;
@@ -144,7 +150,7 @@ void VertexBuffer::Upload(ID3D12GraphicsCommandList* cmdList, void const* data,
 	}
 
 	cmdList->CopyBufferRegion(
-		m_defaultBuffer, 0,
+		m_defaultBuffer, destOffset,
 		uploadAlloc.m_buffer, uploadAlloc.m_offset,
 		dataSize
 	);
@@ -241,3 +247,17 @@ void VertexBuffer::CreateDefaultBuffer()
 //	m_uploadBufferSize = size;
 //}
 #endif // ENGINE_RENDER_D3D12
+
+#ifdef ENGINE_RENDER_NULL
+VertexBuffer::VertexBuffer(unsigned int id, unsigned int size, unsigned int stride)
+	: m_id(id)
+	, m_size(size)
+	, m_stride(stride)
+{
+}
+
+void VertexBuffer::Resize(unsigned int size)
+{
+	m_size = size;
+}
+#endif // ENGINE_RENDER_NULL
@@ -54,6 +54,9 @@ public:
 	void Create();
 	void Resize(unsigned int size);
 	void Upload(ID3D12GraphicsCommandList* cmdList, void const* data, unsigned int dataSize);
+	// Writes dataSize bytes at destOffset and keeps the rest, the buffer then holds bufferDataSize bytes.
+	// Cannot grow the buffer
+	void UploadRange(ID3D12GraphicsCommandList* cmdList, void const* data, unsigned int dataSize, unsigned int destOffset, unsigned int bufferDataSize);
 
 	unsigned int GetSize() const { return m_size; }
 	unsigned int GetStride() const { return m_stride; }
@@ -81,3 +84,29 @@ private:
 
 
 
+
+#ifdef ENGINE_RENDER_NULL
+//-----------------------------------------------------------------------------------------------
+// No GPU memory behind it, NullRenderer only tracks the size and records the id
+class VertexBuffer
+{
+	friend class NullRenderer;
+
+public:
+	VertexBuffer(const VertexBuffer& copy) = delete;
+	void operator=(VertexBuffer const& copy) = delete;
+	virtual ~VertexBuffer() = default;
+
+	VertexBuffer(unsigned int id, unsigned int size, unsigned int stride);
+
+	void Resize(unsigned int size);
+
+	unsigned int GetSize() const { return m_size; }
+	unsigned int GetStride() const { return m_stride; }
+
+private:
+	unsigned int m_id = 0;
+	unsigned int m_size = 0;
+	unsigned int m_stride = 0;
+};
+#endif // ENGINE_RENDER_NULL
@@ -0,0 +1,206 @@
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Network/NetworkSystem.hpp"
+#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/Culling.hpp"
+#include "Engine/Renderer/DescriptorAllocator.hpp"
+#include "Engine/Renderer/FenceBucketQueue.hpp"
+#include "Engine/Renderer/InstanceBatch.hpp"
+#include "Engine/Renderer/NullRenderer.hpp"
+#include "Engine/Renderer/PipelineStateCache.hpp"
+#include "Engine/Renderer/SpriteBatch.hpp"
+#include "Engine/Renderer/SpriteSheet.hpp"
+#include <cstdio>
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+// Runs the engine's Run*Benchmark functions headless against the null renderer, so the numbers
+// quoted for them can be reproduced. "--quick" shrinks every size for a ctest smoke run.
+//
+//	EngineBench [--quick] [benchmark ...]
+//
+namespace
+{
+	struct EngineBenchmark
+	{
+		char const*	m_name = nullptr;
+		void		(*m_function)(bool isQuick) = nullptr;
+	};
+
+	void PrintBenchmarkLine(char const* name, std::string const& text)
+	{
+		printf("%-16s %s\n", name, text.c_str());
+		fflush(stdout);
+	}
+
+	//-------------------------------------------------------------------------------------------
+	void BenchmarkPipelineCache(bool isQuick)
+	{
+		int numDraws = isQuick ? 20000 : 2000000;
+		for (int drawsPerStateChange : { 1, 8, 64 })
+		{
+			PrintBenchmarkLine("PipelineCache", RunPipelineCacheBenchmark(numDraws, 64, drawsPerStateChange).ToString());
+		}
+	}
+
+	void BenchmarkCulling(bool isQuick)
+	{
+		WorkerPool workers;
+		int numIterations = isQuick ? 2 : 50;
+		for (int numObjects : { 1000, 10000, 100000 })
+		{
+			PrintBenchmarkLine("Culling", RunCullingBenchmark(isQuick ? numObjects / 10 : numObjects, numIterations, &workers).ToString());
+		}
+	}
+
+	void BenchmarkDescriptorAllocator(bool isQuick)
+	{
+		int numOperations = isQuick ? 10000 : 1000000;
+		for (uint32_t maxTableSize : { 1u, 8u, 32u })
+		{
+			PrintBenchmarkLine("DescriptorAlloc", RunDescriptorAllocatorBenchmark(isQuick ? 4096 : 65536, numOperations, maxTableSize).ToString());
+		}
+	}
+
+	void BenchmarkDeferredRelease(bool isQuick)
+	{
+		for (int numItems : { 1000, 100000 })
+		{
+			PrintBenchmarkLine("DeferredRelease", RunDeferredReleaseBenchmark(isQuick ? numItems / 100 : numItems, isQuick ? 10 : 600).ToString());
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------
+	// The textures only need dimensions, the null renderer never reads texels
+	Texture* CreateBenchTexture(NullRenderer& renderer, char const* name)
+	{
+		return renderer.CreateOrGetTextureFromImage(Image(IntVec2(256, 256), Rgba8::OPAQUE_WHITE, name));
+	}
+
+	void BenchmarkText(bool isQuick)
+	{
+		RendererConfig rendererConfig;
+		NullRenderer renderer(rendererConfig);
+		renderer.Startup();
+
+		// The font finds the texture already made under its png name
+		CreateBenchTexture(renderer, "BenchFont.png");
+		BitmapFont* font = renderer.CreateOrGetBitmapFont("BenchFont");
+		for (int numLabels : { 100, 1000 })
+		{
+			PrintBenchmarkLine("Text", RunTextBenchmark(*font, isQuick ? numLabels / 10 : numLabels, isQuick ? 5 : 200).ToString());
+		}
+		renderer.Shutdown();
+	}
+
+	void BenchmarkSpriteBatch(bool isQuick)
+	{
+		RendererConfig rendererConfig;
+		NullRenderer renderer(rendererConfig);
+		renderer.Startup();
+		renderer.SetRecordUploadData(false);
+		{
+			std::vector<SpriteSheet> sheets;
+			sheets.reserve(4);
+			std::vector<SpriteSheet const*> sheetPointers;
+			for (int sheetIndex = 0; sheetIndex < 4; ++sheetIndex)
+			{
+				std::string name = Stringf("BenchSprites%d.png", sheetIndex);
+				sheets.emplace_back(*CreateBenchTexture(renderer, name.c_str()), IntVec2(8, 8));
+				sheetPointers.push_back(&sheets.back());
+			}
+
+			WorkerPool workers;
+			int numFrames = isQuick ? 3 : 100;
+			for (int numSprites : { 1000, 10000, 100000 })
+			{
+				PrintBenchmarkLine("SpriteBatch", RunSpriteBatchBenchmark(&renderer, sheetPointers, isQuick ? numSprites / 10 : numSprites, numFrames).ToString());
+				PrintBenchmarkLine("SpriteBatch", RunSpriteBatchBenchmark(&renderer, sheetPointers, isQuick ? numSprites / 10 : numSprites, numFrames, &workers).ToString());
+			}
+		}
+		renderer.Shutdown();
+	}
+
+	void BenchmarkInstanceBatch(bool isQuick)
+	{
+		RendererConfig rendererConfig;
+		NullRenderer renderer(rendererConfig);
+		renderer.Startup();
+		renderer.SetRecordUploadData(false);
+		int numFrames = isQuick ? 3 : 100;
+		for (int numInstances : { 1000, 10000, 100000 })
+		{
+			PrintBenchmarkLine("InstanceBatch", RunInstanceBatchBenchmark(&renderer, isQuick ? numInstances / 10 : numInstances, numFrames).ToString());
+		}
+		renderer.Shutdown();
+	}
+
+	//-------------------------------------------------------------------------------------------
+	void BenchmarkNetClientChurn(bool isQuick)
+	{
+		for (int clientsPerWave : { 16, 128 })
+		{
+			NetClientChurnBenchmarkResult result;
+			for (unsigned short port = 47400; port < 47410 && !result.m_isComplete; ++port)
+			{
+				result = RunNetClientChurnBenchmark(port, isQuick ? 4 : 100, isQuick ? clientsPerWave / 4 : clientsPerWave);
+			}
+			PrintBenchmarkLine("NetClientChurn", result.ToString());
+		}
+	}
+
+	EngineBenchmark const s_benchmarks[] =
+	{
+		{ "PipelineCache",		BenchmarkPipelineCache },
+		{ "Culling",			BenchmarkCulling },
+		{ "DescriptorAlloc",	BenchmarkDescriptorAllocator },
+		{ "DeferredRelease",	BenchmarkDeferredRelease },
+		{ "Text",				BenchmarkText },
+		{ "SpriteBatch",		BenchmarkSpriteBatch },
+		{ "InstanceBatch",		BenchmarkInstanceBatch },
+		{ "NetClientChurn",		BenchmarkNetClientChurn },
+	};
+}
+
+//-----------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	bool isQuick = false;
+	std::vector<char const*> selectedNames;
+	for (int argIndex = 1; argIndex < argc; ++argIndex)
+	{
+		if (strcmp(argv[argIndex], "--quick") == 0)
+		{
+			isQuick = true;
+		}
+		else
+		{
+			selectedNames.push_back(argv[argIndex]);
+		}
+	}
+
+	int numRun = 0;
+	for (EngineBenchmark const& benchmark : s_benchmarks)
+	{
+		bool isSelected = selectedNames.empty();
+		for (char const* name : selectedNames)
+		{
+			isSelected = isSelected || strcmp(name, benchmark.m_name) == 0;
+		}
+		if (isSelected)
+		{
+			benchmark.m_function(isQuick);
+			++numRun;
+		}
+	}
+
+	if (numRun == 0)
+	{
+		printf("No benchmark matches the given names\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,150 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/Camera.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Everything a camera was told, its transforms rebuilt from scratch on every call
+	struct ReferenceCamera
+	{
+		bool		m_isPerspective = false;
+		Vec3		m_position;
+		EulerAngles	m_orientation;
+		Vec2		m_bottomLeft;
+		Vec2		m_topRight;
+		float		m_orthographicNear = 0.f;
+		float		m_orthographicFar = 1.f;
+		float		m_aspect = 1.f;
+		float		m_fov = 60.f;
+		float		m_perspectiveNear = 0.1f;
+		float		m_perspectiveFar = 100.f;
+		Mat44		m_cameraToRender;
+
+		Mat44 GetCameraToWorld() const
+		{
+			Mat44 cameraToWorld = m_orientation.GetAsMatrix_IFwd_JLeft_KUp();
+			cameraToWorld.SetTranslation3D(m_position);
+			return cameraToWorld;
+		}
+
+		Mat44 GetRenderToClip() const
+		{
+			if (m_isPerspective)
+			{
+				return Mat44::MakePerspectiveProjection(m_fov, m_aspect, m_perspectiveNear, m_perspectiveFar);
+			}
+			return Mat44::MakeOrthoProjection(m_bottomLeft.x, m_topRight.x, m_bottomLeft.y, m_topRight.y, m_orthographicNear, m_orthographicFar);
+		}
+
+		Mat44 GetWorldToClip() const
+		{
+			Mat44 worldToClip = GetRenderToClip();
+			worldToClip.Append(m_cameraToRender);
+			worldToClip.Append(GetCameraToWorld().GetOrthonormalInverse());
+			return worldToClip;
+		}
+	};
+
+	bool IsSameMatrix(Mat44 const& a, Mat44 const& b)
+	{
+		return memcmp(a.m_values, b.m_values, sizeof(a.m_values)) == 0;
+	}
+
+	// Reads every cached transform, so a setter that forgets to dirty one leaves it stale for the next check
+	bool MatchesReference(Camera const& camera, ReferenceCamera const& reference)
+	{
+		Mat44 clipToWorld = reference.GetWorldToClip();
+		clipToWorld.Inverse();
+		return IsSameMatrix(camera.GetCameraToWorldTransform(), reference.GetCameraToWorld())
+			&& IsSameMatrix(camera.GetWorldToCameraTransform(), reference.GetCameraToWorld().GetOrthonormalInverse())
+			&& IsSameMatrix(camera.GetCameraToRenderTransform(), reference.m_cameraToRender)
+			&& IsSameMatrix(camera.GetRenderToClipTransform(), reference.GetRenderToClip())
+			&& IsSameMatrix(camera.GetProjectionMatrix(), reference.GetRenderToClip())
+			&& IsSameMatrix(camera.GetWorldToClipTransform(), reference.GetWorldToClip())
+			&& IsSameMatrix(camera.GetClipToWorldTransform(), clipToWorld);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(Camera, CachedTransformsFollowEverySetter)
+{
+	Camera camera;
+	ReferenceCamera reference;
+	camera.SetOrthographicView(Vec2(-8.f, -4.5f), Vec2(8.f, 4.5f), 0.f, 1.f);
+	reference.m_bottomLeft = Vec2(-8.f, -4.5f);
+	reference.m_topRight = Vec2(8.f, 4.5f);
+	TEST_CHECK(MatchesReference(camera, reference));
+
+	camera.Translate2D(Vec2(3.f, -1.f));
+	reference.m_bottomLeft += Vec2(3.f, -1.f);
+	reference.m_topRight += Vec2(3.f, -1.f);
+	TEST_CHECK(MatchesReference(camera, reference));
+
+	camera.SetPerspectiveView(16.f / 9.f, 70.f, 0.2f, 500.f);
+	reference.m_isPerspective = true;
+	reference.m_aspect = 16.f / 9.f;
+	reference.m_fov = 70.f;
+	reference.m_perspectiveNear = 0.2f;
+	reference.m_perspectiveFar = 500.f;
+	TEST_CHECK(MatchesReference(camera, reference));
+
+	camera.SetCameraToRenderTransform(Mat44::DIRECTX_C2R);
+	reference.m_cameraToRender = Mat44::DIRECTX_C2R;
+	TEST_CHECK(MatchesReference(camera, reference));
+
+	camera.SetPosition(Vec3(10.f, -4.f, 2.5f));
+	reference.m_position = Vec3(10.f, -4.f, 2.5f);
+	TEST_CHECK(MatchesReference(camera, reference));
+
+	camera.SetOrientation(EulerAngles(35.f, -20.f, 5.f));
+	reference.m_orientation = EulerAngles(35.f, -20.f, 5.f);
+	TEST_CHECK(MatchesReference(camera, reference));
+
+	camera.SetPositionAndOrientation(Vec3(-1.f, 2.f, 3.f), EulerAngles(-90.f, 10.f, 0.f));
+	reference.m_position = Vec3(-1.f, 2.f, 3.f);
+	reference.m_orientation = EulerAngles(-90.f, 10.f, 0.f);
+	TEST_CHECK(MatchesReference(camera, reference));
+
+	// A copy carries its cache along and stays correct on its own
+	Camera copy = camera;
+	copy.SetPosition(Vec3(7.f, 7.f, 7.f));
+	ReferenceCamera copyReference = reference;
+	copyReference.m_position = Vec3(7.f, 7.f, 7.f);
+	TEST_CHECK(MatchesReference(copy, copyReference));
+	TEST_CHECK(MatchesReference(camera, reference));
+
+	camera.SetOrthoView(Vec2(0.f, 0.f), Vec2(1600.f, 800.f));
+	reference.m_isPerspective = false;
+	reference.m_bottomLeft = Vec2(0.f, 0.f);
+	reference.m_topRight = Vec2(1600.f, 800.f);
+	reference.m_orthographicNear = 0.f;
+	reference.m_orthographicFar = 1.f;
+	TEST_CHECK(MatchesReference(camera, reference));
+}
+
+ENGINE_TEST(Camera, ProjectionMatchesWorldToClip)
+{
+	Camera camera;
+	camera.SetPerspectiveView(2.f, 60.f, 0.1f, 100.f);
+	camera.SetCameraToRenderTransform(Mat44::DIRECTX_C2R);
+	camera.SetPositionAndOrientation(Vec3(-5.f, 0.f, 0.f), EulerAngles());
+
+	// Straight ahead lands in the middle, behind the camera is left alone
+	Vec3 const points[] = { Vec3(5.f, 0.f, 0.f), Vec3(-10.f, 0.f, 0.f) };
+	Vec2 viewportPositions[2] = { Vec2(-1.f, -1.f), Vec2(-1.f, -1.f) };
+	bool isInFront[2] = {};
+	TEST_CHECK_EQUAL(camera.ProjectWorldToViewportPoints(points, 2, viewportPositions, isInFront), 1);
+	TEST_CHECK(isInFront[0] && !isInFront[1]);
+	TEST_CHECK(viewportPositions[0].x > 0.4999f && viewportPositions[0].x < 0.5001f);
+	TEST_CHECK(viewportPositions[0].y > 0.4999f && viewportPositions[0].y < 0.5001f);
+	TEST_CHECK(viewportPositions[1].x == -1.f);
+
+	// Moving the camera must move the projection, not reuse the cached world to clip
+	camera.SetPosition(Vec3(-5.f, 0.f, 5.f));
+	Vec2 movedPosition;
+	TEST_CHECK(camera.ProjectWorldToViewportPoint(points[0], movedPosition));
+	TEST_CHECK(movedPosition.y < 0.4f);
+}
@@ -0,0 +1,111 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Core/DebugRender.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Renderer/Camera.hpp"
+#include "Engine/Renderer/NullRenderer.hpp"
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Moves only when told to, so expiry does not depend on how fast the test runs
+	class ManualClock : public Clock
+	{
+	public:
+		void AdvanceSeconds(double seconds) { Advance(seconds); }
+	};
+
+	// Vertexes the debug renderer drew this frame, finished objects are skipped even while still held
+	uint64_t DrawWorldFrame(NullRenderer& renderer, Camera const& camera)
+	{
+		renderer.BeginFrame();
+		DebugRenderBeginFrame();
+		DebugRenderWorld(camera);
+		DebugRenderEndFrame();
+		renderer.EndFrame();
+		return renderer.GetLastFrameCounters().m_numVertexes;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(DebugRender, ExpiryBucketsDropExactlyTheExpired)
+{
+	g_theEventSystem = new EventSystem(EventSystemConfig());
+	g_theEventSystem->Startup();
+	RendererConfig rendererConfig;
+	NullRenderer renderer(rendererConfig);
+	renderer.Startup();
+	renderer.CreateOrGetTextureFromImage(Image(IntVec2(256, 256), Rgba8::OPAQUE_WHITE, "DebugRenderTestFont.png"));
+
+	ManualClock clock;
+	DebugRenderConfig config;
+	config.m_renderer = &renderer;
+	config.m_clock = &clock;
+	config.m_fontPath = "";
+	config.m_fontName = "DebugRenderTestFont";
+	DebugRenderSystemStartup(config);
+
+	Camera camera;
+	camera.SetPerspectiveView(2.f, 60.f, 0.1f, 100.f);
+	camera.SetCameraToRenderTransform(Mat44::DIRECTX_C2R);
+	camera.SetPositionAndOrientation(Vec3(-10.f, 0.f, 0.f), EulerAngles());
+
+	// Buckets are a quarter second: expiring at 0.1 and 0 share bucket 0, 0.3 is in bucket 1, 0.6 in bucket 2
+	DebugAddWorldWireSphere(Vec3(), 1.f, 0.1f);
+	DebugAddWorldWireSphere(Vec3(), 1.f, 0.3f);
+	DebugAddWorldWireSphere(Vec3(), 1.f, 0.6f);
+	DebugAddWorldWireSphere(Vec3(), 1.f, -1.f);
+	DebugAddWorldWireSphere(Vec3(), 1.f, 0.f);
+	DebugAddScreenText("screen", AABB2(Vec2(0.f, 0.f), Vec2(100.f, 20.f)), 10.f, Vec2(0.f, 0.f), 0.3f);
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 5);
+	TEST_CHECK_EQUAL(DebugRenderGetNumScreenObjects(), 1);
+	uint64_t sphereVertexes = DrawWorldFrame(renderer, camera) / 5;
+	TEST_CHECK(sphereVertexes > 0);
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 5);
+
+	// Two are finished but their bucket has not passed, they are held and not drawn
+	clock.AdvanceSeconds(0.2);
+	TEST_CHECK_EQUAL(DrawWorldFrame(renderer, camera), 3 * sphereVertexes);
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 5);
+
+	clock.AdvanceSeconds(0.06);
+	TEST_CHECK_EQUAL(DrawWorldFrame(renderer, camera), 3 * sphereVertexes);
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 3);
+	TEST_CHECK_EQUAL(DebugRenderGetNumScreenObjects(), 1);
+
+	// Added after bucket 0 went, expiring with the 0.3 one in bucket 1
+	DebugAddWorldWireSphere(Vec3(), 1.f, 0.05f);
+	TEST_CHECK_EQUAL(DrawWorldFrame(renderer, camera), 4 * sphereVertexes);
+	clock.AdvanceSeconds(0.24);
+	TEST_CHECK_EQUAL(DrawWorldFrame(renderer, camera), 2 * sphereVertexes);
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 2);
+	TEST_CHECK_EQUAL(DebugRenderGetNumScreenObjects(), 0);
+
+	// A jump past every bucket, only the infinite one stays
+	clock.AdvanceSeconds(100.0);
+	TEST_CHECK_EQUAL(DrawWorldFrame(renderer, camera), sphereVertexes);
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 1);
+
+	// Buckets keep working after the jump
+	DebugAddWorldWireSphere(Vec3(), 1.f, 0.1f);
+	DebugAddWorldWireSphere(Vec3(), 1.f, 1.f);
+	clock.AdvanceSeconds(0.5);
+	TEST_CHECK_EQUAL(DrawWorldFrame(renderer, camera), 2 * sphereVertexes);
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 2);
+	clock.AdvanceSeconds(1.0);
+	DrawWorldFrame(renderer, camera);
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 1);
+
+	DebugRenderClear();
+	TEST_CHECK_EQUAL(DebugRenderGetNumWorldObjects(), 0);
+	DebugRenderSystemShutdown();
+	renderer.Shutdown();
+	g_theEventSystem->Shutdown();
+	delete g_theEventSystem;
+	g_theEventSystem = nullptr;
+}
@@ -0,0 +1,228 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/DescriptorAllocator.hpp"
+#include "Engine/Renderer/RendererCommon.hpp"
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(DescriptorAllocator, RangeAllocateFreeCoalesce)
+{
+	DescriptorRangeAllocator allocator(100);
+	TEST_CHECK_EQUAL(allocator.Allocate(0), INVALID_INDEX_U32);
+
+	uint32_t a = allocator.Allocate(10);
+	uint32_t b = allocator.Allocate(20);
+	uint32_t c = allocator.Allocate(30);
+	TEST_CHECK_EQUAL(a, 0u);
+	TEST_CHECK_EQUAL(b, 10u);
+	TEST_CHECK_EQUAL(c, 30u);
+	TEST_CHECK_EQUAL(allocator.GetNumAllocated(), 60u);
+	TEST_CHECK_EQUAL(allocator.GetRangeSize(b), 20u);
+	TEST_CHECK_EQUAL(allocator.GetNumFreeBlocks(), 1);
+
+	// Only the start of a live range frees it, and only once
+	TEST_CHECK(!allocator.Free(b + 1));
+	TEST_CHECK(allocator.Free(b));
+	TEST_CHECK(!allocator.Free(b));
+	TEST_CHECK_EQUAL(allocator.GetRangeSize(b), 0u);
+	TEST_CHECK_EQUAL(allocator.GetNumFreeBlocks(), 2);
+	TEST_CHECK(allocator.GetFragmentation() > 0.f);
+
+	// Freeing a merges with the hole after it, freeing c joins everything back into one block
+	TEST_CHECK(allocator.Free(a));
+	TEST_CHECK_EQUAL(allocator.GetNumFreeBlocks(), 2);
+	TEST_CHECK_EQUAL(allocator.GetLargestFreeBlock(), 40u);
+	TEST_CHECK(allocator.Free(c));
+	TEST_CHECK_EQUAL(allocator.GetNumFreeBlocks(), 1);
+	TEST_CHECK_EQUAL(allocator.GetLargestFreeBlock(), 100u);
+	TEST_CHECK_EQUAL(allocator.GetNumAllocated(), 0u);
+	TEST_CHECK(allocator.GetFragmentation() == 0.f);
+}
+
+ENGINE_TEST(DescriptorAllocator, RangeBestFitAndFull)
+{
+	DescriptorRangeAllocator allocator(64);
+	uint32_t first = allocator.Allocate(8);
+	uint32_t keepA = allocator.Allocate(1);
+	uint32_t second = allocator.Allocate(4);
+	uint32_t keepB = allocator.Allocate(1);
+	TEST_CHECK(keepA != INVALID_INDEX_U32 && keepB != INVALID_INDEX_U32);
+	allocator.Free(first);
+	allocator.Free(second);
+
+	// Holes of 8 and 4 plus the 50 at the end: a 3 goes into the 4, an 8 into the 8
+	TEST_CHECK_EQUAL(allocator.Allocate(3), second);
+	TEST_CHECK_EQUAL(allocator.Allocate(8), first);
+	TEST_CHECK_EQUAL(allocator.Allocate(50), 14u);
+	TEST_CHECK_EQUAL(allocator.Allocate(2), INVALID_INDEX_U32);
+	TEST_CHECK_EQUAL(allocator.Allocate(1), second + 3);
+	TEST_CHECK_EQUAL(allocator.GetNumAllocated(), 64u);
+	TEST_CHECK_EQUAL(allocator.Allocate(1), INVALID_INDEX_U32);
+
+	allocator.Reset(16);
+	TEST_CHECK_EQUAL(allocator.GetNumAllocated(), 0u);
+	TEST_CHECK_EQUAL(allocator.Allocate(16), 0u);
+}
+
+// Random tables against an ownership map of every descriptor
+ENGINE_TEST(DescriptorAllocator, RangeRandomChurn)
+{
+	constexpr uint32_t CAPACITY = 2048;
+	DescriptorRangeAllocator allocator(CAPACITY);
+	std::vector<int> owners(CAPACITY, -1);
+	std::vector<uint32_t> liveStarts;
+	std::mt19937 random(77);
+
+	int numOverlaps = 0;
+	int numBadFrees = 0;
+	for (int operation = 0; operation < 20000; ++operation)
+	{
+		bool doAllocate = liveStarts.empty() || (random() % 100) < 55;
+		if (doAllocate)
+		{
+			uint32_t count = (random() % 4 == 0) ? 1 + random() % 32 : 1;
+			uint32_t start = allocator.Allocate(count);
+			if (start == INVALID_INDEX_U32)
+			{
+				continue;
+			}
+			for (uint32_t index = start; index < start + count; ++index)
+			{
+				numOverlaps += (index >= CAPACITY || owners[index] != -1) ? 1 : 0;
+				if (index < CAPACITY)
+				{
+					owners[index] = static_cast<int>(start);
+				}
+			}
+			liveStarts.push_back(start);
+		}
+		else
+		{
+			size_t liveIndex = random() % liveStarts.size();
+			uint32_t start = liveStarts[liveIndex];
+			uint32_t count = allocator.GetRangeSize(start);
+			numBadFrees += allocator.Free(start) ? 0 : 1;
+			for (uint32_t index = start; index < start + count; ++index)
+			{
+				owners[index] = -1;
+			}
+			liveStarts[liveIndex] = liveStarts.back();
+			liveStarts.pop_back();
+		}
+	}
+	TEST_CHECK_EQUAL(numOverlaps, 0);
+	TEST_CHECK_EQUAL(numBadFrees, 0);
+
+	uint32_t numOwned = 0;
+	for (int owner : owners)
+	{
+		numOwned += (owner != -1) ? 1 : 0;
+	}
+	TEST_CHECK_EQUAL(allocator.GetNumAllocated(), numOwned);
+
+	// Everything freed coalesces back into a single block
+	for (uint32_t start : liveStarts)
+	{
+		allocator.Free(start);
+	}
+	TEST_CHECK_EQUAL(allocator.GetNumFreeBlocks(), 1);
+	TEST_CHECK_EQUAL(allocator.GetLargestFreeBlock(), CAPACITY);
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(DescriptorAllocator, RingWrapsAndRecyclesByFence)
+{
+	DescriptorRing ring(16);
+	TEST_CHECK_EQUAL(ring.Allocate(0), INVALID_INDEX_U32);
+	TEST_CHECK_EQUAL(ring.Allocate(17), INVALID_INDEX_U32);
+
+	TEST_CHECK_EQUAL(ring.Allocate(6), 0u);
+	ring.RetireFrame(1);
+	TEST_CHECK_EQUAL(ring.Allocate(6), 6u);
+	ring.RetireFrame(2);
+
+	// 4 left at the end is too short for 5, and frame 1 still holds the start
+	TEST_CHECK_EQUAL(ring.Allocate(5), INVALID_INDEX_U32);
+	ring.Recycle(0);
+	TEST_CHECK_EQUAL(ring.GetNumUsed(), 12u);
+
+	// Once frame 1 completed the range skips the tail and wraps to 0
+	ring.Recycle(1);
+	TEST_CHECK_EQUAL(ring.GetNumUsed(), 6u);
+	TEST_CHECK_EQUAL(ring.Allocate(5), 0u);
+	TEST_CHECK_EQUAL(ring.GetNumUsed(), 15u); // the skipped tail counts until its frame retires
+	TEST_CHECK_EQUAL(ring.Allocate(2), INVALID_INDEX_U32);
+	TEST_CHECK_EQUAL(ring.Allocate(1), 5u);
+	ring.RetireFrame(3);
+	TEST_CHECK_EQUAL(ring.GetPeakUsed(), 16u);
+
+	ring.Recycle(3);
+	TEST_CHECK_EQUAL(ring.GetNumUsed(), 0u);
+
+	// An empty ring starts over at 0
+	TEST_CHECK_EQUAL(ring.Allocate(16), 0u);
+}
+
+// Frames of random tables with three in flight, against an ownership map of every descriptor
+ENGINE_TEST(DescriptorAllocator, RingRandomFramesInFlight)
+{
+	constexpr uint32_t CAPACITY = 1000;
+	constexpr uint64_t FRAMES_IN_FLIGHT = 3;
+	DescriptorRing ring(CAPACITY);
+	std::vector<uint64_t> ownerFence(CAPACITY, 0); // 0 is free
+	std::deque<std::pair<uint64_t, std::vector<std::pair<uint32_t, uint32_t>>>> framesInFlight;
+	std::mt19937 random(5);
+
+	int numOverlaps = 0;
+	int numFailedAllocations = 0;
+	for (uint64_t fenceValue = 1; fenceValue <= 2000; ++fenceValue)
+	{
+		uint64_t completedFenceValue = fenceValue > FRAMES_IN_FLIGHT ? fenceValue - FRAMES_IN_FLIGHT : 0;
+		ring.Recycle(completedFenceValue);
+		while (!framesInFlight.empty() && framesInFlight.front().first <= completedFenceValue)
+		{
+			for (std::pair<uint32_t, uint32_t> const& range : framesInFlight.front().second)
+			{
+				for (uint32_t index = range.first; index < range.first + range.second; ++index)
+				{
+					ownerFence[index] = 0;
+				}
+			}
+			framesInFlight.pop_front();
+		}
+
+		std::vector<std::pair<uint32_t, uint32_t>> frameRanges;
+		int numTables = static_cast<int>(random() % 40);
+		for (int tableIndex = 0; tableIndex < numTables; ++tableIndex)
+		{
+			uint32_t count = 1 + random() % 8;
+			uint32_t start = ring.Allocate(count);
+			if (start == INVALID_INDEX_U32)
+			{
+				++numFailedAllocations;
+				continue;
+			}
+			for (uint32_t index = start; index < start + count; ++index)
+			{
+				numOverlaps += (index >= CAPACITY || ownerFence[index] != 0) ? 1 : 0;
+				if (index < CAPACITY)
+				{
+					ownerFence[index] = fenceValue;
+				}
+			}
+			frameRanges.push_back(std::make_pair(start, count));
+		}
+		ring.RetireFrame(fenceValue);
+		if (!frameRanges.empty())
+		{
+			framesInFlight.push_back(std::make_pair(fenceValue, frameRanges));
+		}
+	}
+
+	// At most 3 x 39 x 8 descriptors plus skipped tails are ever live, well under the capacity
+	TEST_CHECK_EQUAL(numOverlaps, 0);
+	TEST_CHECK_EQUAL(numFailedAllocations, 0);
+	TEST_CHECK(ring.GetPeakUsed() <= CAPACITY);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// Minimal test registry for the headless build. Each ENGINE_TEST registers itself before main,
+// EngineTests runs every test, or only the suites named on the command line, and exits non-zero
+// when any TEST_CHECK failed. CMake adds one ctest entry per suite.
+//
+//	ENGINE_TEST(WorkerPool, NestedParallelFor)
+//	{
+//		TEST_CHECK(sum == expected);
+//	}
+//
+typedef void (*EngineTestFunction)();
+
+struct EngineTestCase
+{
+	char const*			m_suiteName = nullptr;
+	char const*			m_testName = nullptr;
+	EngineTestFunction	m_function = nullptr;
+};
+
+std::vector<EngineTestCase>& GetEngineTestCases();
+
+struct EngineTestRegistrar
+{
+	EngineTestRegistrar(char const* suiteName, char const* testName, EngineTestFunction function);
+};
+
+// Safe from any thread, the test keeps running after a failed check
+void ReportEngineTestFailure(char const* fileName, int lineNumber, std::string const& message);
+
+#define ENGINE_TEST(suiteName, testName)																			\
+	static void EngineTest_##suiteName##_##testName();																\
+	static EngineTestRegistrar s_engineTestRegistrar_##suiteName##_##testName(#suiteName, #testName, EngineTest_##suiteName##_##testName);	\
+	static void EngineTest_##suiteName##_##testName()
+
+#define TEST_CHECK(expression)																						\
+	do																												\
+	{																												\
+		if (!(expression))																							\
+		{																											\
+			ReportEngineTestFailure(__FILE__, __LINE__, #expression);												\
+		}																											\
+	} while (0)
+
+#define TEST_CHECK_EQUAL(actual, expected)																			\
+	do																												\
+	{																												\
+		auto const& actualValue_ = (actual);																		\
+		auto const& expectedValue_ = (expected);																	\
+		if (!(actualValue_ == expectedValue_))																		\
+		{																											\
+			ReportEngineTestFailure(__FILE__, __LINE__, std::string(#actual " == " #expected " (got ")			\
+				+ std::to_string(actualValue_) + ", expected " + std::to_string(expectedValue_) + ")");			\
+		}																											\
+	} while (0)
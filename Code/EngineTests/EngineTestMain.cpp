@@ -0,0 +1,76 @@
+#include "EngineTests/EngineTest.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+namespace
+{
+	std::atomic<int>	s_numFailedChecks{ 0 };
+	std::mutex			s_reportMutex;
+}
+
+//-----------------------------------------------------------------------------------------------
+std::vector<EngineTestCase>& GetEngineTestCases()
+{
+	static std::vector<EngineTestCase> s_testCases;
+	return s_testCases;
+}
+
+EngineTestRegistrar::EngineTestRegistrar(char const* suiteName, char const* testName, EngineTestFunction function)
+{
+	EngineTestCase testCase;
+	testCase.m_suiteName = suiteName;
+	testCase.m_testName = testName;
+	testCase.m_function = function;
+	GetEngineTestCases().push_back(testCase);
+}
+
+void ReportEngineTestFailure(char const* fileName, int lineNumber, std::string const& message)
+{
+	s_numFailedChecks.fetch_add(1);
+	std::lock_guard<std::mutex> lock(s_reportMutex);
+	printf("%s(%d): check failed: %s\n", fileName, lineNumber, message.c_str());
+}
+
+//-----------------------------------------------------------------------------------------------
+// EngineTests [suite ...]
+int main(int argc, char* argv[])
+{
+	int numRun = 0;
+	int numFailed = 0;
+	for (EngineTestCase const& testCase : GetEngineTestCases())
+	{
+		bool isSelected = (argc <= 1);
+		for (int argIndex = 1; argIndex < argc; ++argIndex)
+		{
+			isSelected = isSelected || strcmp(argv[argIndex], testCase.m_suiteName) == 0;
+		}
+		if (!isSelected)
+		{
+			continue;
+		}
+
+		printf("[ RUN  ] %s.%s\n", testCase.m_suiteName, testCase.m_testName);
+		fflush(stdout);
+		int failedChecksBefore = s_numFailedChecks.load();
+		auto startTime = std::chrono::steady_clock::now();
+		testCase.m_function();
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		bool passed = (s_numFailedChecks.load() == failedChecksBefore);
+		printf("[ %s ] %s.%s (%.1f ms)\n", passed ? " OK " : "FAIL", testCase.m_suiteName, testCase.m_testName, milliseconds);
+		fflush(stdout);
+		++numRun;
+		numFailed += passed ? 0 : 1;
+	}
+
+	printf("%d tests run, %d failed\n", numRun, numFailed);
+	if (numRun == 0)
+	{
+		printf("No test matches the given suite names\n");
+		return 1;
+	}
+	return numFailed == 0 ? 0 : 1;
+}
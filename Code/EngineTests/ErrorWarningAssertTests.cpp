@@ -0,0 +1,45 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	// Runs failingCode in a child process and returns its wait status
+	template <typename Function>
+	int RunInChildProcess(Function const& failingCode)
+	{
+		fflush(stdout);
+		pid_t childId = fork();
+		if (childId == 0)
+		{
+			failingCode();
+			_exit(0);
+		}
+		int status = 0;
+		waitpid(childId, &status, 0);
+		return status;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(ErrorWarningAssert, FatalErrorAborts)
+{
+	int status = RunInChildProcess([]() { ERROR_AND_DIE("Expected fatal error from ErrorWarningAssert tests"); });
+	TEST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+
+	status = RunInChildProcess([]() { GUARANTEE_OR_DIE(1 + 1 == 3, "Expected guarantee failure from ErrorWarningAssert tests"); });
+	TEST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+}
+
+// Without a dialog to answer, a recoverable warning carries on
+ENGINE_TEST(ErrorWarningAssert, RecoverableWarningContinues)
+{
+	int status = RunInChildProcess([]() { ERROR_RECOVERABLE("Expected warning from ErrorWarningAssert tests"); });
+	TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+#endif
@@ -0,0 +1,173 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Core/FileArchive.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <random>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	namespace fs = std::filesystem;
+
+	// Compressible, incompressible, empty, always stored and nested files, more than one batch of tiny ones
+	std::map<std::string, std::vector<uint8_t>> WriteSourceFiles(std::string const& sourceDirectory)
+	{
+		std::map<std::string, std::vector<uint8_t>> contents;
+		std::string text;
+		for (int lineIndex = 0; lineIndex < 2000; ++lineIndex)
+		{
+			text += "line " + std::to_string(lineIndex % 37) + " of a very repetitive text file\n";
+		}
+		contents["text.txt"] = std::vector<uint8_t>(text.begin(), text.end());
+
+		std::mt19937 random(7);
+		std::vector<uint8_t> noise(100000);
+		for (uint8_t& byte : noise)
+		{
+			byte = static_cast<uint8_t>(random());
+		}
+		contents["noise.bin"] = noise;
+		contents["empty.txt"] = std::vector<uint8_t>();
+		contents["images/stored.png"] = std::vector<uint8_t>(text.begin(), text.begin() + 5000);
+		for (int fileIndex = 0; fileIndex < 300; ++fileIndex)
+		{
+			std::string small = "small file " + std::to_string(fileIndex);
+			contents["small/" + std::to_string(fileIndex) + ".txt"] = std::vector<uint8_t>(small.begin(), small.end());
+		}
+
+		fs::remove_all(sourceDirectory);
+		for (auto const& pathAndContents : contents)
+		{
+			fs::path filePath = fs::path(sourceDirectory) / pathAndContents.first;
+			fs::create_directories(filePath.parent_path());
+			FileWriteFromBuffer(pathAndContents.second, filePath.string());
+		}
+		return contents;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(FileArchive, StreamedBuildRoundTrips)
+{
+	std::string const sourceDirectory = "/tmp/EngineTests_ArchiveSource";
+	std::map<std::string, std::vector<uint8_t>> contents = WriteSourceFiles(sourceDirectory);
+
+	WorkerPool workers(3);
+	std::vector<uint8_t> firstArchiveBytes;
+	for (size_t batchBytes : { size_t(1), size_t(4096), size_t(64 * 1024 * 1024) })
+	{
+		for (WorkerPool* pool : { static_cast<WorkerPool*>(nullptr), &workers })
+		{
+			std::string const archivePath = "/tmp/EngineTests_Archive.pak";
+			FileArchiveBuildConfig config;
+			config.m_batchBytes = batchBytes;
+			FileArchiveBuildResult result;
+			TEST_CHECK(BuildFileArchive(sourceDirectory, archivePath, config, pool, &result));
+			TEST_CHECK_EQUAL(result.m_numFiles, static_cast<int>(contents.size()));
+			TEST_CHECK(result.m_numCompressed > 0);
+
+			FileArchive archive;
+			TEST_CHECK(archive.Open(archivePath));
+			TEST_CHECK_EQUAL(archive.GetNumEntries(), static_cast<int>(contents.size()));
+			TEST_CHECK_EQUAL(archive.GetArchiveSize(), result.m_archiveBytes);
+			for (auto const& pathAndContents : contents)
+			{
+				std::vector<uint8_t> readBack;
+				TEST_CHECK(archive.ReadFile(pathAndContents.first, readBack));
+				TEST_CHECK(readBack == pathAndContents.second);
+			}
+			FileArchiveEntry const* stored = archive.FindEntry("images/stored.png");
+			TEST_CHECK(stored && stored->m_compression == static_cast<uint32_t>(FileArchiveCompression::NONE));
+			for (int entryIndex = 0; entryIndex < archive.GetNumEntries(); ++entryIndex)
+			{
+				TEST_CHECK_EQUAL(archive.GetEntry(entryIndex).m_dataOffset % config.m_dataAlignment, 0ull);
+			}
+			archive.Close();
+
+			// Batching and threading must not change a byte
+			std::vector<uint8_t> archiveBytes;
+			FileReadToBuffer(archiveBytes, archivePath);
+			if (firstArchiveBytes.empty())
+			{
+				firstArchiveBytes = archiveBytes;
+			}
+			TEST_CHECK(archiveBytes == firstArchiveBytes);
+			fs::remove(archivePath);
+		}
+	}
+	fs::remove_all(sourceDirectory);
+}
+
+ENGINE_TEST(FileArchive, RejectsEntriesOf4GB)
+{
+	std::string const sourceDirectory = "/tmp/EngineTests_HugeArchiveSource";
+	std::string const archivePath = "/tmp/EngineTests_HugeArchive.pak";
+	fs::remove_all(sourceDirectory);
+	fs::create_directories(sourceDirectory);
+	FileWriteFromString("small", sourceDirectory + "/small.txt");
+
+	// Sparse, so the test costs no disk space, and rejected from its listed size before anything is mapped
+	std::error_code error;
+	fs::path hugePath = fs::path(sourceDirectory) / "huge.bin";
+	FileWriteFromString("", hugePath.string());
+	fs::resize_file(hugePath, 0x100000000ull, error);
+	if (!error)
+	{
+		TEST_CHECK(!BuildFileArchive(sourceDirectory, archivePath));
+		TEST_CHECK(!fs::exists(archivePath));
+	}
+	fs::remove_all(sourceDirectory);
+}
+
+// ReadFile allocates an entry's m_size before decompressing, so a corrupt size must fail Open
+ENGINE_TEST(FileArchive, RejectsImpossibleDecompressedSizes)
+{
+	std::string const sourceDirectory = "/tmp/EngineTests_CorruptArchiveSource";
+	std::string const archivePath = "/tmp/EngineTests_CorruptArchive.pak";
+	std::string const corruptPath = "/tmp/EngineTests_CorruptArchiveEdited.pak";
+	std::map<std::string, std::vector<uint8_t>> contents = WriteSourceFiles(sourceDirectory);
+	TEST_CHECK(BuildFileArchive(sourceDirectory, archivePath));
+
+	std::vector<uint8_t> archiveBytes;
+	FileReadToBuffer(archiveBytes, archivePath);
+	FileArchiveHeader header;
+	memcpy(static_cast<void*>(&header), archiveBytes.data(), sizeof(header));
+
+	// The entry table sits in the archive as is, find the compressed text file's entry in it
+	FileArchive archive;
+	TEST_CHECK(archive.Open(archivePath));
+	FileArchiveEntry const* textEntry = archive.FindEntry("text.txt");
+	TEST_CHECK(textEntry && textEntry->m_compression == static_cast<uint32_t>(FileArchiveCompression::LZ4));
+	size_t const entryOffset = static_cast<size_t>(header.m_entriesOffset) + static_cast<size_t>(textEntry - &archive.GetEntry(0)) * sizeof(FileArchiveEntry);
+	uint64_t const storedSize = textEntry->m_storedSize;
+	archive.Close();
+
+	auto openWithSize = [&](uint64_t size)
+		{
+			std::vector<uint8_t> corrupt = archiveBytes;
+			memcpy(corrupt.data() + entryOffset + offsetof(FileArchiveEntry, m_size), &size, sizeof(size));
+			FileWriteFromBuffer(corrupt, corruptPath);
+			FileArchive corruptArchive;
+			return corruptArchive.Open(corruptPath);
+		};
+	TEST_CHECK(!openWithSize(storedSize * 255 + 1));
+	TEST_CHECK(!openWithSize(0x100000000ull));
+	TEST_CHECK(!openWithSize(0xFFFFFFFFFFFFFFFFull));
+
+	// Within the bound Open accepts it, and the size mismatch fails the read instead
+	TEST_CHECK(openWithSize(storedSize * 255));
+	FileArchive corruptArchive;
+	TEST_CHECK(corruptArchive.Open(corruptPath));
+	std::vector<uint8_t> readBack;
+	TEST_CHECK(!corruptArchive.ReadFile("text.txt", readBack));
+	TEST_CHECK(corruptArchive.ReadFile("noise.bin", readBack) && readBack == contents["noise.bin"]);
+	corruptArchive.Close();
+
+	fs::remove(archivePath);
+	fs::remove(corruptPath);
+	fs::remove_all(sourceDirectory);
+}
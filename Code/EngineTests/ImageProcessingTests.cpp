@@ -0,0 +1,151 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/ImageProcessing.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <random>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Image::GetBoxBlurred before it moved to ImageProcessing: float sums of every tap. Also makes
+	// the exact result, floor(mean * 256 / 255) from integer sums, which the float path can miss
+	void GetReferenceBoxBlurred(Image const& source, int blurRadius, Image& out_oldBlurred, Image& out_exactBlurred)
+	{
+		out_oldBlurred = source;
+		out_exactBlurred = source;
+		IntVec2 dimensions = source.GetDimensions();
+		for (int texelY = 0; texelY < dimensions.y; ++texelY)
+		{
+			for (int texelX = 0; texelX < dimensions.x; ++texelX)
+			{
+				float sumR = 0.f;
+				float sumG = 0.f;
+				float sumB = 0.f;
+				float sumA = 0.f;
+				int exactSums[4] = {};
+				int count = 0;
+				for (int ky = -blurRadius; ky <= blurRadius; ++ky)
+				{
+					for (int kx = -blurRadius; kx <= blurRadius; ++kx)
+					{
+						IntVec2 neighborCoords(texelX + kx, texelY + ky);
+						if (source.IsInBounds(neighborCoords))
+						{
+							Rgba8 neighborColor = source.GetTexelColor(neighborCoords);
+							sumR += NormalizeByte(neighborColor.r);
+							sumG += NormalizeByte(neighborColor.g);
+							sumB += NormalizeByte(neighborColor.b);
+							sumA += NormalizeByte(neighborColor.a);
+							exactSums[0] += neighborColor.r;
+							exactSums[1] += neighborColor.g;
+							exactSums[2] += neighborColor.b;
+							exactSums[3] += neighborColor.a;
+							++count;
+						}
+					}
+				}
+				out_oldBlurred.SetTexelColor(IntVec2(texelX, texelY), Rgba8(DenormalizeByte(sumR / count), DenormalizeByte(sumG / count), DenormalizeByte(sumB / count), DenormalizeByte(sumA / count)));
+
+				unsigned char exact[4];
+				for (int channel = 0; channel < 4; ++channel)
+				{
+					int value = (exactSums[channel] * 256) / (255 * count);
+					exact[channel] = static_cast<unsigned char>((value > 255) ? 255 : value);
+				}
+				out_exactBlurred.SetTexelColor(IntVec2(texelX, texelY), Rgba8(exact[0], exact[1], exact[2], exact[3]));
+			}
+		}
+	}
+
+	Image MakeRandomImage(IntVec2 const& dimensions, unsigned int seed)
+	{
+		std::mt19937 random(seed);
+		Image image(dimensions, Rgba8::OPAQUE_WHITE);
+		for (int texelY = 0; texelY < dimensions.y; ++texelY)
+		{
+			for (int texelX = 0; texelX < dimensions.x; ++texelX)
+			{
+				// Flat patches as well as noise, so exact means show up and the float rounding gets tested
+				unsigned int value = random();
+				bool isPatch = ((texelX / 8 + texelY / 8) % 3) == 0;
+				unsigned char r = isPatch ? 200 : static_cast<unsigned char>(value);
+				unsigned char g = isPatch ? 17 : static_cast<unsigned char>(value >> 8);
+				image.SetTexelColor(IntVec2(texelX, texelY), Rgba8(r, g, static_cast<unsigned char>(value >> 16), static_cast<unsigned char>(value >> 24)));
+			}
+		}
+		return image;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+// GetBoxBlurred must give the exact result everywhere. The old float path may only have been one
+// step below it, on the rare channels whose mean sits exactly on a step
+ENGINE_TEST(ImageProcessing, BoxBlurMatchesOldGetBoxBlurred)
+{
+	IntVec2 const sizes[] = { IntVec2(1, 1), IntVec2(7, 3), IntVec2(61, 47), IntVec2(130, 9) };
+	int const radii[] = { 1, 2, 5, 17, 70 };
+
+	int numChannels = 0;
+	int numNotExact = 0;
+	int numOldOneBelow = 0;
+	int numOldOtherDifferences = 0;
+	unsigned int seed = 1;
+	for (IntVec2 const& size : sizes)
+	{
+		for (int blurRadius : radii)
+		{
+			Image source = MakeRandomImage(size, seed++);
+			Image oldBlurred;
+			Image exactBlurred;
+			GetReferenceBoxBlurred(source, blurRadius, oldBlurred, exactBlurred);
+			Image blurred = source.GetBoxBlurred(blurRadius);
+			TEST_CHECK(blurred.GetDimensions() == size);
+
+			for (int texelIndex = 0; texelIndex < size.x * size.y; ++texelIndex)
+			{
+				Rgba8 const& old = oldBlurred.GetRawTexels()[texelIndex];
+				Rgba8 const& actual = blurred.GetRawTexels()[texelIndex];
+				numNotExact += (actual == exactBlurred.GetRawTexels()[texelIndex]) ? 0 : 1;
+
+				int const oldDifferences[] = { actual.r - old.r, actual.g - old.g, actual.b - old.b, actual.a - old.a };
+				for (int difference : oldDifferences)
+				{
+					++numChannels;
+					numOldOneBelow += (difference == 1) ? 1 : 0;
+					numOldOtherDifferences += (difference != 0 && difference != 1) ? 1 : 0;
+				}
+			}
+		}
+	}
+
+	TEST_CHECK_EQUAL(numNotExact, 0);
+	TEST_CHECK_EQUAL(numOldOtherDifferences, 0);
+	TEST_CHECK(numOldOneBelow * 1000 <= numChannels); // at most 0.1%, even with the flat patches
+}
+
+ENGINE_TEST(ImageProcessing, BoxBlurSameWithWorkers)
+{
+	Image source = MakeRandomImage(IntVec2(200, 150), 99);
+	WorkerPool workers(3);
+	for (int blurRadius : { 0, 1, 4, 33 })
+	{
+		Image serial = GetBoxBlurredImage(source, blurRadius);
+		Image parallel = GetBoxBlurredImage(source, blurRadius, &workers);
+		int numDifferent = 0;
+		for (int texelIndex = 0; texelIndex < 200 * 150; ++texelIndex)
+		{
+			numDifferent += (serial.GetRawTexels()[texelIndex] == parallel.GetRawTexels()[texelIndex]) ? 0 : 1;
+		}
+		TEST_CHECK_EQUAL(numDifferent, 0);
+	}
+
+	// Radius 0 leaves the image as it was
+	Image unblurred = source.GetBoxBlurred(0);
+	int numChanged = 0;
+	for (int texelIndex = 0; texelIndex < 200 * 150; ++texelIndex)
+	{
+		numChanged += (unblurred.GetRawTexels()[texelIndex] == source.GetRawTexels()[texelIndex]) ? 0 : 1;
+	}
+	TEST_CHECK_EQUAL(numChanged, 0);
+}
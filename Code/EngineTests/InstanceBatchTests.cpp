@@ -0,0 +1,149 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/InstanceBatch.hpp"
+#include "Engine/Renderer/NullRenderer.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Math/Plane3.hpp"
+#include <cstring>
+#include <random>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	struct TestInstance
+	{
+		Mat44	m_transform;
+		Rgba8	m_color;
+		Vec3	m_worldCenter;
+		float	m_worldRadius = 0.f;
+	};
+
+	bool IsPackedAs(InstanceData const& packed, TestInstance const& instance)
+	{
+		float color[4];
+		instance.m_color.GetAsFloats(color);
+		return memcmp(packed.ModelToWorldTransform.m_values, instance.m_transform.m_values, sizeof(instance.m_transform.m_values)) == 0
+			&& memcmp(packed.ModelColor, color, sizeof(color)) == 0;
+	}
+
+	// The same test CullAndPack documents, written the slow way
+	bool IsVisible(TestInstance const& instance, Plane3 const* planes, int numPlanes, Vec3 const& viewPosition, float maxDistance)
+	{
+		if (maxDistance > 0.f && (instance.m_worldCenter - viewPosition).GetLength() > maxDistance + instance.m_worldRadius)
+		{
+			return false;
+		}
+		for (int planeIndex = 0; planeIndex < numPlanes; ++planeIndex)
+		{
+			if (planes[planeIndex].GetSignedDistanceToPoint(instance.m_worldCenter) < -instance.m_worldRadius)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(InstanceBatch, CullAndPackMatchesReference)
+{
+	Vec3 const localCenter(0.5f, 0.f, 0.f);
+	float const localRadius = 1.f;
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> position(-50.f, 50.f);
+	std::uniform_real_distribution<float> scale(0.5f, 4.f);
+	std::uniform_real_distribution<float> angle(0.f, 360.f);
+
+	InstanceBatch batch;
+	batch.SetLocalBounds(localCenter, localRadius);
+	std::vector<TestInstance> instances;
+	for (int instanceIndex = 0; instanceIndex < 2000; ++instanceIndex)
+	{
+		TestInstance instance;
+		Vec3 nonUniformScale(scale(random), scale(random), scale(random));
+		instance.m_transform = Mat44::MakeTranslation3D(Vec3(position(random), position(random), position(random)));
+		instance.m_transform.AppendZRotation(angle(random));
+		instance.m_transform.AppendScaleNonUniform3D(nonUniformScale);
+		instance.m_color = Rgba8(static_cast<unsigned char>(instanceIndex), static_cast<unsigned char>(instanceIndex >> 8), 7, 255);
+		instance.m_worldCenter = instance.m_transform.TransformPosition3D(localCenter);
+		float largestScale = (nonUniformScale.x > nonUniformScale.y) ? nonUniformScale.x : nonUniformScale.y;
+		instance.m_worldRadius = localRadius * ((nonUniformScale.z > largestScale) ? nonUniformScale.z : largestScale);
+		TEST_CHECK_EQUAL(batch.AddInstance(instance.m_transform, instance.m_color), instanceIndex);
+		instances.push_back(instance);
+	}
+
+	// Moving an instance moves its bounds
+	instances[5].m_transform = Mat44::MakeTranslation3D(Vec3(-1000.f, 0.f, 0.f));
+	instances[5].m_worldCenter = Vec3(-999.5f, 0.f, 0.f);
+	instances[5].m_worldRadius = localRadius;
+	batch.SetInstance(5, instances[5].m_transform, instances[5].m_color);
+
+	TEST_CHECK_EQUAL(batch.PackAll(), 2000);
+	for (int instanceIndex = 0; instanceIndex < 2000; ++instanceIndex)
+	{
+		TEST_CHECK(IsPackedAs(batch.GetPackedData()[instanceIndex], instances[instanceIndex]));
+	}
+
+	Plane3 const planes[] = { Plane3(Vec3(1.f, 0.f, 0.f), -10.f), Plane3(Vec3(0.f, -1.f, 0.f), -20.f), Plane3(Vec3(0.f, 0.6f, 0.8f), 0.f) };
+	Vec3 const viewPosition(0.f, 0.f, 5.f);
+	for (float maxDistance : { 0.f, 40.f })
+	{
+		for (int numPlanes : { 0, 1, 3 })
+		{
+			int numPacked = batch.CullAndPack(planes, numPlanes, viewPosition, maxDistance);
+			TEST_CHECK_EQUAL(numPacked, batch.GetNumPacked());
+
+			// Survivors in add order, each packed with its own transform and color
+			int packedIndex = 0;
+			for (TestInstance const& instance : instances)
+			{
+				if (IsVisible(instance, planes, numPlanes, viewPosition, maxDistance))
+				{
+					TEST_CHECK(packedIndex < numPacked && IsPackedAs(batch.GetPackedData()[packedIndex], instance));
+					++packedIndex;
+				}
+			}
+			TEST_CHECK_EQUAL(packedIndex, numPacked);
+			TEST_CHECK(numPacked > 0 && (numPlanes == 0 && maxDistance == 0.f ? numPacked == 2000 : numPacked < 2000));
+		}
+	}
+}
+
+ENGINE_TEST(InstanceBatch, DrawUploadsThePackedInstances)
+{
+	RendererConfig config;
+	NullRenderer renderer(config);
+	renderer.Startup();
+	VertexBuffer* vbo = renderer.CreateVertexBuffer(36 * sizeof(Vertex_PCU), sizeof(Vertex_PCU));
+	{
+		InstanceBatch batch;
+		batch.SetLocalBounds(Vec3(), 1.f);
+		for (int instanceIndex = 0; instanceIndex < 10; ++instanceIndex)
+		{
+			batch.AddInstance(Mat44::MakeTranslation3D(Vec3(static_cast<float>(instanceIndex) * 10.f, 0.f, 0.f)));
+		}
+		Plane3 const keepNearOrigin(Vec3(-1.f, 0.f, 0.f), -35.f);
+		RenderState material;
+
+		renderer.BeginFrame();
+		TEST_CHECK_EQUAL(batch.CullAndPack(&keepNearOrigin, 1, Vec3()), 4);
+		batch.Draw(&renderer, material, vbo, 36);
+		renderer.EndFrame();
+		RenderCounters const& counters = renderer.GetLastFrameCounters();
+		TEST_CHECK_EQUAL(counters.m_numDrawCalls, 1ull);
+		TEST_CHECK_EQUAL(counters.m_numInstances, 4ull);
+		TEST_CHECK_EQUAL(counters.m_numVertexes, 4ull * 36ull);
+		TEST_CHECK(counters.m_numBytesCopied >= 4 * sizeof(InstanceData));
+
+		// Nothing packed, nothing drawn
+		renderer.BeginFrame();
+		Plane3 const keepNothing(Vec3(1.f, 0.f, 0.f), 1000.f);
+		TEST_CHECK_EQUAL(batch.CullAndPack(&keepNothing, 1, Vec3()), 0);
+		batch.Draw(&renderer, material, vbo, 36);
+		renderer.EndFrame();
+		TEST_CHECK_EQUAL(renderer.GetLastFrameCounters().m_numDrawCalls, 0ull);
+		TEST_CHECK_EQUAL(renderer.GetLastFrameCounters().m_numInstances, 0ull);
+	}
+	delete vbo;
+	renderer.Shutdown();
+}
@@ -0,0 +1,226 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/LinearPageAllocator.hpp"
+#include <map>
+#include <random>
+#include <set>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Tracks the backend calls, so every created page has to be destroyed exactly once
+	class RecordingPageAllocator : public LinearPageAllocator
+	{
+	public:
+		explicit RecordingPageAllocator(size_t pageSize) : LinearPageAllocator(pageSize) {}
+		~RecordingPageAllocator() override { DestroyAllPages(); }
+
+		bool IsPageAlive(int pageIndex) const { return m_alivePages.count(pageIndex) != 0; }
+		int GetNumAlivePages() const { return static_cast<int>(m_alivePages.size()); }
+
+		int m_numCreateCalls = 0;
+		int m_numDestroyCalls = 0;
+		int m_numBadCalls = 0;
+
+	protected:
+		void CreatePage(int pageIndex, size_t capacity) override
+		{
+			++m_numCreateCalls;
+			m_numBadCalls += (capacity == 0 || !m_alivePages.insert(pageIndex).second) ? 1 : 0;
+		}
+
+		void DestroyPage(int pageIndex) override
+		{
+			++m_numDestroyCalls;
+			m_numBadCalls += (m_alivePages.erase(pageIndex) == 1) ? 0 : 1;
+		}
+
+		std::set<int> m_alivePages;
+	};
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(LinearPageAllocator, AlignsAndBumpsWithinPage)
+{
+	RecordingPageAllocator allocator(1024);
+	allocator.BeginFrame(0);
+
+	LinearPageAllocation first = allocator.AllocateRange(10, 16);
+	TEST_CHECK_EQUAL(first.m_offset, size_t(0));
+	TEST_CHECK_EQUAL(first.m_size, size_t(16));
+
+	LinearPageAllocation constants = allocator.AllocateRange(4, 256);
+	TEST_CHECK_EQUAL(constants.m_pageIndex, first.m_pageIndex);
+	TEST_CHECK_EQUAL(constants.m_offset, size_t(256));
+	TEST_CHECK_EQUAL(constants.m_size, size_t(256));
+
+	// Structured buffer stride, not a power of two
+	LinearPageAllocation structured = allocator.AllocateRangeAnyAlign(13, 12);
+	TEST_CHECK_EQUAL(structured.m_pageIndex, first.m_pageIndex);
+	TEST_CHECK_EQUAL(structured.m_offset, size_t(516));
+	TEST_CHECK_EQUAL(structured.m_size, size_t(24));
+
+	TEST_CHECK_EQUAL(allocator.GetStats().m_frameBytes, size_t(540));
+	TEST_CHECK_EQUAL(allocator.GetStats().m_framePages, 1);
+	TEST_CHECK_EQUAL(allocator.m_numCreateCalls, 1);
+}
+
+ENGINE_TEST(LinearPageAllocator, OverflowAndDedicatedPages)
+{
+	RecordingPageAllocator allocator(1024);
+	allocator.BeginFrame(0);
+
+	LinearPageAllocation first = allocator.AllocateRange(600, 4);
+	LinearPageAllocation second = allocator.AllocateRange(600, 4);
+	TEST_CHECK(second.m_pageIndex != first.m_pageIndex);
+	TEST_CHECK_EQUAL(second.m_offset, size_t(0));
+
+	// Larger than a page: a page of its own, and the current page keeps going afterwards
+	LinearPageAllocation huge = allocator.AllocateRange(5000, 16);
+	TEST_CHECK_EQUAL(huge.m_offset, size_t(0));
+	TEST_CHECK_EQUAL(allocator.GetPageCapacity(huge.m_pageIndex), size_t(5008));
+	LinearPageAllocation afterHuge = allocator.AllocateRange(100, 4);
+	TEST_CHECK_EQUAL(afterHuge.m_pageIndex, second.m_pageIndex);
+	TEST_CHECK_EQUAL(afterHuge.m_offset, size_t(600));
+	TEST_CHECK_EQUAL(allocator.GetStats().m_framePages, 3);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numPages, 3);
+
+	// Recycling destroys the dedicated page and pools the standard ones
+	allocator.RetireUsedPages(1);
+	allocator.BeginFrame(1);
+	TEST_CHECK(!allocator.IsPageAlive(huge.m_pageIndex));
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numPages, 2);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numFreePages, 2);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numPageBytes, size_t(2048));
+	TEST_CHECK_EQUAL(allocator.m_numDestroyCalls, 1);
+
+	// The next dedicated page takes the freed slot
+	LinearPageAllocation nextHuge = allocator.AllocateRange(3000, 16);
+	TEST_CHECK_EQUAL(nextHuge.m_pageIndex, huge.m_pageIndex);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numFreePages, 2);
+}
+
+ENGINE_TEST(LinearPageAllocator, RecyclesOnlyAfterFence)
+{
+	RecordingPageAllocator allocator(256);
+	allocator.BeginFrame(0);
+	allocator.AllocateRange(200, 4);
+	allocator.AllocateRange(200, 4);
+	allocator.RetireUsedPages(1);
+
+	// GPU still on frame 1, its pages are not reused
+	allocator.BeginFrame(0);
+	allocator.AllocateRange(200, 4);
+	allocator.AllocateRange(200, 4);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numPagesCreated, 4);
+	allocator.RetireUsedPages(2);
+
+	allocator.BeginFrame(1);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numFreePages, 2);
+	allocator.AllocateRange(200, 4);
+	allocator.AllocateRange(200, 4);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numPagesCreated, 4);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numFreePages, 0);
+
+	// Retiring nothing is not an error and does not need a new fence
+	allocator.RetireUsedPages(3);
+	allocator.RetireUsedPages(3);
+	allocator.BeginFrame(3);
+	TEST_CHECK_EQUAL(allocator.GetStats().m_numFreePages, 4);
+}
+
+ENGINE_TEST(LinearPageAllocator, FrameStats)
+{
+	RecordingPageAllocator allocator(1024);
+	allocator.AllocateRange(64, 4); // startup upload, before the first frame
+	allocator.RetireUsedPages(0);
+
+	size_t const frameSizes[] = { 100, 300, 200 };
+	for (int frameIndex = 0; frameIndex < 3; ++frameIndex)
+	{
+		allocator.BeginFrame(static_cast<uint64_t>(frameIndex));
+		allocator.AllocateRange(frameSizes[frameIndex], 4);
+		allocator.RetireUsedPages(static_cast<uint64_t>(frameIndex + 1));
+	}
+	allocator.BeginFrame(3);
+
+	LinearAllocatorStats const& stats = allocator.GetStats();
+	TEST_CHECK_EQUAL(stats.m_numFrames, uint64_t(3));
+	TEST_CHECK_EQUAL(stats.m_lastFrameBytes, size_t(200));
+	TEST_CHECK_EQUAL(stats.m_peakFrameBytes, size_t(300));
+	TEST_CHECK_EQUAL(stats.m_lastFramePages, 1);
+	TEST_CHECK(stats.m_averageFrameBytes > 199.9 && stats.m_averageFrameBytes < 200.1);
+	TEST_CHECK(!stats.ToString().empty());
+}
+
+//-----------------------------------------------------------------------------------------------
+// Random sizes and alignments with three frames in flight: allocations of a frame never overlap,
+// a page is never handed out before the GPU passed the fence it was retired with, and the pool
+// stops growing once it covers the frames in flight
+ENGINE_TEST(LinearPageAllocator, RandomFramesInFlight)
+{
+	constexpr int NUM_FRAMES = 300;
+	constexpr uint64_t FRAMES_IN_FLIGHT = 3;
+	std::mt19937 random(1234);
+	size_t const alignments[] = { 4, 16, 256, 12, 48 };
+
+	int numCreateCallsAtFrame100 = 0;
+	{
+		RecordingPageAllocator allocator(4096);
+		std::map<int, uint64_t> retiredFenceByPage;
+		int numOverlaps = 0;
+		int numEarlyReuses = 0;
+		int numOutOfBounds = 0;
+
+		for (int frameIndex = 0; frameIndex < NUM_FRAMES; ++frameIndex)
+		{
+			uint64_t fenceValue = static_cast<uint64_t>(frameIndex) + 1;
+			uint64_t completedFenceValue = fenceValue > FRAMES_IN_FLIGHT ? fenceValue - FRAMES_IN_FLIGHT : 0;
+			allocator.BeginFrame(completedFenceValue);
+
+			std::map<int, std::vector<std::pair<size_t, size_t>>> rangesByPage;
+			int numAllocations = static_cast<int>(random() % 64);
+			for (int allocIndex = 0; allocIndex < numAllocations; ++allocIndex)
+			{
+				size_t sizeInBytes = 1 + random() % ((random() % 16 == 0) ? 9000 : 700);
+				size_t alignment = alignments[random() % 5];
+				LinearPageAllocation alloc = (alignment & (alignment - 1)) == 0 ? allocator.AllocateRange(sizeInBytes, alignment) : allocator.AllocateRangeAnyAlign(sizeInBytes, alignment);
+
+				numOutOfBounds += (alloc.m_size >= sizeInBytes && alloc.m_offset % alignment == 0
+					&& alloc.m_offset + alloc.m_size <= allocator.GetPageCapacity(alloc.m_pageIndex) && allocator.IsPageAlive(alloc.m_pageIndex)) ? 0 : 1;
+
+				auto retired = retiredFenceByPage.find(alloc.m_pageIndex);
+				if (retired != retiredFenceByPage.end())
+				{
+					numEarlyReuses += (retired->second <= completedFenceValue) ? 0 : 1;
+					retiredFenceByPage.erase(retired);
+				}
+
+				for (std::pair<size_t, size_t> const& range : rangesByPage[alloc.m_pageIndex])
+				{
+					numOverlaps += (alloc.m_offset < range.second && range.first < alloc.m_offset + alloc.m_size) ? 1 : 0;
+				}
+				rangesByPage[alloc.m_pageIndex].push_back(std::make_pair(alloc.m_offset, alloc.m_offset + alloc.m_size));
+			}
+
+			allocator.RetireUsedPages(fenceValue);
+			for (auto const& pageRanges : rangesByPage)
+			{
+				retiredFenceByPage[pageRanges.first] = fenceValue;
+			}
+			if (frameIndex == 100)
+			{
+				numCreateCallsAtFrame100 = allocator.GetStats().m_numPagesCreated - allocator.m_numDestroyCalls;
+			}
+		}
+
+		TEST_CHECK_EQUAL(numOverlaps, 0);
+		TEST_CHECK_EQUAL(numEarlyReuses, 0);
+		TEST_CHECK_EQUAL(numOutOfBounds, 0);
+		TEST_CHECK_EQUAL(allocator.m_numBadCalls, 0);
+		TEST_CHECK_EQUAL(allocator.GetNumAlivePages(), allocator.GetStats().m_numPages);
+
+		// Standard pages created after warm up are rare, dedicated ones come and go
+		int numStandardPagesCreated = allocator.GetStats().m_numPagesCreated - allocator.m_numDestroyCalls;
+		TEST_CHECK(numStandardPagesCreated - numCreateCallsAtFrame100 <= 4);
+	}
+}
@@ -0,0 +1,276 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Network/NetConditioner.hpp"
+#include "Engine/Network/NetConnection.hpp"
+#include "Engine/Network/NetBuffer.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	NetConditionerConfig MakeConfig()
+	{
+		NetConditionerConfig config;
+		config.m_isEnabled = true;
+		config.m_maxQueuedBytes = 0;
+		return config;
+	}
+
+	void EnqueueCounter(NetConditioner& conditioner, uint32_t counter, size_t numBytes, double currentTime)
+	{
+		std::vector<uint8_t> data(numBytes, 0);
+		memcpy(data.data(), &counter, sizeof(counter));
+		conditioner.Enqueue(NetAddress(), data.data(), data.size(), currentTime);
+	}
+
+	uint32_t GetCounter(NetConditionedPacket const& packet)
+	{
+		uint32_t counter = 0;
+		memcpy(&counter, packet.m_data.data(), sizeof(counter));
+		return counter;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(NetConditioner, LatencyAndJitter)
+{
+	srand(27);
+	NetConditioner conditioner;
+	NetConditionerConfig config = MakeConfig();
+	config.m_latencySeconds = 0.1;
+	conditioner.SetConfig(config);
+
+	NetConditionedPacket packet;
+	EnqueueCounter(conditioner, 0, 64, 1.0);
+	TEST_CHECK(!conditioner.PopReadyPacket(packet, 1.099));
+	TEST_CHECK(conditioner.PopReadyPacket(packet, 1.1));
+	TEST_CHECK(packet.m_data.size() == 64);
+
+	// Every delay lands in [latency, latency + jitter] and the spread covers most of it
+	config.m_jitterSeconds = 0.04;
+	conditioner.SetConfig(config);
+	for (uint32_t counter = 0; counter < 2000; ++counter)
+	{
+		EnqueueCounter(conditioner, counter, 16, 0.0);
+	}
+	TEST_CHECK_EQUAL(conditioner.GetNumPendingPackets(), 2000);
+	TEST_CHECK_EQUAL(conditioner.GetNumPendingBytes(), static_cast<size_t>(2000 * 16));
+	double minDelay = 1.0;
+	double maxDelay = 0.0;
+	double previousDelay = 0.0;
+	bool isSorted = true;
+	while (conditioner.PopReadyPacket(packet, 10.0))
+	{
+		minDelay = (packet.m_deliveryTime < minDelay) ? packet.m_deliveryTime : minDelay;
+		maxDelay = (packet.m_deliveryTime > maxDelay) ? packet.m_deliveryTime : maxDelay;
+		isSorted = isSorted && packet.m_deliveryTime >= previousDelay;
+		previousDelay = packet.m_deliveryTime;
+	}
+	TEST_CHECK(isSorted);
+	TEST_CHECK(minDelay >= 0.1 && maxDelay <= 0.14 + 1e-9);
+	TEST_CHECK(minDelay < 0.102 && maxDelay > 0.138);
+	TEST_CHECK_EQUAL(conditioner.GetNumPendingBytes(), static_cast<size_t>(0));
+}
+
+ENGINE_TEST(NetConditioner, Loss)
+{
+	srand(28);
+	NetConditioner conditioner;
+	NetConditionerConfig config = MakeConfig();
+	config.m_lossChance = 0.25f;
+	conditioner.SetConfig(config);
+
+	constexpr int NUM_PACKETS = 20000;
+	for (uint32_t counter = 0; counter < NUM_PACKETS; ++counter)
+	{
+		EnqueueCounter(conditioner, counter, 8, 0.0);
+	}
+	double lossRatio = static_cast<double>(conditioner.GetNumDroppedPackets()) / NUM_PACKETS;
+	TEST_CHECK(lossRatio > 0.23 && lossRatio < 0.27);
+	TEST_CHECK_EQUAL(static_cast<uint64_t>(conditioner.GetNumPendingPackets()) + conditioner.GetNumDroppedPackets(), static_cast<uint64_t>(NUM_PACKETS));
+
+	// A stream cannot lose bytes, loss is ignored
+	NetConditioner stream(NetConditionerMode::STREAM);
+	stream.SetConfig(config);
+	for (uint32_t counter = 0; counter < 1000; ++counter)
+	{
+		EnqueueCounter(stream, counter, 8, 0.0);
+	}
+	TEST_CHECK_EQUAL(stream.GetNumDroppedPackets(), static_cast<uint64_t>(0));
+	TEST_CHECK_EQUAL(stream.GetNumPendingPackets(), 1000);
+
+	conditioner.Clear();
+	TEST_CHECK_EQUAL(conditioner.GetNumDroppedPackets(), static_cast<uint64_t>(0));
+	TEST_CHECK_EQUAL(conditioner.GetNumPendingPackets(), 0);
+}
+
+ENGINE_TEST(NetConditioner, BandwidthCapAndQueue)
+{
+	srand(29);
+	NetConditioner conditioner;
+	NetConditionerConfig config = MakeConfig();
+	config.m_latencySeconds = 0.02;
+	config.m_bandwidthBytesPerSecond = 10000;
+	conditioner.SetConfig(config);
+
+	// 100 byte packets take 10 ms each on the link, so a burst leaves one every 10 ms
+	for (uint32_t counter = 0; counter < 50; ++counter)
+	{
+		EnqueueCounter(conditioner, counter, 100, 0.0);
+	}
+	NetConditionedPacket packet;
+	bool isPaced = true;
+	for (uint32_t counter = 0; counter < 50; ++counter)
+	{
+		isPaced = isPaced && conditioner.PopReadyPacket(packet, 10.0) && GetCounter(packet) == counter
+			&& fabs(packet.m_deliveryTime - (0.02 + 0.01 * (counter + 1))) < 1e-9;
+	}
+	TEST_CHECK(isPaced);
+
+	// The link drains while idle, a packet sent later does not wait for the old burst
+	EnqueueCounter(conditioner, 50, 100, 2.0);
+	TEST_CHECK(conditioner.PopReadyPacket(packet, 10.0));
+	TEST_CHECK(fabs(packet.m_deliveryTime - 2.03) < 1e-9);
+
+	// Beyond the router queue, datagrams are tail dropped
+	config.m_maxQueuedBytes = 1000;
+	conditioner.SetConfig(config);
+	conditioner.Clear();
+	for (uint32_t counter = 0; counter < 30; ++counter)
+	{
+		EnqueueCounter(conditioner, counter, 100, 0.0);
+	}
+	TEST_CHECK_EQUAL(conditioner.GetNumPendingPackets(), 10);
+	TEST_CHECK_EQUAL(conditioner.GetNumPendingBytes(), static_cast<size_t>(1000));
+	TEST_CHECK_EQUAL(conditioner.GetNumDroppedPackets(), static_cast<uint64_t>(20));
+}
+
+ENGINE_TEST(NetConditioner, Reorder)
+{
+	srand(30);
+	NetConditioner conditioner;
+	NetConditionerConfig config = MakeConfig();
+	config.m_latencySeconds = 0.01;
+	config.m_reorderChance = 0.3f;
+	config.m_reorderDelaySeconds = 0.05;
+	conditioner.SetConfig(config);
+
+	// One packet a millisecond, so a held back packet is overtaken by the next 50
+	constexpr uint32_t NUM_PACKETS = 5000;
+	for (uint32_t counter = 0; counter < NUM_PACKETS; ++counter)
+	{
+		EnqueueCounter(conditioner, counter, 8, 0.001 * counter);
+	}
+	NetConditionedPacket packet;
+	int numHeldBack = 0;
+	int numOvertaken = 0;
+	uint32_t newestCounter = 0;
+	while (conditioner.PopReadyPacket(packet, 100.0))
+	{
+		uint32_t counter = GetCounter(packet);
+		double delay = packet.m_deliveryTime - 0.001 * counter;
+		numHeldBack += (delay > 0.01 + 0.025) ? 1 : 0;
+		numOvertaken += (counter < newestCounter) ? 1 : 0;
+		newestCounter = (counter > newestCounter) ? counter : newestCounter;
+	}
+	double heldBackRatio = static_cast<double>(numHeldBack) / NUM_PACKETS;
+	TEST_CHECK(heldBackRatio > 0.27 && heldBackRatio < 0.33);
+	TEST_CHECK(numOvertaken > 0 && numOvertaken <= numHeldBack);
+
+	// A stream never reorders, jitter and reorder only delay the bytes behind
+	NetConditioner stream(NetConditionerMode::STREAM);
+	config.m_jitterSeconds = 0.03;
+	stream.SetConfig(config);
+	for (uint32_t counter = 0; counter < 1000; ++counter)
+	{
+		EnqueueCounter(stream, counter, 8, 0.001 * counter);
+	}
+	bool isInOrder = true;
+	for (uint32_t counter = 0; counter < 1000; ++counter)
+	{
+		isInOrder = isInOrder && stream.PopReadyPacket(packet, 100.0) && GetCounter(packet) == counter;
+	}
+	TEST_CHECK(isInOrder);
+}
+
+// Connection counters against the traffic that actually crossed the conditioners
+ENGINE_TEST(NetConditioner, ConnectionStatsMatchTraffic)
+{
+	srand(31);
+	NetConditionerConfig config = MakeConfig();
+	config.m_latencySeconds = 0.05;
+	NetConnection ends[2];
+	NetConditioner links[2];
+	for (int endIndex = 0; endIndex < 2; ++endIndex)
+	{
+		ends[endIndex].SetState(NetConnectionState::CONNECTED, 0.0);
+		links[endIndex].SetConfig(config);
+	}
+
+	std::vector<uint8_t> message(100, 7);
+	for (int messageIndex = 0; messageIndex < 10; ++messageIndex)
+	{
+		ends[0].QueueMessage(NetChannel::RELIABLE_ORDERED, message.data(), 100);
+	}
+	for (int messageIndex = 0; messageIndex < 5; ++messageIndex)
+	{
+		ends[0].QueueMessage(NetChannel::UNRELIABLE_SEQUENCED, message.data(), 50);
+	}
+	NetConnectionStats queued = ends[0].GetStats();
+	TEST_CHECK_EQUAL(queued.m_queuedMessages, 15);
+	TEST_CHECK_EQUAL(queued.m_queuedBytes, static_cast<size_t>(10 * 100 + 5 * 50));
+
+	uint64_t numBytesSent[2] = {};
+	uint64_t numPacketsSent[2] = {};
+	std::vector<NetMessage> received[2];
+	std::vector<uint8_t> packet;
+	NetConditionedPacket delivered;
+	constexpr double STEP_SECONDS = 0.001;
+	for (int stepIndex = 1; stepIndex <= 1000; ++stepIndex)
+	{
+		double currentTime = STEP_SECONDS * stepIndex;
+		for (int endIndex = 0; endIndex < 2; ++endIndex)
+		{
+			while (links[endIndex].PopReadyPacket(delivered, currentTime))
+			{
+				NetBufferReader reader(delivered.m_data.data(), delivered.m_data.size());
+				reader.ReadUInt32();
+				reader.ReadUInt8();
+				TEST_CHECK(ends[1 - endIndex].ReadPayloadPacket(reader, currentTime));
+			}
+			ends[1 - endIndex].RetrieveIncomingMessages(received[1 - endIndex]);
+		}
+		for (int endIndex = 0; endIndex < 2; ++endIndex)
+		{
+			while (ends[endIndex].WritePayloadPacket(packet, NET_DEFAULT_PROTOCOL_ID, currentTime, 0.1))
+			{
+				numBytesSent[endIndex] += packet.size();
+				numPacketsSent[endIndex]++;
+				links[endIndex].Enqueue(NetAddress(), packet.data(), packet.size(), currentTime);
+			}
+		}
+	}
+
+	NetConnectionStats sender = ends[0].GetStats();
+	NetConnectionStats receiver = ends[1].GetStats();
+	TEST_CHECK_EQUAL(received[1].size(), static_cast<size_t>(15));
+	TEST_CHECK_EQUAL(sender.m_messagesSent, static_cast<uint64_t>(15));
+	TEST_CHECK_EQUAL(receiver.m_messagesReceived, static_cast<uint64_t>(15));
+	TEST_CHECK_EQUAL(sender.m_bytesSent, numBytesSent[0]);
+	TEST_CHECK_EQUAL(sender.m_packetsSent, numPacketsSent[0]);
+	TEST_CHECK_EQUAL(receiver.m_bytesSent, numBytesSent[1]);
+	TEST_CHECK_EQUAL(receiver.m_packetsSent, numPacketsSent[1]);
+
+	// Nothing lost: everything sent but still in flight is the difference
+	uint64_t numBytesInFlight = links[0].GetNumPendingBytes();
+	TEST_CHECK_EQUAL(receiver.m_bytesReceived + numBytesInFlight, numBytesSent[0]);
+	TEST_CHECK_EQUAL(receiver.m_packetsReceived + links[0].GetNumPendingPackets(), numPacketsSent[0]);
+	TEST_CHECK_EQUAL(sender.m_reliableResends, static_cast<uint64_t>(0));
+	TEST_CHECK_EQUAL(sender.m_queuedMessages, 0);
+	TEST_CHECK_EQUAL(sender.m_queuedBytes, static_cast<size_t>(0));
+
+	// Two one way latencies, plus at most a step before the ack goes out
+	TEST_CHECK(sender.m_roundTripTime >= 0.1 - 1e-9 && sender.m_roundTripTime <= 0.1 + STEP_SECONDS + 1e-9);
+	TEST_CHECK(receiver.m_roundTripTime >= 0.1 - 1e-9 && receiver.m_roundTripTime <= 0.1 + STEP_SECONDS + 1e-9);
+}
@@ -0,0 +1,345 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Network/NetConnection.hpp"
+#include "Engine/Network/NetConditioner.hpp"
+#include "Engine/Network/NetBuffer.hpp"
+#include "Engine/Network/NetSnapshot.hpp"
+#include "Engine/Network/UdpNetworkSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <thread>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	constexpr double FRAME_SECONDS = 1.0 / 60.0;
+	constexpr double KEEP_ALIVE_SECONDS = 0.05;
+	constexpr int MAX_PACKETS_PER_FRAME = 16;
+
+	// Two connected ends, each sending through its own conditioner, on a simulated clock so the
+	// loss and reorder pattern only depends on the rand() seed
+	struct LoopbackLink
+	{
+		NetConnection			m_ends[2];
+		NetConditioner			m_links[2];		// m_links[i] carries the packets m_ends[i] sends
+		std::vector<NetMessage>	m_received[2];
+		double					m_time = 0.0;
+		int						m_numMalformed = 0;
+
+		explicit LoopbackLink(NetConditionerConfig const& config)
+		{
+			for (int endIndex = 0; endIndex < 2; ++endIndex)
+			{
+				m_ends[endIndex].SetState(NetConnectionState::CONNECTED, m_time);
+				m_links[endIndex].SetConfig(config);
+			}
+		}
+
+		void SendPackets()
+		{
+			std::vector<uint8_t> packet;
+			for (int endIndex = 0; endIndex < 2; ++endIndex)
+			{
+				for (int packetIndex = 0; packetIndex < MAX_PACKETS_PER_FRAME; ++packetIndex)
+				{
+					if (!m_ends[endIndex].WritePayloadPacket(packet, NET_DEFAULT_PROTOCOL_ID, m_time, KEEP_ALIVE_SECONDS))
+					{
+						break;
+					}
+					m_links[endIndex].Enqueue(NetAddress(), packet.data(), packet.size(), m_time);
+				}
+			}
+		}
+
+		void DeliverPackets()
+		{
+			NetConditionedPacket packet;
+			for (int endIndex = 0; endIndex < 2; ++endIndex)
+			{
+				NetConnection& receiver = m_ends[1 - endIndex];
+				while (m_links[endIndex].PopReadyPacket(packet, m_time))
+				{
+					NetBufferReader reader(packet.m_data.data(), packet.m_data.size());
+					reader.ReadUInt32();
+					reader.ReadUInt8();
+					m_numMalformed += receiver.ReadPayloadPacket(reader, m_time) ? 0 : 1;
+				}
+				receiver.RetrieveIncomingMessages(m_received[1 - endIndex]);
+			}
+		}
+
+		void Step()
+		{
+			SendPackets();
+			m_time += FRAME_SECONDS;
+			DeliverPackets();
+		}
+	};
+
+	NetConditionerConfig MakeBadNetwork(float lossChance, float reorderChance)
+	{
+		NetConditionerConfig config;
+		config.m_isEnabled = true;
+		config.m_lossChance = lossChance;
+		config.m_latencySeconds = 0.04;
+		config.m_jitterSeconds = 0.02;
+		config.m_reorderChance = reorderChance;
+		config.m_reorderDelaySeconds = 0.05;
+		return config;
+	}
+
+	uint32_t ReadCounter(std::vector<uint8_t> const& data)
+	{
+		uint32_t counter = 0;
+		if (data.size() >= sizeof(counter))
+		{
+			memcpy(&counter, data.data(), sizeof(counter));
+		}
+		return counter;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(NetConnection, ReliableOrderedSurvivesLossAndReorder)
+{
+	srand(26);
+	LoopbackLink link(MakeBadNetwork(0.2f, 0.2f));
+
+	constexpr uint32_t NUM_MESSAGES = 2000;
+	uint32_t numQueued = 0;
+	for (int frameIndex = 0; frameIndex < 3000 && link.m_received[1].size() < NUM_MESSAGES; ++frameIndex)
+	{
+		for (int messageIndex = 0; messageIndex < 20 && numQueued < NUM_MESSAGES; ++messageIndex)
+		{
+			// Varying sizes so packets hold different numbers of messages
+			std::vector<uint8_t> message(sizeof(uint32_t) + numQueued % 61, static_cast<uint8_t>(numQueued));
+			memcpy(message.data(), &numQueued, sizeof(numQueued));
+			TEST_CHECK(link.m_ends[0].QueueMessage(NetChannel::RELIABLE_ORDERED, message.data(), message.size()));
+			numQueued++;
+		}
+		link.Step();
+	}
+
+	std::vector<NetMessage> const& received = link.m_received[1];
+	TEST_CHECK_EQUAL(received.size(), static_cast<size_t>(NUM_MESSAGES));
+	bool isInOrder = true;
+	for (size_t messageIndex = 0; messageIndex < received.size(); ++messageIndex)
+	{
+		isInOrder = isInOrder && received[messageIndex].m_channel == NetChannel::RELIABLE_ORDERED
+			&& ReadCounter(received[messageIndex].m_data) == messageIndex
+			&& received[messageIndex].m_data.size() == sizeof(uint32_t) + messageIndex % 61;
+	}
+	TEST_CHECK(isInOrder);
+	TEST_CHECK_EQUAL(link.m_numMalformed, 0);
+
+	// The conditions actually hurt: packets were lost and messages had to be resent. A few more
+	// frames for the last acks to come back
+	for (int frameIndex = 0; frameIndex < 60; ++frameIndex)
+	{
+		link.Step();
+	}
+	TEST_CHECK(link.m_links[0].GetNumDroppedPackets() > 0);
+	TEST_CHECK(link.m_ends[0].GetStats().m_reliableResends > 0);
+	TEST_CHECK_EQUAL(link.m_ends[0].GetNumPendingReliableMessages(), 0);
+}
+
+ENGINE_TEST(NetConnection, UnreliableSequencedDropsStale)
+{
+	// Delivered out of order by hand: the older message arrives second and is dropped
+	{
+		NetConnection sender;
+		NetConnection receiver;
+		std::vector<uint8_t> packets[2];
+		for (uint32_t counter = 0; counter < 2; ++counter)
+		{
+			sender.QueueMessage(NetChannel::UNRELIABLE_SEQUENCED, &counter, sizeof(counter));
+			TEST_CHECK(sender.WritePayloadPacket(packets[counter], NET_DEFAULT_PROTOCOL_ID, 0.0, KEEP_ALIVE_SECONDS));
+		}
+		for (int packetIndex : { 1, 0 })
+		{
+			NetBufferReader reader(packets[packetIndex].data(), packets[packetIndex].size());
+			reader.ReadUInt32();
+			reader.ReadUInt8();
+			TEST_CHECK(receiver.ReadPayloadPacket(reader, 0.0));
+		}
+		std::vector<NetMessage> received;
+		receiver.RetrieveIncomingMessages(received);
+		TEST_CHECK_EQUAL(received.size(), static_cast<size_t>(1));
+		TEST_CHECK(!received.empty() && ReadCounter(received[0].m_data) == 1);
+	}
+
+	// Through the conditioner: whatever arrives is strictly newer than what came before it
+	srand(27);
+	LoopbackLink link(MakeBadNetwork(0.1f, 0.3f));
+	constexpr uint32_t NUM_MESSAGES = 600;
+	for (uint32_t counter = 0; counter < NUM_MESSAGES; ++counter)
+	{
+		link.m_ends[0].QueueMessage(NetChannel::UNRELIABLE_SEQUENCED, &counter, sizeof(counter));
+		link.Step();
+	}
+	uint64_t numDropped = link.m_links[0].GetNumDroppedPackets();	// loss is decided when sent
+	for (int frameIndex = 0; frameIndex < 60; ++frameIndex)
+	{
+		link.Step();
+	}
+
+	std::vector<NetMessage> const& received = link.m_received[1];
+	bool isIncreasing = true;
+	for (size_t messageIndex = 1; messageIndex < received.size(); ++messageIndex)
+	{
+		isIncreasing = isIncreasing && ReadCounter(received[messageIndex].m_data) > ReadCounter(received[messageIndex - 1].m_data);
+	}
+	TEST_CHECK(isIncreasing);
+
+	// One packet per message, so every packet that got through but is missing was dropped as stale
+	size_t numDelivered = NUM_MESSAGES - static_cast<size_t>(numDropped);
+	TEST_CHECK(received.size() < numDelivered);
+	TEST_CHECK(received.size() > NUM_MESSAGES / 2);
+	TEST_CHECK_EQUAL(link.m_numMalformed, 0);
+}
+
+// The server sends each tick as a delta against the newest tick the client acked, the client
+// rebuilds every snapshot it receives from its own copy of that baseline
+ENGINE_TEST(NetConnection, SnapshotDeltasRoundTrip)
+{
+	srand(28);
+	LoopbackLink link(MakeBadNetwork(0.15f, 0.2f));
+	constexpr uint32_t STATE_SIZE = 12;
+	constexpr int NUM_ENTITIES = 40;
+
+	std::map<uint32_t, NetSnapshot> serverSnapshots;
+	std::map<uint32_t, NetSnapshot> clientSnapshots;
+	serverSnapshots[0] = NetSnapshot(STATE_SIZE);
+	clientSnapshots[0] = NetSnapshot(STATE_SIZE);
+	uint32_t newestAckedTick = 0;
+	int numDecoded = 0;
+	int numAgainstBaseline = 0;
+	int numMismatches = 0;
+
+	for (uint32_t tick = 1; tick <= 300; ++tick)
+	{
+		// A few entities move each tick, one leaves and comes back
+		NetSnapshot& snapshot = serverSnapshots[tick];
+		snapshot = NetSnapshot(STATE_SIZE);
+		snapshot.m_tick = tick;
+		for (uint32_t entityId = 1; entityId <= NUM_ENTITIES; ++entityId)
+		{
+			if (entityId == 7 && (tick / 20) % 2 == 1)
+			{
+				continue;
+			}
+			uint32_t state[3] = { entityId, (entityId % 5 == tick % 5) ? tick : entityId * 100, tick / 10 };
+			snapshot.SetEntityState(entityId, state);
+		}
+
+		std::vector<uint8_t> delta;
+		WriteSnapshotDelta(serverSnapshots[newestAckedTick], snapshot, delta);
+		std::vector<uint8_t> message(sizeof(uint32_t));
+		memcpy(message.data(), &newestAckedTick, sizeof(newestAckedTick));
+		message.insert(message.end(), delta.begin(), delta.end());
+		TEST_CHECK(link.m_ends[0].QueueMessage(NetChannel::UNRELIABLE_SEQUENCED, message.data(), message.size()));
+		link.Step();
+
+		for (NetMessage const& received : link.m_received[1])
+		{
+			uint32_t baselineTick = ReadCounter(received.m_data);
+			auto baseline = clientSnapshots.find(baselineTick);
+			if (baseline == clientSnapshots.end())
+			{
+				numMismatches++;
+				continue;
+			}
+			NetSnapshot decoded;
+			if (!ReadSnapshotDelta(baseline->second, received.m_data.data() + sizeof(uint32_t), received.m_data.size() - sizeof(uint32_t), decoded))
+			{
+				numMismatches++;
+				continue;
+			}
+			NetSnapshot const& expected = serverSnapshots[decoded.m_tick];
+			bool isSame = decoded.GetNumEntities() == expected.GetNumEntities();
+			for (int entityIndex = 0; isSame && entityIndex < expected.GetNumEntities(); ++entityIndex)
+			{
+				isSame = decoded.GetEntityIdAtIndex(entityIndex) == expected.GetEntityIdAtIndex(entityIndex)
+					&& memcmp(decoded.GetEntityStateAtIndex(entityIndex), expected.GetEntityStateAtIndex(entityIndex), STATE_SIZE) == 0;
+			}
+			numMismatches += isSame ? 0 : 1;
+			numDecoded++;
+			numAgainstBaseline += (baselineTick != 0) ? 1 : 0;
+
+			uint32_t ackTick = decoded.m_tick;
+			clientSnapshots[ackTick] = std::move(decoded);
+			link.m_ends[1].QueueMessage(NetChannel::UNRELIABLE_SEQUENCED, &ackTick, sizeof(ackTick));
+		}
+		link.m_received[1].clear();
+
+		for (NetMessage const& ack : link.m_received[0])
+		{
+			uint32_t ackTick = ReadCounter(ack.m_data);
+			newestAckedTick = (ackTick > newestAckedTick) ? ackTick : newestAckedTick;
+		}
+		link.m_received[0].clear();
+	}
+
+	TEST_CHECK_EQUAL(numMismatches, 0);
+	TEST_CHECK(numDecoded > 150);
+	TEST_CHECK(numAgainstBaseline > numDecoded / 2);
+	TEST_CHECK_EQUAL(link.m_numMalformed, 0);
+}
+
+// The same protocol over real sockets on 127.0.0.1, both sides conditioned
+ENGINE_TEST(NetConnection, UdpLoopbackDeliversReliableInOrder)
+{
+	srand(29);
+	UdpNetworkConfig config;
+	config.m_conditioner = MakeBadNetwork(0.1f, 0.1f);
+	config.m_conditioner.m_latencySeconds = 0.005;
+	config.m_conditioner.m_jitterSeconds = 0.005;
+	config.m_conditioner.m_reorderDelaySeconds = 0.01;
+	UdpNetworkSystem server(config);
+	UdpNetworkSystem client(config);
+	server.Startup();
+	client.Startup();
+
+	unsigned short port = 0;
+	for (unsigned short candidate = 47200; candidate < 47300 && port == 0; ++candidate)
+	{
+		port = server.StartServer(candidate) ? candidate : 0;
+	}
+	TEST_CHECK(port != 0);
+	TEST_CHECK(client.StartClient("127.0.0.1", port));
+
+	constexpr uint32_t NUM_MESSAGES = 300;
+	uint32_t numQueued = 0;
+	std::vector<uint32_t> received;
+	double timeoutTime = GetCurrentTimeSeconds() + 10.0;
+	while (port != 0 && received.size() < NUM_MESSAGES && GetCurrentTimeSeconds() < timeoutTime)
+	{
+		server.BeginFrame();
+		client.BeginFrame();
+		for (int messageIndex = 0; messageIndex < 10 && numQueued < NUM_MESSAGES && client.GetState() == NetState::CLIENT_CONNECTED; ++messageIndex)
+		{
+			client.QueueOutgoingMessage(0, NetChannel::RELIABLE_ORDERED, &numQueued, sizeof(numQueued));
+			numQueued++;
+		}
+		for (NetIncomingMessage const& message : server.RetrieveIncomingMessages())
+		{
+			received.push_back(ReadCounter(message.m_data));
+		}
+		client.EndFrame();
+		server.EndFrame();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	TEST_CHECK_EQUAL(received.size(), static_cast<size_t>(NUM_MESSAGES));
+	bool isInOrder = true;
+	for (size_t messageIndex = 0; messageIndex < received.size(); ++messageIndex)
+	{
+		isInOrder = isInOrder && received[messageIndex] == messageIndex;
+	}
+	TEST_CHECK(isInOrder);
+
+	client.Shutdown();
+	server.Shutdown();
+}
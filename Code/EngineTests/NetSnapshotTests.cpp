@@ -0,0 +1,124 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Network/NetSnapshot.hpp"
+#include "Engine/Network/NetBuffer.hpp"
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	constexpr uint32_t STATE_SIZE = 17;	// odd, the last word is partial
+
+	void SetEntity(NetSnapshot& snapshot, uint32_t entityId, float x, uint32_t health)
+	{
+		uint8_t state[STATE_SIZE] = {};
+		memcpy(state, &x, sizeof(x));
+		memcpy(state + 8, &health, sizeof(health));
+		state[16] = static_cast<uint8_t>(entityId);
+		snapshot.SetEntityState(entityId, state);
+	}
+
+	bool IsSameSnapshot(NetSnapshot const& a, NetSnapshot const& b)
+	{
+		if (a.m_tick != b.m_tick || a.GetNumEntities() != b.GetNumEntities() || a.GetStateSize() != b.GetStateSize())
+		{
+			return false;
+		}
+		for (int entityIndex = 0; entityIndex < a.GetNumEntities(); ++entityIndex)
+		{
+			if (a.GetEntityIdAtIndex(entityIndex) != b.GetEntityIdAtIndex(entityIndex)
+				|| memcmp(a.GetEntityStateAtIndex(entityIndex), b.GetEntityStateAtIndex(entityIndex), a.GetStateSize()) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// tick | state size | no removed ids | numChanged entities, each an id and a full mask
+	std::vector<uint8_t> MakeCraftedDelta(uint32_t stateSize, uint32_t numChanged, int numEntitiesWritten)
+	{
+		std::vector<uint8_t> delta;
+		NetBufferWriter writer(delta);
+		writer.WriteVarUInt(1);
+		writer.WriteVarUInt(stateSize);
+		writer.WriteVarUInt(0);
+		writer.WriteVarUInt(numChanged);
+		for (int entityIndex = 0; entityIndex < numEntitiesWritten; ++entityIndex)
+		{
+			writer.WriteVarUInt(1);
+			writer.WriteUInt8(0xFF);
+			writer.WriteUInt32(0xDEADBEEF);
+		}
+		return delta;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(NetSnapshot, DeltaRoundTrips)
+{
+	NetSnapshot empty(STATE_SIZE);
+	NetSnapshot baseline(STATE_SIZE);
+	baseline.m_tick = 10;
+	for (uint32_t entityId = 1; entityId <= 50; ++entityId)
+	{
+		SetEntity(baseline, entityId * 3, static_cast<float>(entityId), 100);
+	}
+
+	NetSnapshot current(STATE_SIZE);
+	current.m_tick = 11;
+	for (uint32_t entityId = 1; entityId <= 50; ++entityId)
+	{
+		if (entityId % 7 == 0)
+		{
+			continue; // removed
+		}
+		uint32_t health = (entityId % 3 == 0) ? 90 : 100;
+		SetEntity(current, entityId * 3, static_cast<float>(entityId), health);
+	}
+	SetEntity(current, 1000, 5.f, 1);	// new
+
+	std::vector<uint8_t> delta;
+	NetSnapshot decoded;
+	WriteSnapshotDelta(baseline, current, delta);
+	TEST_CHECK(ReadSnapshotDelta(baseline, delta.data(), delta.size(), decoded));
+	TEST_CHECK(IsSameSnapshot(decoded, current));
+
+	// Unchanged entities cost nothing, so the delta is far smaller than the full snapshot
+	std::vector<uint8_t> fullDelta;
+	WriteSnapshotDelta(empty, current, fullDelta);
+	TEST_CHECK(delta.size() * 3 < fullDelta.size());
+	TEST_CHECK(ReadSnapshotDelta(empty, fullDelta.data(), fullDelta.size(), decoded));
+	TEST_CHECK(IsSameSnapshot(decoded, current));
+
+	// Every truncation is rejected, never read past
+	for (size_t size = 0; size < delta.size(); ++size)
+	{
+		TEST_CHECK(!ReadSnapshotDelta(baseline, delta.data(), size, decoded));
+	}
+}
+
+// The first snapshot of a connection is read against an empty baseline, the state size on the
+// wire must not decide what gets allocated
+ENGINE_TEST(NetSnapshot, RejectsOversizedState)
+{
+	NetSnapshot empty(STATE_SIZE);
+	NetSnapshot unsized;
+	NetSnapshot decoded;
+
+	std::vector<uint8_t> hugeState = MakeCraftedDelta(0xFFFFFFFFu, 1, 1);
+	TEST_CHECK(!ReadSnapshotDelta(empty, hugeState.data(), hugeState.size(), decoded));
+	TEST_CHECK(!ReadSnapshotDelta(unsized, hugeState.data(), hugeState.size(), decoded));
+
+	std::vector<uint8_t> overMax = MakeCraftedDelta(NET_SNAPSHOT_MAX_STATE_SIZE + 1, 1, 1);
+	TEST_CHECK(!ReadSnapshotDelta(unsized, overMax.data(), overMax.size(), decoded));
+
+	// An empty baseline still fixes its state size
+	std::vector<uint8_t> wrongSize = MakeCraftedDelta(4, 1, 1);
+	TEST_CHECK(!ReadSnapshotDelta(empty, wrongSize.data(), wrongSize.size(), decoded));
+	TEST_CHECK(ReadSnapshotDelta(unsized, wrongSize.data(), wrongSize.size(), decoded));
+	TEST_CHECK_EQUAL(decoded.GetNumEntities(), 1);
+
+	// More changed entities than the remaining bytes could hold
+	std::vector<uint8_t> hugeCount = MakeCraftedDelta(4, 0x0FFFFFFFu, 2);
+	TEST_CHECK(!ReadSnapshotDelta(unsized, hugeCount.data(), hugeCount.size(), decoded));
+}
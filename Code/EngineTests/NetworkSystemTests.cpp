@@ -0,0 +1,23 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Network/NetworkSystem.hpp"
+
+//-----------------------------------------------------------------------------------------------
+// Real TCP sockets on 127.0.0.1, the first free port in the range is used
+ENGINE_TEST(NetworkSystem, LoopbackClientChurn)
+{
+	constexpr int NUM_WAVES = 6;
+	constexpr int CLIENTS_PER_WAVE = 16;
+
+	NetClientChurnBenchmarkResult result;
+	for (unsigned short port = 47300; port < 47310 && !result.m_isComplete; ++port)
+	{
+		result = RunNetClientChurnBenchmark(port, NUM_WAVES, CLIENTS_PER_WAVE);
+	}
+	TEST_CHECK(result.m_isComplete);
+	TEST_CHECK_EQUAL(result.m_numAccepted, NUM_WAVES * CLIENTS_PER_WAVE);
+
+	// Every wave lands in the slots the previous one freed, under new generations
+	TEST_CHECK_EQUAL(result.m_numSlotsUsed, CLIENTS_PER_WAVE);
+	TEST_CHECK_EQUAL(result.m_numStaleHandlesConnected, 0);
+	TEST_CHECK(result.m_numServerFrames > 0);
+}
@@ -0,0 +1,134 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/PipelineStateCache.hpp"
+#include <unordered_set>
+
+//-----------------------------------------------------------------------------------------------
+// Every enum combination, with ids at both ends of their fields, must round trip and stay unique
+ENGINE_TEST(PipelineStateCache, PackUnpackEveryCombination)
+{
+	uint32_t const shaderIds[] = { 0, 1, 2, 0x7FFF, (1u << GraphicsPipelineKey::SHADER_BITS) - 1 };
+	uint32_t const layoutIds[] = { 0, 1, 0x100, (1u << GraphicsPipelineKey::RENDER_TARGETS_BITS) - 1 };
+
+	std::unordered_set<uint64_t> keys;
+	int numCombinations = 0;
+	for (uint32_t shaderId : shaderIds)
+	for (uint32_t layoutId : layoutIds)
+	for (int inputLayout = 0; inputLayout < static_cast<int>(VertexType::COUNT); ++inputLayout)
+	for (int blendMode = 0; blendMode < static_cast<int>(BlendMode::COUNT); ++blendMode)
+	for (int rasterizerMode = 0; rasterizerMode < static_cast<int>(RasterizerMode::COUNT); ++rasterizerMode)
+	for (int depthMode = 0; depthMode < static_cast<int>(DepthMode::COUNT); ++depthMode)
+	{
+		uint64_t value = GraphicsPipelineKey::Pack(shaderId, layoutId, static_cast<VertexType>(inputLayout),
+			static_cast<BlendMode>(blendMode), static_cast<RasterizerMode>(rasterizerMode), static_cast<DepthMode>(depthMode));
+		GraphicsPipelineKey key(value);
+		TEST_CHECK((value & PIPELINE_KEY_VALID_BIT) != 0);
+		TEST_CHECK((value & PIPELINE_KEY_COMPUTE_BIT) == 0);
+		TEST_CHECK_EQUAL(key.GetShaderId(), shaderId);
+		TEST_CHECK_EQUAL(key.GetRenderTargetLayoutId(), layoutId);
+		TEST_CHECK_EQUAL(static_cast<int>(key.GetInputLayout()), inputLayout);
+		TEST_CHECK_EQUAL(static_cast<int>(key.GetBlendMode()), blendMode);
+		TEST_CHECK_EQUAL(static_cast<int>(key.GetRasterizerMode()), rasterizerMode);
+		TEST_CHECK_EQUAL(static_cast<int>(key.GetDepthMode()), depthMode);
+		keys.insert(value);
+		++numCombinations;
+	}
+	TEST_CHECK_EQUAL(static_cast<int>(keys.size()), numCombinations);
+}
+
+ENGINE_TEST(PipelineStateCache, SettersReportOnlyRealChanges)
+{
+	GraphicsPipelineKey key;
+	TEST_CHECK(key.SetBlendMode(BlendMode::ALPHA));
+	TEST_CHECK(!key.SetBlendMode(BlendMode::ALPHA));
+	TEST_CHECK(key.SetShaderId(7));
+	TEST_CHECK(!key.SetShaderId(7));
+	TEST_CHECK(!key.SetDepthMode(DepthMode::DISABLED)); // already 0
+	TEST_CHECK(key.SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL));
+
+	// Changing one field leaves the others alone
+	TEST_CHECK(key.SetRasterizerMode(RasterizerMode::WIREFRAME_CULL_BACK));
+	TEST_CHECK_EQUAL(key.GetShaderId(), 7u);
+	TEST_CHECK(key.GetBlendMode() == BlendMode::ALPHA);
+	TEST_CHECK(key.GetDepthMode() == DepthMode::READ_WRITE_LESS_EQUAL);
+
+	uint64_t computeKey = MakeComputePipelineKey(7);
+	TEST_CHECK(computeKey != key.GetValue());
+	TEST_CHECK((computeKey & PIPELINE_KEY_COMPUTE_BIT) != 0);
+}
+
+ENGINE_TEST(PipelineStateCache, IdRegistryInternsOnce)
+{
+	PipelineIdRegistry registry;
+	uint32_t defaultId = registry.InternShaderName("Default");
+	TEST_CHECK(defaultId != 0);
+	TEST_CHECK_EQUAL(registry.InternShaderName("Default"), defaultId);
+	TEST_CHECK(registry.InternShaderName("Lit") != defaultId);
+	TEST_CHECK_EQUAL(registry.GetNumShaderIds(), 2);
+
+	RenderTargetLayout backBuffer;
+	RenderTargetLayout gBuffer;
+	DXGI_FORMAT const gBufferFormats[] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT };
+	gBuffer.Set(2, gBufferFormats, DXGI_FORMAT_D24_UNORM_S8_UINT, 1, 0);
+	uint32_t backBufferId = registry.InternRenderTargetLayout(backBuffer);
+	uint32_t gBufferId = registry.InternRenderTargetLayout(gBuffer);
+	TEST_CHECK(backBufferId != 0 && gBufferId != 0 && backBufferId != gBufferId);
+	TEST_CHECK_EQUAL(registry.InternRenderTargetLayout(backBuffer), backBufferId);
+	TEST_CHECK_EQUAL(registry.InternRenderTargetLayout(gBuffer), gBufferId);
+	TEST_CHECK_EQUAL(registry.GetNumRenderTargetLayouts(), 2);
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(PipelineStateCache, FlatCacheHitAndMiss)
+{
+	FlatPipelineCache<int> cache(16);
+	uint64_t keyA = GraphicsPipelineKey::Pack(1, 1, VertexType::VERTEX_PCU, BlendMode::OPAQUE, RasterizerMode::SOLID_CULL_BACK, DepthMode::READ_WRITE_LESS_EQUAL);
+	uint64_t keyB = GraphicsPipelineKey::Pack(1, 1, VertexType::VERTEX_PCU, BlendMode::ALPHA, RasterizerMode::SOLID_CULL_BACK, DepthMode::READ_WRITE_LESS_EQUAL);
+
+	TEST_CHECK(cache.Find(keyA) == nullptr);
+	cache.Insert(keyA, 10);
+	TEST_CHECK(cache.Find(keyA) != nullptr && *cache.Find(keyA) == 10);
+	TEST_CHECK(cache.Find(keyB) == nullptr);
+
+	// Inserting an existing key replaces its value without growing
+	cache.Insert(keyA, 11);
+	TEST_CHECK_EQUAL(cache.GetSize(), 1);
+	TEST_CHECK(*cache.Find(keyA) == 11);
+
+	cache.Clear();
+	TEST_CHECK_EQUAL(cache.GetSize(), 0);
+	TEST_CHECK(cache.Find(keyA) == nullptr);
+}
+
+// Thousands of keys force several grows and plenty of probing, every one must stay findable
+ENGINE_TEST(PipelineStateCache, FlatCacheGrowKeepsEntries)
+{
+	FlatPipelineCache<uint32_t> cache(16);
+	constexpr uint32_t NUM_KEYS = 5000;
+	for (uint32_t shaderId = 1; shaderId <= NUM_KEYS; ++shaderId)
+	{
+		cache.Insert(MakeComputePipelineKey(shaderId), shaderId);
+		TEST_CHECK(cache.GetSize() * 2 <= cache.GetCapacity());
+	}
+	TEST_CHECK_EQUAL(cache.GetSize(), static_cast<int>(NUM_KEYS));
+
+	int numWrong = 0;
+	for (uint32_t shaderId = 1; shaderId <= NUM_KEYS; ++shaderId)
+	{
+		uint32_t const* found = cache.Find(MakeComputePipelineKey(shaderId));
+		numWrong += (found == nullptr || *found != shaderId) ? 1 : 0;
+	}
+	TEST_CHECK_EQUAL(numWrong, 0);
+	TEST_CHECK(cache.Find(MakeComputePipelineKey(NUM_KEYS + 1)) == nullptr);
+
+	int numVisited = 0;
+	cache.ForEach([&](uint64_t, uint32_t) { ++numVisited; });
+	TEST_CHECK_EQUAL(numVisited, static_cast<int>(NUM_KEYS));
+}
+
+ENGINE_TEST(PipelineStateCache, BenchmarkPathsAgree)
+{
+	// Small run, RunPipelineCacheBenchmark dies if the two paths resolve draws differently
+	PipelineCacheBenchmarkResult result = RunPipelineCacheBenchmark(10000, 24, 3);
+	TEST_CHECK(result.m_numPackedKeyLookups > 0);
+	TEST_CHECK(result.m_numPackedKeyLookups <= result.m_numDraws);
+}
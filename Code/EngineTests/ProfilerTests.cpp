@@ -0,0 +1,156 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	ProfilerScopeSummary const* FindScopeSummary(char const* name)
+	{
+		for (ProfilerScopeSummary const& summary : ProfilerGetLastFrameSummary())
+		{
+			if (strcmp(summary.m_name, name) == 0)
+			{
+				return &summary;
+			}
+		}
+		return nullptr;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+// Games get the profiler and its console command without calling ProfilerStartup themselves
+ENGINE_TEST(Profiler, StartsWithEventSystem)
+{
+	g_theEventSystem = new EventSystem(EventSystemConfig());
+	g_theEventSystem->Startup();
+
+	Strings commandNames;
+	g_theEventSystem->GetAllRegistedCommands(commandNames);
+	TEST_CHECK(std::find(commandNames.begin(), commandNames.end(), "Profiler") != commandNames.end());
+
+	ProfilerBeginFrame();
+	{
+		PROFILE_SCOPE("Test Started By EventSystem");
+	}
+	ProfilerBeginFrame();
+	TEST_CHECK(FindScopeSummary("Test Started By EventSystem") != nullptr);
+
+	g_theEventSystem->Shutdown();
+	delete g_theEventSystem;
+	g_theEventSystem = nullptr;
+
+	ProfilerBeginFrame();
+	TEST_CHECK(ProfilerGetLastFrameSummary().empty());
+}
+
+ENGINE_TEST(Profiler, NestedScopeSummary)
+{
+	ProfilerStartup(ProfilerConfig());
+	ProfilerBeginFrame();
+	for (int callIndex = 0; callIndex < 3; ++callIndex)
+	{
+		PROFILE_SCOPE("Test Outer");
+		for (int innerIndex = 0; innerIndex < 2; ++innerIndex)
+		{
+			PROFILE_SCOPE("Test Inner");
+		}
+	}
+	ProfilerBeginFrame();
+
+	ProfilerScopeSummary const* outer = FindScopeSummary("Test Outer");
+	ProfilerScopeSummary const* inner = FindScopeSummary("Test Inner");
+	TEST_CHECK(outer != nullptr && inner != nullptr);
+	if (outer && inner)
+	{
+		TEST_CHECK_EQUAL(outer->m_numCalls, 3);
+		TEST_CHECK_EQUAL(inner->m_numCalls, 6);
+		TEST_CHECK(outer->m_inclusiveSeconds >= inner->m_inclusiveSeconds);
+		TEST_CHECK(outer->m_exclusiveSeconds <= outer->m_inclusiveSeconds - inner->m_inclusiveSeconds + 1e-9);
+	}
+	ProfilerShutdown();
+}
+
+// Threads that come and go must not leave a ring each behind
+ENGINE_TEST(Profiler, ExitedThreadRingsAreRecycled)
+{
+	constexpr int NUM_THREADS_AT_ONCE = 4;
+	ProfilerStartup(ProfilerConfig());
+	for (int roundIndex = 0; roundIndex < 50; ++roundIndex)
+	{
+		std::vector<std::thread> threads;
+		for (int threadIndex = 0; threadIndex < NUM_THREADS_AT_ONCE; ++threadIndex)
+		{
+			threads.emplace_back([]()
+			{
+				for (int scopeIndex = 0; scopeIndex < 100; ++scopeIndex)
+				{
+					PROFILE_SCOPE("Test Short Lived Thread");
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		ProfilerBeginFrame();
+
+		ProfilerScopeSummary const* summary = FindScopeSummary("Test Short Lived Thread");
+		TEST_CHECK(summary != nullptr && summary->m_numCalls == NUM_THREADS_AT_ONCE * 100);
+	}
+	TEST_CHECK(ProfilerGetNumThreadBuffers() <= NUM_THREADS_AT_ONCE);
+	ProfilerShutdown();
+}
+
+// Small rings wrap constantly while the main thread folds and exports. Run under ThreadSanitizer
+// this checks the reads are race free, here that nothing torn reaches the summary
+ENGINE_TEST(Profiler, FoldAndExportWhileWriting)
+{
+	ProfilerConfig config;
+	config.m_eventsPerThread = 64;
+	ProfilerStartup(config);
+
+	std::atomic<bool> isDone{ false };
+	std::vector<std::thread> writers;
+	for (int writerIndex = 0; writerIndex < 3; ++writerIndex)
+	{
+		writers.emplace_back([&isDone]()
+		{
+			while (!isDone.load())
+			{
+				PROFILE_SCOPE("Test Writer Outer");
+				PROFILE_SCOPE("Test Writer Inner");
+			}
+		});
+	}
+
+	char const* tracePath = "ProfilerTests_trace.json";
+	for (int frameIndex = 0; frameIndex < 200; ++frameIndex)
+	{
+		ProfilerBeginFrame();
+		for (ProfilerScopeSummary const& summary : ProfilerGetLastFrameSummary())
+		{
+			bool isKnownName = strcmp(summary.m_name, "Test Writer Outer") == 0 || strcmp(summary.m_name, "Test Writer Inner") == 0;
+			TEST_CHECK(isKnownName);
+			TEST_CHECK(summary.m_inclusiveSeconds >= 0.0 && summary.m_inclusiveSeconds < 1.0);
+		}
+		if (frameIndex % 20 == 0)
+		{
+			TEST_CHECK(ProfilerExportChromeTrace(tracePath));
+		}
+	}
+
+	isDone.store(true);
+	for (std::thread& writer : writers)
+	{
+		writer.join();
+	}
+	remove(tracePath);
+	ProfilerShutdown();
+}
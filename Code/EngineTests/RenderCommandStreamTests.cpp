@@ -0,0 +1,223 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/RenderCommandStream.hpp"
+#include "Engine/Renderer/NullRenderer.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <cstdio>
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	struct DecodedCommand
+	{
+		RenderCommandType		m_type = RenderCommandType::COUNT;
+		std::vector<uint8_t>	m_payload;
+
+		template<typename T>
+		T GetPayload() const
+		{
+			T result;
+			memcpy(static_cast<void*>(&result), m_payload.data(), sizeof(T));
+			return result;
+		}
+	};
+
+	std::vector<DecodedCommand> DecodeStream(RenderCommandStream const& stream)
+	{
+		std::vector<DecodedCommand> commands;
+		size_t offset = 0;
+		RenderCommandType type;
+		uint8_t const* payload = nullptr;
+		uint32_t payloadSize = 0;
+		while (stream.ReadCommand(offset, type, payload, payloadSize))
+		{
+			DecodedCommand command;
+			command.m_type = type;
+			command.m_payload.assign(payload, payload + payloadSize);
+			commands.push_back(command);
+		}
+		return commands;
+	}
+
+	std::vector<Vertex_PCU> MakeVerts(int numVerts)
+	{
+		std::vector<Vertex_PCU> verts;
+		for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+		{
+			verts.push_back(Vertex_PCU(Vec3(static_cast<float>(vertIndex), 1.f, 2.f), Rgba8(10, 20, 30, 40), Vec2(0.5f, 0.25f)));
+		}
+		return verts;
+	}
+
+	bool IsSameCounters(RenderCounters const& a, RenderCounters const& b)
+	{
+		return a.m_numCommands == b.m_numCommands && a.m_numDrawCalls == b.m_numDrawCalls && a.m_numVertexes == b.m_numVertexes
+			&& a.m_numIndexes == b.m_numIndexes && a.m_numInstances == b.m_numInstances && a.m_numStateChanges == b.m_numStateChanges
+			&& a.m_numConstantUpdates == b.m_numConstantUpdates && a.m_numBytesCopied == b.m_numBytesCopied && a.m_numCameras == b.m_numCameras;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(RenderCommandStream, RecordsKnownFrame)
+{
+	RendererConfig config;
+	NullRenderer renderer(config);
+	renderer.Startup();
+	Texture* texture = renderer.CreateOrGetTextureFromImage(Image(IntVec2(4, 4), Rgba8::OPAQUE_WHITE, "StreamTest.png"));
+
+	// Startup binds the defaults, this frame takes those commands so the next one starts clean
+	renderer.BeginFrame();
+	renderer.EndFrame();
+	uint32_t defaultTextureId = INVALID_INDEX_U32;
+	for (DecodedCommand const& command : DecodeStream(renderer.GetLastFrameStream()))
+	{
+		if (command.m_type == RenderCommandType::BIND_TEXTURE && command.GetPayload<RenderCommandState>().m_slot == 0)
+		{
+			defaultTextureId = command.GetPayload<RenderCommandState>().m_value;
+		}
+	}
+	TEST_CHECK(defaultTextureId != INVALID_INDEX_U32);
+
+	std::vector<Vertex_PCU> triangleVerts = MakeVerts(6);
+	std::vector<Vertex_PCU> quadVerts = MakeVerts(4);
+	std::vector<unsigned int> quadIndexes = { 0, 1, 2, 0, 2, 3 };
+	renderer.BeginFrame();
+	renderer.SetBlendMode(BlendMode::ALPHA);
+	renderer.SetBlendMode(BlendMode::ALPHA);	// redundant, counted but not recorded
+	renderer.BindTexture(texture);
+	renderer.BindShader(nullptr);				// the default is still bound, redundant
+	renderer.SetModelConstants(Mat44::MakeTranslation3D(Vec3(1.f, 2.f, 3.f)), Rgba8(255, 0, 0, 255));
+	renderer.DrawVertexArray(triangleVerts);
+	renderer.DrawIndexedVertexArray(quadVerts, quadIndexes);
+	renderer.EndFrame();
+
+	RenderCommandType const expectedTypes[] =
+	{
+		RenderCommandType::BEGIN_FRAME,
+		RenderCommandType::SET_BLEND_MODE,
+		RenderCommandType::BIND_TEXTURE,
+		RenderCommandType::SET_CONSTANTS,
+		RenderCommandType::COPY_TO_BUFFER,
+		RenderCommandType::DRAW,
+		RenderCommandType::COPY_TO_BUFFER,
+		RenderCommandType::COPY_TO_BUFFER,
+		RenderCommandType::DRAW_INDEXED,
+		RenderCommandType::END_FRAME,
+	};
+	int const numExpected = static_cast<int>(sizeof(expectedTypes) / sizeof(expectedTypes[0]));
+	RenderCommandStream const& stream = renderer.GetLastFrameStream();
+	std::vector<DecodedCommand> commands = DecodeStream(stream);
+	TEST_CHECK_EQUAL(static_cast<int>(commands.size()), numExpected);
+	TEST_CHECK_EQUAL(stream.GetNumCommands(), numExpected);
+	for (int commandIndex = 0; commandIndex < numExpected && commandIndex < static_cast<int>(commands.size()); ++commandIndex)
+	{
+		TEST_CHECK(commands[commandIndex].m_type == expectedTypes[commandIndex]);
+	}
+	if (static_cast<int>(commands.size()) != numExpected)
+	{
+		renderer.Shutdown();
+		return;
+	}
+
+	// Payloads
+	TEST_CHECK_EQUAL(commands[1].GetPayload<RenderCommandState>().m_value, static_cast<uint32_t>(BlendMode::ALPHA));
+	TEST_CHECK(commands[2].GetPayload<RenderCommandState>().m_value != defaultTextureId);
+	TEST_CHECK_EQUAL(commands[2].GetPayload<RenderCommandState>().m_slot, 0);
+	RenderCommandConstants constants = commands[3].GetPayload<RenderCommandConstants>();
+	TEST_CHECK_EQUAL(constants.m_numBytes, static_cast<uint32_t>(sizeof(ModelConstants)));
+	TEST_CHECK_EQUAL(commands[3].m_payload.size(), sizeof(RenderCommandConstants) + sizeof(ModelConstants));
+
+	uint32_t const triangleBytes = static_cast<uint32_t>(triangleVerts.size() * sizeof(Vertex_PCU));
+	RenderCommandCopy triangleCopy = commands[4].GetPayload<RenderCommandCopy>();
+	TEST_CHECK(triangleCopy.m_bufferType == RenderBufferType::VERTEX);
+	TEST_CHECK_EQUAL(triangleCopy.m_numBytes, triangleBytes);
+	TEST_CHECK_EQUAL(triangleCopy.m_numRecordedBytes, triangleBytes);
+	TEST_CHECK(memcmp(commands[4].m_payload.data() + sizeof(RenderCommandCopy), triangleVerts.data(), triangleBytes) == 0);
+	RenderCommandDraw draw = commands[5].GetPayload<RenderCommandDraw>();
+	TEST_CHECK_EQUAL(draw.m_vertexBufferId, triangleCopy.m_bufferId);
+	TEST_CHECK_EQUAL(draw.m_stride, static_cast<uint32_t>(sizeof(Vertex_PCU)));
+	TEST_CHECK_EQUAL(draw.m_count, 6u);
+
+	RenderCommandCopy indexCopy = commands[7].GetPayload<RenderCommandCopy>();
+	TEST_CHECK(indexCopy.m_bufferType == RenderBufferType::INDEX);
+	TEST_CHECK(memcmp(commands[7].m_payload.data() + sizeof(RenderCommandCopy), quadIndexes.data(), quadIndexes.size() * sizeof(unsigned int)) == 0);
+	RenderCommandDraw indexedDraw = commands[8].GetPayload<RenderCommandDraw>();
+	TEST_CHECK_EQUAL(indexedDraw.m_vertexBufferId, commands[6].GetPayload<RenderCommandCopy>().m_bufferId);
+	TEST_CHECK_EQUAL(indexedDraw.m_indexBufferId, indexCopy.m_bufferId);
+	TEST_CHECK_EQUAL(indexedDraw.m_count, 6u);
+
+	// Counters, live and replayed from the stream
+	uint64_t const expectedBytes = sizeof(ModelConstants) + triangleBytes + quadVerts.size() * sizeof(Vertex_PCU) + quadIndexes.size() * sizeof(unsigned int);
+	RenderCounters const& counters = renderer.GetLastFrameCounters();
+	TEST_CHECK_EQUAL(counters.m_numCommands, static_cast<uint64_t>(numExpected));
+	TEST_CHECK_EQUAL(counters.m_numDrawCalls, 2ull);
+	TEST_CHECK_EQUAL(counters.m_numVertexes, 6ull);
+	TEST_CHECK_EQUAL(counters.m_numIndexes, 6ull);
+	TEST_CHECK_EQUAL(counters.m_numStateChanges, 2ull);
+	TEST_CHECK_EQUAL(counters.m_numRedundantStateChanges, 2ull);
+	TEST_CHECK_EQUAL(counters.m_numConstantUpdates, 1ull);
+	TEST_CHECK_EQUAL(counters.m_numBytesCopied, expectedBytes);
+	RenderCounters replayed = stream.ComputeCounters();
+	TEST_CHECK(IsSameCounters(replayed, counters));
+	TEST_CHECK_EQUAL(replayed.m_numRedundantStateChanges, 0ull);
+
+	// Bindings carry over, the same state next frame is all redundant
+	renderer.BeginFrame();
+	renderer.SetBlendMode(BlendMode::ALPHA);
+	renderer.BindTexture(texture);
+	renderer.EndFrame();
+	TEST_CHECK_EQUAL(renderer.GetLastFrameCounters().m_numStateChanges, 0ull);
+	TEST_CHECK_EQUAL(renderer.GetLastFrameCounters().m_numRedundantStateChanges, 2ull);
+	TEST_CHECK_EQUAL(renderer.GetLastFrameCounters().m_numCommands, 2ull);
+	TEST_CHECK_EQUAL(renderer.GetNumFramesRecorded(), 3);
+	renderer.Shutdown();
+}
+
+ENGINE_TEST(RenderCommandStream, SaveLoadAndMalformedInput)
+{
+	RenderCommandStream stream;
+	RenderCommandDraw draw;
+	draw.m_vertexBufferId = 3;
+	draw.m_stride = sizeof(Vertex_PCU);
+	draw.m_count = 99;
+	stream.Write(RenderCommandType::BEGIN_FRAME);
+	stream.Write(RenderCommandType::DRAW, &draw, sizeof(draw));
+	stream.Write(RenderCommandType::END_FRAME);
+
+	std::string const filePath = "/tmp/EngineTests_Stream.rcs";
+	TEST_CHECK(stream.SaveToFile(filePath));
+	RenderCommandStream loaded;
+	TEST_CHECK(loaded.LoadFromFile(filePath));
+	TEST_CHECK(loaded.GetBytes() == stream.GetBytes());
+	TEST_CHECK_EQUAL(loaded.GetNumCommands(), 3);
+	TEST_CHECK(IsSameCounters(loaded.ComputeCounters(), stream.ComputeCounters()));
+	TEST_CHECK_EQUAL(loaded.ComputeCounters().m_numVertexes, 99ull);
+
+	// Cut inside the draw payload: the draw is not read, the command before it still is
+	std::vector<uint8_t> fileBytes;
+	FileReadToBuffer(fileBytes, filePath);
+	fileBytes.resize(fileBytes.size() - 6);
+	FileWriteFromBuffer(fileBytes, filePath);
+	RenderCommandStream truncated;
+	TEST_CHECK(truncated.LoadFromFile(filePath));
+	size_t offset = 0;
+	RenderCommandType type;
+	uint8_t const* payload = nullptr;
+	uint32_t payloadSize = 0;
+	int numRead = 0;
+	while (truncated.ReadCommand(offset, type, payload, payloadSize))
+	{
+		++numRead;
+	}
+	TEST_CHECK_EQUAL(numRead, 1);
+	TEST_CHECK_EQUAL(truncated.ComputeCounters().m_numDrawCalls, 0ull);
+	remove(filePath.c_str());
+
+	TEST_CHECK(strcmp(GetRenderCommandName(RenderCommandType::DRAW), "UNKNOWN") != 0);
+	TEST_CHECK(strcmp(GetRenderCommandName(RenderCommandType::COUNT), "UNKNOWN") == 0);
+	TEST_CHECK(strcmp(GetRenderCommandName(static_cast<RenderCommandType>(200)), "UNKNOWN") == 0);
+}
@@ -0,0 +1,177 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Renderer/NullRenderer.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// The first vertex of every submitted triangle carries its item id in x
+	std::vector<Vertex_PCU> MakeTaggedTriangle(int itemId)
+	{
+		std::vector<Vertex_PCU> verts;
+		for (int vertIndex = 0; vertIndex < 3; ++vertIndex)
+		{
+			verts.push_back(Vertex_PCU(Vec3(static_cast<float>(itemId), static_cast<float>(vertIndex), 0.f), Rgba8::OPAQUE_WHITE, Vec2()));
+		}
+		return verts;
+	}
+
+	// Item ids in draw order, read back from the vertex uploads in the recorded frame
+	std::vector<int> GetDrawnItemIds(RenderCommandStream const& stream)
+	{
+		std::vector<int> itemIds;
+		size_t offset = 0;
+		RenderCommandType type;
+		uint8_t const* payload = nullptr;
+		uint32_t payloadSize = 0;
+		int lastUploadedId = -1;
+		while (stream.ReadCommand(offset, type, payload, payloadSize))
+		{
+			if (type == RenderCommandType::COPY_TO_BUFFER && payloadSize >= sizeof(RenderCommandCopy) + sizeof(Vertex_PCU))
+			{
+				RenderCommandCopy copy;
+				memcpy(&copy, payload, sizeof(copy));
+				if (copy.m_bufferType == RenderBufferType::VERTEX)
+				{
+					Vertex_PCU firstVertex;
+					memcpy(static_cast<void*>(&firstVertex), payload + sizeof(copy), sizeof(firstVertex));
+					lastUploadedId = static_cast<int>(firstVertex.m_position.x);
+				}
+			}
+			else if (type == RenderCommandType::DRAW)
+			{
+				itemIds.push_back(lastUploadedId);
+			}
+		}
+		return itemIds;
+	}
+
+	int CountCommands(RenderCommandStream const& stream, RenderCommandType countedType)
+	{
+		int numCommands = 0;
+		size_t offset = 0;
+		RenderCommandType type;
+		uint8_t const* payload = nullptr;
+		uint32_t payloadSize = 0;
+		while (stream.ReadCommand(offset, type, payload, payloadSize))
+		{
+			numCommands += (type == countedType) ? 1 : 0;
+		}
+		return numCommands;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(RenderQueue, RadixSortIsStable)
+{
+	std::mt19937_64 random(3);
+	std::vector<RenderSortItem> items;
+	std::vector<RenderSortItem> scratch;
+	for (int numItems : { 0, 1, 2, 100, 5000 })
+	{
+		items.clear();
+		for (int itemIndex = 0; itemIndex < numItems; ++itemIndex)
+		{
+			// Few distinct keys so stability matters, spread over low and high bytes so passes run and skip
+			RenderSortItem item;
+			item.m_key = ((random() % 7) << 58) | ((random() % 5) << 20) | (random() % 3);
+			item.m_index = static_cast<uint32_t>(itemIndex);
+			items.push_back(item);
+		}
+		std::vector<RenderSortItem> expected = items;
+		std::stable_sort(expected.begin(), expected.end(), [](RenderSortItem const& a, RenderSortItem const& b) { return a.m_key < b.m_key; });
+
+		RadixSortRenderItems(items, scratch);
+		bool isSame = items.size() == expected.size();
+		for (size_t itemIndex = 0; isSame && itemIndex < items.size(); ++itemIndex)
+		{
+			isSame = items[itemIndex].m_key == expected[itemIndex].m_key && items[itemIndex].m_index == expected[itemIndex].m_index;
+		}
+		TEST_CHECK(isSame);
+	}
+}
+
+ENGINE_TEST(RenderQueue, FlushOrdersAndElidesState)
+{
+	RendererConfig config;
+	NullRenderer renderer(config);
+	renderer.Startup();
+	Texture* textureA = renderer.CreateOrGetTextureFromImage(Image(IntVec2(4, 4), Rgba8::OPAQUE_WHITE, "QueueA.png"));
+	Texture* textureB = renderer.CreateOrGetTextureFromImage(Image(IntVec2(4, 4), Rgba8::OPAQUE_WHITE, "QueueB.png"));
+
+	// Startup binds the defaults, this frame takes those commands so the next one starts clean
+	renderer.BeginFrame();
+	renderer.EndFrame();
+	{
+		RenderState opaqueA;
+		opaqueA.m_texture = textureA;
+		RenderState opaqueB = opaqueA;
+		opaqueB.m_texture = textureB;
+		RenderState alphaA = opaqueA;
+		alphaA.m_blendMode = BlendMode::ALPHA;
+		RenderState alphaB = alphaA;
+		alphaB.m_texture = textureB;
+
+		struct Submission
+		{
+			int			m_pass = 0;
+			RenderState	m_state;
+			float		m_viewDepth = 0.f;
+		};
+		Submission const submissions[] =
+		{
+			{ 0, opaqueA, 5.f },
+			{ 0, opaqueB, 1.f },
+			{ 0, alphaA, 2.f },
+			{ 0, opaqueA, 1.f },
+			{ 1, opaqueA, 0.5f },
+			{ 0, alphaB, 8.f },
+			{ 0, opaqueB, 3.f },
+			{ 0, alphaA, 4.f },
+		};
+		int const numItems = static_cast<int>(sizeof(submissions) / sizeof(submissions[0]));
+
+		RenderQueue queue(&renderer);
+		queue.BeginFrame();
+		renderer.BeginFrame();
+		for (int itemId = 0; itemId < numItems; ++itemId)
+		{
+			Submission const& submission = submissions[itemId];
+			queue.Submit(submission.m_pass, submission.m_state, MakeTaggedTriangle(itemId), Mat44(), Rgba8::OPAQUE_WHITE, submission.m_viewDepth);
+		}
+		TEST_CHECK_EQUAL(queue.GetNumQueuedItems(), numItems);
+		queue.Flush();
+		renderer.EndFrame();
+		TEST_CHECK_EQUAL(queue.GetNumQueuedItems(), 0);
+
+		// Pass first, opaque grouped by texture front to back, then blended back to front
+		std::vector<int> const expectedOrder = { 3, 0, 1, 6, 5, 7, 2, 4 };
+		TEST_CHECK(GetDrawnItemIds(renderer.GetLastFrameStream()) == expectedOrder);
+
+		// Sorted: all 6 fields for the first draw, then texture, blend, texture, blend. Submit order
+		// pays 1 + 2 + 1 + 0 + 2 + 1 + 2 after the first
+		RenderQueueStats const& stats = queue.GetLastFlushStats();
+		TEST_CHECK_EQUAL(stats.m_numItems, numItems);
+		TEST_CHECK_EQUAL(stats.m_numDrawCalls, numItems);
+		TEST_CHECK_EQUAL(stats.m_numStateChanges, 10);
+		TEST_CHECK_EQUAL(stats.m_numSubmitOrderStateChanges, 15);
+		TEST_CHECK_EQUAL(stats.m_numStateSetsSaved, numItems * 6 - 10);
+		TEST_CHECK_EQUAL(stats.m_numModelConstantsSkipped, numItems - 1);
+		TEST_CHECK_EQUAL(CountCommands(renderer.GetLastFrameStream(), RenderCommandType::SET_CONSTANTS), 1);
+		TEST_CHECK_EQUAL(CountCommands(renderer.GetLastFrameStream(), RenderCommandType::BIND_TEXTURE), 3);
+		TEST_CHECK_EQUAL(CountCommands(renderer.GetLastFrameStream(), RenderCommandType::SET_BLEND_MODE), 3);
+
+		// A second frame starts fresh flush stats and keeps the last frame's
+		queue.BeginFrame();
+		TEST_CHECK_EQUAL(queue.GetLastFrameStats().m_numDrawCalls, numItems);
+		TEST_CHECK_EQUAL(queue.GetFrameStats().m_numDrawCalls, 0);
+	}
+	renderer.Shutdown();
+}
@@ -0,0 +1,105 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/SDFFontAtlas.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// 4x4 grid of 8x8 cells, glyph 5 is a box of ink over source columns 2-5 and rows 1-6
+	constexpr int INK_GLYPH = 5;
+	IntVec2 const GRID_LAYOUT(4, 4);
+	IntVec2 const INK_MINS(2, 1);
+	IntVec2 const INK_MAXS(6, 7);	// exclusive
+
+	Image MakeGlyphSheet()
+	{
+		Image sheet(IntVec2(32, 32), Rgba8(0, 0, 0, 0), "SDFTestGlyphs.png");
+		IntVec2 const cellMins((INK_GLYPH % GRID_LAYOUT.x) * 8, (GRID_LAYOUT.y - 1 - INK_GLYPH / GRID_LAYOUT.x) * 8);
+		for (int y = INK_MINS.y; y < INK_MAXS.y; ++y)
+		{
+			for (int x = INK_MINS.x; x < INK_MAXS.x; ++x)
+			{
+				sheet.SetTexelColor(cellMins + IntVec2(x, y), Rgba8(255, 255, 255, 255));
+			}
+		}
+		return sheet;
+	}
+
+	// Exact signed distance to a box, positive inside, everything in atlas texels
+	float GetSignedDistanceToBox(float x, float y, float minX, float minY, float maxX, float maxY)
+	{
+		float outsideX = std::max(std::max(minX - x, x - maxX), 0.f);
+		float outsideY = std::max(std::max(minY - y, y - maxY), 0.f);
+		if (outsideX > 0.f || outsideY > 0.f)
+		{
+			return -sqrtf(outsideX * outsideX + outsideY * outsideY);
+		}
+		return std::min(std::min(x - minX, maxX - x), std::min(y - minY, maxY - y));
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(SDFFontAtlas, DistancesMatchAnExactBox)
+{
+	Image const sheet = MakeGlyphSheet();
+	SDFFontConfig config;
+	config.m_glyphGridLayout = GRID_LAYOUT;
+	config.m_atlasGlyphSize = 32;
+	config.m_spreadTexels = 4;
+	SDFFontAtlas atlas = GenerateSDFFontAtlas(sheet, config);
+	TEST_CHECK(atlas.m_image.GetDimensions() == IntVec2(128, 128));
+	TEST_CHECK_EQUAL(atlas.m_glyphs.size(), 16ull);
+
+	// 24 content texels over 8 source texels, after 4 texels of padding. The field is measured on a
+	// supersampled grid, so it may be a few alpha steps off the exact box
+	float const scale = 3.f;
+	float const padding = 4.f;
+	IntVec2 const atlasCellMins((INK_GLYPH % GRID_LAYOUT.x) * 32, (GRID_LAYOUT.y - 1 - INK_GLYPH / GRID_LAYOUT.x) * 32);
+	int maxDifference = 0;
+	for (int y = 0; y < 32; ++y)
+	{
+		for (int x = 0; x < 32; ++x)
+		{
+			float distance = GetSignedDistanceToBox(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f,
+				padding + INK_MINS.x * scale, padding + INK_MINS.y * scale, padding + INK_MAXS.x * scale, padding + INK_MAXS.y * scale);
+			float encoded = std::min(std::max(0.5f + 0.5f * distance / padding, 0.f), 1.f);
+			int expected = static_cast<int>(encoded * 255.f + 0.5f);
+			int difference = std::abs(static_cast<int>(atlas.m_image.GetTexelColor(atlasCellMins + IntVec2(x, y)).a) - expected);
+			maxDifference = std::max(maxDifference, difference);
+		}
+	}
+	TEST_CHECK(maxDifference <= 4);
+
+	// Cells without ink are fully outside
+	TEST_CHECK_EQUAL(static_cast<int>(atlas.m_image.GetTexelColor(IntVec2(16, 16)).a), 0);
+
+	// Ink is 4 of 8 source columns, plus half a source texel of bearing on either side
+	TEST_CHECK_EQUAL(atlas.m_glyphs[INK_GLYPH].m_advance, 0.625f);
+	TEST_CHECK_EQUAL(atlas.m_glyphs[0].m_advance, config.m_emptyGlyphAdvance);
+	config.m_isMonospace = true;
+	SDFFontAtlas monospace = GenerateSDFFontAtlas(sheet, config);
+	TEST_CHECK_EQUAL(monospace.m_glyphs[INK_GLYPH].m_advance, 1.f);
+	TEST_CHECK_EQUAL(monospace.m_glyphs[0].m_advance, 1.f);
+}
+
+ENGINE_TEST(SDFFontAtlas, PooledMatchesSerial)
+{
+	Image const sheet = MakeGlyphSheet();
+	SDFFontConfig config;
+	config.m_glyphGridLayout = GRID_LAYOUT;
+	SDFFontAtlas serial = GenerateSDFFontAtlas(sheet, config);
+	WorkerPool workers(3);
+	SDFFontAtlas pooled = GenerateSDFFontAtlas(sheet, config, &workers);
+
+	IntVec2 const dimensions = serial.m_image.GetDimensions();
+	TEST_CHECK(pooled.m_image.GetDimensions() == dimensions);
+	TEST_CHECK(memcmp(serial.m_image.GetRawData(), pooled.m_image.GetRawData(), static_cast<size_t>(dimensions.x) * dimensions.y * sizeof(Rgba8)) == 0);
+	for (size_t glyphIndex = 0; glyphIndex < serial.m_glyphs.size(); ++glyphIndex)
+	{
+		TEST_CHECK_EQUAL(serial.m_glyphs[glyphIndex].m_advance, pooled.m_glyphs[glyphIndex].m_advance);
+	}
+}
@@ -0,0 +1,111 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Core/SlotMap.hpp"
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(SlotMap, StaleHandlesFail)
+{
+	SlotMap<int> slotMap;
+	SlotHandle first = slotMap.Add();
+	*slotMap.Get(first) = 1;
+	SlotHandle second = slotMap.Add();
+	*slotMap.Get(second) = 2;
+	TEST_CHECK(!SlotHandle().IsValid());
+	TEST_CHECK(!slotMap.IsValid(SlotHandle()));
+
+	TEST_CHECK(slotMap.Remove(first));
+	TEST_CHECK(!slotMap.IsValid(first));
+	TEST_CHECK(slotMap.Get(first) == nullptr);
+	TEST_CHECK(!slotMap.Remove(first));
+	TEST_CHECK_EQUAL(slotMap.GetCount(), 1);
+
+	// The freed slot comes back under a new generation, the old handle must not reach its new owner
+	SlotHandle reused = slotMap.Add();
+	TEST_CHECK_EQUAL(reused.m_index, first.m_index);
+	TEST_CHECK_EQUAL(reused.m_generation, first.m_generation + 1);
+	TEST_CHECK(reused != first);
+	TEST_CHECK(slotMap.Get(first) == nullptr);
+	TEST_CHECK(!slotMap.Remove(first));
+	TEST_CHECK(slotMap.IsValid(reused));
+	TEST_CHECK_EQUAL(*slotMap.Get(second), 2);
+
+	// A handle from past the end of the slots is just as invalid
+	SlotHandle outOfRange;
+	outOfRange.m_index = 100;
+	TEST_CHECK(slotMap.Get(outOfRange) == nullptr);
+}
+
+ENGINE_TEST(SlotMap, ChurnReusesSlots)
+{
+	constexpr int NUM_LIVE = 64;
+	SlotMap<std::vector<int>> slotMap;
+	std::vector<SlotHandle> handles;
+	std::vector<SlotHandle> staleHandles;
+	for (int round = 0; round < 100; ++round)
+	{
+		for (int objectIndex = 0; objectIndex < NUM_LIVE; ++objectIndex)
+		{
+			SlotHandle handle = slotMap.Add();
+			std::vector<int>& value = *slotMap.Get(handle);
+			value.clear();
+			value.push_back(round * NUM_LIVE + objectIndex);
+			handles.push_back(handle);
+		}
+		TEST_CHECK_EQUAL(slotMap.GetCount(), NUM_LIVE);
+		TEST_CHECK_EQUAL(slotMap.GetCapacity(), NUM_LIVE);
+		for (SlotHandle handle : staleHandles)
+		{
+			TEST_CHECK(!slotMap.IsValid(handle));
+		}
+
+		// Odd rounds drop everything at once, even rounds one by one in a scattered order
+		if (round % 2 == 1)
+		{
+			slotMap.Clear();
+		}
+		else
+		{
+			for (int objectIndex = 0; objectIndex < NUM_LIVE; ++objectIndex)
+			{
+				SlotHandle handle = handles[(objectIndex * 37) % NUM_LIVE];
+				TEST_CHECK_EQUAL((*slotMap.Get(handle))[0] % NUM_LIVE, (objectIndex * 37) % NUM_LIVE);
+				TEST_CHECK(slotMap.Remove(handle));
+			}
+		}
+		TEST_CHECK_EQUAL(slotMap.GetCount(), 0);
+		staleHandles.swap(handles);
+		handles.clear();
+	}
+}
+
+ENGINE_TEST(SlotMap, DenseIterationAfterRemove)
+{
+	SlotMap<int> slotMap;
+	std::vector<SlotHandle> handles;
+	for (int value = 0; value < 10; ++value)
+	{
+		handles.push_back(slotMap.Add());
+		*slotMap.Get(handles.back()) = value;
+	}
+
+	// Backwards, a removal swaps the last live object into the hole
+	for (int denseIndex = slotMap.GetCount() - 1; denseIndex >= 0; --denseIndex)
+	{
+		if (slotMap.GetAtDenseIndex(denseIndex) % 3 == 0)
+		{
+			TEST_CHECK(slotMap.Remove(slotMap.GetHandleAtDenseIndex(denseIndex)));
+		}
+	}
+	TEST_CHECK_EQUAL(slotMap.GetCount(), 6);
+
+	int valueMask = 0;
+	for (int denseIndex = 0; denseIndex < slotMap.GetCount(); ++denseIndex)
+	{
+		SlotHandle handle = slotMap.GetHandleAtDenseIndex(denseIndex);
+		int value = slotMap.GetAtDenseIndex(denseIndex);
+		TEST_CHECK(handle == handles[value]);
+		TEST_CHECK(slotMap.Get(handle) == &slotMap.GetAtDenseIndex(denseIndex));
+		valueMask |= 1 << value;
+	}
+	TEST_CHECK_EQUAL(valueMask, (1 << 1) | (1 << 2) | (1 << 4) | (1 << 5) | (1 << 7) | (1 << 8));
+}
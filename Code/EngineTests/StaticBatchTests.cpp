@@ -0,0 +1,162 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/StaticBatch.hpp"
+#include "Engine/Renderer/NullRenderer.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// Sees the merged arrays, to check them against the meshes the entries were added with
+	class StaticBatchProbe : public StaticBatch
+	{
+	public:
+		using StaticBatch::StaticBatch;
+
+		// Every live entry's range holds its own mesh, every other index is part of a degenerate triangle
+		int GetNumInconsistencies() const
+		{
+			int numInconsistencies = 0;
+			for (int materialIndex = 0; materialIndex < static_cast<int>(m_materials.size()); ++materialIndex)
+			{
+				Material const& material = m_materials[materialIndex];
+				std::vector<int> ownerCounts(material.m_indexes.size(), 0);
+				for (StaticBatchHandle handle : material.m_entryHandles)
+				{
+					Entry const& entry = *m_entries.Get(handle);
+					StaticBatchRange const& range = entry.m_range;
+					numInconsistencies += (range.m_materialIndex == materialIndex) ? 0 : 1;
+					for (int vertIndex = 0; vertIndex < range.m_numVertexes; ++vertIndex)
+					{
+						Vec3 expectedPosition = entry.m_modelToWorldTransform.TransformPosition3D(entry.m_modelVerts[vertIndex].m_position);
+						Vec3 const& position = material.m_verts[range.m_firstVertex + vertIndex].m_position;
+						numInconsistencies += (position.x == expectedPosition.x && position.y == expectedPosition.y && position.z == expectedPosition.z) ? 0 : 1;
+					}
+					for (int index = 0; index < range.m_numIndexes; ++index)
+					{
+						unsigned int modelIndex = entry.m_modelIndexes.empty() ? static_cast<unsigned int>(index) : entry.m_modelIndexes[index];
+						numInconsistencies += (material.m_indexes[range.m_firstIndex + index] == range.m_firstVertex + modelIndex) ? 0 : 1;
+						++ownerCounts[range.m_firstIndex + index];
+					}
+				}
+				for (size_t index = 0; index + 2 < material.m_indexes.size(); index += 3)
+				{
+					bool isOwned = ownerCounts[index] != 0;
+					bool isDegenerate = material.m_indexes[index] == material.m_indexes[index + 1] && material.m_indexes[index] == material.m_indexes[index + 2];
+					numInconsistencies += (ownerCounts[index] > 1 || (!isOwned && !isDegenerate)) ? 1 : 0;
+				}
+			}
+			return numInconsistencies;
+		}
+	};
+
+	std::vector<Vertex_PCU> MakeQuadVerts(float x)
+	{
+		std::vector<Vertex_PCU> verts;
+		Vec3 const corners[] = { Vec3(x, 0.f, 0.f), Vec3(x + 1.f, 0.f, 0.f), Vec3(x + 1.f, 1.f, 0.f), Vec3(x, 1.f, 0.f) };
+		for (Vec3 const& corner : corners)
+		{
+			verts.push_back(Vertex_PCU(corner, Rgba8::OPAQUE_WHITE, Vec2()));
+		}
+		return verts;
+	}
+
+	std::vector<unsigned int> const QUAD_INDEXES = { 0, 1, 2, 0, 2, 3 };
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(StaticBatch, RemoveKeepsOtherEntriesIntact)
+{
+	RendererConfig config;
+	NullRenderer renderer(config);
+	renderer.Startup();
+	{
+		StaticBatchProbe batch(&renderer);
+		RenderState opaque;
+		RenderState alpha;
+		alpha.m_blendMode = BlendMode::ALPHA;
+
+		std::vector<StaticBatchHandle> handles;
+		for (int entryIndex = 0; entryIndex < 300; ++entryIndex)
+		{
+			RenderState const& material = (entryIndex % 3 == 0) ? alpha : opaque;
+			if (entryIndex % 2 == 0)
+			{
+				handles.push_back(batch.Add(material, MakeQuadVerts(static_cast<float>(entryIndex)), QUAD_INDEXES));
+			}
+			else
+			{
+				// Triangle list without indexes
+				std::vector<Vertex_PCU> quadVerts = MakeQuadVerts(static_cast<float>(entryIndex));
+				std::vector<Vertex_PCU> triangleVerts = { quadVerts[0], quadVerts[1], quadVerts[2] };
+				handles.push_back(batch.Add(material, triangleVerts, Mat44::MakeTranslation3D(Vec3(0.f, 0.f, 5.f))));
+			}
+		}
+		TEST_CHECK_EQUAL(batch.GetNumMaterials(), 2);
+		TEST_CHECK_EQUAL(batch.GetNumInconsistencies(), 0);
+
+		// Remove in a scattered order, checking along the way: holes, tail removals and compactions all happen
+		int numRemoved = 0;
+		for (int step = 0; step < 300; ++step)
+		{
+			int entryIndex = (step * 7) % 300;
+			TEST_CHECK(batch.Remove(handles[entryIndex]));
+			TEST_CHECK(!batch.Remove(handles[entryIndex]));
+			++numRemoved;
+			if (step % 25 == 0)
+			{
+				TEST_CHECK_EQUAL(batch.GetNumInconsistencies(), 0);
+				TEST_CHECK_EQUAL(batch.GetNumEntries(), 300 - numRemoved);
+			}
+			if (step == 150)
+			{
+				TEST_CHECK(batch.UpdateTransform(handles[(151 * 7) % 300], Mat44::MakeTranslation3D(Vec3(1.f, 2.f, 3.f))));
+				TEST_CHECK_EQUAL(batch.GetNumInconsistencies(), 0);
+			}
+		}
+		TEST_CHECK_EQUAL(batch.GetNumEntries(), 0);
+		TEST_CHECK_EQUAL(batch.GetNumVertexes(), 0);
+		TEST_CHECK_EQUAL(batch.GetNumIndexes(), 0);
+	}
+	renderer.Shutdown();
+}
+
+// Changes upload only the bytes they touched once the buffers exist
+ENGINE_TEST(StaticBatch, UploadsOnlyChangedRanges)
+{
+	RendererConfig config;
+	NullRenderer renderer(config);
+	renderer.Startup();
+	{
+		StaticBatch batch(&renderer);
+		RenderState opaque;
+		std::vector<StaticBatchHandle> handles;
+		for (int entryIndex = 0; entryIndex < 100; ++entryIndex)
+		{
+			handles.push_back(batch.Add(opaque, MakeQuadVerts(static_cast<float>(entryIndex)), QUAD_INDEXES));
+		}
+		batch.Render();
+		int const fullBytes = 100 * (4 * static_cast<int>(sizeof(Vertex_PCU)) + 6 * static_cast<int>(sizeof(unsigned int)));
+		TEST_CHECK_EQUAL(batch.GetLastNumUploadedBytes(), fullBytes);
+		TEST_CHECK_EQUAL(batch.GetLastNumDrawCalls(), 1);
+
+		batch.Render();
+		TEST_CHECK_EQUAL(batch.GetLastNumUploads(), 0);
+
+		batch.UpdateTransform(handles[40], Mat44::MakeTranslation3D(Vec3(0.f, 0.f, 1.f)));
+		batch.Render();
+		TEST_CHECK_EQUAL(batch.GetLastNumUploadedBytes(), 4 * static_cast<int>(sizeof(Vertex_PCU)));
+
+		batch.Remove(handles[50]);
+		batch.Render();
+		TEST_CHECK_EQUAL(batch.GetLastNumUploadedBytes(), 6 * static_cast<int>(sizeof(unsigned int)));
+
+		// Removing the last entry only shrinks the arrays, nothing to upload
+		batch.Remove(handles[99]);
+		batch.Render();
+		TEST_CHECK_EQUAL(batch.GetLastNumUploads(), 0);
+		TEST_CHECK_EQUAL(batch.GetNumIndexes(), 98 * 6);
+	}
+	renderer.Shutdown();
+}
@@ -0,0 +1,150 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/TextureAtlas.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include <random>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	struct PlacedRect
+	{
+		IntVec2 m_mins;
+		IntVec2 m_size;
+	};
+
+	bool DoRectsOverlap(PlacedRect const& a, PlacedRect const& b)
+	{
+		return a.m_mins.x < b.m_mins.x + b.m_size.x && b.m_mins.x < a.m_mins.x + a.m_size.x
+			&& a.m_mins.y < b.m_mins.y + b.m_size.y && b.m_mins.y < a.m_mins.y + a.m_size.y;
+	}
+
+	bool IsInsideBounds(PlacedRect const& rect, IntVec2 const& bounds)
+	{
+		return rect.m_mins.x >= 0 && rect.m_mins.y >= 0 && rect.m_mins.x + rect.m_size.x <= bounds.x && rect.m_mins.y + rect.m_size.y <= bounds.y;
+	}
+
+	bool AreAllApartAndInside(std::vector<PlacedRect> const& rects, IntVec2 const& bounds)
+	{
+		for (size_t rectIndex = 0; rectIndex < rects.size(); ++rectIndex)
+		{
+			if (!IsInsideBounds(rects[rectIndex], bounds))
+			{
+				return false;
+			}
+			for (size_t otherIndex = rectIndex + 1; otherIndex < rects.size(); ++otherIndex)
+			{
+				if (DoRectsOverlap(rects[rectIndex], rects[otherIndex]))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool IsSameColor(Rgba8 const& a, Rgba8 const& b)
+	{
+		return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(TextureAtlas, PackerPlacementsStayApartAndInside)
+{
+	// Random sizes until the bin is full, every placement checked against all the others
+	std::mt19937 random(11);
+	for (IntVec2 const& binDimensions : { IntVec2(256, 256), IntVec2(512, 128), IntVec2(97, 301) })
+	{
+		MaxRectsPacker packer;
+		packer.Reset(binDimensions);
+		std::vector<PlacedRect> placed;
+		int expectedArea = 0;
+		int numFailed = 0;
+		for (int attempt = 0; attempt < 2000 && numFailed < 200; ++attempt)
+		{
+			IntVec2 size(1 + static_cast<int>(random() % 40), 1 + static_cast<int>(random() % 40));
+			IntVec2 mins;
+			if (packer.Insert(size, mins))
+			{
+				placed.push_back(PlacedRect{ mins, size });
+				expectedArea += size.x * size.y;
+			}
+			else
+			{
+				++numFailed;
+			}
+		}
+		TEST_CHECK(placed.size() > 10);
+		TEST_CHECK(AreAllApartAndInside(placed, binDimensions));
+		TEST_CHECK_EQUAL(packer.GetUsedArea(), expectedArea);
+		TEST_CHECK(packer.GetUsedDimensions().x <= binDimensions.x && packer.GetUsedDimensions().y <= binDimensions.y);
+	}
+
+	// Four quadrants fill the bin exactly, then nothing more fits
+	MaxRectsPacker packer;
+	packer.Reset(IntVec2(64, 64));
+	std::vector<PlacedRect> quadrants;
+	for (int quadrantIndex = 0; quadrantIndex < 4; ++quadrantIndex)
+	{
+		IntVec2 mins;
+		TEST_CHECK(packer.Insert(IntVec2(32, 32), mins));
+		quadrants.push_back(PlacedRect{ mins, IntVec2(32, 32) });
+	}
+	TEST_CHECK(AreAllApartAndInside(quadrants, IntVec2(64, 64)));
+	TEST_CHECK_EQUAL(packer.GetOccupancy(), 1.f);
+	IntVec2 unused;
+	TEST_CHECK(!packer.Insert(IntVec2(1, 1), unused));
+}
+
+ENGINE_TEST(TextureAtlas, SpritesAndPaddingStayApartOnTheirPages)
+{
+	std::mt19937 random(5);
+	std::vector<Image> images;
+	for (int imageIndex = 0; imageIndex < 150; ++imageIndex)
+	{
+		IntVec2 dimensions(1 + static_cast<int>(random() % 60), 1 + static_cast<int>(random() % 60));
+		images.emplace_back(dimensions, Rgba8(static_cast<unsigned char>(imageIndex), 100, static_cast<unsigned char>(imageIndex / 2), 255), "Sprite");
+	}
+	images.emplace_back(IntVec2(300, 20), Rgba8(200, 200, 200, 255), "Oversized");
+	std::vector<Image const*> imagePointers;
+	for (Image const& image : images)
+	{
+		imagePointers.push_back(&image);
+	}
+
+	TextureAtlasConfig config;
+	config.m_pageDimensions = IntVec2(256, 256);
+	config.m_padding = 2;
+	TextureAtlas atlas = BuildTextureAtlas(imagePointers, config);
+	TEST_CHECK_EQUAL(atlas.m_sprites.size(), images.size());
+	TEST_CHECK(atlas.m_pages.size() > 1);
+
+	// Padded rectangles must not overlap, or extrusion would write over a neighbour
+	std::vector<std::vector<PlacedRect>> paddedRectsPerPage(atlas.m_pages.size());
+	for (size_t spriteIndex = 0; spriteIndex < atlas.m_sprites.size(); ++spriteIndex)
+	{
+		TextureAtlasSprite const& sprite = atlas.m_sprites[spriteIndex];
+		TEST_CHECK(sprite.m_pageIndex >= 0 && sprite.m_pageIndex < static_cast<int>(atlas.m_pages.size()));
+		TEST_CHECK(sprite.m_dimensions == images[spriteIndex].GetDimensions());
+		PlacedRect padded{ sprite.m_texelMins - IntVec2(config.m_padding, config.m_padding), sprite.m_dimensions + IntVec2(2 * config.m_padding, 2 * config.m_padding) };
+		paddedRectsPerPage[sprite.m_pageIndex].push_back(padded);
+
+		// Corners of the sprite and of its extruded border carry the image's color
+		Image const& pageImage = atlas.m_pages[sprite.m_pageIndex].m_image;
+		Rgba8 const color = images[spriteIndex].GetTexelColor(IntVec2(0, 0));
+		TEST_CHECK(IsSameColor(pageImage.GetTexelColor(sprite.m_texelMins), color));
+		TEST_CHECK(IsSameColor(pageImage.GetTexelColor(padded.m_mins), color));
+		TEST_CHECK(IsSameColor(pageImage.GetTexelColor(padded.m_mins + padded.m_size - IntVec2(1, 1)), color));
+	}
+	for (size_t pageIndex = 0; pageIndex < atlas.m_pages.size(); ++pageIndex)
+	{
+		IntVec2 pageDimensions = atlas.m_pages[pageIndex].m_image.GetDimensions();
+		TEST_CHECK(AreAllApartAndInside(paddedRectsPerPage[pageIndex], pageDimensions));
+	}
+
+	// The oversized image gets a page of exactly its padded size
+	TextureAtlasSprite const& oversized = atlas.m_sprites.back();
+	TEST_CHECK_EQUAL(paddedRectsPerPage[oversized.m_pageIndex].size(), 1ull);
+	TEST_CHECK(atlas.m_pages[oversized.m_pageIndex].m_image.GetDimensions() == IntVec2(304, 24));
+}
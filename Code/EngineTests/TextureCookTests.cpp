@@ -0,0 +1,337 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/TextureCook.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	using BlockTexels = std::vector<Rgba8>;
+
+	struct BlockError
+	{
+		int		m_maxError = 0;		// largest channel difference of any texel
+		double	m_sumSquared = 0.0;
+		int		m_numValues = 0;
+
+		double GetRms() const { return (m_numValues > 0) ? std::sqrt(m_sumSquared / m_numValues) : 0.0; }
+	};
+
+	void AddError(BlockError& error, Rgba8 const source[16], Rgba8 const decoded[16], bool includeAlpha)
+	{
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			int const differences[4] = {
+				source[texelIndex].r - decoded[texelIndex].r, source[texelIndex].g - decoded[texelIndex].g,
+				source[texelIndex].b - decoded[texelIndex].b, source[texelIndex].a - decoded[texelIndex].a };
+			for (int channel = 0; channel < (includeAlpha ? 4 : 3); ++channel)
+			{
+				error.m_maxError = std::max(error.m_maxError, std::abs(differences[channel]));
+				error.m_sumSquared += differences[channel] * differences[channel];
+				++error.m_numValues;
+			}
+		}
+	}
+
+	unsigned char ToChannel(int value)
+	{
+		return static_cast<unsigned char>(std::min(std::max(value, 0), 255));
+	}
+
+	std::vector<BlockTexels> MakeSolidBlocks(std::mt19937& random, int numBlocks, bool isOpaque)
+	{
+		std::vector<BlockTexels> blocks;
+		for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+		{
+			Rgba8 color(ToChannel(random() % 256), ToChannel(random() % 256), ToChannel(random() % 256), isOpaque ? 255 : ToChannel(random() % 256));
+			blocks.push_back(BlockTexels(16, color));
+		}
+		return blocks;
+	}
+
+	// Linear ramps between two random colors, the kind of block a photo or a painted texture is made of
+	std::vector<BlockTexels> MakeGradientBlocks(std::mt19937& random, int numBlocks, bool isOpaque)
+	{
+		std::vector<BlockTexels> blocks;
+		for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+		{
+			int start[4];
+			int end[4];
+			for (int channel = 0; channel < 4; ++channel)
+			{
+				start[channel] = static_cast<int>(random() % 256);
+				end[channel] = static_cast<int>(random() % 256);
+			}
+			BlockTexels block(16);
+			for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+			{
+				int const step = (texelIndex % 4) + (texelIndex / 4);
+				int channels[4];
+				for (int channel = 0; channel < 4; ++channel)
+				{
+					channels[channel] = start[channel] + (end[channel] - start[channel]) * step / 6;
+				}
+				block[texelIndex] = Rgba8(ToChannel(channels[0]), ToChannel(channels[1]), ToChannel(channels[2]), isOpaque ? 255 : ToChannel(channels[3]));
+			}
+			blocks.push_back(block);
+		}
+		return blocks;
+	}
+
+	// Worst case, nothing for the endpoints to line up with
+	std::vector<BlockTexels> MakeNoiseBlocks(std::mt19937& random, int numBlocks, bool isOpaque)
+	{
+		std::vector<BlockTexels> blocks;
+		for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+		{
+			BlockTexels block(16);
+			for (Rgba8& texel : block)
+			{
+				texel = Rgba8(ToChannel(random() % 256), ToChannel(random() % 256), isOpaque ? 255 : ToChannel(random() % 256));
+			}
+			blocks.push_back(block);
+		}
+		return blocks;
+	}
+
+	BlockError RoundTripBC1(std::vector<BlockTexels> const& blocks)
+	{
+		BlockError error;
+		for (BlockTexels const& block : blocks)
+		{
+			uint8_t encoded[8];
+			Rgba8 decoded[16];
+			EncodeBC1Block(block.data(), encoded);
+			DecodeBC1Block(encoded, decoded);
+			AddError(error, block.data(), decoded, false);
+		}
+		return error;
+	}
+
+	BlockError RoundTripBC3(std::vector<BlockTexels> const& blocks)
+	{
+		BlockError error;
+		for (BlockTexels const& block : blocks)
+		{
+			uint8_t encoded[16];
+			Rgba8 decoded[16];
+			EncodeBC3Block(block.data(), encoded);
+			DecodeBC3Block(encoded, decoded);
+			AddError(error, block.data(), decoded, true);
+		}
+		return error;
+	}
+
+	BlockError RoundTripBC7(std::vector<BlockTexels> const& blocks)
+	{
+		BlockError error;
+		for (BlockTexels const& block : blocks)
+		{
+			uint8_t encoded[16];
+			Rgba8 decoded[16];
+			EncodeBC7Block(block.data(), encoded);
+			DecodeBC7Block(encoded, decoded);
+			AddError(error, block.data(), decoded, true);
+		}
+		return error;
+	}
+
+	// Least significant bit first, the order every BC format packs its fields in
+	void WriteBits(uint8_t* bytes, int& bitOffset, uint32_t value, int numBits)
+	{
+		for (int bitIndex = 0; bitIndex < numBits; ++bitIndex, ++bitOffset)
+		{
+			if ((value >> bitIndex) & 1)
+			{
+				bytes[bitOffset / 8] |= static_cast<uint8_t>(1 << (bitOffset % 8));
+			}
+		}
+	}
+
+	bool IsNear(int value, int expected)
+	{
+		return std::abs(value - expected) <= 1;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+// Tolerances sit a little above what the encoders reach today, so a regression in endpoint fitting
+// or in the bit layout fails while an equally good change of heuristics does not
+ENGINE_TEST(TextureCook, BlockEncodersRoundTripWithinTolerance)
+{
+	std::mt19937 random(3);
+	std::vector<BlockTexels> const opaqueSolid = MakeSolidBlocks(random, 200, true);
+	std::vector<BlockTexels> const opaqueGradients = MakeGradientBlocks(random, 200, true);
+	std::vector<BlockTexels> const opaqueNoise = MakeNoiseBlocks(random, 200, true);
+	std::vector<BlockTexels> const solid = MakeSolidBlocks(random, 200, false);
+	std::vector<BlockTexels> const gradients = MakeGradientBlocks(random, 200, false);
+	std::vector<BlockTexels> const noise = MakeNoiseBlocks(random, 200, false);
+
+	// BC1 and BC3 color is 565 endpoints with two interpolated entries
+	BlockError error = RoundTripBC1(opaqueSolid);
+	TEST_CHECK(error.m_maxError <= 5);
+	TEST_CHECK(error.GetRms() <= 2.5);
+	error = RoundTripBC1(opaqueGradients);
+	TEST_CHECK(error.m_maxError <= 48);
+	TEST_CHECK(error.GetRms() <= 10.0);
+	BlockError const bc1GradientError = error;
+	error = RoundTripBC1(opaqueNoise);
+	TEST_CHECK(error.GetRms() <= 45.0);
+
+	// BC3 alpha has 8 bit endpoints, so a flat alpha comes back exactly
+	error = RoundTripBC3(solid);
+	TEST_CHECK(error.m_maxError <= 5);
+	TEST_CHECK(error.GetRms() <= 2.5);
+	error = RoundTripBC3(gradients);
+	TEST_CHECK(error.m_maxError <= 48);
+	TEST_CHECK(error.GetRms() <= 9.0);
+	error = RoundTripBC3(noise);
+	TEST_CHECK(error.GetRms() <= 55.0);
+
+	// BC7 mode 6 is 7 bit endpoints plus a shared bit and 16 weights, close to lossless on smooth blocks
+	for (std::vector<BlockTexels> const* blocks : { &opaqueSolid, &solid })
+	{
+		error = RoundTripBC7(*blocks);
+		TEST_CHECK(error.m_maxError <= 1);
+	}
+	for (std::vector<BlockTexels> const* blocks : { &opaqueGradients, &gradients })
+	{
+		error = RoundTripBC7(*blocks);
+		TEST_CHECK(error.m_maxError <= 10);
+		TEST_CHECK(error.GetRms() <= 2.5);
+		TEST_CHECK(error.GetRms() < bc1GradientError.GetRms());
+	}
+	error = RoundTripBC7(noise);
+	TEST_CHECK(error.GetRms() <= 55.0);
+}
+
+ENGINE_TEST(TextureCook, BlockEncodersKeepAlphaModes)
+{
+	std::mt19937 random(9);
+	std::vector<BlockTexels> blocks = MakeGradientBlocks(random, 100, true);
+	for (size_t blockIndex = 0; blockIndex < blocks.size(); ++blockIndex)
+	{
+		BlockTexels& block = blocks[blockIndex];
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			block[texelIndex].a = static_cast<unsigned char>(((texelIndex + blockIndex) % 3 == 0) ? 20 : 240);
+		}
+	}
+
+	for (BlockTexels const& block : blocks)
+	{
+		uint8_t encoded[16];
+		Rgba8 decoded[16];
+
+		// BC1 alpha is one bit, cut at 128, and a cut texel is transparent black
+		EncodeBC1Block(block.data(), encoded);
+		DecodeBC1Block(encoded, decoded);
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			bool const isTransparent = block[texelIndex].a < 128;
+			TEST_CHECK_EQUAL(static_cast<int>(decoded[texelIndex].a), isTransparent ? 0 : 255);
+		}
+
+		// Two alpha values fit the BC3 alpha endpoints exactly
+		EncodeBC3Block(block.data(), encoded);
+		DecodeBC3Block(encoded, decoded);
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			TEST_CHECK_EQUAL(decoded[texelIndex].a, block[texelIndex].a);
+		}
+	}
+
+	// An opaque block stays exactly opaque in BC7, the alpha channel is not left to the fit
+	for (BlockTexels const& block : MakeNoiseBlocks(random, 100, true))
+	{
+		uint8_t encoded[16];
+		Rgba8 decoded[16];
+		EncodeBC7Block(block.data(), encoded);
+		DecodeBC7Block(encoded, decoded);
+		for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			TEST_CHECK_EQUAL(static_cast<int>(decoded[texelIndex].a), 255);
+		}
+	}
+}
+
+// Blocks built by hand from the format documentation, so an encoder and decoder that agree on a
+// wrong layout still fail. Interpolated entries may round either way, hence IsNear
+ENGINE_TEST(TextureCook, DecodersMatchTheBlockFormats)
+{
+	// BC1, red then blue 565 endpoints, texel i uses index i % 4
+	uint8_t bc1Block[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+	Rgba8 decoded[16];
+	DecodeBC1Block(bc1Block, decoded);
+	int const fourColors[4][4] = { { 255, 0, 0, 255 }, { 0, 0, 255, 255 }, { 170, 0, 85, 255 }, { 85, 0, 170, 255 } };
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		int const* expected = fourColors[texelIndex % 4];
+		TEST_CHECK(IsNear(decoded[texelIndex].r, expected[0]) && decoded[texelIndex].g == expected[1]
+			&& IsNear(decoded[texelIndex].b, expected[2]) && decoded[texelIndex].a == expected[3]);
+	}
+
+	// Swapped endpoints, color0 <= color1, is the three color mode with transparent black last
+	uint8_t bc1ThreeColorBlock[8] = { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4 };
+	DecodeBC1Block(bc1ThreeColorBlock, decoded);
+	int const threeColors[4][4] = { { 0, 0, 255, 255 }, { 255, 0, 0, 255 }, { 128, 0, 128, 255 }, { 0, 0, 0, 0 } };
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		int const* expected = threeColors[texelIndex % 4];
+		TEST_CHECK(IsNear(decoded[texelIndex].r, expected[0]) && decoded[texelIndex].g == expected[1]
+			&& IsNear(decoded[texelIndex].b, expected[2]) && decoded[texelIndex].a == expected[3]);
+	}
+
+	// BC3, alpha 255 and 0 with 3 bit indexes, texel i uses index i % 8, then the BC1 block as color.
+	// BC3 color is always four colors, whatever the endpoint order
+	uint8_t bc3Block[16] = { 0xFF, 0x00 };
+	int bitOffset = 16;
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		WriteBits(bc3Block, bitOffset, static_cast<uint32_t>(texelIndex % 8), 3);
+	}
+	std::copy(bc1ThreeColorBlock, bc1ThreeColorBlock + 8, bc3Block + 8);
+	DecodeBC3Block(bc3Block, decoded);
+	int const alphas[8] = { 255, 0, 219, 182, 146, 109, 73, 36 };
+	int const bc3Colors[4][3] = { { 0, 0, 255 }, { 255, 0, 0 }, { 85, 0, 170 }, { 170, 0, 85 } };
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		int const* expected = bc3Colors[texelIndex % 4];
+		TEST_CHECK(IsNear(decoded[texelIndex].a, alphas[texelIndex % 8]));
+		TEST_CHECK(IsNear(decoded[texelIndex].r, expected[0]) && IsNear(decoded[texelIndex].b, expected[2]));
+	}
+
+	// BC7 mode 6, endpoints 0 and 255 in every channel through the p bits, texel i uses index i,
+	// the first index has 3 bits
+	uint8_t bc7Block[16] = {};
+	bitOffset = 0;
+	WriteBits(bc7Block, bitOffset, 1 << 6, 7);
+	for (int channel = 0; channel < 4; ++channel)
+	{
+		WriteBits(bc7Block, bitOffset, 0x00, 7);
+		WriteBits(bc7Block, bitOffset, 0x7F, 7);
+	}
+	WriteBits(bc7Block, bitOffset, 0, 1);
+	WriteBits(bc7Block, bitOffset, 1, 1);
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		WriteBits(bc7Block, bitOffset, static_cast<uint32_t>(texelIndex), (texelIndex == 0) ? 3 : 4);
+	}
+	TEST_CHECK_EQUAL(bitOffset, 128);
+	DecodeBC7Block(bc7Block, decoded);
+	int const weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	for (int texelIndex = 0; texelIndex < 16; ++texelIndex)
+	{
+		int const expected = (weights[texelIndex] * 255 + 32) >> 6;
+		TEST_CHECK(decoded[texelIndex].r == expected && decoded[texelIndex].g == expected && decoded[texelIndex].b == expected && decoded[texelIndex].a == expected);
+	}
+
+	// Only mode 6 is decoded, anything else is transparent black like a reserved mode
+	bc7Block[0] = 0x01;
+	DecodeBC7Block(bc7Block, decoded);
+	TEST_CHECK(decoded[5].r == 0 && decoded[5].a == 0);
+}
@@ -0,0 +1,151 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Renderer/TextureStreamer.hpp"
+#include "Engine/Renderer/NullRenderer.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include <cstdio>
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+namespace
+{
+	// 2x2 RGBA PNG, both rows red then blue
+	std::vector<uint8_t> const VALID_PNG = {
+		0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+		0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x08, 0x06, 0x00, 0x00, 0x00, 0x72, 0xb6, 0x0d,
+		0x24, 0x00, 0x00, 0x00, 0x11, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9c, 0x63, 0xf8, 0xcf, 0xc0, 0x00,
+		0x42, 0xff, 0x19, 0x60, 0x0c, 0x00, 0x43, 0xce, 0x07, 0xf9, 0x58, 0xed, 0x66, 0xa0, 0x00, 0x00,
+		0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+	};
+
+	// 2x2 8 bit greyscale PNG, top row 0 and 255, bottom row 128 and 64
+	std::vector<uint8_t> const GREY_PNG = {
+		0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+		0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x08, 0x00, 0x00, 0x00, 0x00, 0x57, 0xdd, 0x52,
+		0xf8, 0x00, 0x00, 0x00, 0x0e, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0x60, 0xf8, 0xcf, 0xd0,
+		0xe0, 0x00, 0x00, 0x05, 0x42, 0x01, 0xc0, 0x6d, 0x5e, 0x78, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x49,
+		0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+	};
+
+	// Header intact, so GetImageFileInfo still accepts it, but cut off inside the IDAT chunk
+	std::vector<uint8_t> GetTruncatedPng()
+	{
+		return std::vector<uint8_t>(VALID_PNG.begin(), VALID_PNG.begin() + 50);
+	}
+
+	bool IsSameColor(Rgba8 const& a, Rgba8 const& b)
+	{
+		return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+	}
+
+	bool IsSameImage(Image const& a, Image const& b)
+	{
+		if (!(a.GetDimensions() == b.GetDimensions()) || a.GetImageFilePath() != b.GetImageFilePath())
+		{
+			return false;
+		}
+		size_t numBytes = static_cast<size_t>(a.GetDimensions().x) * a.GetDimensions().y * sizeof(Rgba8);
+		return memcmp(a.GetRawData(), b.GetRawData(), numBytes) == 0;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(TextureStreamer, LoadFromFileFailsQuietly)
+{
+	std::string const validPath = "/tmp/EngineTests_Valid.png";
+	std::string const truncatedPath = "/tmp/EngineTests_Truncated.png";
+	FileWriteFromBuffer(VALID_PNG, validPath);
+	FileWriteFromBuffer(GetTruncatedPng(), truncatedPath);
+
+	Image image;
+	TEST_CHECK(image.LoadFromFile(validPath.c_str()));
+	TEST_CHECK_EQUAL(image.GetDimensions().x, 2);
+	TEST_CHECK_EQUAL(image.GetDimensions().y, 2);
+	TEST_CHECK(IsSameColor(image.GetTexelColor(IntVec2(0, 0)), Rgba8(255, 0, 0, 255)));
+	TEST_CHECK(IsSameColor(image.GetTexelColor(IntVec2(1, 0)), Rgba8(0, 0, 255, 255)));
+
+	IntVec2 headerDimensions;
+	TEST_CHECK(GetImageFileInfo(truncatedPath.c_str(), headerDimensions));
+	TEST_CHECK(!image.LoadFromFile(truncatedPath.c_str()));
+	TEST_CHECK(!image.LoadFromFile("/tmp/EngineTests_Missing.png"));
+
+	// A failed load leaves the previous image alone
+	TEST_CHECK(image.GetImageFilePath() == validPath);
+	TEST_CHECK_EQUAL(image.GetDimensions().x, 2);
+	TEST_CHECK(IsSameColor(image.GetTexelColor(IntVec2(1, 1)), Rgba8(0, 0, 255, 255)));
+
+	remove(validPath.c_str());
+	remove(truncatedPath.c_str());
+}
+
+ENGINE_TEST(TextureStreamer, TruncatedFileFails)
+{
+	std::string const validPath = "/tmp/EngineTests_StreamedValid.png";
+	std::string const truncatedPath = "/tmp/EngineTests_StreamedTruncated.png";
+	FileWriteFromBuffer(VALID_PNG, validPath);
+	FileWriteFromBuffer(GetTruncatedPng(), truncatedPath);
+
+	RendererConfig config;
+	NullRenderer renderer(config);
+	renderer.Startup();
+	{
+		TextureStreamer streamer(&renderer);
+		StreamedTextureHandle validHandle = streamer.RequestTexture(validPath);
+		StreamedTextureHandle truncatedHandle = streamer.RequestTexture(truncatedPath);
+		streamer.FinishAllRequests();
+
+		TEST_CHECK(streamer.GetState(validHandle) == StreamedTextureState::READY);
+		TEST_CHECK(streamer.GetTexture(validHandle) != nullptr);
+		TEST_CHECK(streamer.GetState(truncatedHandle) == StreamedTextureState::FAILED);
+		TEST_CHECK(streamer.GetTexture(truncatedHandle) == nullptr);
+		TEST_CHECK_EQUAL(streamer.GetStats().m_numFailed, 1);
+	}
+	renderer.Shutdown();
+
+	remove(validPath.c_str());
+	remove(truncatedPath.c_str());
+}
+
+// Images decode straight to RGBA rows, the flip is which source row each row is copied from
+ENGINE_TEST(TextureStreamer, ImagesDecodeToRgbaRows)
+{
+	std::string const greyPath = "/tmp/EngineTests_Grey.png";
+	std::string const validPath = "/tmp/EngineTests_BatchValid.png";
+	FileWriteFromBuffer(GREY_PNG, greyPath);
+	FileWriteFromBuffer(VALID_PNG, validPath);
+
+	// Image row 0 is the bottom of the file unless asked otherwise, grey expands to opaque RGBA
+	Image flipped(greyPath.c_str());
+	TEST_CHECK(IsSameColor(flipped.GetTexelColor(IntVec2(0, 0)), Rgba8(128, 128, 128, 255)));
+	TEST_CHECK(IsSameColor(flipped.GetTexelColor(IntVec2(1, 0)), Rgba8(64, 64, 64, 255)));
+	TEST_CHECK(IsSameColor(flipped.GetTexelColor(IntVec2(0, 1)), Rgba8(0, 0, 0, 255)));
+	TEST_CHECK(IsSameColor(flipped.GetTexelColor(IntVec2(1, 1)), Rgba8(255, 255, 255, 255)));
+	Image unflipped(greyPath.c_str(), false);
+	TEST_CHECK(IsSameColor(unflipped.GetTexelColor(IntVec2(0, 0)), Rgba8(0, 0, 0, 255)));
+	TEST_CHECK(IsSameColor(unflipped.GetTexelColor(IntVec2(1, 1)), Rgba8(64, 64, 64, 255)));
+
+	// A batch keeps the order of its paths and matches loading one at a time, on threads or not
+	std::vector<std::string> paths;
+	for (int pathIndex = 0; pathIndex < 24; ++pathIndex)
+	{
+		paths.push_back((pathIndex % 3 == 0) ? validPath : greyPath);
+	}
+	WorkerPool workers(3);
+	for (bool flipVertically : { true, false })
+	{
+		std::vector<Image> serial = LoadImagesFromFiles(paths, nullptr, flipVertically);
+		std::vector<Image> pooled = LoadImagesFromFiles(paths, &workers, flipVertically);
+		TEST_CHECK_EQUAL(pooled.size(), paths.size());
+		for (size_t pathIndex = 0; pathIndex < paths.size(); ++pathIndex)
+		{
+			Image single(paths[pathIndex].c_str(), flipVertically);
+			TEST_CHECK(IsSameImage(serial[pathIndex], single));
+			TEST_CHECK(IsSameImage(pooled[pathIndex], single));
+		}
+	}
+
+	remove(greyPath.c_str());
+	remove(validPath.c_str());
+}
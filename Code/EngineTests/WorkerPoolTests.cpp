@@ -0,0 +1,133 @@
+#include "EngineTests/EngineTest.hpp"
+#include "Engine/Core/WorkerPool.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+ENGINE_TEST(WorkerPool, EveryTaskRunsOnce)
+{
+	WorkerPool workers(4);
+	for (int numTasks : { 0, 1, 2, 7, 1000 })
+	{
+		std::vector<std::atomic<int>> runCounts(numTasks);
+		workers.ParallelFor(numTasks, [&](int taskIndex) { runCounts[taskIndex].fetch_add(1); });
+		for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+		{
+			TEST_CHECK_EQUAL(runCounts[taskIndex].load(), 1);
+		}
+	}
+}
+
+ENGINE_TEST(WorkerPool, NoWorkersRunsInline)
+{
+	WorkerPool workers(0);
+	std::thread::id callerId = std::this_thread::get_id();
+	bool allInline = true;
+	workers.ParallelFor(16, [&](int) { allInline = allInline && std::this_thread::get_id() == callerId; });
+	workers.Enqueue([&]() { allInline = allInline && std::this_thread::get_id() == callerId; });
+	TEST_CHECK(allInline);
+}
+
+// Producers hammer the same pool with ParallelFor calls of their own at the same time
+ENGINE_TEST(WorkerPool, ManyProducers)
+{
+	constexpr int NUM_PRODUCERS = 8;
+	constexpr int NUM_JOBS_PER_PRODUCER = 200;
+	WorkerPool workers(4);
+
+	std::atomic<int> numWrongSums{ 0 };
+	std::vector<std::thread> producers;
+	for (int producerIndex = 0; producerIndex < NUM_PRODUCERS; ++producerIndex)
+	{
+		producers.emplace_back([&, producerIndex]()
+		{
+			for (int jobIndex = 0; jobIndex < NUM_JOBS_PER_PRODUCER; ++jobIndex)
+			{
+				int numTasks = 1 + (producerIndex * 31 + jobIndex * 17) % 64;
+				std::atomic<int> sum{ 0 };
+				workers.ParallelFor(numTasks, [&](int taskIndex) { sum.fetch_add(taskIndex + 1); });
+				if (sum.load() != numTasks * (numTasks + 1) / 2)
+				{
+					numWrongSums.fetch_add(1);
+				}
+			}
+		});
+	}
+	for (std::thread& producer : producers)
+	{
+		producer.join();
+	}
+	TEST_CHECK_EQUAL(numWrongSums.load(), 0);
+}
+
+// Every task of the outer job starts an inner job on the same pool, two levels deep
+ENGINE_TEST(WorkerPool, NestedParallelFor)
+{
+	WorkerPool workers(3);
+	constexpr int NUM_OUTER = 32;
+	constexpr int NUM_MIDDLE = 8;
+	constexpr int NUM_INNER = 16;
+
+	std::atomic<int> numLeafTasks{ 0 };
+	workers.ParallelFor(NUM_OUTER, [&](int)
+	{
+		workers.ParallelFor(NUM_MIDDLE, [&](int)
+		{
+			workers.ParallelFor(NUM_INNER, [&](int) { numLeafTasks.fetch_add(1); });
+		});
+	});
+	TEST_CHECK_EQUAL(numLeafTasks.load(), NUM_OUTER * NUM_MIDDLE * NUM_INNER);
+}
+
+// The destructor must run everything still queued, not drop it
+ENGINE_TEST(WorkerPool, ShutdownWithQueuedWork)
+{
+	constexpr int NUM_QUEUED = 20000;
+	std::atomic<int> numRun{ 0 };
+	{
+		WorkerPool workers(4);
+		for (int taskIndex = 0; taskIndex < NUM_QUEUED; ++taskIndex)
+		{
+			workers.Enqueue([&numRun]() { numRun.fetch_add(1); });
+		}
+	}
+	TEST_CHECK_EQUAL(numRun.load(), NUM_QUEUED);
+}
+
+// Queued tasks, ParallelFor producers and nested jobs all in flight while the pool shuts down
+ENGINE_TEST(WorkerPool, MixedStress)
+{
+	constexpr int NUM_ROUNDS = 20;
+	for (int roundIndex = 0; roundIndex < NUM_ROUNDS; ++roundIndex)
+	{
+		std::atomic<int> numQueuedRun{ 0 };
+		std::atomic<int> numNestedRun{ 0 };
+		int numQueued = 0;
+		{
+			WorkerPool workers(1 + roundIndex % 4);
+			std::vector<std::thread> producers;
+			for (int producerIndex = 0; producerIndex < 4; ++producerIndex)
+			{
+				producers.emplace_back([&]()
+				{
+					workers.ParallelFor(16, [&](int)
+					{
+						workers.ParallelFor(4, [&](int) { numNestedRun.fetch_add(1); });
+					});
+				});
+			}
+			for (; numQueued < 500; ++numQueued)
+			{
+				workers.Enqueue([&numQueuedRun]() { numQueuedRun.fetch_add(1); });
+			}
+			for (std::thread& producer : producers)
+			{
+				producer.join();
+			}
+		}
+		TEST_CHECK_EQUAL(numQueuedRun.load(), numQueued);
+		TEST_CHECK_EQUAL(numNestedRun.load(), 4 * 16 * 4);
+	}
+}